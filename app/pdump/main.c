@@ -65,6 +65,9 @@
 #define PDUMP_RING_SIZE_ARG "ring-size"
 #define PDUMP_MSIZE_ARG "mbuf-size"
 #define PDUMP_NUM_MBUFS_ARG "total-num-mbufs"
+#define PDUMP_SNAPLEN_ARG "snaplen"
+#define PDUMP_FILTER_ARG "filter"
+#define PDUMP_ZEROCOPY_ARG "zero-copy"
 #define CMD_LINE_OPT_SER_SOCK_PATH "server-socket-path"
 #define CMD_LINE_OPT_CLI_SOCK_PATH "client-socket-path"
 
@@ -120,6 +123,9 @@ const char *valid_pdump_arguments[] = {
 	PDUMP_RING_SIZE_ARG,
 	PDUMP_MSIZE_ARG,
 	PDUMP_NUM_MBUFS_ARG,
+	PDUMP_SNAPLEN_ARG,
+	PDUMP_FILTER_ARG,
+	PDUMP_ZEROCOPY_ARG,
 	NULL
 };
 
@@ -139,6 +145,10 @@ struct pdump_tuples {
 	uint32_t ring_size;
 	uint16_t mbuf_data_size;
 	uint32_t total_num_mbufs;
+	uint32_t snaplen;
+	struct rte_pdump_bpf_insn *filter;
+	uint16_t filter_len;
+	bool zero_copy;
 
 	/* params for library API call */
 	uint32_t dir;
@@ -156,6 +166,7 @@ struct pdump_tuples {
 
 	/* stats */
 	struct pdump_stats stats;
+	struct rte_pdump_stats capture_stats;
 } __rte_cache_aligned;
 static struct pdump_tuples pdump_t[APP_ARG_TCPDUMP_MAX_TUPLES];
 
@@ -182,7 +193,10 @@ pdump_usage(const char *prgname)
 			" tx-dev=<iface or pcap file>,"
 			"[ring-size=<ring size>default:16384],"
 			"[mbuf-size=<mbuf data size>default:2176],"
-			"[total-num-mbufs=<number of mbufs>default:65535]'\n"
+			"[total-num-mbufs=<number of mbufs>default:65535],"
+			"[snaplen=<bytes captured per packet>default:0 (all)],"
+			"[filter=<file of tcpdump -ddd output>],"
+			"[zero-copy=<0|1>default:0]'\n"
 			"[--server-socket-path=<server socket dir>"
 				"default:/var/run/.dpdk/ (or) ~/.dpdk/]\n"
 			"[--client-socket-path=<client socket dir>"
@@ -238,6 +252,63 @@ parse_rxtxdev(const char *key, const char *value, void *extra_args)
 	return 0;
 }
 
+/* load a classic BPF program, as printed by "tcpdump -ddd <expression>" */
+static int
+parse_filter(const char *key __rte_unused, const char *value,
+		void *extra_args)
+{
+	struct pdump_tuples *pt = extra_args;
+	struct rte_pdump_bpf_insn *ins;
+	unsigned int code, jt, jf, k, n, i;
+	FILE *f;
+	int ret = 0;
+
+	f = fopen(value, "r");
+	if (f == NULL) {
+		ret = -errno;
+		printf("cannot open filter file \"%s\": %s\n", value,
+			strerror(-ret));
+		return ret;
+	}
+
+	if (fscanf(f, "%u", &n) != 1 || n == 0 ||
+			n > RTE_PDUMP_FILTER_MAX_INSNS) {
+		printf("filter file \"%s\": invalid instruction count\n",
+			value);
+		ret = -EINVAL;
+		goto close_file;
+	}
+
+	pt->filter = calloc(n, sizeof(*pt->filter));
+	if (pt->filter == NULL) {
+		ret = -ENOMEM;
+		goto close_file;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (fscanf(f, "%u %u %u %u", &code, &jt, &jf, &k) != 4 ||
+				code > UINT16_MAX || jt > UINT8_MAX ||
+				jf > UINT8_MAX) {
+			printf("filter file \"%s\": invalid instruction %u\n",
+				value, i);
+			free(pt->filter);
+			pt->filter = NULL;
+			ret = -EINVAL;
+			goto close_file;
+		}
+		ins = &pt->filter[i];
+		ins->code = code;
+		ins->jt = jt;
+		ins->jf = jf;
+		ins->k = k;
+	}
+	pt->filter_len = n;
+
+close_file:
+	fclose(f);
+	return ret;
+}
+
 static int
 parse_uint_value(const char *key, const char *value, void *extra_args)
 {
@@ -396,6 +467,40 @@ parse_pdump(const char *optarg)
 	} else
 		pt->total_num_mbufs = MBUFS_PER_POOL;
 
+	/* snaplen parsing and validation */
+	cnt1 = rte_kvargs_count(kvlist, PDUMP_SNAPLEN_ARG);
+	if (cnt1 == 1) {
+		v.min = 0;
+		v.max = UINT32_MAX;
+		ret = rte_kvargs_process(kvlist, PDUMP_SNAPLEN_ARG,
+						&parse_uint_value, &v);
+		if (ret < 0)
+			goto free_kvlist;
+		pt->snaplen = (uint32_t) v.val;
+	} else
+		pt->snaplen = 0;
+
+	/* filter parsing */
+	cnt1 = rte_kvargs_count(kvlist, PDUMP_FILTER_ARG);
+	if (cnt1 == 1) {
+		ret = rte_kvargs_process(kvlist, PDUMP_FILTER_ARG,
+						&parse_filter, pt);
+		if (ret < 0)
+			goto free_kvlist;
+	}
+
+	/* zero-copy parsing and validation */
+	cnt1 = rte_kvargs_count(kvlist, PDUMP_ZEROCOPY_ARG);
+	if (cnt1 == 1) {
+		v.min = 0;
+		v.max = 1;
+		ret = rte_kvargs_process(kvlist, PDUMP_ZEROCOPY_ARG,
+						&parse_uint_value, &v);
+		if (ret < 0)
+			goto free_kvlist;
+		pt->zero_copy = !!v.val;
+	}
+
 	num_tuples++;
 
 free_kvlist:
@@ -475,6 +580,14 @@ print_pdump_stats(void)
 							pt->stats.tx_pkts);
 		printf(" -packets freed:			%"PRIu64"\n",
 							pt->stats.freed_pkts);
+		printf(" -packets captured:			%"PRIu64"\n",
+						pt->capture_stats.accepted);
+		printf(" -packets filtered out:		%"PRIu64"\n",
+						pt->capture_stats.filtered);
+		printf(" -packets lost, no mbufs:		%"PRIu64"\n",
+						pt->capture_stats.nombuf);
+		printf(" -packets lost, ring full:		%"PRIu64"\n",
+						pt->capture_stats.ringfull);
 	}
 }
 
@@ -488,6 +601,17 @@ disable_pdump(struct pdump_tuples *pt)
 		rte_pdump_disable(pt->port, pt->queue, pt->dir);
 }
 
+static inline void
+get_capture_stats(struct pdump_tuples *pt)
+{
+	if (pt->dump_by_type == DEVICE_ID)
+		rte_pdump_stats_by_deviceid(pt->device_id, pt->queue,
+				pt->dir, &pt->capture_stats);
+	else if (pt->dump_by_type == PORT_ID)
+		rte_pdump_stats(pt->port, pt->queue, pt->dir,
+				&pt->capture_stats);
+}
+
 static inline void
 pdump_rxtx(struct rte_ring *ring, uint8_t vdev_id, struct pdump_stats *stats)
 {
@@ -534,6 +658,7 @@ cleanup_rings(void)
 
 		if (pt->device_id)
 			free(pt->device_id);
+		free(pt->filter);
 
 		/* free the rings */
 		if (pt->rx_ring)
@@ -555,6 +680,7 @@ cleanup_pdump_resources(void)
 
 		/* remove callbacks */
 		disable_pdump(pt);
+		get_capture_stats(pt);
 
 		/*
 		* transmit rest of the enqueued packets of the rings on to
@@ -767,6 +893,22 @@ create_mp_ring_vdev(void)
 	}
 }
 
+static int
+enable_pdump_dir(struct pdump_tuples *pt, uint32_t dir, struct rte_ring *ring)
+{
+	if (pt->zero_copy)
+		dir |= RTE_PDUMP_FLAG_ZEROCOPY;
+
+	if (pt->dump_by_type == DEVICE_ID)
+		return rte_pdump_enable_filter_by_deviceid(pt->device_id,
+				pt->queue, dir, pt->snaplen, ring, pt->mp,
+				pt->filter, pt->filter_len);
+
+	return rte_pdump_enable_filter(pt->port, pt->queue, dir,
+			pt->snaplen, ring, pt->mp, pt->filter,
+			pt->filter_len);
+}
+
 static void
 enable_pdump(void)
 {
@@ -793,49 +935,14 @@ enable_pdump(void)
 	for (i = 0; i < num_tuples; i++) {
 		pt = &pdump_t[i];
 		if (pt->dir == RTE_PDUMP_FLAG_RXTX) {
-			if (pt->dump_by_type == DEVICE_ID) {
-				ret = rte_pdump_enable_by_deviceid(
-						pt->device_id,
-						pt->queue,
-						RTE_PDUMP_FLAG_RX,
-						pt->rx_ring,
-						pt->mp, NULL);
-				ret1 = rte_pdump_enable_by_deviceid(
-						pt->device_id,
-						pt->queue,
-						RTE_PDUMP_FLAG_TX,
-						pt->tx_ring,
-						pt->mp, NULL);
-			} else if (pt->dump_by_type == PORT_ID) {
-				ret = rte_pdump_enable(pt->port, pt->queue,
-						RTE_PDUMP_FLAG_RX,
-						pt->rx_ring, pt->mp, NULL);
-				ret1 = rte_pdump_enable(pt->port, pt->queue,
-						RTE_PDUMP_FLAG_TX,
-						pt->tx_ring, pt->mp, NULL);
-			}
+			ret = enable_pdump_dir(pt, RTE_PDUMP_FLAG_RX,
+					pt->rx_ring);
+			ret1 = enable_pdump_dir(pt, RTE_PDUMP_FLAG_TX,
+					pt->tx_ring);
 		} else if (pt->dir == RTE_PDUMP_FLAG_RX) {
-			if (pt->dump_by_type == DEVICE_ID)
-				ret = rte_pdump_enable_by_deviceid(
-						pt->device_id,
-						pt->queue,
-						pt->dir, pt->rx_ring,
-						pt->mp, NULL);
-			else if (pt->dump_by_type == PORT_ID)
-				ret = rte_pdump_enable(pt->port, pt->queue,
-						pt->dir,
-						pt->rx_ring, pt->mp, NULL);
+			ret = enable_pdump_dir(pt, pt->dir, pt->rx_ring);
 		} else if (pt->dir == RTE_PDUMP_FLAG_TX) {
-			if (pt->dump_by_type == DEVICE_ID)
-				ret = rte_pdump_enable_by_deviceid(
-						pt->device_id,
-						pt->queue,
-						pt->dir,
-						pt->tx_ring, pt->mp, NULL);
-			else if (pt->dump_by_type == PORT_ID)
-				ret = rte_pdump_enable(pt->port, pt->queue,
-						pt->dir,
-						pt->tx_ring, pt->mp, NULL);
+			ret = enable_pdump_dir(pt, pt->dir, pt->tx_ring);
 		}
 		if (ret < 0 || ret1 < 0) {
 			cleanup_pdump_resources();
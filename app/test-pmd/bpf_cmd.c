@@ -0,0 +1,193 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_bpf_ethdev.h>
+#include <rte_ethdev.h>
+#include <rte_flow.h>
+#include <rte_mbuf.h>
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_num.h>
+#include <cmdline_parse_string.h>
+
+#include "testpmd.h"
+#include "bpf_cmd.h"
+
+/* symbols programs loaded from testpmd may refer to */
+static const struct rte_bpf_xsym bpf_xsym[] = {
+	{
+		.name = RTE_STR(stdout),
+		.type = RTE_BPF_XTYPE_VAR,
+		.var = &stdout,
+	},
+	{
+		.name = RTE_STR(rte_pktmbuf_dump),
+		.type = RTE_BPF_XTYPE_FUNC,
+		.func = (uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t,
+			uint64_t))(uintptr_t)rte_pktmbuf_dump,
+	},
+};
+
+/* *** Load BPF program *** */
+struct cmd_bpf_ld_result {
+	cmdline_fixed_string_t bpf;
+	cmdline_fixed_string_t dir;
+	uint16_t port;
+	uint16_t queue;
+	cmdline_fixed_string_t op;
+	cmdline_fixed_string_t flags;
+	cmdline_fixed_string_t prm;
+};
+
+/*
+ * Parse the flags string: J requests the native code, M gives the program
+ * the mbuf instead of the packet data, - stands for no flag.
+ */
+static int
+bpf_parse_flags(const char *str, struct rte_bpf_prm *prm, uint32_t *flags)
+{
+	uint32_t i;
+
+	*flags = RTE_BPF_ETH_F_NONE;
+	prm->prog_type = RTE_BPF_PROG_TYPE_UNSPEC;
+
+	for (i = 0; str[i] != 0; i++) {
+		switch (str[i]) {
+		case 'J':
+			*flags |= RTE_BPF_ETH_F_JIT;
+			break;
+		case 'M':
+			prm->prog_type = RTE_BPF_PROG_TYPE_MBUF;
+			break;
+		case '-':
+			break;
+		default:
+			printf("unknown flag: \'%c\'\n", str[i]);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+static void cmd_operate_bpf_ld_parsed(void *parsed_result,
+	__attribute__((unused)) struct cmdline *cl,
+	__attribute__((unused)) void *data)
+{
+	struct cmd_bpf_ld_result *res = parsed_result;
+	struct rte_bpf_prm prm;
+	uint32_t flags;
+	int ret;
+
+	if (port_id_is_invalid(res->port, ENABLED_WARN))
+		return;
+
+	memset(&prm, 0, sizeof(prm));
+	prm.xsym = bpf_xsym;
+	prm.nb_xsym = RTE_DIM(bpf_xsym);
+
+	ret = bpf_parse_flags(res->flags, &prm, &flags);
+	if (ret != 0)
+		return;
+
+	if (strcmp(res->dir, "rx") == 0)
+		ret = rte_bpf_eth_rx_elf_load(res->port, res->queue, &prm,
+			res->op, res->prm, flags);
+	else
+		ret = rte_bpf_eth_tx_elf_load(res->port, res->queue, &prm,
+			res->op, res->prm, flags);
+
+	if (ret != 0)
+		printf("Failed to load BPF program on port %u queue %u: %s\n",
+			res->port, res->queue, strerror(-ret));
+}
+
+cmdline_parse_token_string_t cmd_load_bpf_start =
+	TOKEN_STRING_INITIALIZER(struct cmd_bpf_ld_result,
+			bpf, "bpf-load");
+cmdline_parse_token_string_t cmd_load_bpf_dir =
+	TOKEN_STRING_INITIALIZER(struct cmd_bpf_ld_result,
+			dir, "rx#tx");
+cmdline_parse_token_num_t cmd_load_bpf_port =
+	TOKEN_NUM_INITIALIZER(struct cmd_bpf_ld_result, port, UINT16);
+cmdline_parse_token_num_t cmd_load_bpf_queue =
+	TOKEN_NUM_INITIALIZER(struct cmd_bpf_ld_result, queue, UINT16);
+cmdline_parse_token_string_t cmd_load_bpf_flags =
+	TOKEN_STRING_INITIALIZER(struct cmd_bpf_ld_result,
+			flags, NULL);
+cmdline_parse_token_string_t cmd_load_bpf_op =
+	TOKEN_STRING_INITIALIZER(struct cmd_bpf_ld_result,
+			op, NULL);
+cmdline_parse_token_string_t cmd_load_bpf_prm =
+	TOKEN_STRING_INITIALIZER(struct cmd_bpf_ld_result,
+			prm, NULL);
+
+cmdline_parse_inst_t cmd_operate_bpf_ld_parse = {
+	.f = cmd_operate_bpf_ld_parsed,
+	.data = NULL,
+	.help_str = "bpf-load rx|tx <port> <queue> <J|M|-> <file> <section>: "
+		"load an eBPF filter on a queue",
+	.tokens = {
+		(void *)&cmd_load_bpf_start,
+		(void *)&cmd_load_bpf_dir,
+		(void *)&cmd_load_bpf_port,
+		(void *)&cmd_load_bpf_queue,
+		(void *)&cmd_load_bpf_flags,
+		(void *)&cmd_load_bpf_op,
+		(void *)&cmd_load_bpf_prm,
+		NULL,
+	},
+};
+
+/* *** Unload BPF program *** */
+struct cmd_bpf_unld_result {
+	cmdline_fixed_string_t bpf;
+	cmdline_fixed_string_t dir;
+	uint16_t port;
+	uint16_t queue;
+};
+
+static void cmd_operate_bpf_unld_parsed(void *parsed_result,
+	__attribute__((unused)) struct cmdline *cl,
+	__attribute__((unused)) void *data)
+{
+	struct cmd_bpf_unld_result *res = parsed_result;
+
+	if (port_id_is_invalid(res->port, ENABLED_WARN))
+		return;
+
+	if (strcmp(res->dir, "rx") == 0)
+		rte_bpf_eth_rx_unload(res->port, res->queue);
+	else
+		rte_bpf_eth_tx_unload(res->port, res->queue);
+}
+
+cmdline_parse_token_string_t cmd_unload_bpf_start =
+	TOKEN_STRING_INITIALIZER(struct cmd_bpf_unld_result,
+			bpf, "bpf-unload");
+cmdline_parse_token_string_t cmd_unload_bpf_dir =
+	TOKEN_STRING_INITIALIZER(struct cmd_bpf_unld_result,
+			dir, "rx#tx");
+cmdline_parse_token_num_t cmd_unload_bpf_port =
+	TOKEN_NUM_INITIALIZER(struct cmd_bpf_unld_result, port, UINT16);
+cmdline_parse_token_num_t cmd_unload_bpf_queue =
+	TOKEN_NUM_INITIALIZER(struct cmd_bpf_unld_result, queue, UINT16);
+
+cmdline_parse_inst_t cmd_operate_bpf_unld_parse = {
+	.f = cmd_operate_bpf_unld_parsed,
+	.data = NULL,
+	.help_str = "bpf-unload rx|tx <port> <queue>: "
+		"unload the eBPF filter of a queue",
+	.tokens = {
+		(void *)&cmd_unload_bpf_start,
+		(void *)&cmd_unload_bpf_dir,
+		(void *)&cmd_unload_bpf_port,
+		(void *)&cmd_unload_bpf_queue,
+		NULL,
+	},
+};
@@ -60,10 +60,13 @@
 #define ETH_AF_PACKET_FRAMESIZE_ARG	"framesz"
 #define ETH_AF_PACKET_FRAMECOUNT_ARG	"framecnt"
 #define ETH_AF_PACKET_QDISC_BYPASS_ARG	"qdisc_bypass"
+#define ETH_AF_PACKET_TPACKET_V3_ARG	"tpacket_v3"
+#define ETH_AF_PACKET_BLOCK_TMO_ARG	"blocktmo"
 
 #define DFLT_BLOCK_SIZE		(1 << 12)
 #define DFLT_FRAME_SIZE		(1 << 11)
 #define DFLT_FRAME_COUNT	(1 << 9)
+#define DFLT_BLOCK_TMO		1	/* ms */
 
 #define RTE_PMD_AF_PACKET_MAX_RINGS 16
 
@@ -72,9 +75,14 @@ struct pkt_rx_queue {
 
 	struct iovec *rd;
 	uint8_t *map;
+	size_t map_size;
 	unsigned int framecount;
 	unsigned int framenum;
 
+	/* TPACKET_V3: rd/framecount/framenum describe blocks, not frames */
+	struct tpacket3_hdr *ppd3;	/* next packet in current block */
+	unsigned int block_pkts;	/* packets left in current block */
+
 	struct rte_mempool *mb_pool;
 	uint16_t in_port;
 
@@ -89,6 +97,7 @@ struct pkt_tx_queue {
 
 	struct iovec *rd;
 	uint8_t *map;
+	size_t map_size;
 	unsigned int framecount;
 	unsigned int framenum;
 
@@ -105,6 +114,8 @@ struct pmd_internals {
 	struct ether_addr eth_addr;
 
 	struct tpacket_req req;
+	unsigned int tpacket_v3;
+	unsigned int block_tmo;
 
 	struct pkt_rx_queue rx_queue[RTE_PMD_AF_PACKET_MAX_RINGS];
 	struct pkt_tx_queue tx_queue[RTE_PMD_AF_PACKET_MAX_RINGS];
@@ -117,6 +128,8 @@ static const char *valid_arguments[] = {
 	ETH_AF_PACKET_FRAMESIZE_ARG,
 	ETH_AF_PACKET_FRAMECOUNT_ARG,
 	ETH_AF_PACKET_QDISC_BYPASS_ARG,
+	ETH_AF_PACKET_TPACKET_V3_ARG,
+	ETH_AF_PACKET_BLOCK_TMO_ARG,
 	NULL
 };
 
@@ -187,6 +200,95 @@ eth_af_packet_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	return num_rx;
 }
 
+/*
+ * TPACKET_V3 variant: the kernel fills whole blocks with variable sized
+ * frames and hands them over once full or once the block retire timeout
+ * expires, so a single status check covers many packets.
+ */
+static uint16_t
+eth_af_packet_rx_v3(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	unsigned i;
+	struct tpacket_block_desc *pbd;
+	struct tpacket3_hdr *ppd;
+	struct rte_mbuf *mbuf;
+	uint8_t *pbuf;
+	struct pkt_rx_queue *pkt_q = queue;
+	uint16_t num_rx = 0;
+	unsigned long num_rx_bytes = 0;
+	unsigned int blockcount, blocknum, block_pkts;
+
+	if (unlikely(nb_pkts == 0))
+		return 0;
+
+	blockcount = pkt_q->framecount;
+	blocknum = pkt_q->framenum;
+	block_pkts = pkt_q->block_pkts;
+	ppd = pkt_q->ppd3;
+	pbd = (struct tpacket_block_desc *) pkt_q->rd[blocknum].iov_base;
+	for (i = 0; i < nb_pkts; ) {
+		if (block_pkts == 0) {
+			/* wait for the kernel to retire the current block */
+			if ((pbd->hdr.bh1.block_status & TP_STATUS_USER) == 0)
+				break;
+			rte_smp_rmb();
+			block_pkts = pbd->hdr.bh1.num_pkts;
+			ppd = (struct tpacket3_hdr *) ((uint8_t *) pbd +
+				pbd->hdr.bh1.offset_to_first_pkt);
+			if (unlikely(block_pkts == 0))
+				goto release_block;
+		}
+
+		/* allocate the next mbuf */
+		mbuf = rte_pktmbuf_alloc(pkt_q->mb_pool);
+		if (unlikely(mbuf == NULL))
+			break;
+
+		/* frames may be larger than the mbuf as only blocks are sized */
+		if (unlikely(ppd->tp_snaplen > rte_pktmbuf_tailroom(mbuf))) {
+			rte_pktmbuf_free(mbuf);
+			pkt_q->err_pkts++;
+		} else {
+			rte_pktmbuf_pkt_len(mbuf) = rte_pktmbuf_data_len(mbuf) =
+				ppd->tp_snaplen;
+			pbuf = (uint8_t *) ppd + ppd->tp_mac;
+			memcpy(rte_pktmbuf_mtod(mbuf, void *), pbuf,
+			       rte_pktmbuf_data_len(mbuf));
+
+			/* check for vlan info */
+			if (ppd->tp_status & TP_STATUS_VLAN_VALID) {
+				mbuf->vlan_tci = ppd->hv1.tp_vlan_tci;
+				mbuf->ol_flags |=
+					(PKT_RX_VLAN | PKT_RX_VLAN_STRIPPED);
+			}
+			mbuf->port = pkt_q->in_port;
+
+			/* account for the receive frame */
+			bufs[i++] = mbuf;
+			num_rx++;
+			num_rx_bytes += mbuf->pkt_len;
+		}
+
+		ppd = (struct tpacket3_hdr *) ((uint8_t *) ppd +
+					       ppd->tp_next_offset);
+		if (--block_pkts)
+			continue;
+release_block:
+		/* release the whole block and advance ring buffer */
+		rte_smp_wmb();
+		pbd->hdr.bh1.block_status = TP_STATUS_KERNEL;
+		if (++blocknum >= blockcount)
+			blocknum = 0;
+		pbd = (struct tpacket_block_desc *) pkt_q->rd[blocknum].iov_base;
+	}
+	pkt_q->framenum = blocknum;
+	pkt_q->block_pkts = block_pkts;
+	pkt_q->ppd3 = ppd;
+	pkt_q->rx_pkts += num_rx;
+	pkt_q->rx_bytes += num_rx_bytes;
+	return num_rx;
+}
+
 /*
  * Callback to handle sending packets through a real NIC.
  */
@@ -262,8 +364,9 @@ eth_af_packet_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		rte_pktmbuf_free(mbuf);
 	}
 
-	/* kick-off transmits */
-	if (sendto(pkt_q->sockfd, NULL, 0, MSG_DONTWAIT, NULL, 0) == -1) {
+	/* kick-off transmits, once for the whole burst */
+	if (num_tx > 0 &&
+	    sendto(pkt_q->sockfd, NULL, 0, MSG_DONTWAIT, NULL, 0) == -1) {
 		/* error sending -- no packets transmitted */
 		num_tx = 0;
 		num_tx_bytes = 0;
@@ -337,6 +440,7 @@ eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *igb_stats)
 	unsigned i, imax;
 	unsigned long rx_total = 0, tx_total = 0, tx_err_total = 0;
 	unsigned long rx_bytes_total = 0, tx_bytes_total = 0;
+	unsigned long rx_err_total = 0;
 	const struct pmd_internals *internal = dev->data->dev_private;
 
 	imax = (internal->nb_queues < RTE_ETHDEV_QUEUE_STAT_CNTRS ?
@@ -346,6 +450,7 @@ eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *igb_stats)
 		igb_stats->q_ibytes[i] = internal->rx_queue[i].rx_bytes;
 		rx_total += igb_stats->q_ipackets[i];
 		rx_bytes_total += igb_stats->q_ibytes[i];
+		rx_err_total += internal->rx_queue[i].err_pkts;
 	}
 
 	imax = (internal->nb_queues < RTE_ETHDEV_QUEUE_STAT_CNTRS ?
@@ -361,6 +466,7 @@ eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *igb_stats)
 
 	igb_stats->ipackets = rx_total;
 	igb_stats->ibytes = rx_bytes_total;
+	igb_stats->ierrors = rx_err_total;
 	igb_stats->opackets = tx_total;
 	igb_stats->oerrors = tx_err_total;
 	igb_stats->obytes = tx_bytes_total;
@@ -376,6 +482,7 @@ eth_stats_reset(struct rte_eth_dev *dev)
 	for (i = 0; i < internal->nb_queues; i++) {
 		internal->rx_queue[i].rx_pkts = 0;
 		internal->rx_queue[i].rx_bytes = 0;
+		internal->rx_queue[i].err_pkts = 0;
 	}
 
 	for (i = 0; i < internal->nb_queues; i++) {
@@ -563,6 +670,8 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
                        unsigned int framesize,
                        unsigned int framecnt,
 		       unsigned int qdisc_bypass,
+		       unsigned int tpacket_v3,
+		       unsigned int block_tmo,
                        struct pmd_internals **internals,
                        struct rte_eth_dev **eth_dev,
                        struct rte_kvargs *kvlist)
@@ -576,11 +685,14 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 	unsigned k_idx;
 	struct sockaddr_ll sockaddr;
 	struct tpacket_req *req;
+	struct tpacket_req3 req3;
 	struct pkt_rx_queue *rx_queue;
 	struct pkt_tx_queue *tx_queue;
 	int rc, tpver, discard;
 	int qsockfd = -1;
+	int txsockfd = -1;
 	unsigned int i, q, rdsize;
+	size_t ring_size;
 #if defined(PACKET_FANOUT)
 	int fanout_arg;
 #endif
@@ -625,6 +737,16 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 	req->tp_block_nr = blockcnt;
 	req->tp_frame_size = framesize;
 	req->tp_frame_nr = framecnt;
+	ring_size = (size_t)req->tp_block_size * req->tp_block_nr;
+
+	memset(&req3, 0, sizeof(req3));
+	req3.tp_block_size = blocksize;
+	req3.tp_block_nr = blockcnt;
+	req3.tp_frame_size = framesize;
+	req3.tp_frame_nr = framecnt;
+	req3.tp_retire_blk_tov = block_tmo;
+	(*internals)->tpacket_v3 = tpacket_v3;
+	(*internals)->block_tmo = block_tmo;
 
 	ifnamelen = strlen(pair->value);
 	if (ifnamelen < sizeof(ifr.ifr_name)) {
@@ -669,16 +791,35 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 #endif
 
 	for (q = 0; q < nb_queues; q++) {
+		txsockfd = -1;
+
 		/* Open an AF_PACKET socket for this queue... */
 		qsockfd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
 		if (qsockfd == -1) {
 			RTE_LOG(ERR, PMD,
 			        "%s: could not open AF_PACKET socket\n",
 			        name);
-			return -1;
+			goto error;
 		}
 
-		tpver = TPACKET_V2;
+		/*
+		 * The ring version is per socket and TPACKET_V3 is meant for
+		 * Rx only: in this mode, Tx goes through a second socket
+		 * bound to no protocol so that it never receives anything.
+		 */
+		if (tpacket_v3) {
+			txsockfd = socket(AF_PACKET, SOCK_RAW, 0);
+			if (txsockfd == -1) {
+				RTE_LOG(ERR, PMD,
+					"%s: could not open AF_PACKET socket\n",
+					name);
+				goto error;
+			}
+		} else {
+			txsockfd = qsockfd;
+		}
+
+		tpver = tpacket_v3 ? TPACKET_V3 : TPACKET_V2;
 		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_VERSION,
 				&tpver, sizeof(tpver));
 		if (rc == -1) {
@@ -687,9 +828,21 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 				"socket for %s\n", name, pair->value);
 			goto error;
 		}
+		if (txsockfd != qsockfd) {
+			tpver = TPACKET_V2;
+			rc = setsockopt(txsockfd, SOL_PACKET, PACKET_VERSION,
+					&tpver, sizeof(tpver));
+			if (rc == -1) {
+				RTE_LOG(ERR, PMD,
+					"%s: could not set PACKET_VERSION on "
+					"AF_PACKET socket for %s\n",
+					name, pair->value);
+				goto error;
+			}
+		}
 
 		discard = 1;
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_LOSS,
+		rc = setsockopt(txsockfd, SOL_PACKET, PACKET_LOSS,
 				&discard, sizeof(discard));
 		if (rc == -1) {
 			RTE_LOG(ERR, PMD,
@@ -699,7 +852,7 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 		}
 
 #if defined(PACKET_QDISC_BYPASS)
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_QDISC_BYPASS,
+		rc = setsockopt(txsockfd, SOL_PACKET, PACKET_QDISC_BYPASS,
 				&qdisc_bypass, sizeof(qdisc_bypass));
 		if (rc == -1) {
 			RTE_LOG(ERR, PMD,
@@ -712,7 +865,12 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 		RTE_SET_USED(qdisc_bypass);
 #endif
 
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_RX_RING, req, sizeof(*req));
+		if (tpacket_v3)
+			rc = setsockopt(qsockfd, SOL_PACKET, PACKET_RX_RING,
+					&req3, sizeof(req3));
+		else
+			rc = setsockopt(qsockfd, SOL_PACKET, PACKET_RX_RING,
+					req, sizeof(*req));
 		if (rc == -1) {
 			RTE_LOG(ERR, PMD,
 				"%s: could not set PACKET_RX_RING on AF_PACKET "
@@ -720,7 +878,7 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 			goto error;
 		}
 
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_TX_RING, req, sizeof(*req));
+		rc = setsockopt(txsockfd, SOL_PACKET, PACKET_TX_RING, req, sizeof(*req));
 		if (rc == -1) {
 			RTE_LOG(ERR, PMD,
 				"%s: could not set PACKET_TX_RING on AF_PACKET "
@@ -729,9 +887,13 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 		}
 
 		rx_queue = &((*internals)->rx_queue[q]);
-		rx_queue->framecount = req->tp_frame_nr;
+		tx_queue = &((*internals)->tx_queue[q]);
 
-		rx_queue->map = mmap(NULL, 2 * req->tp_block_size * req->tp_block_nr,
+		/* a single mapping covers both rings of a shared socket */
+		rx_queue->map_size = ring_size;
+		if (txsockfd == qsockfd)
+			rx_queue->map_size += ring_size;
+		rx_queue->map = mmap(NULL, rx_queue->map_size,
 				    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED,
 				    qsockfd, 0);
 		if (rx_queue->map == MAP_FAILED) {
@@ -741,26 +903,56 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 			goto error;
 		}
 
-		/* rdsize is same for both Tx and Rx */
-		rdsize = req->tp_frame_nr * sizeof(*(rx_queue->rd));
+		if (txsockfd == qsockfd) {
+			tx_queue->map = rx_queue->map + ring_size;
+		} else {
+			tx_queue->map_size = ring_size;
+			tx_queue->map = mmap(NULL, tx_queue->map_size,
+					     PROT_READ | PROT_WRITE,
+					     MAP_SHARED | MAP_LOCKED,
+					     txsockfd, 0);
+			if (tx_queue->map == MAP_FAILED) {
+				RTE_LOG(ERR, PMD,
+					"%s: call to mmap failed on AF_PACKET "
+					"socket for %s\n", name, pair->value);
+				goto error;
+			}
+		}
 
-		rx_queue->rd = rte_zmalloc_socket(name, rdsize, 0, numa_node);
-		if (rx_queue->rd == NULL)
-			goto error;
-		for (i = 0; i < req->tp_frame_nr; ++i) {
-			rx_queue->rd[i].iov_base = rx_queue->map + (i * framesize);
-			rx_queue->rd[i].iov_len = req->tp_frame_size;
+		if (tpacket_v3) {
+			/* Rx descriptors point to blocks */
+			rdsize = req->tp_block_nr * sizeof(*(rx_queue->rd));
+			rx_queue->rd = rte_zmalloc_socket(name, rdsize, 0,
+							  numa_node);
+			if (rx_queue->rd == NULL)
+				goto error;
+			for (i = 0; i < req->tp_block_nr; ++i) {
+				rx_queue->rd[i].iov_base = rx_queue->map +
+					(i * req->tp_block_size);
+				rx_queue->rd[i].iov_len = req->tp_block_size;
+			}
+			rx_queue->framecount = req->tp_block_nr;
+		} else {
+			rdsize = req->tp_frame_nr * sizeof(*(rx_queue->rd));
+			rx_queue->rd = rte_zmalloc_socket(name, rdsize, 0,
+							  numa_node);
+			if (rx_queue->rd == NULL)
+				goto error;
+			for (i = 0; i < req->tp_frame_nr; ++i) {
+				rx_queue->rd[i].iov_base = rx_queue->map +
+					(i * framesize);
+				rx_queue->rd[i].iov_len = req->tp_frame_size;
+			}
+			rx_queue->framecount = req->tp_frame_nr;
 		}
 		rx_queue->sockfd = qsockfd;
 
-		tx_queue = &((*internals)->tx_queue[q]);
 		tx_queue->framecount = req->tp_frame_nr;
 		tx_queue->frame_data_size = req->tp_frame_size;
 		tx_queue->frame_data_size -= TPACKET2_HDRLEN -
 			sizeof(struct sockaddr_ll);
 
-		tx_queue->map = rx_queue->map + req->tp_block_size * req->tp_block_nr;
-
+		rdsize = req->tp_frame_nr * sizeof(*(tx_queue->rd));
 		tx_queue->rd = rte_zmalloc_socket(name, rdsize, 0, numa_node);
 		if (tx_queue->rd == NULL)
 			goto error;
@@ -768,7 +960,7 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 			tx_queue->rd[i].iov_base = tx_queue->map + (i * framesize);
 			tx_queue->rd[i].iov_len = req->tp_frame_size;
 		}
-		tx_queue->sockfd = qsockfd;
+		tx_queue->sockfd = txsockfd;
 
 		rc = bind(qsockfd, (const struct sockaddr*)&sockaddr, sizeof(sockaddr));
 		if (rc == -1) {
@@ -777,6 +969,20 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 			        name, pair->value);
 			goto error;
 		}
+		if (txsockfd != qsockfd) {
+			struct sockaddr_ll tx_sockaddr = sockaddr;
+
+			tx_sockaddr.sll_protocol = 0;
+			rc = bind(txsockfd,
+				  (const struct sockaddr *)&tx_sockaddr,
+				  sizeof(tx_sockaddr));
+			if (rc == -1) {
+				RTE_LOG(ERR, PMD,
+					"%s: could not bind AF_PACKET socket "
+					"to %s\n", name, pair->value);
+				goto error;
+			}
+		}
 
 #if defined(PACKET_FANOUT)
 		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_FANOUT,
@@ -820,15 +1026,27 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 error:
 	if (qsockfd != -1)
 		close(qsockfd);
+	if (txsockfd != -1 && txsockfd != qsockfd)
+		close(txsockfd);
 	for (q = 0; q < nb_queues; q++) {
-		munmap((*internals)->rx_queue[q].map,
-		       2 * req->tp_block_size * req->tp_block_nr);
+		if ((*internals)->rx_queue[q].map != MAP_FAILED)
+			munmap((*internals)->rx_queue[q].map,
+			       (*internals)->rx_queue[q].map_size);
+		if ((*internals)->tx_queue[q].map != MAP_FAILED &&
+		    (*internals)->tx_queue[q].map_size)
+			munmap((*internals)->tx_queue[q].map,
+			       (*internals)->tx_queue[q].map_size);
 
 		rte_free((*internals)->rx_queue[q].rd);
 		rte_free((*internals)->tx_queue[q].rd);
 		if (((*internals)->rx_queue[q].sockfd != 0) &&
 			((*internals)->rx_queue[q].sockfd != qsockfd))
 			close((*internals)->rx_queue[q].sockfd);
+		if (((*internals)->tx_queue[q].sockfd != 0) &&
+		    ((*internals)->tx_queue[q].sockfd !=
+		     (*internals)->rx_queue[q].sockfd) &&
+		    ((*internals)->tx_queue[q].sockfd != txsockfd))
+			close((*internals)->tx_queue[q].sockfd);
 	}
 	free((*internals)->if_name);
 	rte_free(*internals);
@@ -853,6 +1071,8 @@ rte_eth_from_packet(struct rte_vdev_device *dev,
 	unsigned int framecount = DFLT_FRAME_COUNT;
 	unsigned int qpairs = 1;
 	unsigned int qdisc_bypass = 1;
+	unsigned int tpacket_v3 = 0;
+	unsigned int block_tmo = DFLT_BLOCK_TMO;
 
 	/* do some parameter checking */
 	if (*sockfd < 0)
@@ -914,6 +1134,26 @@ rte_eth_from_packet(struct rte_vdev_device *dev,
 			}
 			continue;
 		}
+		if (strstr(pair->key, ETH_AF_PACKET_TPACKET_V3_ARG) != NULL) {
+			tpacket_v3 = atoi(pair->value);
+			if (tpacket_v3 > 1) {
+				RTE_LOG(ERR, PMD,
+					"%s: invalid tpacket_v3 value\n",
+					name);
+				return -1;
+			}
+			continue;
+		}
+		if (strstr(pair->key, ETH_AF_PACKET_BLOCK_TMO_ARG) != NULL) {
+			block_tmo = atoi(pair->value);
+			if (!block_tmo) {
+				RTE_LOG(ERR, PMD,
+					"%s: invalid block timeout value\n",
+					name);
+				return -1;
+			}
+			continue;
+		}
 	}
 
 	if (framesize > blocksize) {
@@ -935,16 +1175,21 @@ rte_eth_from_packet(struct rte_vdev_device *dev,
 	RTE_LOG(INFO, PMD, "%s:\tblock count %d\n", name, blockcount);
 	RTE_LOG(INFO, PMD, "%s:\tframe size %d\n", name, framesize);
 	RTE_LOG(INFO, PMD, "%s:\tframe count %d\n", name, framecount);
+	if (tpacket_v3)
+		RTE_LOG(INFO, PMD, "%s:\tTPACKET_V3 Rx, block timeout %u ms\n",
+			name, block_tmo);
 
 	if (rte_pmd_init_internals(dev, *sockfd, qpairs,
 				   blocksize, blockcount,
 				   framesize, framecount,
 				   qdisc_bypass,
+				   tpacket_v3, block_tmo,
 				   &internals, &eth_dev,
 				   kvlist) < 0)
 		return -1;
 
-	eth_dev->rx_pkt_burst = eth_af_packet_rx;
+	eth_dev->rx_pkt_burst = tpacket_v3 ? eth_af_packet_rx_v3 :
+		eth_af_packet_rx;
 	eth_dev->tx_pkt_burst = eth_af_packet_tx;
 
 	return 0;
@@ -1035,4 +1280,6 @@ RTE_PMD_REGISTER_PARAM_STRING(net_af_packet,
 	"blocksz=<int> "
 	"framesz=<int> "
 	"framecnt=<int> "
-	"qdisc_bypass=<0|1>");
+	"qdisc_bypass=<0|1> "
+	"tpacket_v3=<0|1> "
+	"blocktmo=<int>");
@@ -0,0 +1,1370 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <rte_mbuf.h>
+#include <rte_ethdev.h>
+#include <rte_ethdev_vdev.h>
+#include <rte_malloc.h>
+#include <rte_memzone.h>
+#include <rte_kvargs.h>
+#include <rte_bus_vdev.h>
+#include <rte_spinlock.h>
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <net/if.h>
+#include <linux/if_ether.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <linux/bpf.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#ifndef AF_XDP
+#define AF_XDP			44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP			283
+#endif
+/* headroom reserved by the kernel in front of every received frame */
+#define XDP_PACKET_HEADROOM	256
+
+#define ETH_AF_XDP_IFACE_ARG		"iface"
+#define ETH_AF_XDP_START_QUEUE_ARG	"start_queue"
+#define ETH_AF_XDP_QUEUE_COUNT_ARG	"queue_count"
+#define ETH_AF_XDP_FRAME_SIZE_ARG	"framesz"
+#define ETH_AF_XDP_FRAME_COUNT_ARG	"framecnt"
+#define ETH_AF_XDP_XDP_MODE_ARG		"xdp_mode"
+#define ETH_AF_XDP_BUSY_POLL_ARG	"busy_poll"
+
+#define ETH_AF_XDP_XDP_MODE_SKB		"skb"
+#define ETH_AF_XDP_XDP_MODE_DRV		"drv"
+
+#define DFLT_FRAME_SIZE		(1 << 11)
+#define DFLT_FRAME_COUNT	(1 << 13)
+#define DFLT_RING_SIZE		(1 << 11)
+#define DFLT_FILL_RING_SIZE	(DFLT_RING_SIZE * 2)
+
+#define ETH_AF_XDP_BATCH	32
+
+#define RTE_PMD_AF_XDP_MAX_QUEUES 16
+
+/* Single producer or single consumer ring shared with the kernel */
+struct xdp_ring {
+	uint32_t cached_prod;
+	uint32_t cached_cons;
+	uint32_t mask;
+	uint32_t size;
+	volatile uint32_t *producer;
+	volatile uint32_t *consumer;
+	volatile uint32_t *flags;
+	void *ring;
+	void *map;
+	size_t map_size;
+};
+
+/*
+ * The UMEM is the memory area of a mempool whose elements are each exactly
+ * one chunk: the kernel writes received frames directly into mbuf data
+ * rooms and transmits from them.
+ */
+struct xdp_umem {
+	const struct rte_memzone *mz;
+	struct rte_mempool *mb_pool;
+	uint8_t *buffer;
+	uint32_t frame_size;
+	uint32_t hdr_size;		/* mempool object header size */
+	struct xdp_ring fq;		/* fill ring */
+	struct xdp_ring cq;		/* completion ring */
+	rte_spinlock_t cq_lock;		/* Rx and Tx may both reap the cq */
+};
+
+struct pkt_rx_queue {
+	int sockfd;
+	struct xdp_ring rx;
+	struct xdp_umem *umem;
+	uint16_t in_port;
+	uint32_t busy_poll;
+	int need_wakeup;		/* bound with XDP_USE_NEED_WAKEUP */
+	uint32_t fill_deficit;		/* buffers owed to the fill ring */
+	uint32_t nb_desc;
+	unsigned int socket_id;
+
+	volatile unsigned long rx_pkts;
+	volatile unsigned long rx_bytes;
+	volatile unsigned long rx_nombuf;
+};
+
+struct pkt_tx_queue {
+	struct xdp_ring tx;
+	struct pkt_rx_queue *pair;
+	uint32_t nb_desc;
+
+	volatile unsigned long tx_pkts;
+	volatile unsigned long tx_bytes;
+};
+
+struct pmd_internals {
+	int if_index;
+	char if_name[IFNAMSIZ];
+	struct ether_addr eth_addr;
+	uint16_t start_queue;
+	uint16_t queue_count;
+	uint32_t frame_size;
+	uint32_t frame_count;
+	uint32_t hdr_size;		/* mempool object header size */
+	uint32_t xdp_flags;
+	uint32_t busy_poll;
+	int prog_fd;
+	int map_fd;
+
+	struct pkt_rx_queue rx_queues[RTE_PMD_AF_XDP_MAX_QUEUES];
+	struct pkt_tx_queue tx_queues[RTE_PMD_AF_XDP_MAX_QUEUES];
+};
+
+static const char *valid_arguments[] = {
+	ETH_AF_XDP_IFACE_ARG,
+	ETH_AF_XDP_START_QUEUE_ARG,
+	ETH_AF_XDP_QUEUE_COUNT_ARG,
+	ETH_AF_XDP_FRAME_SIZE_ARG,
+	ETH_AF_XDP_FRAME_COUNT_ARG,
+	ETH_AF_XDP_XDP_MODE_ARG,
+	ETH_AF_XDP_BUSY_POLL_ARG,
+	NULL
+};
+
+static struct rte_eth_link pmd_link = {
+	.link_speed = ETH_SPEED_NUM_10G,
+	.link_duplex = ETH_LINK_FULL_DUPLEX,
+	.link_status = ETH_LINK_DOWN,
+	.link_autoneg = ETH_LINK_FIXED,
+};
+
+/* Number of entries the kernel has produced and we did not consume yet */
+static inline uint32_t
+xdp_ring_cons_avail(struct xdp_ring *r, uint32_t nb)
+{
+	uint32_t entries = r->cached_prod - r->cached_cons;
+
+	if (entries == 0) {
+		r->cached_prod = *r->producer;
+		rte_smp_rmb();
+		entries = r->cached_prod - r->cached_cons;
+	}
+	return RTE_MIN(entries, nb);
+}
+
+static inline void
+xdp_ring_cons_release(struct xdp_ring *r, uint32_t nb)
+{
+	rte_smp_mb();
+	r->cached_cons += nb;
+	*r->consumer = r->cached_cons;
+}
+
+/* Number of free entries we can produce for the kernel */
+static inline uint32_t
+xdp_ring_prod_free(struct xdp_ring *r, uint32_t nb)
+{
+	uint32_t free_entries = r->cached_cons - r->cached_prod;
+
+	if (free_entries < nb) {
+		/* cached_cons is kept one ring size ahead of the consumer */
+		r->cached_cons = *r->consumer + r->size;
+		free_entries = r->cached_cons - r->cached_prod;
+	}
+	return RTE_MIN(free_entries, nb);
+}
+
+static inline void
+xdp_ring_prod_submit(struct xdp_ring *r, uint32_t nb)
+{
+	rte_smp_wmb();
+	r->cached_prod += nb;
+	*r->producer = r->cached_prod;
+}
+
+static inline uint64_t *
+xdp_ring_addr(struct xdp_ring *r, uint32_t idx)
+{
+	return &((uint64_t *)r->ring)[idx & r->mask];
+}
+
+static inline struct xdp_desc *
+xdp_ring_desc(struct xdp_ring *r, uint32_t idx)
+{
+	return &((struct xdp_desc *)r->ring)[idx & r->mask];
+}
+
+/* UMEM offset of the chunk holding an mbuf, as given to the fill ring */
+static inline uint64_t
+umem_mbuf_to_addr(const struct xdp_umem *umem, const struct rte_mbuf *mbuf)
+{
+	return (uint64_t)((const uint8_t *)mbuf - umem->buffer) -
+		umem->hdr_size;
+}
+
+/* mbuf owning any UMEM offset, chunks being aligned on frame_size */
+static inline struct rte_mbuf *
+umem_addr_to_mbuf(const struct xdp_umem *umem, uint64_t addr)
+{
+	addr &= ~((uint64_t)umem->frame_size - 1);
+	return (struct rte_mbuf *)(umem->buffer + addr + umem->hdr_size);
+}
+
+static inline uint64_t
+umem_mbuf_data_addr(const struct xdp_umem *umem, const struct rte_mbuf *mbuf)
+{
+	return (uint64_t)(rte_pktmbuf_mtod(mbuf, const uint8_t *) -
+			  umem->buffer);
+}
+
+static uint32_t
+umem_fill(struct xdp_umem *umem, uint32_t nb)
+{
+	struct rte_mbuf *mbufs[ETH_AF_XDP_BATCH];
+	uint32_t i, n, done = 0;
+
+	while (done < nb) {
+		n = RTE_MIN(nb - done, (uint32_t)ETH_AF_XDP_BATCH);
+		n = xdp_ring_prod_free(&umem->fq, n);
+		if (n == 0)
+			break;
+		if (rte_pktmbuf_alloc_bulk(umem->mb_pool, mbufs, n) != 0)
+			break;
+		for (i = 0; i < n; i++)
+			*xdp_ring_addr(&umem->fq, umem->fq.cached_prod + i) =
+				umem_mbuf_to_addr(umem, mbufs[i]);
+		xdp_ring_prod_submit(&umem->fq, n);
+		done += n;
+	}
+	return done;
+}
+
+/* Release the mbufs of frames the kernel has finished transmitting */
+static void
+eth_af_xdp_tx_complete(struct xdp_umem *umem)
+{
+	struct xdp_ring *cq = &umem->cq;
+	uint32_t i, n;
+
+	n = xdp_ring_cons_avail(cq, cq->size);
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free(umem_addr_to_mbuf(umem,
+				*xdp_ring_addr(cq, cq->cached_cons + i)));
+	if (n)
+		xdp_ring_cons_release(cq, n);
+}
+
+/*
+ * Received mbufs sent back zero-copy only return to the UMEM pool once
+ * completed: when the pool runs dry, reap completions from the Rx side too,
+ * or Rx could starve waiting for a Tx burst that never comes.
+ */
+static uint32_t
+umem_refill(struct xdp_umem *umem, uint32_t nb)
+{
+	uint32_t n = umem_fill(umem, nb);
+
+	if (unlikely(n < nb) && rte_spinlock_trylock(&umem->cq_lock)) {
+		eth_af_xdp_tx_complete(umem);
+		rte_spinlock_unlock(&umem->cq_lock);
+		n += umem_fill(umem, nb - n);
+	}
+	return n;
+}
+
+static uint16_t
+eth_af_xdp_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct pkt_rx_queue *rxq = queue;
+	struct xdp_umem *umem = rxq->umem;
+	struct xdp_ring *rx = &rxq->rx;
+	unsigned long num_rx_bytes = 0;
+	uint32_t i, nb_rx;
+
+	nb_rx = xdp_ring_cons_avail(rx, nb_pkts);
+	if (nb_rx == 0) {
+		if (unlikely(rxq->fill_deficit))
+			rxq->fill_deficit -= umem_refill(umem,
+							 rxq->fill_deficit);
+		/* drive the driver NAPI context from this lcore */
+		if (rxq->busy_poll || (rxq->need_wakeup &&
+		    (*umem->fq.flags & XDP_RING_NEED_WAKEUP)))
+			recvfrom(rxq->sockfd, NULL, 0, MSG_DONTWAIT, NULL, NULL);
+		return 0;
+	}
+
+	for (i = 0; i < nb_rx; i++) {
+		const struct xdp_desc *desc =
+			xdp_ring_desc(rx, rx->cached_cons + i);
+		struct rte_mbuf *mbuf = umem_addr_to_mbuf(umem, desc->addr);
+
+		mbuf->data_off = (umem->buffer + desc->addr) -
+			(uint8_t *)mbuf->buf_addr;
+		rte_pktmbuf_pkt_len(mbuf) = desc->len;
+		rte_pktmbuf_data_len(mbuf) = desc->len;
+		mbuf->port = rxq->in_port;
+		bufs[i] = mbuf;
+		num_rx_bytes += desc->len;
+	}
+	xdp_ring_cons_release(rx, nb_rx);
+
+	/* give the kernel as many buffers as it handed over */
+	rxq->fill_deficit += nb_rx;
+	rxq->fill_deficit -= umem_refill(umem, rxq->fill_deficit);
+	if (unlikely(rxq->fill_deficit))
+		rxq->rx_nombuf++;
+
+	rxq->rx_pkts += nb_rx;
+	rxq->rx_bytes += num_rx_bytes;
+	return nb_rx;
+}
+
+/*
+ * Return an mbuf whose data lies in the UMEM: the packet itself when it
+ * belongs to the UMEM mempool and is not shared, otherwise a copy.
+ */
+static struct rte_mbuf *
+eth_af_xdp_tx_prepare(struct xdp_umem *umem, struct rte_mbuf *mbuf)
+{
+	struct rte_mbuf *umbuf;
+	struct rte_mbuf *seg;
+	uint8_t *dst;
+
+	if (mbuf->pool == umem->mb_pool && mbuf->nb_segs == 1 &&
+	    RTE_MBUF_DIRECT(mbuf) && rte_mbuf_refcnt_read(mbuf) == 1)
+		return mbuf;
+
+	umbuf = rte_pktmbuf_alloc(umem->mb_pool);
+	if (unlikely(umbuf == NULL))
+		return NULL;
+	dst = (uint8_t *)rte_pktmbuf_append(umbuf, mbuf->pkt_len);
+	if (unlikely(dst == NULL)) {
+		rte_pktmbuf_free(umbuf);
+		return NULL;
+	}
+	for (seg = mbuf; seg != NULL; seg = seg->next) {
+		rte_memcpy(dst, rte_pktmbuf_mtod(seg, void *), seg->data_len);
+		dst += seg->data_len;
+	}
+	rte_pktmbuf_free(mbuf);
+	return umbuf;
+}
+
+static uint16_t
+eth_af_xdp_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct pkt_tx_queue *txq = queue;
+	struct pkt_rx_queue *rxq = txq->pair;
+	struct xdp_umem *umem = rxq->umem;
+	struct xdp_ring *tx = &txq->tx;
+	unsigned long num_tx_bytes = 0;
+	uint32_t i, n;
+
+	rte_spinlock_lock(&umem->cq_lock);
+	eth_af_xdp_tx_complete(umem);
+	rte_spinlock_unlock(&umem->cq_lock);
+
+	n = xdp_ring_prod_free(tx, nb_pkts);
+	for (i = 0; i < n; i++) {
+		struct xdp_desc *desc = xdp_ring_desc(tx, tx->cached_prod + i);
+		struct rte_mbuf *mbuf;
+		uint32_t len = bufs[i]->pkt_len;
+
+		mbuf = eth_af_xdp_tx_prepare(umem, bufs[i]);
+		if (unlikely(mbuf == NULL))
+			break;
+		desc->addr = umem_mbuf_data_addr(umem, mbuf);
+		desc->len = len;
+		desc->options = 0;
+		num_tx_bytes += len;
+	}
+	if (i)
+		xdp_ring_prod_submit(tx, i);
+
+	/* without need_wakeup support, every burst needs a kick */
+	if (i && (!rxq->need_wakeup || (*tx->flags & XDP_RING_NEED_WAKEUP)))
+		sendto(rxq->sockfd, NULL, 0, MSG_DONTWAIT, NULL, 0);
+
+	txq->tx_pkts += i;
+	txq->tx_bytes += num_tx_bytes;
+	return i;
+}
+
+static int
+sys_bpf(enum bpf_cmd cmd, union bpf_attr *attr)
+{
+	return syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+/* XSKMAP holding one socket per redirected queue, keyed by queue index */
+static int
+xdp_map_create(struct pmd_internals *internals)
+{
+	union bpf_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.map_type = BPF_MAP_TYPE_XSKMAP;
+	attr.key_size = sizeof(int);
+	attr.value_size = sizeof(int);
+	attr.max_entries = internals->start_queue + internals->queue_count;
+	return sys_bpf(BPF_MAP_CREATE, &attr);
+}
+
+/*
+ * Equivalent of:
+ *	return bpf_redirect_map(&xsks_map, ctx->rx_queue_index, XDP_PASS);
+ * Frames of queues without a socket in the map go to the kernel stack.
+ */
+static int
+xdp_prog_load(int map_fd)
+{
+	struct bpf_insn insns[] = {
+		{
+			.code = BPF_LDX | BPF_MEM | BPF_W,
+			.dst_reg = BPF_REG_2,
+			.src_reg = BPF_REG_1,
+			.off = offsetof(struct xdp_md, rx_queue_index),
+		},
+		{
+			.code = BPF_LD | BPF_DW | BPF_IMM,
+			.dst_reg = BPF_REG_1,
+			.src_reg = BPF_PSEUDO_MAP_FD,
+			.imm = map_fd,
+		},
+		{ .code = 0 },	/* second half of the 64-bit immediate */
+		{
+			.code = BPF_ALU64 | BPF_MOV | BPF_K,
+			.dst_reg = BPF_REG_3,
+			.imm = XDP_PASS,
+		},
+		{
+			.code = BPF_JMP | BPF_CALL,
+			.imm = BPF_FUNC_redirect_map,
+		},
+		{
+			.code = BPF_JMP | BPF_EXIT,
+		},
+	};
+	union bpf_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.prog_type = BPF_PROG_TYPE_XDP;
+	attr.insn_cnt = RTE_DIM(insns);
+	attr.insns = (uint64_t)(uintptr_t)insns;
+	attr.license = (uint64_t)(uintptr_t)"BSD";
+	return sys_bpf(BPF_PROG_LOAD, &attr);
+}
+
+static int
+xdp_map_update(int map_fd, int key, int sockfd)
+{
+	union bpf_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.map_fd = map_fd;
+	attr.key = (uint64_t)(uintptr_t)&key;
+	attr.value = (uint64_t)(uintptr_t)&sockfd;
+	attr.flags = BPF_ANY;
+	return sys_bpf(BPF_MAP_UPDATE_ELEM, &attr);
+}
+
+/* Attach (prog_fd >= 0) or detach (prog_fd == -1) the XDP program */
+static int
+xdp_link_set(int if_index, int prog_fd, uint32_t flags)
+{
+	struct {
+		struct nlmsghdr nh;
+		struct ifinfomsg ifinfo;
+		char attrbuf[64];
+	} req;
+	struct {
+		struct nlmsghdr nh;
+		struct nlmsgerr err;
+	} ack;
+	struct sockaddr_nl sa = { .nl_family = AF_NETLINK };
+	struct nlattr *nla, *nla_xdp;
+	int sockfd, ret;
+
+	sockfd = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+	if (sockfd < 0)
+		return -errno;
+
+	memset(&req, 0, sizeof(req));
+	req.nh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+	req.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+	req.nh.nlmsg_type = RTM_SETLINK;
+	req.nh.nlmsg_seq = 1;
+	req.ifinfo.ifi_family = AF_UNSPEC;
+	req.ifinfo.ifi_index = if_index;
+
+	nla = (struct nlattr *)((char *)&req + NLMSG_ALIGN(req.nh.nlmsg_len));
+	nla->nla_type = NLA_F_NESTED | IFLA_XDP;
+	nla->nla_len = NLA_HDRLEN;
+
+	nla_xdp = (struct nlattr *)((char *)nla + nla->nla_len);
+	nla_xdp->nla_type = IFLA_XDP_FD;
+	nla_xdp->nla_len = NLA_HDRLEN + sizeof(int);
+	memcpy((char *)nla_xdp + NLA_HDRLEN, &prog_fd, sizeof(int));
+	nla->nla_len += NLA_ALIGN(nla_xdp->nla_len);
+
+	nla_xdp = (struct nlattr *)((char *)nla + nla->nla_len);
+	nla_xdp->nla_type = IFLA_XDP_FLAGS;
+	nla_xdp->nla_len = NLA_HDRLEN + sizeof(uint32_t);
+	memcpy((char *)nla_xdp + NLA_HDRLEN, &flags, sizeof(uint32_t));
+	nla->nla_len += NLA_ALIGN(nla_xdp->nla_len);
+
+	req.nh.nlmsg_len += NLA_ALIGN(nla->nla_len);
+
+	if (sendto(sockfd, &req, req.nh.nlmsg_len, 0,
+		   (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+		ret = -errno;
+		goto out;
+	}
+	if (recv(sockfd, &ack, sizeof(ack), 0) < 0) {
+		ret = -errno;
+		goto out;
+	}
+	ret = ack.nh.nlmsg_type == NLMSG_ERROR ? ack.err.error : 0;
+out:
+	close(sockfd);
+	return ret;
+}
+
+static int
+xdp_ring_map(int sockfd, const struct xdp_ring_offset *off, uint32_t size,
+	     size_t entry_size, off_t pgoff, struct xdp_ring *r)
+{
+	r->map_size = off->desc + size * entry_size;
+	r->map = mmap(NULL, r->map_size, PROT_READ | PROT_WRITE,
+		      MAP_SHARED | MAP_POPULATE, sockfd, pgoff);
+	if (r->map == MAP_FAILED) {
+		r->map = NULL;
+		return -errno;
+	}
+	r->producer = (volatile uint32_t *)((char *)r->map + off->producer);
+	r->consumer = (volatile uint32_t *)((char *)r->map + off->consumer);
+	r->flags = (volatile uint32_t *)((char *)r->map + off->flags);
+	r->ring = (char *)r->map + off->desc;
+	r->mask = size - 1;
+	r->size = size;
+	r->cached_prod = *r->producer;
+	r->cached_cons = *r->consumer;
+	return 0;
+}
+
+static void
+xdp_ring_unmap(struct xdp_ring *r)
+{
+	if (r->map != NULL)
+		munmap(r->map, r->map_size);
+	memset(r, 0, sizeof(*r));
+}
+
+/* Room left for packet data in a UMEM chunk */
+static uint32_t
+umem_data_size(const struct pmd_internals *internals)
+{
+	return internals->frame_size - internals->hdr_size -
+		sizeof(struct rte_mbuf) - RTE_PKTMBUF_HEADROOM;
+}
+
+static void
+umem_destroy(struct xdp_umem *umem)
+{
+	if (umem == NULL)
+		return;
+	rte_mempool_free(umem->mb_pool);
+	rte_memzone_free(umem->mz);
+	rte_free(umem);
+}
+
+/*
+ * Build a mempool of frame_count mbufs laid out back to back in a single
+ * memzone, so that every object is exactly one aligned UMEM chunk.
+ */
+static struct xdp_umem *
+umem_create(struct rte_eth_dev *dev, uint16_t qid, unsigned int socket_id)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	struct rte_pktmbuf_pool_private mbp_priv;
+	char name[RTE_MEMZONE_NAMESIZE];
+	struct xdp_umem *umem;
+	int ret;
+
+	umem = rte_zmalloc_socket(dev->device->name, sizeof(*umem), 0,
+				  socket_id);
+	if (umem == NULL)
+		return NULL;
+	umem->frame_size = internals->frame_size;
+	umem->hdr_size = internals->hdr_size;
+	rte_spinlock_init(&umem->cq_lock);
+
+	snprintf(name, sizeof(name), "af_xdp_umem_%u_%u",
+		 dev->data->port_id, qid);
+	umem->mz = rte_memzone_reserve_aligned(name,
+			(size_t)internals->frame_count * internals->frame_size,
+			socket_id, 0, getpagesize());
+	if (umem->mz == NULL)
+		goto err;
+	umem->buffer = umem->mz->addr;
+
+	umem->mb_pool = rte_mempool_create_empty(name, internals->frame_count,
+			internals->frame_size - internals->hdr_size, 0,
+			sizeof(struct rte_pktmbuf_pool_private), socket_id,
+			MEMPOOL_F_NO_SPREAD);
+	if (umem->mb_pool == NULL)
+		goto err;
+	if (rte_mempool_set_ops_byname(umem->mb_pool, "ring_mp_mc", NULL))
+		goto err;
+
+	mbp_priv.mbuf_data_room_size = internals->frame_size -
+		internals->hdr_size - sizeof(struct rte_mbuf);
+	mbp_priv.mbuf_priv_size = 0;
+	rte_pktmbuf_pool_init(umem->mb_pool, &mbp_priv);
+
+	ret = rte_mempool_populate_iova(umem->mb_pool, umem->mz->addr,
+					umem->mz->iova, umem->mz->len,
+					NULL, NULL);
+	if (ret != (int)internals->frame_count)
+		goto err;
+	rte_mempool_obj_iter(umem->mb_pool, rte_pktmbuf_init, NULL);
+
+	return umem;
+
+err:
+	RTE_LOG(ERR, PMD, "%s: cannot create UMEM for queue %u\n",
+		dev->device->name, qid);
+	umem_destroy(umem);
+	return NULL;
+}
+
+static void
+xsk_destroy(struct pmd_internals *internals, uint16_t qid)
+{
+	struct pkt_rx_queue *rxq = &internals->rx_queues[qid];
+	struct pkt_tx_queue *txq = &internals->tx_queues[qid];
+
+	if (rxq->sockfd != -1) {
+		close(rxq->sockfd);
+		rxq->sockfd = -1;
+	}
+	xdp_ring_unmap(&rxq->rx);
+	xdp_ring_unmap(&txq->tx);
+	if (rxq->umem != NULL) {
+		xdp_ring_unmap(&rxq->umem->fq);
+		xdp_ring_unmap(&rxq->umem->cq);
+		umem_destroy(rxq->umem);
+		rxq->umem = NULL;
+	}
+	rxq->fill_deficit = 0;
+}
+
+/* Create the UMEM and the AF_XDP socket backing queue pair qid */
+static int
+xsk_create(struct rte_eth_dev *dev, uint16_t qid, uint32_t rx_size,
+	   uint32_t tx_size, unsigned int socket_id)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	struct pkt_rx_queue *rxq = &internals->rx_queues[qid];
+	struct pkt_tx_queue *txq = &internals->tx_queues[qid];
+	uint32_t fill_size = rx_size * 2;
+	uint32_t comp_size = tx_size;
+	struct xdp_mmap_offsets off;
+	struct sockaddr_xdp sxdp;
+	struct xdp_umem_reg mr;
+	socklen_t optlen;
+	int headroom;
+	int ret;
+
+	rxq->umem = umem_create(dev, qid, socket_id);
+	if (rxq->umem == NULL)
+		return -ENOMEM;
+
+	rxq->sockfd = socket(AF_XDP, SOCK_RAW, 0);
+	if (rxq->sockfd < 0) {
+		ret = -errno;
+		RTE_LOG(ERR, PMD, "%s: cannot open AF_XDP socket: %s\n",
+			dev->device->name, strerror(errno));
+		goto err;
+	}
+
+	/* place received data right after the mbuf headroom */
+	headroom = internals->hdr_size + sizeof(struct rte_mbuf) +
+		RTE_PKTMBUF_HEADROOM - XDP_PACKET_HEADROOM;
+	memset(&mr, 0, sizeof(mr));
+	mr.addr = (uint64_t)(uintptr_t)rxq->umem->buffer;
+	mr.len = rxq->umem->mz->len;
+	mr.chunk_size = internals->frame_size;
+	mr.headroom = RTE_MAX(headroom, 0);
+	if (setsockopt(rxq->sockfd, SOL_XDP, XDP_UMEM_REG, &mr, sizeof(mr)) ||
+	    setsockopt(rxq->sockfd, SOL_XDP, XDP_UMEM_FILL_RING, &fill_size,
+		       sizeof(fill_size)) ||
+	    setsockopt(rxq->sockfd, SOL_XDP, XDP_UMEM_COMPLETION_RING,
+		       &comp_size, sizeof(comp_size)) ||
+	    setsockopt(rxq->sockfd, SOL_XDP, XDP_RX_RING, &rx_size,
+		       sizeof(rx_size)) ||
+	    setsockopt(rxq->sockfd, SOL_XDP, XDP_TX_RING, &tx_size,
+		       sizeof(tx_size))) {
+		ret = -errno;
+		RTE_LOG(ERR, PMD, "%s: cannot configure AF_XDP socket: %s\n",
+			dev->device->name, strerror(errno));
+		goto err;
+	}
+
+	optlen = sizeof(off);
+	if (getsockopt(rxq->sockfd, SOL_XDP, XDP_MMAP_OFFSETS, &off,
+		       &optlen)) {
+		ret = -errno;
+		goto err;
+	}
+	ret = xdp_ring_map(rxq->sockfd, &off.fr, fill_size, sizeof(uint64_t),
+			   XDP_UMEM_PGOFF_FILL_RING, &rxq->umem->fq);
+	if (ret == 0)
+		ret = xdp_ring_map(rxq->sockfd, &off.cr, comp_size,
+				   sizeof(uint64_t),
+				   XDP_UMEM_PGOFF_COMPLETION_RING,
+				   &rxq->umem->cq);
+	if (ret == 0)
+		ret = xdp_ring_map(rxq->sockfd, &off.rx, rx_size,
+				   sizeof(struct xdp_desc), XDP_PGOFF_RX_RING,
+				   &rxq->rx);
+	if (ret == 0)
+		ret = xdp_ring_map(rxq->sockfd, &off.tx, tx_size,
+				   sizeof(struct xdp_desc), XDP_PGOFF_TX_RING,
+				   &txq->tx);
+	if (ret < 0) {
+		RTE_LOG(ERR, PMD, "%s: cannot map AF_XDP rings\n",
+			dev->device->name);
+		goto err;
+	}
+	/* producer rings: everything is free */
+	rxq->umem->fq.cached_cons += fill_size;
+	txq->tx.cached_cons += tx_size;
+
+	memset(&sxdp, 0, sizeof(sxdp));
+	sxdp.sxdp_family = AF_XDP;
+	sxdp.sxdp_ifindex = internals->if_index;
+	sxdp.sxdp_queue_id = internals->start_queue + qid;
+	sxdp.sxdp_flags = XDP_USE_NEED_WAKEUP;
+	rxq->need_wakeup = 1;
+	if (bind(rxq->sockfd, (struct sockaddr *)&sxdp, sizeof(sxdp)) &&
+	    errno == EINVAL) {
+		/* kernel without need_wakeup support */
+		sxdp.sxdp_flags = 0;
+		rxq->need_wakeup = 0;
+		ret = bind(rxq->sockfd, (struct sockaddr *)&sxdp,
+			   sizeof(sxdp));
+	} else {
+		ret = 0;
+	}
+	if (ret) {
+		ret = -errno;
+		RTE_LOG(ERR, PMD, "%s: cannot bind AF_XDP socket to %s:%u: %s\n",
+			dev->device->name, internals->if_name,
+			sxdp.sxdp_queue_id, strerror(errno));
+		goto err;
+	}
+
+	if (internals->busy_poll &&
+	    setsockopt(rxq->sockfd, SOL_SOCKET, SO_BUSY_POLL,
+		       &internals->busy_poll, sizeof(internals->busy_poll)))
+		RTE_LOG(WARNING, PMD, "%s: cannot enable busy polling: %s\n",
+			dev->device->name, strerror(errno));
+	rxq->busy_poll = internals->busy_poll;
+
+	if (xdp_map_update(internals->map_fd, sxdp.sxdp_queue_id,
+			   rxq->sockfd)) {
+		ret = -errno;
+		RTE_LOG(ERR, PMD, "%s: cannot insert socket in XSKMAP: %s\n",
+			dev->device->name, strerror(errno));
+		goto err;
+	}
+
+	rxq->fill_deficit = fill_size - umem_fill(rxq->umem, fill_size);
+	return 0;
+
+err:
+	xsk_destroy(internals, qid);
+	return ret;
+}
+
+static void
+xdp_prog_release(struct pmd_internals *internals)
+{
+	if (internals->prog_fd != -1) {
+		xdp_link_set(internals->if_index, -1, internals->xdp_flags);
+		close(internals->prog_fd);
+		internals->prog_fd = -1;
+	}
+	if (internals->map_fd != -1) {
+		close(internals->map_fd);
+		internals->map_fd = -1;
+	}
+}
+
+static int
+xdp_prog_setup(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	int ret;
+
+	internals->map_fd = xdp_map_create(internals);
+	if (internals->map_fd < 0) {
+		ret = -errno;
+		RTE_LOG(ERR, PMD, "%s: cannot create XSKMAP: %s\n",
+			dev->device->name, strerror(errno));
+		return ret;
+	}
+	internals->prog_fd = xdp_prog_load(internals->map_fd);
+	if (internals->prog_fd < 0) {
+		ret = -errno;
+		RTE_LOG(ERR, PMD, "%s: cannot load XDP program: %s\n",
+			dev->device->name, strerror(errno));
+		close(internals->map_fd);
+		internals->map_fd = -1;
+		return ret;
+	}
+	ret = xdp_link_set(internals->if_index, internals->prog_fd,
+			   internals->xdp_flags | XDP_FLAGS_UPDATE_IF_NOEXIST);
+	if (ret < 0) {
+		RTE_LOG(ERR, PMD, "%s: cannot attach XDP program to %s: %s\n",
+			dev->device->name, internals->if_name, strerror(-ret));
+		close(internals->prog_fd);
+		internals->prog_fd = -1;
+		close(internals->map_fd);
+		internals->map_fd = -1;
+	}
+	return ret;
+}
+
+/* Sockets of the queue pairs set up since the last start are created here */
+static int
+eth_dev_start(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	uint16_t i;
+	int ret;
+
+	for (i = 0; i < dev->data->nb_rx_queues; i++) {
+		struct pkt_rx_queue *rxq = &internals->rx_queues[i];
+
+		if (rxq->sockfd != -1)
+			continue;
+		ret = xsk_create(dev, i, rxq->nb_desc,
+				 internals->tx_queues[i].nb_desc,
+				 rxq->socket_id);
+		if (ret < 0)
+			return ret;
+	}
+
+	dev->data->dev_link.link_status = ETH_LINK_UP;
+	return 0;
+}
+
+static void
+eth_dev_stop(struct rte_eth_dev *dev)
+{
+	dev->data->dev_link.link_status = ETH_LINK_DOWN;
+}
+
+static int
+eth_dev_configure(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+
+	if (dev->data->nb_rx_queues != dev->data->nb_tx_queues) {
+		RTE_LOG(ERR, PMD, "%s: Rx and Tx queues come in pairs\n",
+			dev->device->name);
+		return -EINVAL;
+	}
+	if (internals->prog_fd == -1)
+		return xdp_prog_setup(dev);
+	return 0;
+}
+
+static void
+eth_dev_info(struct rte_eth_dev *dev, struct rte_eth_dev_info *dev_info)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+
+	dev_info->if_index = internals->if_index;
+	dev_info->max_mac_addrs = 1;
+	dev_info->max_rx_pktlen = umem_data_size(internals);
+	dev_info->max_rx_queues = internals->queue_count;
+	dev_info->max_tx_queues = internals->queue_count;
+	dev_info->min_rx_bufsize = 0;
+}
+
+/* Layout of XDP_STATISTICS accepted by every kernel with AF_XDP */
+struct xdp_statistics_v1 {
+	uint64_t rx_dropped;
+	uint64_t rx_invalid_descs;
+	uint64_t tx_invalid_descs;
+};
+
+static int
+eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *stats)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	struct xdp_statistics_v1 xdp_stats;
+	socklen_t optlen;
+	unsigned int i;
+
+	for (i = 0; i < dev->data->nb_rx_queues; i++) {
+		const struct pkt_rx_queue *rxq = &internals->rx_queues[i];
+		const struct pkt_tx_queue *txq = &internals->tx_queues[i];
+
+		if (i < RTE_ETHDEV_QUEUE_STAT_CNTRS) {
+			stats->q_ipackets[i] = rxq->rx_pkts;
+			stats->q_ibytes[i] = rxq->rx_bytes;
+			stats->q_opackets[i] = txq->tx_pkts;
+			stats->q_obytes[i] = txq->tx_bytes;
+		}
+		stats->ipackets += rxq->rx_pkts;
+		stats->ibytes += rxq->rx_bytes;
+		stats->rx_nombuf += rxq->rx_nombuf;
+		stats->opackets += txq->tx_pkts;
+		stats->obytes += txq->tx_bytes;
+
+		if (rxq->sockfd == -1)
+			continue;
+		optlen = sizeof(xdp_stats);
+		if (getsockopt(rxq->sockfd, SOL_XDP, XDP_STATISTICS,
+			       &xdp_stats, &optlen) == 0) {
+			stats->imissed += xdp_stats.rx_dropped;
+			stats->ierrors += xdp_stats.rx_invalid_descs;
+			stats->oerrors += xdp_stats.tx_invalid_descs;
+		}
+	}
+	return 0;
+}
+
+static void
+eth_stats_reset(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	unsigned int i;
+
+	for (i = 0; i < RTE_PMD_AF_XDP_MAX_QUEUES; i++) {
+		internals->rx_queues[i].rx_pkts = 0;
+		internals->rx_queues[i].rx_bytes = 0;
+		internals->rx_queues[i].rx_nombuf = 0;
+		internals->tx_queues[i].tx_pkts = 0;
+		internals->tx_queues[i].tx_bytes = 0;
+	}
+}
+
+static void
+eth_dev_close(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	uint16_t i;
+
+	for (i = 0; i < internals->queue_count; i++)
+		xsk_destroy(internals, i);
+	xdp_prog_release(internals);
+}
+
+static void
+eth_queue_release(void *q __rte_unused)
+{
+}
+
+static int
+eth_link_update(struct rte_eth_dev *dev __rte_unused,
+		int wait_to_complete __rte_unused)
+{
+	return 0;
+}
+
+static uint32_t
+eth_ring_size(struct rte_eth_dev *dev, uint16_t nb_desc)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	uint32_t ring_size;
+
+	ring_size = rte_align32pow2(nb_desc ? nb_desc : DFLT_RING_SIZE);
+	/* the fill ring is twice the Rx ring and must not exceed the UMEM */
+	if (ring_size * 2 > internals->frame_count) {
+		RTE_LOG(ERR, PMD, "%s: %u descriptors need %u frames, only %u\n",
+			dev->device->name, nb_desc, ring_size * 2,
+			internals->frame_count);
+		return 0;
+	}
+	return ring_size;
+}
+
+/*
+ * Rx mbufs are allocated from the UMEM mempool of the queue, the one given
+ * by the application is not used: the kernel can only write into the UMEM.
+ * Rx and Tx queues of the same index share one socket, created at start.
+ */
+static int
+eth_rx_queue_setup(struct rte_eth_dev *dev,
+		   uint16_t rx_queue_id,
+		   uint16_t nb_rx_desc,
+		   unsigned int socket_id,
+		   const struct rte_eth_rxconf *rx_conf __rte_unused,
+		   struct rte_mempool *mb_pool __rte_unused)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	struct pkt_rx_queue *rxq = &internals->rx_queues[rx_queue_id];
+
+	rxq->nb_desc = eth_ring_size(dev, nb_rx_desc);
+	if (rxq->nb_desc == 0)
+		return -EINVAL;
+	rxq->socket_id = socket_id == (unsigned int)SOCKET_ID_ANY ?
+		rte_socket_id() : socket_id;
+	xsk_destroy(internals, rx_queue_id);
+
+	rxq->in_port = dev->data->port_id;
+	dev->data->rx_queues[rx_queue_id] = rxq;
+	return 0;
+}
+
+static int
+eth_tx_queue_setup(struct rte_eth_dev *dev,
+		   uint16_t tx_queue_id,
+		   uint16_t nb_tx_desc,
+		   unsigned int socket_id __rte_unused,
+		   const struct rte_eth_txconf *tx_conf __rte_unused)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	struct pkt_tx_queue *txq = &internals->tx_queues[tx_queue_id];
+
+	txq->nb_desc = eth_ring_size(dev, nb_tx_desc);
+	if (txq->nb_desc == 0)
+		return -EINVAL;
+	xsk_destroy(internals, tx_queue_id);
+
+	txq->pair = &internals->rx_queues[tx_queue_id];
+	dev->data->tx_queues[tx_queue_id] = txq;
+	return 0;
+}
+
+static int
+eth_dev_mtu_set(struct rte_eth_dev *dev, uint16_t mtu)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	struct ifreq ifr = { .ifr_mtu = mtu };
+	int ret;
+	int s;
+
+	if ((uint32_t)mtu + ETHER_HDR_LEN > umem_data_size(internals))
+		return -EINVAL;
+
+	s = socket(PF_INET, SOCK_DGRAM, 0);
+	if (s < 0)
+		return -EINVAL;
+
+	snprintf(ifr.ifr_name, IFNAMSIZ, "%s", internals->if_name);
+	ret = ioctl(s, SIOCSIFMTU, &ifr);
+	close(s);
+
+	if (ret < 0)
+		return -EINVAL;
+
+	return 0;
+}
+
+static void
+eth_dev_change_flags(char *if_name, uint32_t flags, uint32_t mask)
+{
+	struct ifreq ifr;
+	int s;
+
+	s = socket(PF_INET, SOCK_DGRAM, 0);
+	if (s < 0)
+		return;
+
+	snprintf(ifr.ifr_name, IFNAMSIZ, "%s", if_name);
+	if (ioctl(s, SIOCGIFFLAGS, &ifr) < 0)
+		goto out;
+	ifr.ifr_flags &= mask;
+	ifr.ifr_flags |= flags;
+	if (ioctl(s, SIOCSIFFLAGS, &ifr) < 0)
+		goto out;
+out:
+	close(s);
+}
+
+static void
+eth_dev_promiscuous_enable(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+
+	eth_dev_change_flags(internals->if_name, IFF_PROMISC, ~0);
+}
+
+static void
+eth_dev_promiscuous_disable(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+
+	eth_dev_change_flags(internals->if_name, 0, ~IFF_PROMISC);
+}
+
+static const struct eth_dev_ops ops = {
+	.dev_start = eth_dev_start,
+	.dev_stop = eth_dev_stop,
+	.dev_close = eth_dev_close,
+	.dev_configure = eth_dev_configure,
+	.dev_infos_get = eth_dev_info,
+	.mtu_set = eth_dev_mtu_set,
+	.promiscuous_enable = eth_dev_promiscuous_enable,
+	.promiscuous_disable = eth_dev_promiscuous_disable,
+	.rx_queue_setup = eth_rx_queue_setup,
+	.tx_queue_setup = eth_tx_queue_setup,
+	.rx_queue_release = eth_queue_release,
+	.tx_queue_release = eth_queue_release,
+	.link_update = eth_link_update,
+	.stats_get = eth_stats_get,
+	.stats_reset = eth_stats_reset,
+};
+
+static int
+parse_string(const char *key __rte_unused, const char *value,
+	     void *extra_args)
+{
+	char *name = extra_args;
+
+	if (strlen(value) >= IFNAMSIZ) {
+		RTE_LOG(ERR, PMD, "Interface name too long: %s\n", value);
+		return -EINVAL;
+	}
+	snprintf(name, IFNAMSIZ, "%s", value);
+	return 0;
+}
+
+static int
+parse_uint(const char *key, const char *value, void *extra_args)
+{
+	uint32_t *out = extra_args;
+	unsigned long v;
+	char *end;
+
+	errno = 0;
+	v = strtoul(value, &end, 0);
+	if (errno || *end != '\0' || v > UINT32_MAX) {
+		RTE_LOG(ERR, PMD, "Invalid %s value: %s\n", key, value);
+		return -EINVAL;
+	}
+	*out = v;
+	return 0;
+}
+
+static int
+parse_xdp_mode(const char *key __rte_unused, const char *value,
+	       void *extra_args)
+{
+	uint32_t *flags = extra_args;
+
+	if (strcmp(value, ETH_AF_XDP_XDP_MODE_SKB) == 0)
+		*flags = XDP_FLAGS_SKB_MODE;
+	else if (strcmp(value, ETH_AF_XDP_XDP_MODE_DRV) == 0)
+		*flags = XDP_FLAGS_DRV_MODE;
+	else {
+		RTE_LOG(ERR, PMD, "Invalid XDP mode: %s\n", value);
+		return -EINVAL;
+	}
+	return 0;
+}
+
+static int
+get_iface_info(struct pmd_internals *internals)
+{
+	struct ifreq ifr;
+	int s;
+
+	internals->if_index = if_nametoindex(internals->if_name);
+	if (internals->if_index == 0) {
+		RTE_LOG(ERR, PMD, "Unknown interface %s\n", internals->if_name);
+		return -ENODEV;
+	}
+
+	s = socket(PF_INET, SOCK_DGRAM, 0);
+	if (s < 0)
+		return -errno;
+	memset(&ifr, 0, sizeof(ifr));
+	snprintf(ifr.ifr_name, IFNAMSIZ, "%s", internals->if_name);
+	if (ioctl(s, SIOCGIFHWADDR, &ifr) < 0) {
+		RTE_LOG(ERR, PMD, "%s: ioctl failed (SIOCGIFHWADDR)\n",
+			internals->if_name);
+		close(s);
+		return -errno;
+	}
+	close(s);
+	memcpy(&internals->eth_addr, ifr.ifr_hwaddr.sa_data, ETH_ALEN);
+	return 0;
+}
+
+static int
+rte_pmd_af_xdp_probe(struct rte_vdev_device *dev)
+{
+	struct rte_mempool_objsz objsz;
+	struct pmd_internals *internals;
+	struct rte_eth_dev *eth_dev;
+	struct rte_kvargs *kvlist;
+	uint32_t start_queue = 0;
+	uint32_t queue_count = 1;
+	unsigned int i;
+	int ret;
+
+	RTE_LOG(INFO, PMD, "Initializing pmd_af_xdp for %s\n",
+		rte_vdev_device_name(dev));
+
+	kvlist = rte_kvargs_parse(rte_vdev_device_args(dev), valid_arguments);
+	if (kvlist == NULL)
+		return -EINVAL;
+
+	if (rte_kvargs_count(kvlist, ETH_AF_XDP_IFACE_ARG) != 1) {
+		RTE_LOG(ERR, PMD, "%s: exactly one %s argument is required\n",
+			rte_vdev_device_name(dev), ETH_AF_XDP_IFACE_ARG);
+		ret = -EINVAL;
+		goto exit;
+	}
+
+	if (dev->device.numa_node == SOCKET_ID_ANY)
+		dev->device.numa_node = rte_socket_id();
+
+	eth_dev = rte_eth_vdev_allocate(dev, sizeof(*internals));
+	if (eth_dev == NULL) {
+		ret = -ENOMEM;
+		goto exit;
+	}
+	internals = eth_dev->data->dev_private;
+	internals->frame_size = DFLT_FRAME_SIZE;
+	internals->frame_count = DFLT_FRAME_COUNT;
+	internals->xdp_flags = XDP_FLAGS_SKB_MODE;
+	internals->prog_fd = -1;
+	internals->map_fd = -1;
+	for (i = 0; i < RTE_PMD_AF_XDP_MAX_QUEUES; i++)
+		internals->rx_queues[i].sockfd = -1;
+
+	ret = rte_kvargs_process(kvlist, ETH_AF_XDP_IFACE_ARG,
+				 &parse_string, internals->if_name);
+	if (ret == 0)
+		ret = rte_kvargs_process(kvlist, ETH_AF_XDP_START_QUEUE_ARG,
+					 &parse_uint, &start_queue);
+	if (ret == 0)
+		ret = rte_kvargs_process(kvlist, ETH_AF_XDP_QUEUE_COUNT_ARG,
+					 &parse_uint, &queue_count);
+	if (ret == 0)
+		ret = rte_kvargs_process(kvlist, ETH_AF_XDP_FRAME_SIZE_ARG,
+					 &parse_uint, &internals->frame_size);
+	if (ret == 0)
+		ret = rte_kvargs_process(kvlist, ETH_AF_XDP_FRAME_COUNT_ARG,
+					 &parse_uint, &internals->frame_count);
+	if (ret == 0)
+		ret = rte_kvargs_process(kvlist, ETH_AF_XDP_XDP_MODE_ARG,
+					 &parse_xdp_mode,
+					 &internals->xdp_flags);
+	if (ret == 0)
+		ret = rte_kvargs_process(kvlist, ETH_AF_XDP_BUSY_POLL_ARG,
+					 &parse_uint, &internals->busy_poll);
+	if (ret < 0)
+		goto free_dev;
+
+	if (queue_count == 0 || queue_count > RTE_PMD_AF_XDP_MAX_QUEUES ||
+	    start_queue > UINT16_MAX - queue_count) {
+		RTE_LOG(ERR, PMD, "%s: invalid queue range %u-%u (max %d)\n",
+			rte_vdev_device_name(dev), start_queue,
+			start_queue + queue_count - 1,
+			RTE_PMD_AF_XDP_MAX_QUEUES);
+		ret = -EINVAL;
+		goto free_dev;
+	}
+	internals->start_queue = start_queue;
+	internals->queue_count = queue_count;
+
+	/* UMEM chunks must be a power of two no larger than a page */
+	if (!rte_is_power_of_2(internals->frame_size) ||
+	    internals->frame_size < 2048 ||
+	    internals->frame_size > (uint32_t)getpagesize()) {
+		RTE_LOG(ERR, PMD, "%s: invalid frame size %u\n",
+			rte_vdev_device_name(dev), internals->frame_size);
+		ret = -EINVAL;
+		goto free_dev;
+	}
+	/* mempool objects must match the chunks exactly */
+	rte_mempool_calc_obj_size(0, MEMPOOL_F_NO_SPREAD, &objsz);
+	internals->hdr_size = objsz.header_size;
+	if (rte_mempool_calc_obj_size(internals->frame_size -
+			internals->hdr_size, MEMPOOL_F_NO_SPREAD, NULL) !=
+	    internals->frame_size) {
+		RTE_LOG(ERR, PMD, "%s: frame size %u does not fit mempool objects\n",
+			rte_vdev_device_name(dev), internals->frame_size);
+		ret = -EINVAL;
+		goto free_dev;
+	}
+
+	ret = get_iface_info(internals);
+	if (ret < 0)
+		goto free_dev;
+
+	eth_dev->data->dev_link = pmd_link;
+	eth_dev->data->mac_addrs = &internals->eth_addr;
+	eth_dev->dev_ops = &ops;
+	eth_dev->rx_pkt_burst = eth_af_xdp_rx;
+	eth_dev->tx_pkt_burst = eth_af_xdp_tx;
+
+	RTE_LOG(INFO, PMD, "%s: %s queues %u-%u, %u frames of %u bytes\n",
+		rte_vdev_device_name(dev), internals->if_name,
+		internals->start_queue,
+		internals->start_queue + internals->queue_count - 1,
+		internals->frame_count, internals->frame_size);
+	ret = 0;
+	goto exit;
+
+free_dev:
+	rte_free(eth_dev->data->dev_private);
+	rte_eth_dev_release_port(eth_dev);
+exit:
+	rte_kvargs_free(kvlist);
+	return ret;
+}
+
+static int
+rte_pmd_af_xdp_remove(struct rte_vdev_device *dev)
+{
+	struct rte_eth_dev *eth_dev;
+
+	RTE_LOG(INFO, PMD, "Closing AF_XDP ethdev on numa socket %u\n",
+		rte_socket_id());
+
+	if (dev == NULL)
+		return -1;
+
+	eth_dev = rte_eth_dev_allocated(rte_vdev_device_name(dev));
+	if (eth_dev == NULL)
+		return -1;
+
+	eth_dev_close(eth_dev);
+	rte_free(eth_dev->data->dev_private);
+	rte_eth_dev_release_port(eth_dev);
+
+	return 0;
+}
+
+static struct rte_vdev_driver pmd_af_xdp_drv = {
+	.probe = rte_pmd_af_xdp_probe,
+	.remove = rte_pmd_af_xdp_remove,
+};
+
+RTE_PMD_REGISTER_VDEV(net_af_xdp, pmd_af_xdp_drv);
+RTE_PMD_REGISTER_PARAM_STRING(net_af_xdp,
+	"iface=<string> "
+	"start_queue=<int> "
+	"queue_count=<int> "
+	"framesz=<int> "
+	"framecnt=<int> "
+	"xdp_mode=<skb|drv> "
+	"busy_poll=<int>");
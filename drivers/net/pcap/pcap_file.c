@@ -0,0 +1,504 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <rte_byteorder.h>
+#include <rte_common.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_memcpy.h>
+
+#include "pcap_file.h"
+
+#define NS_PER_S		1000000000ULL
+
+#define PCAP_MAGIC_US		0xa1b2c3d4
+#define PCAP_MAGIC_NS		0xa1b23c4d
+#define PCAP_FILE_HDR_LEN	24
+#define PCAP_REC_HDR_LEN	16
+
+#define PCAPNG_BOM		0x1a2b3c4d
+#define PCAPNG_BLOCK_SHB	0x0a0d0d0a
+#define PCAPNG_BLOCK_IDB	1
+#define PCAPNG_BLOCK_OPB	2
+#define PCAPNG_BLOCK_SPB	3
+#define PCAPNG_BLOCK_EPB	6
+#define PCAPNG_OPT_END		0
+#define PCAPNG_OPT_IF_NAME	2
+#define PCAPNG_OPT_IF_TSRESOL	9
+#define PCAPNG_OPT_IF_TSOFFSET	14
+#define PCAPNG_LINKTYPE_ETHERNET 1
+#define PCAPNG_TSRESOL_US	6
+#define PCAPNG_TSRESOL_NS	9
+#define PCAPNG_MAX_IFACES	64
+
+#define PCAP_FILE_WBUF_SIZE	(1 << 18)
+
+struct pcapng_iface {
+	uint32_t snaplen;
+	uint8_t tsresol;
+	int64_t tsoffset;		/* seconds */
+};
+
+struct pcap_file_reader {
+	const uint8_t *base;
+	size_t size;
+	size_t off;			/* next record to peek */
+	size_t next;			/* record following the peeked one */
+	int pcapng;
+	int swapped;			/* file byte order is not ours */
+	uint32_t ts_mult;		/* pcap: nanoseconds per ts unit */
+	uint32_t snaplen;		/* pcap */
+	unsigned int nb_ifaces;		/* pcapng: in the current section */
+	struct pcapng_iface ifaces[PCAPNG_MAX_IFACES];
+};
+
+struct pcap_file_writer {
+	int fd;
+	uint32_t snaplen;
+	uint32_t used;
+	uint8_t buf[PCAP_FILE_WBUF_SIZE];
+};
+
+static inline uint16_t
+rd16(const struct pcap_file_reader *r, const uint8_t *p)
+{
+	uint16_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return r->swapped ? rte_bswap16(v) : v;
+}
+
+static inline uint32_t
+rd32(const struct pcap_file_reader *r, const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return r->swapped ? rte_bswap32(v) : v;
+}
+
+static inline uint64_t
+rd64(const struct pcap_file_reader *r, const uint8_t *p)
+{
+	uint64_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return r->swapped ? rte_bswap64(v) : v;
+}
+
+static uint64_t
+pcapng_ts_to_ns(const struct pcapng_iface *ifc, uint64_t ts)
+{
+	static const uint64_t pow10[] = {
+		1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL,
+		1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+		10000000000ULL,
+	};
+	unsigned int res = ifc->tsresol & 0x7f;
+	uint64_t ns;
+
+	if (ifc->tsresol & 0x80) {
+		/* units of 2^-res seconds */
+		uint64_t frac;
+
+		if (res >= 64)
+			return 0;
+		frac = ts & ((1ULL << res) - 1);
+		ns = (ts >> res) * NS_PER_S;
+		/* keep frac * NS_PER_S within 64 bits */
+		if (res > 32) {
+			frac >>= res - 32;
+			res = 32;
+		}
+		ns += (frac * NS_PER_S) >> res;
+	} else if (res <= PCAPNG_TSRESOL_NS) {
+		ns = ts * pow10[PCAPNG_TSRESOL_NS - res];
+	} else if (res - PCAPNG_TSRESOL_NS < RTE_DIM(pow10)) {
+		ns = ts / pow10[res - PCAPNG_TSRESOL_NS];
+	} else {
+		ns = 0;
+	}
+	return ns + ifc->tsoffset * NS_PER_S;
+}
+
+static void
+pcapng_parse_idb(struct pcap_file_reader *r, const uint8_t *blk,
+		 uint32_t blen)
+{
+	struct pcapng_iface *ifc;
+	const uint8_t *opt, *end;
+
+	if (r->nb_ifaces == PCAPNG_MAX_IFACES || blen < 20)
+		return;
+	ifc = &r->ifaces[r->nb_ifaces++];
+	ifc->snaplen = rd32(r, blk + 12);
+	ifc->tsresol = PCAPNG_TSRESOL_US;
+	ifc->tsoffset = 0;
+
+	end = blk + blen - 4;
+	for (opt = blk + 16; opt + 4 <= end; ) {
+		uint16_t code = rd16(r, opt);
+		uint16_t len = rd16(r, opt + 2);
+
+		if (code == PCAPNG_OPT_END || opt + 4 + len > end)
+			break;
+		if (code == PCAPNG_OPT_IF_TSRESOL && len == 1)
+			ifc->tsresol = opt[4];
+		else if (code == PCAPNG_OPT_IF_TSOFFSET && len == 8)
+			ifc->tsoffset = (int64_t)rd64(r, opt + 4);
+		opt += 4 + RTE_ALIGN_CEIL(len, 4);
+	}
+}
+
+static int
+pcapng_peek(struct pcap_file_reader *r, struct pcap_file_pkt *pkt)
+{
+	static const struct pcapng_iface dflt_iface = {
+		.tsresol = PCAPNG_TSRESOL_US,
+	};
+	const struct pcapng_iface *ifc;
+	const uint8_t *blk;
+	uint32_t type, blen, iface_id;
+
+	for (;;) {
+		if (r->off + 12 > r->size)
+			return -1;
+		blk = r->base + r->off;
+		type = rd32(r, blk);
+
+		if (type == PCAPNG_BLOCK_SHB) {
+			/* each section may come with its own byte order */
+			uint32_t bom;
+
+			memcpy(&bom, blk + 8, sizeof(bom));
+			if (bom == PCAPNG_BOM)
+				r->swapped = 0;
+			else if (bom == rte_bswap32(PCAPNG_BOM))
+				r->swapped = 1;
+			else
+				return -1;
+			r->nb_ifaces = 0;
+		}
+
+		blen = rd32(r, blk + 4);
+		if (blen < 12 || (blen & 3) || blen > r->size - r->off)
+			return -1;
+
+		switch (type) {
+		case PCAPNG_BLOCK_IDB:
+			pcapng_parse_idb(r, blk, blen);
+			break;
+		case PCAPNG_BLOCK_EPB:
+		case PCAPNG_BLOCK_OPB:
+			if (blen < 32)
+				return -1;
+			iface_id = type == PCAPNG_BLOCK_EPB ?
+				rd32(r, blk + 8) : rd16(r, blk + 8);
+			ifc = iface_id < r->nb_ifaces ?
+				&r->ifaces[iface_id] : &dflt_iface;
+			pkt->caplen = rd32(r, blk + 20);
+			if (pkt->caplen > blen - 32)
+				return -1;
+			pkt->len = rd32(r, blk + 24);
+			pkt->data = blk + 28;
+			pkt->ts = pcapng_ts_to_ns(ifc,
+				((uint64_t)rd32(r, blk + 12) << 32) |
+				rd32(r, blk + 16));
+			r->next = r->off + blen;
+			return 0;
+		case PCAPNG_BLOCK_SPB:
+			if (blen < 16)
+				return -1;
+			pkt->len = rd32(r, blk + 8);
+			pkt->caplen = RTE_MIN(pkt->len, blen - 16);
+			if (r->nb_ifaces && r->ifaces[0].snaplen)
+				pkt->caplen = RTE_MIN(pkt->caplen,
+						      r->ifaces[0].snaplen);
+			pkt->data = blk + 12;
+			pkt->ts = 0;
+			r->next = r->off + blen;
+			return 0;
+		default:
+			break;
+		}
+		r->off += blen;
+	}
+}
+
+static int
+pcap_peek(struct pcap_file_reader *r, struct pcap_file_pkt *pkt)
+{
+	const uint8_t *rec;
+
+	if (r->off + PCAP_REC_HDR_LEN > r->size)
+		return -1;
+	rec = r->base + r->off;
+	pkt->caplen = rd32(r, rec + 8);
+	if (pkt->caplen > r->size - r->off - PCAP_REC_HDR_LEN)
+		return -1;
+	pkt->len = rd32(r, rec + 12);
+	pkt->data = rec + PCAP_REC_HDR_LEN;
+	pkt->ts = (uint64_t)rd32(r, rec) * NS_PER_S +
+		(uint64_t)rd32(r, rec + 4) * r->ts_mult;
+	r->next = r->off + PCAP_REC_HDR_LEN + pkt->caplen;
+	return 0;
+}
+
+int
+pcap_file_peek(struct pcap_file_reader *r, struct pcap_file_pkt *pkt)
+{
+	return r->pcapng ? pcapng_peek(r, pkt) : pcap_peek(r, pkt);
+}
+
+void
+pcap_file_advance(struct pcap_file_reader *r)
+{
+	r->off = r->next;
+}
+
+void
+pcap_file_reader_rewind(struct pcap_file_reader *r)
+{
+	/* pcapng sections and interfaces are parsed again */
+	r->off = r->pcapng ? 0 : PCAP_FILE_HDR_LEN;
+	r->next = r->off;
+	r->nb_ifaces = 0;
+}
+
+struct pcap_file_reader *
+pcap_file_reader_open(const char *path, int populate)
+{
+	struct pcap_file_reader *r;
+	struct stat st;
+	uint32_t magic;
+	void *base;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return NULL;
+	}
+	if (st.st_size < PCAP_FILE_HDR_LEN) {
+		close(fd);
+		errno = EPROTONOSUPPORT;
+		return NULL;
+	}
+	base = mmap(NULL, st.st_size, PROT_READ,
+		    MAP_PRIVATE | (populate ? MAP_POPULATE : 0), fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		return NULL;
+	madvise(base, st.st_size, populate ? MADV_WILLNEED : MADV_SEQUENTIAL);
+
+	r = rte_zmalloc("pcap_file_reader", sizeof(*r), 0);
+	if (r == NULL) {
+		munmap(base, st.st_size);
+		errno = ENOMEM;
+		return NULL;
+	}
+	r->base = base;
+	r->size = st.st_size;
+
+	memcpy(&magic, base, sizeof(magic));
+	if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS) {
+		r->swapped = 0;
+	} else if (magic == rte_bswap32(PCAP_MAGIC_US) ||
+		   magic == rte_bswap32(PCAP_MAGIC_NS)) {
+		r->swapped = 1;
+		magic = rte_bswap32(magic);
+	} else if (magic == PCAPNG_BLOCK_SHB) {
+		r->pcapng = 1;
+	} else {
+		pcap_file_reader_close(r);
+		errno = EPROTONOSUPPORT;
+		return NULL;
+	}
+	if (!r->pcapng) {
+		r->ts_mult = magic == PCAP_MAGIC_NS ? 1 : 1000;
+		r->snaplen = rd32(r, r->base + 16);
+	}
+
+	pcap_file_reader_rewind(r);
+	return r;
+}
+
+void
+pcap_file_reader_close(struct pcap_file_reader *r)
+{
+	if (r == NULL)
+		return;
+	munmap((void *)(uintptr_t)r->base, r->size);
+	rte_free(r);
+}
+
+int
+pcap_file_writer_flush(struct pcap_file_writer *w)
+{
+	uint32_t done = 0;
+	ssize_t n;
+
+	while (done < w->used) {
+		n = write(w->fd, w->buf + done, w->used - done);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		done += n;
+	}
+	w->used = 0;
+	return 0;
+}
+
+static uint8_t *
+pcapng_put_opt(uint8_t *p, uint16_t code, const void *val, uint16_t len)
+{
+	memcpy(p, &code, sizeof(code));
+	memcpy(p + 2, &len, sizeof(len));
+	if (len)
+		memcpy(p + 4, val, len);
+	memset(p + 4 + len, 0, RTE_ALIGN_CEIL(len, 4) - len);
+	return p + 4 + RTE_ALIGN_CEIL(len, 4);
+}
+
+/* Start the file with a section header and one interface description */
+static void
+pcapng_write_header(struct pcap_file_writer *w, const char *if_name)
+{
+	const uint8_t tsresol = PCAPNG_TSRESOL_NS;
+	uint32_t u32;
+	uint16_t u16;
+	int64_t i64;
+	uint8_t *blk, *p;
+
+	blk = w->buf;
+	u32 = PCAPNG_BLOCK_SHB;
+	memcpy(blk, &u32, 4);
+	u32 = PCAPNG_BOM;
+	memcpy(blk + 8, &u32, 4);
+	u16 = 1;
+	memcpy(blk + 12, &u16, 2);		/* major version */
+	u16 = 0;
+	memcpy(blk + 14, &u16, 2);		/* minor version */
+	i64 = -1;
+	memcpy(blk + 16, &i64, 8);		/* section length unknown */
+	u32 = 28;
+	memcpy(blk + 4, &u32, 4);
+	memcpy(blk + 24, &u32, 4);
+
+	blk += 28;
+	u32 = PCAPNG_BLOCK_IDB;
+	memcpy(blk, &u32, 4);
+	u16 = PCAPNG_LINKTYPE_ETHERNET;
+	memcpy(blk + 8, &u16, 2);
+	u16 = 0;
+	memcpy(blk + 10, &u16, 2);
+	memcpy(blk + 12, &w->snaplen, 4);
+	p = blk + 16;
+	if (if_name != NULL)
+		p = pcapng_put_opt(p, PCAPNG_OPT_IF_NAME, if_name,
+				   RTE_MIN(strlen(if_name), 256U));
+	p = pcapng_put_opt(p, PCAPNG_OPT_IF_TSRESOL, &tsresol, 1);
+	p = pcapng_put_opt(p, PCAPNG_OPT_END, NULL, 0);
+	u32 = p + 4 - blk;
+	memcpy(blk + 4, &u32, 4);
+	memcpy(p, &u32, 4);
+
+	w->used = p + 4 - w->buf;
+}
+
+struct pcap_file_writer *
+pcap_file_writer_open(const char *path, const char *if_name,
+		      uint32_t snaplen)
+{
+	struct pcap_file_writer *w;
+	int ret;
+
+	w = rte_zmalloc("pcap_file_writer", sizeof(*w), 0);
+	if (w == NULL) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	/* a block must always fit in the buffer */
+	w->snaplen = RTE_MIN(snaplen, (uint32_t)PCAP_FILE_WBUF_SIZE / 2);
+	w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (w->fd < 0) {
+		rte_free(w);
+		return NULL;
+	}
+
+	pcapng_write_header(w, if_name);
+	ret = pcap_file_writer_flush(w);
+	if (ret < 0) {
+		close(w->fd);
+		rte_free(w);
+		errno = -ret;
+		return NULL;
+	}
+	return w;
+}
+
+void
+pcap_file_writer_close(struct pcap_file_writer *w)
+{
+	if (w == NULL)
+		return;
+	pcap_file_writer_flush(w);
+	close(w->fd);
+	rte_free(w);
+}
+
+int
+pcap_file_write(struct pcap_file_writer *w, const struct rte_mbuf *m,
+		uint64_t ts)
+{
+	uint32_t caplen = RTE_MIN(m->pkt_len, w->snaplen);
+	uint32_t blen = 32 + RTE_ALIGN_CEIL(caplen, 4);
+	uint32_t u32, left, len;
+	uint8_t *blk, *p;
+	int ret;
+
+	if (w->used + blen > sizeof(w->buf)) {
+		ret = pcap_file_writer_flush(w);
+		if (ret < 0)
+			return ret;
+	}
+
+	blk = w->buf + w->used;
+	u32 = PCAPNG_BLOCK_EPB;
+	memcpy(blk, &u32, 4);
+	memcpy(blk + 4, &blen, 4);
+	u32 = 0;				/* interface id */
+	memcpy(blk + 8, &u32, 4);
+	u32 = ts >> 32;
+	memcpy(blk + 12, &u32, 4);
+	u32 = (uint32_t)ts;
+	memcpy(blk + 16, &u32, 4);
+	memcpy(blk + 20, &caplen, 4);
+	memcpy(blk + 24, &m->pkt_len, 4);
+
+	p = blk + 28;
+	for (left = caplen; left > 0; m = m->next) {
+		len = RTE_MIN(left, (uint32_t)m->data_len);
+		rte_memcpy(p, rte_pktmbuf_mtod(m, const void *), len);
+		p += len;
+		left -= len;
+	}
+	memset(p, 0, RTE_ALIGN_CEIL(caplen, 4) - caplen);
+	memcpy(blk + blen - 4, &blen, 4);
+
+	w->used += blen;
+	return 0;
+}
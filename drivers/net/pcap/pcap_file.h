@@ -0,0 +1,67 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef _PCAP_FILE_H_
+#define _PCAP_FILE_H_
+
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+
+/*
+ * Capture file access without libpcap: files are read through a read-only
+ * mapping, and written as pcapng through a private buffer.
+ */
+
+/* Packet record of a capture file, data points into the file mapping */
+struct pcap_file_pkt {
+	const uint8_t *data;
+	uint32_t caplen;		/* bytes present in the file */
+	uint32_t len;			/* length on the wire */
+	uint64_t ts;			/* nanoseconds since the epoch */
+};
+
+struct pcap_file_reader;
+struct pcap_file_writer;
+
+/*
+ * Map a pcap (micro or nanosecond) or pcapng file. With populate set, the
+ * whole file is read in memory at once, for repeated replays.
+ * Returns NULL with errno set, EPROTONOSUPPORT for unknown formats.
+ */
+struct pcap_file_reader *pcap_file_reader_open(const char *path,
+					       int populate);
+void pcap_file_reader_close(struct pcap_file_reader *r);
+
+/* Go back to the first packet of the file */
+void pcap_file_reader_rewind(struct pcap_file_reader *r);
+
+/*
+ * Describe the next packet record without consuming it.
+ * Returns 0 on success, -1 at end of file or on a truncated record.
+ */
+int pcap_file_peek(struct pcap_file_reader *r, struct pcap_file_pkt *pkt);
+
+/* Consume the record returned by the last successful pcap_file_peek() */
+void pcap_file_advance(struct pcap_file_reader *r);
+
+/*
+ * Create a pcapng file holding one Ethernet interface named if_name, with
+ * nanosecond timestamps. Packets longer than snaplen are truncated.
+ */
+struct pcap_file_writer *pcap_file_writer_open(const char *path,
+					       const char *if_name,
+					       uint32_t snaplen);
+
+/* Flush and close the file */
+void pcap_file_writer_close(struct pcap_file_writer *w);
+
+/* Append a packet, flushing the buffer first if it cannot hold it */
+int pcap_file_write(struct pcap_file_writer *w, const struct rte_mbuf *m,
+		    uint64_t ts);
+
+/* Write the buffered packets to the file */
+int pcap_file_writer_flush(struct pcap_file_writer *w);
+
+#endif /* _PCAP_FILE_H_ */
@@ -32,6 +32,8 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <errno.h>
+#include <string.h>
 #include <time.h>
 
 #include <net/if.h>
@@ -46,6 +48,8 @@
 #include <rte_mbuf.h>
 #include <rte_bus_vdev.h>
 
+#include "pcap_file.h"
+
 #define RTE_ETH_PCAP_SNAPSHOT_LEN 65535
 #define RTE_ETH_PCAP_SNAPLEN ETHER_MAX_JUMBO_FRAME_LEN
 #define RTE_ETH_PCAP_PROMISC 1
@@ -56,6 +60,10 @@
 #define ETH_PCAP_RX_IFACE_ARG "rx_iface"
 #define ETH_PCAP_TX_IFACE_ARG "tx_iface"
 #define ETH_PCAP_IFACE_ARG    "iface"
+#define ETH_PCAP_INFINITE_RX_ARG "infinite_rx"
+#define ETH_PCAP_RX_RATE_ARG  "rx_rate"
+
+#define ETH_PCAPNG_SUFFIX	".pcapng"
 
 #define ETH_PCAP_ARG_MAXLEN	64
 
@@ -64,6 +72,7 @@
 static char errbuf[PCAP_ERRBUF_SIZE];
 static unsigned char tx_pcap_data[RTE_ETH_PCAP_SNAPLEN];
 static struct timeval start_time;
+static uint64_t start_ns;
 static uint64_t start_cycles;
 static uint64_t hz;
 
@@ -75,15 +84,21 @@ struct queue_stat {
 
 struct pcap_rx_queue {
 	pcap_t *pcap;
+	struct pcap_file_reader *reader;
 	uint16_t in_port;
 	struct rte_mempool *mb_pool;
 	struct queue_stat rx_stat;
+	int infinite_rx;		/* replay the file forever */
+	uint64_t rate;			/* bytes per second, 0 for no pacing */
+	uint64_t tokens;		/* bytes allowed to be read */
+	uint64_t last_cycles;
 	char name[PATH_MAX];
 	char type[ETH_PCAP_ARG_MAXLEN];
 };
 
 struct pcap_tx_queue {
 	pcap_dumper_t *dumper;
+	struct pcap_file_writer *writer;
 	pcap_t *pcap;
 	struct queue_stat tx_stat;
 	char name[PATH_MAX];
@@ -99,8 +114,13 @@ struct pmd_internals {
 
 struct pmd_devargs {
 	unsigned int num_of_queue;
+	const char *dev_name;
+	int infinite_rx;
+	uint64_t rx_rate;
 	struct devargs_queue {
 		pcap_dumper_t *dumper;
+		struct pcap_file_writer *writer;
+		struct pcap_file_reader *reader;
 		pcap_t *pcap;
 		const char *name;
 		const char *type;
@@ -113,6 +133,8 @@ static const char *valid_arguments[] = {
 	ETH_PCAP_RX_IFACE_ARG,
 	ETH_PCAP_TX_IFACE_ARG,
 	ETH_PCAP_IFACE_ARG,
+	ETH_PCAP_INFINITE_RX_ARG,
+	ETH_PCAP_RX_RATE_ARG,
 	NULL
 };
 
@@ -180,6 +202,115 @@ eth_pcap_gather_data(unsigned char *data, struct rte_mbuf *mbuf)
 	}
 }
 
+/* Add the bytes earned since the last burst to the pacing budget */
+static inline void
+eth_pcap_rx_pace(struct pcap_rx_queue *pcap_q)
+{
+	uint64_t now = rte_get_timer_cycles();
+	uint64_t cycles = RTE_MIN(now - pcap_q->last_cycles, hz / 10);
+	uint64_t burst = RTE_MAX(pcap_q->rate / 1000,
+				 2 * (uint64_t)RTE_ETH_PCAP_SNAPSHOT_LEN);
+	uint64_t earned = cycles * pcap_q->rate / hz;
+
+	/* at low rates, let cycles accumulate until they are worth a byte */
+	if (earned == 0)
+		return;
+	pcap_q->last_cycles = now;
+	pcap_q->tokens += earned;
+	if (pcap_q->tokens > burst)
+		pcap_q->tokens = burst;
+}
+
+/*
+ * Read packets straight from the mapping of a capture file: mbufs are
+ * allocated in bulk and the records are copied without any intermediate
+ * buffer.
+ */
+static uint16_t
+eth_pcap_rx_file(struct pcap_rx_queue *pcap_q, struct rte_mbuf **bufs,
+		uint16_t nb_pkts)
+{
+	struct pcap_file_reader *reader = pcap_q->reader;
+	struct pcap_file_pkt pkt;
+	struct rte_mbuf *mbuf;
+	uint16_t num_rx = 0, num_used;
+	uint16_t buf_size;
+	uint32_t rx_bytes = 0;
+	uint32_t caplen;
+	int rewound = 0;
+
+	if (pcap_file_peek(reader, &pkt) != 0) {
+		if (!pcap_q->infinite_rx)
+			return 0;
+		pcap_file_reader_rewind(reader);
+		rewound = 1;
+		if (pcap_file_peek(reader, &pkt) != 0)
+			return 0;
+	}
+
+	if (pcap_q->rate) {
+		eth_pcap_rx_pace(pcap_q);
+		if (pcap_q->tokens < RTE_MIN(pkt.caplen,
+				(uint32_t)RTE_ETH_PCAP_SNAPSHOT_LEN))
+			return 0;
+	}
+
+	if (unlikely(rte_pktmbuf_alloc_bulk(pcap_q->mb_pool, bufs,
+					    nb_pkts) != 0))
+		return 0;
+
+	buf_size = rte_pktmbuf_data_room_size(pcap_q->mb_pool) -
+			RTE_PKTMBUF_HEADROOM;
+
+	for (num_used = 0; num_used < nb_pkts; ) {
+		if (pcap_file_peek(reader, &pkt) != 0) {
+			if (!pcap_q->infinite_rx || rewound)
+				break;
+			pcap_file_reader_rewind(reader);
+			rewound = 1;
+			continue;
+		}
+
+		caplen = RTE_MIN(pkt.caplen,
+				(uint32_t)RTE_ETH_PCAP_SNAPSHOT_LEN);
+		if (pcap_q->rate) {
+			if (pcap_q->tokens < caplen)
+				break;
+			pcap_q->tokens -= caplen;
+		}
+		pcap_file_advance(reader);
+
+		mbuf = bufs[num_used++];
+		if (caplen <= buf_size) {
+			rte_memcpy(rte_pktmbuf_mtod(mbuf, void *), pkt.data,
+					caplen);
+			mbuf->data_len = (uint16_t)caplen;
+		} else if (unlikely(eth_pcap_rx_jumbo(pcap_q->mb_pool,
+						mbuf, pkt.data, caplen) == -1)) {
+			rte_pktmbuf_free(mbuf);
+			pcap_q->rx_stat.err_pkts++;
+			break;
+		}
+
+		mbuf->pkt_len = caplen;
+		mbuf->port = pcap_q->in_port;
+		mbuf->timestamp = pkt.ts;
+		mbuf->ol_flags |= PKT_RX_TIMESTAMP;
+		bufs[num_rx++] = mbuf;
+		rx_bytes += caplen;
+	}
+
+	/* give back the mbufs allocated for records not read */
+	if (num_used < nb_pkts)
+		rte_mempool_put_bulk(pcap_q->mb_pool,
+				(void **)&bufs[num_used], nb_pkts - num_used);
+
+	pcap_q->rx_stat.pkts += num_rx;
+	pcap_q->rx_stat.bytes += rx_bytes;
+
+	return num_rx;
+}
+
 static uint16_t
 eth_pcap_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
@@ -192,6 +323,9 @@ eth_pcap_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	uint16_t buf_size;
 	uint32_t rx_bytes = 0;
 
+	if (pcap_q->reader != NULL)
+		return eth_pcap_rx_file(pcap_q, bufs, nb_pkts);
+
 	if (unlikely(pcap_q->pcap == NULL || nb_pkts == 0))
 		return 0;
 
@@ -251,6 +385,48 @@ calculate_timestamp(struct timeval *ts) {
 	timeradd(&start_time, &cur_time, ts);
 }
 
+static inline uint64_t
+calculate_timestamp_ns(void)
+{
+	uint64_t cycles;
+
+	cycles = rte_get_timer_cycles() - start_cycles;
+	return start_ns + cycles / hz * NS_PER_S +
+		(cycles % hz) * NS_PER_S / hz;
+}
+
+/*
+ * Write packets to a pcapng file: one write() per burst, nanosecond
+ * timestamps.
+ */
+static uint16_t
+eth_pcapng_tx_dumper(struct pcap_tx_queue *dumper_q, struct rte_mbuf **bufs,
+		uint16_t nb_pkts)
+{
+	unsigned int i;
+	struct rte_mbuf *mbuf;
+	uint16_t num_tx = 0;
+	uint32_t tx_bytes = 0;
+
+	for (i = 0; i < nb_pkts; i++) {
+		mbuf = bufs[i];
+		if (unlikely(pcap_file_write(dumper_q->writer, mbuf,
+					     calculate_timestamp_ns()) < 0))
+			break;
+		num_tx++;
+		tx_bytes += mbuf->pkt_len;
+		rte_pktmbuf_free(mbuf);
+	}
+
+	/* same as with libpcap dumpers, the file is complete after a burst */
+	pcap_file_writer_flush(dumper_q->writer);
+	dumper_q->tx_stat.pkts += num_tx;
+	dumper_q->tx_stat.bytes += tx_bytes;
+	dumper_q->tx_stat.err_pkts += nb_pkts - num_tx;
+
+	return num_tx;
+}
+
 /*
  * Callback to handle writing packets to a pcap file.
  */
@@ -264,6 +440,9 @@ eth_pcap_tx_dumper(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	uint32_t tx_bytes = 0;
 	struct pcap_pkthdr header;
 
+	if (dumper_q->writer != NULL && nb_pkts != 0)
+		return eth_pcapng_tx_dumper(dumper_q, bufs, nb_pkts);
+
 	if (dumper_q->dumper == NULL || nb_pkts == 0)
 		return 0;
 
@@ -392,6 +571,31 @@ open_single_iface(const char *iface, pcap_t **pcap)
 	return 0;
 }
 
+static int
+is_pcapng_file(const char *pcap_filename)
+{
+	size_t len = strlen(pcap_filename);
+	size_t suffix_len = strlen(ETH_PCAPNG_SUFFIX);
+
+	return len > suffix_len && strcmp(pcap_filename + len - suffix_len,
+			ETH_PCAPNG_SUFFIX) == 0;
+}
+
+static int
+open_single_tx_pcapng(const char *pcap_filename, const char *if_name,
+		struct pcap_file_writer **writer)
+{
+	*writer = pcap_file_writer_open(pcap_filename, if_name,
+			RTE_ETH_PCAP_SNAPSHOT_LEN);
+	if (*writer == NULL) {
+		RTE_LOG(ERR, PMD, "Couldn't open %s for writing: %s\n",
+			pcap_filename, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
 static int
 open_single_tx_pcap(const char *pcap_filename, pcap_dumper_t **dumper)
 {
@@ -421,15 +625,33 @@ open_single_tx_pcap(const char *pcap_filename, pcap_dumper_t **dumper)
 	return 0;
 }
 
+/*
+ * Capture files are mapped and parsed by the PMD itself, libpcap is only
+ * used for the formats it does not know.
+ */
 static int
-open_single_rx_pcap(const char *pcap_filename, pcap_t **pcap)
+open_single_rx_pcap(const char *pcap_filename, pcap_t **pcap,
+		struct pcap_file_reader **reader, int infinite_rx)
 {
+	*pcap = NULL;
+	*reader = pcap_file_reader_open(pcap_filename, infinite_rx);
+	if (*reader != NULL)
+		return 0;
+	if (errno != EPROTONOSUPPORT) {
+		RTE_LOG(ERR, PMD, "Couldn't open %s: %s\n", pcap_filename,
+			strerror(errno));
+		return -1;
+	}
+
 	*pcap = pcap_open_offline(pcap_filename, errbuf);
 	if (*pcap == NULL) {
 		RTE_LOG(ERR, PMD, "Couldn't open %s: %s\n", pcap_filename,
 			errbuf);
 		return -1;
 	}
+	if (infinite_rx)
+		RTE_LOG(WARNING, PMD, "%s: infinite Rx not supported for this format\n",
+			pcap_filename);
 
 	return 0;
 }
@@ -459,10 +681,17 @@ eth_dev_start(struct rte_eth_dev *dev)
 	for (i = 0; i < dev->data->nb_tx_queues; i++) {
 		tx = &internals->tx_queue[i];
 
-		if (!tx->dumper &&
+		if (!tx->dumper && !tx->writer &&
 				strcmp(tx->type, ETH_PCAP_TX_PCAP_ARG) == 0) {
-			if (open_single_tx_pcap(tx->name, &tx->dumper) < 0)
+			if (is_pcapng_file(tx->name)) {
+				if (open_single_tx_pcapng(tx->name,
+						dev->data->name,
+						&tx->writer) < 0)
+					return -1;
+			} else if (open_single_tx_pcap(tx->name,
+						&tx->dumper) < 0) {
 				return -1;
+			}
 		} else if (!tx->pcap &&
 				strcmp(tx->type, ETH_PCAP_TX_IFACE_ARG) == 0) {
 			if (open_single_iface(tx->name, &tx->pcap) < 0)
@@ -474,11 +703,12 @@ eth_dev_start(struct rte_eth_dev *dev)
 	for (i = 0; i < dev->data->nb_rx_queues; i++) {
 		rx = &internals->rx_queue[i];
 
-		if (rx->pcap != NULL)
+		if (rx->pcap != NULL || rx->reader != NULL)
 			continue;
 
 		if (strcmp(rx->type, ETH_PCAP_RX_PCAP_ARG) == 0) {
-			if (open_single_rx_pcap(rx->name, &rx->pcap) < 0)
+			if (open_single_rx_pcap(rx->name, &rx->pcap,
+					&rx->reader, rx->infinite_rx) < 0)
 				return -1;
 		} else if (strcmp(rx->type, ETH_PCAP_RX_IFACE_ARG) == 0) {
 			if (open_single_iface(rx->name, &rx->pcap) < 0)
@@ -523,6 +753,11 @@ eth_dev_stop(struct rte_eth_dev *dev)
 			tx->dumper = NULL;
 		}
 
+		if (tx->writer != NULL) {
+			pcap_file_writer_close(tx->writer);
+			tx->writer = NULL;
+		}
+
 		if (tx->pcap != NULL) {
 			pcap_close(tx->pcap);
 			tx->pcap = NULL;
@@ -536,6 +771,11 @@ eth_dev_stop(struct rte_eth_dev *dev)
 			pcap_close(rx->pcap);
 			rx->pcap = NULL;
 		}
+
+		if (rx->reader != NULL) {
+			pcap_file_reader_close(rx->reader);
+			rx->reader = NULL;
+		}
 	}
 
 status_down:
@@ -690,13 +930,16 @@ open_rx_pcap(const char *key, const char *value, void *extra_args)
 	unsigned int i;
 	const char *pcap_filename = value;
 	struct pmd_devargs *rx = extra_args;
+	struct pcap_file_reader *reader = NULL;
 	pcap_t *pcap = NULL;
 
 	for (i = 0; i < rx->num_of_queue; i++) {
-		if (open_single_rx_pcap(pcap_filename, &pcap) < 0)
+		if (open_single_rx_pcap(pcap_filename, &pcap, &reader,
+				rx->infinite_rx) < 0)
 			return -1;
 
 		rx->queue[i].pcap = pcap;
+		rx->queue[i].reader = reader;
 		rx->queue[i].name = pcap_filename;
 		rx->queue[i].type = key;
 	}
@@ -714,13 +957,20 @@ open_tx_pcap(const char *key, const char *value, void *extra_args)
 	unsigned int i;
 	const char *pcap_filename = value;
 	struct pmd_devargs *dumpers = extra_args;
-	pcap_dumper_t *dumper;
+	struct pcap_file_writer *writer = NULL;
+	pcap_dumper_t *dumper = NULL;
 
 	for (i = 0; i < dumpers->num_of_queue; i++) {
-		if (open_single_tx_pcap(pcap_filename, &dumper) < 0)
+		if (is_pcapng_file(pcap_filename)) {
+			if (open_single_tx_pcapng(pcap_filename,
+					dumpers->dev_name, &writer) < 0)
+				return -1;
+		} else if (open_single_tx_pcap(pcap_filename, &dumper) < 0) {
 			return -1;
+		}
 
 		dumpers->queue[i].dumper = dumper;
+		dumpers->queue[i].writer = writer;
 		dumpers->queue[i].name = pcap_filename;
 		dumpers->queue[i].type = key;
 	}
@@ -792,6 +1042,22 @@ open_tx_iface(const char *key, const char *value, void *extra_args)
 	return 0;
 }
 
+static int
+get_uint_arg(const char *key, const char *value, void *extra_args)
+{
+	unsigned long *out = extra_args;
+	char *end;
+
+	errno = 0;
+	*out = strtoul(value, &end, 10);
+	if (errno != 0 || end == value || *end != '\0') {
+		RTE_LOG(ERR, PMD, "Invalid %s value: %s\n", key, value);
+		return -1;
+	}
+
+	return 0;
+}
+
 static struct rte_vdev_driver pmd_pcap_drv;
 
 static int
@@ -872,6 +1138,9 @@ eth_from_pcaps_common(struct rte_vdev_device *vdev,
 		struct devargs_queue *queue = &rx_queues->queue[i];
 
 		rx->pcap = queue->pcap;
+		rx->reader = queue->reader;
+		rx->infinite_rx = rx_queues->infinite_rx;
+		rx->rate = rx_queues->rx_rate;
 		snprintf(rx->name, sizeof(rx->name), "%s", queue->name);
 		snprintf(rx->type, sizeof(rx->type), "%s", queue->type);
 	}
@@ -881,6 +1150,7 @@ eth_from_pcaps_common(struct rte_vdev_device *vdev,
 		struct devargs_queue *queue = &tx_queues->queue[i];
 
 		tx->dumper = queue->dumper;
+		tx->writer = queue->writer;
 		tx->pcap = queue->pcap;
 		snprintf(tx->name, sizeof(tx->name), "%s", queue->name);
 		snprintf(tx->type, sizeof(tx->type), "%s", queue->type);
@@ -938,6 +1208,9 @@ pmd_pcap_probe(struct rte_vdev_device *dev)
 	struct rte_kvargs *kvlist;
 	struct pmd_devargs pcaps = {0};
 	struct pmd_devargs dumpers = {0};
+	struct timespec start_ts;
+	unsigned long infinite_rx = 0;
+	unsigned long rx_rate = 0;
 	int single_iface = 0;
 	int ret;
 
@@ -945,6 +1218,8 @@ pmd_pcap_probe(struct rte_vdev_device *dev)
 	RTE_LOG(INFO, PMD, "Initializing pmd_pcap for %s\n", name);
 
 	gettimeofday(&start_time, NULL);
+	clock_gettime(CLOCK_REALTIME, &start_ts);
+	start_ns = start_ts.tv_sec * NS_PER_S + start_ts.tv_nsec;
 	start_cycles = rte_get_timer_cycles();
 	hz = rte_get_timer_hz();
 
@@ -952,6 +1227,22 @@ pmd_pcap_probe(struct rte_vdev_device *dev)
 	if (kvlist == NULL)
 		return -1;
 
+	pcaps.dev_name = name;
+	dumpers.dev_name = name;
+
+	ret = rte_kvargs_process(kvlist, ETH_PCAP_INFINITE_RX_ARG,
+			&get_uint_arg, &infinite_rx);
+	if (ret < 0)
+		goto free_kvlist;
+	pcaps.infinite_rx = !!infinite_rx;
+
+	ret = rte_kvargs_process(kvlist, ETH_PCAP_RX_RATE_ARG,
+			&get_uint_arg, &rx_rate);
+	if (ret < 0)
+		goto free_kvlist;
+	/* Mbit/s to bytes per second */
+	pcaps.rx_rate = rx_rate * 1000000ULL / 8;
+
 	/*
 	 * If iface argument is passed we open the NICs and use them for
 	 * reading / writing
@@ -1067,4 +1358,6 @@ RTE_PMD_REGISTER_PARAM_STRING(net_pcap,
 	ETH_PCAP_TX_PCAP_ARG "=<string> "
 	ETH_PCAP_RX_IFACE_ARG "=<ifc> "
 	ETH_PCAP_TX_IFACE_ARG "=<ifc> "
-	ETH_PCAP_IFACE_ARG "=<ifc>");
+	ETH_PCAP_IFACE_ARG "=<ifc> "
+	ETH_PCAP_INFINITE_RX_ARG "=<0|1> "
+	ETH_PCAP_RX_RATE_ARG "=<Mbps>");
@@ -123,9 +123,7 @@ static int
 tun_alloc(struct pmd_internals *pmd)
 {
 	struct ifreq ifr;
-#ifdef IFF_MULTI_QUEUE
 	unsigned int features;
-#endif
 	int fd;
 
 	memset(&ifr, 0, sizeof(struct ifreq));
@@ -145,7 +143,6 @@ tun_alloc(struct pmd_internals *pmd)
 		goto error;
 	}
 
-#ifdef IFF_MULTI_QUEUE
 	/* Grab the TUN features to verify we can work multi-queue */
 	if (ioctl(fd, TUNGETFEATURES, &features) < 0) {
 		RTE_LOG(ERR, PMD, "TAP unable to get TUN/TAP features\n");
@@ -153,6 +150,17 @@ tun_alloc(struct pmd_internals *pmd)
 	}
 	RTE_LOG(DEBUG, PMD, "  TAP Features %08x\n", features);
 
+	/*
+	 * The virtio-net header carries checksum and GSO information in both
+	 * directions, allowing TSO superframes and partially checksummed
+	 * packets to be exchanged with the kernel.
+	 */
+	if (features & IFF_VNET_HDR) {
+		ifr.ifr_flags |= IFF_VNET_HDR;
+		pmd->vnet_hdr = 1;
+	}
+
+#ifdef IFF_MULTI_QUEUE
 	if (features & IFF_MULTI_QUEUE) {
 		RTE_LOG(DEBUG, PMD, "  Multi-queue support for %d queues\n",
 			RTE_PMD_TAP_MAX_QUEUES);
@@ -266,6 +274,9 @@ tap_verify_csum(struct rte_mbuf *mbuf)
 		/* IPv6 extensions are not supported */
 		return;
 	}
+	/* L4 checksum status may already be known from the vnet header */
+	if (mbuf->ol_flags & PKT_RX_L4_CKSUM_MASK)
+		return;
 	if (l4 == RTE_PTYPE_L4_UDP || l4 == RTE_PTYPE_L4_TCP) {
 		l4_hdr = rte_pktmbuf_mtod_offset(mbuf, void *, l2_len + l3_len);
 		/* Don't verify checksum for multi-segment packets. */
@@ -281,6 +292,34 @@ tap_verify_csum(struct rte_mbuf *mbuf)
 	}
 }
 
+/* Translate the virtio-net header written by the kernel into mbuf offload
+ * flags. Checksums of locally generated packets are left partial by the
+ * kernel and GRO/GSO frames are given as a single superframe.
+ */
+static int
+tap_rx_offload(struct rte_mbuf *mbuf, const struct virtio_net_hdr *hdr)
+{
+	if (hdr->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM)
+		mbuf->ol_flags |= PKT_RX_L4_CKSUM_NONE;
+	else if (hdr->flags & VIRTIO_NET_HDR_F_DATA_VALID)
+		mbuf->ol_flags |= PKT_RX_L4_CKSUM_GOOD;
+
+	if (hdr->gso_type == VIRTIO_NET_HDR_GSO_NONE)
+		return 0;
+	switch (hdr->gso_type) {
+	case VIRTIO_NET_HDR_GSO_TCPV4:
+	case VIRTIO_NET_HDR_GSO_TCPV6:
+		if (hdr->gso_size == 0)
+			return -EINVAL;
+		mbuf->tso_segsz = hdr->gso_size;
+		mbuf->ol_flags |= PKT_RX_LRO;
+		return 0;
+	default:
+		/* ECN and UDP fragmentation are not supported */
+		return -EINVAL;
+	}
+}
+
 /* Callback to handle the rx burst of packets to the correct interface and
  * file descriptor(s) in a multi-queue setup.
  */
@@ -307,16 +346,16 @@ pmd_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		len = readv(rxq->fd, *rxq->iovecs,
 			    1 + (rxq->rxmode->enable_scatter ?
 				 rxq->nb_rx_desc : 1));
-		if (len < (int)sizeof(struct tun_pi))
+		if (len < (int)(*rxq->iovecs)[0].iov_len)
 			break;
 
 		/* Packet couldn't fit in the provided mbuf */
-		if (unlikely(rxq->pi.flags & TUN_PKT_STRIP)) {
+		if (unlikely(rxq->hdr.pi.flags & TUN_PKT_STRIP)) {
 			rxq->stats.ierrors++;
 			continue;
 		}
 
-		len -= sizeof(struct tun_pi);
+		len -= (*rxq->iovecs)[0].iov_len;
 
 		mbuf->pkt_len = len;
 		mbuf->port = rxq->in_port;
@@ -361,6 +400,12 @@ pmd_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		seg->next = NULL;
 		mbuf->packet_type = rte_net_get_ptype(mbuf, NULL,
 						      RTE_PTYPE_ALL_MASK);
+		if (rxq->vnet_hdr &&
+		    unlikely(tap_rx_offload(mbuf, &rxq->hdr.vnet) < 0)) {
+			rte_pktmbuf_free(mbuf);
+			rxq->stats.ierrors++;
+			continue;
+		}
 		if (rxq->rxmode->hw_ip_checksum)
 			tap_verify_csum(mbuf);
 
@@ -425,6 +470,75 @@ tap_tx_offload(char *packet, uint64_t ol_flags, unsigned int l2_len,
 	}
 }
 
+/* With TSO, the kernel expects the TCP checksum field to hold the pseudo
+ * header checksum including the payload length, whereas the DPDK API
+ * provides it without. Also compute the IPv4 header checksum, which is only
+ * refreshed by the kernel on the resulting segments.
+ */
+static void
+tap_tso_fix_cksum(struct rte_mbuf *mbuf)
+{
+	struct ipv4_hdr *iph;
+	struct tcp_hdr *th;
+	uint16_t ip_paylen;
+	uint32_t cksum;
+
+	/* headers are expected in the first segment */
+	if (unlikely(rte_pktmbuf_data_len(mbuf) <
+		     mbuf->l2_len + mbuf->l3_len + mbuf->l4_len))
+		return;
+	iph = rte_pktmbuf_mtod_offset(mbuf, struct ipv4_hdr *, mbuf->l2_len);
+	th = RTE_PTR_ADD(iph, mbuf->l3_len);
+	if ((iph->version_ihl >> 4) == 4) {
+		iph->hdr_checksum = 0;
+		iph->hdr_checksum = rte_ipv4_cksum(iph);
+		ip_paylen = rte_cpu_to_be_16(rte_be_to_cpu_16(iph->total_length) -
+					     mbuf->l3_len);
+	} else {
+		ip_paylen = ((struct ipv6_hdr *)iph)->payload_len;
+	}
+	cksum = th->cksum;
+	cksum += ip_paylen;
+	cksum = (cksum & 0xffff) + (cksum >> 16);
+	th->cksum = cksum;
+}
+
+/* Fill the virtio-net header so that the kernel completes L4 checksums and
+ * segments TSO superframes on our behalf. The pseudo header checksum must
+ * already be set in the packet, as for any hardware L4 checksum offload.
+ */
+static void
+tap_tx_vnet_hdr(struct rte_mbuf *mbuf, struct virtio_net_hdr *hdr)
+{
+	uint64_t ol_flags = mbuf->ol_flags;
+
+	memset(hdr, 0, sizeof(*hdr));
+	if (ol_flags & PKT_TX_TCP_SEG)
+		ol_flags |= PKT_TX_TCP_CKSUM;
+	switch (ol_flags & PKT_TX_L4_MASK) {
+	case PKT_TX_UDP_CKSUM:
+		hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+		hdr->csum_start = mbuf->l2_len + mbuf->l3_len;
+		hdr->csum_offset = offsetof(struct udp_hdr, dgram_cksum);
+		break;
+	case PKT_TX_TCP_CKSUM:
+		hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+		hdr->csum_start = mbuf->l2_len + mbuf->l3_len;
+		hdr->csum_offset = offsetof(struct tcp_hdr, cksum);
+		break;
+	default:
+		break;
+	}
+	if (ol_flags & PKT_TX_TCP_SEG) {
+		tap_tso_fix_cksum(mbuf);
+		hdr->gso_type = (ol_flags & PKT_TX_IPV6) ?
+			VIRTIO_NET_HDR_GSO_TCPV6 :
+			VIRTIO_NET_HDR_GSO_TCPV4;
+		hdr->gso_size = mbuf->tso_segsz;
+		hdr->hdr_len = mbuf->l2_len + mbuf->l3_len + mbuf->l4_len;
+	}
+}
+
 /* Callback to handle sending packets from the tap interface
  */
 static uint16_t
@@ -443,34 +557,44 @@ pmd_tx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	for (i = 0; i < nb_pkts; i++) {
 		struct rte_mbuf *mbuf = bufs[num_tx];
 		struct iovec iovecs[mbuf->nb_segs + 1];
-		struct tun_pi pi = { .flags = 0 };
+		struct tap_pkt_hdr hdr = { .pi = { .flags = 0 } };
 		struct rte_mbuf *seg = mbuf;
+		uint64_t sw_ol_flags = mbuf->ol_flags;
 		char m_copy[mbuf->data_len];
 		int n;
 		int j;
 
+		if (txq->vnet_hdr) {
+			tap_tx_vnet_hdr(mbuf, &hdr.vnet);
+			/* L4 checksums and TSO are done by the kernel */
+			sw_ol_flags &= ~PKT_TX_L4_MASK;
+			if (mbuf->ol_flags & PKT_TX_TCP_SEG)
+				sw_ol_flags = 0;
+		}
 		/* stats.errs will be incremented */
-		if (rte_pktmbuf_pkt_len(mbuf) > max_size)
+		if (rte_pktmbuf_pkt_len(mbuf) > max_size &&
+		    !(txq->vnet_hdr && (mbuf->ol_flags & PKT_TX_TCP_SEG)))
 			break;
 
-		iovecs[0].iov_base = &pi;
-		iovecs[0].iov_len = sizeof(pi);
+		iovecs[0].iov_base = &hdr;
+		iovecs[0].iov_len = sizeof(hdr.pi) +
+			(txq->vnet_hdr ? sizeof(hdr.vnet) : 0);
 		for (j = 1; j <= mbuf->nb_segs; j++) {
 			iovecs[j].iov_len = rte_pktmbuf_data_len(seg);
 			iovecs[j].iov_base =
 				rte_pktmbuf_mtod(seg, void *);
 			seg = seg->next;
 		}
-		if (mbuf->ol_flags & (PKT_TX_IP_CKSUM | PKT_TX_IPV4) ||
-		    (mbuf->ol_flags & PKT_TX_L4_MASK) == PKT_TX_UDP_CKSUM ||
-		    (mbuf->ol_flags & PKT_TX_L4_MASK) == PKT_TX_TCP_CKSUM) {
+		if (sw_ol_flags & (PKT_TX_IP_CKSUM | PKT_TX_IPV4) ||
+		    (sw_ol_flags & PKT_TX_L4_MASK) == PKT_TX_UDP_CKSUM ||
+		    (sw_ol_flags & PKT_TX_L4_MASK) == PKT_TX_TCP_CKSUM) {
 			/* Support only packets with all data in the same seg */
 			if (mbuf->nb_segs > 1)
 				break;
 			/* To change checksums, work on a copy of data. */
 			rte_memcpy(m_copy, rte_pktmbuf_mtod(mbuf, void *),
 				   rte_pktmbuf_data_len(mbuf));
-			tap_tx_offload(m_copy, mbuf->ol_flags,
+			tap_tx_offload(m_copy, sw_ol_flags,
 				       mbuf->l2_len, mbuf->l3_len);
 			iovecs[1].iov_base = m_copy;
 		}
@@ -600,6 +724,43 @@ tap_dev_stop(struct rte_eth_dev *dev)
 	tap_link_set_down(dev);
 }
 
+/* Tell the kernel which offloads it may leave to us on Rx: partial
+ * checksums and TSO superframes. Without them, the kernel completes
+ * checksums and segments packets before handing them to the tap.
+ */
+static int
+tap_offload_set(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *pmd = dev->data->dev_private;
+	struct rte_eth_rxmode *rxmode = &dev->data->dev_conf.rxmode;
+	unsigned int offload = 0;
+	int fd;
+
+	if (!pmd->vnet_hdr)
+		return 0;
+	if (rxmode->hw_ip_checksum)
+		offload |= TUN_F_CSUM;
+	if (rxmode->enable_lro) {
+		/* superframes are only readable into chained mbufs */
+		if (!rxmode->enable_scatter) {
+			RTE_LOG(ERR, PMD, "%s: LRO requires scattered Rx\n",
+				dev->device->name);
+			return -EINVAL;
+		}
+		offload |= TUN_F_CSUM | TUN_F_TSO4 | TUN_F_TSO6;
+	}
+	if (offload == pmd->tun_offload)
+		return 0;
+	fd = pmd->rxq[0].fd != -1 ? pmd->rxq[0].fd : pmd->txq[0].fd;
+	if (ioctl(fd, TUNSETOFFLOAD, offload) < 0) {
+		RTE_LOG(ERR, PMD, "%s: TUNSETOFFLOAD(0x%x) failed: %s\n",
+			dev->device->name, offload, strerror(errno));
+		return -errno;
+	}
+	pmd->tun_offload = offload;
+	return 0;
+}
+
 static int
 tap_dev_configure(struct rte_eth_dev *dev)
 {
@@ -626,7 +787,7 @@ tap_dev_configure(struct rte_eth_dev *dev)
 	RTE_LOG(INFO, PMD, "%s: %p: RX configured queues number: %u\n",
 	     dev->device->name, (void *)dev, dev->data->nb_rx_queues);
 
-	return 0;
+	return tap_offload_set(dev);
 }
 
 static uint32_t
@@ -683,6 +844,10 @@ tap_dev_info(struct rte_eth_dev *dev, struct rte_eth_dev_info *dev_info)
 		(DEV_TX_OFFLOAD_IPV4_CKSUM |
 		 DEV_TX_OFFLOAD_UDP_CKSUM |
 		 DEV_TX_OFFLOAD_TCP_CKSUM);
+	if (internals->vnet_hdr) {
+		dev_info->rx_offload_capa |= DEV_RX_OFFLOAD_TCP_LRO;
+		dev_info->tx_offload_capa |= DEV_TX_OFFLOAD_TCP_TSO;
+	}
 }
 
 static int
@@ -967,7 +1132,9 @@ tap_setup_queue(struct rte_eth_dev *dev,
 	}
 
 	tx->mtu = &dev->data->mtu;
+	tx->vnet_hdr = pmd->vnet_hdr;
 	rx->rxmode = &dev->data->dev_conf.rxmode;
+	rx->vnet_hdr = pmd->vnet_hdr;
 
 	return *fd;
 }
@@ -1019,8 +1186,9 @@ tap_rx_queue_setup(struct rte_eth_dev *dev,
 		goto error;
 	}
 
-	(*rxq->iovecs)[0].iov_len = sizeof(struct tun_pi);
-	(*rxq->iovecs)[0].iov_base = &rxq->pi;
+	(*rxq->iovecs)[0].iov_len = sizeof(rxq->hdr.pi) +
+		(rxq->vnet_hdr ? sizeof(rxq->hdr.vnet) : 0);
+	(*rxq->iovecs)[0].iov_base = &rxq->hdr;
 
 	for (i = 1; i <= nb_desc; i++) {
 		*tmp = rte_pktmbuf_alloc(rxq->mp);
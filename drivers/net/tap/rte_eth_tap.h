@@ -40,6 +40,7 @@
 #include <net/if.h>
 
 #include <linux/if_tun.h>
+#include <linux/virtio_net.h>
 
 #include <rte_ethdev.h>
 #include <rte_ether.h>
@@ -60,6 +61,15 @@ struct pkt_stats {
 	uint64_t rx_nombuf;             /* Nb of RX mbuf alloc failures */
 };
 
+/*
+ * Header prepended by the kernel to every frame read from or written to the
+ * tap fd. The virtio-net part is only present when IFF_VNET_HDR is in use.
+ */
+struct tap_pkt_hdr {
+	struct tun_pi pi;               /* packet info */
+	struct virtio_net_hdr vnet;     /* checksum/GSO offload info */
+};
+
 struct rx_queue {
 	struct rte_mempool *mp;         /* Mempool for RX packets */
 	uint32_t trigger_seen;          /* Last seen Rx trigger value */
@@ -70,12 +80,14 @@ struct rx_queue {
 	struct rte_eth_rxmode *rxmode;  /* RX features */
 	struct rte_mbuf *pool;          /* mbufs pool for this queue */
 	struct iovec (*iovecs)[];       /* descriptors for this queue */
-	struct tun_pi pi;               /* packet info for iovecs */
+	struct tap_pkt_hdr hdr;         /* packet info for iovecs */
+	int vnet_hdr;                   /* 1 if IFF_VNET_HDR is in use */
 };
 
 struct tx_queue {
 	int fd;
 	uint16_t *mtu;                  /* Pointer to MTU from dev_data */
+	int vnet_hdr;                   /* 1 if IFF_VNET_HDR is in use */
 	struct pkt_stats stats;         /* Stats for this TX queue */
 };
 
@@ -90,6 +102,8 @@ struct pmd_internals {
 	int ioctl_sock;                   /* socket for ioctl calls */
 	int nlsk_fd;                      /* Netlink socket fd */
 	int flow_isolate;                 /* 1 if flow isolation is enabled */
+	int vnet_hdr;                     /* 1 if IFF_VNET_HDR is in use */
+	unsigned int tun_offload;         /* TUN_F_* flags set on the device */
 	LIST_HEAD(tap_flows, rte_flow) flows;        /* rte_flow rules */
 	/* implicit rte_flow rules set when a remote device is active */
 	LIST_HEAD(tap_implicit_flows, rte_flow) implicit_flows;
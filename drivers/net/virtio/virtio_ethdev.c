@@ -161,6 +161,85 @@ static const struct rte_virtio_xstats_name_off rte_virtio_txq_stat_strings[] = {
 
 struct virtio_hw_internal virtio_hw_internal[RTE_MAX_ETHPORTS];
 
+/*
+ * Same format as on the split ring below, the descriptors of the chain
+ * being consecutive in the packed ring. The head flags are written last
+ * to make the whole chain available at once.
+ */
+static int
+virtio_send_command_packed(struct virtnet_ctl *cvq,
+			   struct virtio_pmd_ctrl *ctrl,
+			   int *dlen, int pkt_num)
+{
+	struct virtqueue *vq = cvq->vq;
+	struct vring_packed_desc *desc = vq->ring_packed.desc_packed;
+	struct virtio_pmd_ctrl *result;
+	uint16_t head, idx, id, head_flags, nb_descs = 0;
+	int k, sum = 0;
+
+	head = vq->vq_avail_idx;
+	head_flags = vq->vq_packed_flags | VRING_DESC_F_NEXT;
+	id = vq_packed_get_id(vq);
+
+	desc[head].addr = cvq->virtio_net_hdr_mem;
+	desc[head].len = sizeof(struct virtio_net_ctrl_hdr);
+	desc[head].id = id;
+	nb_descs++;
+	vq_packed_inc_avail(vq);
+
+	for (k = 0; k < pkt_num; k++) {
+		idx = vq->vq_avail_idx;
+		desc[idx].addr = cvq->virtio_net_hdr_mem
+			+ sizeof(struct virtio_net_ctrl_hdr)
+			+ sizeof(ctrl->status) + sizeof(uint8_t) * sum;
+		desc[idx].len = dlen[k];
+		desc[idx].id = id;
+		desc[idx].flags = vq->vq_packed_flags | VRING_DESC_F_NEXT;
+		sum += dlen[k];
+		nb_descs++;
+		vq_packed_inc_avail(vq);
+	}
+
+	idx = vq->vq_avail_idx;
+	desc[idx].addr = cvq->virtio_net_hdr_mem
+		+ sizeof(struct virtio_net_ctrl_hdr);
+	desc[idx].len = sizeof(ctrl->status);
+	desc[idx].id = id;
+	desc[idx].flags = vq->vq_packed_flags | VRING_DESC_F_WRITE;
+	nb_descs++;
+	vq_packed_inc_avail(vq);
+
+	vq->vq_free_cnt -= nb_descs;
+	vq->vq_descx[id].ndescs = nb_descs;
+
+	virtio_wmb();
+	desc[head].flags = head_flags;
+
+	PMD_INIT_LOG(DEBUG, "vq->vq_queue_index = %d", vq->vq_queue_index);
+
+	virtqueue_notify(vq);
+
+	/* the device writes back a single used descriptor for the chain */
+	while (!desc_is_used(&desc[vq->vq_used_cons_idx], vq)) {
+		rte_rmb();
+		usleep(100);
+	}
+	virtio_rmb();
+
+	id = desc[vq->vq_used_cons_idx].id;
+	nb_descs = vq->vq_descx[id].ndescs;
+	vq->vq_free_cnt += nb_descs;
+	vq_packed_inc_used(vq, nb_descs);
+	vq_packed_put_id(vq, id);
+
+	PMD_INIT_LOG(DEBUG, "vq->vq_free_cnt=%d\nvq->vq_used_cons_idx=%d",
+			vq->vq_free_cnt, vq->vq_used_cons_idx);
+
+	result = cvq->virtio_net_hdr_mz->addr;
+
+	return result->status;
+}
+
 static int
 virtio_send_command(struct virtnet_ctl *cvq, struct virtio_pmd_ctrl *ctrl,
 		int *dlen, int pkt_num)
@@ -190,6 +269,9 @@ virtio_send_command(struct virtnet_ctl *cvq, struct virtio_pmd_ctrl *ctrl,
 	memcpy(cvq->virtio_net_hdr_mz->addr, ctrl,
 		sizeof(struct virtio_pmd_ctrl));
 
+	if (vtpci_packed_queue(vq->hw))
+		return virtio_send_command_packed(cvq, ctrl, dlen, pkt_num);
+
 	/*
 	 * Format is enforced in qemu code:
 	 * One TX packet for header;
@@ -318,7 +400,6 @@ virtio_init_vring(struct virtqueue *vq)
 	 * Reinitialise since virtio port might have been stopped and restarted
 	 */
 	memset(ring_mem, 0, vq->vq_ring_size);
-	vring_init(vr, size, ring_mem, VIRTIO_PCI_VRING_ALIGN);
 	vq->vq_used_cons_idx = 0;
 	vq->vq_desc_head_idx = 0;
 	vq->vq_avail_idx = 0;
@@ -326,7 +407,17 @@ virtio_init_vring(struct virtqueue *vq)
 	vq->vq_free_cnt = vq->vq_nentries;
 	memset(vq->vq_descx, 0, sizeof(struct vq_desc_extra) * vq->vq_nentries);
 
-	vring_desc_init(vr->desc, size);
+	if (vtpci_packed_queue(vq->hw)) {
+		vring_init_packed(&vq->ring_packed, size, ring_mem,
+				  VIRTIO_PCI_VRING_ALIGN);
+		vring_desc_init_packed(vq, size);
+		vq->avail_wrap_counter = 1;
+		vq->used_wrap_counter = 1;
+		vq->vq_packed_flags = VRING_DESC_F_AVAIL(1);
+	} else {
+		vring_init(vr, size, ring_mem, VIRTIO_PCI_VRING_ALIGN);
+		vring_desc_init(vr->desc, size);
+	}
 
 	/*
 	 * Disable device(host) interrupting guest
@@ -401,7 +492,10 @@ virtio_init_queue(struct rte_eth_dev *dev, uint16_t vtpci_queue_idx)
 	/*
 	 * Reserve a memzone for vring elements
 	 */
-	size = vring_size(vq_size, VIRTIO_PCI_VRING_ALIGN);
+	if (vtpci_packed_queue(hw))
+		size = vring_size_packed(vq_size, VIRTIO_PCI_VRING_ALIGN);
+	else
+		size = vring_size(vq_size, VIRTIO_PCI_VRING_ALIGN);
 	vq->vq_ring_size = RTE_ALIGN_CEIL(size, VIRTIO_PCI_VRING_ALIGN);
 	PMD_INIT_LOG(DEBUG, "vring_size: %d, rounded_vring_size: %d",
 		     size, vq->vq_ring_size);
@@ -1205,6 +1299,10 @@ virtio_negotiate_features(struct virtio_hw *hw, uint64_t req_features)
 			req_features &= ~(1ULL << VIRTIO_NET_F_MTU);
 	}
 
+	/* In-order is only implemented for the packed ring */
+	if (!(host_features & req_features & (1ULL << VIRTIO_F_RING_PACKED)))
+		req_features &= ~(1ULL << VIRTIO_F_IN_ORDER);
+
 	/*
 	 * Negotiate features: Subset of device feature bits are written back
 	 * guest feature bits.
@@ -1266,7 +1364,26 @@ set_rxtx_funcs(struct rte_eth_dev *eth_dev)
 {
 	struct virtio_hw *hw = eth_dev->data->dev_private;
 
-	if (hw->use_simple_rx) {
+	if (vtpci_packed_queue(hw)) {
+		PMD_INIT_LOG(INFO,
+			"virtio: using packed ring %s Rx path on port %u",
+			vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF) ?
+			"mergeable buffer" : "standard",
+			eth_dev->data->port_id);
+		if (vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF))
+			eth_dev->rx_pkt_burst =
+				&virtio_recv_mergeable_pkts_packed;
+		else
+			eth_dev->rx_pkt_burst = &virtio_recv_pkts_packed;
+	} else if (hw->use_simple_rx && hw->vec_path == VIRTIO_VEC_AVX512) {
+		PMD_INIT_LOG(INFO, "virtio: using AVX512 Rx path on port %u",
+			eth_dev->data->port_id);
+		eth_dev->rx_pkt_burst = virtio_recv_pkts_vec_avx512;
+	} else if (hw->use_simple_rx && hw->vec_path == VIRTIO_VEC_AVX2) {
+		PMD_INIT_LOG(INFO, "virtio: using AVX2 Rx path on port %u",
+			eth_dev->data->port_id);
+		eth_dev->rx_pkt_burst = virtio_recv_pkts_vec_avx2;
+	} else if (hw->use_simple_rx) {
 		PMD_INIT_LOG(INFO, "virtio: using simple Rx path on port %u",
 			eth_dev->data->port_id);
 		eth_dev->rx_pkt_burst = virtio_recv_pkts_vec;
@@ -1281,7 +1398,19 @@ set_rxtx_funcs(struct rte_eth_dev *eth_dev)
 		eth_dev->rx_pkt_burst = &virtio_recv_pkts;
 	}
 
-	if (hw->use_simple_tx) {
+	if (vtpci_packed_queue(hw)) {
+		PMD_INIT_LOG(INFO, "virtio: using packed ring Tx path on port %u",
+			eth_dev->data->port_id);
+		eth_dev->tx_pkt_burst = virtio_xmit_pkts_packed;
+	} else if (hw->use_simple_tx && hw->vec_path == VIRTIO_VEC_AVX512) {
+		PMD_INIT_LOG(INFO, "virtio: using AVX512 Tx path on port %u",
+			eth_dev->data->port_id);
+		eth_dev->tx_pkt_burst = virtio_xmit_pkts_vec_avx512;
+	} else if (hw->use_simple_tx && hw->vec_path == VIRTIO_VEC_AVX2) {
+		PMD_INIT_LOG(INFO, "virtio: using AVX2 Tx path on port %u",
+			eth_dev->data->port_id);
+		eth_dev->tx_pkt_burst = virtio_xmit_pkts_vec_avx2;
+	} else if (hw->use_simple_tx) {
 		PMD_INIT_LOG(INFO, "virtio: using simple Tx path on port %u",
 			eth_dev->data->port_id);
 		eth_dev->tx_pkt_burst = virtio_xmit_pkts_simple;
@@ -1699,6 +1828,29 @@ rte_virtio_pmd_init(void)
 	rte_pci_register(&rte_virtio_pmd);
 }
 
+/*
+ * Select the widest vector Rx/Tx paths built in and supported by the CPU.
+ * They keep the ring layout of the simple paths.
+ */
+static uint8_t
+virtio_vec_path_select(struct virtio_hw *hw)
+{
+	if (hw->vec_disabled || vtpci_packed_queue(hw))
+		return VIRTIO_VEC_NONE;
+
+#ifdef CC_AVX512_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW))
+		return VIRTIO_VEC_AVX512;
+#endif
+#ifdef CC_AVX2_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
+		return VIRTIO_VEC_AVX2;
+#endif
+
+	return VIRTIO_VEC_NONE;
+}
+
 /*
  * Configure virtio device
  * It returns 0 on success.
@@ -1777,6 +1929,7 @@ virtio_dev_configure(struct rte_eth_dev *dev)
 
 	hw->use_simple_rx = 1;
 	hw->use_simple_tx = 1;
+	hw->vec_path = virtio_vec_path_select(hw);
 
 #if defined RTE_ARCH_ARM64 || defined RTE_ARCH_ARM
 	if (!rte_cpu_get_flag_enabled(RTE_CPUFLAG_NEON)) {
@@ -1784,14 +1937,22 @@ virtio_dev_configure(struct rte_eth_dev *dev)
 		hw->use_simple_tx = 0;
 	}
 #endif
-	if (vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF)) {
+	/* the wide vector paths handle mergeable buffers and offloads */
+	if (vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF) &&
+			hw->vec_path == VIRTIO_VEC_NONE) {
 		hw->use_simple_rx = 0;
 		hw->use_simple_tx = 0;
 	}
 
-	if (rxmode->hw_ip_checksum)
+	if (rxmode->hw_ip_checksum && hw->vec_path == VIRTIO_VEC_NONE)
 		hw->use_simple_rx = 0;
 
+	/* the simple paths rely on the split ring layout */
+	if (vtpci_packed_queue(hw)) {
+		hw->use_simple_rx = 0;
+		hw->use_simple_tx = 0;
+	}
+
 	return 0;
 }
 
@@ -76,6 +76,25 @@ virtio_dev_rx_queue_done(void *rxq, uint16_t offset)
 	struct virtnet_rx *rxvq = rxq;
 	struct virtqueue *vq = rxvq->vq;
 
+	if (vtpci_packed_queue(vq->hw)) {
+		struct vring_packed_desc *desc = vq->ring_packed.desc_packed;
+		uint16_t idx, wrap, flags;
+
+		if (offset == 0)
+			return 1;
+
+		/* one descriptor per received buffer */
+		idx = vq->vq_used_cons_idx + offset - 1;
+		wrap = vq->used_wrap_counter;
+		if (idx >= vq->vq_nentries) {
+			idx -= vq->vq_nentries;
+			wrap ^= 1;
+		}
+		flags = *(volatile uint16_t *)&desc[idx].flags;
+		return !!(flags & VRING_DESC_F_AVAIL(1)) == wrap &&
+			!!(flags & VRING_DESC_F_USED(1)) == wrap;
+	}
+
 	return VIRTQUEUE_NUSED(vq) >= offset;
 }
 
@@ -147,6 +166,45 @@ virtqueue_dequeue_burst_rx(struct virtqueue *vq, struct rte_mbuf **rx_pkts,
 	return i;
 }
 
+static uint16_t
+virtqueue_dequeue_burst_rx_packed(struct virtqueue *vq,
+				  struct rte_mbuf **rx_pkts,
+				  uint32_t *len, uint16_t num)
+{
+	struct vring_packed_desc *desc = vq->ring_packed.desc_packed;
+	struct rte_mbuf *cookie;
+	uint16_t used_idx, id;
+	uint16_t i;
+
+	for (i = 0; i < num; i++) {
+		used_idx = vq->vq_used_cons_idx;
+		if (!desc_is_used(&desc[used_idx], vq))
+			break;
+
+		/* read the descriptor only once it is known to be used */
+		virtio_rmb();
+		len[i] = desc[used_idx].len;
+		id = desc[used_idx].id;
+		cookie = (struct rte_mbuf *)vq->vq_descx[id].cookie;
+
+		if (unlikely(cookie == NULL)) {
+			PMD_DRV_LOG(ERR, "vring descriptor with no mbuf cookie at %u",
+				vq->vq_used_cons_idx);
+			break;
+		}
+
+		rte_prefetch0(cookie);
+		rte_packet_prefetch(rte_pktmbuf_mtod(cookie, void *));
+		rx_pkts[i]  = cookie;
+		vq->vq_descx[id].cookie = NULL;
+		vq->vq_free_cnt++;
+		vq_packed_inc_used(vq, 1);
+		vq_packed_put_id(vq, id);
+	}
+
+	return i;
+}
+
 #ifndef DEFAULT_TX_FREE_THRESH
 #define DEFAULT_TX_FREE_THRESH 32
 #endif
@@ -175,6 +233,36 @@ virtio_xmit_cleanup(struct virtqueue *vq, uint16_t num)
 	}
 }
 
+/*
+ * Cleanup from completed transmits on a packed ring. With in-order, the
+ * device may write a single used descriptor for a batch of buffers, with
+ * the id of the last one: all the buffers up to it are completed.
+ */
+static void
+virtio_xmit_cleanup_packed(struct virtqueue *vq)
+{
+	struct vring_packed_desc *desc = vq->ring_packed.desc_packed;
+	int in_order = vtpci_with_feature(vq->hw, VIRTIO_F_IN_ORDER);
+	struct vq_desc_extra *dxp;
+	uint16_t id, curr_id;
+
+	while (desc_is_used(&desc[vq->vq_used_cons_idx], vq)) {
+		virtio_rmb();
+		id = desc[vq->vq_used_cons_idx].id;
+		do {
+			curr_id = in_order ? vq->vq_used_cons_idx : id;
+			dxp = &vq->vq_descx[curr_id];
+			vq->vq_free_cnt += dxp->ndescs;
+			vq_packed_inc_used(vq, dxp->ndescs);
+			vq_packed_put_id(vq, curr_id);
+
+			if (dxp->cookie != NULL) {
+				rte_pktmbuf_free(dxp->cookie);
+				dxp->cookie = NULL;
+			}
+		} while (curr_id != id);
+	}
+}
 
 static inline int
 virtqueue_enqueue_recv_refill(struct virtqueue *vq, struct rte_mbuf *cookie)
@@ -216,6 +304,53 @@ virtqueue_enqueue_recv_refill(struct virtqueue *vq, struct rte_mbuf *cookie)
 	return 0;
 }
 
+/*
+ * Make num receive buffers available on a packed ring, one descriptor
+ * each. The flags of the first descriptor are written last so that the
+ * device sees the whole batch at once.
+ */
+static inline int
+virtqueue_enqueue_recv_refill_packed(struct virtqueue *vq,
+				     struct rte_mbuf **cookie, uint16_t num)
+{
+	struct vring_packed_desc *desc = vq->ring_packed.desc_packed;
+	struct virtio_hw *hw = vq->hw;
+	struct vq_desc_extra *dxp;
+	uint16_t head_idx, head_flags, idx, id, i;
+
+	if (unlikely(vq->vq_free_cnt == 0))
+		return -ENOSPC;
+	if (unlikely(vq->vq_free_cnt < num))
+		return -EMSGSIZE;
+
+	head_idx = vq->vq_avail_idx;
+	head_flags = vq->vq_packed_flags | VRING_DESC_F_WRITE;
+
+	for (i = 0; i < num; i++) {
+		idx = vq->vq_avail_idx;
+		id = vq_packed_get_id(vq);
+		dxp = &vq->vq_descx[id];
+		dxp->cookie = (void *)cookie[i];
+		dxp->ndescs = 1;
+
+		desc[idx].addr = VIRTIO_MBUF_ADDR(cookie[i], vq) +
+			RTE_PKTMBUF_HEADROOM - hw->vtnet_hdr_size;
+		desc[idx].len = cookie[i]->buf_len -
+			RTE_PKTMBUF_HEADROOM + hw->vtnet_hdr_size;
+		desc[idx].id = id;
+		if (i != 0)
+			desc[idx].flags =
+				vq->vq_packed_flags | VRING_DESC_F_WRITE;
+		vq_packed_inc_avail(vq);
+	}
+	vq->vq_free_cnt = (uint16_t)(vq->vq_free_cnt - num);
+
+	virtio_wmb();
+	desc[head_idx].flags = head_flags;
+
+	return 0;
+}
+
 /* When doing TSO, the IP length is not included in the pseudo header
  * checksum of the packet given to the PMD, but for virtio it is
  * expected.
@@ -257,20 +392,57 @@ virtio_tso_fix_cksum(struct rte_mbuf *m)
 	}
 }
 
-static inline int
-tx_offload_enabled(struct virtio_hw *hw)
-{
-	return vtpci_with_feature(hw, VIRTIO_NET_F_CSUM) ||
-		vtpci_with_feature(hw, VIRTIO_NET_F_HOST_TSO4) ||
-		vtpci_with_feature(hw, VIRTIO_NET_F_HOST_TSO6);
-}
-
 /* avoid write operation when necessary, to lessen cache issues */
 #define ASSIGN_UNLESS_EQUAL(var, val) do {	\
 	if ((var) != (val))			\
 		(var) = (val);			\
 } while (0)
 
+void
+virtqueue_xmit_offload(struct virtio_net_hdr *hdr, struct rte_mbuf *cookie)
+{
+	if (cookie->ol_flags & PKT_TX_TCP_SEG)
+		cookie->ol_flags |= PKT_TX_TCP_CKSUM;
+
+	switch (cookie->ol_flags & PKT_TX_L4_MASK) {
+	case PKT_TX_UDP_CKSUM:
+		hdr->csum_start = cookie->l2_len + cookie->l3_len;
+		hdr->csum_offset = offsetof(struct udp_hdr,
+			dgram_cksum);
+		hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+		break;
+
+	case PKT_TX_TCP_CKSUM:
+		hdr->csum_start = cookie->l2_len + cookie->l3_len;
+		hdr->csum_offset = offsetof(struct tcp_hdr, cksum);
+		hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+		break;
+
+	default:
+		ASSIGN_UNLESS_EQUAL(hdr->csum_start, 0);
+		ASSIGN_UNLESS_EQUAL(hdr->csum_offset, 0);
+		ASSIGN_UNLESS_EQUAL(hdr->flags, 0);
+		break;
+	}
+
+	/* TCP Segmentation Offload */
+	if (cookie->ol_flags & PKT_TX_TCP_SEG) {
+		virtio_tso_fix_cksum(cookie);
+		hdr->gso_type = (cookie->ol_flags & PKT_TX_IPV6) ?
+			VIRTIO_NET_HDR_GSO_TCPV6 :
+			VIRTIO_NET_HDR_GSO_TCPV4;
+		hdr->gso_size = cookie->tso_segsz;
+		hdr->hdr_len =
+			cookie->l2_len +
+			cookie->l3_len +
+			cookie->l4_len;
+	} else {
+		ASSIGN_UNLESS_EQUAL(hdr->gso_type, 0);
+		ASSIGN_UNLESS_EQUAL(hdr->gso_size, 0);
+		ASSIGN_UNLESS_EQUAL(hdr->hdr_len, 0);
+	}
+}
+
 static inline void
 virtqueue_enqueue_xmit(struct virtnet_tx *txvq, struct rte_mbuf *cookie,
 		       uint16_t needed, int use_indirect, int can_push)
@@ -341,48 +513,8 @@ virtqueue_enqueue_xmit(struct virtnet_tx *txvq, struct rte_mbuf *cookie,
 	}
 
 	/* Checksum Offload / TSO */
-	if (offload) {
-		if (cookie->ol_flags & PKT_TX_TCP_SEG)
-			cookie->ol_flags |= PKT_TX_TCP_CKSUM;
-
-		switch (cookie->ol_flags & PKT_TX_L4_MASK) {
-		case PKT_TX_UDP_CKSUM:
-			hdr->csum_start = cookie->l2_len + cookie->l3_len;
-			hdr->csum_offset = offsetof(struct udp_hdr,
-				dgram_cksum);
-			hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
-			break;
-
-		case PKT_TX_TCP_CKSUM:
-			hdr->csum_start = cookie->l2_len + cookie->l3_len;
-			hdr->csum_offset = offsetof(struct tcp_hdr, cksum);
-			hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
-			break;
-
-		default:
-			ASSIGN_UNLESS_EQUAL(hdr->csum_start, 0);
-			ASSIGN_UNLESS_EQUAL(hdr->csum_offset, 0);
-			ASSIGN_UNLESS_EQUAL(hdr->flags, 0);
-			break;
-		}
-
-		/* TCP Segmentation Offload */
-		if (cookie->ol_flags & PKT_TX_TCP_SEG) {
-			virtio_tso_fix_cksum(cookie);
-			hdr->gso_type = (cookie->ol_flags & PKT_TX_IPV6) ?
-				VIRTIO_NET_HDR_GSO_TCPV6 :
-				VIRTIO_NET_HDR_GSO_TCPV4;
-			hdr->gso_size = cookie->tso_segsz;
-			hdr->hdr_len =
-				cookie->l2_len +
-				cookie->l3_len +
-				cookie->l4_len;
-		} else {
-			ASSIGN_UNLESS_EQUAL(hdr->gso_type, 0);
-			ASSIGN_UNLESS_EQUAL(hdr->gso_size, 0);
-			ASSIGN_UNLESS_EQUAL(hdr->hdr_len, 0);
-		}
-	}
+	if (offload)
+		virtqueue_xmit_offload(hdr, cookie);
 
 	do {
 		start_dp[idx].addr  = VIRTIO_MBUF_DATA_DMA_ADDR(cookie, vq);
@@ -401,6 +533,81 @@ virtqueue_enqueue_xmit(struct virtnet_tx *txvq, struct rte_mbuf *cookie,
 	vq_update_avail_ring(vq, head_idx);
 }
 
+/*
+ * Fill the packed ring descriptors of a packet, the header being either
+ * pushed in the mbuf headroom or in its own descriptor. The flags of the
+ * head descriptor are not written but returned, the caller makes the
+ * chain available.
+ */
+static inline uint16_t
+virtqueue_enqueue_xmit_packed(struct virtnet_tx *txvq, struct rte_mbuf *cookie,
+			      uint16_t needed, int can_push)
+{
+	struct virtio_tx_region *txr = txvq->virtio_net_hdr_mz->addr;
+	struct virtqueue *vq = txvq->vq;
+	struct vring_packed_desc *desc = vq->ring_packed.desc_packed;
+	uint16_t head_size = vq->hw->vtnet_hdr_size;
+	uint16_t head_idx, head_flags, idx, id, flags;
+	struct virtio_net_hdr *hdr;
+	struct vq_desc_extra *dxp;
+	int offload;
+
+	offload = tx_offload_enabled(vq->hw);
+	head_idx = vq->vq_avail_idx;
+	head_flags = vq->vq_packed_flags;
+	id = vq_packed_get_id(vq);
+	dxp = &vq->vq_descx[id];
+	dxp->cookie = (void *)cookie;
+	dxp->ndescs = needed;
+
+	if (can_push) {
+		/* prepend cannot fail, checked by caller */
+		hdr = (struct virtio_net_hdr *)
+			rte_pktmbuf_prepend(cookie, head_size);
+		/* restore the packet length, see virtqueue_enqueue_xmit() */
+		cookie->pkt_len -= head_size;
+		/* if offload disabled, it is not zeroed below, do it now */
+		if (offload == 0) {
+			ASSIGN_UNLESS_EQUAL(hdr->csum_start, 0);
+			ASSIGN_UNLESS_EQUAL(hdr->csum_offset, 0);
+			ASSIGN_UNLESS_EQUAL(hdr->flags, 0);
+			ASSIGN_UNLESS_EQUAL(hdr->gso_type, 0);
+			ASSIGN_UNLESS_EQUAL(hdr->gso_size, 0);
+			ASSIGN_UNLESS_EQUAL(hdr->hdr_len, 0);
+		}
+	} else {
+		/* first descriptor points to the header in reserved region */
+		desc[head_idx].addr = txvq->virtio_net_hdr_mem +
+			RTE_PTR_DIFF(&txr[id].tx_hdr, txr);
+		desc[head_idx].len = head_size;
+		desc[head_idx].id = id;
+		head_flags |= VRING_DESC_F_NEXT;
+		hdr = (struct virtio_net_hdr *)&txr[id].tx_hdr;
+		vq_packed_inc_avail(vq);
+	}
+
+	/* Checksum Offload / TSO */
+	if (offload)
+		virtqueue_xmit_offload(hdr, cookie);
+
+	do {
+		idx = vq->vq_avail_idx;
+		desc[idx].addr = VIRTIO_MBUF_DATA_DMA_ADDR(cookie, vq);
+		desc[idx].len = cookie->data_len;
+		desc[idx].id = id;
+		flags = cookie->next ? VRING_DESC_F_NEXT : 0;
+		if (idx == head_idx)
+			head_flags |= flags;
+		else
+			desc[idx].flags = vq->vq_packed_flags | flags;
+		vq_packed_inc_avail(vq);
+	} while ((cookie = cookie->next) != NULL);
+
+	vq->vq_free_cnt = (uint16_t)(vq->vq_free_cnt - needed);
+
+	return head_flags;
+}
+
 void
 virtio_dev_cq_start(struct rte_eth_dev *dev)
 {
@@ -482,6 +689,8 @@ virtio_dev_rx_queue_setup_finish(struct rte_eth_dev *dev, uint16_t queue_idx)
 		/* Enqueue allocated buffers */
 		if (hw->use_simple_rx)
 			error = virtqueue_enqueue_recv_refill_simple(vq, m);
+		else if (vtpci_packed_queue(hw))
+			error = virtqueue_enqueue_recv_refill_packed(vq, &m, 1);
 		else
 			error = virtqueue_enqueue_recv_refill(vq, m);
 
@@ -492,7 +701,8 @@ virtio_dev_rx_queue_setup_finish(struct rte_eth_dev *dev, uint16_t queue_idx)
 		nbufs++;
 	}
 
-	vq_update_avail_idx(vq);
+	if (!vtpci_packed_queue(hw))
+		vq_update_avail_idx(vq);
 
 	PMD_INIT_LOG(DEBUG, "Allocated %d bufs", nbufs);
 
@@ -525,9 +735,17 @@ virtio_dev_tx_queue_setup(struct rte_eth_dev *dev,
 
 	PMD_INIT_FUNC_TRACE();
 
-	/* cannot use simple rxtx funcs with multisegs or offloads */
-	if ((tx_conf->txq_flags & VIRTIO_SIMPLE_FLAGS) != VIRTIO_SIMPLE_FLAGS)
+	/*
+	 * cannot use simple rxtx funcs with multisegs or offloads, the wide
+	 * vector ones only need single segment packets
+	 */
+	if (hw->vec_path != VIRTIO_VEC_NONE) {
+		if (!(tx_conf->txq_flags & ETH_TXQ_FLAGS_NOMULTSEGS))
+			hw->use_simple_tx = 0;
+	} else if ((tx_conf->txq_flags & VIRTIO_SIMPLE_FLAGS) !=
+			VIRTIO_SIMPLE_FLAGS) {
 		hw->use_simple_tx = 0;
+	}
 
 	if (nb_desc == 0 || nb_desc > vq->vq_nentries)
 		nb_desc = vq->vq_nentries;
@@ -565,11 +783,16 @@ virtio_dev_tx_queue_setup_finish(struct rte_eth_dev *dev,
 	struct virtqueue *vq = hw->vqs[vtpci_queue_idx];
 	uint16_t mid_idx = vq->vq_nentries >> 1;
 	struct virtnet_tx *txvq = &vq->txq;
+	uint64_t hdr_stride = 0;
 	uint16_t desc_idx;
 
 	PMD_INIT_FUNC_TRACE();
 
 	if (hw->use_simple_tx) {
+		/* the wide vector paths fill a header per slot for offloads */
+		if (hw->vec_path != VIRTIO_VEC_NONE)
+			hdr_stride = sizeof(struct virtio_tx_region);
+
 		for (desc_idx = 0; desc_idx < mid_idx; desc_idx++) {
 			vq->vq_ring.avail->ring[desc_idx] =
 				desc_idx + mid_idx;
@@ -577,6 +800,7 @@ virtio_dev_tx_queue_setup_finish(struct rte_eth_dev *dev,
 				desc_idx;
 			vq->vq_ring.desc[desc_idx + mid_idx].addr =
 				txvq->virtio_net_hdr_mem +
+				(desc_idx + mid_idx) * hdr_stride +
 				offsetof(struct virtio_tx_region, tx_hdr);
 			vq->vq_ring.desc[desc_idx + mid_idx].len =
 				vq->hw->vtnet_hdr_size;
@@ -602,7 +826,10 @@ virtio_discard_rxbuf(struct virtqueue *vq, struct rte_mbuf *m)
 	 * Requeue the discarded mbuf. This should always be
 	 * successful since it was just dequeued.
 	 */
-	error = virtqueue_enqueue_recv_refill(vq, m);
+	if (vtpci_packed_queue(vq->hw))
+		error = virtqueue_enqueue_recv_refill_packed(vq, &m, 1);
+	else
+		error = virtqueue_enqueue_recv_refill(vq, m);
 	if (unlikely(error)) {
 		RTE_LOG(ERR, PMD, "cannot requeue discarded mbuf");
 		rte_pktmbuf_free(m);
@@ -642,7 +869,7 @@ virtio_update_packet_stats(struct virtnet_stats *stats, struct rte_mbuf *mbuf)
 }
 
 /* Optionally fill offload information in structure */
-static int
+int
 virtio_rx_offload(struct rte_mbuf *m, struct virtio_net_hdr *hdr)
 {
 	struct rte_net_hdr_lens hdr_lens;
@@ -713,14 +940,6 @@ virtio_rx_offload(struct rte_mbuf *m, struct virtio_net_hdr *hdr)
 	return 0;
 }
 
-static inline int
-rx_offload_enabled(struct virtio_hw *hw)
-{
-	return vtpci_with_feature(hw, VIRTIO_NET_F_GUEST_CSUM) ||
-		vtpci_with_feature(hw, VIRTIO_NET_F_GUEST_TSO4) ||
-		vtpci_with_feature(hw, VIRTIO_NET_F_GUEST_TSO6);
-}
-
 #define VIRTIO_MBUF_BURST_SZ 64
 #define DESC_PER_CACHELINE (RTE_CACHE_LINE_SIZE / sizeof(struct vring_desc))
 uint16_t
@@ -1099,3 +1318,334 @@ virtio_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 
 	return nb_tx;
 }
+
+/* Refill the free descriptors of a packed receive ring */
+static uint16_t
+virtio_rx_refill_packed(struct virtnet_rx *rxvq)
+{
+	struct virtqueue *vq = rxvq->vq;
+	struct rte_mbuf *new_pkts[VIRTIO_MBUF_BURST_SZ];
+	uint16_t free_cnt, nb_enqueued = 0;
+
+	while (likely(!virtqueue_full(vq))) {
+		free_cnt = RTE_MIN(vq->vq_free_cnt, VIRTIO_MBUF_BURST_SZ);
+		if (unlikely(rte_mempool_get_bulk(rxvq->mpool,
+				(void **)new_pkts, free_cnt) < 0)) {
+			struct rte_eth_dev *dev
+				= &rte_eth_devices[rxvq->port_id];
+			dev->data->rx_mbuf_alloc_failed += free_cnt;
+			break;
+		}
+		virtqueue_enqueue_recv_refill_packed(vq, new_pkts, free_cnt);
+		nb_enqueued += free_cnt;
+	}
+
+	return nb_enqueued;
+}
+
+uint16_t
+virtio_recv_pkts_packed(void *rx_queue, struct rte_mbuf **rx_pkts,
+			uint16_t nb_pkts)
+{
+	struct virtnet_rx *rxvq = rx_queue;
+	struct virtqueue *vq = rxvq->vq;
+	struct virtio_hw *hw = vq->hw;
+	struct rte_mbuf *rxm;
+	uint16_t num, nb_rx;
+	uint32_t len[VIRTIO_MBUF_BURST_SZ];
+	struct rte_mbuf *rcv_pkts[VIRTIO_MBUF_BURST_SZ];
+	uint32_t i, nb_enqueued;
+	uint32_t hdr_size;
+	int offload;
+	struct virtio_net_hdr *hdr;
+
+	nb_rx = 0;
+	if (unlikely(hw->started == 0))
+		return nb_rx;
+
+	num = RTE_MIN(nb_pkts, VIRTIO_MBUF_BURST_SZ);
+	num = virtqueue_dequeue_burst_rx_packed(vq, rcv_pkts, len, num);
+	PMD_RX_LOG(DEBUG, "dequeue:%d", num);
+
+	nb_enqueued = 0;
+	hdr_size = hw->vtnet_hdr_size;
+	offload = rx_offload_enabled(hw);
+
+	for (i = 0; i < num ; i++) {
+		rxm = rcv_pkts[i];
+
+		PMD_RX_LOG(DEBUG, "packet len:%d", len[i]);
+
+		if (unlikely(len[i] < hdr_size + ETHER_HDR_LEN)) {
+			PMD_RX_LOG(ERR, "Packet drop");
+			nb_enqueued++;
+			virtio_discard_rxbuf(vq, rxm);
+			rxvq->stats.errors++;
+			continue;
+		}
+
+		rxm->port = rxvq->port_id;
+		rxm->data_off = RTE_PKTMBUF_HEADROOM;
+		rxm->ol_flags = 0;
+		rxm->vlan_tci = 0;
+
+		rxm->pkt_len = (uint32_t)(len[i] - hdr_size);
+		rxm->data_len = (uint16_t)(len[i] - hdr_size);
+
+		hdr = (struct virtio_net_hdr *)((char *)rxm->buf_addr +
+			RTE_PKTMBUF_HEADROOM - hdr_size);
+
+		if (hw->vlan_strip)
+			rte_vlan_strip(rxm);
+
+		if (offload && virtio_rx_offload(rxm, hdr) < 0) {
+			nb_enqueued++;
+			virtio_discard_rxbuf(vq, rxm);
+			rxvq->stats.errors++;
+			continue;
+		}
+
+		VIRTIO_DUMP_PACKET(rxm, rxm->data_len);
+
+		rx_pkts[nb_rx++] = rxm;
+
+		rxvq->stats.bytes += rxm->pkt_len;
+		virtio_update_packet_stats(&rxvq->stats, rxm);
+	}
+
+	rxvq->stats.packets += nb_rx;
+
+	/* Allocate new mbufs for the used descriptors */
+	nb_enqueued += virtio_rx_refill_packed(rxvq);
+
+	if (likely(nb_enqueued)) {
+		if (unlikely(virtqueue_kick_prepare_packed(vq))) {
+			virtqueue_notify(vq);
+			PMD_RX_LOG(DEBUG, "Notified");
+		}
+	}
+
+	return nb_rx;
+}
+
+uint16_t
+virtio_recv_mergeable_pkts_packed(void *rx_queue,
+			struct rte_mbuf **rx_pkts,
+			uint16_t nb_pkts)
+{
+	struct virtnet_rx *rxvq = rx_queue;
+	struct virtqueue *vq = rxvq->vq;
+	struct virtio_hw *hw = vq->hw;
+	struct rte_mbuf *rxm, *head;
+	uint16_t nb_rx, num;
+	uint32_t len[VIRTIO_MBUF_BURST_SZ];
+	struct rte_mbuf *rcv_pkts[VIRTIO_MBUF_BURST_SZ];
+	struct rte_mbuf *prev;
+	uint32_t nb_enqueued;
+	uint32_t seg_num;
+	uint16_t extra_idx;
+	uint32_t seg_res;
+	uint32_t hdr_size;
+	int offload;
+
+	nb_rx = 0;
+	if (unlikely(hw->started == 0))
+		return nb_rx;
+
+	nb_enqueued = 0;
+	hdr_size = hw->vtnet_hdr_size;
+	offload = rx_offload_enabled(hw);
+
+	while (nb_rx < nb_pkts) {
+		struct virtio_net_hdr_mrg_rxbuf *header;
+
+		num = virtqueue_dequeue_burst_rx_packed(vq, rcv_pkts, len, 1);
+		if (num != 1)
+			break;
+
+		PMD_RX_LOG(DEBUG, "packet len:%d", len[0]);
+
+		head = rcv_pkts[0];
+
+		if (unlikely(len[0] < hdr_size + ETHER_HDR_LEN)) {
+			PMD_RX_LOG(ERR, "Packet drop");
+			nb_enqueued++;
+			virtio_discard_rxbuf(vq, head);
+			rxvq->stats.errors++;
+			continue;
+		}
+
+		header = (struct virtio_net_hdr_mrg_rxbuf *)
+			((char *)head->buf_addr + RTE_PKTMBUF_HEADROOM -
+			 hdr_size);
+		seg_num = header->num_buffers;
+
+		if (seg_num == 0)
+			seg_num = 1;
+
+		head->data_off = RTE_PKTMBUF_HEADROOM;
+		head->nb_segs = seg_num;
+		head->ol_flags = 0;
+		head->vlan_tci = 0;
+		head->pkt_len = (uint32_t)(len[0] - hdr_size);
+		head->data_len = (uint16_t)(len[0] - hdr_size);
+		head->port = rxvq->port_id;
+		prev = head;
+
+		/*
+		 * The device makes the buffers of a packet used at once,
+		 * get the extra segments of the packet.
+		 */
+		seg_res = seg_num - 1;
+		while (seg_res != 0) {
+			uint16_t rcv_cnt = RTE_MIN(seg_res, RTE_DIM(rcv_pkts));
+
+			num = virtqueue_dequeue_burst_rx_packed(vq, rcv_pkts,
+					len, rcv_cnt);
+			for (extra_idx = 0; extra_idx < num; extra_idx++) {
+				rxm = rcv_pkts[extra_idx];
+
+				rxm->data_off = RTE_PKTMBUF_HEADROOM - hdr_size;
+				rxm->pkt_len = (uint32_t)(len[extra_idx]);
+				rxm->data_len = (uint16_t)(len[extra_idx]);
+
+				prev->next = rxm;
+				prev = rxm;
+				head->pkt_len += rxm->pkt_len;
+			}
+			seg_res -= num;
+			if (num != rcv_cnt)
+				break;
+		}
+
+		if (unlikely(seg_res != 0)) {
+			PMD_RX_LOG(ERR, "No enough segments for packet.");
+			head->nb_segs = seg_num - seg_res;
+			rte_pktmbuf_free(head);
+			rxvq->stats.errors++;
+			continue;
+		}
+
+		if (offload && virtio_rx_offload(head, &header->hdr) < 0) {
+			rte_pktmbuf_free(head);
+			rxvq->stats.errors++;
+			continue;
+		}
+
+		if (hw->vlan_strip)
+			rte_vlan_strip(head);
+
+		VIRTIO_DUMP_PACKET(head, head->data_len);
+
+		rx_pkts[nb_rx++] = head;
+		rxvq->stats.bytes += head->pkt_len;
+		virtio_update_packet_stats(&rxvq->stats, head);
+	}
+
+	rxvq->stats.packets += nb_rx;
+
+	/* Allocate new mbufs for the used descriptors */
+	nb_enqueued += virtio_rx_refill_packed(rxvq);
+
+	if (likely(nb_enqueued)) {
+		if (unlikely(virtqueue_kick_prepare_packed(vq))) {
+			virtqueue_notify(vq);
+			PMD_RX_LOG(DEBUG, "Notified");
+		}
+	}
+
+	return nb_rx;
+}
+
+uint16_t
+virtio_xmit_pkts_packed(void *tx_queue, struct rte_mbuf **tx_pkts,
+			uint16_t nb_pkts)
+{
+	struct virtnet_tx *txvq = tx_queue;
+	struct virtqueue *vq = txvq->vq;
+	struct virtio_hw *hw = vq->hw;
+	struct vring_packed_desc *desc = vq->ring_packed.desc_packed;
+	uint16_t hdr_size = hw->vtnet_hdr_size;
+	uint16_t nb_tx = 0, nb_enq = 0;
+	uint16_t head_idx = 0, head_flags = 0, idx, flags;
+	int error;
+
+	if (unlikely(hw->started == 0))
+		return nb_tx;
+
+	if (unlikely(nb_pkts < 1))
+		return nb_pkts;
+
+	PMD_TX_LOG(DEBUG, "%d packets to xmit", nb_pkts);
+
+	if (vq->vq_free_cnt < vq->vq_free_thresh)
+		virtio_xmit_cleanup_packed(vq);
+
+	for (nb_tx = 0; nb_tx < nb_pkts; nb_tx++) {
+		struct rte_mbuf *txm = tx_pkts[nb_tx];
+		int can_push = 0, slots;
+
+		/* Do VLAN tag insertion */
+		if (unlikely(txm->ol_flags & PKT_TX_VLAN_PKT)) {
+			error = rte_vlan_insert(&txm);
+			if (unlikely(error)) {
+				rte_pktmbuf_free(txm);
+				continue;
+			}
+		}
+
+		/* optimize ring usage, VERSION_1 is implied by packed ring */
+		if (rte_mbuf_refcnt_read(txm) == 1 &&
+		    RTE_MBUF_DIRECT(txm) &&
+		    txm->nb_segs == 1 &&
+		    rte_pktmbuf_headroom(txm) >= hdr_size &&
+		    rte_is_aligned(rte_pktmbuf_mtod(txm, char *),
+				   __alignof__(struct virtio_net_hdr_mrg_rxbuf)))
+			can_push = 1;
+
+		/* How many ring entries are needed to this Tx?
+		 * any_layout => number of segments
+		 * default    => number of segments + 1
+		 */
+		slots = txm->nb_segs + !can_push;
+
+		if (unlikely(slots > vq->vq_free_cnt)) {
+			virtio_xmit_cleanup_packed(vq);
+			if (unlikely(slots > vq->vq_free_cnt)) {
+				PMD_TX_LOG(ERR,
+					   "No free tx descriptors to transmit");
+				break;
+			}
+		}
+
+		/* Enqueue Packet buffers, the first chain of the burst is
+		 * made available last, once all the others are written.
+		 */
+		idx = vq->vq_avail_idx;
+		flags = virtqueue_enqueue_xmit_packed(txvq, txm, slots,
+						      can_push);
+		if (nb_enq++ == 0) {
+			head_idx = idx;
+			head_flags = flags;
+		} else {
+			desc[idx].flags = flags;
+		}
+
+		txvq->stats.bytes += txm->pkt_len;
+		virtio_update_packet_stats(&txvq->stats, txm);
+	}
+
+	txvq->stats.packets += nb_tx;
+
+	if (likely(nb_enq)) {
+		virtio_wmb();
+		desc[head_idx].flags = head_flags;
+
+		if (unlikely(virtqueue_kick_prepare_packed(vq))) {
+			virtqueue_notify(vq);
+			PMD_TX_LOG(DEBUG, "Notified backend after xmit");
+		}
+	}
+
+	return nb_tx;
+}
@@ -36,6 +36,14 @@
 
 #define RTE_PMD_VIRTIO_RX_MAX_BURST 64
 
+/*
+ * Wide vector paths of x86, chosen from the CPU flags. They use the ring
+ * layout of the simple paths but take mergeable Rx buffers and offloads.
+ */
+#define VIRTIO_VEC_NONE		0
+#define VIRTIO_VEC_AVX2		1
+#define VIRTIO_VEC_AVX512	2
+
 struct virtnet_stats {
 	uint64_t	packets;
 	uint64_t	bytes;
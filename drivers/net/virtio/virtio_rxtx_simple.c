@@ -179,3 +179,39 @@ virtio_recv_pkts_vec(void *rx_queue __rte_unused,
 	rte_panic("Wrong weak function linked by linker\n");
 	return 0;
 }
+
+uint16_t __attribute__((weak))
+virtio_recv_pkts_vec_avx2(void *rx_queue __rte_unused,
+			  struct rte_mbuf **rx_pkts __rte_unused,
+			  uint16_t nb_pkts __rte_unused)
+{
+	rte_panic("Wrong weak function linked by linker\n");
+	return 0;
+}
+
+uint16_t __attribute__((weak))
+virtio_xmit_pkts_vec_avx2(void *tx_queue __rte_unused,
+			  struct rte_mbuf **tx_pkts __rte_unused,
+			  uint16_t nb_pkts __rte_unused)
+{
+	rte_panic("Wrong weak function linked by linker\n");
+	return 0;
+}
+
+uint16_t __attribute__((weak))
+virtio_recv_pkts_vec_avx512(void *rx_queue __rte_unused,
+			    struct rte_mbuf **rx_pkts __rte_unused,
+			    uint16_t nb_pkts __rte_unused)
+{
+	rte_panic("Wrong weak function linked by linker\n");
+	return 0;
+}
+
+uint16_t __attribute__((weak))
+virtio_xmit_pkts_vec_avx512(void *tx_queue __rte_unused,
+			    struct rte_mbuf **tx_pkts __rte_unused,
+			    uint16_t nb_pkts __rte_unused)
+{
+	rte_panic("Wrong weak function linked by linker\n");
+	return 0;
+}
@@ -36,6 +36,9 @@
 
 #include <stdint.h>
 
+#include <rte_ether.h>
+#include <rte_mbuf.h>
+
 #include "virtio_logs.h"
 #include "virtio_ethdev.h"
 #include "virtqueue.h"
@@ -84,6 +87,110 @@ virtio_rxq_rearm_vec(struct virtnet_rx *rxvq)
 	vq_update_avail_idx(vq);
 }
 
+/*
+ * Receive one packet at the used index for the wide vector paths, which
+ * only convert packets of a single buffer without offload information:
+ * the buffers of a mergeable packet are chained and the offloads set.
+ * Returns the number of used entries consumed, 0 when the buffers of the
+ * packet are not all used yet. *pkt is NULL when the packet was dropped.
+ */
+static inline uint16_t
+virtio_recv_pkt_vec_slow(struct virtnet_rx *rxvq, uint16_t nb_used,
+	struct rte_mbuf **pkt)
+{
+	struct virtqueue *vq = rxvq->vq;
+	struct virtio_hw *hw = vq->hw;
+	struct vring_used_elem *uep = vq->vq_ring.used->ring;
+	uint16_t mask = vq->vq_nentries - 1;
+	uint16_t hdr_size = hw->vtnet_hdr_size;
+	uint16_t idx = vq->vq_used_cons_idx;
+	struct virtio_net_hdr_mrg_rxbuf *hdr;
+	struct rte_mbuf *head, *prev, *m;
+	uint16_t nb_segs = 1, i;
+	uint32_t len;
+	int drop = 0;
+
+	head = vq->sw_ring[idx & mask];
+	hdr = (struct virtio_net_hdr_mrg_rxbuf *)((char *)head->buf_addr +
+		RTE_PKTMBUF_HEADROOM - hdr_size);
+	if (vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF) &&
+			hdr->num_buffers > 1) {
+		nb_segs = hdr->num_buffers;
+		/* cannot be completed, drop the first buffer */
+		if (unlikely(nb_segs > vq->vq_nentries)) {
+			nb_segs = 1;
+			drop = 1;
+		} else if (nb_segs > nb_used) {
+			return 0;
+		}
+	}
+
+	len = uep[idx & mask].len;
+	head->nb_segs = nb_segs;
+	head->ol_flags = 0;
+	head->packet_type = 0;
+	head->vlan_tci = 0;
+	head->pkt_len = len - hdr_size;
+	head->data_len = len - hdr_size;
+
+	prev = head;
+	for (i = 1; i < nb_segs; i++) {
+		m = vq->sw_ring[(idx + i) & mask];
+		len = uep[(idx + i) & mask].len;
+		m->data_off = RTE_PKTMBUF_HEADROOM - hdr_size;
+		m->data_len = len;
+		prev->next = m;
+		prev = m;
+		head->pkt_len += len;
+	}
+
+	if (unlikely(drop ||
+			uep[idx & mask].len <
+				(uint32_t)hdr_size + ETHER_HDR_LEN ||
+			(rx_offload_enabled(hw) &&
+			 virtio_rx_offload(head, &hdr->hdr) < 0))) {
+		PMD_RX_LOG(ERR, "Packet drop");
+		rte_pktmbuf_free(head);
+		rxvq->stats.errors++;
+		*pkt = NULL;
+		return nb_segs;
+	}
+
+	if (hw->vlan_strip)
+		rte_vlan_strip(head);
+
+	rxvq->stats.bytes += head->pkt_len;
+	*pkt = head;
+
+	return nb_segs;
+}
+
+/*
+ * Prepare a packet for the wide vector Tx paths: insert its VLAN tag and
+ * fill the virtio header of its slot for the offloads.
+ * Returns -1 when the packet cannot be sent and was freed.
+ */
+static inline int
+virtio_xmit_pkt_vec_prep(struct virtnet_tx *txvq, struct rte_mbuf **pkt,
+	uint16_t slot, int offload)
+{
+	struct virtio_tx_region *txr = txvq->virtio_net_hdr_mz->addr;
+	struct virtqueue *vq = txvq->vq;
+
+	if (unlikely((*pkt)->ol_flags & PKT_TX_VLAN_PKT)) {
+		if (unlikely(rte_vlan_insert(pkt) != 0)) {
+			rte_pktmbuf_free(*pkt);
+			return -1;
+		}
+	}
+
+	if (offload)
+		virtqueue_xmit_offload(&txr[(vq->vq_nentries >> 1) +
+			slot].tx_hdr.hdr, *pkt);
+
+	return 0;
+}
+
 #define VIRTIO_TX_FREE_THRESH 32
 #define VIRTIO_TX_MAX_FREE_BUF_SZ 32
 #define VIRTIO_TX_FREE_NR 32
@@ -0,0 +1,303 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <stdint.h>
+
+#include <immintrin.h>
+
+#include <rte_branch_prediction.h>
+#include <rte_common.h>
+#include <rte_ether.h>
+#include <rte_mbuf.h>
+#include <rte_prefetch.h>
+
+#include "virtio_rxtx_simple.h"
+
+#define VIRTIO_AVX2_DESC_PER_LOOP 4
+#define VIRTIO_AVX2_TX_BURST 32
+
+/* virtio AVX2 receive routine
+ *
+ * It uses the Rx ring layout of the simple path: each entry in the avail
+ * ring points to the desc with the same index, and sw_ring holds the mbuf
+ * of each desc. The used entries of 4 packets of a single buffer without
+ * offload information are converted at once, the other packets (mergeable
+ * buffers, offloads, errors) go through virtio_recv_pkt_vec_slow().
+ */
+uint16_t
+virtio_recv_pkts_vec_avx2(void *rx_queue, struct rte_mbuf **rx_pkts,
+	uint16_t nb_pkts)
+{
+	struct virtnet_rx *rxvq = rx_queue;
+	struct virtqueue *vq = rxvq->vq;
+	struct virtio_hw *hw = vq->hw;
+	uint16_t hdr_size = hw->vtnet_hdr_size;
+	uint16_t mask = vq->vq_nentries - 1;
+	uint16_t nb_used, nb_rx = 0, idx, n, cons_idx;
+	struct rte_mbuf *m;
+	__m256i shuf_even, shuf_odd, len_adjust, min_len, rearm;
+	__m256i hdr_off, hdr_next, off_msk, nbuf_msk, nbuf_one, bytes;
+	int offload, mrg, vec;
+
+	/* rearm_data, ol_flags and rx_descriptor_fields1 are written at once */
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, ol_flags) !=
+		offsetof(struct rte_mbuf, rearm_data) + 8);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, rx_descriptor_fields1) !=
+		offsetof(struct rte_mbuf, rearm_data) + 16);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, buf_addr) != 0);
+
+	if (unlikely(hw->started == 0))
+		return 0;
+
+	nb_used = VIRTQUEUE_NUSED(vq);
+
+	virtio_rmb();
+
+	/* fields of the even and odd used entries of each 128-bit lane */
+	shuf_even = _mm256_set_epi8(
+		0xFF, 0xFF, 0xFF, 0xFF,	/* rss */
+		0xFF, 0xFF,		/* vlan tci */
+		5, 4,			/* dat len */
+		7, 6, 5, 4,		/* pkt len */
+		0xFF, 0xFF, 0xFF, 0xFF,	/* packet type */
+		0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF,
+		5, 4,
+		7, 6, 5, 4,
+		0xFF, 0xFF, 0xFF, 0xFF);
+	shuf_odd = _mm256_set_epi8(
+		0xFF, 0xFF, 0xFF, 0xFF,	/* rss */
+		0xFF, 0xFF,		/* vlan tci */
+		13, 12,			/* dat len */
+		15, 14, 13, 12,		/* pkt len */
+		0xFF, 0xFF, 0xFF, 0xFF,	/* packet type */
+		0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF,
+		13, 12,
+		15, 14, 13, 12,
+		0xFF, 0xFF, 0xFF, 0xFF);
+
+	/* the lengths are in the odd 32-bit words of the used entries */
+	len_adjust = _mm256_set_epi32(-hdr_size, 0, -hdr_size, 0,
+		-hdr_size, 0, -hdr_size, 0);
+	min_len = _mm256_set_epi32(hdr_size + ETHER_HDR_LEN, 0,
+		hdr_size + ETHER_HDR_LEN, 0, hdr_size + ETHER_HDR_LEN, 0,
+		hdr_size + ETHER_HDR_LEN, 0);
+	rearm = _mm256_set_epi64x(0, 0, 0, rxvq->mbuf_initializer);
+
+	/* virtio header: flags and gso_type, then num_buffers at offset 10 */
+	hdr_off = _mm256_set1_epi64x(RTE_PKTMBUF_HEADROOM - hdr_size);
+	hdr_next = _mm256_set1_epi64x(8);
+	off_msk = _mm256_set1_epi64x(0xFFFF);
+	nbuf_msk = _mm256_set1_epi64x(0xFFFF0000);
+	nbuf_one = _mm256_set1_epi64x(0x10000);
+	bytes = _mm256_setzero_si256();
+
+	offload = rx_offload_enabled(hw);
+	mrg = vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF);
+	vec = !hw->vlan_strip;
+	cons_idx = vq->vq_used_cons_idx;
+
+	while (nb_rx < nb_pkts && nb_used > 0) {
+		idx = vq->vq_used_cons_idx & mask;
+
+		if (vec && nb_used >= VIRTIO_AVX2_DESC_PER_LOOP &&
+				nb_pkts - nb_rx >= VIRTIO_AVX2_DESC_PER_LOOP &&
+				idx + VIRTIO_AVX2_DESC_PER_LOOP <=
+					vq->vq_nentries) {
+			__m256i used, mbufs, hdrs, pkt_even, pkt_odd;
+			int fast;
+
+			used = _mm256_loadu_si256(
+				(void *)&vq->vq_ring.used->ring[idx]);
+			mbufs = _mm256_loadu_si256((void *)&vq->sw_ring[idx]);
+			hdrs = _mm256_setzero_si256();
+
+			fast = _mm256_testz_si256(
+				_mm256_cmpgt_epi32(min_len, used),
+				_mm256_cmpgt_epi32(min_len, used));
+			if (fast && (offload || mrg)) {
+				hdrs = _mm256_i64gather_epi64(NULL, mbufs, 1);
+				hdrs = _mm256_add_epi64(hdrs, hdr_off);
+			}
+			if (fast && offload) {
+				__m256i h = _mm256_i64gather_epi64(NULL,
+					hdrs, 1);
+
+				fast = _mm256_testz_si256(h, off_msk);
+			}
+			if (fast && mrg) {
+				__m256i h = _mm256_i64gather_epi64(NULL,
+					_mm256_add_epi64(hdrs, hdr_next), 1);
+
+				h = _mm256_cmpgt_epi64(
+					_mm256_and_si256(h, nbuf_msk),
+					nbuf_one);
+				fast = _mm256_testz_si256(h, h);
+			}
+
+			if (fast) {
+				used = _mm256_add_epi32(used, len_adjust);
+				bytes = _mm256_add_epi64(bytes,
+					_mm256_srli_epi64(used, 32));
+				pkt_even = _mm256_shuffle_epi8(used, shuf_even);
+				pkt_odd = _mm256_shuffle_epi8(used, shuf_odd);
+
+				_mm256_storeu_si256((void *)&rx_pkts[nb_rx],
+					mbufs);
+				_mm256_storeu_si256(
+					(void *)&rx_pkts[nb_rx]->rearm_data,
+					_mm256_permute2x128_si256(rearm,
+						pkt_even, 0x20));
+				_mm256_storeu_si256(
+					(void *)&rx_pkts[nb_rx + 1]->rearm_data,
+					_mm256_permute2x128_si256(rearm,
+						pkt_odd, 0x20));
+				_mm256_storeu_si256(
+					(void *)&rx_pkts[nb_rx + 2]->rearm_data,
+					_mm256_permute2x128_si256(rearm,
+						pkt_even, 0x30));
+				_mm256_storeu_si256(
+					(void *)&rx_pkts[nb_rx + 3]->rearm_data,
+					_mm256_permute2x128_si256(rearm,
+						pkt_odd, 0x30));
+
+				nb_rx += VIRTIO_AVX2_DESC_PER_LOOP;
+				vq->vq_used_cons_idx +=
+					VIRTIO_AVX2_DESC_PER_LOOP;
+				nb_used -= VIRTIO_AVX2_DESC_PER_LOOP;
+				continue;
+			}
+		}
+
+		n = virtio_recv_pkt_vec_slow(rxvq, nb_used, &m);
+		if (n == 0)
+			break;
+		vq->vq_used_cons_idx += n;
+		nb_used -= n;
+		if (m != NULL)
+			rx_pkts[nb_rx++] = m;
+	}
+
+	vq->vq_free_cnt += (uint16_t)(vq->vq_used_cons_idx - cons_idx);
+
+	/* mergeable packets may have consumed more than one burst */
+	n = 0;
+	while (vq->vq_free_cnt >= RTE_VIRTIO_VPMD_RX_REARM_THRESH) {
+		uint16_t free_cnt = vq->vq_free_cnt;
+
+		virtio_rxq_rearm_vec(rxvq);
+		if (unlikely(vq->vq_free_cnt == free_cnt))
+			break;
+		n++;
+	}
+	if (n != 0 && unlikely(virtqueue_kick_prepare(vq)))
+		virtqueue_notify(vq);
+
+	bytes = _mm256_add_epi64(bytes,
+		_mm256_permute2x128_si256(bytes, bytes, 0x01));
+	rxvq->stats.bytes += _mm256_extract_epi64(bytes, 0) +
+		_mm256_extract_epi64(bytes, 1);
+	rxvq->stats.packets += nb_rx;
+
+	return nb_rx;
+}
+
+static inline uint16_t
+virtio_xmit_fixed_burst_avx2(struct virtnet_tx *txvq,
+	struct rte_mbuf **tx_pkts, uint16_t nb_pkts, int offload)
+{
+	struct virtqueue *vq = txvq->vq;
+	struct vring_desc *start_dp = vq->vq_ring.desc;
+	uint16_t desc_idx_max = (vq->vq_nentries >> 1) - 1;
+	struct rte_mbuf *pkts[VIRTIO_AVX2_TX_BURST];
+	uint16_t desc_idx, idx, nb_commit = 0, i;
+	uint64_t bytes = 0;
+
+	desc_idx = vq->vq_avail_idx & desc_idx_max;
+
+	for (i = 0; i < nb_pkts; i++) {
+		struct rte_mbuf *m = tx_pkts[i];
+
+		if (unlikely(virtio_xmit_pkt_vec_prep(txvq, &m,
+				(desc_idx + nb_commit) & desc_idx_max,
+				offload) != 0))
+			continue;
+		vq->vq_descx[(desc_idx + nb_commit) & desc_idx_max].cookie = m;
+		pkts[nb_commit++] = m;
+		bytes += m->pkt_len;
+	}
+
+	/* the data descs, two per store */
+	for (i = 0; i < nb_commit;) {
+		idx = (desc_idx + i) & desc_idx_max;
+		if (i + 2 <= nb_commit && idx < desc_idx_max) {
+			_mm256_storeu_si256((void *)&start_dp[idx],
+				_mm256_set_epi64x(pkts[i + 1]->pkt_len,
+					VIRTIO_MBUF_DATA_DMA_ADDR(pkts[i + 1],
+						vq),
+					pkts[i]->pkt_len,
+					VIRTIO_MBUF_DATA_DMA_ADDR(pkts[i],
+						vq)));
+			i += 2;
+		} else {
+			start_dp[idx].addr =
+				VIRTIO_MBUF_DATA_DMA_ADDR(pkts[i], vq);
+			start_dp[idx].len = pkts[i]->pkt_len;
+			i++;
+		}
+	}
+
+	vq->vq_free_cnt -= (uint16_t)(nb_commit << 1);
+	vq->vq_avail_idx += nb_commit;
+	vq_update_avail_idx(vq);
+
+	txvq->stats.packets += nb_commit;
+	txvq->stats.bytes += bytes;
+
+	return nb_pkts;
+}
+
+/* virtio AVX2 transmit routine
+ *
+ * It uses the Tx ring layout of the simple path, with a virtio header per
+ * slot so that the checksum and segmentation offloads are supported.
+ * Packets must have a single segment.
+ */
+uint16_t
+virtio_xmit_pkts_vec_avx2(void *tx_queue, struct rte_mbuf **tx_pkts,
+	uint16_t nb_pkts)
+{
+	struct virtnet_tx *txvq = tx_queue;
+	struct virtqueue *vq = txvq->vq;
+	struct virtio_hw *hw = vq->hw;
+	uint16_t nb_used, nb_tx = 0, n;
+	int offload;
+
+	if (unlikely(hw->started == 0))
+		return 0;
+
+	nb_used = VIRTQUEUE_NUSED(vq);
+
+	virtio_rmb();
+
+	while (nb_used >= VIRTIO_TX_FREE_THRESH) {
+		virtio_xmit_cleanup(vq);
+		nb_used -= VIRTIO_TX_FREE_THRESH;
+	}
+
+	nb_pkts = RTE_MIN((vq->vq_free_cnt >> 1), nb_pkts);
+	offload = tx_offload_enabled(hw);
+
+	while (nb_tx < nb_pkts) {
+		n = RTE_MIN(nb_pkts - nb_tx, VIRTIO_AVX2_TX_BURST);
+		nb_tx += virtio_xmit_fixed_burst_avx2(txvq, &tx_pkts[nb_tx],
+			n, offload);
+	}
+
+	if (likely(nb_tx != 0) && unlikely(virtqueue_kick_prepare(vq)))
+		virtqueue_notify(vq);
+
+	return nb_tx;
+}
@@ -83,6 +83,9 @@ virtio_user_kick_queue(struct virtio_user_dev *dev, uint32_t queue_sel)
 
 	state.index = queue_sel;
 	state.num = 0; /* no reservation */
+	/* packed ring: avail wrap counter starts at 1, in bit 15 */
+	if (dev->features & (1ULL << VIRTIO_F_RING_PACKED))
+		state.num |= (1 << 15);
 	dev->ops->send_request(dev, VHOST_USER_SET_VRING_BASE, &state);
 
 	dev->ops->send_request(dev, VHOST_USER_SET_VRING_ADDR, &addr);
@@ -339,11 +342,14 @@ virtio_user_dev_setup(struct virtio_user_dev *dev)
 	 1ULL << VIRTIO_NET_F_GUEST_CSUM	|	\
 	 1ULL << VIRTIO_NET_F_GUEST_TSO4	|	\
 	 1ULL << VIRTIO_NET_F_GUEST_TSO6	|	\
-	 1ULL << VIRTIO_F_VERSION_1)
+	 1ULL << VIRTIO_F_VERSION_1		|	\
+	 1ULL << VIRTIO_F_RING_PACKED		|	\
+	 1ULL << VIRTIO_F_IN_ORDER)
 
 int
 virtio_user_dev_init(struct virtio_user_dev *dev, char *path, int queues,
-		     int cq, int queue_size, const char *mac, char **ifname)
+		     int cq, int queue_size, const char *mac, char **ifname,
+		     int packed_vq, int in_order)
 {
 	snprintf(dev->path, PATH_MAX, "%s", path);
 	dev->max_queue_pairs = queues;
@@ -393,6 +399,11 @@ virtio_user_dev_init(struct virtio_user_dev *dev, char *path, int queues,
 	if (is_vhost_user_by_type(dev->path))
 		dev->device_features |= (1ull << VIRTIO_NET_F_STATUS);
 
+	if (!packed_vq)
+		dev->device_features &= ~(1ull << VIRTIO_F_RING_PACKED);
+	if (!in_order)
+		dev->device_features &= ~(1ull << VIRTIO_F_IN_ORDER);
+
 	dev->device_features &= VIRTIO_USER_SUPPORTED_FEATURES;
 
 	return 0;
@@ -505,3 +516,85 @@ virtio_user_handle_cq(struct virtio_user_dev *dev, uint16_t queue_idx)
 		vring->used->idx++;
 	}
 }
+
+static inline int
+desc_is_avail(struct vring_packed_desc *desc, uint8_t wrap_counter)
+{
+	uint16_t flags = *(volatile uint16_t *)&desc->flags;
+
+	return wrap_counter == !!(flags & VRING_DESC_F_AVAIL(1)) &&
+		wrap_counter != !!(flags & VRING_DESC_F_USED(1));
+}
+
+static uint32_t
+virtio_user_handle_ctrl_msg_packed(struct virtio_user_dev *dev,
+				   struct vring_packed *vring,
+				   uint16_t idx_hdr)
+{
+	struct virtio_net_ctrl_hdr *hdr;
+	virtio_net_ctrl_ack status = ~0;
+	uint16_t idx_data, idx_status;
+	uint32_t n_descs = 0;
+
+	/* locate desc for header, data, and status, consecutive in ring */
+	idx_data = idx_hdr + 1;
+	if (idx_data >= vring->num)
+		idx_data -= vring->num;
+	n_descs++;
+
+	idx_status = idx_data;
+	while (vring->desc_packed[idx_status].flags & VRING_DESC_F_NEXT) {
+		if (++idx_status >= vring->num)
+			idx_status -= vring->num;
+		n_descs++;
+	}
+	n_descs++;
+
+	hdr = (void *)(uintptr_t)vring->desc_packed[idx_hdr].addr;
+	if (hdr->class == VIRTIO_NET_CTRL_MQ &&
+	    hdr->cmd == VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET) {
+		uint16_t queues;
+
+		queues = *(uint16_t *)(uintptr_t)
+			vring->desc_packed[idx_data].addr;
+		status = virtio_user_handle_mq(dev, queues);
+	}
+
+	/* Update status */
+	*(virtio_net_ctrl_ack *)(uintptr_t)
+		vring->desc_packed[idx_status].addr = status;
+
+	return n_descs;
+}
+
+void
+virtio_user_handle_cq_packed(struct virtio_user_dev *dev, uint16_t queue_idx)
+{
+	struct vring_packed *vring = &dev->packed_vrings[queue_idx];
+	struct vring_packed_desc *desc;
+	uint32_t n_descs;
+	uint16_t flags;
+
+	/* Chains are used as soon as made available, in the same slots */
+	desc = &vring->desc_packed[dev->cq_used_idx];
+	while (desc_is_avail(desc, dev->cq_used_wrap_counter)) {
+		rte_smp_rmb();
+		n_descs = virtio_user_handle_ctrl_msg_packed(dev, vring,
+							     dev->cq_used_idx);
+
+		/* Update used descriptor, the id is already the buffer's */
+		flags = VRING_DESC_F_WRITE;
+		if (dev->cq_used_wrap_counter)
+			flags |= VRING_DESC_F_AVAIL(1) | VRING_DESC_F_USED(1);
+		desc->len = n_descs;
+		rte_smp_wmb();
+		desc->flags = flags;
+
+		dev->cq_used_idx += n_descs;
+		if (dev->cq_used_idx >= vring->num) {
+			dev->cq_used_idx -= vring->num;
+			dev->cq_used_wrap_counter ^= 1;
+		}
+		desc = &vring->desc_packed[dev->cq_used_idx];
+	}
+}
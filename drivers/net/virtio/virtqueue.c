@@ -83,6 +83,28 @@ virtqueue_detatch_unused(struct virtqueue *vq)
 	return NULL;
 }
 
+/* Flush the used descriptors of a packed ring. */
+static void
+virtqueue_rxvq_flush_packed(struct virtqueue *vq)
+{
+	struct vring_packed_desc *desc = vq->ring_packed.desc_packed;
+	struct vq_desc_extra *dxp;
+	uint16_t id;
+
+	while (desc_is_used(&desc[vq->vq_used_cons_idx], vq)) {
+		virtio_rmb();
+		id = desc[vq->vq_used_cons_idx].id;
+		dxp = &vq->vq_descx[id];
+		if (dxp->cookie != NULL) {
+			rte_pktmbuf_free(dxp->cookie);
+			dxp->cookie = NULL;
+		}
+		vq->vq_free_cnt += dxp->ndescs;
+		vq_packed_inc_used(vq, dxp->ndescs);
+		vq_packed_put_id(vq, id);
+	}
+}
+
 /* Flush the elements in the used ring. */
 void
 virtqueue_rxvq_flush(struct virtqueue *vq)
@@ -94,6 +116,11 @@ virtqueue_rxvq_flush(struct virtqueue *vq)
 	uint16_t used_idx, desc_idx;
 	uint16_t nb_used, i;
 
+	if (vtpci_packed_queue(hw)) {
+		virtqueue_rxvq_flush_packed(vq);
+		return;
+	}
+
 	nb_used = VIRTQUEUE_NUSED(vq);
 
 	for (i = 0; i < nb_used; i++) {
@@ -179,20 +179,30 @@ struct virtio_pmd_ctrl {
 struct vq_desc_extra {
 	void *cookie;
 	uint16_t ndescs;
+	uint16_t next; /**< free buffer id chain, packed ring only */
 };
 
 struct virtqueue {
 	struct virtio_hw  *hw; /**< virtio_hw structure pointer. */
-	struct vring vq_ring;  /**< vring keeping desc, used and avail */
+	union {
+		struct vring vq_ring;  /**< vring keeping desc, used and avail */
+		/** packed vring keeping desc, driver and device event */
+		struct vring_packed ring_packed;
+	};
 	/**
 	 * Last consumed descriptor in the used table,
 	 * trails vq_ring.used->idx.
+	 * On a packed ring, next descriptor slot to be used by the device.
 	 */
 	uint16_t vq_used_cons_idx;
 	uint16_t vq_nentries;  /**< vring desc numbers */
 	uint16_t vq_free_cnt;  /**< num of desc available */
 	uint16_t vq_avail_idx; /**< sync until needed */
 	uint16_t vq_free_thresh; /**< free threshold */
+	/** AVAIL/USED flags of the next available packed descriptor */
+	uint16_t vq_packed_flags;
+	uint8_t avail_wrap_counter; /**< packed ring driver wrap counter */
+	uint8_t used_wrap_counter;  /**< packed ring device wrap counter */
 
 	void *vq_ring_virt_mem;  /**< linear address of vring*/
 	unsigned int vq_ring_size;
@@ -210,6 +220,7 @@ struct virtqueue {
 	 * Head of the free chain in the descriptor table. If
 	 * there are no free descriptors, this will be set to
 	 * VQ_RING_DESC_CHAIN_END.
+	 * On a packed ring, head of the free buffer id chain.
 	 */
 	uint16_t  vq_desc_head_idx;
 	uint16_t  vq_desc_tail_idx;
@@ -276,13 +287,28 @@ vring_desc_init(struct vring_desc *dp, uint16_t n)
 	dp[i].next = VQ_RING_DESC_CHAIN_END;
 }
 
+/* Chain all the buffer ids of a packed ring with an END */
+static inline void
+vring_desc_init_packed(struct virtqueue *vq, uint16_t n)
+{
+	uint16_t i;
+
+	for (i = 0; i < n - 1; i++)
+		vq->vq_descx[i].next = (uint16_t)(i + 1);
+	vq->vq_descx[i].next = VQ_RING_DESC_CHAIN_END;
+}
+
 /**
  * Tell the backend not to interrupt us.
  */
 static inline void
 virtqueue_disable_intr(struct virtqueue *vq)
 {
-	vq->vq_ring.avail->flags |= VRING_AVAIL_F_NO_INTERRUPT;
+	if (vtpci_packed_queue(vq->hw))
+		vq->ring_packed.driver_event->desc_event_flags =
+			RING_EVENT_FLAGS_DISABLE;
+	else
+		vq->vq_ring.avail->flags |= VRING_AVAIL_F_NO_INTERRUPT;
 }
 
 /**
@@ -291,7 +317,11 @@ virtqueue_disable_intr(struct virtqueue *vq)
 static inline void
 virtqueue_enable_intr(struct virtqueue *vq)
 {
-	vq->vq_ring.avail->flags &= (~VRING_AVAIL_F_NO_INTERRUPT);
+	if (vtpci_packed_queue(vq->hw))
+		vq->ring_packed.driver_event->desc_event_flags =
+			RING_EVENT_FLAGS_ENABLE;
+	else
+		vq->vq_ring.avail->flags &= (~VRING_AVAIL_F_NO_INTERRUPT);
 }
 
 /**
@@ -306,6 +336,29 @@ struct rte_mbuf *virtqueue_detatch_unused(struct virtqueue *vq);
 /* Flush the elements in the used ring. */
 void virtqueue_rxvq_flush(struct virtqueue *vq);
 
+/* Fill the Rx offload flags of a packet from its virtio header */
+int virtio_rx_offload(struct rte_mbuf *m, struct virtio_net_hdr *hdr);
+
+/* Fill the virtio header of a packet from its Tx offload flags */
+void virtqueue_xmit_offload(struct virtio_net_hdr *hdr,
+	struct rte_mbuf *cookie);
+
+static inline int
+rx_offload_enabled(struct virtio_hw *hw)
+{
+	return vtpci_with_feature(hw, VIRTIO_NET_F_GUEST_CSUM) ||
+		vtpci_with_feature(hw, VIRTIO_NET_F_GUEST_TSO4) ||
+		vtpci_with_feature(hw, VIRTIO_NET_F_GUEST_TSO6);
+}
+
+static inline int
+tx_offload_enabled(struct virtio_hw *hw)
+{
+	return vtpci_with_feature(hw, VIRTIO_NET_F_CSUM) ||
+		vtpci_with_feature(hw, VIRTIO_NET_F_HOST_TSO4) ||
+		vtpci_with_feature(hw, VIRTIO_NET_F_HOST_TSO6);
+}
+
 static inline int
 virtqueue_full(const struct virtqueue *vq)
 {
@@ -357,6 +410,85 @@ virtqueue_kick_prepare(struct virtqueue *vq)
 	return !(vq->vq_ring.used->flags & VRING_USED_F_NO_NOTIFY);
 }
 
+/* A packed descriptor is used when both flags match the used wrap counter */
+static inline int
+desc_is_used(struct vring_packed_desc *desc, struct virtqueue *vq)
+{
+	uint16_t flags = *(volatile uint16_t *)&desc->flags;
+	uint16_t used, avail;
+
+	used = !!(flags & VRING_DESC_F_USED(1));
+	avail = !!(flags & VRING_DESC_F_AVAIL(1));
+
+	return avail == used && used == vq->used_wrap_counter;
+}
+
+/*
+ * Buffer id of the chain starting at the next available slot. With
+ * VIRTIO_F_IN_ORDER buffers come back in order and the slot of the chain
+ * head is used as id, otherwise ids are taken from the free chain.
+ */
+static inline uint16_t
+vq_packed_get_id(struct virtqueue *vq)
+{
+	uint16_t id;
+
+	if (vtpci_with_feature(vq->hw, VIRTIO_F_IN_ORDER))
+		return vq->vq_avail_idx;
+
+	id = vq->vq_desc_head_idx;
+	vq->vq_desc_head_idx = vq->vq_descx[id].next;
+	if (vq->vq_desc_head_idx == VQ_RING_DESC_CHAIN_END)
+		vq->vq_desc_tail_idx = VQ_RING_DESC_CHAIN_END;
+	return id;
+}
+
+static inline void
+vq_packed_put_id(struct virtqueue *vq, uint16_t id)
+{
+	if (vtpci_with_feature(vq->hw, VIRTIO_F_IN_ORDER))
+		return;
+
+	vq->vq_descx[id].next = VQ_RING_DESC_CHAIN_END;
+	if (vq->vq_desc_tail_idx == VQ_RING_DESC_CHAIN_END)
+		vq->vq_desc_head_idx = id;
+	else
+		vq->vq_descx[vq->vq_desc_tail_idx].next = id;
+	vq->vq_desc_tail_idx = id;
+}
+
+/* Move to the next available slot, flipping the flags on wrap around */
+static inline void
+vq_packed_inc_avail(struct virtqueue *vq)
+{
+	if (++vq->vq_avail_idx >= vq->vq_nentries) {
+		vq->vq_avail_idx -= vq->vq_nentries;
+		vq->avail_wrap_counter ^= 1;
+		vq->vq_packed_flags ^=
+			VRING_DESC_F_AVAIL(1) | VRING_DESC_F_USED(1);
+	}
+}
+
+/* Move the used index forward by the descriptors of a used buffer */
+static inline void
+vq_packed_inc_used(struct virtqueue *vq, uint16_t ndescs)
+{
+	vq->vq_used_cons_idx += ndescs;
+	if (vq->vq_used_cons_idx >= vq->vq_nentries) {
+		vq->vq_used_cons_idx -= vq->vq_nentries;
+		vq->used_wrap_counter ^= 1;
+	}
+}
+
+static inline int
+virtqueue_kick_prepare_packed(struct virtqueue *vq)
+{
+	/* order the descriptor flags with the read of the device event */
+	virtio_mb();
+	return vq->ring_packed.device_event->desc_event_flags !=
+		RING_EVENT_FLAGS_DISABLE;
+}
+
 static inline void
 virtqueue_notify(struct virtqueue *vq)
 {
@@ -371,6 +503,15 @@ virtqueue_notify(struct virtqueue *vq)
 #ifdef RTE_LIBRTE_VIRTIO_DEBUG_DUMP
 #define VIRTQUEUE_DUMP(vq) do { \
 	uint16_t used_idx, nused; \
+	if (vtpci_packed_queue((vq)->hw)) { \
+		PMD_INIT_LOG(DEBUG, \
+		  "VQ: - size=%d; free=%d; avail_idx=%d; used_cons_idx=%d;" \
+		  " avail_wrap=%d; used_wrap=%d", \
+		  (vq)->vq_nentries, (vq)->vq_free_cnt, \
+		  (vq)->vq_avail_idx, (vq)->vq_used_cons_idx, \
+		  (vq)->avail_wrap_counter, (vq)->used_wrap_counter); \
+		break; \
+	} \
 	used_idx = (vq)->vq_ring.used->idx; \
 	nused = (uint16_t)(used_idx - (vq)->vq_used_cons_idx); \
 	PMD_INIT_LOG(DEBUG, \
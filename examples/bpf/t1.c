@@ -0,0 +1,41 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+/*
+ * eBPF program sample.
+ * Accepts pointer to the first segment packet data as an input parameter.
+ * Accepts IPv4 UDP packets with destination port 5000 and drops all
+ * others.
+ * To compile:
+ * clang -O2 -target bpf -c t1.c
+ */
+
+#include <stdint.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+
+uint64_t
+entry(void *pkt)
+{
+	struct ether_header *eth;
+	struct iphdr *iph;
+	struct udphdr *udh;
+
+	eth = pkt;
+
+	if (eth->ether_type != htons(ETHERTYPE_IP))
+		return 0;
+
+	iph = (struct iphdr *)(eth + 1);
+	if (iph->protocol != IPPROTO_UDP)
+		return 0;
+
+	udh = (struct udphdr *)((uint8_t *)iph + iph->ihl * 4);
+	if (udh->dest != htons(5000))
+		return 0;
+
+	return 1;
+}
@@ -0,0 +1,29 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+/*
+ * eBPF program sample.
+ * Accepts pointer to struct rte_mbuf as an input parameter.
+ * Dumps the first 64 bytes of every packet to stdout and accepts it,
+ * through the symbols testpmd provides.
+ * To compile:
+ * clang -O2 -I${RTE_SDK}/${RTE_TARGET}/include -target bpf -c t2.c
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <rte_config.h>
+#include <rte_mbuf.h>
+
+uint64_t
+entry(void *pkt)
+{
+	struct rte_mbuf *mb;
+
+	mb = pkt;
+	rte_pktmbuf_dump(stdout, mb, 64);
+
+	return 1;
+}
@@ -166,9 +166,6 @@ enum {
 };
 
 
-/** MAX number of tries per one ACL context.*/
-#define RTE_ACL_MAX_TRIES	8
-
 /** Max number of characters in PM name.*/
 #define RTE_ACL_NAMESIZE	32
 
@@ -191,6 +188,10 @@ struct rte_acl_ctx {
 	int32_t             socket_id;
 	/** Socket ID to allocate memory from. */
 	enum rte_acl_classify_alg alg;
+	uint32_t            build_threads;
+	/** Number of threads to build with, the calling one included. */
+	rte_cpuset_t        build_cpuset;
+	/** CPUs of the build worker threads, empty to inherit. */
 	void               *rules;
 	uint32_t            max_rules;
 	uint32_t            rule_sz;
@@ -205,6 +206,7 @@ struct rte_acl_ctx {
 	struct rte_acl_trie trie[RTE_ACL_MAX_TRIES];
 	void               *mem;
 	size_t              mem_sz;
+	struct rte_acl_build_stats stats; /* stats of the last build. */
 	struct rte_acl_config config; /* copy of build config. */
 };
 
@@ -212,6 +214,10 @@ int rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
 	uint32_t num_categories, uint32_t data_index_sz, size_t max_size);
 
+int acl_check_rule(const struct rte_acl_rule_data *rd);
+
+enum rte_acl_classify_alg acl_get_default_classify(void);
+
 typedef int (*rte_acl_classify_t)
 (const struct rte_acl_ctx *, const uint8_t **, uint32_t *, uint32_t, uint32_t);
 
@@ -230,6 +236,10 @@ int
 rte_acl_classify_avx2(const struct rte_acl_ctx *ctx, const uint8_t **data,
 	uint32_t *results, uint32_t num, uint32_t categories);
 
+int
+rte_acl_classify_avx512(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories);
+
 int
 rte_acl_classify_neon(const struct rte_acl_ctx *ctx, const uint8_t **data,
 	uint32_t *results, uint32_t num, uint32_t categories);
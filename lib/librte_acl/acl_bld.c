@@ -31,7 +31,10 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <pthread.h>
+
 #include <rte_acl.h>
+#include <rte_cycles.h>
 #include "tb_mem.h"
 #include "acl.h"
 
@@ -91,6 +94,8 @@ struct rte_acl_build_rule {
 	uint32_t                    *wildness;
 };
 
+struct acl_build_worker;
+
 /* Context for build phase */
 struct acl_build_context {
 	const struct rte_acl_ctx *acx;
@@ -114,6 +119,25 @@ struct acl_build_context {
 	/* memory free lists for nodes and blocks used for node ptrs */
 	struct acl_mem_block      blocks[MEM_BLOCK_NUM];
 	struct rte_acl_node       *node_free_list;
+
+	/* worker threads rebuilding the tries split from the rule set */
+	uint32_t                  num_threads;
+	uint32_t                  num_workers;
+	uint32_t                  num_joined;
+	struct acl_build_worker   *workers[RTE_ACL_MAX_TRIES];
+};
+
+/*
+ * Rebuild of one trie on a worker thread. The worker has its own build
+ * context, as the memory pool and free lists are not thread safe, and
+ * its own copy of the head of the trie rule set.
+ */
+struct acl_build_worker {
+	struct acl_build_context   bcx;
+	struct rte_acl_build_rule  *rule_sets[RTE_ACL_MAX_TRIES];
+	uint32_t                   trie;
+	int                        rc;
+	pthread_t                  thread;
 };
 
 static int acl_merge_trie(struct acl_build_context *context,
@@ -1300,10 +1324,141 @@ build_one_trie(struct acl_build_context *context,
 	return last;
 }
 
+static void *
+acl_build_worker_main(void *arg)
+{
+	struct acl_build_worker *wrk;
+	struct rte_acl_build_rule *last;
+	int32_t rc;
+
+	wrk = arg;
+
+	rc = sigsetjmp(wrk->bcx.pool.fail, 0);
+	if (rc == 0) {
+		last = build_one_trie(&wrk->bcx, wrk->rule_sets, wrk->trie,
+			INT32_MAX);
+		if (wrk->bcx.bld_tries[wrk->trie].trie == NULL || last != NULL)
+			rc = -ENOMEM;
+	}
+
+	wrk->rc = rc;
+	return NULL;
+}
+
+/*
+ * Wait for the oldest worker, and take the trie it built.
+ */
+static int
+acl_build_worker_join(struct acl_build_context *context)
+{
+	struct acl_build_worker *wrk;
+	uint32_t n;
+
+	wrk = context->workers[context->num_joined++];
+	pthread_join(wrk->thread, NULL);
+
+	n = wrk->trie;
+	if (wrk->rc != 0) {
+		RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
+		return wrk->rc;
+	}
+
+	context->tries[n] = wrk->bcx.tries[n];
+	context->tries[n].data_index = context->data_indexes[n];
+	memcpy(context->data_indexes[n], wrk->bcx.data_indexes[n],
+		sizeof(context->data_indexes[n]));
+	context->bld_tries[n] = wrk->bcx.bld_tries[n];
+	context->num_nodes += wrk->bcx.num_nodes;
+	return 0;
+}
+
+static int
+acl_build_workers_join(struct acl_build_context *context)
+{
+	int32_t rc, ret;
+
+	rc = 0;
+	while (context->num_joined != context->num_workers) {
+		ret = acl_build_worker_join(context);
+		if (rc == 0)
+			rc = ret;
+	}
+	return rc;
+}
+
+/*
+ * Rebuild the n-th trie for its reduced rule-set on a worker thread,
+ * once one is free.
+ */
+static int
+acl_build_worker_start(struct acl_build_context *context,
+	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES], uint32_t n)
+{
+	struct acl_build_worker *wrk;
+	int32_t rc;
+
+	if (context->num_workers - context->num_joined + 1 ==
+			context->num_threads) {
+		rc = acl_build_worker_join(context);
+		if (rc != 0)
+			return rc;
+	}
+
+	wrk = acl_build_alloc(context, 1, sizeof(*wrk));
+	wrk->bcx.acx = context->acx;
+	wrk->bcx.pool.alignment = ACL_POOL_ALIGN;
+	wrk->bcx.pool.min_alloc = ACL_POOL_ALLOC_MIN;
+	wrk->bcx.cfg.num_categories = context->cfg.num_categories;
+	wrk->rule_sets[n] = rule_sets[n];
+	wrk->trie = n;
+
+	rc = pthread_create(&wrk->thread, NULL, acl_build_worker_main, wrk);
+	if (rc != 0) {
+		RTE_LOG(ERR, ACL, "ACL context: %s, cannot start a build "
+			"thread: %s\n", context->acx->name, strerror(rc));
+		return -rc;
+	}
+
+	if (CPU_COUNT(&context->acx->build_cpuset) != 0 &&
+			pthread_setaffinity_np(wrk->thread,
+				sizeof(context->acx->build_cpuset),
+				&context->acx->build_cpuset) != 0)
+		RTE_LOG(WARNING, ACL, "ACL context: %s, cannot set the "
+			"affinity of a build thread\n", context->acx->name);
+
+	context->workers[context->num_workers++] = wrk;
+	return 0;
+}
+
+/*
+ * Free the memory of the tries built by the workers.
+ */
+static void
+acl_build_workers_free(struct acl_build_context *context)
+{
+	uint32_t n;
+
+	for (n = 0; n != context->num_workers; n++)
+		tb_free_pool(&context->workers[n]->bcx.pool);
+}
+
+static size_t
+acl_build_mem(const struct acl_build_context *context)
+{
+	size_t sz;
+	uint32_t n;
+
+	sz = context->pool.alloc;
+	for (n = 0; n != context->num_workers; n++)
+		sz += context->workers[n]->bcx.pool.alloc;
+	return sz;
+}
+
 static int
 acl_build_tries(struct acl_build_context *context,
 	struct rte_acl_build_rule *head)
 {
+	int32_t rc;
 	uint32_t n, num_tries;
 	struct rte_acl_config *config;
 	struct rte_acl_build_rule *last;
@@ -1362,7 +1517,15 @@ acl_build_tries(struct acl_build_context *context,
 		/*
 		 * Rebuild the trie for the reduced rule-set.
 		 * Don't try to split it any further.
+		 * With build threads, it runs along the next trie build.
 		 */
+		if (context->num_threads > 1) {
+			rc = acl_build_worker_start(context, rule_sets, n);
+			if (rc != 0)
+				return rc;
+			continue;
+		}
+
 		last = build_one_trie(context, rule_sets, n, INT32_MAX);
 		if (context->bld_tries[n].trie == NULL || last != NULL) {
 			RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
@@ -1383,11 +1546,13 @@ acl_build_log(const struct acl_build_context *ctx)
 	RTE_LOG(DEBUG, ACL, "Build phase for ACL \"%s\":\n"
 		"node limit for tree split: %u\n"
 		"nodes created: %u\n"
+		"tries built by worker threads: %u\n"
 		"memory consumed: %zu\n",
 		ctx->acx->name,
 		ctx->node_max,
 		ctx->num_nodes,
-		ctx->pool.alloc);
+		ctx->num_workers,
+		acl_build_mem(ctx));
 
 	for (n = 0; n < RTE_DIM(ctx->tries); n++) {
 		if (ctx->tries[n].count != 0)
@@ -1466,7 +1631,7 @@ static int
 acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 	const struct rte_acl_config *cfg, uint32_t node_max)
 {
-	int32_t rc;
+	int32_t rc, ret;
 
 	/* setup build context. */
 	memset(bcx, 0, sizeof(*bcx));
@@ -1477,6 +1642,7 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 	bcx->category_mask = RTE_LEN2MASK(bcx->cfg.num_categories,
 		typeof(bcx->category_mask));
 	bcx->node_max = node_max;
+	bcx->num_threads = ctx->build_threads;
 
 	rc = sigsetjmp(bcx->pool.fail, 0);
 
@@ -1485,6 +1651,7 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 		RTE_LOG(ERR, ACL,
 			"ACL context: %s, %s() failed with error code: %d\n",
 			bcx->acx->name, __func__, rc);
+		acl_build_workers_join(bcx);
 		return rc;
 	}
 
@@ -1499,6 +1666,9 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 	} else {
 		/* build internal trie representation. */
 		rc = acl_build_tries(bcx, bcx->build_rules);
+		ret = acl_build_workers_join(bcx);
+		if (rc == 0)
+			rc = ret;
 	}
 	return rc;
 }
@@ -1546,18 +1716,42 @@ acl_check_bld_param(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 	return 0;
 }
 
+/*
+ * Keep the build phase stats of the last attempt in the context.
+ */
+static void
+acl_build_stats(struct rte_acl_ctx *ctx, const struct acl_build_context *bcx)
+{
+	uint32_t n;
+
+	ctx->stats.num_attempts++;
+	ctx->stats.gen_cycles = 0;
+	ctx->stats.node_max = bcx->node_max;
+	ctx->stats.num_workers = bcx->num_workers;
+	ctx->stats.num_nodes = bcx->num_nodes;
+	ctx->stats.tmp_mem = acl_build_mem(bcx);
+	ctx->stats.num_tries = bcx->num_tries;
+
+	for (n = 0; n != RTE_DIM(bcx->tries); n++) {
+		ctx->stats.trie_rules[n] = bcx->tries[n].count;
+		ctx->stats.trie_nodes[n] = 0;
+	}
+}
+
 int
 rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 {
 	int32_t rc;
 	uint32_t n;
 	size_t max_size;
+	uint64_t start, tm;
 	struct acl_build_context bcx;
 
 	rc = acl_check_bld_param(ctx, cfg);
 	if (rc != 0)
 		return rc;
 
+	start = rte_rdtsc();
 	acl_build_reset(ctx);
 
 	if (cfg->max_size == 0) {
@@ -1571,14 +1765,19 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 	for (rc = -ERANGE; n >= NODE_MIN && rc == -ERANGE; n /= 2) {
 
 		/* perform build phase. */
+		tm = rte_rdtsc();
 		rc = acl_bld(&bcx, ctx, cfg, n);
+		ctx->stats.trie_cycles = rte_rdtsc() - tm;
+		acl_build_stats(ctx, &bcx);
 
 		if (rc == 0) {
 			/* allocate and fill run-time  structures. */
+			tm = rte_rdtsc();
 			rc = rte_acl_gen(ctx, bcx.tries, bcx.bld_tries,
 				bcx.num_tries, bcx.cfg.num_categories,
 				RTE_ACL_MAX_FIELDS * RTE_DIM(bcx.tries) *
 				sizeof(ctx->data_indexes[0]), max_size);
+			ctx->stats.gen_cycles = rte_rdtsc() - tm;
 			if (rc == 0) {
 				/* set data indexes. */
 				acl_set_data_indexes(ctx);
@@ -1591,8 +1790,10 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 		acl_build_log(&bcx);
 
 		/* cleanup after build. */
+		acl_build_workers_free(&bcx);
 		tb_free_pool(&bcx.pool);
 	}
 
+	ctx->stats.build_cycles = rte_rdtsc() - start;
 	return rc;
 }
@@ -443,21 +443,29 @@ acl_gen_node(struct rte_acl_node *node, uint64_t *node_array,
 	}
 }
 
+static uint32_t
+acl_count_nodes(const struct acl_node_counters *counts)
+{
+	return counts->match + counts->single + counts->quad + counts->dfa;
+}
+
 static void
 acl_calc_counts_indices(struct acl_node_counters *counts,
-	struct rte_acl_indices *indices,
+	struct rte_acl_indices *indices, uint32_t *trie_nodes,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
 	uint64_t no_match)
 {
-	uint32_t n;
+	uint32_t k, n;
 
 	memset(indices, 0, sizeof(*indices));
 	memset(counts, 0, sizeof(*counts));
 
 	/* Get stats on nodes */
 	for (n = 0; n < num_tries; n++) {
+		k = acl_count_nodes(counts);
 		acl_count_trie_types(counts, node_bld_trie[n].trie,
 			no_match, 1);
+		trie_nodes[n] = acl_count_nodes(counts) - k;
 	}
 
 	indices->dfa_index = RTE_ACL_DFA_SIZE + 1;
@@ -489,7 +497,7 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	no_match = RTE_ACL_NODE_MATCH;
 
 	/* Fill counts and indices arrays from the nodes. */
-	acl_calc_counts_indices(&counts, &indices,
+	acl_calc_counts_indices(&counts, &indices, ctx->stats.trie_nodes,
 		node_bld_trie, num_tries, no_match);
 
 	/* Allocate runtime memory (align to cache boundary) */
@@ -498,6 +506,13 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 		(counts.match + 1) * sizeof(struct rte_acl_match_results) +
 		XMM_SIZE;
 
+	/* Keep the counts, even if the build does not fit. */
+	ctx->stats.dfa_nodes = counts.dfa;
+	ctx->stats.quad_nodes = counts.quad;
+	ctx->stats.single_nodes = counts.single;
+	ctx->stats.match_nodes = counts.match;
+	ctx->stats.rt_mem = total_size;
+
 	if (total_size > max_size) {
 		RTE_LOG(DEBUG, ACL,
 			"Gen phase for ACL ctx \"%s\" exceeds max_size limit, "
@@ -0,0 +1,452 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <rte_acl.h>
+#include "acl.h"
+
+/* packets classified at once over all the partitions */
+#define	ACL_INC_BURST	64
+
+/* user view of the rule a partition result refers to */
+struct acl_inc_res {
+	uint32_t userdata;
+	int32_t  priority;
+};
+
+/*
+ * One build of a partition, read only once published.
+ * The rules of the sub-context carry the index of their entry
+ * in res[] plus one as userdata.
+ */
+struct acl_inc_trie {
+	struct rte_acl_ctx *ctx;
+	uint32_t            num_rules;
+	struct acl_inc_res  res[];
+};
+
+struct acl_inc_part {
+	uint8_t             *rules;   /* rule_sz bytes per rule */
+	uint32_t             num_rules;
+	uint32_t             dirty;   /* changed since the last commit */
+	uint32_t             gen;     /* builds of the partition */
+	struct acl_inc_trie *live;    /* used by the classification */
+	struct acl_inc_trie *retired; /* replaced at the last commit */
+};
+
+struct rte_acl_inc_ctx {
+	char                  name[RTE_ACL_NAMESIZE];
+	int32_t               socket_id;
+	enum rte_acl_classify_alg alg;
+	uint32_t              rule_sz;
+	uint32_t              max_rules;
+	uint32_t              part_rules;
+	uint32_t              num_rules;
+	uint32_t              num_parts;
+	struct rte_acl_config config;
+	struct acl_inc_part   part[];
+};
+
+static void
+acl_inc_trie_free(struct acl_inc_trie *t)
+{
+	if (t == NULL)
+		return;
+
+	if (t->ctx != NULL) {
+		rte_free(t->ctx->mem);
+		rte_free(t->ctx);
+	}
+	rte_free(t);
+}
+
+struct rte_acl_inc_ctx *
+rte_acl_inc_create(const struct rte_acl_inc_param *param,
+	const struct rte_acl_config *cfg)
+{
+	struct rte_acl_inc_ctx *ctx;
+	uint32_t i, part_rules, num_parts;
+	uint8_t *rules;
+	size_t sz;
+
+	if (param == NULL || param->name == NULL || cfg == NULL ||
+			param->rule_size < sizeof(struct rte_acl_rule) ||
+			param->max_rule_num == 0 ||
+			cfg->num_categories == 0 ||
+			cfg->num_categories > RTE_ACL_MAX_CATEGORIES ||
+			cfg->num_fields == 0 ||
+			cfg->num_fields > RTE_ACL_MAX_FIELDS) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	part_rules = param->part_rule_num;
+	if (part_rules == 0)
+		part_rules = RTE_ACL_INC_DEFAULT_PART_RULES;
+	part_rules = RTE_MIN(part_rules, param->max_rule_num);
+	num_parts = (param->max_rule_num + part_rules - 1) / part_rules;
+
+	/* the rules of all the partitions follow the partition array. */
+	sz = sizeof(*ctx) + num_parts * sizeof(ctx->part[0]);
+	sz = RTE_ALIGN_CEIL(sz, RTE_CACHE_LINE_SIZE);
+	ctx = rte_zmalloc_socket(param->name,
+		sz + (size_t)num_parts * part_rules * param->rule_size,
+		RTE_CACHE_LINE_SIZE, param->socket_id);
+	if (ctx == NULL) {
+		RTE_LOG(ERR, ACL, "allocation of context %s failed\n",
+			param->name);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	snprintf(ctx->name, sizeof(ctx->name), "%s", param->name);
+	ctx->socket_id = param->socket_id;
+	ctx->alg = acl_get_default_classify();
+	ctx->rule_sz = param->rule_size;
+	ctx->max_rules = param->max_rule_num;
+	ctx->part_rules = part_rules;
+	ctx->num_parts = num_parts;
+	ctx->config = *cfg;
+
+	rules = (uint8_t *)ctx + sz;
+	for (i = 0; i != num_parts; i++)
+		ctx->part[i].rules = rules +
+			(size_t)i * part_rules * param->rule_size;
+
+	return ctx;
+}
+
+void
+rte_acl_inc_free(struct rte_acl_inc_ctx *ctx)
+{
+	uint32_t i;
+
+	if (ctx == NULL)
+		return;
+
+	for (i = 0; i != ctx->num_parts; i++) {
+		acl_inc_trie_free(ctx->part[i].live);
+		acl_inc_trie_free(ctx->part[i].retired);
+	}
+	rte_free(ctx);
+}
+
+int
+rte_acl_inc_add_rules(struct rte_acl_inc_ctx *ctx,
+	const struct rte_acl_rule *rules, uint32_t num)
+{
+	const struct rte_acl_rule *rv;
+	struct acl_inc_part *p;
+	uint32_t i, n, k;
+
+	if (ctx == NULL || (rules == NULL && num != 0))
+		return -EINVAL;
+
+	for (i = 0; i != num; i++) {
+		rv = (const struct rte_acl_rule *)
+			((uintptr_t)rules + i * ctx->rule_sz);
+		if (rv->data.userdata == 0 || acl_check_rule(&rv->data) != 0) {
+			RTE_LOG(ERR, ACL, "%s(%s): rule #%u is invalid\n",
+				__func__, ctx->name, i + 1);
+			return -EINVAL;
+		}
+	}
+
+	if (num > ctx->max_rules - ctx->num_rules)
+		return -ENOMEM;
+
+	/* fill the partitions in order, to keep as few of them as possible */
+	for (i = 0, k = 0; i != num; k++) {
+		p = ctx->part + k;
+		n = RTE_MIN(num - i, ctx->part_rules - p->num_rules);
+		if (n == 0)
+			continue;
+
+		memcpy(p->rules + (size_t)p->num_rules * ctx->rule_sz,
+			(const uint8_t *)rules + (size_t)i * ctx->rule_sz,
+			(size_t)n * ctx->rule_sz);
+		p->num_rules += n;
+		p->dirty = 1;
+		i += n;
+	}
+
+	ctx->num_rules += num;
+	return 0;
+}
+
+static int
+acl_inc_cmp_userdata(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+int
+rte_acl_inc_del_rules(struct rte_acl_inc_ctx *ctx, const uint32_t *userdata,
+	uint32_t num)
+{
+	const struct rte_acl_rule *rv;
+	struct acl_inc_part *p;
+	uint32_t *ids;
+	uint32_t i, k;
+	int deleted;
+
+	if (ctx == NULL || (userdata == NULL && num != 0))
+		return -EINVAL;
+	if (num == 0)
+		return 0;
+
+	/* sorted copy of the userdata, for a single pass over the rules */
+	ids = malloc(num * sizeof(ids[0]));
+	if (ids == NULL)
+		return -ENOMEM;
+	memcpy(ids, userdata, num * sizeof(ids[0]));
+	qsort(ids, num, sizeof(ids[0]), acl_inc_cmp_userdata);
+
+	deleted = 0;
+	for (k = 0; k != ctx->num_parts; k++) {
+		p = ctx->part + k;
+
+		for (i = 0; i < p->num_rules; ) {
+			rv = (const struct rte_acl_rule *)
+				(p->rules + (size_t)i * ctx->rule_sz);
+			if (bsearch(&rv->data.userdata, ids, num,
+					sizeof(ids[0]),
+					acl_inc_cmp_userdata) == NULL) {
+				i++;
+				continue;
+			}
+
+			/* the last rule of the partition takes the free slot */
+			p->num_rules--;
+			if (i != p->num_rules)
+				memcpy(p->rules + (size_t)i * ctx->rule_sz,
+					p->rules + (size_t)p->num_rules *
+					ctx->rule_sz, ctx->rule_sz);
+			p->dirty = 1;
+			deleted++;
+		}
+	}
+
+	ctx->num_rules -= deleted;
+	free(ids);
+	return deleted;
+}
+
+/*
+ * Build one partition into a new trie, the rules of the sub-context
+ * refer to the results table of the trie.
+ */
+static int
+acl_inc_build(struct rte_acl_inc_ctx *ctx, struct acl_inc_part *p,
+	struct acl_inc_trie **trie)
+{
+	struct acl_inc_trie *t;
+	struct rte_acl_ctx *sub;
+	struct rte_acl_rule *rv;
+	uint32_t i;
+	int rc;
+
+	*trie = NULL;
+	if (p->num_rules == 0)
+		return 0;
+
+	t = rte_zmalloc_socket(ctx->name,
+		sizeof(*t) + p->num_rules * sizeof(t->res[0]),
+		RTE_CACHE_LINE_SIZE, ctx->socket_id);
+	sub = rte_zmalloc_socket(ctx->name,
+		sizeof(*sub) + (size_t)p->num_rules * ctx->rule_sz,
+		RTE_CACHE_LINE_SIZE, ctx->socket_id);
+	if (t == NULL || sub == NULL) {
+		rte_free(t);
+		rte_free(sub);
+		return -ENOMEM;
+	}
+
+	snprintf(sub->name, sizeof(sub->name), "%s_%u_%u", ctx->name,
+		(uint32_t)(p - ctx->part), p->gen);
+	sub->rules = sub + 1;
+	sub->max_rules = p->num_rules;
+	sub->num_rules = p->num_rules;
+	sub->rule_sz = ctx->rule_sz;
+	sub->socket_id = ctx->socket_id;
+	sub->alg = ctx->alg;
+	t->ctx = sub;
+	t->num_rules = p->num_rules;
+
+	memcpy(sub->rules, p->rules, (size_t)p->num_rules * ctx->rule_sz);
+	for (i = 0; i != p->num_rules; i++) {
+		rv = (struct rte_acl_rule *)
+			((uintptr_t)sub->rules + i * ctx->rule_sz);
+		t->res[i].userdata = rv->data.userdata;
+		t->res[i].priority = rv->data.priority;
+		rv->data.userdata = i + 1;
+	}
+
+	rc = rte_acl_build(sub, &ctx->config);
+	if (rc != 0) {
+		acl_inc_trie_free(t);
+		return rc;
+	}
+
+	*trie = t;
+	return 0;
+}
+
+int
+rte_acl_inc_commit(struct rte_acl_inc_ctx *ctx)
+{
+	struct acl_inc_part *p;
+	struct acl_inc_trie *t;
+	uint32_t i;
+	int rc, ret;
+
+	if (ctx == NULL)
+		return -EINVAL;
+
+	/* lookups from before the previous commit are over. */
+	for (i = 0; i != ctx->num_parts; i++) {
+		acl_inc_trie_free(ctx->part[i].retired);
+		ctx->part[i].retired = NULL;
+	}
+
+	ret = 0;
+	for (i = 0; i != ctx->num_parts; i++) {
+		p = ctx->part + i;
+		if (p->dirty == 0)
+			continue;
+
+		rc = acl_inc_build(ctx, p, &t);
+		if (rc != 0) {
+			RTE_LOG(ERR, ACL, "%s(%s): build of partition %u "
+				"failed with %d\n", __func__, ctx->name, i, rc);
+			ret = rc;
+			continue;
+		}
+
+		/* the trie is complete before it becomes visible */
+		rte_smp_wmb();
+		p->retired = p->live;
+		p->live = t;
+		p->dirty = 0;
+		p->gen++;
+	}
+
+	return ret;
+}
+
+/*
+ * Merge the results of one partition into the running results,
+ * keeping the match of highest priority for every category.
+ */
+static inline void
+acl_inc_merge(const struct acl_inc_trie *t, const uint32_t *part_res,
+	uint32_t *results, int32_t *priority, uint32_t num)
+{
+	const struct acl_inc_res *r;
+	uint32_t i;
+
+	for (i = 0; i != num; i++) {
+		if (part_res[i] == 0)
+			continue;
+
+		r = t->res + part_res[i] - 1;
+		if (results[i] == 0 || r->priority > priority[i]) {
+			results[i] = r->userdata;
+			priority[i] = r->priority;
+		}
+	}
+}
+
+int
+rte_acl_inc_classify(const struct rte_acl_inc_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories)
+{
+	uint32_t part_res[ACL_INC_BURST * RTE_ACL_MAX_CATEGORIES];
+	int32_t priority[ACL_INC_BURST * RTE_ACL_MAX_CATEGORIES];
+	const struct acl_inc_trie *t;
+	uint32_t i, k, n;
+	int rc;
+
+	if (ctx == NULL || categories == 0 ||
+			categories > RTE_ACL_MAX_CATEGORIES ||
+			(categories != 1 &&
+			((RTE_ACL_RESULTS_MULTIPLIER - 1) & categories) != 0))
+		return -EINVAL;
+
+	for (i = 0; i < num; i += n) {
+		n = RTE_MIN(num - i, (uint32_t)ACL_INC_BURST);
+		memset(results, 0, n * categories * sizeof(results[0]));
+
+		for (k = 0; k != ctx->num_parts; k++) {
+			t = *(const struct acl_inc_trie * const volatile *)
+				&ctx->part[k].live;
+			if (t == NULL)
+				continue;
+
+			rc = rte_acl_classify_alg(t->ctx, data, part_res, n,
+				categories, ctx->alg);
+			if (rc != 0)
+				return rc;
+
+			acl_inc_merge(t, part_res, results, priority,
+				n * categories);
+		}
+
+		data += n;
+		results += n * categories;
+	}
+
+	return 0;
+}
+
+int
+rte_acl_inc_set_classify(struct rte_acl_inc_ctx *ctx,
+	enum rte_acl_classify_alg alg)
+{
+	uint32_t i;
+
+	if (ctx == NULL || (uint32_t)alg >= RTE_ACL_CLASSIFY_NUM)
+		return -EINVAL;
+
+	ctx->alg = alg;
+	for (i = 0; i != ctx->num_parts; i++)
+		if (ctx->part[i].live != NULL)
+			rte_acl_set_ctx_classify(ctx->part[i].live->ctx, alg);
+
+	return 0;
+}
+
+void
+rte_acl_inc_dump(const struct rte_acl_inc_ctx *ctx)
+{
+	const struct acl_inc_part *p;
+	uint32_t i;
+
+	if (ctx == NULL)
+		return;
+
+	printf("acl incremental context <%s>@%p\n", ctx->name, ctx);
+	printf("  socket_id=%"PRId32"\n", ctx->socket_id);
+	printf("  alg=%"PRId32"\n", ctx->alg);
+	printf("  max_rules=%"PRIu32"\n", ctx->max_rules);
+	printf("  rule_size=%"PRIu32"\n", ctx->rule_sz);
+	printf("  num_rules=%"PRIu32"\n", ctx->num_rules);
+	printf("  part_rules=%"PRIu32"\n", ctx->part_rules);
+	printf("  num_parts=%"PRIu32"\n", ctx->num_parts);
+
+	for (i = 0; i != ctx->num_parts; i++) {
+		p = ctx->part + i;
+		if (p->num_rules == 0 && p->live == NULL)
+			continue;
+		printf("  part %u: num_rules=%"PRIu32", built_rules=%"PRIu32
+			", num_tries=%"PRIu32", mem_sz=%zu%s\n", i,
+			p->num_rules,
+			p->live != NULL ? p->live->num_rules : 0,
+			p->live != NULL ? p->live->ctx->num_tries : 0,
+			p->live != NULL ? p->live->ctx->mem_sz : 0,
+			p->dirty ? ", dirty" : "");
+	}
+}
@@ -0,0 +1,263 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include "acl_run_sse.h"
+
+/* flows per ZMM register, one 32-bit half of a transition per flow */
+#define ZMM_FLOWS	(sizeof(__m512i) / sizeof(uint32_t))
+#define MAX_ZMM		(MAX_SEARCHES_AVX512X64 / ZMM_FLOWS)
+
+/*
+ * Calculate the address of the next transition for 16 flows,
+ * see ACL_TR_CALC_ADDR() for the details. AVX512 has no sign and
+ * blendv instructions, masks are used instead.
+ */
+static __rte_always_inline __m512i
+calc_addr16(__m512i index_mask, __m512i next_input, __m512i shuffle_input,
+	__m512i ones_16, __m512i range_base, __m512i tr_lo, __m512i tr_hi)
+{
+	__mmask64 qm;
+	__mmask16 dfa_msk;
+	__m512i addr, in, node_type, r, t;
+	__m512i dfa_ofs, quad_ofs;
+
+	in = _mm512_shuffle_epi8(next_input, shuffle_input);
+
+	/* Calc node type and node addr */
+	node_type = _mm512_andnot_si512(index_mask, tr_lo);
+	addr = _mm512_and_si512(index_mask, tr_lo);
+
+	/* mask for DFA type(0) nodes */
+	dfa_msk = _mm512_cmpeq_epi32_mask(node_type, _mm512_setzero_si512());
+
+	/* DFA calculations. */
+	r = _mm512_srli_epi32(in, 30);
+	r = _mm512_add_epi8(r, range_base);
+	t = _mm512_srli_epi32(in, 24);
+	r = _mm512_shuffle_epi8(tr_hi, r);
+
+	dfa_ofs = _mm512_sub_epi32(t, r);
+
+	/* QUAD/SINGLE calculations: count the boundaries below the input. */
+	qm = _mm512_cmpgt_epi8_mask(in, tr_hi);
+	t = _mm512_maskz_set1_epi8(qm, 1);
+	t = _mm512_maddubs_epi16(t, t);
+	quad_ofs = _mm512_madd_epi16(t, ones_16);
+
+	/* blend DFA and QUAD/SINGLE. */
+	t = _mm512_mask_mov_epi32(quad_ofs, dfa_msk, dfa_ofs);
+
+	/* calculate address for next transitions. */
+	return _mm512_add_epi32(addr, t);
+}
+
+/*
+ * Process 16 transitions in parallel.
+ * tr_lo contains low 32 bits for 16 transitions.
+ * tr_hi contains high 32 bits for 16 transitions.
+ * next_input contains up to 4 input bytes for 16 flows.
+ */
+static __rte_always_inline __m512i
+transition16(__m512i next_input, const uint64_t *trans, __m512i *tr_lo,
+	__m512i *tr_hi)
+{
+	const int32_t *tr;
+	__m512i addr;
+
+	tr = (const int32_t *)(uintptr_t)trans;
+
+	/* Calculate the address (array index) for all 16 transitions. */
+	addr = calc_addr16(_mm512_set1_epi32(RTE_ACL_NODE_INDEX), next_input,
+		_mm512_set4_epi32(0x0c0c0c0c, 0x08080808, 0x04040404, 0),
+		_mm512_set1_epi16(1),
+		_mm512_set4_epi32(0xffffff0c, 0xffffff08, 0xffffff04,
+			0xffffff00),
+		*tr_lo, *tr_hi);
+
+	/* load lower 32 bits of 16 transactions at once. */
+	*tr_lo = _mm512_i32gather_epi32(addr, tr, sizeof(trans[0]));
+
+	next_input = _mm512_srli_epi32(next_input, CHAR_BIT);
+
+	/* load high 32 bits of 16 transactions at once. */
+	*tr_hi = _mm512_i32gather_epi32(addr, tr + 1, sizeof(trans[0]));
+
+	return next_input;
+}
+
+/*
+ * Split 16 transitions into their low and high 32 bits.
+ */
+static inline void
+acl_tr_hilo16(const uint64_t *tr, __m512i *tr_lo, __m512i *tr_hi)
+{
+	const __m512i lo_idx = _mm512_set_epi32(30, 28, 26, 24, 22, 20, 18,
+		16, 14, 12, 10, 8, 6, 4, 2, 0);
+	const __m512i hi_idx = _mm512_set_epi32(31, 29, 27, 25, 23, 21, 19,
+		17, 15, 13, 11, 9, 7, 5, 3, 1);
+	__m512i t0, t1;
+
+	t0 = _mm512_loadu_si512(tr);
+	t1 = _mm512_loadu_si512(tr + ZMM_FLOWS / 2);
+
+	*tr_lo = _mm512_permutex2var_epi32(t0, lo_idx, t1);
+	*tr_hi = _mm512_permutex2var_epi32(t0, hi_idx, t1);
+}
+
+/*
+ * Get the next 4 input bytes of 16 flows.
+ */
+static __rte_always_inline __m512i
+acl_next_input16(struct parms *parms, uint32_t slot)
+{
+	return _mm512_set_epi32(
+		GET_NEXT_4BYTES(parms, slot + 15),
+		GET_NEXT_4BYTES(parms, slot + 14),
+		GET_NEXT_4BYTES(parms, slot + 13),
+		GET_NEXT_4BYTES(parms, slot + 12),
+		GET_NEXT_4BYTES(parms, slot + 11),
+		GET_NEXT_4BYTES(parms, slot + 10),
+		GET_NEXT_4BYTES(parms, slot + 9),
+		GET_NEXT_4BYTES(parms, slot + 8),
+		GET_NEXT_4BYTES(parms, slot + 7),
+		GET_NEXT_4BYTES(parms, slot + 6),
+		GET_NEXT_4BYTES(parms, slot + 5),
+		GET_NEXT_4BYTES(parms, slot + 4),
+		GET_NEXT_4BYTES(parms, slot + 3),
+		GET_NEXT_4BYTES(parms, slot + 2),
+		GET_NEXT_4BYTES(parms, slot + 1),
+		GET_NEXT_4BYTES(parms, slot));
+}
+
+/*
+ * Complete the flows of a 16 flows set that reached a match node and
+ * start the next tries in their slots, until none of them is at a match
+ * node. Kept out of line, so that the search loop keeps its registers.
+ */
+static __rte_noinline void
+acl_match_avx512x16(const struct rte_acl_ctx *ctx, struct parms *parms,
+	struct acl_flow_data *flows, uint32_t slot, uint32_t msk,
+	__m512i *tr_lo, __m512i *tr_hi)
+{
+	uint32_t lo[ZMM_FLOWS] __rte_aligned(sizeof(__m512i));
+	uint32_t hi[ZMM_FLOWS] __rte_aligned(sizeof(__m512i));
+	const __m512i match_mask = _mm512_set1_epi32(RTE_ACL_NODE_MATCH);
+	uint64_t tr;
+	uint32_t i;
+
+	_mm512_store_si512(lo, *tr_lo);
+	_mm512_store_si512(hi, *tr_hi);
+
+	do {
+		do {
+			i = rte_bsf32(msk);
+			msk &= msk - 1;
+
+			tr = (uint64_t)hi[i] << 32 | lo[i];
+			tr = acl_match_check(tr, slot + i, ctx, parms, flows,
+				resolve_priority_sse);
+			lo[i] = (uint32_t)tr;
+			hi[i] = (uint32_t)(tr >> 32);
+		} while (msk != 0);
+
+		*tr_lo = _mm512_load_si512(lo);
+		msk = _mm512_test_epi32_mask(*tr_lo, match_mask);
+	} while (msk != 0);
+
+	*tr_hi = _mm512_load_si512(hi);
+}
+
+/*
+ * Check for matches in 16 flows.
+ */
+static __rte_always_inline void
+acl_match_check_avx512x16(const struct rte_acl_ctx *ctx,
+	struct parms *parms, struct acl_flow_data *flows, uint32_t slot,
+	__m512i *tr_lo, __m512i *tr_hi)
+{
+	uint32_t msk;
+
+	/* test for match node */
+	msk = _mm512_test_epi32_mask(*tr_lo,
+		_mm512_set1_epi32(RTE_ACL_NODE_MATCH));
+	if (msk != 0)
+		acl_match_avx512x16(ctx, parms, flows, slot, msk,
+			tr_lo, tr_hi);
+}
+
+/*
+ * Execute trie traversal for nb_zmm * 16 flows in parallel.
+ */
+static __rte_always_inline int
+search_avx512x16xn(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories,
+	const uint32_t nb_zmm)
+{
+	uint32_t n, k;
+	struct acl_flow_data flows;
+	uint64_t index_array[MAX_SEARCHES_AVX512X64];
+	struct completion cmplt[MAX_SEARCHES_AVX512X64];
+	struct parms parms[MAX_SEARCHES_AVX512X64];
+	__m512i input[MAX_ZMM], tr_lo[MAX_ZMM], tr_hi[MAX_ZMM];
+
+	acl_set_flow(&flows, cmplt, nb_zmm * ZMM_FLOWS, data, results,
+		total_packets, categories, ctx->trans_table);
+
+	for (n = 0; n < nb_zmm * ZMM_FLOWS; n++) {
+		cmplt[n].count = 0;
+		index_array[n] = acl_start_next_trie(&flows, parms, n, ctx);
+	}
+
+	for (k = 0; k < nb_zmm; k++) {
+		acl_tr_hilo16(&index_array[k * ZMM_FLOWS], &tr_lo[k],
+			&tr_hi[k]);
+
+		/* Check for any matches. */
+		acl_match_check_avx512x16(ctx, parms, &flows, k * ZMM_FLOWS,
+			&tr_lo[k], &tr_hi[k]);
+	}
+
+	while (flows.started > 0) {
+
+		/* Gather 4 bytes of input data for each flow. */
+		for (k = 0; k < nb_zmm; k++)
+			input[k] = acl_next_input16(parms, k * ZMM_FLOWS);
+
+		for (n = 0; n < sizeof(uint32_t); n++)
+			for (k = 0; k < nb_zmm; k++)
+				input[k] = transition16(input[k], flows.trans,
+					&tr_lo[k], &tr_hi[k]);
+
+		/* Check for any matches. */
+		for (k = 0; k < nb_zmm; k++)
+			acl_match_check_avx512x16(ctx, parms, &flows,
+				k * ZMM_FLOWS, &tr_lo[k], &tr_hi[k]);
+	}
+
+	return 0;
+}
+
+static inline int
+search_avx512x16(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	return search_avx512x16xn(ctx, data, results, total_packets,
+		categories, MAX_SEARCHES_AVX512X16 / ZMM_FLOWS);
+}
+
+static inline int
+search_avx512x32(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	return search_avx512x16xn(ctx, data, results, total_packets,
+		categories, MAX_SEARCHES_AVX512X32 / ZMM_FLOWS);
+}
+
+static inline int
+search_avx512x64(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	return search_avx512x16xn(ctx, data, results, total_packets,
+		categories, MAX_SEARCHES_AVX512X64 / ZMM_FLOWS);
+}
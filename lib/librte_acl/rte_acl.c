@@ -55,6 +55,20 @@ rte_acl_classify_avx2(__rte_unused const struct rte_acl_ctx *ctx,
 	return -ENOTSUP;
 }
 
+/*
+ * If the compiler doesn't support AVX512 instructions or AVX512 is not
+ * enabled in the build, then the dummy one would be used instead.
+ */
+int __attribute__ ((weak))
+rte_acl_classify_avx512(__rte_unused const struct rte_acl_ctx *ctx,
+	__rte_unused const uint8_t **data,
+	__rte_unused uint32_t *results,
+	__rte_unused uint32_t num,
+	__rte_unused uint32_t categories)
+{
+	return -ENOTSUP;
+}
+
 int __attribute__ ((weak))
 rte_acl_classify_sse(__rte_unused const struct rte_acl_ctx *ctx,
 	__rte_unused const uint8_t **data,
@@ -92,6 +106,7 @@ static const rte_acl_classify_t classify_fns[] = {
 	[RTE_ACL_CLASSIFY_AVX2] = rte_acl_classify_avx2,
 	[RTE_ACL_CLASSIFY_NEON] = rte_acl_classify_neon,
 	[RTE_ACL_CLASSIFY_ALTIVEC] = rte_acl_classify_altivec,
+	[RTE_ACL_CLASSIFY_AVX512] = rte_acl_classify_avx512,
 };
 
 /* by default, use always available scalar code path. */
@@ -104,6 +119,12 @@ rte_acl_set_default_classify(enum rte_acl_classify_alg alg)
 	rte_acl_default_classify = alg;
 }
 
+enum rte_acl_classify_alg
+acl_get_default_classify(void)
+{
+	return rte_acl_default_classify;
+}
+
 extern int
 rte_acl_set_ctx_classify(struct rte_acl_ctx *ctx, enum rte_acl_classify_alg alg)
 {
@@ -114,11 +135,39 @@ rte_acl_set_ctx_classify(struct rte_acl_ctx *ctx, enum rte_acl_classify_alg alg)
 	return 0;
 }
 
+int
+rte_acl_set_build_threads(struct rte_acl_ctx *ctx, uint32_t num,
+	const rte_cpuset_t *cpuset)
+{
+	if (ctx == NULL || num > RTE_ACL_MAX_TRIES)
+		return -EINVAL;
+
+	ctx->build_threads = num;
+	if (cpuset != NULL)
+		ctx->build_cpuset = *cpuset;
+	else
+		CPU_ZERO(&ctx->build_cpuset);
+	return 0;
+}
+
+int
+rte_acl_build_stats_get(const struct rte_acl_ctx *ctx,
+	struct rte_acl_build_stats *stats)
+{
+	if (ctx == NULL || stats == NULL)
+		return -EINVAL;
+
+	*stats = ctx->stats;
+	return 0;
+}
+
 /*
  * Select highest available classify method as default one.
  * Note that CLASSIFY_AVX2 should be set as a default only
  * if both conditions are met:
  * at build time compiler supports AVX2 and target cpu supports AVX2.
+ * The same goes for CLASSIFY_AVX512, which also has to be enabled
+ * in the build and needs both AVX512F and AVX512BW.
  */
 RTE_INIT(rte_acl_init)
 {
@@ -132,6 +181,12 @@ RTE_INIT(rte_acl_init)
 #elif defined(RTE_ARCH_PPC_64)
 	alg = RTE_ACL_CLASSIFY_ALTIVEC;
 #else
+#ifdef CC_AVX512_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW))
+		alg = RTE_ACL_CLASSIFY_AVX512;
+	else
+#endif
 #ifdef CC_AVX2_SUPPORT
 	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
 		alg = RTE_ACL_CLASSIFY_AVX2;
@@ -306,7 +361,7 @@ acl_add_rules(struct rte_acl_ctx *ctx, const void *rules, uint32_t num)
 	return 0;
 }
 
-static int
+int
 acl_check_rule(const struct rte_acl_rule_data *rd)
 {
 	if ((RTE_LEN2MASK(RTE_ACL_MAX_CATEGORIES, typeof(rd->category_mask)) &
@@ -41,6 +41,7 @@
  */
 
 #include <rte_acl_osdep.h>
+#include <rte_lcore.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -53,6 +54,9 @@ extern "C" {
 #define RTE_ACL_MAX_LEVELS 64
 #define RTE_ACL_MAX_FIELDS 64
 
+/** MAX number of tries per one ACL context.*/
+#define RTE_ACL_MAX_TRIES	8
+
 union rte_acl_field_types {
 	uint8_t  u8;
 	uint16_t u16;
@@ -249,6 +253,81 @@ rte_acl_reset_rules(struct rte_acl_ctx *ctx);
 int
 rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg);
 
+/**
+ * Set the number of threads rte_acl_build() runs on for the given context.
+ * When the rules do not fit in one trie, the build of each trie is done
+ * twice: once to find where to split the rule set, and once over the
+ * rules kept. With more than one thread, the second builds run on worker
+ * threads, while the calling thread goes on with the next tries.
+ * The built context is the same, whatever the number of threads.
+ *
+ * @param ctx
+ *   ACL context to set the number of build threads for.
+ * @param num
+ *   Number of threads, the calling one included, up to RTE_ACL_MAX_TRIES.
+ *   Zero or one builds on the calling thread only, which is the default.
+ * @param cpuset
+ *   CPUs the worker threads run on. If NULL, they inherit the affinity
+ *   of the calling thread, which is a single CPU on an EAL lcore.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - Zero if operation completed successfully.
+ */
+int
+rte_acl_set_build_threads(struct rte_acl_ctx *ctx, uint32_t num,
+	const rte_cpuset_t *cpuset);
+
+/**
+ * Statistics of the last build of an ACL context, to tune its max_size
+ * and its number of build threads.
+ */
+struct rte_acl_build_stats {
+	uint64_t build_cycles;
+	/**< TSC cycles spent in rte_acl_build(), all attempts included. */
+	uint64_t trie_cycles;
+	/**< TSC cycles spent building the tries, in the last attempt. */
+	uint64_t gen_cycles;
+	/**< TSC cycles spent generating the run-time structures. */
+	size_t tmp_mem;
+	/**< Temporary memory of the last attempt, all threads included. */
+	size_t rt_mem;
+	/**< Memory needed by the run-time structures. */
+	uint32_t num_attempts;
+	/**< Number of builds made to fit in max_size. */
+	uint32_t node_max;
+	/**< Node limit to split the rule set at, in the last attempt. */
+	uint32_t num_workers;
+	/**< Number of tries built again on worker threads. */
+	uint32_t num_nodes;
+	/**< Number of nodes in the tries, before their conversion. */
+	uint32_t dfa_nodes;    /**< Number of run-time DFA nodes. */
+	uint32_t quad_nodes;   /**< Number of run-time QUAD nodes. */
+	uint32_t single_nodes; /**< Number of run-time SINGLE nodes. */
+	uint32_t match_nodes;  /**< Number of run-time MATCH nodes. */
+	uint32_t num_tries;    /**< Number of tries. */
+	uint32_t trie_rules[RTE_ACL_MAX_TRIES];
+	/**< Number of rules in each trie. */
+	uint32_t trie_nodes[RTE_ACL_MAX_TRIES];
+	/**< Number of run-time nodes in each trie. */
+};
+
+/**
+ * Get the statistics of the last build of an ACL context.
+ * They are also filled when that build failed, for instance
+ * with -ERANGE when the run-time structures exceed max_size.
+ *
+ * @param ctx
+ *   ACL context to get the build statistics of.
+ * @param stats
+ *   Structure to fill.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - Zero if operation completed successfully.
+ */
+int
+rte_acl_build_stats_get(const struct rte_acl_ctx *ctx,
+	struct rte_acl_build_stats *stats);
+
 /**
  * Delete all rules from the ACL context and
  * destroy all internal run-time structures.
@@ -270,6 +349,7 @@ enum rte_acl_classify_alg {
 	RTE_ACL_CLASSIFY_AVX2 = 3,    /**< requires AVX2 support. */
 	RTE_ACL_CLASSIFY_NEON = 4,    /**< requires NEON support. */
 	RTE_ACL_CLASSIFY_ALTIVEC = 5,    /**< requires ALTIVEC support. */
+	RTE_ACL_CLASSIFY_AVX512 = 6,  /**< requires AVX512F and AVX512BW. */
 	RTE_ACL_CLASSIFY_NUM          /* should always be the last one. */
 };
 
@@ -380,6 +460,178 @@ rte_acl_dump(const struct rte_acl_ctx *ctx);
 void
 rte_acl_list_dump(void);
 
+/*
+ * Incremental update mode.
+ *
+ * The rules of an incremental context are spread over partitions of a
+ * bounded number of rules, each one built into its own sub-trie.
+ * Adding or deleting rules only marks the partitions they belong to,
+ * and rte_acl_inc_commit() rebuilds those partitions alone, so the cost
+ * of a change depends on the partition size, not on the number of rules
+ * in the context. Classification runs over all the built partitions and
+ * returns, for each category, the match of highest priority among them.
+ */
+
+/** Maximum number of rules in a partition, when not specified. */
+#define	RTE_ACL_INC_DEFAULT_PART_RULES	4096
+
+/** Incremental ACL context, opaque. */
+struct rte_acl_inc_ctx;
+
+/**
+ * Parameters used when creating an incremental ACL context.
+ */
+struct rte_acl_inc_param {
+	const char *name;         /**< Name of the incremental context. */
+	int         socket_id;    /**< Socket ID to allocate memory for. */
+	uint32_t    rule_size;    /**< Size of each rule. */
+	uint32_t    max_rule_num; /**< Maximum number of rules. */
+	uint32_t    part_rule_num;
+	/**< Maximum number of rules in a partition, 0 for the default. */
+};
+
+/**
+ * Create a new incremental ACL context.
+ *
+ * @param param
+ *   Parameters used to create and initialise the context.
+ * @param cfg
+ *   Build configuration, used for every partition. It is copied, the
+ *   memory it points to can be released after the call.
+ * @return
+ *   Pointer to the context, or NULL with rte_errno set:
+ *   - EINVAL - invalid parameter passed to function
+ *   - ENOMEM - can't allocate memory
+ */
+struct rte_acl_inc_ctx *
+rte_acl_inc_create(const struct rte_acl_inc_param *param,
+	const struct rte_acl_config *cfg);
+
+/**
+ * De-allocate all memory used by an incremental ACL context.
+ *
+ * @param ctx
+ *   Incremental ACL context to free.
+ */
+void
+rte_acl_inc_free(struct rte_acl_inc_ctx *ctx);
+
+/**
+ * Add rules to an incremental ACL context. Each rule goes to the first
+ * partition that has room for it. The rules are classified on only after
+ * the next rte_acl_inc_commit().
+ *
+ * @param ctx
+ *   Incremental ACL context to add rules to.
+ * @param rules
+ *   Array of rules to add to the context, rule_size bytes each.
+ *   The userdata of a rule must not be zero, it is what identifies the
+ *   rule for rte_acl_inc_del_rules().
+ * @param num
+ *   Number of elements in the rules array.
+ * @return
+ *   - -ENOMEM if there is no space in the context for the new rules.
+ *   - -EINVAL if the parameters are invalid.
+ *   - Zero if operation completed successfully.
+ */
+int
+rte_acl_inc_add_rules(struct rte_acl_inc_ctx *ctx,
+	const struct rte_acl_rule *rules, uint32_t num);
+
+/**
+ * Delete rules from an incremental ACL context. The rules are still
+ * classified on until the next rte_acl_inc_commit().
+ *
+ * @param ctx
+ *   Incremental ACL context to delete rules from.
+ * @param userdata
+ *   Array of the userdata of the rules to delete. All the rules with one
+ *   of these userdata values are deleted.
+ * @param num
+ *   Number of elements in the userdata array.
+ * @return
+ *   The number of deleted rules, or a negative error code:
+ *   - -EINVAL if the parameters are invalid.
+ *   - -ENOMEM if there is not enough memory for the lookup.
+ */
+int
+rte_acl_inc_del_rules(struct rte_acl_inc_ctx *ctx, const uint32_t *userdata,
+	uint32_t num);
+
+/**
+ * Rebuild the partitions changed since the last commit and make them
+ * visible to the classification.
+ * Each partition is built aside and replaces the previous one with a
+ * single pointer store, so lookups running concurrently with a commit
+ * see either the old or the new version of every partition. The replaced
+ * versions are freed by the next commit: by then, no lookup started
+ * before this commit may still be running.
+ * Commits are not thread safe against each other or against the other
+ * update functions.
+ *
+ * @param ctx
+ *   Incremental ACL context to commit.
+ * @return
+ *   - -ENOMEM if there is not enough memory to build a partition.
+ *   - -ERANGE if a partition does not fit in the build max_size.
+ *   - -EINVAL if the parameters are invalid.
+ *   - Zero if operation completed successfully.
+ *   On error, the partitions that could not be built keep their previous
+ *   version and are built again by the next commit.
+ */
+int
+rte_acl_inc_commit(struct rte_acl_inc_ctx *ctx);
+
+/**
+ * Perform search for a matching ACL rule for each input data buffer,
+ * over all the committed partitions of an incremental context.
+ * The semantics of the parameters and of the results are the ones of
+ * rte_acl_classify(), rules of equal priority in different partitions
+ * are resolved in an unspecified order.
+ *
+ * @param ctx
+ *   Incremental ACL context to search with.
+ * @param data
+ *   Array of pointers to input data buffers to perform search.
+ * @param results
+ *   Array of search results, *categories* results per each input data buffer.
+ * @param num
+ *   Number of elements in the input data buffers array.
+ * @param categories
+ *   Number of maximum possible matches for each input buffer.
+ * @return
+ *   zero on successful completion.
+ *   -EINVAL for incorrect arguments.
+ */
+int
+rte_acl_inc_classify(const struct rte_acl_inc_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories);
+
+/**
+ * Override the classify algorithm used for the partitions of an
+ * incremental ACL context, see rte_acl_set_ctx_classify().
+ *
+ * @param ctx
+ *   Incremental ACL context to change classify function for.
+ * @param alg
+ *   New classify algorithm for the context.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - Zero if operation completed successfully.
+ */
+int
+rte_acl_inc_set_classify(struct rte_acl_inc_ctx *ctx,
+	enum rte_acl_classify_alg alg);
+
+/**
+ * Dump an incremental ACL context and its partitions to the console.
+ *
+ * @param ctx
+ *   Incremental ACL context to dump.
+ */
+void
+rte_acl_inc_dump(const struct rte_acl_inc_ctx *ctx);
+
 #ifdef __cplusplus
 }
 #endif
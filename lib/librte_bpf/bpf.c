@@ -0,0 +1,62 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+#include <sys/mman.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+
+#include "bpf_impl.h"
+
+int rte_bpf_logtype;
+
+void
+rte_bpf_destroy(struct rte_bpf *bpf)
+{
+	if (bpf == NULL)
+		return;
+
+	if (bpf->jit.func != NULL)
+		munmap(bpf->jit.func, bpf->jit.sz);
+	munmap(bpf, bpf->sz);
+}
+
+int
+rte_bpf_get_jit(const struct rte_bpf *bpf, struct rte_bpf_jit *jit)
+{
+	if (bpf == NULL || jit == NULL)
+		return -EINVAL;
+
+	*jit = bpf->jit;
+	return 0;
+}
+
+int
+bpf_jit(struct rte_bpf *bpf)
+{
+	int rc;
+
+#ifdef RTE_ARCH_X86_64
+	rc = bpf_jit_x86(bpf);
+#else
+	RTE_SET_USED(bpf);
+	rc = -ENOTSUP;
+#endif
+
+	if (rc != 0)
+		RTE_BPF_LOG(WARNING, "%s(%p) failed, error code: %d;\n",
+			__func__, bpf, rc);
+	return rc;
+}
+
+RTE_INIT(rte_bpf_init_log);
+
+static void
+rte_bpf_init_log(void)
+{
+	rte_bpf_logtype = rte_log_register("librte.bpf");
+	if (rte_bpf_logtype >= 0)
+		rte_log_set_level(rte_bpf_logtype, RTE_LOG_INFO);
+}
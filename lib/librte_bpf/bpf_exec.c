@@ -0,0 +1,455 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_atomic.h>
+#include <rte_byteorder.h>
+
+#include "bpf_impl.h"
+
+#define BPF_ALU_REG(reg, ins, type, op) \
+	((reg)[(ins)->dst_reg] = \
+		(type)(reg)[(ins)->dst_reg] op (type)(reg)[(ins)->src_reg])
+
+/* immediates are sign extended to 64 bits first */
+#define BPF_ALU_IMM(reg, ins, type, op) \
+	((reg)[(ins)->dst_reg] = \
+		(type)(reg)[(ins)->dst_reg] op (type)(int64_t)(ins)->imm)
+
+#define BPF_SHIFT_REG(reg, ins, type, op, mask) \
+	((reg)[(ins)->dst_reg] = (type)(reg)[(ins)->dst_reg] op \
+		((reg)[(ins)->src_reg] & (mask)))
+
+#define BPF_JMP_COND_REG(reg, ins, type, op) \
+	((type)(reg)[(ins)->dst_reg] op (type)(reg)[(ins)->src_reg])
+
+#define BPF_JMP_COND_IMM(reg, ins, type, op) \
+	((type)(reg)[(ins)->dst_reg] op (type)(ins)->imm)
+
+#define BPF_LD_REG(reg, ins, type) \
+	((reg)[(ins)->dst_reg] = \
+		*(type *)(uintptr_t)((reg)[(ins)->src_reg] + (ins)->off))
+
+#define BPF_ST_IMM(reg, ins, type) \
+	(*(type *)(uintptr_t)((reg)[(ins)->dst_reg] + (ins)->off) = \
+		(type)(ins)->imm)
+
+#define BPF_ST_REG(reg, ins, type) \
+	(*(type *)(uintptr_t)((reg)[(ins)->dst_reg] + (ins)->off) = \
+		(type)(reg)[(ins)->src_reg])
+
+static inline int
+bpf_div_zero(const struct rte_bpf *bpf, const struct ebpf_insn *ins,
+	uint64_t divisor)
+{
+	if (divisor != 0)
+		return 0;
+
+	RTE_BPF_LOG(ERR, "%s(%p): division by 0 at pc: %#zx;\n",
+		__func__, bpf, (uintptr_t)ins - (uintptr_t)bpf->prm.ins);
+	return 1;
+}
+
+static inline uint64_t
+bpf_byteswap(uint64_t v, const struct ebpf_insn *ins)
+{
+	if (BPF_SRC(ins->code) == EBPF_TO_BE) {
+		switch (ins->imm) {
+		case 16:
+			return rte_cpu_to_be_16((uint16_t)v);
+		case 32:
+			return rte_cpu_to_be_32((uint32_t)v);
+		default:
+			return rte_cpu_to_be_64(v);
+		}
+	}
+
+	switch (ins->imm) {
+	case 16:
+		return rte_cpu_to_le_16((uint16_t)v);
+	case 32:
+		return rte_cpu_to_le_32((uint32_t)v);
+	default:
+		return rte_cpu_to_le_64(v);
+	}
+}
+
+static inline uint64_t
+bpf_exec(const struct rte_bpf *bpf, uint64_t reg[EBPF_REG_NUM])
+{
+	const struct ebpf_insn *ins;
+	const struct rte_bpf_xsym *xs;
+
+	for (ins = bpf->prm.ins; ; ins++) {
+		switch (ins->code) {
+		/* 32-bit ALU, results are zero extended */
+		case (BPF_ALU | BPF_ADD | BPF_X):
+			BPF_ALU_REG(reg, ins, uint32_t, +);
+			break;
+		case (BPF_ALU | BPF_SUB | BPF_X):
+			BPF_ALU_REG(reg, ins, uint32_t, -);
+			break;
+		case (BPF_ALU | BPF_MUL | BPF_X):
+			BPF_ALU_REG(reg, ins, uint32_t, *);
+			break;
+		case (BPF_ALU | BPF_DIV | BPF_X):
+			if (bpf_div_zero(bpf, ins,
+					(uint32_t)reg[ins->src_reg]))
+				return 0;
+			BPF_ALU_REG(reg, ins, uint32_t, /);
+			break;
+		case (BPF_ALU | BPF_MOD | BPF_X):
+			if (bpf_div_zero(bpf, ins,
+					(uint32_t)reg[ins->src_reg]))
+				return 0;
+			BPF_ALU_REG(reg, ins, uint32_t, %);
+			break;
+		case (BPF_ALU | BPF_OR | BPF_X):
+			BPF_ALU_REG(reg, ins, uint32_t, |);
+			break;
+		case (BPF_ALU | BPF_AND | BPF_X):
+			BPF_ALU_REG(reg, ins, uint32_t, &);
+			break;
+		case (BPF_ALU | BPF_XOR | BPF_X):
+			BPF_ALU_REG(reg, ins, uint32_t, ^);
+			break;
+		case (BPF_ALU | BPF_LSH | BPF_X):
+			BPF_SHIFT_REG(reg, ins, uint32_t, <<, 31);
+			break;
+		case (BPF_ALU | BPF_RSH | BPF_X):
+			BPF_SHIFT_REG(reg, ins, uint32_t, >>, 31);
+			break;
+		case (BPF_ALU | EBPF_ARSH | BPF_X):
+			reg[ins->dst_reg] = (uint32_t)((int32_t)
+				reg[ins->dst_reg] >> (reg[ins->src_reg] & 31));
+			break;
+		case (BPF_ALU | EBPF_MOV | BPF_X):
+			reg[ins->dst_reg] = (uint32_t)reg[ins->src_reg];
+			break;
+		case (BPF_ALU | BPF_ADD | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint32_t, +);
+			break;
+		case (BPF_ALU | BPF_SUB | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint32_t, -);
+			break;
+		case (BPF_ALU | BPF_MUL | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint32_t, *);
+			break;
+		case (BPF_ALU | BPF_DIV | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint32_t, /);
+			break;
+		case (BPF_ALU | BPF_MOD | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint32_t, %);
+			break;
+		case (BPF_ALU | BPF_OR | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint32_t, |);
+			break;
+		case (BPF_ALU | BPF_AND | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint32_t, &);
+			break;
+		case (BPF_ALU | BPF_XOR | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint32_t, ^);
+			break;
+		case (BPF_ALU | BPF_LSH | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint32_t, <<);
+			break;
+		case (BPF_ALU | BPF_RSH | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint32_t, >>);
+			break;
+		case (BPF_ALU | EBPF_ARSH | BPF_K):
+			reg[ins->dst_reg] = (uint32_t)((int32_t)
+				reg[ins->dst_reg] >> ins->imm);
+			break;
+		case (BPF_ALU | EBPF_MOV | BPF_K):
+			reg[ins->dst_reg] = (uint32_t)ins->imm;
+			break;
+		case (BPF_ALU | BPF_NEG):
+			reg[ins->dst_reg] =
+				-(uint32_t)reg[ins->dst_reg];
+			break;
+		case (BPF_ALU | EBPF_END | EBPF_TO_BE):
+		case (BPF_ALU | EBPF_END | EBPF_TO_LE):
+			reg[ins->dst_reg] =
+				bpf_byteswap(reg[ins->dst_reg], ins);
+			break;
+		/* 64-bit ALU, immediates are sign extended */
+		case (EBPF_ALU64 | BPF_ADD | BPF_X):
+			BPF_ALU_REG(reg, ins, uint64_t, +);
+			break;
+		case (EBPF_ALU64 | BPF_SUB | BPF_X):
+			BPF_ALU_REG(reg, ins, uint64_t, -);
+			break;
+		case (EBPF_ALU64 | BPF_MUL | BPF_X):
+			BPF_ALU_REG(reg, ins, uint64_t, *);
+			break;
+		case (EBPF_ALU64 | BPF_DIV | BPF_X):
+			if (bpf_div_zero(bpf, ins, reg[ins->src_reg]))
+				return 0;
+			BPF_ALU_REG(reg, ins, uint64_t, /);
+			break;
+		case (EBPF_ALU64 | BPF_MOD | BPF_X):
+			if (bpf_div_zero(bpf, ins, reg[ins->src_reg]))
+				return 0;
+			BPF_ALU_REG(reg, ins, uint64_t, %);
+			break;
+		case (EBPF_ALU64 | BPF_OR | BPF_X):
+			BPF_ALU_REG(reg, ins, uint64_t, |);
+			break;
+		case (EBPF_ALU64 | BPF_AND | BPF_X):
+			BPF_ALU_REG(reg, ins, uint64_t, &);
+			break;
+		case (EBPF_ALU64 | BPF_XOR | BPF_X):
+			BPF_ALU_REG(reg, ins, uint64_t, ^);
+			break;
+		case (EBPF_ALU64 | BPF_LSH | BPF_X):
+			BPF_SHIFT_REG(reg, ins, uint64_t, <<, 63);
+			break;
+		case (EBPF_ALU64 | BPF_RSH | BPF_X):
+			BPF_SHIFT_REG(reg, ins, uint64_t, >>, 63);
+			break;
+		case (EBPF_ALU64 | EBPF_ARSH | BPF_X):
+			BPF_SHIFT_REG(reg, ins, int64_t, >>, 63);
+			break;
+		case (EBPF_ALU64 | EBPF_MOV | BPF_X):
+			reg[ins->dst_reg] = reg[ins->src_reg];
+			break;
+		case (EBPF_ALU64 | BPF_ADD | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint64_t, +);
+			break;
+		case (EBPF_ALU64 | BPF_SUB | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint64_t, -);
+			break;
+		case (EBPF_ALU64 | BPF_MUL | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint64_t, *);
+			break;
+		case (EBPF_ALU64 | BPF_DIV | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint64_t, /);
+			break;
+		case (EBPF_ALU64 | BPF_MOD | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint64_t, %);
+			break;
+		case (EBPF_ALU64 | BPF_OR | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint64_t, |);
+			break;
+		case (EBPF_ALU64 | BPF_AND | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint64_t, &);
+			break;
+		case (EBPF_ALU64 | BPF_XOR | BPF_K):
+			BPF_ALU_IMM(reg, ins, uint64_t, ^);
+			break;
+		case (EBPF_ALU64 | BPF_LSH | BPF_K):
+			reg[ins->dst_reg] <<= ins->imm;
+			break;
+		case (EBPF_ALU64 | BPF_RSH | BPF_K):
+			reg[ins->dst_reg] >>= ins->imm;
+			break;
+		case (EBPF_ALU64 | EBPF_ARSH | BPF_K):
+			reg[ins->dst_reg] =
+				(int64_t)reg[ins->dst_reg] >> ins->imm;
+			break;
+		case (EBPF_ALU64 | EBPF_MOV | BPF_K):
+			reg[ins->dst_reg] = (int64_t)ins->imm;
+			break;
+		case (EBPF_ALU64 | BPF_NEG):
+			reg[ins->dst_reg] = -reg[ins->dst_reg];
+			break;
+		/* 64-bit immediate load, over two instructions */
+		case (BPF_LD | BPF_IMM | EBPF_DW):
+			reg[ins->dst_reg] = (uint32_t)ins[0].imm |
+				(uint64_t)(uint32_t)ins[1].imm << 32;
+			ins++;
+			break;
+		/* memory loads */
+		case (BPF_LDX | BPF_MEM | BPF_B):
+			BPF_LD_REG(reg, ins, uint8_t);
+			break;
+		case (BPF_LDX | BPF_MEM | BPF_H):
+			BPF_LD_REG(reg, ins, uint16_t);
+			break;
+		case (BPF_LDX | BPF_MEM | BPF_W):
+			BPF_LD_REG(reg, ins, uint32_t);
+			break;
+		case (BPF_LDX | BPF_MEM | EBPF_DW):
+			BPF_LD_REG(reg, ins, uint64_t);
+			break;
+		/* memory stores */
+		case (BPF_ST | BPF_MEM | BPF_B):
+			BPF_ST_IMM(reg, ins, uint8_t);
+			break;
+		case (BPF_ST | BPF_MEM | BPF_H):
+			BPF_ST_IMM(reg, ins, uint16_t);
+			break;
+		case (BPF_ST | BPF_MEM | BPF_W):
+			BPF_ST_IMM(reg, ins, uint32_t);
+			break;
+		case (BPF_ST | BPF_MEM | EBPF_DW):
+			BPF_ST_IMM(reg, ins, int64_t);
+			break;
+		case (BPF_STX | BPF_MEM | BPF_B):
+			BPF_ST_REG(reg, ins, uint8_t);
+			break;
+		case (BPF_STX | BPF_MEM | BPF_H):
+			BPF_ST_REG(reg, ins, uint16_t);
+			break;
+		case (BPF_STX | BPF_MEM | BPF_W):
+			BPF_ST_REG(reg, ins, uint32_t);
+			break;
+		case (BPF_STX | BPF_MEM | EBPF_DW):
+			BPF_ST_REG(reg, ins, uint64_t);
+			break;
+		/* atomic add */
+		case (BPF_STX | EBPF_XADD | BPF_W):
+			rte_atomic32_add((rte_atomic32_t *)(uintptr_t)
+				(reg[ins->dst_reg] + ins->off),
+				reg[ins->src_reg]);
+			break;
+		case (BPF_STX | EBPF_XADD | EBPF_DW):
+			rte_atomic64_add((rte_atomic64_t *)(uintptr_t)
+				(reg[ins->dst_reg] + ins->off),
+				reg[ins->src_reg]);
+			break;
+		/* jumps */
+		case (BPF_JMP | BPF_JA):
+			ins += ins->off;
+			break;
+		case (BPF_JMP | BPF_JEQ | BPF_X):
+			if (BPF_JMP_COND_REG(reg, ins, uint64_t, ==))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JNE | BPF_X):
+			if (BPF_JMP_COND_REG(reg, ins, uint64_t, !=))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | BPF_JGT | BPF_X):
+			if (BPF_JMP_COND_REG(reg, ins, uint64_t, >))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JLT | BPF_X):
+			if (BPF_JMP_COND_REG(reg, ins, uint64_t, <))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | BPF_JGE | BPF_X):
+			if (BPF_JMP_COND_REG(reg, ins, uint64_t, >=))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JLE | BPF_X):
+			if (BPF_JMP_COND_REG(reg, ins, uint64_t, <=))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JSGT | BPF_X):
+			if (BPF_JMP_COND_REG(reg, ins, int64_t, >))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JSLT | BPF_X):
+			if (BPF_JMP_COND_REG(reg, ins, int64_t, <))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JSGE | BPF_X):
+			if (BPF_JMP_COND_REG(reg, ins, int64_t, >=))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JSLE | BPF_X):
+			if (BPF_JMP_COND_REG(reg, ins, int64_t, <=))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | BPF_JSET | BPF_X):
+			if (BPF_JMP_COND_REG(reg, ins, uint64_t, &))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | BPF_JEQ | BPF_K):
+			if (BPF_JMP_COND_IMM(reg, ins, int64_t, ==))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JNE | BPF_K):
+			if (BPF_JMP_COND_IMM(reg, ins, int64_t, !=))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | BPF_JGT | BPF_K):
+			if ((uint64_t)reg[ins->dst_reg] >
+					(uint64_t)(int64_t)ins->imm)
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JLT | BPF_K):
+			if ((uint64_t)reg[ins->dst_reg] <
+					(uint64_t)(int64_t)ins->imm)
+				ins += ins->off;
+			break;
+		case (BPF_JMP | BPF_JGE | BPF_K):
+			if ((uint64_t)reg[ins->dst_reg] >=
+					(uint64_t)(int64_t)ins->imm)
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JLE | BPF_K):
+			if ((uint64_t)reg[ins->dst_reg] <=
+					(uint64_t)(int64_t)ins->imm)
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JSGT | BPF_K):
+			if (BPF_JMP_COND_IMM(reg, ins, int64_t, >))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JSLT | BPF_K):
+			if (BPF_JMP_COND_IMM(reg, ins, int64_t, <))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JSGE | BPF_K):
+			if (BPF_JMP_COND_IMM(reg, ins, int64_t, >=))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | EBPF_JSLE | BPF_K):
+			if (BPF_JMP_COND_IMM(reg, ins, int64_t, <=))
+				ins += ins->off;
+			break;
+		case (BPF_JMP | BPF_JSET | BPF_K):
+			if (BPF_JMP_COND_IMM(reg, ins, int64_t, &))
+				ins += ins->off;
+			break;
+		/* external function call, the result lands in R0 */
+		case (BPF_JMP | EBPF_CALL):
+			xs = bpf->prm.xsym + ins->imm;
+			reg[EBPF_REG_0] = xs->func(reg[EBPF_REG_1],
+				reg[EBPF_REG_2], reg[EBPF_REG_3],
+				reg[EBPF_REG_4], reg[EBPF_REG_5]);
+			break;
+		case (BPF_JMP | EBPF_EXIT):
+			return reg[EBPF_REG_0];
+		default:
+			/* rejected by the verifier */
+			RTE_BPF_LOG(ERR, "%s(%p): invalid opcode %#x at pc: "
+				"%#zx;\n", __func__, bpf, ins->code,
+				(uintptr_t)ins - (uintptr_t)bpf->prm.ins);
+			return 0;
+		}
+	}
+}
+
+uint32_t
+rte_bpf_exec_burst(const struct rte_bpf *bpf, void *ctx[], uint64_t rc[],
+	uint32_t num)
+{
+	uint32_t i, n;
+	uint64_t reg[EBPF_REG_NUM];
+	uint64_t stack[MAX_BPF_STACK_SIZE / sizeof(uint64_t)];
+
+	for (n = 0, i = 0; i != num; i++) {
+		reg[EBPF_REG_1] = (uintptr_t)ctx[i];
+		reg[EBPF_REG_10] = (uintptr_t)(stack + RTE_DIM(stack));
+
+		rc[i] = bpf_exec(bpf, reg);
+		n += (rc[i] != 0);
+	}
+
+	return n;
+}
+
+uint64_t
+rte_bpf_exec(const struct rte_bpf *bpf, void *ctx)
+{
+	uint64_t rc;
+
+	rte_bpf_exec_burst(bpf, &ctx, &rc, 1);
+	return rc;
+}
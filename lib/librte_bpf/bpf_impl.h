@@ -0,0 +1,36 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef _BPF_IMPL_H_
+#define _BPF_IMPL_H_
+
+#include <rte_log.h>
+
+#include "rte_bpf.h"
+
+/* stack available to every program, addressed below EBPF_REG_10 */
+#define MAX_BPF_STACK_SIZE	0x200
+
+struct rte_bpf {
+	struct rte_bpf_prm prm;
+	struct rte_bpf_jit jit;
+	size_t sz;	/* size of the mapping holding the program */
+};
+
+extern int rte_bpf_logtype;
+
+#define RTE_BPF_LOG(lvl, fmt, args...) \
+	rte_log(RTE_LOG_## lvl, rte_bpf_logtype, fmt, ##args)
+
+/* check the program, returns 0 or a negative errno */
+int bpf_validate(struct rte_bpf *bpf);
+
+/* generate native code, returns 0 or a negative errno */
+int bpf_jit(struct rte_bpf *bpf);
+
+#ifdef RTE_ARCH_X86_64
+int bpf_jit_x86(struct rte_bpf *bpf);
+#endif
+
+#endif /* _BPF_IMPL_H_ */
@@ -0,0 +1,704 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+
+#include "bpf_impl.h"
+
+/* x86-64 general purpose registers */
+enum {
+	RAX,
+	RCX,
+	RDX,
+	RBX,
+	RSP,
+	RBP,
+	RSI,
+	RDI,
+	R8,
+	R9,
+	R10,
+	R11,
+	R12,
+	R13,
+	R14,
+	R15,
+};
+
+/*
+ * eBPF arguments R1-R5 map to the SysV argument registers, so external
+ * calls need no shuffling, and R6-R10 to callee-saved registers.
+ */
+static const uint8_t ebpf2x86[EBPF_REG_NUM] = {
+	[EBPF_REG_0] = RAX,
+	[EBPF_REG_1] = RDI,
+	[EBPF_REG_2] = RSI,
+	[EBPF_REG_3] = RDX,
+	[EBPF_REG_4] = RCX,
+	[EBPF_REG_5] = R8,
+	[EBPF_REG_6] = RBX,
+	[EBPF_REG_7] = R13,
+	[EBPF_REG_8] = R14,
+	[EBPF_REG_9] = R15,
+	[EBPF_REG_10] = RBP,
+};
+
+/* scratch registers, never holding an eBPF register */
+#define TMP_REG_0	R11
+#define TMP_REG_1	R10
+#define TMP_REG_2	R9
+
+/* ModRM mod field */
+#define MOD_DIRECT	3
+#define MOD_DISP32	2
+
+/* opcode extensions of the 0x81, 0xc1, 0xd3 and 0xf7 groups */
+#define GRP1_ADD	0
+#define GRP1_OR		1
+#define GRP1_AND	4
+#define GRP1_SUB	5
+#define GRP1_XOR	6
+#define GRP1_CMP	7
+#define GRP2_ROL	0
+#define GRP2_SHL	4
+#define GRP2_SHR	5
+#define GRP2_SAR	7
+#define GRP3_TEST	0
+#define GRP3_NEG	3
+#define GRP3_DIV	6
+
+/* condition codes of the 0x0f 0x8x jumps */
+#define JCC_JB		0x82
+#define JCC_JAE		0x83
+#define JCC_JE		0x84
+#define JCC_JNE		0x85
+#define JCC_JBE		0x86
+#define JCC_JA		0x87
+#define JCC_JL		0x8c
+#define JCC_JGE		0x8d
+#define JCC_JLE		0x8e
+#define JCC_JG		0x8f
+
+struct bpf_jit_state {
+	uint8_t *ins;		/* code buffer, NULL while sizing */
+	size_t sz;		/* bytes emitted so far */
+	uint32_t *off;		/* code offset of each eBPF instruction */
+	size_t exit0_ofs;	/* code returning 0 */
+	size_t exit_ofs;	/* epilogue */
+};
+
+static void
+emit_bytes(struct bpf_jit_state *st, const uint8_t *b, uint32_t n)
+{
+	if (st->ins != NULL)
+		memcpy(st->ins + st->sz, b, n);
+	st->sz += n;
+}
+
+static void
+emit_byte(struct bpf_jit_state *st, uint8_t b)
+{
+	emit_bytes(st, &b, 1);
+}
+
+static void
+emit_imm(struct bpf_jit_state *st, uint64_t v, uint32_t n)
+{
+	uint8_t b[sizeof(v)];
+	uint32_t i;
+
+	for (i = 0; i != n; i++)
+		b[i] = v >> (i * 8);
+	emit_bytes(st, b, n);
+}
+
+/* REX prefix, mandatory for 64-bit operands and R8-R15 */
+static void
+emit_rex(struct bpf_jit_state *st, int w, uint32_t reg, uint32_t rm,
+	int force)
+{
+	uint8_t rex;
+
+	rex = 0x40 | (w ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) |
+		((rm & 8) ? 0x01 : 0);
+	if (rex != 0x40 || force)
+		emit_byte(st, rex);
+}
+
+static void
+emit_modrm(struct bpf_jit_state *st, uint32_t mod, uint32_t reg,
+	uint32_t rm)
+{
+	emit_byte(st, (mod << 6) | ((reg & 7) << 3) | (rm & 7));
+}
+
+/* [base + disp32] memory operand */
+static void
+emit_mem(struct bpf_jit_state *st, uint32_t reg, uint32_t base,
+	int32_t disp)
+{
+	emit_modrm(st, MOD_DISP32, reg, base);
+	if ((base & 7) == RSP)
+		emit_byte(st, 0x24);	/* SIB: no index */
+	emit_imm(st, (uint32_t)disp, sizeof(uint32_t));
+}
+
+/* op dst, src with op one of the 0x01-style register forms */
+static void
+emit_alu_reg(struct bpf_jit_state *st, int w, uint8_t op, uint32_t src,
+	uint32_t dst)
+{
+	emit_rex(st, w, src, dst, 0);
+	emit_byte(st, op);
+	emit_modrm(st, MOD_DIRECT, src, dst);
+}
+
+static void
+emit_mov_reg(struct bpf_jit_state *st, int w, uint32_t src, uint32_t dst)
+{
+	emit_alu_reg(st, w, 0x89, src, dst);
+}
+
+/* group 1 operation with an immediate, sign extended for 64 bits */
+static void
+emit_alu_imm(struct bpf_jit_state *st, int w, uint32_t ext, uint32_t dst,
+	int32_t imm)
+{
+	emit_rex(st, w, 0, dst, 0);
+	emit_byte(st, 0x81);
+	emit_modrm(st, MOD_DIRECT, ext, dst);
+	emit_imm(st, (uint32_t)imm, sizeof(uint32_t));
+}
+
+static void
+emit_mov_imm(struct bpf_jit_state *st, int w, uint32_t dst, int32_t imm)
+{
+	if (w) {
+		/* sign extended */
+		emit_rex(st, 1, 0, dst, 0);
+		emit_byte(st, 0xc7);
+		emit_modrm(st, MOD_DIRECT, 0, dst);
+	} else {
+		/* zero extended */
+		emit_rex(st, 0, 0, dst, 0);
+		emit_byte(st, 0xb8 + (dst & 7));
+	}
+	emit_imm(st, (uint32_t)imm, sizeof(uint32_t));
+}
+
+static void
+emit_movabs(struct bpf_jit_state *st, uint32_t dst, uint64_t imm)
+{
+	emit_rex(st, 1, 0, dst, 0);
+	emit_byte(st, 0xb8 + (dst & 7));
+	emit_imm(st, imm, sizeof(imm));
+}
+
+static void
+emit_jcc(struct bpf_jit_state *st, uint8_t cc, size_t target)
+{
+	emit_byte(st, 0x0f);
+	emit_byte(st, cc);
+	emit_imm(st, (uint32_t)(target - (st->sz + sizeof(uint32_t))),
+		sizeof(uint32_t));
+}
+
+static void
+emit_jmp(struct bpf_jit_state *st, size_t target)
+{
+	emit_byte(st, 0xe9);
+	emit_imm(st, (uint32_t)(target - (st->sz + sizeof(uint32_t))),
+		sizeof(uint32_t));
+}
+
+/* shift dst by the count in src, through CL */
+static void
+emit_shift_reg(struct bpf_jit_state *st, int w, uint32_t ext, uint32_t src,
+	uint32_t dst)
+{
+	uint32_t r;
+
+	emit_mov_reg(st, 1, RCX, TMP_REG_1);
+	emit_mov_reg(st, 1, src, RCX);
+
+	/* when dst is RCX, shift the saved copy, restored below */
+	r = (dst == RCX) ? TMP_REG_1 : dst;
+	emit_rex(st, w, 0, r, 0);
+	emit_byte(st, 0xd3);
+	emit_modrm(st, MOD_DIRECT, ext, r);
+
+	emit_mov_reg(st, 1, TMP_REG_1, RCX);
+}
+
+static void
+emit_shift_imm(struct bpf_jit_state *st, int w, uint32_t ext, uint32_t dst,
+	int32_t imm)
+{
+	emit_rex(st, w, 0, dst, 0);
+	emit_byte(st, 0xc1);
+	emit_modrm(st, MOD_DIRECT, ext, dst);
+	emit_byte(st, imm);
+}
+
+/*
+ * DIV leaves the quotient in RAX and the remainder in RDX, both saved in
+ * scratch registers around it. A zero divisor returns 0 from the program.
+ */
+static void
+emit_div(struct bpf_jit_state *st, const struct ebpf_insn *ins, int w,
+	uint32_t src, uint32_t dst)
+{
+	if (BPF_SRC(ins->code) == BPF_X) {
+		emit_mov_reg(st, w, src, TMP_REG_0);
+		emit_alu_reg(st, w, 0x85, TMP_REG_0, TMP_REG_0);
+		emit_jcc(st, JCC_JE, st->exit0_ofs);
+	} else {
+		emit_mov_imm(st, w, TMP_REG_0, ins->imm);
+	}
+
+	emit_mov_reg(st, 1, RAX, TMP_REG_1);
+	emit_mov_reg(st, 1, RDX, TMP_REG_2);
+	emit_mov_reg(st, w, dst, RAX);
+	emit_alu_reg(st, 0, 0x31, RDX, RDX);
+
+	emit_rex(st, w, 0, TMP_REG_0, 0);
+	emit_byte(st, 0xf7);
+	emit_modrm(st, MOD_DIRECT, GRP3_DIV, TMP_REG_0);
+
+	emit_mov_reg(st, 1, (BPF_OP(ins->code) == BPF_DIV) ? RAX : RDX,
+		TMP_REG_0);
+	emit_mov_reg(st, 1, TMP_REG_1, RAX);
+	emit_mov_reg(st, 1, TMP_REG_2, RDX);
+	emit_mov_reg(st, 1, TMP_REG_0, dst);
+}
+
+static void
+emit_movzx16(struct bpf_jit_state *st, uint32_t dst)
+{
+	emit_rex(st, 0, dst, dst, 0);
+	emit_byte(st, 0x0f);
+	emit_byte(st, 0xb7);
+	emit_modrm(st, MOD_DIRECT, dst, dst);
+}
+
+static void
+emit_end(struct bpf_jit_state *st, const struct ebpf_insn *ins,
+	uint32_t dst)
+{
+	int swap;
+
+#if RTE_BYTE_ORDER == RTE_LITTLE_ENDIAN
+	swap = (BPF_SRC(ins->code) == EBPF_TO_BE);
+#else
+	swap = (BPF_SRC(ins->code) == EBPF_TO_LE);
+#endif
+
+	switch (ins->imm) {
+	case 16:
+		if (swap) {
+			/* rol dst16, 8 */
+			emit_byte(st, 0x66);
+			emit_shift_imm(st, 0, GRP2_ROL, dst, 8);
+		}
+		emit_movzx16(st, dst);
+		break;
+	case 32:
+		if (swap) {
+			emit_rex(st, 0, 0, dst, 0);
+			emit_byte(st, 0x0f);
+			emit_byte(st, 0xc8 + (dst & 7));
+		} else {
+			emit_mov_reg(st, 0, dst, dst);
+		}
+		break;
+	default:
+		if (swap) {
+			emit_rex(st, 1, 0, dst, 0);
+			emit_byte(st, 0x0f);
+			emit_byte(st, 0xc8 + (dst & 7));
+		}
+		break;
+	}
+}
+
+static void
+emit_ld(struct bpf_jit_state *st, uint32_t size, uint32_t src, uint32_t dst,
+	int16_t off)
+{
+	switch (size) {
+	case BPF_B:
+	case BPF_H:
+		/* movzx, zero extended to 64 bits */
+		emit_rex(st, 0, dst, src, 0);
+		emit_byte(st, 0x0f);
+		emit_byte(st, (size == BPF_B) ? 0xb6 : 0xb7);
+		break;
+	case BPF_W:
+		emit_rex(st, 0, dst, src, 0);
+		emit_byte(st, 0x8b);
+		break;
+	default:
+		emit_rex(st, 1, dst, src, 0);
+		emit_byte(st, 0x8b);
+		break;
+	}
+	emit_mem(st, dst, src, off);
+}
+
+static void
+emit_st_reg(struct bpf_jit_state *st, uint32_t size, uint32_t src,
+	uint32_t dst, int16_t off)
+{
+	if (size == BPF_H)
+		emit_byte(st, 0x66);
+	/* byte stores of SIL/DIL need a REX prefix */
+	emit_rex(st, size == EBPF_DW, src, dst, size == BPF_B);
+	emit_byte(st, (size == BPF_B) ? 0x88 : 0x89);
+	emit_mem(st, src, dst, off);
+}
+
+static void
+emit_st_imm(struct bpf_jit_state *st, uint32_t size, uint32_t dst,
+	int16_t off, int32_t imm)
+{
+	if (size == BPF_H)
+		emit_byte(st, 0x66);
+	emit_rex(st, size == EBPF_DW, 0, dst, 0);
+	emit_byte(st, (size == BPF_B) ? 0xc6 : 0xc7);
+	emit_mem(st, 0, dst, off);
+
+	switch (size) {
+	case BPF_B:
+		emit_imm(st, (uint32_t)imm, sizeof(uint8_t));
+		break;
+	case BPF_H:
+		emit_imm(st, (uint32_t)imm, sizeof(uint16_t));
+		break;
+	default:
+		emit_imm(st, (uint32_t)imm, sizeof(uint32_t));
+		break;
+	}
+}
+
+/* lock add [dst + off], src */
+static void
+emit_xadd(struct bpf_jit_state *st, uint32_t size, uint32_t src,
+	uint32_t dst, int16_t off)
+{
+	emit_byte(st, 0xf0);
+	emit_rex(st, size == EBPF_DW, src, dst, 0);
+	emit_byte(st, 0x01);
+	emit_mem(st, src, dst, off);
+}
+
+static uint8_t
+jcc_code(uint8_t op)
+{
+	switch (op) {
+	case BPF_JEQ:
+		return JCC_JE;
+	case EBPF_JNE:
+	case BPF_JSET:
+		return JCC_JNE;
+	case BPF_JGT:
+		return JCC_JA;
+	case EBPF_JLT:
+		return JCC_JB;
+	case BPF_JGE:
+		return JCC_JAE;
+	case EBPF_JLE:
+		return JCC_JBE;
+	case EBPF_JSGT:
+		return JCC_JG;
+	case EBPF_JSLT:
+		return JCC_JL;
+	case EBPF_JSGE:
+		return JCC_JGE;
+	default:
+		return JCC_JLE;
+	}
+}
+
+static void
+emit_jcond(struct bpf_jit_state *st, const struct ebpf_insn *ins,
+	uint32_t src, uint32_t dst, size_t target)
+{
+	uint8_t op = BPF_OP(ins->code);
+
+	if (BPF_SRC(ins->code) == BPF_X) {
+		emit_alu_reg(st, 1, (op == BPF_JSET) ? 0x85 : 0x39, src, dst);
+	} else if (op == BPF_JSET) {
+		emit_rex(st, 1, 0, dst, 0);
+		emit_byte(st, 0xf7);
+		emit_modrm(st, MOD_DIRECT, GRP3_TEST, dst);
+		emit_imm(st, (uint32_t)ins->imm, sizeof(uint32_t));
+	} else {
+		emit_alu_imm(st, 1, GRP1_CMP, dst, ins->imm);
+	}
+
+	emit_jcc(st, jcc_code(op), target);
+}
+
+static void
+emit_call(struct bpf_jit_state *st, uintptr_t func)
+{
+	emit_movabs(st, TMP_REG_0, func);
+	emit_rex(st, 0, 0, TMP_REG_0, 0);
+	emit_byte(st, 0xff);
+	emit_modrm(st, MOD_DIRECT, 2, TMP_REG_0);
+}
+
+/*
+ * Save the callee-saved registers used for R6-R10 and reserve the eBPF
+ * stack below R10. Five pushes keep RSP 16-byte aligned for calls.
+ */
+static void
+emit_prologue(struct bpf_jit_state *st)
+{
+	static const uint8_t push[] = {
+		0x55,		/* push rbp */
+		0x53,		/* push rbx */
+		0x41, 0x55,	/* push r13 */
+		0x41, 0x56,	/* push r14 */
+		0x41, 0x57,	/* push r15 */
+	};
+
+	emit_bytes(st, push, sizeof(push));
+	emit_mov_reg(st, 1, RSP, RBP);
+	emit_alu_imm(st, 1, GRP1_SUB, RSP, MAX_BPF_STACK_SIZE);
+}
+
+static void
+emit_epilogue(struct bpf_jit_state *st)
+{
+	static const uint8_t pop[] = {
+		0x41, 0x5f,	/* pop r15 */
+		0x41, 0x5e,	/* pop r14 */
+		0x41, 0x5d,	/* pop r13 */
+		0x5b,		/* pop rbx */
+		0x5d,		/* pop rbp */
+		0xc3,		/* ret */
+	};
+
+	/* abort path: return 0 */
+	st->exit0_ofs = st->sz;
+	emit_alu_reg(st, 0, 0x31, RAX, RAX);
+
+	st->exit_ofs = st->sz;
+	emit_mov_reg(st, 1, RBP, RSP);
+	emit_bytes(st, pop, sizeof(pop));
+}
+
+static int
+emit_insn(struct bpf_jit_state *st, const struct rte_bpf *bpf,
+	uint32_t pc)
+{
+	static const uint8_t alu_reg_op[] = {
+		[BPF_ADD >> 4] = 0x01,
+		[BPF_SUB >> 4] = 0x29,
+		[BPF_OR >> 4] = 0x09,
+		[BPF_AND >> 4] = 0x21,
+		[BPF_XOR >> 4] = 0x31,
+	};
+	static const uint8_t alu_imm_ext[] = {
+		[BPF_ADD >> 4] = GRP1_ADD,
+		[BPF_SUB >> 4] = GRP1_SUB,
+		[BPF_OR >> 4] = GRP1_OR,
+		[BPF_AND >> 4] = GRP1_AND,
+		[BPF_XOR >> 4] = GRP1_XOR,
+	};
+	static const uint8_t shift_ext[] = {
+		[BPF_LSH >> 4] = GRP2_SHL,
+		[BPF_RSH >> 4] = GRP2_SHR,
+		[EBPF_ARSH >> 4] = GRP2_SAR,
+	};
+	const struct ebpf_insn *ins = bpf->prm.ins + pc;
+	uint32_t dst, src, op;
+	uint64_t imm64;
+	int w;
+
+	dst = ebpf2x86[ins->dst_reg];
+	src = ebpf2x86[ins->src_reg];
+	op = BPF_OP(ins->code);
+	w = (BPF_CLASS(ins->code) == EBPF_ALU64);
+
+	switch (BPF_CLASS(ins->code)) {
+	case BPF_ALU:
+	case EBPF_ALU64:
+		switch (op) {
+		case BPF_ADD:
+		case BPF_SUB:
+		case BPF_OR:
+		case BPF_AND:
+		case BPF_XOR:
+			if (BPF_SRC(ins->code) == BPF_X)
+				emit_alu_reg(st, w, alu_reg_op[op >> 4],
+					src, dst);
+			else
+				emit_alu_imm(st, w, alu_imm_ext[op >> 4],
+					dst, ins->imm);
+			break;
+		case EBPF_MOV:
+			if (BPF_SRC(ins->code) == BPF_X)
+				emit_mov_reg(st, w, src, dst);
+			else
+				emit_mov_imm(st, w, dst, ins->imm);
+			break;
+		case BPF_MUL:
+			/* imul dst, src or imul dst, dst, imm */
+			if (BPF_SRC(ins->code) == BPF_X) {
+				emit_rex(st, w, dst, src, 0);
+				emit_byte(st, 0x0f);
+				emit_byte(st, 0xaf);
+				emit_modrm(st, MOD_DIRECT, dst, src);
+			} else {
+				emit_rex(st, w, dst, dst, 0);
+				emit_byte(st, 0x69);
+				emit_modrm(st, MOD_DIRECT, dst, dst);
+				emit_imm(st, (uint32_t)ins->imm,
+					sizeof(uint32_t));
+			}
+			break;
+		case BPF_DIV:
+		case BPF_MOD:
+			emit_div(st, ins, w, src, dst);
+			break;
+		case BPF_LSH:
+		case BPF_RSH:
+		case EBPF_ARSH:
+			if (BPF_SRC(ins->code) == BPF_X)
+				emit_shift_reg(st, w, shift_ext[op >> 4],
+					src, dst);
+			else
+				emit_shift_imm(st, w, shift_ext[op >> 4],
+					dst, ins->imm);
+			break;
+		case BPF_NEG:
+			emit_rex(st, w, 0, dst, 0);
+			emit_byte(st, 0xf7);
+			emit_modrm(st, MOD_DIRECT, GRP3_NEG, dst);
+			break;
+		case EBPF_END:
+			emit_end(st, ins, dst);
+			break;
+		default:
+			return -EINVAL;
+		}
+		break;
+	case BPF_LD:
+		imm64 = (uint32_t)ins[0].imm |
+			(uint64_t)(uint32_t)ins[1].imm << 32;
+		emit_movabs(st, dst, imm64);
+		break;
+	case BPF_LDX:
+		emit_ld(st, BPF_SIZE(ins->code), src, dst, ins->off);
+		break;
+	case BPF_ST:
+		emit_st_imm(st, BPF_SIZE(ins->code), dst, ins->off, ins->imm);
+		break;
+	case BPF_STX:
+		if (BPF_MODE(ins->code) == EBPF_XADD)
+			emit_xadd(st, BPF_SIZE(ins->code), src, dst, ins->off);
+		else
+			emit_st_reg(st, BPF_SIZE(ins->code), src, dst,
+				ins->off);
+		break;
+	case BPF_JMP:
+		switch (op) {
+		case BPF_JA:
+			emit_jmp(st, st->off[pc + ins->off + 1]);
+			break;
+		case EBPF_CALL:
+			emit_call(st,
+				(uintptr_t)bpf->prm.xsym[ins->imm].func);
+			break;
+		case EBPF_EXIT:
+			emit_jmp(st, st->exit_ofs);
+			break;
+		default:
+			emit_jcond(st, ins, src, dst,
+				st->off[pc + ins->off + 1]);
+			break;
+		}
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* lay out the whole program, writing it when st->ins is set */
+static int
+emit_program(struct bpf_jit_state *st, const struct rte_bpf *bpf)
+{
+	uint32_t i;
+	int rc;
+
+	st->sz = 0;
+	emit_prologue(st);
+
+	for (i = 0; i != bpf->prm.nb_ins; i++) {
+		st->off[i] = st->sz;
+		rc = emit_insn(st, bpf, i);
+		if (rc != 0)
+			return rc;
+		/* skip the second half of a 64-bit immediate load */
+		if (bpf->prm.ins[i].code == (BPF_LD | BPF_IMM | EBPF_DW))
+			st->off[++i] = st->sz;
+	}
+
+	emit_epilogue(st);
+	return 0;
+}
+
+/*
+ * All jumps use 32-bit displacements, so the code size does not depend on
+ * the targets: a first pass records the offsets, the second emits.
+ */
+int
+bpf_jit_x86(struct rte_bpf *bpf)
+{
+	struct bpf_jit_state st;
+	void *code;
+	int rc;
+
+	memset(&st, 0, sizeof(st));
+	st.off = calloc(bpf->prm.nb_ins, sizeof(st.off[0]));
+	if (st.off == NULL)
+		return -ENOMEM;
+
+	rc = emit_program(&st, bpf);
+	if (rc != 0)
+		goto out;
+
+	code = mmap(NULL, st.sz, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (code == MAP_FAILED) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	st.ins = code;
+	rc = emit_program(&st, bpf);
+	if (rc == 0 && mprotect(code, st.sz, PROT_READ | PROT_EXEC) != 0)
+		rc = -ENOMEM;
+	if (rc != 0) {
+		munmap(code, st.sz);
+		goto out;
+	}
+
+	bpf->jit.func = (uint64_t (*)(void *))(uintptr_t)code;
+	bpf->jit.sz = st.sz;
+
+out:
+	free(st.off);
+	return rc;
+}
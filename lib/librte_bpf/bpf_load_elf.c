@@ -0,0 +1,313 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <rte_byteorder.h>
+#include <rte_common.h>
+#include <rte_errno.h>
+
+#include "bpf_impl.h"
+
+#ifndef EM_BPF
+#define EM_BPF	247
+#endif
+
+/* ELF relocatable object mapped in memory */
+struct bpf_elf {
+	const uint8_t *data;
+	size_t sz;
+	const Elf64_Ehdr *ehdr;
+	const Elf64_Shdr *shdr;
+};
+
+/* check that [ofs, ofs + len) lies within the file */
+static int
+elf_range_ok(const struct bpf_elf *elf, uint64_t ofs, uint64_t len)
+{
+	return ofs <= elf->sz && len <= elf->sz - ofs;
+}
+
+static const void *
+elf_section_data(const struct bpf_elf *elf, const Elf64_Shdr *sh)
+{
+	if (!elf_range_ok(elf, sh->sh_offset, sh->sh_size))
+		return NULL;
+	return elf->data + sh->sh_offset;
+}
+
+/* string at offset ofs of string table section idx, NULL if invalid */
+static const char *
+elf_string(const struct bpf_elf *elf, uint32_t idx, uint32_t ofs)
+{
+	const Elf64_Shdr *sh;
+	const char *str;
+
+	if (idx >= elf->ehdr->e_shnum)
+		return NULL;
+	sh = &elf->shdr[idx];
+	if (sh->sh_type != SHT_STRTAB || ofs >= sh->sh_size)
+		return NULL;
+
+	str = elf_section_data(elf, sh);
+	if (str == NULL || memchr(str + ofs, 0, sh->sh_size - ofs) == NULL)
+		return NULL;
+	return str + ofs;
+}
+
+static int
+elf_parse(struct bpf_elf *elf)
+{
+	const Elf64_Ehdr *eh;
+
+	if (elf->sz < sizeof(*eh))
+		return -EINVAL;
+
+	eh = (const Elf64_Ehdr *)elf->data;
+	if (memcmp(eh->e_ident, ELFMAG, SELFMAG) != 0 ||
+			eh->e_ident[EI_CLASS] != ELFCLASS64 ||
+#if RTE_BYTE_ORDER == RTE_LITTLE_ENDIAN
+			eh->e_ident[EI_DATA] != ELFDATA2LSB ||
+#else
+			eh->e_ident[EI_DATA] != ELFDATA2MSB ||
+#endif
+			eh->e_type != ET_REL || eh->e_machine != EM_BPF ||
+			eh->e_shentsize != sizeof(Elf64_Shdr) ||
+			eh->e_shstrndx >= eh->e_shnum ||
+			!elf_range_ok(elf, eh->e_shoff,
+				(uint64_t)eh->e_shnum * sizeof(Elf64_Shdr)))
+		return -EINVAL;
+
+	elf->ehdr = eh;
+	elf->shdr = (const Elf64_Shdr *)(elf->data + eh->e_shoff);
+	return 0;
+}
+
+static int
+elf_find_section(const struct bpf_elf *elf, const char *sname)
+{
+	const Elf64_Shdr *sh;
+	const char *name;
+	uint32_t i;
+
+	for (i = 0; i != elf->ehdr->e_shnum; i++) {
+		sh = &elf->shdr[i];
+		name = elf_string(elf, elf->ehdr->e_shstrndx, sh->sh_name);
+		if (name != NULL && strcmp(name, sname) == 0 &&
+				sh->sh_type == SHT_PROGBITS &&
+				(sh->sh_flags & SHF_EXECINSTR) != 0)
+			return i;
+	}
+
+	return -ENOENT;
+}
+
+/* patch an instruction referencing the external symbol sym */
+static int
+resolve_xsym(const char *sym, struct ebpf_insn *ins, size_t nb_ins,
+	size_t idx, const struct rte_bpf_prm *prm)
+{
+	uint32_t i;
+	uint64_t addr;
+
+	for (i = 0; i != prm->nb_xsym; i++) {
+		if (strcmp(sym, prm->xsym[i].name) == 0)
+			break;
+	}
+	if (i == prm->nb_xsym) {
+		RTE_BPF_LOG(ERR, "%s: unresolved symbol %s\n", __func__, sym);
+		return -ENOENT;
+	}
+
+	if (ins[idx].code == (BPF_JMP | EBPF_CALL) &&
+			prm->xsym[i].type == RTE_BPF_XTYPE_FUNC) {
+		ins[idx].imm = i;
+		return 0;
+	}
+
+	if (ins[idx].code == (BPF_LD | BPF_IMM | EBPF_DW) &&
+			idx + 1 < nb_ins &&
+			prm->xsym[i].type == RTE_BPF_XTYPE_VAR) {
+		addr = (uintptr_t)prm->xsym[i].var;
+		ins[idx].imm = (uint32_t)addr;
+		ins[idx + 1].imm = (uint32_t)(addr >> 32);
+		return 0;
+	}
+
+	RTE_BPF_LOG(ERR, "%s: invalid reference to %s at insn %zu\n",
+		__func__, sym, idx);
+	return -EINVAL;
+}
+
+/* apply the relocations of section sidx to its instructions */
+static int
+elf_reloc(const struct bpf_elf *elf, uint32_t sidx, struct ebpf_insn *ins,
+	size_t nb_ins, const struct rte_bpf_prm *prm)
+{
+	const Elf64_Shdr *sh, *symsh;
+	const Elf64_Rel *rel;
+	const Elf64_Sym *sym;
+	const char *name;
+	size_t i, n, nb_sym, idx;
+	uint32_t j;
+	int rc;
+
+	for (j = 0; j != elf->ehdr->e_shnum; j++) {
+		sh = &elf->shdr[j];
+		if (sh->sh_info != sidx)
+			continue;
+		if (sh->sh_type == SHT_RELA)
+			return -ENOTSUP;
+		if (sh->sh_type != SHT_REL)
+			continue;
+
+		if (sh->sh_link >= elf->ehdr->e_shnum)
+			return -EINVAL;
+		symsh = &elf->shdr[sh->sh_link];
+		rel = elf_section_data(elf, sh);
+		sym = elf_section_data(elf, symsh);
+		if (rel == NULL || sym == NULL ||
+				symsh->sh_type != SHT_SYMTAB)
+			return -EINVAL;
+
+		n = sh->sh_size / sizeof(*rel);
+		nb_sym = symsh->sh_size / sizeof(*sym);
+		for (i = 0; i != n; i++) {
+			if (ELF64_R_SYM(rel[i].r_info) >= nb_sym ||
+					rel[i].r_offset % sizeof(*ins) != 0)
+				return -EINVAL;
+			idx = rel[i].r_offset / sizeof(*ins);
+			if (idx >= nb_ins)
+				return -EINVAL;
+
+			name = elf_string(elf, symsh->sh_link,
+				sym[ELF64_R_SYM(rel[i].r_info)].st_name);
+			if (name == NULL)
+				return -EINVAL;
+
+			rc = resolve_xsym(name, ins, nb_ins, idx, prm);
+			if (rc != 0)
+				return rc;
+		}
+	}
+
+	return 0;
+}
+
+static struct rte_bpf *
+bpf_elf_load(struct bpf_elf *elf, const struct rte_bpf_prm *prm,
+	const char *sname)
+{
+	const Elf64_Shdr *sh;
+	const void *data;
+	struct ebpf_insn *ins;
+	struct rte_bpf_prm np;
+	struct rte_bpf *bpf;
+	size_t nb_ins;
+	int rc;
+
+	rc = elf_parse(elf);
+	if (rc != 0) {
+		RTE_BPF_LOG(ERR, "%s: not a BPF relocatable object\n",
+			__func__);
+		rte_errno = -rc;
+		return NULL;
+	}
+
+	rc = elf_find_section(elf, sname);
+	if (rc < 0) {
+		RTE_BPF_LOG(ERR, "%s: no code section %s\n", __func__, sname);
+		rte_errno = -rc;
+		return NULL;
+	}
+
+	sh = &elf->shdr[rc];
+	data = elf_section_data(elf, sh);
+	nb_ins = sh->sh_size / sizeof(*ins);
+	if (data == NULL || nb_ins == 0 || nb_ins > UINT32_MAX ||
+			sh->sh_size % sizeof(*ins) != 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	/* relocations are applied to a private copy of the code */
+	ins = malloc(sh->sh_size);
+	if (ins == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+	memcpy(ins, data, sh->sh_size);
+
+	bpf = NULL;
+	rc = elf_reloc(elf, rc, ins, nb_ins, prm);
+	if (rc == 0) {
+		np = *prm;
+		np.ins = ins;
+		np.nb_ins = nb_ins;
+		bpf = rte_bpf_load(&np);
+	} else {
+		rte_errno = -rc;
+	}
+
+	free(ins);
+	return bpf;
+}
+
+struct rte_bpf *
+rte_bpf_elf_load(const struct rte_bpf_prm *prm, const char *fname,
+	const char *sname)
+{
+	struct bpf_elf elf;
+	struct rte_bpf *bpf;
+	struct stat st;
+	void *data;
+	int fd, rc;
+
+	if (prm == NULL || fname == NULL || sname == NULL) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	fd = open(fname, O_RDONLY);
+	if (fd < 0) {
+		rc = errno;
+		RTE_BPF_LOG(ERR, "%s: cannot open %s: %s\n",
+			__func__, fname, strerror(rc));
+		rte_errno = rc;
+		return NULL;
+	}
+
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	memset(&elf, 0, sizeof(elf));
+	elf.data = data;
+	elf.sz = st.st_size;
+	bpf = bpf_elf_load(&elf, prm, sname);
+	munmap(data, st.st_size);
+
+	if (bpf != NULL)
+		RTE_BPF_LOG(INFO, "%s(fname=\"%s\", sname=\"%s\") "
+			"successfully creates %p(jit={.func=%p,.sz=%zu});\n",
+			__func__, fname, sname, bpf, bpf->jit.func,
+			bpf->jit.sz);
+	return bpf;
+}
@@ -0,0 +1,325 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_atomic.h>
+#include <rte_errno.h>
+#include <rte_ethdev.h>
+#include <rte_mbuf.h>
+#include <rte_pause.h>
+#include <rte_spinlock.h>
+
+#include "bpf_impl.h"
+#include "rte_bpf_ethdev.h"
+
+/*
+ * Program attached to a queue. The use counter is odd while the data path
+ * runs the program, so that unload can wait for the last burst to finish
+ * before releasing it.
+ */
+struct bpf_eth_cbi {
+	volatile uint32_t use;
+	struct rte_eth_rxtx_callback *cb;
+	struct rte_bpf *bpf;
+	struct rte_bpf_jit jit;
+	enum rte_bpf_prog_type type;
+};
+
+/* programs of one direction, updates serialized by the lock */
+struct bpf_eth_cbh {
+	rte_spinlock_t lock;
+	struct bpf_eth_cbi cbi[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
+};
+
+static struct bpf_eth_cbh rx_cbh = {
+	.lock = RTE_SPINLOCK_INITIALIZER,
+};
+
+static struct bpf_eth_cbh tx_cbh = {
+	.lock = RTE_SPINLOCK_INITIALIZER,
+};
+
+static inline void
+bpf_eth_cbi_inuse(struct bpf_eth_cbi *cbi)
+{
+	cbi->use++;
+	/* make the counter visible before reading the program */
+	rte_smp_mb();
+}
+
+static inline void
+bpf_eth_cbi_unuse(struct bpf_eth_cbi *cbi)
+{
+	/* the program is not used past this point */
+	rte_smp_wmb();
+	cbi->use++;
+}
+
+/* wait for the data path to leave the program, if it is running it */
+static void
+bpf_eth_cbi_wait(const struct bpf_eth_cbi *cbi)
+{
+	uint32_t nuse, puse;
+
+	rte_smp_mb();
+	puse = cbi->use;
+
+	if ((puse & 1) != 0) {
+		do {
+			rte_pause();
+			nuse = cbi->use;
+		} while (nuse == puse);
+	}
+}
+
+/*
+ * Keep packets the program accepted at the head of the array. On Rx the
+ * others are freed; on Tx they are moved to the tail, where the
+ * application sees them as not sent and deals with them as usual.
+ */
+static inline uint32_t
+bpf_eth_apply(struct rte_mbuf *mb[], const uint64_t rc[], uint32_t num,
+	uint32_t drop)
+{
+	uint32_t i, j, k;
+	struct rte_mbuf *dr[num];
+
+	for (i = 0, j = 0, k = 0; i != num; i++) {
+		if (rc[i] != 0)
+			mb[j++] = mb[i];
+		else
+			dr[k++] = mb[i];
+	}
+
+	if (drop != 0) {
+		for (i = 0; i != k; i++)
+			rte_pktmbuf_free(dr[i]);
+	} else {
+		for (i = 0; i != k; i++)
+			mb[j + i] = dr[i];
+	}
+
+	return j;
+}
+
+static inline void *
+bpf_eth_ctx(struct rte_mbuf *mb, enum rte_bpf_prog_type type)
+{
+	if (type == RTE_BPF_PROG_TYPE_MBUF)
+		return mb;
+	return rte_pktmbuf_mtod(mb, void *);
+}
+
+static inline uint32_t
+bpf_eth_filter_vm(const struct bpf_eth_cbi *cbi, struct rte_mbuf *mb[],
+	uint32_t num, uint32_t drop)
+{
+	uint32_t i;
+	void *ctx[num];
+	uint64_t rc[num];
+
+	for (i = 0; i != num; i++)
+		ctx[i] = bpf_eth_ctx(mb[i], cbi->type);
+
+	rte_bpf_exec_burst(cbi->bpf, ctx, rc, num);
+	return bpf_eth_apply(mb, rc, num, drop);
+}
+
+static inline uint32_t
+bpf_eth_filter_jit(const struct bpf_eth_cbi *cbi, struct rte_mbuf *mb[],
+	uint32_t num, uint32_t drop)
+{
+	uint32_t i;
+	uint64_t rc[num];
+
+	for (i = 0; i != num; i++)
+		rc[i] = cbi->jit.func(bpf_eth_ctx(mb[i], cbi->type));
+
+	return bpf_eth_apply(mb, rc, num, drop);
+}
+
+static uint16_t
+bpf_rx_callback_vm(__rte_unused uint16_t port, __rte_unused uint16_t queue,
+	struct rte_mbuf *pkt[], uint16_t nb_pkts,
+	__rte_unused uint16_t max_pkts, void *user_param)
+{
+	struct bpf_eth_cbi *cbi = user_param;
+	uint16_t n;
+
+	bpf_eth_cbi_inuse(cbi);
+	n = (cbi->cb != NULL) ? bpf_eth_filter_vm(cbi, pkt, nb_pkts, 1) :
+		nb_pkts;
+	bpf_eth_cbi_unuse(cbi);
+	return n;
+}
+
+static uint16_t
+bpf_rx_callback_jit(__rte_unused uint16_t port, __rte_unused uint16_t queue,
+	struct rte_mbuf *pkt[], uint16_t nb_pkts,
+	__rte_unused uint16_t max_pkts, void *user_param)
+{
+	struct bpf_eth_cbi *cbi = user_param;
+	uint16_t n;
+
+	bpf_eth_cbi_inuse(cbi);
+	n = (cbi->cb != NULL) ? bpf_eth_filter_jit(cbi, pkt, nb_pkts, 1) :
+		nb_pkts;
+	bpf_eth_cbi_unuse(cbi);
+	return n;
+}
+
+static uint16_t
+bpf_tx_callback_vm(__rte_unused uint16_t port, __rte_unused uint16_t queue,
+	struct rte_mbuf *pkt[], uint16_t nb_pkts, void *user_param)
+{
+	struct bpf_eth_cbi *cbi = user_param;
+	uint16_t n;
+
+	bpf_eth_cbi_inuse(cbi);
+	n = (cbi->cb != NULL) ? bpf_eth_filter_vm(cbi, pkt, nb_pkts, 0) :
+		nb_pkts;
+	bpf_eth_cbi_unuse(cbi);
+	return n;
+}
+
+static uint16_t
+bpf_tx_callback_jit(__rte_unused uint16_t port, __rte_unused uint16_t queue,
+	struct rte_mbuf *pkt[], uint16_t nb_pkts, void *user_param)
+{
+	struct bpf_eth_cbi *cbi = user_param;
+	uint16_t n;
+
+	bpf_eth_cbi_inuse(cbi);
+	n = (cbi->cb != NULL) ? bpf_eth_filter_jit(cbi, pkt, nb_pkts, 0) :
+		nb_pkts;
+	bpf_eth_cbi_unuse(cbi);
+	return n;
+}
+
+/* called with the lock held */
+static void
+bpf_eth_unload(struct bpf_eth_cbh *cbh, uint16_t port, uint16_t queue)
+{
+	struct bpf_eth_cbi *cbi;
+	struct rte_eth_rxtx_callback *cb;
+
+	cbi = &cbh->cbi[port][queue];
+	cb = cbi->cb;
+	if (cb == NULL)
+		return;
+
+	/* bursts already in the callback leave the packets untouched */
+	cbi->cb = NULL;
+	if (cbh == &rx_cbh)
+		rte_eth_remove_rx_callback(port, queue, cb);
+	else
+		rte_eth_remove_tx_callback(port, queue, cb);
+
+	bpf_eth_cbi_wait(cbi);
+	rte_bpf_destroy(cbi->bpf);
+	cbi->bpf = NULL;
+	memset(&cbi->jit, 0, sizeof(cbi->jit));
+}
+
+static void
+bpf_eth_unload_locked(struct bpf_eth_cbh *cbh, uint16_t port,
+	uint16_t queue)
+{
+	if (port >= RTE_MAX_ETHPORTS || queue >= RTE_MAX_QUEUES_PER_PORT)
+		return;
+
+	rte_spinlock_lock(&cbh->lock);
+	bpf_eth_unload(cbh, port, queue);
+	rte_spinlock_unlock(&cbh->lock);
+}
+
+void
+rte_bpf_eth_rx_unload(uint16_t port, uint16_t queue)
+{
+	bpf_eth_unload_locked(&rx_cbh, port, queue);
+}
+
+void
+rte_bpf_eth_tx_unload(uint16_t port, uint16_t queue)
+{
+	bpf_eth_unload_locked(&tx_cbh, port, queue);
+}
+
+static int
+bpf_eth_elf_load(struct bpf_eth_cbh *cbh, uint16_t port, uint16_t queue,
+	const struct rte_bpf_prm *prm, const char *fname, const char *sname,
+	uint32_t flags)
+{
+	struct bpf_eth_cbi *cbi;
+	struct rte_bpf *bpf;
+	struct rte_bpf_jit jit;
+	int rc;
+
+	if (prm == NULL || !rte_eth_dev_is_valid_port(port) ||
+			queue >= RTE_MAX_QUEUES_PER_PORT ||
+			(flags & ~RTE_BPF_ETH_F_JIT) != 0)
+		return -EINVAL;
+
+	bpf = rte_bpf_elf_load(prm, fname, sname);
+	if (bpf == NULL)
+		return -rte_errno;
+
+	rte_bpf_get_jit(bpf, &jit);
+	if ((flags & RTE_BPF_ETH_F_JIT) != 0 && jit.func == NULL) {
+		RTE_BPF_LOG(ERR, "%s(%u, %u): no JIT generated\n",
+			__func__, port, queue);
+		rte_bpf_destroy(bpf);
+		return -ENOTSUP;
+	}
+
+	rte_spinlock_lock(&cbh->lock);
+
+	bpf_eth_unload(cbh, port, queue);
+
+	cbi = &cbh->cbi[port][queue];
+	cbi->bpf = bpf;
+	cbi->jit = jit;
+	cbi->type = prm->prog_type;
+
+	if (cbh == &rx_cbh)
+		cbi->cb = rte_eth_add_rx_callback(port, queue,
+			(flags & RTE_BPF_ETH_F_JIT) ? bpf_rx_callback_jit :
+			bpf_rx_callback_vm, cbi);
+	else
+		cbi->cb = rte_eth_add_tx_callback(port, queue,
+			(flags & RTE_BPF_ETH_F_JIT) ? bpf_tx_callback_jit :
+			bpf_tx_callback_vm, cbi);
+
+	rc = 0;
+	if (cbi->cb == NULL) {
+		rc = -rte_errno;
+		rte_bpf_destroy(bpf);
+		cbi->bpf = NULL;
+		memset(&cbi->jit, 0, sizeof(cbi->jit));
+	}
+
+	rte_spinlock_unlock(&cbh->lock);
+	return rc;
+}
+
+int
+rte_bpf_eth_rx_elf_load(uint16_t port, uint16_t queue,
+	const struct rte_bpf_prm *prm, const char *fname, const char *sname,
+	uint32_t flags)
+{
+	return bpf_eth_elf_load(&rx_cbh, port, queue, prm, fname, sname,
+		flags);
+}
+
+int
+rte_bpf_eth_tx_elf_load(uint16_t port, uint16_t queue,
+	const struct rte_bpf_prm *prm, const char *fname, const char *sname,
+	uint32_t flags)
+{
+	return bpf_eth_elf_load(&tx_cbh, port, queue, prm, fname, sname,
+		flags);
+}
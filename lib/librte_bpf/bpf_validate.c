@@ -0,0 +1,348 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_common.h>
+
+#include "bpf_impl.h"
+
+/* state of an instruction during the depth-first walk */
+enum {
+	WHITE,	/* not visited yet */
+	GREY,	/* on the current path */
+	BLACK,	/* all successors walked */
+};
+
+struct bpf_verifier {
+	const struct rte_bpf *bpf;
+	uint8_t *state;
+	uint8_t *ld_imm64_hi;	/* second slot of a 64-bit load */
+	uint32_t *stack;	/* pending walk: insn indexes */
+	uint8_t *next_edge;	/* successors already pushed per insn */
+};
+
+static const char *
+check_reg(const struct ebpf_insn *ins, int dst_written)
+{
+	if (ins->dst_reg >= EBPF_REG_NUM || ins->src_reg >= EBPF_REG_NUM)
+		return "invalid register";
+	if (dst_written && ins->dst_reg == EBPF_REG_10)
+		return "R10 is read-only";
+	return NULL;
+}
+
+/* accesses relative to the frame pointer must stay within the stack */
+static const char *
+check_stack(uint32_t base, int16_t off, uint32_t size)
+{
+	if (base != EBPF_REG_10)
+		return NULL;
+	if (off >= 0 || -off > MAX_BPF_STACK_SIZE || off + (int32_t)size > 0)
+		return "stack access out of bounds";
+	return NULL;
+}
+
+static uint32_t
+access_size(uint8_t code)
+{
+	switch (BPF_SIZE(code)) {
+	case BPF_B:
+		return sizeof(uint8_t);
+	case BPF_H:
+		return sizeof(uint16_t);
+	case BPF_W:
+		return sizeof(uint32_t);
+	default:
+		return sizeof(uint64_t);
+	}
+}
+
+static const char *
+check_alu(const struct ebpf_insn *ins)
+{
+	uint32_t width;
+
+	width = (BPF_CLASS(ins->code) == EBPF_ALU64) ? 64 : 32;
+	if (ins->off != 0)
+		return "invalid offset";
+	if (BPF_SRC(ins->code) == BPF_X && ins->imm != 0 &&
+			BPF_OP(ins->code) != EBPF_END)
+		return "invalid immediate";
+	if (BPF_SRC(ins->code) == BPF_K && ins->src_reg != 0)
+		return "invalid source register";
+
+	switch (BPF_OP(ins->code)) {
+	case BPF_ADD:
+	case BPF_SUB:
+	case BPF_MUL:
+	case BPF_OR:
+	case BPF_AND:
+	case BPF_XOR:
+	case EBPF_MOV:
+		return NULL;
+	case BPF_DIV:
+	case BPF_MOD:
+		if (BPF_SRC(ins->code) == BPF_K && ins->imm == 0)
+			return "division by 0";
+		return NULL;
+	case BPF_LSH:
+	case BPF_RSH:
+	case EBPF_ARSH:
+		if (BPF_SRC(ins->code) == BPF_K &&
+				(uint32_t)ins->imm >= width)
+			return "invalid shift";
+		return NULL;
+	case BPF_NEG:
+		if (BPF_SRC(ins->code) != BPF_K || ins->imm != 0)
+			return "invalid negation";
+		return NULL;
+	case EBPF_END:
+		if (width != 32 || ins->src_reg != 0 ||
+				(ins->imm != 16 && ins->imm != 32 &&
+				ins->imm != 64))
+			return "invalid byte swap";
+		return NULL;
+	default:
+		return "invalid opcode";
+	}
+}
+
+static const char *
+check_jmp(const struct bpf_verifier *vf, uint32_t pc)
+{
+	const struct rte_bpf *bpf = vf->bpf;
+	const struct ebpf_insn *ins = bpf->prm.ins + pc;
+	int64_t dst;
+
+	switch (BPF_OP(ins->code)) {
+	case EBPF_EXIT:
+		if (ins->code != (BPF_JMP | EBPF_EXIT))
+			return "invalid opcode";
+		return NULL;
+	case EBPF_CALL:
+		if (ins->code != (BPF_JMP | EBPF_CALL))
+			return "invalid opcode";
+		if ((uint32_t)ins->imm >= bpf->prm.nb_xsym ||
+				bpf->prm.xsym[ins->imm].type !=
+				RTE_BPF_XTYPE_FUNC)
+			return "call to an unknown function";
+		return NULL;
+	case BPF_JA:
+		if (ins->code != (BPF_JMP | BPF_JA))
+			return "invalid opcode";
+		break;
+	case BPF_JEQ:
+	case BPF_JGT:
+	case BPF_JGE:
+	case BPF_JSET:
+	case EBPF_JNE:
+	case EBPF_JSGT:
+	case EBPF_JSGE:
+	case EBPF_JLT:
+	case EBPF_JLE:
+	case EBPF_JSLT:
+	case EBPF_JSLE:
+		break;
+	default:
+		return "invalid opcode";
+	}
+
+	dst = (int64_t)pc + ins->off + 1;
+	if (dst < 0 || dst >= bpf->prm.nb_ins)
+		return "jump out of the program";
+	return NULL;
+}
+
+/* check the instruction at pc, returns an error string or NULL */
+static const char *
+check_syntax(struct bpf_verifier *vf, uint32_t pc)
+{
+	const struct rte_bpf *bpf = vf->bpf;
+	const struct ebpf_insn *ins = bpf->prm.ins + pc;
+	const char *err;
+	uint32_t size;
+
+	switch (BPF_CLASS(ins->code)) {
+	case BPF_ALU:
+	case EBPF_ALU64:
+		err = check_reg(ins, 1);
+		if (err == NULL)
+			err = check_alu(ins);
+		return err;
+	case BPF_LD:
+		/* only 64-bit immediate loads, over two slots */
+		if (ins->code != (BPF_LD | BPF_IMM | EBPF_DW))
+			return "invalid opcode";
+		if (pc + 1 >= bpf->prm.nb_ins || ins[1].code != 0 ||
+				ins[1].dst_reg != 0 || ins[1].src_reg != 0 ||
+				ins[1].off != 0)
+			return "invalid 64-bit immediate load";
+		vf->ld_imm64_hi[pc + 1] = 1;
+		return check_reg(ins, 1);
+	case BPF_LDX:
+		if (BPF_MODE(ins->code) != BPF_MEM)
+			return "invalid opcode";
+		err = check_reg(ins, 1);
+		if (err == NULL)
+			err = check_stack(ins->src_reg, ins->off,
+				access_size(ins->code));
+		return err;
+	case BPF_ST:
+		if (BPF_MODE(ins->code) != BPF_MEM || ins->src_reg != 0)
+			return "invalid opcode";
+		err = check_reg(ins, 0);
+		if (err == NULL)
+			err = check_stack(ins->dst_reg, ins->off,
+				access_size(ins->code));
+		return err;
+	case BPF_STX:
+		size = access_size(ins->code);
+		if (BPF_MODE(ins->code) != BPF_MEM &&
+				(BPF_MODE(ins->code) != EBPF_XADD ||
+				size < sizeof(uint32_t)))
+			return "invalid opcode";
+		err = check_reg(ins, 0);
+		if (err == NULL)
+			err = check_stack(ins->dst_reg, ins->off, size);
+		return err;
+	case BPF_JMP:
+		err = check_reg(ins, 0);
+		if (err == NULL)
+			err = check_jmp(vf, pc);
+		return err;
+	default:
+		return "invalid opcode";
+	}
+}
+
+/* successors of the instruction at pc, returns their number */
+static uint32_t
+insn_successors(const struct rte_bpf *bpf, uint32_t pc, uint32_t next[2])
+{
+	const struct ebpf_insn *ins = bpf->prm.ins + pc;
+
+	if (ins->code == (BPF_JMP | EBPF_EXIT))
+		return 0;
+	if (ins->code == (BPF_JMP | BPF_JA)) {
+		next[0] = pc + ins->off + 1;
+		return 1;
+	}
+	if (ins->code == (BPF_LD | BPF_IMM | EBPF_DW)) {
+		next[0] = pc + 2;
+		return 1;
+	}
+
+	next[0] = pc + 1;
+	if (BPF_CLASS(ins->code) == BPF_JMP &&
+			ins->code != (BPF_JMP | EBPF_CALL)) {
+		next[1] = pc + ins->off + 1;
+		return 2;
+	}
+	return 1;
+}
+
+/*
+ * Walk the control flow graph depth-first: a jump back to an instruction
+ * of the current path is a loop, and every instruction must be reachable.
+ */
+static int
+check_cfg(struct bpf_verifier *vf)
+{
+	const struct rte_bpf *bpf = vf->bpf;
+	uint32_t next[2], n, pc, sp, i;
+
+	sp = 0;
+	vf->stack[sp++] = 0;
+	vf->state[0] = GREY;
+
+	while (sp != 0) {
+		pc = vf->stack[sp - 1];
+		n = insn_successors(bpf, pc, next);
+
+		i = vf->next_edge[pc];
+		if (i == n) {
+			vf->state[pc] = BLACK;
+			sp--;
+			continue;
+		}
+		vf->next_edge[pc]++;
+
+		if (next[i] >= bpf->prm.nb_ins) {
+			RTE_BPF_LOG(ERR, "%s: pc: %u falls off the program\n",
+				__func__, pc);
+			return -EINVAL;
+		}
+		if (vf->ld_imm64_hi[next[i]]) {
+			RTE_BPF_LOG(ERR, "%s: pc: %u jumps into a 64-bit "
+				"immediate load\n", __func__, pc);
+			return -EINVAL;
+		}
+		if (vf->state[next[i]] == GREY) {
+			RTE_BPF_LOG(ERR, "%s: pc: %u loops back to %u\n",
+				__func__, pc, next[i]);
+			return -EINVAL;
+		}
+		if (vf->state[next[i]] == WHITE) {
+			vf->state[next[i]] = GREY;
+			vf->stack[sp++] = next[i];
+		}
+	}
+
+	for (pc = 0; pc != bpf->prm.nb_ins; pc++) {
+		if (vf->state[pc] == WHITE && !vf->ld_imm64_hi[pc]) {
+			RTE_BPF_LOG(ERR, "%s: pc: %u is unreachable\n",
+				__func__, pc);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+int
+bpf_validate(struct rte_bpf *bpf)
+{
+	struct bpf_verifier vf;
+	const char *err;
+	uint32_t n, pc;
+	int rc;
+
+	n = bpf->prm.nb_ins;
+	memset(&vf, 0, sizeof(vf));
+	vf.bpf = bpf;
+	vf.state = calloc(n, sizeof(vf.state[0]));
+	vf.ld_imm64_hi = calloc(n, sizeof(vf.ld_imm64_hi[0]));
+	vf.next_edge = calloc(n, sizeof(vf.next_edge[0]));
+	vf.stack = calloc(n, sizeof(vf.stack[0]));
+	if (vf.state == NULL || vf.ld_imm64_hi == NULL ||
+			vf.next_edge == NULL || vf.stack == NULL) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	rc = 0;
+	for (pc = 0; pc != n; pc++) {
+		if (vf.ld_imm64_hi[pc])
+			continue;
+		err = check_syntax(&vf, pc);
+		if (err != NULL) {
+			RTE_BPF_LOG(ERR, "%s: %s at pc: %u\n",
+				__func__, err, pc);
+			rc = -EINVAL;
+			goto out;
+		}
+	}
+
+	rc = check_cfg(&vf);
+
+out:
+	free(vf.stack);
+	free(vf.next_edge);
+	free(vf.ld_imm64_hi);
+	free(vf.state);
+	return rc;
+}
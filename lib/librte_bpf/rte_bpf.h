@@ -0,0 +1,164 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef _RTE_BPF_H_
+#define _RTE_BPF_H_
+
+/**
+ * @file
+ *
+ * RTE BPF
+ *
+ * Load, verify and run eBPF programs inside DPDK applications, either
+ * through an interpreter or as native code produced by a JIT compiler
+ * (x86-64 only at the moment).
+ *
+ * Programs are trusted: the verifier rejects malformed code, loops and
+ * out of bounds stack accesses, but does not track the pointers a
+ * program dereferences.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <rte_common.h>
+
+#include <bpf_def.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Type of the input of a program, passed in EBPF_REG_1 */
+enum rte_bpf_prog_type {
+	RTE_BPF_PROG_TYPE_UNSPEC, /**< pointer to raw data */
+	RTE_BPF_PROG_TYPE_MBUF,   /**< pointer to a struct rte_mbuf */
+};
+
+/** Type of a symbol provided to programs */
+enum rte_bpf_xtype {
+	RTE_BPF_XTYPE_FUNC, /**< function, called with EBPF_CALL */
+	RTE_BPF_XTYPE_VAR,  /**< variable, loaded with a 64-bit immediate */
+	RTE_BPF_XTYPE_NUM,
+};
+
+/**
+ * Symbol provided to programs. Calls to external functions are encoded as
+ * an EBPF_CALL to the index of the symbol in the rte_bpf_prm xsym array.
+ * References from ELF objects are resolved by name.
+ */
+struct rte_bpf_xsym {
+	const char *name;        /**< name */
+	enum rte_bpf_xtype type; /**< type */
+	RTE_STD_C11
+	union {
+		/** function, up to EBPF_FUNC_MAX_ARGS arguments */
+		uint64_t (*func)(uint64_t, uint64_t, uint64_t,
+				uint64_t, uint64_t);
+		void *var; /**< address of the variable */
+	};
+};
+
+/** Parameters of a program to load */
+struct rte_bpf_prm {
+	const struct ebpf_insn *ins;    /**< instructions */
+	uint32_t nb_ins;                /**< number of instructions */
+	const struct rte_bpf_xsym *xsym; /**< external symbols */
+	uint32_t nb_xsym;               /**< number of external symbols */
+	enum rte_bpf_prog_type prog_type; /**< type of the input */
+};
+
+/** Native code generated for a program */
+struct rte_bpf_jit {
+	uint64_t (*func)(void *); /**< entry point, NULL if none */
+	size_t sz;                /**< size of the code */
+};
+
+struct rte_bpf;
+
+/**
+ * Release a program and its native code.
+ *
+ * @param bpf
+ *   Program to release, NULL is allowed.
+ */
+void rte_bpf_destroy(struct rte_bpf *bpf);
+
+/**
+ * Load and verify a program. Native code is generated when the
+ * architecture has a JIT compiler; a JIT failure is not fatal, the
+ * program is then only run by the interpreter.
+ *
+ * @param prm
+ *   Program parameters, the instructions and symbols are copied.
+ * @return
+ *   The program on success, NULL on error with rte_errno set.
+ */
+struct rte_bpf *rte_bpf_load(const struct rte_bpf_prm *prm);
+
+/**
+ * Load and verify a program from a section of an ELF relocatable object,
+ * as produced by "clang -O2 -target bpf -c". References to external
+ * symbols are resolved against prm->xsym.
+ *
+ * @param prm
+ *   Program parameters, ins and nb_ins are ignored.
+ * @param fname
+ *   Path of the ELF file.
+ * @param sname
+ *   Name of the section holding the program.
+ * @return
+ *   The program on success, NULL on error with rte_errno set.
+ */
+struct rte_bpf *rte_bpf_elf_load(const struct rte_bpf_prm *prm,
+	const char *fname, const char *sname);
+
+/**
+ * Run a program through the interpreter.
+ *
+ * @param bpf
+ *   Program to run.
+ * @param ctx
+ *   Program input.
+ * @return
+ *   Value returned by the program, 0 if it was aborted by a division by
+ *   zero.
+ */
+uint64_t rte_bpf_exec(const struct rte_bpf *bpf, void *ctx);
+
+/**
+ * Run a program through the interpreter, for several inputs.
+ *
+ * @param bpf
+ *   Program to run.
+ * @param ctx
+ *   Program inputs.
+ * @param rc
+ *   Values returned by the program, one per input.
+ * @param num
+ *   Number of inputs.
+ * @return
+ *   Number of non zero values returned.
+ */
+uint32_t rte_bpf_exec_burst(const struct rte_bpf *bpf, void *ctx[],
+	uint64_t rc[], uint32_t num);
+
+/**
+ * Get the native code of a program.
+ *
+ * @param bpf
+ *   Program.
+ * @param jit
+ *   Filled with the entry point, whose func is NULL when the program has
+ *   no native code.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int rte_bpf_get_jit(const struct rte_bpf *bpf, struct rte_bpf_jit *jit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_BPF_H_ */
@@ -0,0 +1,106 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef _RTE_BPF_ETHDEV_H_
+#define _RTE_BPF_ETHDEV_H_
+
+/**
+ * @file
+ *
+ * RTE BPF ethdev filters
+ *
+ * Attach eBPF programs to the Rx or Tx path of an ethdev queue, through
+ * ethdev callbacks. Every packet is given to the program, packets for
+ * which it returns 0 are filtered out: on Rx they are freed before
+ * reaching the application, on Tx they are not sent and are returned to
+ * the application at the end of the array, as for a partial burst.
+ *
+ * At most one program is attached per queue and direction; loading a new
+ * one replaces the previous one.
+ */
+
+#include <rte_bpf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Run the program through the interpreter */
+#define RTE_BPF_ETH_F_NONE	0
+/** Run the native code of the program, fail if there is none */
+#define RTE_BPF_ETH_F_JIT	0x1
+
+/**
+ * Detach and release the program attached to the Rx path of a queue.
+ * Waits for the data path to stop using it.
+ *
+ * @param port
+ *   Port identifier.
+ * @param queue
+ *   Rx queue identifier.
+ */
+void rte_bpf_eth_rx_unload(uint16_t port, uint16_t queue);
+
+/**
+ * Detach and release the program attached to the Tx path of a queue.
+ * Waits for the data path to stop using it.
+ *
+ * @param port
+ *   Port identifier.
+ * @param queue
+ *   Tx queue identifier.
+ */
+void rte_bpf_eth_tx_unload(uint16_t port, uint16_t queue);
+
+/**
+ * Load a program from an ELF file and attach it to the Rx path of a queue.
+ *
+ * @param port
+ *   Port identifier.
+ * @param queue
+ *   Rx queue identifier.
+ * @param prm
+ *   Program parameters, see rte_bpf_elf_load().
+ * @param fname
+ *   Path of the ELF file.
+ * @param sname
+ *   Name of the section holding the program.
+ * @param flags
+ *   RTE_BPF_ETH_F_* flags.
+ * @return
+ *   0 on success, negative errno value on error; -ENOTSUP when
+ *   RTE_BPF_ETH_F_JIT is requested and no native code could be generated.
+ */
+int rte_bpf_eth_rx_elf_load(uint16_t port, uint16_t queue,
+	const struct rte_bpf_prm *prm, const char *fname, const char *sname,
+	uint32_t flags);
+
+/**
+ * Load a program from an ELF file and attach it to the Tx path of a queue.
+ *
+ * @param port
+ *   Port identifier.
+ * @param queue
+ *   Tx queue identifier.
+ * @param prm
+ *   Program parameters, see rte_bpf_elf_load().
+ * @param fname
+ *   Path of the ELF file.
+ * @param sname
+ *   Name of the section holding the program.
+ * @param flags
+ *   RTE_BPF_ETH_F_* flags.
+ * @return
+ *   0 on success, negative errno value on error; -ENOTSUP when
+ *   RTE_BPF_ETH_F_JIT is requested and no native code could be generated.
+ */
+int rte_bpf_eth_tx_elf_load(uint16_t port, uint16_t queue,
+	const struct rte_bpf_prm *prm, const char *fname, const char *sname,
+	uint32_t flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_BPF_ETHDEV_H_ */
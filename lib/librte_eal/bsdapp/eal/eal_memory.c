@@ -203,3 +203,39 @@ rte_eal_using_phys_addrs(void)
 {
 	return 0;
 }
+
+/* contigmem is mapped as a whole, there is no memory hotplug on FreeBSD */
+void
+eal_memory_hotplug_lock(void)
+{
+}
+
+void
+eal_memory_hotplug_unlock(void)
+{
+}
+
+void
+eal_memory_hotplug_sync(void)
+{
+}
+
+unsigned int
+eal_memory_hotplug_page_sizes(uint64_t page_sz[] __rte_unused,
+		unsigned int n __rte_unused)
+{
+	return 0;
+}
+
+int
+eal_memory_hotplug_grow(int socket_id __rte_unused,
+		uint64_t page_sz __rte_unused, size_t size __rte_unused)
+{
+	return -1;
+}
+
+int
+eal_memory_hotplug_release(unsigned int ms_idx __rte_unused)
+{
+	return -1;
+}
@@ -368,6 +368,9 @@ rte_memzone_lookup(const char *name)
 
 	mcfg = rte_eal_get_configuration()->mem_config;
 
+	/* map the memory the memzone may be in */
+	eal_memory_hotplug_sync();
+
 	rte_rwlock_read_lock(&mcfg->mlock);
 
 	memzone = memzone_lookup_thread_unsafe(name);
@@ -84,9 +84,29 @@ eal_hugepage_info_path(void)
 	return buffer;
 }
 
+/** Path of memory hotplug info file. */
+#define HOTPLUG_INFO_FMT "%s/.%s_hotplug_info"
+
+static inline const char *
+eal_hotplug_info_path(void)
+{
+	static char buffer[PATH_MAX]; /* static so auto-zeroed */
+	const char *directory = default_config_dir;
+	const char *home_dir = getenv("HOME");
+
+	if (getuid() != 0 && home_dir != NULL)
+		directory = home_dir;
+	snprintf(buffer, sizeof(buffer) - 1, HOTPLUG_INFO_FMT, directory,
+			internal_config.hugefile_prefix);
+	return buffer;
+}
+
 /** String format for hugepage map files. */
 #define HUGEFILE_FMT "%s/%smap_%d"
 #define TEMP_HUGEFILE_FMT "%s/%smap_temp_%d"
+/** String format for hugepage files mapped on demand, by area and page. */
+#define HOTPLUG_HUGEFILE_FMT "%s/%smap_hp%u_%u"
+#define TEMP_HOTPLUG_HUGEFILE_FMT "%s/%smap_hp%u_temp_%u"
 
 static inline const char *
 eal_get_hugefile_path(char *buffer, size_t buflen, const char *hugedir, int f_id)
@@ -212,6 +212,76 @@ int rte_eal_hugepage_init(void);
  */
 int rte_eal_hugepage_attach(void);
 
+/**
+ * Lock the memory hotplug state for a change of the memsegs, after
+ * mapping the memory other processes added and unmapping what they
+ * released. Nothing is done if memory is not hotplugged.
+ *
+ * This function is private to the EAL.
+ */
+void eal_memory_hotplug_lock(void);
+
+/**
+ * Unlock the memory hotplug state.
+ *
+ * This function is private to the EAL.
+ */
+void eal_memory_hotplug_unlock(void);
+
+/**
+ * Map the memory other processes added and unmap what they released,
+ * if there was any change since the last call.
+ *
+ * This function is private to the EAL.
+ */
+void eal_memory_hotplug_sync(void);
+
+/**
+ * Get the hugepage sizes memory can be hotplugged with.
+ *
+ * This function is private to the EAL.
+ *
+ * @param page_sz
+ *   Array filled with the page sizes, largest first.
+ * @param n
+ *   Number of entries in the array.
+ * @return
+ *   The number of page sizes stored.
+ */
+unsigned int eal_memory_hotplug_page_sizes(uint64_t page_sz[], unsigned int n);
+
+/**
+ * Map hugepages on a socket and add memsegs for them, at the end of the
+ * memseg array. Pages are mapped in chunks, that can be bigger than
+ * asked for. The memory hotplug state must be locked.
+ *
+ * This function is private to the EAL.
+ *
+ * @param socket_id
+ *   Socket to map the pages on.
+ * @param page_sz
+ *   Size of the pages.
+ * @param size
+ *   Length one of the new memsegs must have at least.
+ * @return
+ *   Index of the first new memseg, negative on error.
+ */
+int eal_memory_hotplug_grow(int socket_id, uint64_t page_sz, size_t size);
+
+/**
+ * Unmap the hugepages of a memseg nothing is allocated in, the memseg
+ * itself is left for the caller to remove. The memory hotplug state
+ * must be locked.
+ *
+ * This function is private to the EAL.
+ *
+ * @param ms_idx
+ *   Index of the memseg.
+ * @return
+ *   0 on success, negative if the memseg must be kept.
+ */
+int eal_memory_hotplug_release(unsigned int ms_idx);
+
 /**
  * Find a bus capable of identifying a device.
  *
@@ -191,8 +191,8 @@ malloc_elem_free_list_insert(struct malloc_elem *elem)
 /*
  * Remove the specified element from its heap's free list.
  */
-static void
-elem_free_list_remove(struct malloc_elem *elem)
+void
+malloc_elem_free_list_remove(struct malloc_elem *elem)
 {
 	LIST_REMOVE(elem, free_list);
 }
@@ -212,7 +212,7 @@ malloc_elem_alloc(struct malloc_elem *elem, size_t size, unsigned align,
 	const size_t trailer_size = elem->size - old_elem_size - size -
 		MALLOC_ELEM_OVERHEAD;
 
-	elem_free_list_remove(elem);
+	malloc_elem_free_list_remove(elem);
 
 	if (trailer_size > MALLOC_ELEM_OVERHEAD + MIN_DATA_SIZE) {
 		/* split it, too much free space after elem */
@@ -252,6 +252,17 @@ malloc_elem_alloc(struct malloc_elem *elem, size_t size, unsigned align,
 	return new_elem;
 }
 
+/*
+ * check if an element spans its whole memseg
+ */
+int
+malloc_elem_is_memseg(const struct malloc_elem *elem)
+{
+	const struct malloc_elem *next = RTE_PTR_ADD(elem, elem->size);
+
+	return elem->prev == NULL && next->size == 0;
+}
+
 /*
  * join two struct malloc_elem together. elem1 and elem2 must
  * be contiguous in memory.
@@ -267,11 +278,14 @@ join_elem(struct malloc_elem *elem1, struct malloc_elem *elem2)
 /*
  * free a malloc_elem block by adding it to the free list. If the
  * blocks either immediately before or immediately after newly freed block
- * are also free, the blocks are merged together.
+ * are also free, the blocks are merged together. Returns 1 if the block
+ * then spans its whole memseg.
  */
 int
 malloc_elem_free(struct malloc_elem *elem)
 {
+	int ret;
+
 	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY)
 		return -1;
 
@@ -281,7 +295,7 @@ malloc_elem_free(struct malloc_elem *elem)
 	struct malloc_elem *next = RTE_PTR_ADD(elem, elem->size);
 	if (next->state == ELEM_FREE){
 		/* remove from free list, join to this one */
-		elem_free_list_remove(next);
+		malloc_elem_free_list_remove(next);
 		join_elem(elem, next);
 		sz += (sizeof(*elem) + MALLOC_ELEM_TRAILER_LEN);
 	}
@@ -290,7 +304,7 @@ malloc_elem_free(struct malloc_elem *elem)
 	 * need to re-insert in free list, as that element's size is changing
 	 */
 	if (elem->prev != NULL && elem->prev->state == ELEM_FREE) {
-		elem_free_list_remove(elem->prev);
+		malloc_elem_free_list_remove(elem->prev);
 		join_elem(elem->prev, elem);
 		sz += (sizeof(*elem) + MALLOC_ELEM_TRAILER_LEN);
 		ptr -= (sizeof(*elem) + MALLOC_ELEM_TRAILER_LEN);
@@ -303,9 +317,10 @@ malloc_elem_free(struct malloc_elem *elem)
 
 	memset(ptr, 0, sz);
 
+	ret = malloc_elem_is_memseg(elem);
 	rte_spinlock_unlock(&(elem->heap->lock));
 
-	return 0;
+	return ret;
 }
 
 /*
@@ -330,7 +345,7 @@ malloc_elem_resize(struct malloc_elem *elem, size_t size)
 	/* we now know the element fits, so remove from free list,
 	 * join the two
 	 */
-	elem_free_list_remove(next);
+	malloc_elem_free_list_remove(next);
 	join_elem(elem, next);
 
 	if (elem->size - new_size >= MIN_DATA_SIZE + MALLOC_ELEM_OVERHEAD) {
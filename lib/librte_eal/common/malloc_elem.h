@@ -165,7 +165,8 @@ malloc_elem_alloc(struct malloc_elem *elem, size_t size,
 /*
  * free a malloc_elem block by adding it to the free list. If the
  * blocks either immediately before or immediately after newly freed block
- * are also free, the blocks are merged together.
+ * are also free, the blocks are merged together. Returns 1 if the block
+ * then spans its whole memseg.
  */
 int
 malloc_elem_free(struct malloc_elem *elem);
@@ -189,4 +190,16 @@ malloc_elem_free_list_index(size_t size);
 void
 malloc_elem_free_list_insert(struct malloc_elem *elem);
 
+/*
+ * Remove element from its heap's free list.
+ */
+void
+malloc_elem_free_list_remove(struct malloc_elem *elem);
+
+/*
+ * check if an element spans its whole memseg
+ */
+int
+malloc_elem_is_memseg(const struct malloc_elem *elem);
+
 #endif /* MALLOC_ELEM_H_ */
@@ -50,6 +50,8 @@
 #include <rte_memcpy.h>
 #include <rte_atomic.h>
 
+#include "eal_internal_cfg.h"
+#include "eal_private.h"
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 
@@ -145,6 +147,69 @@ find_suitable_element(struct malloc_heap *heap, size_t size,
 	return NULL;
 }
 
+static struct malloc_elem *
+heap_alloc(struct malloc_heap *heap, size_t size, unsigned flags,
+		size_t align, size_t bound)
+{
+	struct malloc_elem *elem;
+
+	rte_spinlock_lock(&heap->lock);
+
+	elem = find_suitable_element(heap, size, flags, align, bound);
+	if (elem != NULL) {
+		elem = malloc_elem_alloc(elem, size, align, bound);
+		/* increase heap's count of allocated elements */
+		heap->alloc_count++;
+	}
+	rte_spinlock_unlock(&heap->lock);
+
+	return elem;
+}
+
+/*
+ * Map memory for a block which doesn't fit in the heap, and add it to the
+ * heap. Called with the memory hotplug lock held.
+ */
+static int
+malloc_heap_grow(struct malloc_heap *heap, size_t size, unsigned flags,
+		size_t align, size_t bound)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	uint64_t page_sz[MAX_HUGEPAGE_SIZES];
+	struct rte_memseg *ms;
+	int socket = heap - mcfg->malloc_heaps;
+	unsigned int i, n, pass;
+	int first = -1;
+
+	/* twice the size has a block of it on one side of a boundary */
+	if (bound != 0)
+		size *= 2;
+	size += align + 3 * MALLOC_ELEM_OVERHEAD;
+
+	/* page sizes matching the flags first, any other if it's a hint */
+	n = eal_memory_hotplug_page_sizes(page_sz, RTE_DIM(page_sz));
+	for (pass = 0; pass < 2 && first < 0; pass++) {
+		if (pass == 1 && !(flags & RTE_MEMZONE_SIZE_HINT_ONLY))
+			break;
+		for (i = 0; i < n && first < 0; i++) {
+			if (!!check_hugepage_sz(flags, page_sz[i]) == pass)
+				continue;
+			first = eal_memory_hotplug_grow(socket, page_sz[i],
+					size);
+		}
+	}
+	if (first < 0)
+		return -1;
+
+	rte_spinlock_lock(&heap->lock);
+	for (ms = &mcfg->memseg[first];
+			ms < &mcfg->memseg[RTE_MAX_MEMSEG] && ms->len > 0; ms++)
+		malloc_heap_add_memseg(heap, ms);
+	rte_spinlock_unlock(&heap->lock);
+
+	return 0;
+}
+
 /*
  * Main function to allocate a block of memory from the heap.
  * It locks the free list, scans it, and adds a new memseg if the
@@ -161,17 +226,135 @@ malloc_heap_alloc(struct malloc_heap *heap,
 	size = RTE_CACHE_LINE_ROUNDUP(size);
 	align = RTE_CACHE_LINE_ROUNDUP(align);
 
+	eal_memory_hotplug_sync();
+
+	elem = heap_alloc(heap, size, flags, align, bound);
+	if (elem == NULL && internal_config.mem_hotplug) {
+		eal_memory_hotplug_lock();
+		/* the heap may have grown while waiting for the lock */
+		elem = heap_alloc(heap, size, flags, align, bound);
+		if (elem == NULL && malloc_heap_grow(heap, size, flags, align,
+				bound) == 0)
+			elem = heap_alloc(heap, size, flags, align, bound);
+		eal_memory_hotplug_unlock();
+	}
+
+	return elem == NULL ? NULL : (void *)(&elem[1]);
+}
+
+/*
+ * Give a memseg the slot of another, and update what refers to it.
+ */
+static void
+malloc_heap_move_memseg(struct rte_mem_config *mcfg, unsigned int from,
+		unsigned int to)
+{
+	struct rte_memseg *ms = &mcfg->memseg[to];
+	struct malloc_elem *elem;
+	struct malloc_heap *heap;
+	unsigned int i;
+
+	*ms = mcfg->memseg[from];
+
+	elem = ms->addr;
+	heap = elem->heap;
 	rte_spinlock_lock(&heap->lock);
+	for (; elem->size != 0; elem = RTE_PTR_ADD(elem, elem->size))
+		elem->ms = ms;
+	elem->ms = ms;
+	rte_spinlock_unlock(&heap->lock);
 
-	elem = find_suitable_element(heap, size, flags, align, bound);
-	if (elem != NULL) {
-		elem = malloc_elem_alloc(elem, size, align, bound);
-		/* increase heap's count of allocated elements */
-		heap->alloc_count++;
+	for (i = 0; i < RTE_MAX_MEMZONE; i++)
+		if (mcfg->memzone[i].addr != NULL &&
+				mcfg->memzone[i].memseg_id == from)
+			mcfg->memzone[i].memseg_id = to;
+
+	memset(&mcfg->memseg[from], 0, sizeof(mcfg->memseg[from]));
+}
+
+/*
+ * Unmap a memseg nothing is allocated from anymore. The memseg array
+ * stays packed: the last memseg takes the place of the released one.
+ */
+static void
+malloc_heap_release(uint64_t addr)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct rte_memseg *ms = mcfg->memseg;
+	struct malloc_elem *elem;
+	struct malloc_heap *heap;
+	unsigned int i, last;
+	size_t size;
+
+	rte_rwlock_write_lock(&mcfg->mlock);
+	eal_memory_hotplug_lock();
+
+	for (i = 0; i < RTE_MAX_MEMSEG && ms[i].len > 0; i++)
+		if (ms[i].addr_64 == addr)
+			break;
+	if (i == RTE_MAX_MEMSEG || ms[i].len == 0)
+		goto out;
+
+	/* it may have been allocated from since it was freed */
+	elem = ms[i].addr;
+	heap = elem->heap;
+	rte_spinlock_lock(&heap->lock);
+	if (elem->state != ELEM_FREE || !malloc_elem_is_memseg(elem)) {
+		rte_spinlock_unlock(&heap->lock);
+		goto out;
 	}
+	malloc_elem_free_list_remove(elem);
+	elem->state = ELEM_BUSY;
+	size = elem->size;
 	rte_spinlock_unlock(&heap->lock);
 
-	return elem == NULL ? NULL : (void *)(&elem[1]);
+	if (eal_memory_hotplug_release(i) < 0) {
+		rte_spinlock_lock(&heap->lock);
+		malloc_elem_free_list_insert(elem);
+		rte_spinlock_unlock(&heap->lock);
+		goto out;
+	}
+
+	rte_spinlock_lock(&heap->lock);
+	heap->total_size -= size;
+	rte_spinlock_unlock(&heap->lock);
+
+	for (last = i; last + 1 < RTE_MAX_MEMSEG && ms[last + 1].len > 0;
+			last++)
+		;
+	if (last != i)
+		malloc_heap_move_memseg(mcfg, last, i);
+	else
+		memset(&ms[i], 0, sizeof(ms[i]));
+
+out:
+	eal_memory_hotplug_unlock();
+	rte_rwlock_write_unlock(&mcfg->mlock);
+}
+
+/*
+ * Free a block, and with memory hotplug, release its memseg if nothing
+ * else is allocated from it.
+ */
+int
+malloc_heap_free(struct malloc_elem *elem)
+{
+	uint64_t addr;
+	int ret;
+
+	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY)
+		return -1;
+
+	eal_memory_hotplug_sync();
+
+	addr = elem->ms->addr_64;
+	ret = malloc_elem_free(elem);
+	if (ret < 0)
+		return -1;
+
+	if (ret == 1 && internal_config.mem_hotplug)
+		malloc_heap_release(addr);
+	return 0;
 }
 
 /*
@@ -41,6 +41,8 @@
 extern "C" {
 #endif
 
+struct malloc_elem;
+
 static inline unsigned
 malloc_get_numa_socket(void)
 {
@@ -56,6 +58,9 @@ void *
 malloc_heap_alloc(struct malloc_heap *heap,	const char *type, size_t size,
 		unsigned flags, size_t align, size_t bound);
 
+int
+malloc_heap_free(struct malloc_elem *elem);
+
 int
 malloc_heap_get_stats(struct malloc_heap *heap,
 		struct rte_malloc_socket_stats *socket_stats);
@@ -366,6 +366,7 @@ eal_usage(const char *prgname)
 	       "  --"OPT_BASE_VIRTADDR"     Base virtual address\n"
 	       "  --"OPT_CREATE_UIO_DEV"    Create /dev/uioX (usually done by hotplug)\n"
 	       "  --"OPT_VFIO_INTR"         Interrupt mode for VFIO (legacy|msi|msix)\n"
+	       "  --"OPT_MEM_HOTPLUG"       Map and release hugepages on demand\n"
 	       "\n");
 	/* Allow the application to print its usage message too if hook is set */
 	if ( rte_application_usage_hook ) {
@@ -612,6 +613,10 @@ eal_parse_args(int argc, char **argv)
 			internal_config.mbuf_pool_ops_name = optarg;
 			break;
 
+		case OPT_MEM_HOTPLUG_NUM:
+			internal_config.mem_hotplug = 1;
+			break;
+
 		default:
 			if (opt < OPT_LONG_MIN_NUM && isprint(opt)) {
 				RTE_LOG(ERR, EAL, "Option %c is not supported "
@@ -643,6 +648,24 @@ eal_parse_args(int argc, char **argv)
 		goto out;
 	}
 
+	if (internal_config.mem_hotplug && (internal_config.no_hugetlbfs ||
+			internal_config.hugepage_unlink)) {
+		RTE_LOG(ERR, EAL, "Option --"OPT_MEM_HOTPLUG" cannot be "
+			"specified together with --"OPT_NO_HUGE" or --"
+			OPT_HUGE_UNLINK"\n");
+		eal_usage(prgname);
+		ret = -1;
+		goto out;
+	}
+#ifndef RTE_ARCH_64
+	if (internal_config.mem_hotplug) {
+		RTE_LOG(ERR, EAL, "Option --"OPT_MEM_HOTPLUG" is only "
+			"supported on 64-bit systems\n");
+		ret = -1;
+		goto out;
+	}
+#endif
+
 	if (optind >= 0)
 		argv[optind-1] = prgname;
 	ret = optind-1;
@@ -894,7 +917,9 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
-	eal_check_mem_on_local_socket();
+	/* with memory hotplug, memory is mapped on the socket it's asked for */
+	if (!internal_config.mem_hotplug)
+		eal_check_mem_on_local_socket();
 
 	eal_thread_init_master(rte_config.master_lcore);
 
@@ -50,6 +50,7 @@
 #include <limits.h>
 #include <sys/ioctl.h>
 #include <sys/time.h>
+#include <time.h>
 #include <signal.h>
 #include <setjmp.h>
 #ifdef RTE_EAL_NUMA_AWARE_HUGEPAGES
@@ -66,11 +67,14 @@
 #include <rte_lcore.h>
 #include <rte_common.h>
 #include <rte_string_fns.h>
+#include <rte_rwlock.h>
+#include <rte_spinlock.h>
 
 #include "eal_private.h"
 #include "eal_internal_cfg.h"
 #include "eal_filesystem.h"
 #include "eal_hugepages.h"
+#include "eal_vfio.h"
 
 #define PFN_MASK_SIZE	8
 
@@ -997,6 +1001,998 @@ huge_recover_sigbus(void)
 	}
 }
 
+/*
+ * Memory hotplug
+ *
+ * With --mem-hotplug, hugepages are mapped when the malloc heap needs
+ * them, instead of all at once during init. A virtual area is reserved
+ * for each socket and page size, and the heap grows into it by chunks:
+ * the pages of a chunk are mapped, sorted by physical address like at
+ * init, and made into one memseg per IOVA contiguous run. Once nothing
+ * is allocated in a memseg anymore, its pages are unmapped and their
+ * files removed. Only the memory asked for with -m or --socket-mem is
+ * mapped during init, and it is never released.
+ *
+ * Memsegs are shared through the memory config as usual, the rest of
+ * the state is in a shared file, in place of the hugepage table. Any
+ * process can add or release memory under the hotplug lock, and every
+ * change bumps a generation number. Processes map and unmap pages to
+ * match the memsegs when they see a new generation: before a change of
+ * their own, on entry to the malloc and memzone API, and on a fault in a
+ * hotplug area. A released virtual range is only reused once all live
+ * processes have caught up with the release, so that none of them can
+ * still see the old pages there.
+ */
+
+#define HOTPLUG_MAX_AREAS (RTE_MAX_NUMA_NODES * MAX_HUGEPAGE_SIZES)
+#define HOTPLUG_MAX_PROCS 64
+/* minimum size of the chunks mapped to grow the heap */
+#define HOTPLUG_CHUNK_MIN (32ULL << 20)
+/* areas are bigger than the hugepages, to leave room for fragmentation */
+#define HOTPLUG_AREA_FACTOR 2
+
+/* virtual area reserved for the pages of a socket and page size */
+struct hotplug_area {
+	uint64_t addr;
+	uint64_t len;
+	uint64_t page_sz;
+	int32_t socket_id;
+	uint32_t dir_idx;       /* index of the hugepage directory */
+};
+
+/* process mapping hotplugged memory */
+struct hotplug_proc {
+	volatile int32_t pid;   /* 0 for a free entry */
+	volatile uint32_t gen;  /* generation of the memsegs it maps */
+};
+
+/* released range, processes may still map it until they see gen */
+struct hotplug_stale {
+	uint64_t addr;
+	uint64_t len;
+	uint32_t gen;
+};
+
+/* shared state of memory hotplug */
+struct hotplug_config {
+	rte_rwlock_t lock;
+	volatile uint32_t gen;  /* changes of the memsegs */
+	uint32_t nb_pinned;     /* memsegs mapped during init, never released */
+	uint32_t nb_areas;
+	uint32_t nb_stale;
+	struct hotplug_area area[HOTPLUG_MAX_AREAS];
+	struct hotplug_proc proc[HOTPLUG_MAX_PROCS];
+	struct hotplug_stale stale[RTE_MAX_MEMSEG];
+	char hugedir[MAX_HUGEPAGE_SIZES][PATH_MAX];
+};
+
+/* memseg mapped by this process */
+struct hotplug_map {
+	void *addr;
+	uint64_t len;
+};
+
+/* page of a chunk being mapped */
+struct hotplug_page {
+	rte_iova_t iova;
+	unsigned int idx;       /* index in the chunk when it was mapped */
+};
+
+static struct hotplug_config *hotplug; /* NULL without memory hotplug */
+static struct hotplug_map hotplug_maps[RTE_MAX_MEMSEG];
+static unsigned int hotplug_nb_maps;
+static uint32_t hotplug_gen;           /* generation mapped */
+static unsigned int hotplug_proc_idx;
+static rte_spinlock_t hotplug_sync_lock = RTE_SPINLOCK_INITIALIZER;
+static struct sigaction hotplug_segv_old;
+#ifdef RTE_EAL_NUMA_AWARE_HUGEPAGES
+static int hotplug_numa;
+#endif
+
+static void
+hotplug_file_path(char *buf, size_t len, const struct hotplug_area *a,
+		uint64_t addr)
+{
+	snprintf(buf, len, HOTPLUG_HUGEFILE_FMT, hotplug->hugedir[a->dir_idx],
+		internal_config.hugefile_prefix,
+		(unsigned int)(a - hotplug->area),
+		(unsigned int)((addr - a->addr) / a->page_sz));
+}
+
+static void
+hotplug_temp_path(char *buf, size_t len, const struct hotplug_area *a,
+		unsigned int idx)
+{
+	snprintf(buf, len, TEMP_HOTPLUG_HUGEFILE_FMT,
+		hotplug->hugedir[a->dir_idx], internal_config.hugefile_prefix,
+		(unsigned int)(a - hotplug->area), idx);
+}
+
+/* replace a range with inaccessible, reserved address space */
+static void
+hotplug_reserve(uint64_t addr, uint64_t len)
+{
+	if (mmap((void *)(uintptr_t)addr, len, PROT_NONE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED,
+			-1, 0) == MAP_FAILED)
+		RTE_LOG(ERR, EAL, "Cannot reserve [0x%" PRIx64 ", 0x%" PRIx64
+			"): %s\n", addr, addr + len, strerror(errno));
+}
+
+static struct hotplug_area *
+hotplug_area_of(uint64_t addr)
+{
+	unsigned int i;
+
+	for (i = 0; i < hotplug->nb_areas; i++)
+		if (addr - hotplug->area[i].addr < hotplug->area[i].len)
+			return &hotplug->area[i];
+	return NULL;
+}
+
+static struct hotplug_area *
+hotplug_area_get(int socket_id, uint64_t page_sz)
+{
+	unsigned int i;
+
+	for (i = 0; i < hotplug->nb_areas; i++)
+		if (hotplug->area[i].socket_id == socket_id &&
+				hotplug->area[i].page_sz == page_sz)
+			return &hotplug->area[i];
+	return NULL;
+}
+
+static int
+hotplug_map_lookup(const void *addr, uint64_t len)
+{
+	unsigned int i;
+
+	for (i = 0; i < hotplug_nb_maps; i++)
+		if (hotplug_maps[i].addr == addr && hotplug_maps[i].len == len)
+			return i;
+	return -1;
+}
+
+static void
+hotplug_map_add(void *addr, uint64_t len)
+{
+	hotplug_maps[hotplug_nb_maps].addr = addr;
+	hotplug_maps[hotplug_nb_maps].len = len;
+	hotplug_nb_maps++;
+}
+
+/* unmap pages and remove their files, the range stays reserved */
+static void
+hotplug_unmap_pages(const struct hotplug_area *a, uint64_t addr, uint64_t len)
+{
+	char path[PATH_MAX];
+	uint64_t off;
+
+	hotplug_reserve(addr, len);
+	for (off = 0; off < len; off += a->page_sz) {
+		hotplug_file_path(path, sizeof(path), a, addr + off);
+		unlink(path);
+	}
+}
+
+/* map the pages of a memseg another process added */
+static int
+hotplug_map_seg(const struct rte_memseg *ms)
+{
+	const struct hotplug_area *a = hotplug_area_of(ms->addr_64);
+	char path[PATH_MAX];
+	uint64_t off;
+	void *va;
+	int fd;
+
+	if (a == NULL)
+		return -1;
+
+	for (off = 0; off < ms->len; off += a->page_sz) {
+		hotplug_file_path(path, sizeof(path), a, ms->addr_64 + off);
+		fd = open(path, O_RDWR);
+		if (fd < 0)
+			break;
+		va = mmap(RTE_PTR_ADD(ms->addr, off), a->page_sz,
+			PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+		/* the lock stays as long as the page is mapped */
+		if (va == MAP_FAILED || flock(fd, LOCK_SH | LOCK_NB) == -1) {
+			close(fd);
+			break;
+		}
+		close(fd);
+	}
+	if (off < ms->len) {
+		RTE_LOG(ERR, EAL, "Could not map %s: %s\n", path,
+			strerror(errno));
+		hotplug_reserve(ms->addr_64, ms->len);
+		return -1;
+	}
+
+	hotplug_map_add(ms->addr, ms->len);
+	return 0;
+}
+
+/* map and unmap pages to match the memsegs, under the hotplug lock */
+static void
+hotplug_sync_locked(void)
+{
+	const struct rte_mem_config *mcfg =
+		rte_eal_get_configuration()->mem_config;
+	const struct rte_memseg *ms = mcfg->memseg;
+	uint32_t gen = hotplug->gen;
+	unsigned int i, j;
+	int ret = 0;
+
+	if (gen == hotplug_gen)
+		return;
+
+	/* unmap what was released */
+	for (i = 0; i < hotplug_nb_maps; ) {
+		for (j = 0; j < RTE_MAX_MEMSEG && ms[j].addr != NULL; j++)
+			if (ms[j].addr == hotplug_maps[i].addr &&
+					ms[j].len == hotplug_maps[i].len)
+				break;
+		if (j < RTE_MAX_MEMSEG && ms[j].addr != NULL) {
+			i++;
+			continue;
+		}
+		hotplug_reserve((uintptr_t)hotplug_maps[i].addr,
+			hotplug_maps[i].len);
+		hotplug_maps[i] = hotplug_maps[--hotplug_nb_maps];
+	}
+
+	/* map what was added */
+	for (j = 0; j < RTE_MAX_MEMSEG && ms[j].addr != NULL; j++)
+		if (hotplug_map_lookup(ms[j].addr, ms[j].len) < 0 &&
+				hotplug_map_seg(&ms[j]) < 0)
+			ret = -1;
+
+	/* what could not be mapped is tried again next time */
+	if (ret == 0)
+		hotplug_gen = gen;
+	hotplug->proc[hotplug_proc_idx].gen = gen;
+}
+
+void
+eal_memory_hotplug_sync(void)
+{
+	if (hotplug == NULL || hotplug->gen == hotplug_gen)
+		return;
+
+	rte_rwlock_read_lock(&hotplug->lock);
+	rte_spinlock_lock(&hotplug_sync_lock);
+	hotplug_sync_locked();
+	rte_spinlock_unlock(&hotplug_sync_lock);
+	rte_rwlock_read_unlock(&hotplug->lock);
+}
+
+void
+eal_memory_hotplug_lock(void)
+{
+	if (hotplug == NULL)
+		return;
+
+	rte_rwlock_write_lock(&hotplug->lock);
+	hotplug_sync_locked();
+}
+
+void
+eal_memory_hotplug_unlock(void)
+{
+	if (hotplug != NULL)
+		rte_rwlock_write_unlock(&hotplug->lock);
+}
+
+unsigned int
+eal_memory_hotplug_page_sizes(uint64_t page_sz[], unsigned int n)
+{
+	unsigned int i, j, nb = 0;
+
+	if (hotplug == NULL)
+		return 0;
+
+	/* areas are in the order of the hugepage sizes, largest first */
+	for (i = 0; i < hotplug->nb_areas; i++) {
+		for (j = 0; j < nb; j++)
+			if (page_sz[j] == hotplug->area[i].page_sz)
+				break;
+		if (j == nb && nb < n)
+			page_sz[nb++] = hotplug->area[i].page_sz;
+	}
+	return nb;
+}
+
+/* new generation for a change made by this process */
+static uint32_t
+hotplug_gen_next(void)
+{
+	uint32_t gen = hotplug->gen + 1;
+
+	/* memsegs that could not be mapped are still to be synced */
+	if (hotplug_gen == hotplug->gen)
+		hotplug_gen = gen;
+	hotplug->gen = gen;
+	hotplug->proc[hotplug_proc_idx].gen = gen;
+	return gen;
+}
+
+static int
+hotplug_proc_alive(pid_t pid)
+{
+	return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+/* forget the released ranges all live processes have unmapped */
+static void
+hotplug_stale_gc(void)
+{
+	uint32_t gen = hotplug->gen;
+	unsigned int i;
+
+	for (i = 0; i < HOTPLUG_MAX_PROCS; i++) {
+		struct hotplug_proc *p = &hotplug->proc[i];
+
+		if (p->pid == 0)
+			continue;
+		if (!hotplug_proc_alive(p->pid)) {
+			p->pid = 0;
+			continue;
+		}
+		if ((int32_t)(p->gen - gen) < 0)
+			gen = p->gen;
+	}
+
+	for (i = 0; i < hotplug->nb_stale; ) {
+		if ((int32_t)(gen - hotplug->stale[i].gen) >= 0)
+			hotplug->stale[i] = hotplug->stale[--hotplug->nb_stale];
+		else
+			i++;
+	}
+}
+
+/* end of a memseg or stale range overlapping the given one, 0 if none */
+static uint64_t
+hotplug_range_busy(uint64_t addr, uint64_t len)
+{
+	const struct rte_memseg *ms =
+		rte_eal_get_configuration()->mem_config->memseg;
+	const struct hotplug_stale *s = hotplug->stale;
+	unsigned int i;
+
+	for (i = 0; i < RTE_MAX_MEMSEG && ms[i].addr != NULL; i++)
+		if (ms[i].addr_64 < addr + len &&
+				addr < ms[i].addr_64 + ms[i].len)
+			return ms[i].addr_64 + ms[i].len;
+	for (i = 0; i < hotplug->nb_stale; i++)
+		if (s[i].addr < addr + len && addr < s[i].addr + s[i].len)
+			return s[i].addr + s[i].len;
+	return 0;
+}
+
+static uint64_t
+hotplug_find_va(const struct hotplug_area *a, uint64_t len)
+{
+	uint64_t addr = a->addr;
+	uint64_t end;
+
+	while (addr + len <= a->addr + a->len) {
+		end = hotplug_range_busy(addr, len);
+		if (end == 0)
+			return addr;
+		addr = end;
+	}
+	return 0;
+}
+
+/* map a page with a temporary name, and get its IOVA */
+static int
+hotplug_map_page(const struct hotplug_area *a, void *va, unsigned int idx,
+		rte_iova_t *iova)
+{
+	char path[PATH_MAX];
+	int fd;
+
+	hotplug_temp_path(path, sizeof(path), a, idx);
+	fd = open(path, O_CREAT | O_RDWR, 0600);
+	if (fd < 0) {
+		RTE_LOG(DEBUG, EAL, "%s(): open failed: %s\n", __func__,
+			strerror(errno));
+		return -1;
+	}
+	if (mmap(va, a->page_sz, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		RTE_LOG(DEBUG, EAL, "%s(): mmap failed: %s\n", __func__,
+			strerror(errno));
+		goto fail;
+	}
+
+#ifdef RTE_EAL_NUMA_AWARE_HUGEPAGES
+	if (hotplug_numa) {
+		unsigned long nodemask = 1UL << a->socket_id;
+
+		if (mbind(va, a->page_sz, MPOL_BIND, &nodemask,
+				sizeof(nodemask) * CHAR_BIT, 0) < 0) {
+			RTE_LOG(DEBUG, EAL, "%s(): mbind failed: %s\n",
+				__func__, strerror(errno));
+			goto fail;
+		}
+	}
+#endif
+
+	/* hugetlb limits are enforced at fault time, see map_all_hugepages */
+	if (huge_wrap_sigsetjmp()) {
+		RTE_LOG(DEBUG, EAL, "SIGBUS: Cannot mmap more hugepages "
+			"of size %u MB on socket %d\n",
+			(unsigned int)(a->page_sz / 0x100000), a->socket_id);
+		goto fail;
+	}
+	*(int *)va = 0;
+
+	if (flock(fd, LOCK_SH | LOCK_NB) == -1) {
+		RTE_LOG(DEBUG, EAL, "%s(): Locking file failed: %s\n",
+			__func__, strerror(errno));
+		goto fail;
+	}
+	close(fd);
+
+	if (rte_eal_iova_mode() == RTE_IOVA_VA)
+		*iova = (uintptr_t)va;
+	else if (phys_addrs_available)
+		*iova = rte_mem_virt2phy(va);
+	else
+		*iova = RTE_BAD_IOVA;
+	return 0;
+
+fail:
+	hotplug_reserve((uintptr_t)va, a->page_sz);
+	close(fd);
+	unlink(path);
+	return -1;
+}
+
+static int
+hotplug_cmp_page(const void *a, const void *b)
+{
+	const struct hotplug_page *p = a;
+	const struct hotplug_page *q = b;
+
+	if (p->iova < q->iova)
+		return -1;
+	return p->iova > q->iova;
+}
+
+static int
+hotplug_page_contig(const struct hotplug_page *prev,
+		const struct hotplug_page *p, uint64_t page_sz)
+{
+	if (p->iova == RTE_BAD_IOVA)
+		return prev->iova == RTE_BAD_IOVA;
+	return p->iova == prev->iova + page_sz;
+}
+
+/*
+ * Map a chunk of len bytes on an area and add memsegs for it. Fewer pages
+ * may be left, but at least one memseg is min_len long. Without all_runs,
+ * only the longest run of contiguous pages is kept. Returns the index of
+ * the first new memseg.
+ */
+static int
+hotplug_grow(const struct hotplug_area *a, uint64_t min_len, uint64_t len,
+		int all_runs)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct rte_memseg *ms = mcfg->memseg;
+	struct rte_memseg *seg = NULL;
+	struct hotplug_page *pages;
+	char path[PATH_MAX], new_path[PATH_MAX];
+	unsigned int i, n, first, nb_segs, run, run_max, run_start;
+	uint64_t addr, page_sz = a->page_sz;
+	void *va;
+
+	hotplug_stale_gc();
+	addr = hotplug_find_va(a, len);
+	if (addr == 0 && len > min_len) {
+		len = min_len;
+		addr = hotplug_find_va(a, len);
+	}
+	if (addr == 0) {
+		RTE_LOG(DEBUG, EAL, "No room left for %" PRIu64 " MB on "
+			"socket %d\n", len >> 20, a->socket_id);
+		return -1;
+	}
+
+	for (first = 0; first < RTE_MAX_MEMSEG; first++)
+		if (ms[first].addr == NULL)
+			break;
+
+	n = len / page_sz;
+	pages = malloc(n * sizeof(*pages));
+	if (pages == NULL)
+		return -1;
+
+	huge_register_sigbus();
+	for (i = 0; i < n; i++) {
+		pages[i].idx = i;
+		if (hotplug_map_page(a, (void *)(uintptr_t)(addr + i * page_sz),
+				i, &pages[i].iova) < 0)
+			break;
+	}
+	huge_recover_sigbus();
+	n = i;
+
+	/* make runs of contiguous pages */
+	if (rte_eal_iova_mode() != RTE_IOVA_VA)
+		qsort(pages, n, sizeof(*pages), hotplug_cmp_page);
+
+	nb_segs = 0;
+	run = run_max = run_start = 0;
+	for (i = 0; i < n; i++) {
+		if (i == 0 || !hotplug_page_contig(&pages[i - 1], &pages[i],
+				page_sz)) {
+			nb_segs++;
+			run = 0;
+		}
+		if (++run > run_max) {
+			run_max = run;
+			run_start = i + 1 - run;
+		}
+	}
+
+	/*
+	 * When growing for an allocation, only keep the run it will be in,
+	 * the other pages would make memsegs nothing may ever be freed from.
+	 */
+	if (!all_runs && nb_segs > 1 && run_max * page_sz >= min_len) {
+		for (i = 0; i < n; i++) {
+			if (i - run_start < run_max)
+				continue;
+			hotplug_temp_path(path, sizeof(path), a, pages[i].idx);
+			unlink(path);
+		}
+		memmove(pages, &pages[run_start], run_max * sizeof(*pages));
+		n = run_max;
+		nb_segs = 1;
+	}
+
+	if (run_max * page_sz < min_len || first + nb_segs > RTE_MAX_MEMSEG) {
+		RTE_LOG(DEBUG, EAL, "Could not map %" PRIu64 " MB on "
+			"socket %d in %u memsegs\n", min_len >> 20,
+			a->socket_id, RTE_MAX_MEMSEG - first);
+		hotplug_reserve(addr, len);
+		for (i = 0; i < n; i++) {
+			hotplug_temp_path(path, sizeof(path), a, pages[i].idx);
+			unlink(path);
+		}
+		free(pages);
+		return -1;
+	}
+
+	/* give the pages their place in IOVA order, and their final name */
+	for (i = 0; i < n; i++) {
+		hotplug_temp_path(path, sizeof(path), a, pages[i].idx);
+		hotplug_file_path(new_path, sizeof(new_path), a,
+			addr + i * page_sz);
+		if (rename(path, new_path) < 0)
+			goto fail;
+	}
+	for (i = 0; i < n; i++) {
+		int fd;
+
+		if (pages[i].idx == i)
+			continue;
+		hotplug_file_path(path, sizeof(path), a, addr + i * page_sz);
+		fd = open(path, O_RDWR);
+		if (fd < 0)
+			goto fail;
+		va = mmap((void *)(uintptr_t)(addr + i * page_sz), page_sz,
+			PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+		if (va == MAP_FAILED || flock(fd, LOCK_SH | LOCK_NB) == -1) {
+			close(fd);
+			goto fail;
+		}
+		close(fd);
+	}
+	/* pages left out, if any, were mapped after those kept */
+	if (n * page_sz < len)
+		hotplug_reserve(addr + n * page_sz, len - n * page_sz);
+
+	for (i = 0; i < n; i++) {
+		if (i == 0 || !hotplug_page_contig(&pages[i - 1], &pages[i],
+				page_sz)) {
+			seg = seg == NULL ? &ms[first] : seg + 1;
+			seg->iova = pages[i].iova;
+			seg->addr_64 = addr + i * page_sz;
+			seg->len = 0;
+			seg->hugepage_sz = page_sz;
+			seg->socket_id = a->socket_id;
+		}
+		seg->len += page_sz;
+	}
+	free(pages);
+
+#ifdef VFIO_PRESENT
+	for (seg = &ms[first]; seg < &ms[first + nb_segs]; seg++) {
+		if (vfio_dma_mem_map(seg->addr_64, seg->iova, seg->len, 1) == 0)
+			continue;
+		while (seg-- != &ms[first])
+			vfio_dma_mem_map(seg->addr_64, seg->iova, seg->len, 0);
+		memset(&ms[first], 0, nb_segs * sizeof(ms[first]));
+		hotplug_unmap_pages(a, addr, n * page_sz);
+		return -1;
+	}
+#endif
+
+	for (i = first; i < first + nb_segs; i++)
+		hotplug_map_add(ms[i].addr, ms[i].len);
+	hotplug_gen_next();
+
+	RTE_LOG(DEBUG, EAL, "Mapped %u pages of %" PRIu64 " MB at %p on socket "
+		"%d, in %u memsegs\n", n, page_sz >> 20,
+		(void *)(uintptr_t)addr, a->socket_id, nb_segs);
+	return first;
+
+fail:
+	RTE_LOG(ERR, EAL, "Could not remap %s: %s\n", path, strerror(errno));
+	hotplug_reserve(addr, len);
+	for (i = 0; i < n; i++) {
+		hotplug_temp_path(path, sizeof(path), a, pages[i].idx);
+		unlink(path);
+		hotplug_file_path(path, sizeof(path), a, addr + i * page_sz);
+		unlink(path);
+	}
+	free(pages);
+	return -1;
+}
+
+int
+eal_memory_hotplug_grow(int socket_id, uint64_t page_sz, size_t size)
+{
+	const struct hotplug_area *a;
+	uint64_t len;
+
+	if (hotplug == NULL)
+		return -1;
+	a = hotplug_area_get(socket_id, page_sz);
+	if (a == NULL)
+		return -1;
+
+	len = RTE_ALIGN_CEIL(size, page_sz);
+	return hotplug_grow(a, len,
+		RTE_MAX(len, RTE_ALIGN_CEIL(HOTPLUG_CHUNK_MIN, page_sz)), 0);
+}
+
+int
+eal_memory_hotplug_release(unsigned int ms_idx)
+{
+	const struct rte_memseg *ms =
+		&rte_eal_get_configuration()->mem_config->memseg[ms_idx];
+	const struct hotplug_area *a;
+	struct hotplug_stale *s;
+	int i;
+
+	if (hotplug == NULL || ms_idx < hotplug->nb_pinned)
+		return -1;
+	a = hotplug_area_of(ms->addr_64);
+	if (a == NULL)
+		return -1;
+
+	/* keep the memory if the range could not be kept out of reuse */
+	hotplug_stale_gc();
+	if (hotplug->nb_stale == RTE_DIM(hotplug->stale))
+		return -1;
+
+#ifdef VFIO_PRESENT
+	vfio_dma_mem_map(ms->addr_64, ms->iova, ms->len, 0);
+#endif
+	hotplug_unmap_pages(a, ms->addr_64, ms->len);
+	i = hotplug_map_lookup(ms->addr, ms->len);
+	if (i >= 0)
+		hotplug_maps[i] = hotplug_maps[--hotplug_nb_maps];
+
+	s = &hotplug->stale[hotplug->nb_stale++];
+	s->addr = ms->addr_64;
+	s->len = ms->len;
+	s->gen = hotplug_gen_next();
+
+	RTE_LOG(DEBUG, EAL, "Released %" PRIu64 " MB at %p on socket %d\n",
+		ms->len >> 20, ms->addr, ms->socket_id);
+	return 0;
+}
+
+/*
+ * A fault in a hotplug area may be on memory another process added: map
+ * it and retry. Other faults go to the handler there was before.
+ */
+static void
+hotplug_sigsegv_handler(int signo __rte_unused, siginfo_t *info,
+		void *ctx __rte_unused)
+{
+	uint64_t addr = (uintptr_t)info->si_addr;
+	unsigned int i;
+
+	if (hotplug_area_of(addr) != NULL) {
+		eal_memory_hotplug_sync();
+
+		rte_spinlock_lock(&hotplug_sync_lock);
+		for (i = 0; i < hotplug_nb_maps; i++)
+			if (addr - (uintptr_t)hotplug_maps[i].addr <
+					hotplug_maps[i].len)
+				break;
+		rte_spinlock_unlock(&hotplug_sync_lock);
+		if (i < hotplug_nb_maps)
+			return;
+	}
+
+	sigaction(SIGSEGV, &hotplug_segv_old, NULL);
+}
+
+static int
+hotplug_register_sigsegv(void)
+{
+	struct sigaction action;
+
+	memset(&action, 0, sizeof(action));
+	sigemptyset(&action.sa_mask);
+	action.sa_flags = SA_SIGINFO;
+	action.sa_sigaction = hotplug_sigsegv_handler;
+
+	return sigaction(SIGSEGV, &action, &hotplug_segv_old);
+}
+
+static int
+hotplug_reserve_area(const struct hugepage_info *hpi, unsigned int dir_idx,
+		int socket_id)
+{
+	struct hotplug_area *a = &hotplug->area[hotplug->nb_areas];
+	size_t len = hpi->num_pages[0] * hpi->hugepage_sz *
+		HOTPLUG_AREA_FACTOR;
+	void *addr, *va;
+
+	addr = get_virtual_area(&len, hpi->hugepage_sz);
+	if (addr == NULL)
+		return -1;
+	va = mmap(addr, len, PROT_NONE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (va != addr) {
+		RTE_LOG(ERR, EAL, "Cannot reserve %zu bytes at %p\n", len,
+			addr);
+		if (va != MAP_FAILED)
+			munmap(va, len);
+		return -1;
+	}
+
+	a->addr = (uintptr_t)addr;
+	a->len = len;
+	a->page_sz = hpi->hugepage_sz;
+	a->socket_id = socket_id;
+	a->dir_idx = dir_idx;
+	hotplug->nb_areas++;
+	return 0;
+}
+
+/* map memory on a socket, largest pages first, returns what was mapped */
+static uint64_t
+hotplug_prealloc(int socket_id, uint64_t size)
+{
+	const struct rte_memseg *ms =
+		rte_eal_get_configuration()->mem_config->memseg;
+	const struct hotplug_area *a;
+	uint64_t done = 0, want;
+	unsigned int i, j;
+	int first;
+
+	for (i = 0; i < hotplug->nb_areas && done < size; i++) {
+		a = &hotplug->area[i];
+		if (a->socket_id != socket_id)
+			continue;
+
+		/* the smallest pages make up for the rest */
+		for (j = i + 1; j < hotplug->nb_areas; j++)
+			if (hotplug->area[j].socket_id == socket_id)
+				break;
+		if (j == hotplug->nb_areas)
+			want = RTE_ALIGN_CEIL(size - done, a->page_sz);
+		else
+			want = RTE_ALIGN_FLOOR(size - done, a->page_sz);
+
+		while (want > 0) {
+			first = hotplug_grow(a, a->page_sz, want, 1);
+			if (first < 0)
+				break;
+			for (; first < RTE_MAX_MEMSEG && ms[first].addr != NULL;
+					first++) {
+				done += ms[first].len;
+				want -= RTE_MIN(want, ms[first].len);
+			}
+		}
+	}
+	return done;
+}
+
+/*
+ * Reserve the hotplug areas, and map the memory asked for on the command
+ * line. Without NUMA support, all memory is on socket 0.
+ */
+static int
+eal_hotplug_init(void)
+{
+	const struct rte_memseg *ms =
+		rte_eal_get_configuration()->mem_config->memseg;
+	uint64_t memory[RTE_MAX_NUMA_NODES];
+	int sockets[RTE_MAX_NUMA_NODES] = { 0 };
+	unsigned int i, socket;
+	uint64_t done;
+
+	/* the hugepage table is not used, don't let secondaries find one */
+	unlink(eal_hugepage_info_path());
+
+	hotplug = create_shared_memory(eal_hotplug_info_path(),
+			sizeof(*hotplug));
+	if (hotplug == NULL) {
+		RTE_LOG(ERR, EAL, "Failed to create shared memory!\n");
+		return -1;
+	}
+	memset(hotplug, 0, sizeof(*hotplug));
+	rte_rwlock_init(&hotplug->lock);
+
+	sockets[0] = 1;
+#ifdef RTE_EAL_NUMA_AWARE_HUGEPAGES
+	hotplug_numa = numa_available() == 0;
+	for (i = 0; hotplug_numa && i < RTE_MAX_LCORE; i++)
+		if (lcore_config[i].detected &&
+				lcore_config[i].socket_id < RTE_MAX_NUMA_NODES)
+			sockets[lcore_config[i].socket_id] = 1;
+	for (i = 0; hotplug_numa && i < RTE_MAX_NUMA_NODES; i++)
+		if (internal_config.socket_mem[i] != 0)
+			sockets[i] = 1;
+#endif
+
+	for (i = 0; i < internal_config.num_hugepage_sizes; i++) {
+		const struct hugepage_info *hpi =
+			&internal_config.hugepage_info[i];
+
+		if (hpi->hugedir == NULL || hpi->num_pages[0] == 0)
+			continue;
+		snprintf(hotplug->hugedir[i], sizeof(hotplug->hugedir[i]),
+			"%s", hpi->hugedir);
+		for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++)
+			if (sockets[socket] &&
+					hotplug_reserve_area(hpi, i, socket) < 0)
+				goto fail;
+	}
+
+	hotplug->proc[0].pid = getpid();
+	hotplug_proc_idx = 0;
+	if (hotplug_register_sigsegv() < 0) {
+		RTE_LOG(ERR, EAL, "Cannot set up SIGSEGV handler: %s\n",
+			strerror(errno));
+		goto fail;
+	}
+
+	/* -m memory goes to the master lcore socket first */
+	memset(memory, 0, sizeof(memory));
+	if (internal_config.force_sockets) {
+		for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++)
+			memory[socket] = internal_config.socket_mem[socket];
+	} else {
+		socket = rte_lcore_to_socket_id(rte_get_master_lcore());
+		memory[socket < RTE_MAX_NUMA_NODES && sockets[socket] ?
+			socket : 0] = internal_config.memory;
+	}
+
+	for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++) {
+		if (memory[socket] == 0)
+			continue;
+		done = hotplug_prealloc(socket, memory[socket]);
+		if (done >= memory[socket])
+			continue;
+
+		/* spread -m memory over the other sockets */
+		for (i = 0; !internal_config.force_sockets &&
+				i < RTE_MAX_NUMA_NODES && done < memory[socket];
+				i++)
+			if (i != socket && sockets[i])
+				done += hotplug_prealloc(i,
+						memory[socket] - done);
+		if (done < memory[socket]) {
+			RTE_LOG(ERR, EAL, "Not enough memory available on "
+				"socket %u! Requested: %" PRIu64 "MB, "
+				"available: %" PRIu64 "MB\n", socket,
+				memory[socket] >> 20, done >> 20);
+			goto fail;
+		}
+	}
+
+	for (i = 0; i < RTE_MAX_MEMSEG && ms[i].addr != NULL; i++)
+		;
+	hotplug->nb_pinned = i;
+	return 0;
+
+fail:
+	for (i = 0; i < hotplug_nb_maps; i++)
+		hotplug_unmap_pages(hotplug_area_of(
+				(uintptr_t)hotplug_maps[i].addr),
+			(uintptr_t)hotplug_maps[i].addr, hotplug_maps[i].len);
+	for (i = 0; i < hotplug->nb_areas; i++)
+		munmap((void *)(uintptr_t)hotplug->area[i].addr,
+			hotplug->area[i].len);
+	munmap(hotplug, sizeof(*hotplug));
+	hotplug = NULL;
+	return -1;
+}
+
+/* map the hotplug areas and memsegs of the primary process */
+static int
+eal_hotplug_attach(int fd)
+{
+	const struct hotplug_area *a;
+	unsigned int i, nb_areas = 0;
+	void *va;
+
+	hotplug = mmap(NULL, sizeof(*hotplug), PROT_READ | PROT_WRITE,
+			MAP_SHARED, fd, 0);
+	close(fd);
+	if (hotplug == MAP_FAILED) {
+		RTE_LOG(ERR, EAL, "Could not mmap %s\n",
+			eal_hotplug_info_path());
+		hotplug = NULL;
+		return -1;
+	}
+	internal_config.mem_hotplug = 1;
+#ifdef RTE_EAL_NUMA_AWARE_HUGEPAGES
+	hotplug_numa = numa_available() == 0;
+#endif
+
+	for (nb_areas = 0; nb_areas < hotplug->nb_areas; nb_areas++) {
+		a = &hotplug->area[nb_areas];
+		va = mmap((void *)(uintptr_t)a->addr, a->len, PROT_NONE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (va == (void *)(uintptr_t)a->addr)
+			continue;
+		RTE_LOG(ERR, EAL, "Could not reserve %" PRIu64 " bytes at "
+			"[0x%" PRIx64 "] - please use '--base-virtaddr' "
+			"option\n", a->len, a->addr);
+		if (va != MAP_FAILED)
+			munmap(va, a->len);
+		goto error;
+	}
+
+	rte_rwlock_write_lock(&hotplug->lock);
+	for (i = 0; i < HOTPLUG_MAX_PROCS; i++)
+		if (hotplug->proc[i].pid == 0 ||
+				!hotplug_proc_alive(hotplug->proc[i].pid))
+			break;
+	if (i == HOTPLUG_MAX_PROCS) {
+		rte_rwlock_write_unlock(&hotplug->lock);
+		RTE_LOG(ERR, EAL, "Too many processes using memory hotplug\n");
+		goto error;
+	}
+	/* stale ranges were never mapped here */
+	hotplug->proc[i].pid = getpid();
+	hotplug->proc[i].gen = hotplug->gen;
+	hotplug_proc_idx = i;
+	hotplug_sync_locked();
+	rte_rwlock_write_unlock(&hotplug->lock);
+
+	if (hotplug_gen != hotplug->gen || hotplug_register_sigsegv() < 0) {
+		hotplug->proc[i].pid = 0;
+		goto error;
+	}
+	return 0;
+
+error:
+	for (i = 0; i < hotplug_nb_maps; i++)
+		munmap(hotplug_maps[i].addr, hotplug_maps[i].len);
+	hotplug_nb_maps = 0;
+	for (i = 0; i < nb_areas; i++)
+		munmap((void *)(uintptr_t)hotplug->area[i].addr,
+			hotplug->area[i].len);
+	munmap(hotplug, sizeof(*hotplug));
+	hotplug = NULL;
+	return -1;
+}
+
 /*
  * Prepare physical memory mapping: fill configuration structure with
  * these infos, return 0 on success.
@@ -1008,8 +2004,8 @@ huge_recover_sigbus(void)
  *  6. unmap the first mapping
  *  7. fill memsegs in configuration with contiguous zones
  */
-int
-rte_eal_hugepage_init(void)
+static int
+eal_legacy_hugepage_init(void)
 {
 	struct rte_mem_config *mcfg;
 	struct hugepage_file *hugepage = NULL, *tmp_hp = NULL;
@@ -1334,6 +2330,43 @@ rte_eal_hugepage_init(void)
 	return -1;
 }
 
+/*
+ * Map hugepages, all of them or only those asked for with memory hotplug,
+ * and report how long it took.
+ */
+int
+rte_eal_hugepage_init(void)
+{
+	const struct rte_memseg *ms =
+		rte_eal_get_configuration()->mem_config->memseg;
+	struct timespec start, end;
+	uint64_t size = 0;
+	unsigned int i;
+	int ret;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (internal_config.mem_hotplug) {
+		test_phys_addrs_available();
+		ret = eal_hotplug_init();
+	} else {
+		/* don't let secondaries find hotplug state of a previous run */
+		unlink(eal_hotplug_info_path());
+		ret = eal_legacy_hugepage_init();
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < RTE_MAX_MEMSEG && ms[i].addr != NULL; i++)
+		size += ms[i].len;
+	RTE_LOG(INFO, EAL, "Mapped %" PRIu64 " MB of memory%s in %" PRIu64
+		" ms\n", size >> 20,
+		internal_config.mem_hotplug ? " (hotplug)" : "",
+		(uint64_t)(end.tv_sec - start.tv_sec) * 1000 +
+		(end.tv_nsec - start.tv_nsec) / 1000000);
+	return 0;
+}
+
 /*
  * uses fstat to report the size of a file on disk
  */
@@ -1372,6 +2405,11 @@ rte_eal_hugepage_attach(void)
 
 	test_phys_addrs_available();
 
+	/* the primary process uses memory hotplug */
+	fd = open(eal_hotplug_info_path(), O_RDWR);
+	if (fd >= 0)
+		return eal_hotplug_attach(fd);
+
 	fd_zero = open("/dev/zero", O_RDONLY);
 	if (fd_zero < 0) {
 		RTE_LOG(ERR, EAL, "Could not open /dev/zero\n");
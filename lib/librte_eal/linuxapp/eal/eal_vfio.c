@@ -373,7 +373,12 @@ rte_vfio_setup_device(const char *sysfs_base, const char *dev_addr,
 				rte_vfio_clear_group(vfio_group_fd);
 				return -1;
 			}
+			/* memory must not come and go while it's mapped */
+			eal_memory_hotplug_lock();
 			ret = t->dma_map_func(vfio_cfg.vfio_container_fd);
+			if (ret == 0)
+				vfio_cfg.vfio_iommu_type = t;
+			eal_memory_hotplug_unlock();
 			if (ret) {
 				RTE_LOG(ERR, EAL,
 					"  %s DMA remapping failed, error %i (%s)\n",
@@ -726,6 +731,67 @@ vfio_type1_dma_map(int vfio_container_fd)
 	return 0;
 }
 
+int
+vfio_dma_mem_map(uint64_t vaddr, uint64_t iova, uint64_t len, int do_map)
+{
+	const struct vfio_iommu_type *t = vfio_cfg.vfio_iommu_type;
+	unsigned int idx;
+	int ret;
+
+	if (!vfio_cfg.vfio_enabled || vfio_cfg.vfio_active_groups == 0)
+		return 0;
+
+	/* the primary process maps all memory once it sets up the IOMMU */
+	if (t == NULL && internal_config.process_type == RTE_PROC_PRIMARY)
+		return 0;
+
+	/* secondary processes ask the container which type was set up */
+	for (idx = 0; t == NULL && idx < RTE_DIM(iommu_types); idx++)
+		if (ioctl(vfio_cfg.vfio_container_fd, VFIO_CHECK_EXTENSION,
+				iommu_types[idx].type_id) == 1)
+			t = &iommu_types[idx];
+
+	if (t == NULL || t->type_id == RTE_VFIO_NOIOMMU)
+		return 0;
+	if (t->type_id != RTE_VFIO_TYPE1) {
+		RTE_LOG(ERR, EAL, "  memory hotplug is not supported with "
+			"IOMMU type %d (%s)\n", t->type_id, t->name);
+		return -1;
+	}
+
+	if (do_map) {
+		struct vfio_iommu_type1_dma_map dma_map;
+
+		memset(&dma_map, 0, sizeof(dma_map));
+		dma_map.argsz = sizeof(struct vfio_iommu_type1_dma_map);
+		dma_map.vaddr = vaddr;
+		dma_map.size = len;
+		dma_map.iova = iova;
+		dma_map.flags = VFIO_DMA_MAP_FLAG_READ |
+				VFIO_DMA_MAP_FLAG_WRITE;
+
+		ret = ioctl(vfio_cfg.vfio_container_fd, VFIO_IOMMU_MAP_DMA,
+				&dma_map);
+	} else {
+		struct vfio_iommu_type1_dma_unmap dma_unmap;
+
+		memset(&dma_unmap, 0, sizeof(dma_unmap));
+		dma_unmap.argsz = sizeof(struct vfio_iommu_type1_dma_unmap);
+		dma_unmap.size = len;
+		dma_unmap.iova = iova;
+
+		ret = ioctl(vfio_cfg.vfio_container_fd, VFIO_IOMMU_UNMAP_DMA,
+				&dma_unmap);
+	}
+	if (ret) {
+		RTE_LOG(ERR, EAL, "  cannot %s DMA remapping, error %i (%s)\n",
+			do_map ? "set up" : "remove", errno, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
 static int
 vfio_spapr_dma_map(int vfio_container_fd)
 {
@@ -139,6 +139,8 @@ struct vfio_config {
 	int vfio_enabled;
 	int vfio_container_fd;
 	int vfio_active_groups;
+	/* IOMMU type set up by the primary process, NULL elsewhere */
+	const struct vfio_iommu_type *vfio_iommu_type;
 	struct vfio_group vfio_groups[VFIO_MAX_GROUPS];
 };
 
@@ -177,6 +179,12 @@ vfio_get_group_no(const char *sysfs_base,
 int
 vfio_get_group_fd(int iommu_group_no);
 
+/* DMA map or unmap memory hotplugged after the IOMMU was set up
+ * returns 0 on success, -1 for errors
+ */
+int
+vfio_dma_mem_map(uint64_t vaddr, uint64_t iova, uint64_t len, int do_map);
+
 int vfio_mp_sync_setup(void);
 
 #define SOCKET_REQ_CONTAINER 0x100
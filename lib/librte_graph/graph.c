@@ -0,0 +1,674 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+#include <fnmatch.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_debug.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+
+#include "graph_private.h"
+
+static struct graph_head graph_list = STAILQ_HEAD_INITIALIZER(graph_list);
+static rte_graph_t graph_count;
+
+struct graph_head *
+graph_list_head_get(void)
+{
+	return &graph_list;
+}
+
+static struct graph *
+graph_from_id(rte_graph_t id)
+{
+	struct graph *graph;
+
+	STAILQ_FOREACH(graph, &graph_list, next)
+		if (graph->id == id)
+			return graph;
+	return NULL;
+}
+
+static struct graph *
+graph_from_name(const char *name)
+{
+	struct graph *graph;
+
+	STAILQ_FOREACH(graph, &graph_list, next)
+		if (strncmp(graph->name, name, RTE_GRAPH_NAMESIZE) == 0)
+			return graph;
+	return NULL;
+}
+
+/* lowest id not in use */
+static rte_graph_t
+graph_id_alloc(void)
+{
+	rte_graph_t id;
+
+	for (id = 0; id < RTE_GRAPH_ID_INVALID; id++)
+		if (graph_from_id(id) == NULL)
+			return id;
+	return RTE_GRAPH_ID_INVALID;
+}
+
+static struct rte_node *
+graph_node_find(const struct rte_graph *graph, const char *name)
+{
+	rte_node_t i;
+
+	for (i = 0; i < graph->nb_nodes; i++)
+		if (strncmp(graph->nodes[i]->name, name,
+				RTE_NODE_NAMESIZE) == 0)
+			return graph->nodes[i];
+	return NULL;
+}
+
+/*
+ * Add the nodes on the edges of the nodes of the set, until none is
+ * missing. The set has room for all the registered nodes.
+ */
+static int
+graph_nodes_expand(struct node **set, rte_node_t *nb)
+{
+	struct node *node, *next;
+	rte_node_t i, j;
+	rte_edge_t e;
+
+	for (i = 0; i < *nb; i++) {
+		node = set[i];
+		for (e = 0; e < node->nb_edges; e++) {
+			next = node_from_name(node->next_nodes[e]);
+			if (next == NULL) {
+				GRAPH_LOG(ERR, "node %s: no next node %s",
+					node->name, node->next_nodes[e]);
+				return -ENOENT;
+			}
+			for (j = 0; j < *nb; j++)
+				if (set[j] == next)
+					break;
+			if (j == *nb)
+				set[(*nb)++] = next;
+		}
+	}
+	return 0;
+}
+
+static int
+node_cmp(const void *a, const void *b)
+{
+	const struct node *na = *(const struct node * const *)a;
+	const struct node *nb = *(const struct node * const *)b;
+
+	return na->id < nb->id ? -1 : na->id > nb->id;
+}
+
+/*
+ * Check there is a source node, no edge leads to a source node or back to
+ * its node, and every node is reachable from a source.
+ */
+static int
+graph_nodes_check(struct node **set, rte_node_t nb)
+{
+	uint8_t *reached;
+	struct node *node, *next;
+	rte_node_t i, j, nb_src = 0;
+	rte_edge_t e;
+	int changed, ret = 0;
+
+	reached = calloc(nb, sizeof(*reached));
+	if (reached == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < nb; i++) {
+		node = set[i];
+		if (node->flags & RTE_NODE_SOURCE_F) {
+			reached[i] = 1;
+			nb_src++;
+		}
+		for (e = 0; e < node->nb_edges; e++) {
+			next = node_from_name(node->next_nodes[e]);
+			if (next == node) {
+				GRAPH_LOG(ERR, "node %s: edge to itself",
+					node->name);
+				ret = -EINVAL;
+				goto out;
+			}
+			if (next->flags & RTE_NODE_SOURCE_F) {
+				GRAPH_LOG(ERR, "node %s: edge to source %s",
+					node->name, next->name);
+				ret = -EINVAL;
+				goto out;
+			}
+		}
+	}
+	if (nb_src == 0) {
+		GRAPH_LOG(ERR, "no source node");
+		ret = -EINVAL;
+		goto out;
+	}
+
+	do {
+		changed = 0;
+		for (i = 0; i < nb; i++) {
+			if (!reached[i])
+				continue;
+			node = set[i];
+			for (e = 0; e < node->nb_edges; e++) {
+				next = node_from_name(node->next_nodes[e]);
+				for (j = 0; j < nb; j++)
+					if (set[j] == next && !reached[j]) {
+						reached[j] = 1;
+						changed = 1;
+					}
+			}
+		}
+	} while (changed);
+
+	for (i = 0; i < nb; i++)
+		if (!reached[i]) {
+			GRAPH_LOG(ERR, "node %s not reachable from a source",
+				set[i]->name);
+			ret = -EINVAL;
+			goto out;
+		}
+out:
+	free(reached);
+	return ret;
+}
+
+static void
+graph_nodes_fini(struct rte_graph *graph, rte_node_t nb_init,
+		struct node **set)
+{
+	rte_node_t i;
+
+	for (i = 0; i < nb_init; i++)
+		if (set[i]->fini != NULL)
+			set[i]->fini(graph, graph->nodes[i]);
+}
+
+static void
+graph_mem_free(struct rte_graph *graph)
+{
+	rte_node_t i;
+
+	for (i = 0; i < graph->nb_nodes; i++)
+		if (graph->nodes[i] != NULL)
+			rte_free(graph->nodes[i]->objs);
+	rte_free(graph);
+}
+
+static size_t
+graph_node_size(const struct node *node)
+{
+	return RTE_ALIGN_CEIL(sizeof(struct rte_node) +
+		node->nb_edges * sizeof(struct rte_node *),
+		RTE_CACHE_LINE_SIZE);
+}
+
+/* allocate the fast path object of a graph of the node set, sorted by id */
+static struct rte_graph *
+graph_mem_alloc(const char *name, rte_graph_t id, int socket,
+		struct node **set, rte_node_t nb)
+{
+	struct rte_graph *graph;
+	struct rte_node *node;
+	struct node *n;
+	uint32_t cir_size = rte_align32pow2(nb + 1);
+	size_t sz, off;
+	rte_node_t i;
+	rte_edge_t e;
+
+	sz = RTE_ALIGN_CEIL(sizeof(*graph) +
+		(cir_size + 2 * nb) * sizeof(struct rte_node *),
+		RTE_CACHE_LINE_SIZE);
+	for (i = 0; i < nb; i++)
+		sz += graph_node_size(set[i]);
+
+	graph = rte_zmalloc_socket(name, sz, RTE_CACHE_LINE_SIZE, socket);
+	if (graph == NULL)
+		return NULL;
+
+	snprintf(graph->name, sizeof(graph->name), "%s", name);
+	graph->id = id;
+	graph->socket = socket;
+	graph->cir_mask = cir_size - 1;
+	graph->nb_nodes = nb;
+	graph->cir = (struct rte_node **)(graph + 1);
+	graph->src = graph->cir + cir_size;
+	graph->nodes = graph->src + nb;
+
+	off = RTE_ALIGN_CEIL(sizeof(*graph) +
+		(cir_size + 2 * nb) * sizeof(struct rte_node *),
+		RTE_CACHE_LINE_SIZE);
+	for (i = 0; i < nb; i++) {
+		n = set[i];
+		node = RTE_PTR_ADD(graph, off);
+		off += graph_node_size(n);
+
+		node->process = n->process;
+		node->nb_edges = n->nb_edges;
+		node->id = n->id;
+		node->parent_id = n->parent_id;
+		snprintf(node->name, sizeof(node->name), "%s", n->name);
+		graph->nodes[i] = node;
+		if (n->flags & RTE_NODE_SOURCE_F)
+			graph->src[graph->nb_src++] = node;
+
+		node->objs = rte_zmalloc_socket(name,
+			RTE_GRAPH_BURST_SIZE * sizeof(void *),
+			RTE_CACHE_LINE_SIZE, socket);
+		if (node->objs == NULL) {
+			graph_mem_free(graph);
+			return NULL;
+		}
+		node->size = RTE_GRAPH_BURST_SIZE;
+	}
+
+	for (i = 0; i < nb; i++) {
+		node = graph->nodes[i];
+		for (e = 0; e < node->nb_edges; e++)
+			node->nodes[e] = graph_node_find(graph,
+				set[i]->next_nodes[e]);
+	}
+	return graph;
+}
+
+/* create a graph of the node set, with the graph lock held */
+static rte_graph_t
+graph_create(const char *name, int socket, struct node **set, rte_node_t nb)
+{
+	struct rte_graph *rgraph;
+	struct graph *graph;
+	rte_graph_t id;
+	rte_node_t i;
+	int ret;
+
+	if (strnlen(name, RTE_GRAPH_NAMESIZE) == RTE_GRAPH_NAMESIZE) {
+		rte_errno = ENAMETOOLONG;
+		return RTE_GRAPH_ID_INVALID;
+	}
+	if (graph_from_name(name) != NULL) {
+		GRAPH_LOG(ERR, "graph %s already exists", name);
+		rte_errno = EEXIST;
+		return RTE_GRAPH_ID_INVALID;
+	}
+
+	ret = graph_nodes_expand(set, &nb);
+	if (ret == 0)
+		ret = graph_nodes_check(set, nb);
+	if (ret < 0) {
+		rte_errno = -ret;
+		return RTE_GRAPH_ID_INVALID;
+	}
+	qsort(set, nb, sizeof(*set), node_cmp);
+
+	id = graph_id_alloc();
+	if (id == RTE_GRAPH_ID_INVALID) {
+		rte_errno = ENOSPC;
+		return RTE_GRAPH_ID_INVALID;
+	}
+
+	graph = calloc(1, sizeof(*graph));
+	if (graph != NULL)
+		graph->nodes = malloc(nb * sizeof(*graph->nodes));
+	if (graph == NULL || graph->nodes == NULL) {
+		rte_errno = ENOMEM;
+		goto free_graph;
+	}
+
+	rgraph = graph_mem_alloc(name, id, socket, set, nb);
+	if (rgraph == NULL) {
+		rte_errno = ENOMEM;
+		goto free_graph;
+	}
+
+	for (i = 0; i < nb; i++) {
+		if (set[i]->init == NULL)
+			continue;
+		ret = set[i]->init(rgraph, rgraph->nodes[i]);
+		if (ret < 0) {
+			GRAPH_LOG(ERR, "graph %s: init of node %s failed",
+				name, set[i]->name);
+			graph_nodes_fini(rgraph, i, set);
+			graph_mem_free(rgraph);
+			rte_errno = -ret;
+			goto free_graph;
+		}
+	}
+
+	snprintf(graph->name, sizeof(graph->name), "%s", name);
+	graph->id = id;
+	graph->socket = socket;
+	graph->nb_nodes = nb;
+	memcpy(graph->nodes, set, nb * sizeof(*set));
+	graph->graph = rgraph;
+	STAILQ_INSERT_TAIL(&graph_list, graph, next);
+	graph_count++;
+	return id;
+
+free_graph:
+	if (graph != NULL)
+		free(graph->nodes);
+	free(graph);
+	return RTE_GRAPH_ID_INVALID;
+}
+
+rte_graph_t
+rte_graph_create(const char *name, struct rte_graph_param *prm)
+{
+	struct node **set;
+	struct node *node;
+	rte_graph_t id = RTE_GRAPH_ID_INVALID;
+	rte_node_t nb = 0;
+	uint16_t i;
+
+	if (name == NULL || prm == NULL || (prm->nb_node_patterns > 0 &&
+			prm->node_patterns == NULL)) {
+		rte_errno = EINVAL;
+		return RTE_GRAPH_ID_INVALID;
+	}
+
+	graph_spinlock_lock();
+
+	set = calloc(rte_node_max_count() + 1, sizeof(*set));
+	if (set == NULL) {
+		rte_errno = ENOMEM;
+		goto out;
+	}
+
+	STAILQ_FOREACH(node, node_list_head_get(), next)
+		for (i = 0; i < prm->nb_node_patterns; i++)
+			if (fnmatch(prm->node_patterns[i], node->name,
+					0) == 0) {
+				set[nb++] = node;
+				break;
+			}
+	if (nb == 0) {
+		GRAPH_LOG(ERR, "graph %s: no node matches", name);
+		rte_errno = ENOENT;
+		goto out;
+	}
+
+	id = graph_create(name, prm->socket_id, set, nb);
+out:
+	free(set);
+	graph_spinlock_unlock();
+	return id;
+}
+
+rte_graph_t
+rte_graph_clone(rte_graph_t id, const char *name, int socket_id)
+{
+	char clone_name[RTE_GRAPH_NAMESIZE];
+	struct graph *parent;
+	struct node **set = NULL;
+	rte_graph_t clone_id = RTE_GRAPH_ID_INVALID;
+	int n;
+
+	if (name == NULL) {
+		rte_errno = EINVAL;
+		return RTE_GRAPH_ID_INVALID;
+	}
+
+	graph_spinlock_lock();
+
+	parent = graph_from_id(id);
+	if (parent == NULL) {
+		rte_errno = EINVAL;
+		goto out;
+	}
+	n = snprintf(clone_name, sizeof(clone_name), "%s-%s", parent->name,
+		name);
+	if (n < 0 || n >= (int)sizeof(clone_name)) {
+		rte_errno = ENAMETOOLONG;
+		goto out;
+	}
+
+	set = calloc(rte_node_max_count() + 1, sizeof(*set));
+	if (set == NULL) {
+		rte_errno = ENOMEM;
+		goto out;
+	}
+	memcpy(set, parent->nodes, parent->nb_nodes * sizeof(*set));
+	clone_id = graph_create(clone_name, socket_id, set, parent->nb_nodes);
+out:
+	free(set);
+	graph_spinlock_unlock();
+	return clone_id;
+}
+
+int
+rte_graph_destroy(rte_graph_t id)
+{
+	struct graph *graph;
+
+	graph_spinlock_lock();
+
+	graph = graph_from_id(id);
+	if (graph == NULL) {
+		graph_spinlock_unlock();
+		return -EINVAL;
+	}
+	STAILQ_REMOVE(&graph_list, graph, graph, next);
+	graph_count--;
+
+	graph_nodes_fini(graph->graph, graph->nb_nodes, graph->nodes);
+	graph_mem_free(graph->graph);
+	free(graph->nodes);
+	free(graph);
+
+	graph_spinlock_unlock();
+	return 0;
+}
+
+rte_graph_t
+rte_graph_from_name(const char *name)
+{
+	struct graph *graph;
+	rte_graph_t id = RTE_GRAPH_ID_INVALID;
+
+	if (name == NULL)
+		return RTE_GRAPH_ID_INVALID;
+
+	graph_spinlock_lock();
+	graph = graph_from_name(name);
+	if (graph != NULL)
+		id = graph->id;
+	graph_spinlock_unlock();
+	return id;
+}
+
+const char *
+rte_graph_id_to_name(rte_graph_t id)
+{
+	struct graph *graph;
+
+	graph_spinlock_lock();
+	graph = graph_from_id(id);
+	graph_spinlock_unlock();
+	return graph == NULL ? NULL : graph->name;
+}
+
+struct rte_graph *
+rte_graph_lookup(const char *name)
+{
+	struct graph *graph;
+
+	if (name == NULL)
+		return NULL;
+
+	graph_spinlock_lock();
+	graph = graph_from_name(name);
+	graph_spinlock_unlock();
+	return graph == NULL ? NULL : graph->graph;
+}
+
+rte_graph_t
+rte_graph_max_count(void)
+{
+	return graph_count;
+}
+
+static struct rte_node *
+graph_node_get(const struct graph *graph, rte_node_t node_id)
+{
+	rte_node_t i;
+
+	for (i = 0; i < graph->nb_nodes; i++)
+		if (graph->nodes[i]->id == node_id)
+			return graph->graph->nodes[i];
+	return NULL;
+}
+
+struct rte_node *
+rte_graph_node_get(rte_graph_t graph_id, rte_node_t node_id)
+{
+	struct graph *graph;
+	struct rte_node *node = NULL;
+
+	graph_spinlock_lock();
+	graph = graph_from_id(graph_id);
+	if (graph != NULL)
+		node = graph_node_get(graph, node_id);
+	graph_spinlock_unlock();
+	return node;
+}
+
+struct rte_node *
+rte_graph_node_get_by_name(const char *graph_name, const char *name)
+{
+	struct graph *graph;
+	struct rte_node *node = NULL;
+
+	if (graph_name == NULL || name == NULL)
+		return NULL;
+
+	graph_spinlock_lock();
+	graph = graph_from_name(graph_name);
+	if (graph != NULL)
+		node = graph_node_find(graph->graph, name);
+	graph_spinlock_unlock();
+	return node;
+}
+
+static void
+graph_dump(FILE *f, const struct graph *graph)
+{
+	const struct rte_graph *rgraph = graph->graph;
+	const struct rte_node *node;
+	rte_node_t i;
+	rte_edge_t e;
+
+	fprintf(f, "graph <%s>\n", graph->name);
+	fprintf(f, "  id=%u\n", graph->id);
+	fprintf(f, "  socket=%d\n", graph->socket);
+	fprintf(f, "  nb_nodes=%" PRIu32 "\n", rgraph->nb_nodes);
+	fprintf(f, "  nb_src=%" PRIu32 "\n", rgraph->nb_src);
+	fprintf(f, "  cir_size=%" PRIu32 " head=%" PRIu32 " tail=%" PRIu32
+		"\n", rgraph->cir_mask + 1, rgraph->head, rgraph->tail);
+	for (i = 0; i < rgraph->nb_nodes; i++) {
+		node = rgraph->nodes[i];
+		fprintf(f, "  node[%" PRIu32 "] <%s>\n", i, node->name);
+		fprintf(f, "    id=%" PRIu32 " size=%u idx=%u\n", node->id,
+			node->size, node->idx);
+		fprintf(f, "    calls=%" PRIu64 " objs=%" PRIu64
+			" cycles=%" PRIu64 " realloc_count=%" PRIu32 "\n",
+			node->total_calls, node->total_objs,
+			node->total_cycles, node->realloc_count);
+		for (e = 0; e < node->nb_edges; e++)
+			fprintf(f, "    edge[%u] <%s>\n", e,
+				node->nodes[e]->name);
+	}
+}
+
+void
+rte_graph_dump(FILE *f, rte_graph_t id)
+{
+	struct graph *graph;
+
+	graph_spinlock_lock();
+	graph = graph_from_id(id);
+	if (graph != NULL)
+		graph_dump(f, graph);
+	graph_spinlock_unlock();
+}
+
+void
+rte_graph_list_dump(FILE *f)
+{
+	struct graph *graph;
+
+	graph_spinlock_lock();
+	STAILQ_FOREACH(graph, &graph_list, next)
+		graph_dump(f, graph);
+	graph_spinlock_unlock();
+}
+
+int
+rte_graph_export(const char *name, FILE *f)
+{
+	const struct rte_graph *rgraph;
+	const struct rte_node *node;
+	struct graph *graph;
+	rte_node_t i;
+	rte_edge_t e;
+
+	if (name == NULL || f == NULL)
+		return -EINVAL;
+
+	graph_spinlock_lock();
+
+	graph = graph_from_name(name);
+	if (graph == NULL) {
+		graph_spinlock_unlock();
+		return -ENOENT;
+	}
+	rgraph = graph->graph;
+
+	fprintf(f, "digraph \"%s\" {\n\trankdir=LR;\n", graph->name);
+	for (i = 0; i < rgraph->nb_src; i++)
+		fprintf(f, "\t\"%s\" [color=blue, style=bold];\n",
+			rgraph->src[i]->name);
+	for (i = 0; i < rgraph->nb_nodes; i++) {
+		node = rgraph->nodes[i];
+		for (e = 0; e < node->nb_edges; e++)
+			fprintf(f, "\t\"%s\" -> \"%s\";\n", node->name,
+				node->nodes[e]->name);
+	}
+	fprintf(f, "}\n");
+
+	graph_spinlock_unlock();
+	return 0;
+}
+
+void
+__rte_node_stream_alloc(struct rte_graph *graph, struct rte_node *node,
+		uint16_t req_size)
+{
+	uint32_t size = rte_align32pow2(req_size);
+	void **objs;
+
+	if (size > UINT16_MAX)
+		size = UINT16_MAX;
+
+	objs = rte_malloc_socket(graph->name, size * sizeof(void *),
+		RTE_CACHE_LINE_SIZE, graph->socket);
+	if (objs == NULL)
+		rte_panic("graph %s: cannot grow stream of node %s to %u\n",
+			graph->name, node->name, size);
+
+	memcpy(objs, node->objs, node->idx * sizeof(void *));
+	rte_free(node->objs);
+	node->objs = objs;
+	node->size = size;
+	node->realloc_count++;
+}
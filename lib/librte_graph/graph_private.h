@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef _GRAPH_PRIVATE_H_
+#define _GRAPH_PRIVATE_H_
+
+#include <sys/queue.h>
+
+#include <rte_log.h>
+#include <rte_spinlock.h>
+
+#include "rte_graph.h"
+#include "rte_graph_worker.h"
+
+extern int rte_graph_logtype;
+
+#define GRAPH_LOG(level, fmt, args...) \
+	rte_log(RTE_LOG_ ## level, rte_graph_logtype, "%s(): " fmt "\n", \
+		__func__, ##args)
+
+/* registered node */
+struct node {
+	STAILQ_ENTRY(node) next;
+	char name[RTE_NODE_NAMESIZE];
+	uint64_t flags;
+	rte_node_process_t process;
+	rte_node_init_t init;
+	rte_node_fini_t fini;
+	rte_node_t id;
+	rte_node_t parent_id;
+	rte_edge_t nb_edges;
+	char (*next_nodes)[RTE_NODE_NAMESIZE];
+};
+
+STAILQ_HEAD(node_head, node);
+
+/* created graph */
+struct graph {
+	STAILQ_ENTRY(graph) next;
+	char name[RTE_GRAPH_NAMESIZE];
+	rte_graph_t id;
+	int socket;
+	rte_node_t nb_nodes;
+	struct node **nodes;     /* nodes of the graph, in node id order */
+	struct rte_graph *graph; /* fast path object */
+};
+
+STAILQ_HEAD(graph_head, graph);
+
+/* lock of the node and graph lists */
+extern rte_spinlock_t graph_lock;
+
+static inline void
+graph_spinlock_lock(void)
+{
+	rte_spinlock_lock(&graph_lock);
+}
+
+static inline void
+graph_spinlock_unlock(void)
+{
+	rte_spinlock_unlock(&graph_lock);
+}
+
+struct node_head *node_list_head_get(void);
+struct node *node_from_id(rte_node_t id);
+struct node *node_from_name(const char *name);
+
+struct graph_head *graph_list_head_get(void);
+
+#endif /* _GRAPH_PRIVATE_H_ */
@@ -0,0 +1,243 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+#include <fnmatch.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+
+#include "graph_private.h"
+
+/* a node of the cluster and its instances in the graphs */
+struct cluster_node {
+	struct rte_graph_cluster_node_stats stat;
+	uint64_t base_calls;  /* totals at the last reset */
+	uint64_t base_objs;
+	uint64_t base_cycles;
+	uint64_t base_realloc_count;
+	uint32_t nb_objs;     /* number of instances */
+	struct rte_node *objs[];
+};
+
+struct rte_graph_cluster_stats {
+	rte_graph_cluster_stats_cb_t fn;
+	void *cookie;
+	uint32_t nb_nodes;
+	size_t node_size;     /* size of a cluster node */
+	uint8_t nodes[] __rte_cache_aligned;
+};
+
+static struct cluster_node *
+cluster_node(const struct rte_graph_cluster_stats *stat, uint32_t i)
+{
+	return (struct cluster_node *)(uintptr_t)
+		&stat->nodes[i * stat->node_size];
+}
+
+static const char graph_stats_line[] =
+	"--------------------------------------------------------------------"
+	"----------------------------------------";
+
+static int
+graph_cluster_stats_print(bool is_first, bool is_last, void *cookie,
+		const struct rte_graph_cluster_node_stats *stat)
+{
+	FILE *f = cookie;
+	double rate = 0, objs_per_call = 0, cycles_per_call = 0;
+	uint64_t dt = stat->ts - stat->prev_ts;
+
+	if (is_first)
+		fprintf(f, "+%s+\n|%-32s|%14s|%14s|%14s|%12s|%12s|\n+%s+\n",
+			graph_stats_line, "Node", "objs", "calls",
+			"rate (obj/s)", "objs/call", "cycles/call",
+			graph_stats_line);
+
+	if (stat->prev_ts != 0 && dt != 0)
+		rate = (double)(stat->objs - stat->prev_objs) * stat->hz / dt;
+	if (stat->calls != 0) {
+		objs_per_call = (double)stat->objs / stat->calls;
+		cycles_per_call = (double)stat->cycles / stat->calls;
+	}
+	fprintf(f, "|%-32s|%14" PRIu64 "|%14" PRIu64 "|%14.0f|%12.2f|%12.1f|\n",
+		stat->name, stat->objs, stat->calls, rate, objs_per_call,
+		cycles_per_call);
+
+	if (is_last)
+		fprintf(f, "+%s+\n", graph_stats_line);
+	return 0;
+}
+
+/* find or add the cluster node of a node instance */
+static int
+cluster_node_add(struct rte_graph_cluster_stats *stat, uint32_t max_nodes,
+		struct rte_node *node)
+{
+	struct cluster_node *cn;
+	uint32_t i;
+
+	for (i = 0; i < stat->nb_nodes; i++) {
+		cn = cluster_node(stat, i);
+		if (cn->stat.id == node->id) {
+			cn->objs[cn->nb_objs++] = node;
+			return 0;
+		}
+	}
+	if (stat->nb_nodes == max_nodes)
+		return -ENOSPC;
+
+	cn = cluster_node(stat, stat->nb_nodes++);
+	cn->stat.id = node->id;
+	cn->stat.hz = rte_get_tsc_hz();
+	snprintf(cn->stat.name, sizeof(cn->stat.name), "%s", node->name);
+	cn->objs[cn->nb_objs++] = node;
+	return 0;
+}
+
+static bool
+graph_matches(const struct graph *graph,
+		const struct rte_graph_cluster_stats_param *prm)
+{
+	uint16_t i;
+
+	for (i = 0; i < prm->nb_graph_patterns; i++)
+		if (fnmatch(prm->graph_patterns[i], graph->name, 0) == 0)
+			return true;
+	return false;
+}
+
+struct rte_graph_cluster_stats *
+rte_graph_cluster_stats_create(const struct rte_graph_cluster_stats_param *prm)
+{
+	struct rte_graph_cluster_stats *stat = NULL;
+	struct graph *graph;
+	uint32_t nb_graphs = 0, max_nodes = 0;
+	size_t node_size;
+	rte_node_t i;
+
+	if (prm == NULL || (prm->fn == NULL && prm->f == NULL) ||
+			prm->graph_patterns == NULL) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	graph_spinlock_lock();
+
+	STAILQ_FOREACH(graph, graph_list_head_get(), next)
+		if (graph_matches(graph, prm)) {
+			nb_graphs++;
+			max_nodes += graph->nb_nodes;
+		}
+	if (nb_graphs == 0) {
+		rte_errno = ENOENT;
+		goto out;
+	}
+
+	node_size = RTE_ALIGN_CEIL(sizeof(struct cluster_node) +
+		nb_graphs * sizeof(struct rte_node *), RTE_CACHE_LINE_SIZE);
+	stat = rte_zmalloc_socket(NULL, sizeof(*stat) + max_nodes * node_size,
+		RTE_CACHE_LINE_SIZE, prm->socket_id);
+	if (stat == NULL) {
+		rte_errno = ENOMEM;
+		goto out;
+	}
+	stat->node_size = node_size;
+	if (prm->fn != NULL) {
+		stat->fn = prm->fn;
+		stat->cookie = prm->cookie;
+	} else {
+		stat->fn = graph_cluster_stats_print;
+		stat->cookie = prm->f;
+	}
+
+	STAILQ_FOREACH(graph, graph_list_head_get(), next) {
+		if (!graph_matches(graph, prm))
+			continue;
+		for (i = 0; i < graph->nb_nodes; i++)
+			if (cluster_node_add(stat, max_nodes,
+					graph->graph->nodes[i]) < 0) {
+				rte_free(stat);
+				stat = NULL;
+				rte_errno = ENOSPC;
+				goto out;
+			}
+	}
+out:
+	graph_spinlock_unlock();
+	return stat;
+}
+
+void
+rte_graph_cluster_stats_destroy(struct rte_graph_cluster_stats *stat)
+{
+	rte_free(stat);
+}
+
+static void
+cluster_node_collect(struct cluster_node *cn)
+{
+	struct rte_graph_cluster_node_stats *stat = &cn->stat;
+	uint64_t calls = 0, objs = 0, cycles = 0, realloc_count = 0;
+	uint32_t i;
+
+	for (i = 0; i < cn->nb_objs; i++) {
+		calls += cn->objs[i]->total_calls;
+		objs += cn->objs[i]->total_objs;
+		cycles += cn->objs[i]->total_cycles;
+		realloc_count += cn->objs[i]->realloc_count;
+	}
+
+	stat->prev_ts = stat->ts;
+	stat->prev_calls = stat->calls;
+	stat->prev_objs = stat->objs;
+	stat->prev_cycles = stat->cycles;
+
+	stat->ts = rte_get_tsc_cycles();
+	stat->calls = calls - cn->base_calls;
+	stat->objs = objs - cn->base_objs;
+	stat->cycles = cycles - cn->base_cycles;
+	stat->realloc_count = realloc_count - cn->base_realloc_count;
+}
+
+void
+rte_graph_cluster_stats_get(struct rte_graph_cluster_stats *stat, bool skip_cb)
+{
+	struct cluster_node *cn;
+	uint32_t i;
+
+	for (i = 0; i < stat->nb_nodes; i++) {
+		cn = cluster_node(stat, i);
+		cluster_node_collect(cn);
+		if (!skip_cb && stat->fn(i == 0, i == stat->nb_nodes - 1,
+				stat->cookie, &cn->stat) < 0)
+			skip_cb = true;
+	}
+}
+
+void
+rte_graph_cluster_stats_reset(struct rte_graph_cluster_stats *stat)
+{
+	struct rte_graph_cluster_node_stats *s;
+	struct cluster_node *cn;
+	uint32_t i;
+
+	for (i = 0; i < stat->nb_nodes; i++) {
+		cn = cluster_node(stat, i);
+		s = &cn->stat;
+		cluster_node_collect(cn);
+		cn->base_calls += s->calls;
+		cn->base_objs += s->objs;
+		cn->base_cycles += s->cycles;
+		cn->base_realloc_count += s->realloc_count;
+		s->ts = s->calls = s->objs = s->cycles = 0;
+		s->prev_ts = s->prev_calls = s->prev_objs = s->prev_cycles = 0;
+		s->realloc_count = 0;
+	}
+}
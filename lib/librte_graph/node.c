@@ -0,0 +1,367 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+
+#include "graph_private.h"
+
+/* nodes are registered at constructor time, before rte_malloc works */
+static struct node_head node_list = STAILQ_HEAD_INITIALIZER(node_list);
+static rte_node_t node_id;
+
+rte_spinlock_t graph_lock = RTE_SPINLOCK_INITIALIZER;
+int rte_graph_logtype;
+
+RTE_INIT(rte_graph_init_log);
+
+static void
+rte_graph_init_log(void)
+{
+	rte_graph_logtype = rte_log_register("librte.graph");
+	if (rte_graph_logtype >= 0)
+		rte_log_set_level(rte_graph_logtype, RTE_LOG_INFO);
+}
+
+struct node_head *
+node_list_head_get(void)
+{
+	return &node_list;
+}
+
+struct node *
+node_from_id(rte_node_t id)
+{
+	struct node *node;
+
+	STAILQ_FOREACH(node, &node_list, next)
+		if (node->id == id)
+			return node;
+	return NULL;
+}
+
+struct node *
+node_from_name(const char *name)
+{
+	struct node *node;
+
+	STAILQ_FOREACH(node, &node_list, next)
+		if (strncmp(node->name, name, RTE_NODE_NAMESIZE) == 0)
+			return node;
+	return NULL;
+}
+
+/* set edges of a node from index from, growing its edge array as needed */
+static int
+node_edges_set(struct node *node, rte_edge_t from, const char **next_nodes,
+		uint16_t nb)
+{
+	char (*edges)[RTE_NODE_NAMESIZE];
+	uint32_t nb_edges = (uint32_t)from + nb;
+	uint16_t i;
+
+	if (nb_edges >= RTE_EDGE_ID_INVALID)
+		return -ERANGE;
+
+	for (i = 0; i < nb; i++)
+		if (next_nodes[i] == NULL ||
+				strlen(next_nodes[i]) >= RTE_NODE_NAMESIZE)
+			return -EINVAL;
+
+	if (nb_edges > node->nb_edges) {
+		edges = realloc(node->next_nodes, nb_edges * sizeof(*edges));
+		if (edges == NULL)
+			return -ENOMEM;
+		node->next_nodes = edges;
+	}
+
+	for (i = 0; i < nb; i++)
+		snprintf(node->next_nodes[from + i], RTE_NODE_NAMESIZE, "%s",
+			next_nodes[i]);
+	node->nb_edges = nb_edges;
+	return 0;
+}
+
+static struct node *
+node_alloc(const char *name, const struct node *parent)
+{
+	struct node *node;
+
+	if (node_from_name(name) != NULL) {
+		GRAPH_LOG(ERR, "node %s already exists", name);
+		rte_errno = EEXIST;
+		return NULL;
+	}
+
+	node = calloc(1, sizeof(*node));
+	if (node == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+	snprintf(node->name, sizeof(node->name), "%s", name);
+	if (parent != NULL) {
+		node->flags = parent->flags;
+		node->process = parent->process;
+		node->init = parent->init;
+		node->fini = parent->fini;
+		node->parent_id = parent->id;
+	} else {
+		node->parent_id = RTE_NODE_ID_INVALID;
+	}
+	return node;
+}
+
+static rte_node_t
+node_add(struct node *node)
+{
+	node->id = node_id++;
+	STAILQ_INSERT_TAIL(&node_list, node, next);
+	return node->id;
+}
+
+rte_node_t
+__rte_node_register(const struct rte_node_register *reg)
+{
+	struct node *node;
+	rte_node_t id = RTE_NODE_ID_INVALID;
+	int ret;
+
+	if (reg == NULL || reg->process == NULL ||
+			strnlen(reg->name, RTE_NODE_NAMESIZE) == 0 ||
+			strnlen(reg->name, RTE_NODE_NAMESIZE) ==
+				RTE_NODE_NAMESIZE) {
+		rte_errno = EINVAL;
+		return RTE_NODE_ID_INVALID;
+	}
+
+	graph_spinlock_lock();
+
+	node = node_alloc(reg->name, NULL);
+	if (node == NULL)
+		goto out;
+	node->flags = reg->flags;
+	node->process = reg->process;
+	node->init = reg->init;
+	node->fini = reg->fini;
+
+	ret = node_edges_set(node, 0, (const char **)(uintptr_t)reg->next_nodes,
+		reg->nb_edges);
+	if (ret < 0) {
+		GRAPH_LOG(ERR, "bad edges of node %s", reg->name);
+		rte_errno = -ret;
+		free(node);
+		goto out;
+	}
+	id = node_add(node);
+out:
+	graph_spinlock_unlock();
+	return id;
+}
+
+rte_node_t
+rte_node_clone(rte_node_t id, const char *name)
+{
+	char clone_name[RTE_NODE_NAMESIZE];
+	struct node *parent, *node;
+	rte_node_t clone_id = RTE_NODE_ID_INVALID;
+	int n;
+
+	if (name == NULL) {
+		rte_errno = EINVAL;
+		return RTE_NODE_ID_INVALID;
+	}
+
+	graph_spinlock_lock();
+
+	parent = node_from_id(id);
+	if (parent == NULL || parent->parent_id != RTE_NODE_ID_INVALID) {
+		rte_errno = EINVAL;
+		goto out;
+	}
+
+	n = snprintf(clone_name, sizeof(clone_name), "%s-%s", parent->name,
+		name);
+	if (n < 0 || n >= (int)sizeof(clone_name)) {
+		rte_errno = ENAMETOOLONG;
+		goto out;
+	}
+
+	node = node_alloc(clone_name, parent);
+	if (node == NULL)
+		goto out;
+	if (parent->nb_edges > 0) {
+		node->next_nodes = malloc(parent->nb_edges *
+			sizeof(*node->next_nodes));
+		if (node->next_nodes == NULL) {
+			free(node);
+			rte_errno = ENOMEM;
+			goto out;
+		}
+		memcpy(node->next_nodes, parent->next_nodes,
+			parent->nb_edges * sizeof(*node->next_nodes));
+	}
+	node->nb_edges = parent->nb_edges;
+	clone_id = node_add(node);
+out:
+	graph_spinlock_unlock();
+	return clone_id;
+}
+
+rte_node_t
+rte_node_from_name(const char *name)
+{
+	struct node *node;
+	rte_node_t id = RTE_NODE_ID_INVALID;
+
+	if (name == NULL)
+		return RTE_NODE_ID_INVALID;
+
+	graph_spinlock_lock();
+	node = node_from_name(name);
+	if (node != NULL)
+		id = node->id;
+	graph_spinlock_unlock();
+	return id;
+}
+
+const char *
+rte_node_id_to_name(rte_node_t id)
+{
+	struct node *node;
+
+	graph_spinlock_lock();
+	node = node_from_id(id);
+	graph_spinlock_unlock();
+	return node == NULL ? NULL : node->name;
+}
+
+rte_edge_t
+rte_node_edge_count(rte_node_t id)
+{
+	struct node *node;
+	rte_edge_t count = RTE_EDGE_ID_INVALID;
+
+	graph_spinlock_lock();
+	node = node_from_id(id);
+	if (node != NULL)
+		count = node->nb_edges;
+	graph_spinlock_unlock();
+	return count;
+}
+
+rte_edge_t
+rte_node_edge_update(rte_node_t id, rte_edge_t from, const char **next_nodes,
+		uint16_t nb_edges)
+{
+	struct node *node;
+	rte_edge_t count = RTE_EDGE_ID_INVALID;
+
+	graph_spinlock_lock();
+
+	node = node_from_id(id);
+	if (node == NULL || (next_nodes == NULL && nb_edges > 0)) {
+		rte_errno = EINVAL;
+		goto out;
+	}
+	if (from == RTE_EDGE_ID_INVALID)
+		from = node->nb_edges;
+	if (from > node->nb_edges) {
+		rte_errno = EINVAL;
+		goto out;
+	}
+	if (node_edges_set(node, from, next_nodes, nb_edges) < 0) {
+		rte_errno = EINVAL;
+		goto out;
+	}
+	count = node->nb_edges;
+out:
+	graph_spinlock_unlock();
+	return count;
+}
+
+rte_edge_t
+rte_node_edge_shrink(rte_node_t id, rte_edge_t size)
+{
+	struct node *node;
+	rte_edge_t count = RTE_EDGE_ID_INVALID;
+
+	graph_spinlock_lock();
+	node = node_from_id(id);
+	if (node != NULL && size <= node->nb_edges) {
+		node->nb_edges = size;
+		count = size;
+	} else {
+		rte_errno = EINVAL;
+	}
+	graph_spinlock_unlock();
+	return count;
+}
+
+rte_edge_t
+rte_node_edge_get(rte_node_t id, const char *next_nodes[])
+{
+	struct node *node;
+	rte_edge_t count = RTE_EDGE_ID_INVALID;
+	rte_edge_t i;
+
+	graph_spinlock_lock();
+	node = node_from_id(id);
+	if (node != NULL) {
+		count = node->nb_edges;
+		for (i = 0; next_nodes != NULL && i < count; i++)
+			next_nodes[i] = node->next_nodes[i];
+	}
+	graph_spinlock_unlock();
+	return count;
+}
+
+rte_node_t
+rte_node_max_count(void)
+{
+	return node_id;
+}
+
+static void
+node_dump(FILE *f, const struct node *node)
+{
+	rte_edge_t i;
+
+	fprintf(f, "node <%s>\n", node->name);
+	fprintf(f, "  id=%" PRIu32 "\n", node->id);
+	fprintf(f, "  flags=0x%" PRIx64 "\n", node->flags);
+	if (node->parent_id != RTE_NODE_ID_INVALID)
+		fprintf(f, "  parent_id=%" PRIu32 "\n", node->parent_id);
+	fprintf(f, "  nb_edges=%u\n", node->nb_edges);
+	for (i = 0; i < node->nb_edges; i++)
+		fprintf(f, "    edge[%u] <%s>\n", i, node->next_nodes[i]);
+}
+
+void
+rte_node_dump(FILE *f, rte_node_t id)
+{
+	struct node *node;
+
+	graph_spinlock_lock();
+	node = node_from_id(id);
+	if (node != NULL)
+		node_dump(f, node);
+	graph_spinlock_unlock();
+}
+
+void
+rte_node_list_dump(FILE *f)
+{
+	struct node *node;
+
+	graph_spinlock_lock();
+	STAILQ_FOREACH(node, &node_list, next)
+		node_dump(f, node);
+	graph_spinlock_unlock();
+}
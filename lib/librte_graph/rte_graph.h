@@ -0,0 +1,369 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef _RTE_GRAPH_H_
+#define _RTE_GRAPH_H_
+
+/**
+ * @file
+ *
+ * RTE Graph
+ *
+ * A graph is a set of nodes, each processing a vector of objects (packets
+ * most of the time) with its process callback, and passing them on to the
+ * nodes on its edges. Nodes are registered once, at constructor time, with
+ * RTE_NODE_REGISTER(). A graph is then created from node name patterns,
+ * together with all the nodes reachable from them, and walked by one lcore
+ * with rte_graph_walk(). Each lcore walks a graph of its own: graphs never
+ * share their node instances, so nothing is locked on the fast path.
+ *
+ * A node can be cloned, to have an instance per port or queue for example:
+ * the clone is named "<parent>-<name>" and has the process callback and
+ * the edges of its parent.
+ *
+ * The control path functions are not thread safe with each other, and
+ * nodes can only be registered, cloned or have their edges changed before
+ * the graphs using them are created.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RTE_GRAPH_NAMESIZE 64 /**< Max length of graph name. */
+#define RTE_NODE_NAMESIZE 64  /**< Max length of node name. */
+#define RTE_NODE_ID_INVALID UINT32_MAX   /**< Invalid node id. */
+#define RTE_EDGE_ID_INVALID UINT16_MAX   /**< Invalid edge id. */
+#define RTE_GRAPH_ID_INVALID UINT16_MAX  /**< Invalid graph id. */
+#define RTE_NODE_CTX_SZ 16 /**< Size of the node context area. */
+
+/** Number of objects a node stream holds at first, it grows on demand. */
+#define RTE_GRAPH_BURST_SIZE RTE_LIBRTE_GRAPH_BURST_SIZE
+
+typedef uint32_t rte_node_t;  /**< Node id. */
+typedef uint16_t rte_edge_t;  /**< Edge id, index of a node's next node. */
+typedef uint16_t rte_graph_t; /**< Graph id. */
+
+struct rte_graph;
+struct rte_node;
+
+/**
+ * Node process callback.
+ *
+ * Called by rte_graph_walk() with the objects enqueued to the node, or with
+ * none for a source node. It enqueues them to its next nodes with the
+ * rte_node_enqueue*() and rte_node_next_stream*() functions of
+ * rte_graph_worker.h.
+ *
+ * @param graph
+ *   Graph being walked.
+ * @param node
+ *   Node instance in that graph.
+ * @param objs
+ *   Objects to process.
+ * @param nb_objs
+ *   Number of objects.
+ * @return
+ *   Number of objects processed, or produced by a source node. It is only
+ *   used for the statistics.
+ */
+typedef uint16_t (*rte_node_process_t)(struct rte_graph *graph,
+		struct rte_node *node, void **objs, uint16_t nb_objs);
+
+/**
+ * Node init callback, called for each node instance when a graph is
+ * created. The node context is zeroed before.
+ *
+ * @return
+ *   0 on success, negative otherwise: the graph is not created.
+ */
+typedef int (*rte_node_init_t)(const struct rte_graph *graph,
+		struct rte_node *node);
+
+/**
+ * Node fini callback, called for each node instance when a graph is
+ * destroyed.
+ */
+typedef void (*rte_node_fini_t)(const struct rte_graph *graph,
+		struct rte_node *node);
+
+/** Node is a source: it is processed on each walk, and produces objects. */
+#define RTE_NODE_SOURCE_F (1ULL << 0)
+
+/** Node registration structure. */
+struct rte_node_register {
+	char name[RTE_NODE_NAMESIZE]; /**< Name of the node. */
+	uint64_t flags;               /**< RTE_NODE_*_F flags. */
+	rte_node_process_t process;   /**< Process callback. */
+	rte_node_init_t init;         /**< Init callback, optional. */
+	rte_node_fini_t fini;         /**< Fini callback, optional. */
+	rte_node_t id;                /**< Node id, set at registration. */
+	rte_node_t parent_id;         /**< Parent of a clone. */
+	rte_edge_t nb_edges;          /**< Number of next nodes. */
+	const char *next_nodes[];     /**< Names of the next nodes. */
+};
+
+/**
+ * Register a node. Use RTE_NODE_REGISTER() instead.
+ *
+ * @return
+ *   Id of the node, RTE_NODE_ID_INVALID on error.
+ */
+rte_node_t __rte_node_register(const struct rte_node_register *node);
+
+/**
+ * Register a node at constructor time.
+ *
+ * @param node
+ *   Static struct rte_node_register variable, its id is set.
+ */
+#define RTE_NODE_REGISTER(node)						\
+	RTE_INIT(rte_node_register_##node);				\
+	static void rte_node_register_##node(void)			\
+	{								\
+		node.parent_id = RTE_NODE_ID_INVALID;			\
+		node.id = __rte_node_register(&node);			\
+	}
+
+/** Parameters of rte_graph_create(). */
+struct rte_graph_param {
+	int socket_id; /**< Socket to allocate the graph on. */
+	uint16_t nb_node_patterns; /**< Number of node patterns. */
+	/**
+	 * Shell wildcard patterns of the nodes in the graph. The nodes on
+	 * their edges are added as well, recursively.
+	 */
+	const char **node_patterns;
+};
+
+/**
+ * Create a graph. The init callback of each of its nodes is called.
+ *
+ * The graph must have at least one source node, and every node must be
+ * reachable from one.
+ *
+ * @param name
+ *   Unique name of the graph.
+ * @param prm
+ *   Parameters.
+ * @return
+ *   Id of the graph, RTE_GRAPH_ID_INVALID on error, with rte_errno set.
+ */
+rte_graph_t rte_graph_create(const char *name, struct rte_graph_param *prm);
+
+/**
+ * Create a graph with the same nodes as another one, for another lcore.
+ *
+ * @param id
+ *   Graph to clone.
+ * @param name
+ *   Suffix of the clone name, which is "<graph name>-<name>".
+ * @param socket_id
+ *   Socket to allocate the clone on.
+ * @return
+ *   Id of the clone, RTE_GRAPH_ID_INVALID on error, with rte_errno set.
+ */
+rte_graph_t rte_graph_clone(rte_graph_t id, const char *name, int socket_id);
+
+/**
+ * Destroy a graph. The fini callback of each of its nodes is called.
+ *
+ * @return
+ *   0 on success, -EINVAL if there is no such graph.
+ */
+int rte_graph_destroy(rte_graph_t id);
+
+/** Get the id of a graph from its name, RTE_GRAPH_ID_INVALID if none. */
+rte_graph_t rte_graph_from_name(const char *name);
+
+/** Get the name of a graph, NULL if there is no such graph. */
+const char *rte_graph_id_to_name(rte_graph_t id);
+
+/**
+ * Get the fast path object of a graph, to walk it.
+ *
+ * @return
+ *   The graph, NULL if there is no graph of that name.
+ */
+struct rte_graph *rte_graph_lookup(const char *name);
+
+/** Get the number of graphs created. */
+rte_graph_t rte_graph_max_count(void);
+
+/**
+ * Get the instance of a node in a graph.
+ *
+ * @return
+ *   The node instance, NULL if the node is not in the graph.
+ */
+struct rte_node *rte_graph_node_get(rte_graph_t graph_id, rte_node_t node_id);
+
+/** Same as rte_graph_node_get(), by names. */
+struct rte_node *rte_graph_node_get_by_name(const char *graph,
+		const char *name);
+
+/** Dump a graph, its nodes and their statistics. */
+void rte_graph_dump(FILE *f, rte_graph_t id);
+
+/** Dump all the graphs. */
+void rte_graph_list_dump(FILE *f);
+
+/**
+ * Export a graph in graphviz dot format.
+ *
+ * @return
+ *   0 on success, negative otherwise.
+ */
+int rte_graph_export(const char *name, FILE *f);
+
+/**
+ * Clone a node.
+ *
+ * @param id
+ *   Node to clone, it must not be a clone itself.
+ * @param name
+ *   Suffix of the clone name, which is "<node name>-<name>".
+ * @return
+ *   Id of the clone, RTE_NODE_ID_INVALID on error, with rte_errno set.
+ */
+rte_node_t rte_node_clone(rte_node_t id, const char *name);
+
+/** Get the id of a node from its name, RTE_NODE_ID_INVALID if none. */
+rte_node_t rte_node_from_name(const char *name);
+
+/** Get the name of a node, NULL if there is no such node. */
+const char *rte_node_id_to_name(rte_node_t id);
+
+/** Get the number of edges of a node, RTE_EDGE_ID_INVALID if none. */
+rte_edge_t rte_node_edge_count(rte_node_t id);
+
+/**
+ * Set next nodes of a node, before the graphs using it are created.
+ *
+ * @param id
+ *   Node id.
+ * @param from
+ *   First edge to set, the edges after it are replaced. With
+ *   RTE_EDGE_ID_INVALID, the next nodes are added after the last edge.
+ * @param next_nodes
+ *   Names of the next nodes.
+ * @param nb_edges
+ *   Number of next nodes.
+ * @return
+ *   Number of edges of the node, RTE_EDGE_ID_INVALID on error.
+ */
+rte_edge_t rte_node_edge_update(rte_node_t id, rte_edge_t from,
+		const char **next_nodes, uint16_t nb_edges);
+
+/**
+ * Keep only the first edges of a node.
+ *
+ * @return
+ *   Number of edges of the node, RTE_EDGE_ID_INVALID on error.
+ */
+rte_edge_t rte_node_edge_shrink(rte_node_t id, rte_edge_t size);
+
+/**
+ * Get the next nodes of a node.
+ *
+ * @param id
+ *   Node id.
+ * @param next_nodes
+ *   Filled with the names of the next nodes, if not NULL. It must have
+ *   room for rte_node_edge_count() entries.
+ * @return
+ *   Number of edges, RTE_EDGE_ID_INVALID on error.
+ */
+rte_edge_t rte_node_edge_get(rte_node_t id, const char *next_nodes[]);
+
+/** Get the number of nodes registered, clones included. */
+rte_node_t rte_node_max_count(void);
+
+/** Dump a node. */
+void rte_node_dump(FILE *f, rte_node_t id);
+
+/** Dump all the nodes. */
+void rte_node_list_dump(FILE *f);
+
+/** Statistics of a node, summed over the graphs of a cluster. */
+struct rte_graph_cluster_node_stats {
+	uint64_t ts;          /**< TSC at the last stats get. */
+	uint64_t calls;       /**< Number of process calls. */
+	uint64_t objs;        /**< Number of objects processed. */
+	uint64_t cycles;      /**< Cycles spent in process calls. */
+	uint64_t prev_ts;     /**< Values at the previous get. */
+	uint64_t prev_calls;
+	uint64_t prev_objs;
+	uint64_t prev_cycles;
+	uint64_t realloc_count; /**< Number of times its stream grew. */
+	rte_node_t id;        /**< Node id. */
+	uint64_t hz;          /**< TSC frequency. */
+	char name[RTE_NODE_NAMESIZE]; /**< Node name. */
+};
+
+/**
+ * Statistics callback, called for each node of a cluster.
+ *
+ * @return
+ *   0 to go on with the next node, negative to stop.
+ */
+typedef int (*rte_graph_cluster_stats_cb_t)(bool is_first, bool is_last,
+		void *cookie, const struct rte_graph_cluster_node_stats *stats);
+
+/** Parameters of rte_graph_cluster_stats_create(). */
+struct rte_graph_cluster_stats_param {
+	int socket_id; /**< Socket to allocate the statistics on. */
+	/** Callback, the default one prints a table to f. */
+	rte_graph_cluster_stats_cb_t fn;
+	union {
+		void *cookie; /**< Argument of fn. */
+		FILE *f;      /**< Output of the default callback. */
+	};
+	uint16_t nb_graph_patterns; /**< Number of graph patterns. */
+	/** Shell wildcard patterns of the graphs in the cluster. */
+	const char **graph_patterns;
+};
+
+struct rte_graph_cluster_stats;
+
+/**
+ * Create statistics of a cluster of graphs, typically the graphs of all
+ * the lcores: the statistics of the instances of a node in the graphs are
+ * summed up.
+ *
+ * @return
+ *   The statistics object, NULL on error with rte_errno set.
+ */
+struct rte_graph_cluster_stats *rte_graph_cluster_stats_create(
+		const struct rte_graph_cluster_stats_param *prm);
+
+/** Destroy cluster statistics. */
+void rte_graph_cluster_stats_destroy(struct rte_graph_cluster_stats *stat);
+
+/**
+ * Collect the statistics of a cluster, and call the callback for each
+ * node.
+ *
+ * @param stat
+ *   Cluster statistics.
+ * @param skip_cb
+ *   Only collect the statistics, don't call the callback.
+ */
+void rte_graph_cluster_stats_get(struct rte_graph_cluster_stats *stat,
+		bool skip_cb);
+
+/** Reset the statistics collected, not those of the graphs. */
+void rte_graph_cluster_stats_reset(struct rte_graph_cluster_stats *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_GRAPH_H_ */
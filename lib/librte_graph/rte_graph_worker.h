@@ -0,0 +1,340 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef _RTE_GRAPH_WORKER_H_
+#define _RTE_GRAPH_WORKER_H_
+
+/**
+ * @file
+ *
+ * RTE Graph fast path
+ *
+ * rte_graph_walk() processes the source nodes of a graph, then every node
+ * objects were enqueued to, until none is left. A node is pending at most
+ * once: objects enqueued to a pending node are appended to its stream.
+ *
+ * These functions are only to be called from the lcore walking the graph,
+ * and enqueue functions from node process callbacks.
+ */
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_memcpy.h>
+#include <rte_memory.h>
+#include <rte_prefetch.h>
+
+#include "rte_graph.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Fast path object of a graph. */
+struct rte_graph {
+	uint32_t head;            /**< Next pending node to process. */
+	uint32_t tail;            /**< Where the next pending node goes. */
+	uint32_t cir_mask;        /**< Mask of the pending node ring. */
+	rte_node_t nb_nodes;      /**< Number of nodes. */
+	rte_node_t nb_src;        /**< Number of source nodes. */
+	rte_graph_t id;           /**< Graph id. */
+	int socket;               /**< Socket the graph is allocated on. */
+	struct rte_node **cir;    /**< Ring of pending nodes. */
+	struct rte_node **src;    /**< Source nodes. */
+	struct rte_node **nodes;  /**< All nodes, in node id order. */
+	char name[RTE_GRAPH_NAMESIZE]; /**< Graph name. */
+} __rte_cache_aligned;
+
+/** Instance of a node in a graph. */
+struct rte_node {
+	/* fast path area, first cache line */
+	rte_node_process_t process; /**< Process callback. */
+	void **objs;              /**< Stream of objects enqueued. */
+	uint16_t idx;             /**< Number of objects enqueued. */
+	uint16_t size;            /**< Room in the stream. */
+	rte_edge_t nb_edges;      /**< Number of next nodes. */
+	rte_node_t id;            /**< Node id. */
+	uint64_t total_cycles;    /**< Cycles spent in process calls. */
+	uint64_t total_calls;     /**< Number of process calls. */
+	uint64_t total_objs;      /**< Number of objects processed. */
+	uint32_t realloc_count;   /**< Number of times the stream grew. */
+	rte_node_t parent_id;     /**< Parent of a clone. */
+	/** Node context, for the node implementation. */
+	uint8_t ctx[RTE_NODE_CTX_SZ] __rte_cache_aligned;
+	char name[RTE_NODE_NAMESIZE];   /**< Node name. */
+	struct rte_node *nodes[] __rte_cache_min_aligned; /**< Next nodes. */
+} __rte_cache_aligned;
+
+/**
+ * Grow the stream of a node. Private, for the enqueue functions.
+ *
+ * @param graph
+ *   Graph of the node.
+ * @param node
+ *   Node whose stream is too small.
+ * @param req_size
+ *   Number of objects the stream must hold.
+ */
+void __rte_node_stream_alloc(struct rte_graph *graph, struct rte_node *node,
+		uint16_t req_size);
+
+/** Process the objects of a node. Private, for rte_graph_walk(). */
+static __rte_always_inline void
+__rte_node_process(struct rte_graph *graph, struct rte_node *node)
+{
+	uint16_t rc;
+#ifdef RTE_LIBRTE_GRAPH_STATS
+	uint64_t start = rte_rdtsc();
+
+	rc = node->process(graph, node, node->objs, node->idx);
+	node->total_cycles += rte_rdtsc() - start;
+	node->total_calls++;
+	node->total_objs += rc;
+#else
+	rc = node->process(graph, node, node->objs, node->idx);
+	RTE_SET_USED(rc);
+#endif
+	node->idx = 0;
+}
+
+/**
+ * Walk a graph: process its source nodes, then the nodes they and the
+ * following nodes enqueued objects to.
+ *
+ * @param graph
+ *   Graph, from rte_graph_lookup().
+ */
+static inline void
+rte_graph_walk(struct rte_graph *graph)
+{
+	struct rte_node *node;
+	uint32_t head;
+	rte_node_t i;
+
+	for (i = 0; i < graph->nb_src; i++)
+		__rte_node_process(graph, graph->src[i]);
+
+	head = graph->head;
+	while (head != graph->tail) {
+		node = graph->cir[head];
+		head = (head + 1) & graph->cir_mask;
+		rte_prefetch0(node->objs);
+		__rte_node_process(graph, node);
+	}
+	graph->head = head;
+}
+
+/** Make a node pending. Private, for the enqueue functions. */
+static __rte_always_inline void
+__rte_node_enqueue_tail_update(struct rte_graph *graph, struct rte_node *node)
+{
+	uint32_t tail = graph->tail;
+
+	graph->cir[tail] = node;
+	graph->tail = (tail + 1) & graph->cir_mask;
+}
+
+/**
+ * Prepare a node for space more objects. Private, for the enqueue
+ * functions.
+ */
+static __rte_always_inline void
+__rte_node_enqueue_prologue(struct rte_graph *graph, struct rte_node *node,
+		const uint16_t idx, const uint16_t space)
+{
+	if (idx == 0)
+		__rte_node_enqueue_tail_update(graph, node);
+	if (unlikely(node->size < idx + space))
+		__rte_node_stream_alloc(graph, node, idx + space);
+}
+
+/** Get a next node of a node. Private, for the enqueue functions. */
+static __rte_always_inline struct rte_node *
+__rte_node_next_node_get(struct rte_node *node, rte_edge_t next)
+{
+	RTE_ASSERT(next < node->nb_edges);
+	return node->nodes[next];
+}
+
+/**
+ * Enqueue objects to a next node.
+ *
+ * @param graph
+ *   Graph being walked.
+ * @param node
+ *   Current node.
+ * @param next
+ *   Edge of the next node.
+ * @param objs
+ *   Objects to enqueue.
+ * @param nb_objs
+ *   Number of objects.
+ */
+static inline void
+rte_node_enqueue(struct rte_graph *graph, struct rte_node *node,
+		rte_edge_t next, void **objs, uint16_t nb_objs)
+{
+	uint16_t idx;
+
+	node = __rte_node_next_node_get(node, next);
+	idx = node->idx;
+	__rte_node_enqueue_prologue(graph, node, idx, nb_objs);
+	rte_memcpy(&node->objs[idx], objs, nb_objs * sizeof(void *));
+	node->idx = idx + nb_objs;
+}
+
+/** Enqueue one object to a next node. */
+static inline void
+rte_node_enqueue_x1(struct rte_graph *graph, struct rte_node *node,
+		rte_edge_t next, void *obj)
+{
+	uint16_t idx;
+
+	node = __rte_node_next_node_get(node, next);
+	idx = node->idx;
+	__rte_node_enqueue_prologue(graph, node, idx, 1);
+	node->objs[idx++] = obj;
+	node->idx = idx;
+}
+
+/** Enqueue two objects to a next node. */
+static inline void
+rte_node_enqueue_x2(struct rte_graph *graph, struct rte_node *node,
+		rte_edge_t next, void *obj0, void *obj1)
+{
+	uint16_t idx;
+
+	node = __rte_node_next_node_get(node, next);
+	idx = node->idx;
+	__rte_node_enqueue_prologue(graph, node, idx, 2);
+	node->objs[idx++] = obj0;
+	node->objs[idx++] = obj1;
+	node->idx = idx;
+}
+
+/** Enqueue four objects to a next node. */
+static inline void
+rte_node_enqueue_x4(struct rte_graph *graph, struct rte_node *node,
+		rte_edge_t next, void *obj0, void *obj1, void *obj2, void *obj3)
+{
+	uint16_t idx;
+
+	node = __rte_node_next_node_get(node, next);
+	idx = node->idx;
+	__rte_node_enqueue_prologue(graph, node, idx, 4);
+	node->objs[idx++] = obj0;
+	node->objs[idx++] = obj1;
+	node->objs[idx++] = obj2;
+	node->objs[idx++] = obj3;
+	node->idx = idx;
+}
+
+/**
+ * Enqueue objects each to its next node.
+ *
+ * @param nexts
+ *   Edge of the next node of each object.
+ */
+static inline void
+rte_node_enqueue_next(struct rte_graph *graph, struct rte_node *node,
+		rte_edge_t *nexts, void **objs, uint16_t nb_objs)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_objs; i++)
+		rte_node_enqueue_x1(graph, node, nexts[i], objs[i]);
+}
+
+/**
+ * Get room in the stream of a next node, to enqueue objects in place.
+ * It is followed by rte_node_next_stream_put().
+ *
+ * @param graph
+ *   Graph being walked.
+ * @param node
+ *   Current node.
+ * @param next
+ *   Edge of the next node.
+ * @param nb_objs
+ *   Number of objects there must be room for.
+ * @return
+ *   Where to store the objects.
+ */
+static inline void **
+rte_node_next_stream_get(struct rte_graph *graph, struct rte_node *node,
+		rte_edge_t next, uint16_t nb_objs)
+{
+	uint16_t idx;
+
+	node = __rte_node_next_node_get(node, next);
+	idx = node->idx;
+	if (unlikely(node->size < idx + nb_objs))
+		__rte_node_stream_alloc(graph, node, idx + nb_objs);
+
+	return &node->objs[idx];
+}
+
+/**
+ * Account for objects stored in the stream of a next node.
+ *
+ * @param graph
+ *   Graph being walked.
+ * @param node
+ *   Current node.
+ * @param next
+ *   Edge of the next node.
+ * @param nb_objs
+ *   Number of objects stored after rte_node_next_stream_get().
+ */
+static inline void
+rte_node_next_stream_put(struct rte_graph *graph, struct rte_node *node,
+		rte_edge_t next, uint16_t nb_objs)
+{
+	if (unlikely(nb_objs == 0))
+		return;
+
+	node = __rte_node_next_node_get(node, next);
+	if (node->idx == 0)
+		__rte_node_enqueue_tail_update(graph, node);
+	node->idx += nb_objs;
+}
+
+/**
+ * Move all the objects of the current node to a next node. If the next
+ * node has none yet, the streams are swapped rather than copied.
+ *
+ * @param graph
+ *   Graph being walked.
+ * @param src
+ *   Current node.
+ * @param next
+ *   Edge of the next node.
+ */
+static inline void
+rte_node_next_stream_move(struct rte_graph *graph, struct rte_node *src,
+		rte_edge_t next)
+{
+	struct rte_node *dst = __rte_node_next_node_get(src, next);
+	void **objs;
+	uint16_t size;
+
+	if (likely(dst->idx == 0)) {
+		objs = dst->objs;
+		size = dst->size;
+		dst->objs = src->objs;
+		dst->size = src->size;
+		src->objs = objs;
+		src->size = size;
+		dst->idx = src->idx;
+		__rte_node_enqueue_tail_update(graph, dst);
+	} else {
+		rte_node_enqueue(graph, src, next, src->objs, src->idx);
+	}
+	src->idx = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_GRAPH_WORKER_H_ */
@@ -45,6 +45,11 @@
  * cache and non-cache modes. The table below summarize some properties of
  * the different implementations.
  *
+ * A third type, the count-min sketch, estimates how often each key is seen
+ * instead of which set it belongs to, and keeps track of the top-k most
+ * frequent keys (heavy hitters). Lookup then tells whether a key is one of
+ * the current heavy hitters.
+ *
  * @warning
  * @b EXPERIMENTAL: this API may change without prior notice
  */
@@ -95,6 +100,15 @@ typedef uint16_t member_set_t;
 #define RTE_MEMBER_BUCKET_ENTRIES 16
 /** Maximum number of characters in setsum name. */
 #define RTE_MEMBER_NAMESIZE 32
+/** Maximum number of counter rows in sketch mode. */
+#define RTE_MEMBER_SKETCH_ROWS_MAX 16
+/** Maximum number of heavy hitters tracked in sketch mode. */
+#define RTE_MEMBER_SKETCH_TOPK_MAX (1 << 16)
+
+/** Sketch flag: update the counters for every key, never sample. */
+#define RTE_MEMBER_SKETCH_ALWAYS_BOUNDED 0x1
+/** Sketch flag: counters count bytes instead of keys. */
+#define RTE_MEMBER_SKETCH_COUNT_BYTE 0x2
 
 /** @internal Hash function used by membership library. */
 #if defined(RTE_ARCH_X86) || defined(RTE_MACHINE_CPUFLAG_CRC32)
@@ -134,6 +148,7 @@ struct rte_member_parameters;
 enum rte_member_setsum_type {
 	RTE_MEMBER_TYPE_HT = 0,  /**< Hash table based set summary. */
 	RTE_MEMBER_TYPE_VBF,     /**< Vector of bloom filters. */
+	RTE_MEMBER_TYPE_SKETCH,  /**< Count-min sketch with top-k heap. */
 	RTE_MEMBER_NUM_TYPE
 };
 
@@ -173,6 +188,14 @@ struct rte_member_setsum {
 	/* Second cache line should start here. */
 	uint32_t socket_id;          /* NUMA Socket ID for memory. */
 	char name[RTE_MEMBER_NAMESIZE]; /* Name of this set summary. */
+
+	/* Count-min sketch, the table is the sketch runtime. */
+	uint32_t num_row;	/* Number of counter rows. */
+	uint32_t num_col;	/* Number of counters per row. */
+	uint32_t col_mask;	/* Bit mask to get counter column in a row. */
+	uint32_t top_k;		/* Number of heavy hitters tracked. */
+	uint32_t sample_interval; /* Average keys between counter updates. */
+	uint8_t count_byte;	/* If counters count bytes instead of keys. */
 } __rte_cache_aligned;
 
 /**
@@ -235,6 +258,9 @@ struct rte_member_parameters {
 	 * number of bits we need for each BF. User does not specify the size of
 	 * each BF directly because the optimal size depends on the num_keys
 	 * and false positive rate.
+	 *
+	 * For sketch, num_keys is not used: the sketch size only depends on
+	 * error_rate and false_positive_rate.
 	 */
 	uint32_t num_keys;
 
@@ -273,6 +299,11 @@ struct rte_member_parameters {
 	 * to number of entries (num_keys) divided by entry count per bucket
 	 * (RTE_MEMBER_BUCKET_ENTRIES). Thus, the false_positive_rate is not
 	 * directly set by users for HT mode.
+	 *
+	 * For sketch, false_positive_rate is the probability that a count
+	 * estimate exceeds the error bound set by error_rate. The sketch uses
+	 * ceil(ln(1 / false_positive_rate)) rows of counters, at most
+	 * RTE_MEMBER_SKETCH_ROWS_MAX.
 	 */
 	float false_positive_rate;
 
@@ -292,6 +323,42 @@ struct rte_member_parameters {
 	uint32_t sec_hash_seed;
 
 	int socket_id;			/**< NUMA Socket ID for memory. */
+
+	/**
+	 * error_rate is only used for sketch.
+	 *
+	 * A count estimate never falls below the real count of the key and
+	 * exceeds it by at most error_rate times the total count of all keys,
+	 * with probability 1 - false_positive_rate. Each row of the sketch
+	 * has e / error_rate counters, rounded up to a power of 2.
+	 */
+	float error_rate;
+
+	/**
+	 * sample_rate is only used for sketch, when extra_flag does not have
+	 * RTE_MEMBER_SKETCH_ALWAYS_BOUNDED set.
+	 *
+	 * Fraction of the added keys that update the counters, each sampled
+	 * key counting for 1 / sample_rate keys. Sampling makes adds cheaper
+	 * at the cost of a sampling error on top of the error_rate bound, so
+	 * it suits the estimation of large counts. 0 or 1 disables sampling.
+	 */
+	float sample_rate;
+
+	/**
+	 * top_k is only used for sketch.
+	 *
+	 * Number of heavy hitters, i.e. keys with the largest count
+	 * estimates, kept by the sketch. Up to RTE_MEMBER_SKETCH_TOPK_MAX,
+	 * 0 disables heavy hitter tracking.
+	 */
+	uint32_t top_k;
+
+	/**
+	 * extra_flag is only used for sketch, as a combination of
+	 * RTE_MEMBER_SKETCH_* flags.
+	 */
+	uint32_t extra_flag;
 };
 
 /**
@@ -332,6 +399,9 @@ rte_member_create(const struct rte_member_parameters *params);
  * Lookup key in set-summary (SS).
  * Single key lookup and return as soon as the first match found
  *
+ * For sketch, the key matches set id 1 when it is one of the current
+ * heavy hitters.
+ *
  * @param setsum
  *   Pointer of a setsummary.
  * @param key
@@ -379,6 +449,7 @@ rte_member_lookup_bulk(const struct rte_member_setsum *setsum,
  * Note that for cache mode of HT, each key can have at most one match. This is
  * because keys with same signature that maps to same bucket will overwrite
  * each other. So multi-match lookup should be used for vBF and non-cache HT.
+ * Sketch does not support multi-match lookup and -EINVAL is returned.
  *
  * @param setsum
  *   Pointer of a set-summary.
@@ -407,6 +478,7 @@ rte_member_lookup_multi(const struct rte_member_setsum *setsum,
  * Each key lookup will find all matched entries (multiple match).
  * Note that for cache mode HT, each key can have at most one match. So
  * multi-match function is mainly used for vBF and non-cache mode HT.
+ * Sketch does not support multi-match lookup and -EINVAL is returned.
  *
  * @param setsum
  *   Pointer of a setsummary.
@@ -460,11 +532,74 @@ rte_member_lookup_multi_bulk(const struct rte_member_setsum *setsum,
  *   eviction, return 1 otherwise. Return 0 for non-cache mode if success,
  *   -ENOSPC for full, and 1 if cuckoo eviction happens.
  *   Always returns 0 for vBF mode.
+ *   For sketch, set_id is ignored and the count of the key is increased
+ *   by one. Always returns 0, or -EINVAL for a sketch counting bytes.
  */
 int
 rte_member_add(const struct rte_member_setsum *setsum, const void *key,
 			member_set_t set_id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Add bytes to the count of a key in a sketch created with the
+ * RTE_MEMBER_SKETCH_COUNT_BYTE flag.
+ *
+ * @param setsum
+ *   Pointer of a sketch set-summary.
+ * @param key
+ *   Pointer of the key to be added.
+ * @param byte_count
+ *   Number of bytes to add, e.g. the length of the packet.
+ * @return
+ *   0 on success, -EINVAL for a set-summary that does not count bytes.
+ */
+int
+rte_member_add_byte_count(const struct rte_member_setsum *setsum,
+			const void *key, uint32_t byte_count);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Query the count estimate of a key in a sketch set-summary.
+ *
+ * @param setsum
+ *   Pointer of a sketch set-summary.
+ * @param key
+ *   Pointer of the key to be queried.
+ * @param count
+ *   Output the count estimate of the key, in keys or in bytes.
+ * @return
+ *   0 on success, -EINVAL for a set-summary that is not a sketch.
+ */
+int
+rte_member_query_count(const struct rte_member_setsum *setsum,
+			const void *key, uint64_t *count);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Report the heavy hitters of a sketch set-summary, in no particular order.
+ *
+ * @param setsum
+ *   Pointer of a sketch set-summary.
+ * @param keys
+ *   Output pointers to the heavy hitter keys, which stay valid until the
+ *   next add, delete or reset. User needs to preallocate the array that
+ *   can contain top_k pointers.
+ * @param counts
+ *   Output the count estimate of each heavy hitter, when not NULL.
+ * @return
+ *   The number of heavy hitters reported, -EINVAL for a set-summary that
+ *   is not a sketch.
+ */
+int
+rte_member_report_heavyhitter(const struct rte_member_setsum *setsum,
+			void **keys, uint64_t *counts);
+
 /**
  * @warning
  * @b EXPERIMENTAL: this API may change without prior notice
@@ -496,6 +631,8 @@ rte_member_reset(const struct rte_member_setsum *setsum);
  *
  * Delete items from the set-summary. Note that vBF does not support deletion
  * in current implementation. For vBF, error code of -EINVAL will be returned.
+ * For sketch, the key is removed from the heavy hitters, but its count is
+ * kept.
  *
  * @param setsum
  *   Pointer to the set-summary.
@@ -0,0 +1,447 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <rte_malloc.h>
+#include <rte_memory.h>
+#include <rte_errno.h>
+#include <rte_log.h>
+#include <rte_prefetch.h>
+#include <rte_random.h>
+#include <rte_hash.h>
+
+#include "rte_member.h"
+#include "rte_member_sketch.h"
+
+/* Smallest rte_hash, a single bucket */
+#define SKETCH_HASH_ENTRIES_MIN 8
+
+/*
+ * Count-min sketch: num_row rows of num_col 64-bit counters. Each row maps a
+ * key to one of its counters with its own hash, derived from two hashes of
+ * the key as for vBF. The count estimate of a key is the minimum of its
+ * counters, which can only be higher than the real count, because of the
+ * other keys sharing these counters.
+ *
+ * Counters are updated conservatively: the counters of a key are only raised
+ * up to the new estimate of the key, instead of all growing by the added
+ * count. This lowers the overestimation without breaking the lower bound.
+ *
+ * The heavy hitters are kept in a min-heap ordered by count estimate, so the
+ * root is the one evicted when another key overtakes it, and in a hash table
+ * to find the heap node of a key.
+ */
+
+struct sketch_node {
+	uint64_t count;		/* Count estimate at the last update. */
+	uint32_t pos;		/* Position in the heap. */
+	void *key;		/* Copy of the key. */
+};
+
+struct sketch {
+	uint64_t *counters;		/* num_row rows of num_col counters. */
+	struct sketch_node **heap;	/* heap_size nodes, then free nodes. */
+	struct sketch_node *nodes;	/* top_k nodes. */
+	uint8_t *node_keys;		/* top_k keys. */
+	struct rte_hash *heap_hash;	/* Heavy hitter key to heap node. */
+	uint32_t heap_size;		/* Number of heavy hitters. */
+	uint32_t skip;			/* Keys left until the next sample. */
+};
+
+int
+rte_member_create_sketch(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params)
+{
+	struct rte_hash_parameters hash_params;
+	char hash_name[RTE_HASH_NAMESIZE];
+	struct sketch *sk;
+	double num_row, num_col;
+	uint32_t i;
+
+	if (params->error_rate <= 0 || params->error_rate >= 1 ||
+			params->false_positive_rate <= 0 ||
+			params->false_positive_rate >= 1 ||
+			params->sample_rate < 0 || params->sample_rate > 1 ||
+			params->top_k > RTE_MEMBER_SKETCH_TOPK_MAX) {
+		rte_errno = EINVAL;
+		RTE_MEMBER_LOG(ERR, "Membership sketch create with invalid parameters\n");
+		return -EINVAL;
+	}
+
+	/*
+	 * With w = e / error_rate counters per row, the counter of a key in
+	 * one row exceeds its count by more than error_rate times the total
+	 * count with probability 1 / e at most. The minimum of d rows only
+	 * does with probability e^-d, hence d = ln(1 / false_positive_rate).
+	 */
+	num_row = ceil(log(1.0 / params->false_positive_rate));
+	num_col = rte_align64pow2((uint64_t)ceil(M_E / params->error_rate));
+	if (num_row > RTE_MEMBER_SKETCH_ROWS_MAX ||
+			num_row * num_col > UINT32_MAX) {
+		rte_errno = EINVAL;
+		RTE_MEMBER_LOG(ERR, "Membership sketch error or false positive "
+			"rate is too small\n");
+		return -EINVAL;
+	}
+
+	ss->num_row = num_row;
+	ss->num_col = num_col;
+	ss->col_mask = ss->num_col - 1;
+	ss->top_k = params->top_k;
+	ss->count_byte = !!(params->extra_flag & RTE_MEMBER_SKETCH_COUNT_BYTE);
+	ss->sample_interval = 1;
+	if (!(params->extra_flag & RTE_MEMBER_SKETCH_ALWAYS_BOUNDED) &&
+			params->sample_rate > 0 && params->sample_rate < 1)
+		ss->sample_interval = 1.0 / params->sample_rate + 0.5;
+
+	sk = rte_zmalloc_socket(NULL, sizeof(struct sketch) +
+			ss->top_k * (sizeof(struct sketch_node *) +
+			sizeof(struct sketch_node) + ss->key_len),
+			RTE_CACHE_LINE_SIZE, ss->socket_id);
+	if (sk == NULL)
+		return -ENOMEM;
+
+	sk->heap = (struct sketch_node **)&sk[1];
+	sk->nodes = (struct sketch_node *)&sk->heap[ss->top_k];
+	sk->node_keys = (uint8_t *)&sk->nodes[ss->top_k];
+	for (i = 0; i < ss->top_k; i++) {
+		sk->nodes[i].key = &sk->node_keys[i * ss->key_len];
+		sk->heap[i] = &sk->nodes[i];
+	}
+	sk->skip = 1;
+
+	sk->counters = rte_zmalloc_socket(NULL,
+			ss->num_row * ss->num_col * sizeof(uint64_t),
+			RTE_CACHE_LINE_SIZE, ss->socket_id);
+	if (sk->counters == NULL) {
+		rte_free(sk);
+		return -ENOMEM;
+	}
+
+	if (ss->top_k != 0) {
+		snprintf(hash_name, sizeof(hash_name), "SK_%s", ss->name);
+		memset(&hash_params, 0, sizeof(hash_params));
+		hash_params.name = hash_name;
+		hash_params.entries = RTE_MAX(2 * ss->top_k,
+				(uint32_t)SKETCH_HASH_ENTRIES_MIN);
+		hash_params.key_len = ss->key_len;
+		hash_params.hash_func_init_val = ss->prim_hash_seed;
+		hash_params.socket_id = ss->socket_id;
+
+		sk->heap_hash = rte_hash_create(&hash_params);
+		if (sk->heap_hash == NULL) {
+			RTE_MEMBER_LOG(ERR, "Membership sketch heavy hitter "
+				"hash table create failed\n");
+			rte_free(sk->counters);
+			rte_free(sk);
+			return -ENOMEM;
+		}
+	}
+
+	ss->table = sk;
+
+	RTE_MEMBER_LOG(DEBUG, "count-min sketch created, "
+		"%u rows of %u counters, top %u heavy hitters, "
+		"one update every %u keys\n",
+		ss->num_row, ss->num_col, ss->top_k, ss->sample_interval);
+
+	return 0;
+}
+
+static inline void
+sketch_cols(const struct rte_member_setsum *ss, const void *key,
+		uint32_t *idx)
+{
+	uint32_t h1 = MEMBER_HASH_FUNC(key, ss->key_len, ss->prim_hash_seed);
+	uint32_t h2 = MEMBER_HASH_FUNC(&h1, sizeof(uint32_t),
+						ss->sec_hash_seed);
+	uint32_t i;
+
+	for (i = 0; i < ss->num_row; i++)
+		idx[i] = i * ss->num_col + ((h1 + i * h2) & ss->col_mask);
+}
+
+static inline uint64_t
+sketch_estimate(const struct rte_member_setsum *ss, const uint64_t *counters,
+		const uint32_t *idx)
+{
+	uint64_t min = UINT64_MAX;
+	uint32_t i;
+
+	for (i = 0; i < ss->num_row; i++)
+		min = RTE_MIN(min, counters[idx[i]]);
+
+	return min;
+}
+
+static inline uint64_t
+sketch_update(const struct rte_member_setsum *ss, uint64_t *counters,
+		const uint32_t *idx, uint64_t count)
+{
+	uint64_t estimate;
+	uint32_t i;
+
+	/* Each row is a different cache line, get all the misses going */
+	for (i = 0; i < ss->num_row; i++)
+		rte_prefetch0(&counters[idx[i]]);
+
+	estimate = sketch_estimate(ss, counters, idx) + count;
+
+	for (i = 0; i < ss->num_row; i++)
+		counters[idx[i]] = RTE_MAX(counters[idx[i]], estimate);
+
+	return estimate;
+}
+
+static inline void
+heap_swap(struct sketch *sk, uint32_t a, uint32_t b)
+{
+	struct sketch_node *node = sk->heap[a];
+
+	sk->heap[a] = sk->heap[b];
+	sk->heap[b] = node;
+	sk->heap[a]->pos = a;
+	sk->heap[b]->pos = b;
+}
+
+static void
+heap_sift_up(struct sketch *sk, uint32_t pos)
+{
+	while (pos > 0) {
+		uint32_t parent = (pos - 1) / 2;
+
+		if (sk->heap[parent]->count <= sk->heap[pos]->count)
+			break;
+		heap_swap(sk, parent, pos);
+		pos = parent;
+	}
+}
+
+static void
+heap_sift_down(struct sketch *sk, uint32_t pos)
+{
+	struct sketch_node **heap = sk->heap;
+
+	for (;;) {
+		uint32_t child = 2 * pos + 1;
+		uint32_t min = pos;
+
+		if (child < sk->heap_size &&
+				heap[child]->count < heap[min]->count)
+			min = child;
+		if (child + 1 < sk->heap_size &&
+				heap[child + 1]->count < heap[min]->count)
+			min = child + 1;
+		if (min == pos)
+			break;
+		heap_swap(sk, pos, min);
+		pos = min;
+	}
+}
+
+/* Move the node out of the heap, to the first free node. */
+static void
+heap_remove(struct sketch *sk, uint32_t pos)
+{
+	uint32_t last = --sk->heap_size;
+
+	if (pos == last)
+		return;
+	heap_swap(sk, pos, last);
+	heap_sift_down(sk, pos);
+	heap_sift_up(sk, pos);
+}
+
+static void
+sketch_topk_update(const struct rte_member_setsum *ss, struct sketch *sk,
+		const void *key, uint64_t estimate)
+{
+	struct sketch_node *node;
+	void *data;
+
+	if (ss->top_k == 0)
+		return;
+
+	/*
+	 * Estimates never decrease, so a key below the root of a full heap
+	 * cannot be in it: most keys are done without the hash lookup.
+	 */
+	if (sk->heap_size == ss->top_k && estimate < sk->heap[0]->count)
+		return;
+
+	if (rte_hash_lookup_data(sk->heap_hash, key, &data) >= 0) {
+		node = data;
+		node->count = estimate;
+		heap_sift_down(sk, node->pos);
+		return;
+	}
+
+	if (sk->heap_size < ss->top_k) {
+		node = sk->heap[sk->heap_size];
+		memcpy(node->key, key, ss->key_len);
+		node->count = estimate;
+		if (rte_hash_add_key_data(sk->heap_hash, node->key, node) < 0)
+			return;
+		node->pos = sk->heap_size++;
+		heap_sift_up(sk, node->pos);
+		return;
+	}
+
+	/* On a tie the current heavy hitter stays */
+	if (estimate == sk->heap[0]->count)
+		return;
+
+	node = sk->heap[0];
+	rte_hash_del_key(sk->heap_hash, node->key);
+	memcpy(node->key, key, ss->key_len);
+	node->count = estimate;
+	if (rte_hash_add_key_data(sk->heap_hash, node->key, node) < 0) {
+		heap_remove(sk, 0);
+		return;
+	}
+	heap_sift_down(sk, 0);
+}
+
+int
+rte_member_add_sketch(const struct rte_member_setsum *ss,
+		const void *key, uint32_t count)
+{
+	struct sketch *sk = ss->table;
+	uint32_t idx[RTE_MEMBER_SKETCH_ROWS_MAX];
+	uint64_t estimate;
+
+	if (ss->sample_interval != 1) {
+		if (--sk->skip != 0)
+			return 0;
+		/* Between 1 and 2 * interval - 1 keys, interval on average */
+		sk->skip = 1 + rte_rand() % (2 * ss->sample_interval - 1);
+	}
+
+	sketch_cols(ss, key, idx);
+	estimate = sketch_update(ss, sk->counters, idx,
+			(uint64_t)count * ss->sample_interval);
+	sketch_topk_update(ss, sk, key, estimate);
+
+	return 0;
+}
+
+int
+rte_member_query_sketch(const struct rte_member_setsum *ss,
+		const void *key, uint64_t *count)
+{
+	struct sketch *sk = ss->table;
+	uint32_t idx[RTE_MEMBER_SKETCH_ROWS_MAX];
+
+	sketch_cols(ss, key, idx);
+	*count = sketch_estimate(ss, sk->counters, idx);
+
+	return 0;
+}
+
+int
+rte_member_lookup_sketch(const struct rte_member_setsum *ss,
+		const void *key, member_set_t *set_id)
+{
+	struct sketch *sk = ss->table;
+
+	if (ss->top_k != 0 && rte_hash_lookup(sk->heap_hash, key) >= 0) {
+		*set_id = 1;
+		return 1;
+	}
+
+	*set_id = RTE_MEMBER_NO_MATCH;
+	return 0;
+}
+
+uint32_t
+rte_member_lookup_bulk_sketch(const struct rte_member_setsum *ss,
+		const void **keys, uint32_t num_keys, member_set_t *set_ids)
+{
+	struct sketch *sk = ss->table;
+	int32_t positions[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t num_matches = 0;
+	uint32_t i, j, n;
+
+	for (i = 0; i < num_keys; i += n) {
+		n = RTE_MIN(num_keys - i, (uint32_t)RTE_HASH_LOOKUP_BULK_MAX);
+
+		if (ss->top_k == 0) {
+			for (j = 0; j < n; j++)
+				set_ids[i + j] = RTE_MEMBER_NO_MATCH;
+			continue;
+		}
+
+		rte_hash_lookup_bulk(sk->heap_hash, &keys[i], n, positions);
+		for (j = 0; j < n; j++) {
+			if (positions[j] >= 0) {
+				set_ids[i + j] = 1;
+				num_matches++;
+			} else
+				set_ids[i + j] = RTE_MEMBER_NO_MATCH;
+		}
+	}
+
+	return num_matches;
+}
+
+int
+rte_member_report_heavyhitter_sketch(const struct rte_member_setsum *ss,
+		void **keys, uint64_t *counts)
+{
+	struct sketch *sk = ss->table;
+	uint32_t i;
+
+	for (i = 0; i < sk->heap_size; i++) {
+		keys[i] = sk->heap[i]->key;
+		if (counts != NULL)
+			counts[i] = sk->heap[i]->count;
+	}
+
+	return sk->heap_size;
+}
+
+int
+rte_member_delete_sketch(const struct rte_member_setsum *ss,
+		const void *key)
+{
+	struct sketch *sk = ss->table;
+	struct sketch_node *node;
+	void *data;
+
+	if (ss->top_k == 0 ||
+			rte_hash_lookup_data(sk->heap_hash, key, &data) < 0)
+		return -ENOENT;
+
+	node = data;
+	rte_hash_del_key(sk->heap_hash, node->key);
+	heap_remove(sk, node->pos);
+
+	return 0;
+}
+
+void
+rte_member_free_sketch(struct rte_member_setsum *ss)
+{
+	struct sketch *sk = ss->table;
+
+	rte_hash_free(sk->heap_hash);
+	rte_free(sk->counters);
+	rte_free(sk);
+}
+
+void
+rte_member_reset_sketch(const struct rte_member_setsum *ss)
+{
+	struct sketch *sk = ss->table;
+
+	memset(sk->counters, 0,
+		ss->num_row * ss->num_col * sizeof(uint64_t));
+	if (sk->heap_hash != NULL)
+		rte_hash_reset(sk->heap_hash);
+	sk->heap_size = 0;
+	sk->skip = 1;
+}
@@ -0,0 +1,51 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef _RTE_MEMBER_SKETCH_H_
+#define _RTE_MEMBER_SKETCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int
+rte_member_create_sketch(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params);
+
+int
+rte_member_lookup_sketch(const struct rte_member_setsum *setsum,
+		const void *key, member_set_t *set_id);
+
+uint32_t
+rte_member_lookup_bulk_sketch(const struct rte_member_setsum *setsum,
+		const void **keys, uint32_t num_keys,
+		member_set_t *set_ids);
+
+int
+rte_member_add_sketch(const struct rte_member_setsum *setsum,
+		const void *key, uint32_t count);
+
+int
+rte_member_query_sketch(const struct rte_member_setsum *setsum,
+		const void *key, uint64_t *count);
+
+int
+rte_member_report_heavyhitter_sketch(const struct rte_member_setsum *setsum,
+		void **keys, uint64_t *counts);
+
+int
+rte_member_delete_sketch(const struct rte_member_setsum *setsum,
+		const void *key);
+
+void
+rte_member_free_sketch(struct rte_member_setsum *ss);
+
+void
+rte_member_reset_sketch(const struct rte_member_setsum *setsum);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_MEMBER_SKETCH_H_ */
@@ -0,0 +1,155 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_ethdev.h>
+#include <rte_graph.h>
+
+#include "rte_node_eth_api.h"
+#include "node_private.h"
+
+/* an ethdev_rx or ethdev_tx clone */
+struct ethdev_node_data {
+	rte_node_t id;
+	uint16_t port_id;
+	uint16_t queue_id;     /* Rx queue of an ethdev_rx clone */
+	uint16_t nb_tx_queues; /* Tx queues of an ethdev_tx clone */
+};
+
+static struct ethdev_node_data *node_data;
+static unsigned int nb_node_data;
+
+int rte_node_logtype;
+
+RTE_INIT(rte_node_init_log);
+
+static void
+rte_node_init_log(void)
+{
+	rte_node_logtype = rte_log_register("librte.node");
+	if (rte_node_logtype >= 0)
+		rte_log_set_level(rte_node_logtype, RTE_LOG_INFO);
+}
+
+static struct ethdev_node_data *
+node_data_find(rte_node_t id)
+{
+	unsigned int i;
+
+	for (i = 0; i < nb_node_data; i++)
+		if (node_data[i].id == id)
+			return &node_data[i];
+	return NULL;
+}
+
+int
+ethdev_rx_node_data_get(rte_node_t id, uint16_t *port_id, uint16_t *queue_id)
+{
+	struct ethdev_node_data *data = node_data_find(id);
+
+	if (data == NULL)
+		return -ENOENT;
+	*port_id = data->port_id;
+	*queue_id = data->queue_id;
+	return 0;
+}
+
+int
+ethdev_tx_node_data_get(rte_node_t id, uint16_t *port_id,
+		uint16_t *nb_tx_queues)
+{
+	struct ethdev_node_data *data = node_data_find(id);
+
+	if (data == NULL)
+		return -ENOENT;
+	*port_id = data->port_id;
+	*nb_tx_queues = data->nb_tx_queues;
+	return 0;
+}
+
+static int
+node_data_add(rte_node_t id, uint16_t port_id, uint16_t queue_id,
+		uint16_t nb_tx_queues)
+{
+	struct ethdev_node_data *data;
+
+	data = realloc(node_data, (nb_node_data + 1) * sizeof(*data));
+	if (data == NULL)
+		return -ENOMEM;
+	node_data = data;
+	data = &node_data[nb_node_data++];
+	data->id = id;
+	data->port_id = port_id;
+	data->queue_id = queue_id;
+	data->nb_tx_queues = nb_tx_queues;
+	return 0;
+}
+
+int
+rte_node_eth_config(struct rte_node_ethdev_config *cfg, uint16_t cnt,
+		uint16_t nb_graphs)
+{
+	char name[RTE_NODE_NAMESIZE];
+	const char *next_node = name;
+	rte_node_t rx_id = ethdev_rx_node_get()->id;
+	rte_node_t tx_id = ethdev_tx_node_get()->id;
+	rte_node_t ip4_rewrite_id = ip4_rewrite_node_get()->id;
+	rte_node_t id;
+	rte_edge_t edge;
+	uint16_t i, q;
+	int ret;
+
+	if (cfg == NULL)
+		return -EINVAL;
+
+	for (i = 0; i < cnt; i++) {
+		if (!rte_eth_dev_is_valid_port(cfg[i].port_id))
+			return -EINVAL;
+		if (cfg[i].num_tx_queues < nb_graphs) {
+			NODE_LOG(ERR, "port %u: %u Tx queues for %u graphs",
+				cfg[i].port_id, cfg[i].num_tx_queues,
+				nb_graphs);
+			return -EINVAL;
+		}
+
+		for (q = 0; q < cfg[i].num_rx_queues; q++) {
+			snprintf(name, sizeof(name), "%u-%u", cfg[i].port_id,
+				q);
+			id = rte_node_clone(rx_id, name);
+			if (id == RTE_NODE_ID_INVALID)
+				return -rte_errno;
+			ret = node_data_add(id, cfg[i].port_id, q, 0);
+			if (ret < 0)
+				return ret;
+		}
+
+		snprintf(name, sizeof(name), "%u", cfg[i].port_id);
+		id = rte_node_clone(tx_id, name);
+		if (id == RTE_NODE_ID_INVALID)
+			return -rte_errno;
+		ret = node_data_add(id, cfg[i].port_id, 0,
+			cfg[i].num_tx_queues);
+		if (ret < 0)
+			return ret;
+
+		/* next node of ip4_rewrite to this port */
+		snprintf(name, sizeof(name), "%s", rte_node_id_to_name(id));
+		edge = rte_node_edge_count(ip4_rewrite_id);
+		if (rte_node_edge_update(ip4_rewrite_id, RTE_EDGE_ID_INVALID,
+				&next_node, 1) == RTE_EDGE_ID_INVALID)
+			return -EINVAL;
+		ret = ip4_rewrite_port_edge_set(cfg[i].port_id, edge);
+		if (ret < 0)
+			return ret;
+
+		NODE_LOG(DEBUG, "port %u: %u Rx nodes, Tx node %s edge %u",
+			cfg[i].port_id, cfg[i].num_rx_queues, name, edge);
+	}
+	return 0;
+}
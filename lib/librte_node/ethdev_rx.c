@@ -0,0 +1,73 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <rte_common.h>
+#include <rte_ethdev.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_mbuf.h>
+
+#include "rte_node_eth_api.h"
+#include "node_private.h"
+
+enum ethdev_rx_next {
+	ETHDEV_RX_NEXT_IP4_LOOKUP,
+	ETHDEV_RX_NEXT_MAX,
+};
+
+struct ethdev_rx_node_ctx {
+	uint16_t port_id;
+	uint16_t queue_id;
+};
+
+static uint16_t
+ethdev_rx_node_process(struct rte_graph *graph, struct rte_node *node,
+		void **objs, uint16_t nb_objs)
+{
+	struct ethdev_rx_node_ctx *ctx = (struct ethdev_rx_node_ctx *)node->ctx;
+	uint16_t count;
+
+	RTE_SET_USED(objs);
+	RTE_SET_USED(nb_objs);
+
+	count = rte_eth_rx_burst(ctx->port_id, ctx->queue_id,
+		(struct rte_mbuf **)node->objs, node->size);
+	if (count == 0)
+		return 0;
+
+	node->idx = count;
+	rte_node_next_stream_move(graph, node, ETHDEV_RX_NEXT_IP4_LOOKUP);
+	return count;
+}
+
+static int
+ethdev_rx_node_init(const struct rte_graph *graph, struct rte_node *node)
+{
+	struct ethdev_rx_node_ctx *ctx = (struct ethdev_rx_node_ctx *)node->ctx;
+
+	RTE_BUILD_BUG_ON(sizeof(*ctx) > RTE_NODE_CTX_SZ);
+	RTE_SET_USED(graph);
+
+	return ethdev_rx_node_data_get(node->id, &ctx->port_id,
+		&ctx->queue_id);
+}
+
+static struct rte_node_register ethdev_rx_node = {
+	.name = "ethdev_rx",
+	.flags = RTE_NODE_SOURCE_F,
+	.process = ethdev_rx_node_process,
+	.init = ethdev_rx_node_init,
+	.nb_edges = ETHDEV_RX_NEXT_MAX,
+	.next_nodes = {
+		[ETHDEV_RX_NEXT_IP4_LOOKUP] = "ip4_lookup",
+	},
+};
+
+struct rte_node_register *
+ethdev_rx_node_get(void)
+{
+	return &ethdev_rx_node;
+}
+
+RTE_NODE_REGISTER(ethdev_rx_node);
@@ -0,0 +1,80 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_ethdev.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_mbuf.h>
+
+#include "rte_node_eth_api.h"
+#include "node_private.h"
+
+enum ethdev_tx_next {
+	ETHDEV_TX_NEXT_PKT_DROP,
+	ETHDEV_TX_NEXT_MAX,
+};
+
+struct ethdev_tx_node_ctx {
+	uint16_t port_id;
+	uint16_t queue_id;
+};
+
+static uint16_t
+ethdev_tx_node_process(struct rte_graph *graph, struct rte_node *node,
+		void **objs, uint16_t nb_objs)
+{
+	struct ethdev_tx_node_ctx *ctx = (struct ethdev_tx_node_ctx *)node->ctx;
+	uint16_t count;
+
+	count = rte_eth_tx_burst(ctx->port_id, ctx->queue_id,
+		(struct rte_mbuf **)objs, nb_objs);
+	if (unlikely(count != nb_objs))
+		rte_node_enqueue(graph, node, ETHDEV_TX_NEXT_PKT_DROP,
+			&objs[count], nb_objs - count);
+	return count;
+}
+
+static int
+ethdev_tx_node_init(const struct rte_graph *graph, struct rte_node *node)
+{
+	struct ethdev_tx_node_ctx *ctx = (struct ethdev_tx_node_ctx *)node->ctx;
+	uint16_t nb_tx_queues;
+	int ret;
+
+	RTE_BUILD_BUG_ON(sizeof(*ctx) > RTE_NODE_CTX_SZ);
+
+	ret = ethdev_tx_node_data_get(node->id, &ctx->port_id, &nb_tx_queues);
+	if (ret < 0)
+		return ret;
+
+	/* each graph has a Tx queue of its own */
+	if (graph->id >= nb_tx_queues) {
+		NODE_LOG(ERR, "graph %s: no Tx queue %u on port %u",
+			graph->name, graph->id, ctx->port_id);
+		return -ERANGE;
+	}
+	ctx->queue_id = graph->id;
+	return 0;
+}
+
+static struct rte_node_register ethdev_tx_node = {
+	.name = "ethdev_tx",
+	.process = ethdev_tx_node_process,
+	.init = ethdev_tx_node_init,
+	.nb_edges = ETHDEV_TX_NEXT_MAX,
+	.next_nodes = {
+		[ETHDEV_TX_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+struct rte_node_register *
+ethdev_tx_node_get(void)
+{
+	return &ethdev_tx_node;
+}
+
+RTE_NODE_REGISTER(ethdev_tx_node);
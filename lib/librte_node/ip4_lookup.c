@@ -0,0 +1,164 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+#include <stdio.h>
+
+#include <rte_byteorder.h>
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_ip.h>
+#include <rte_lcore.h>
+#include <rte_lpm.h>
+#include <rte_mbuf.h>
+
+#include "rte_node_ip4_api.h"
+#include "node_private.h"
+
+#define IP4_LOOKUP_MAX_ROUTES (1 << 16)
+#define IP4_LOOKUP_NUMBER_TBL8S (1 << 8)
+
+/* next node and next hop of a route, in its LPM next hop */
+#define IP4_LOOKUP_NEXT_SHIFT 16
+#define IP4_LOOKUP_NH_MASK ((1 << IP4_LOOKUP_NEXT_SHIFT) - 1)
+
+struct ip4_lookup_node_ctx {
+	struct rte_lpm *lpm;
+	rte_edge_t next_index; /* next node of the last packet */
+};
+
+/* routes of each socket */
+static struct rte_lpm *ip4_lookup_lpm[RTE_MAX_NUMA_NODES];
+
+static uint16_t
+ip4_lookup_node_process(struct rte_graph *graph, struct rte_node *node,
+		void **objs, uint16_t nb_objs)
+{
+	struct ip4_lookup_node_ctx *ctx =
+		(struct ip4_lookup_node_ctx *)node->ctx;
+	const uint16_t ether_type_ip4 = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+	rte_edge_t next_index = ctx->next_index, next = next_index;
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	struct ether_hdr *eth;
+	struct ipv4_hdr *ip;
+	struct rte_mbuf *m;
+	void **to_next;
+	uint16_t held = 0, i;
+	uint32_t res;
+
+	/* speculate all the packets go to the next node of the last one */
+	to_next = rte_node_next_stream_get(graph, node, next_index, nb_objs);
+
+	for (i = 0; i < nb_objs; i++) {
+		m = pkts[i];
+		if (likely(i + 1 < nb_objs))
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[i + 1], void *));
+
+		eth = rte_pktmbuf_mtod(m, struct ether_hdr *);
+		ip = (struct ipv4_hdr *)(eth + 1);
+		if (likely(eth->ether_type == ether_type_ip4 &&
+				rte_lpm_lookup(ctx->lpm,
+					rte_be_to_cpu_32(ip->dst_addr),
+					&res) == 0)) {
+			next = res >> IP4_LOOKUP_NEXT_SHIFT;
+			m->udata64 = res & IP4_LOOKUP_NH_MASK;
+		} else {
+			next = RTE_NODE_IP4_LOOKUP_NEXT_PKT_DROP;
+		}
+
+		if (likely(next == next_index)) {
+			to_next[held++] = m;
+			continue;
+		}
+		rte_node_enqueue_x1(graph, node, next, m);
+	}
+
+	if (likely(held == nb_objs)) {
+		/* speculation right for all: hand the whole stream over */
+		rte_node_next_stream_move(graph, node, next_index);
+		return nb_objs;
+	}
+	rte_node_next_stream_put(graph, node, next_index, held);
+	/* speculate the next time on the next node of the last packet */
+	ctx->next_index = next;
+	return nb_objs;
+}
+
+static struct rte_lpm *
+ip4_lookup_lpm_get(int socket)
+{
+	struct rte_lpm_config config = {
+		.max_rules = IP4_LOOKUP_MAX_ROUTES,
+		.number_tbl8s = IP4_LOOKUP_NUMBER_TBL8S,
+	};
+	char name[RTE_LPM_NAMESIZE];
+
+	if (socket < 0 || socket >= RTE_MAX_NUMA_NODES)
+		socket = 0;
+	if (ip4_lookup_lpm[socket] != NULL)
+		return ip4_lookup_lpm[socket];
+
+	snprintf(name, sizeof(name), "ip4_lookup_%d", socket);
+	ip4_lookup_lpm[socket] = rte_lpm_create(name, socket, &config);
+	if (ip4_lookup_lpm[socket] == NULL)
+		NODE_LOG(ERR, "cannot create LPM of socket %d: %s", socket,
+			rte_strerror(rte_errno));
+	return ip4_lookup_lpm[socket];
+}
+
+int
+rte_node_ip4_route_add(uint32_t ip, uint8_t depth, uint16_t next_hop,
+		enum rte_node_ip4_lookup_next next_node)
+{
+	uint32_t res = (uint32_t)next_node << IP4_LOOKUP_NEXT_SHIFT |
+		next_hop;
+	struct rte_lpm *lpm;
+	unsigned int lcore_id;
+	int ret;
+
+	if (next_node >= RTE_NODE_IP4_LOOKUP_NEXT_MAX ||
+			next_hop >= RTE_NODE_IP4_REWRITE_NH_MAX)
+		return -EINVAL;
+
+	RTE_LCORE_FOREACH(lcore_id) {
+		lpm = ip4_lookup_lpm_get(rte_lcore_to_socket_id(lcore_id));
+		if (lpm == NULL)
+			return -ENOMEM;
+		ret = rte_lpm_add(lpm, ip, depth, res);
+		if (ret < 0)
+			return ret;
+	}
+	return 0;
+}
+
+static int
+ip4_lookup_node_init(const struct rte_graph *graph, struct rte_node *node)
+{
+	struct ip4_lookup_node_ctx *ctx =
+		(struct ip4_lookup_node_ctx *)node->ctx;
+
+	RTE_BUILD_BUG_ON(sizeof(*ctx) > RTE_NODE_CTX_SZ);
+
+	ctx->lpm = ip4_lookup_lpm_get(graph->socket);
+	if (ctx->lpm == NULL)
+		return -ENOMEM;
+	ctx->next_index = RTE_NODE_IP4_LOOKUP_NEXT_REWRITE;
+	return 0;
+}
+
+static struct rte_node_register ip4_lookup_node = {
+	.name = "ip4_lookup",
+	.process = ip4_lookup_node_process,
+	.init = ip4_lookup_node_init,
+	.nb_edges = RTE_NODE_IP4_LOOKUP_NEXT_MAX,
+	.next_nodes = {
+		[RTE_NODE_IP4_LOOKUP_NEXT_REWRITE] = "ip4_rewrite",
+		[RTE_NODE_IP4_LOOKUP_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+RTE_NODE_REGISTER(ip4_lookup_node);
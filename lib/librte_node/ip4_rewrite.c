@@ -0,0 +1,158 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <rte_atomic.h>
+#include <rte_byteorder.h>
+#include <rte_common.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_ip.h>
+#include <rte_mbuf.h>
+
+#include "rte_node_ip4_api.h"
+#include "node_private.h"
+
+enum ip4_rewrite_next {
+	IP4_REWRITE_NEXT_PKT_DROP,
+	/* then the ethdev_tx clones, added by rte_node_eth_config() */
+};
+
+struct ip4_rewrite_nh {
+	rte_edge_t tx_node;  /* next node, IP4_REWRITE_NEXT_PKT_DROP if unset */
+	uint8_t rewrite_len;
+	uint8_t rewrite_data[RTE_NODE_IP4_REWRITE_DATA_MAX];
+} __rte_aligned(4);
+
+struct ip4_rewrite_node_ctx {
+	rte_edge_t next_index; /* next node of the last packet */
+};
+
+static struct ip4_rewrite_nh ip4_rewrite_nh[RTE_NODE_IP4_REWRITE_NH_MAX];
+static rte_edge_t ip4_rewrite_port_edge[RTE_MAX_ETHPORTS];
+
+static uint16_t
+ip4_rewrite_node_process(struct rte_graph *graph, struct rte_node *node,
+		void **objs, uint16_t nb_objs)
+{
+	struct ip4_rewrite_node_ctx *ctx =
+		(struct ip4_rewrite_node_ctx *)node->ctx;
+	rte_edge_t next_index = ctx->next_index, next = next_index;
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	const struct ip4_rewrite_nh *nh;
+	struct ipv4_hdr *ip;
+	struct rte_mbuf *m;
+	uint8_t *data;
+	void **to_next;
+	uint16_t held = 0, i;
+	uint32_t csum;
+
+	/* speculate all the packets go to the next node of the last one */
+	to_next = rte_node_next_stream_get(graph, node, next_index, nb_objs);
+
+	for (i = 0; i < nb_objs; i++) {
+		m = pkts[i];
+		if (likely(i + 1 < nb_objs))
+			rte_prefetch0(&ip4_rewrite_nh[pkts[i + 1]->udata64]);
+
+		nh = &ip4_rewrite_nh[m->udata64];
+		data = rte_pktmbuf_mtod(m, uint8_t *);
+		ip = (struct ipv4_hdr *)(data + sizeof(struct ether_hdr));
+		next = nh->tx_node;
+		if (unlikely(ip->time_to_live <= 1))
+			next = IP4_REWRITE_NEXT_PKT_DROP;
+
+		if (likely(next != IP4_REWRITE_NEXT_PKT_DROP)) {
+			/* RFC 1141 incremental update for the TTL decrement */
+			ip->time_to_live--;
+			csum = ip->hdr_checksum + rte_cpu_to_be_16(0x0100);
+			ip->hdr_checksum = csum + (csum >> 16);
+			memcpy(data, nh->rewrite_data, nh->rewrite_len);
+		}
+
+		if (likely(next == next_index)) {
+			to_next[held++] = m;
+			continue;
+		}
+		rte_node_enqueue_x1(graph, node, next, m);
+	}
+
+	if (likely(held == nb_objs)) {
+		/* speculation right for all: hand the whole stream over */
+		rte_node_next_stream_move(graph, node, next_index);
+		return nb_objs;
+	}
+	rte_node_next_stream_put(graph, node, next_index, held);
+	/* speculate the next time on the next node of the last packet */
+	ctx->next_index = next;
+	return nb_objs;
+}
+
+int
+ip4_rewrite_port_edge_set(uint16_t port_id, rte_edge_t edge)
+{
+	if (port_id >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+	ip4_rewrite_port_edge[port_id] = edge;
+	return 0;
+}
+
+int
+rte_node_ip4_rewrite_add(uint16_t next_hop, uint8_t *rewrite_data,
+		uint8_t rewrite_len, uint16_t dst_port)
+{
+	struct ip4_rewrite_nh *nh;
+
+	if (next_hop >= RTE_NODE_IP4_REWRITE_NH_MAX ||
+			rewrite_len > RTE_NODE_IP4_REWRITE_DATA_MAX ||
+			(rewrite_data == NULL && rewrite_len > 0) ||
+			dst_port >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+	if (ip4_rewrite_port_edge[dst_port] == IP4_REWRITE_NEXT_PKT_DROP)
+		return -ENODEV;
+
+	nh = &ip4_rewrite_nh[next_hop];
+	nh->tx_node = IP4_REWRITE_NEXT_PKT_DROP;
+	rte_wmb();
+	if (rewrite_len > 0)
+		memcpy(nh->rewrite_data, rewrite_data, rewrite_len);
+	nh->rewrite_len = rewrite_len;
+	rte_wmb();
+	nh->tx_node = ip4_rewrite_port_edge[dst_port];
+	return 0;
+}
+
+static int
+ip4_rewrite_node_init(const struct rte_graph *graph, struct rte_node *node)
+{
+	struct ip4_rewrite_node_ctx *ctx =
+		(struct ip4_rewrite_node_ctx *)node->ctx;
+
+	RTE_BUILD_BUG_ON(sizeof(*ctx) > RTE_NODE_CTX_SZ);
+	RTE_SET_USED(graph);
+
+	ctx->next_index = IP4_REWRITE_NEXT_PKT_DROP;
+	return 0;
+}
+
+static struct rte_node_register ip4_rewrite_node = {
+	.name = "ip4_rewrite",
+	.process = ip4_rewrite_node_process,
+	.init = ip4_rewrite_node_init,
+	.nb_edges = 1,
+	.next_nodes = {
+		[IP4_REWRITE_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+struct rte_node_register *
+ip4_rewrite_node_get(void)
+{
+	return &ip4_rewrite_node;
+}
+
+RTE_NODE_REGISTER(ip4_rewrite_node);
@@ -0,0 +1,31 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef _NODE_PRIVATE_H_
+#define _NODE_PRIVATE_H_
+
+#include <rte_graph.h>
+#include <rte_log.h>
+
+extern int rte_node_logtype;
+
+#define NODE_LOG(level, fmt, args...) \
+	rte_log(RTE_LOG_ ## level, rte_node_logtype, "%s(): " fmt "\n", \
+		__func__, ##args)
+
+/* node registrations, for their ids */
+struct rte_node_register *ethdev_rx_node_get(void);
+struct rte_node_register *ethdev_tx_node_get(void);
+struct rte_node_register *ip4_rewrite_node_get(void);
+
+/* ethdev_rx and ethdev_tx clone data, set by rte_node_eth_config() */
+int ethdev_rx_node_data_get(rte_node_t id, uint16_t *port_id,
+		uint16_t *queue_id);
+int ethdev_tx_node_data_get(rte_node_t id, uint16_t *port_id,
+		uint16_t *nb_tx_queues);
+
+/* next node of ip4_rewrite to a port */
+int ip4_rewrite_port_edge_set(uint16_t port_id, rte_edge_t edge);
+
+#endif /* _NODE_PRIVATE_H_ */
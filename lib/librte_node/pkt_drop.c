@@ -0,0 +1,28 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <rte_common.h>
+#include <rte_graph.h>
+#include <rte_mbuf.h>
+
+static uint16_t
+pkt_drop_node_process(struct rte_graph *graph, struct rte_node *node,
+		void **objs, uint16_t nb_objs)
+{
+	uint16_t i;
+
+	RTE_SET_USED(graph);
+	RTE_SET_USED(node);
+
+	for (i = 0; i < nb_objs; i++)
+		rte_pktmbuf_free(objs[i]);
+	return nb_objs;
+}
+
+static struct rte_node_register pkt_drop_node = {
+	.name = "pkt_drop",
+	.process = pkt_drop_node_process,
+};
+
+RTE_NODE_REGISTER(pkt_drop_node);
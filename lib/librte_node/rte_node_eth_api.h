@@ -0,0 +1,61 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef _RTE_NODE_ETH_API_H_
+#define _RTE_NODE_ETH_API_H_
+
+/**
+ * @file
+ *
+ * RTE ethdev nodes
+ *
+ * The ethdev_rx node is a source node receiving packets from an ethdev Rx
+ * queue, and passing them on to ip4_lookup. It is cloned for each Rx queue
+ * as "ethdev_rx-<port>-<queue>", so a graph polls the queues of the clones
+ * it has.
+ *
+ * The ethdev_tx node sends packets to an ethdev Tx queue, those the queue
+ * cannot take are dropped. It is cloned for each port as
+ * "ethdev_tx-<port>", and a graph uses the Tx queue of the port matching
+ * its graph id.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Port configuration of rte_node_eth_config(). */
+struct rte_node_ethdev_config {
+	uint16_t port_id;       /**< Port id. */
+	uint16_t num_rx_queues; /**< Number of Rx queues configured. */
+	uint16_t num_tx_queues; /**< Number of Tx queues configured. */
+};
+
+/**
+ * Create the ethdev_rx and ethdev_tx clones of configured and started
+ * ports, and add the ethdev_tx clones to the next nodes of ip4_rewrite.
+ *
+ * It is called once, before the graphs are created.
+ *
+ * @param cfg
+ *   Configuration of each port.
+ * @param cnt
+ *   Number of ports.
+ * @param nb_graphs
+ *   Number of graphs that will be created, each needs its own Tx queue.
+ * @return
+ *   0 on success, negative otherwise.
+ */
+int rte_node_eth_config(struct rte_node_ethdev_config *cfg, uint16_t cnt,
+		uint16_t nb_graphs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_NODE_ETH_API_H_ */
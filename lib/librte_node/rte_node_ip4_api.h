@@ -0,0 +1,83 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef _RTE_NODE_IP4_API_H_
+#define _RTE_NODE_IP4_API_H_
+
+/**
+ * @file
+ *
+ * RTE IPv4 nodes
+ *
+ * The ip4_lookup node looks up the destination address of IPv4 packets in
+ * an LPM table, one per socket, and passes them on to ip4_rewrite with the
+ * next hop of the route. Packets which are not IPv4 or have no route are
+ * dropped.
+ *
+ * The ip4_rewrite node decrements the TTL, rewrites the Ethernet header
+ * with the data of the next hop and passes the packets on to the ethdev_tx
+ * node of its port. Packets with a TTL of 1 or less, or to a next hop
+ * without rewrite data, are dropped.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Max number of next hops. */
+#define RTE_NODE_IP4_REWRITE_NH_MAX 1024
+
+/** Max length of the rewrite data of a next hop. */
+#define RTE_NODE_IP4_REWRITE_DATA_MAX 16
+
+/** Next nodes of ip4_lookup. */
+enum rte_node_ip4_lookup_next {
+	RTE_NODE_IP4_LOOKUP_NEXT_REWRITE,  /**< To ip4_rewrite. */
+	RTE_NODE_IP4_LOOKUP_NEXT_PKT_DROP, /**< To pkt_drop. */
+	RTE_NODE_IP4_LOOKUP_NEXT_MAX,      /**< Number of next nodes. */
+};
+
+/**
+ * Add a route to the ip4_lookup node, on every socket with an lcore.
+ *
+ * @param ip
+ *   Destination prefix, in host order.
+ * @param depth
+ *   Prefix length.
+ * @param next_hop
+ *   Next hop, below RTE_NODE_IP4_REWRITE_NH_MAX.
+ * @param next_node
+ *   Next node of the packets matching the route.
+ * @return
+ *   0 on success, negative otherwise.
+ */
+int rte_node_ip4_route_add(uint32_t ip, uint8_t depth, uint16_t next_hop,
+		enum rte_node_ip4_lookup_next next_node);
+
+/**
+ * Set the rewrite data of a next hop of the ip4_rewrite node.
+ *
+ * @param next_hop
+ *   Next hop, below RTE_NODE_IP4_REWRITE_NH_MAX.
+ * @param rewrite_data
+ *   Data written at the start of the packets, their Ethernet header.
+ * @param rewrite_len
+ *   Length of the data, up to RTE_NODE_IP4_REWRITE_DATA_MAX.
+ * @param dst_port
+ *   Port to send the packets to, given to rte_node_eth_config().
+ * @return
+ *   0 on success, negative otherwise.
+ */
+int rte_node_ip4_rewrite_add(uint16_t next_hop, uint8_t *rewrite_data,
+		uint8_t rewrite_len, uint16_t dst_port);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_NODE_IP4_API_H_ */
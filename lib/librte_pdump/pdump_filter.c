@@ -0,0 +1,378 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+
+#include <rte_branch_prediction.h>
+
+#include "pdump_filter.h"
+
+/* Classic BPF encoding, as in libpcap bpf.h and linux/filter.h */
+#define BPF_CLASS(code)	((code) & 0x07)
+#define BPF_LD		0x00
+#define BPF_LDX		0x01
+#define BPF_ST		0x02
+#define BPF_STX		0x03
+#define BPF_ALU		0x04
+#define BPF_JMP		0x05
+#define BPF_RET		0x06
+#define BPF_MISC	0x07
+
+#define BPF_W		0x00
+#define BPF_H		0x08
+#define BPF_B		0x10
+
+#define BPF_MODE(code)	((code) & 0xe0)
+#define BPF_IMM		0x00
+#define BPF_ABS		0x20
+#define BPF_IND		0x40
+#define BPF_MEM		0x60
+#define BPF_LEN		0x80
+#define BPF_MSH		0xa0
+
+#define BPF_OP(code)	((code) & 0xf0)
+#define BPF_ADD		0x00
+#define BPF_SUB		0x10
+#define BPF_MUL		0x20
+#define BPF_DIV		0x30
+#define BPF_OR		0x40
+#define BPF_AND		0x50
+#define BPF_LSH		0x60
+#define BPF_RSH		0x70
+#define BPF_NEG		0x80
+#define BPF_MOD		0x90
+#define BPF_XOR		0xa0
+
+#define BPF_JA		0x00
+#define BPF_JEQ		0x10
+#define BPF_JGT		0x20
+#define BPF_JGE		0x30
+#define BPF_JSET	0x40
+
+#define BPF_SRC(code)	((code) & 0x08)
+#define BPF_K		0x00
+#define BPF_X		0x08
+#define BPF_A		0x10	/* return value only */
+
+#define BPF_TAX		0x00
+#define BPF_TXA		0x80
+
+#define BPF_MEMWORDS	16
+
+int
+pdump_filter_validate(const struct rte_pdump_bpf_insn *insns, uint16_t len)
+{
+	const struct rte_pdump_bpf_insn *ins;
+	uint32_t pc;
+
+	if (len == 0 || len > RTE_PDUMP_FILTER_MAX_INSNS)
+		return -EINVAL;
+
+	for (pc = 0; pc < len; pc++) {
+		ins = &insns[pc];
+
+		switch (BPF_CLASS(ins->code)) {
+		case BPF_LD:
+		case BPF_LDX:
+			switch (ins->code) {
+			case BPF_LD | BPF_W | BPF_ABS:
+			case BPF_LD | BPF_H | BPF_ABS:
+			case BPF_LD | BPF_B | BPF_ABS:
+			case BPF_LD | BPF_W | BPF_IND:
+			case BPF_LD | BPF_H | BPF_IND:
+			case BPF_LD | BPF_B | BPF_IND:
+			case BPF_LD | BPF_W | BPF_LEN:
+			case BPF_LD | BPF_IMM:
+			case BPF_LDX | BPF_W | BPF_LEN:
+			case BPF_LDX | BPF_IMM:
+			case BPF_LDX | BPF_B | BPF_MSH:
+				break;
+			case BPF_LD | BPF_MEM:
+			case BPF_LDX | BPF_MEM:
+				if (ins->k >= BPF_MEMWORDS)
+					return -EINVAL;
+				break;
+			default:
+				return -EINVAL;
+			}
+			break;
+		case BPF_ST:
+		case BPF_STX:
+			if (ins->code != BPF_CLASS(ins->code) ||
+					ins->k >= BPF_MEMWORDS)
+				return -EINVAL;
+			break;
+		case BPF_ALU:
+			switch (BPF_OP(ins->code)) {
+			case BPF_ADD:
+			case BPF_SUB:
+			case BPF_MUL:
+			case BPF_OR:
+			case BPF_AND:
+			case BPF_XOR:
+				break;
+			case BPF_DIV:
+			case BPF_MOD:
+				if (BPF_SRC(ins->code) == BPF_K && ins->k == 0)
+					return -EINVAL;
+				break;
+			case BPF_LSH:
+			case BPF_RSH:
+				if (BPF_SRC(ins->code) == BPF_K && ins->k >= 32)
+					return -EINVAL;
+				break;
+			case BPF_NEG:
+				if (BPF_SRC(ins->code) != BPF_K)
+					return -EINVAL;
+				break;
+			default:
+				return -EINVAL;
+			}
+			break;
+		case BPF_JMP:
+			switch (BPF_OP(ins->code)) {
+			case BPF_JA:
+				if (ins->code != (BPF_JMP | BPF_JA) ||
+						ins->k >= len - pc - 1)
+					return -EINVAL;
+				break;
+			case BPF_JEQ:
+			case BPF_JGT:
+			case BPF_JGE:
+			case BPF_JSET:
+				if (pc + 1 + ins->jt >= len ||
+						pc + 1 + ins->jf >= len)
+					return -EINVAL;
+				break;
+			default:
+				return -EINVAL;
+			}
+			break;
+		case BPF_RET:
+			if (ins->code != (BPF_RET | BPF_K) &&
+					ins->code != (BPF_RET | BPF_X) &&
+					ins->code != (BPF_RET | BPF_A))
+				return -EINVAL;
+			break;
+		case BPF_MISC:
+			if (ins->code != (BPF_MISC | BPF_TAX) &&
+					ins->code != (BPF_MISC | BPF_TXA))
+				return -EINVAL;
+			break;
+		}
+	}
+
+	/* all paths must end with a return */
+	if (BPF_CLASS(insns[len - 1].code) != BPF_RET)
+		return -EINVAL;
+
+	return 0;
+}
+
+/* Read len bytes at offset off of the packet, NULL if out of bounds */
+static inline const uint8_t *
+pdump_filter_load(const struct rte_mbuf *m, uint32_t off, uint32_t len,
+		  void *buf)
+{
+	if (off > m->pkt_len || len > m->pkt_len - off)
+		return NULL;
+
+	if (likely(off + len <= m->data_len))
+		return rte_pktmbuf_mtod_offset(m, const uint8_t *, off);
+
+	return rte_pktmbuf_read(m, off, len, buf);
+}
+
+uint32_t
+pdump_filter_run(const struct rte_pdump_bpf_insn *insns,
+		 const struct rte_mbuf *m)
+{
+	const struct rte_pdump_bpf_insn *ins = insns;
+	uint32_t mem[BPF_MEMWORDS] = { 0 };
+	uint32_t a = 0, x = 0, k, off;
+	const uint8_t *p;
+	uint32_t buf;
+
+	for (;; ins++) {
+		k = ins->k;
+
+		switch (ins->code) {
+		case BPF_RET | BPF_K:
+			return k;
+		case BPF_RET | BPF_A:
+			return a;
+		case BPF_RET | BPF_X:
+			return x;
+
+		case BPF_LD | BPF_W | BPF_ABS:
+		case BPF_LD | BPF_W | BPF_IND:
+			off = BPF_MODE(ins->code) == BPF_IND ? k + x : k;
+			if (off < k)
+				return 0;
+			p = pdump_filter_load(m, off, sizeof(uint32_t), &buf);
+			if (p == NULL)
+				return 0;
+			a = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+				(uint32_t)p[2] << 8 | p[3];
+			break;
+		case BPF_LD | BPF_H | BPF_ABS:
+		case BPF_LD | BPF_H | BPF_IND:
+			off = BPF_MODE(ins->code) == BPF_IND ? k + x : k;
+			if (off < k)
+				return 0;
+			p = pdump_filter_load(m, off, sizeof(uint16_t), &buf);
+			if (p == NULL)
+				return 0;
+			a = (uint32_t)p[0] << 8 | p[1];
+			break;
+		case BPF_LD | BPF_B | BPF_ABS:
+		case BPF_LD | BPF_B | BPF_IND:
+			off = BPF_MODE(ins->code) == BPF_IND ? k + x : k;
+			if (off < k)
+				return 0;
+			p = pdump_filter_load(m, off, sizeof(uint8_t), &buf);
+			if (p == NULL)
+				return 0;
+			a = p[0];
+			break;
+		case BPF_LDX | BPF_B | BPF_MSH:
+			p = pdump_filter_load(m, k, sizeof(uint8_t), &buf);
+			if (p == NULL)
+				return 0;
+			x = (p[0] & 0xf) << 2;
+			break;
+		case BPF_LD | BPF_W | BPF_LEN:
+			a = m->pkt_len;
+			break;
+		case BPF_LDX | BPF_W | BPF_LEN:
+			x = m->pkt_len;
+			break;
+		case BPF_LD | BPF_IMM:
+			a = k;
+			break;
+		case BPF_LDX | BPF_IMM:
+			x = k;
+			break;
+		case BPF_LD | BPF_MEM:
+			a = mem[k];
+			break;
+		case BPF_LDX | BPF_MEM:
+			x = mem[k];
+			break;
+		case BPF_ST:
+			mem[k] = a;
+			break;
+		case BPF_STX:
+			mem[k] = x;
+			break;
+
+		case BPF_JMP | BPF_JA:
+			ins += k;
+			break;
+		case BPF_JMP | BPF_JEQ | BPF_K:
+			ins += (a == k) ? ins->jt : ins->jf;
+			break;
+		case BPF_JMP | BPF_JGT | BPF_K:
+			ins += (a > k) ? ins->jt : ins->jf;
+			break;
+		case BPF_JMP | BPF_JGE | BPF_K:
+			ins += (a >= k) ? ins->jt : ins->jf;
+			break;
+		case BPF_JMP | BPF_JSET | BPF_K:
+			ins += (a & k) ? ins->jt : ins->jf;
+			break;
+		case BPF_JMP | BPF_JEQ | BPF_X:
+			ins += (a == x) ? ins->jt : ins->jf;
+			break;
+		case BPF_JMP | BPF_JGT | BPF_X:
+			ins += (a > x) ? ins->jt : ins->jf;
+			break;
+		case BPF_JMP | BPF_JGE | BPF_X:
+			ins += (a >= x) ? ins->jt : ins->jf;
+			break;
+		case BPF_JMP | BPF_JSET | BPF_X:
+			ins += (a & x) ? ins->jt : ins->jf;
+			break;
+
+		case BPF_ALU | BPF_ADD | BPF_X:
+			a += x;
+			break;
+		case BPF_ALU | BPF_SUB | BPF_X:
+			a -= x;
+			break;
+		case BPF_ALU | BPF_MUL | BPF_X:
+			a *= x;
+			break;
+		case BPF_ALU | BPF_DIV | BPF_X:
+			if (x == 0)
+				return 0;
+			a /= x;
+			break;
+		case BPF_ALU | BPF_MOD | BPF_X:
+			if (x == 0)
+				return 0;
+			a %= x;
+			break;
+		case BPF_ALU | BPF_AND | BPF_X:
+			a &= x;
+			break;
+		case BPF_ALU | BPF_OR | BPF_X:
+			a |= x;
+			break;
+		case BPF_ALU | BPF_XOR | BPF_X:
+			a ^= x;
+			break;
+		case BPF_ALU | BPF_LSH | BPF_X:
+			a = (x < 32) ? a << x : 0;
+			break;
+		case BPF_ALU | BPF_RSH | BPF_X:
+			a = (x < 32) ? a >> x : 0;
+			break;
+		case BPF_ALU | BPF_ADD | BPF_K:
+			a += k;
+			break;
+		case BPF_ALU | BPF_SUB | BPF_K:
+			a -= k;
+			break;
+		case BPF_ALU | BPF_MUL | BPF_K:
+			a *= k;
+			break;
+		case BPF_ALU | BPF_DIV | BPF_K:
+			a /= k;
+			break;
+		case BPF_ALU | BPF_MOD | BPF_K:
+			a %= k;
+			break;
+		case BPF_ALU | BPF_AND | BPF_K:
+			a &= k;
+			break;
+		case BPF_ALU | BPF_OR | BPF_K:
+			a |= k;
+			break;
+		case BPF_ALU | BPF_XOR | BPF_K:
+			a ^= k;
+			break;
+		case BPF_ALU | BPF_LSH | BPF_K:
+			a <<= k;
+			break;
+		case BPF_ALU | BPF_RSH | BPF_K:
+			a >>= k;
+			break;
+		case BPF_ALU | BPF_NEG:
+			a = -a;
+			break;
+
+		case BPF_MISC | BPF_TAX:
+			x = a;
+			break;
+		case BPF_MISC | BPF_TXA:
+			a = x;
+			break;
+
+		default:
+			/* not reached with a validated program */
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,30 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef _PDUMP_FILTER_H_
+#define _PDUMP_FILTER_H_
+
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+
+#include "rte_pdump.h"
+
+/*
+ * Check that a classic BPF program only uses known instructions, has no
+ * backward or out of range jumps, no division by a zero constant and ends
+ * with a return, so that pdump_filter_run() needs no further checks.
+ * Returns 0 if the program is valid, -EINVAL otherwise.
+ */
+int pdump_filter_validate(const struct rte_pdump_bpf_insn *insns,
+			  uint16_t len);
+
+/*
+ * Run a validated program on a packet. Returns the number of bytes to
+ * capture, 0 if the packet is rejected.
+ */
+uint32_t pdump_filter_run(const struct rte_pdump_bpf_insn *insns,
+			  const struct rte_mbuf *m);
+
+#endif /* _PDUMP_FILTER_H_ */
@@ -46,8 +46,10 @@
 #include <rte_lcore.h>
 #include <rte_log.h>
 #include <rte_errno.h>
+#include <rte_malloc.h>
 
 #include "rte_pdump.h"
+#include "pdump_filter.h"
 
 #define SOCKET_PATH_VAR_RUN "/var/run"
 #define SOCKET_PATH_HOME "HOME"
@@ -61,11 +63,13 @@
 
 enum pdump_operation {
 	DISABLE = 1,
-	ENABLE = 2
+	ENABLE = 2,
+	STATS = 3
 };
 
 enum pdump_version {
-	V1 = 1
+	V1 = 1,
+	V2 = 2
 };
 
 static pthread_t pdump_thread;
@@ -85,6 +89,16 @@ struct pdump_request {
 			struct rte_mempool *mp;
 			void *filter;
 		} en_v1;
+		struct enable_v2 {
+			char device[DEVICE_ID_SIZE];
+			uint16_t queue;
+			uint16_t filter_len;
+			uint32_t snaplen;
+			struct rte_ring *ring;
+			struct rte_mempool *mp;
+			struct rte_pdump_bpf_insn
+				filter[RTE_PDUMP_FILTER_MAX_INSNS];
+		} en_v2;
 		struct disable_v1 {
 			char device[DEVICE_ID_SIZE];
 			uint16_t queue;
@@ -99,20 +113,35 @@ struct pdump_response {
 	uint16_t ver;
 	uint16_t res_op;
 	int32_t err_value;
+	struct rte_pdump_stats stats;
+};
+
+/* capture parameters of an enable request */
+struct pdump_capture {
+	struct rte_ring *ring;
+	struct rte_mempool *mp;
+	uint32_t snaplen;
+	bool zero_copy;
+	const struct rte_pdump_bpf_insn *filter;
+	uint16_t filter_len;
 };
 
 static struct pdump_rxtx_cbs {
 	struct rte_ring *ring;
 	struct rte_mempool *mp;
 	struct rte_eth_rxtx_callback *cb;
-	void *filter;
+	struct rte_pdump_bpf_insn *filter;
+	uint32_t snaplen;
+	bool zero_copy;
+	struct rte_pdump_stats stats;
 } rx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT],
 tx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
 
 static inline int
-pdump_pktmbuf_copy_data(struct rte_mbuf *seg, const struct rte_mbuf *m)
+pdump_pktmbuf_copy_data(struct rte_mbuf *seg, const struct rte_mbuf *m,
+			uint16_t len)
 {
-	if (rte_pktmbuf_tailroom(seg) < m->data_len) {
+	if (rte_pktmbuf_tailroom(seg) < len) {
 		RTE_LOG(ERR, PDUMP,
 			"User mempool: insufficient data_len of mbuf\n");
 		return -EINVAL;
@@ -125,7 +154,7 @@ pdump_pktmbuf_copy_data(struct rte_mbuf *seg, const struct rte_mbuf *m)
 	seg->ol_flags = m->ol_flags;
 	seg->packet_type = m->packet_type;
 	seg->vlan_tci_outer = m->vlan_tci_outer;
-	seg->data_len = m->data_len;
+	seg->data_len = len;
 	seg->pkt_len = seg->data_len;
 	rte_memcpy(rte_pktmbuf_mtod(seg, void *),
 			rte_pktmbuf_mtod(m, void *),
@@ -134,12 +163,14 @@ pdump_pktmbuf_copy_data(struct rte_mbuf *seg, const struct rte_mbuf *m)
 	return 0;
 }
 
+/* Copy the first caplen bytes of a packet */
 static inline struct rte_mbuf *
-pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp)
+pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp,
+		uint32_t caplen)
 {
 	struct rte_mbuf *m_dup, *seg, **prev;
-	uint32_t pktlen;
-	uint16_t nseg;
+	uint32_t pktlen, remain;
+	uint16_t nseg, len;
 
 	m_dup = rte_pktmbuf_alloc(mp);
 	if (unlikely(m_dup == NULL))
@@ -147,12 +178,14 @@ pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp)
 
 	seg = m_dup;
 	prev = &seg->next;
-	pktlen = m->pkt_len;
+	pktlen = RTE_MIN(m->pkt_len, caplen);
+	remain = pktlen;
 	nseg = 0;
 
 	do {
 		nseg++;
-		if (pdump_pktmbuf_copy_data(seg, m) < 0) {
+		len = RTE_MIN(m->data_len, remain);
+		if (pdump_pktmbuf_copy_data(seg, m, len) < 0) {
 			if (seg != m_dup)
 				rte_pktmbuf_free_seg(seg);
 			rte_pktmbuf_free(m_dup);
@@ -160,7 +193,8 @@ pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp)
 		}
 		*prev = seg;
 		prev = &seg->next;
-	} while ((m = m->next) != NULL &&
+		remain -= len;
+	} while (remain != 0 && (m = m->next) != NULL &&
 			(seg = rte_pktmbuf_alloc(mp)) != NULL);
 
 	*prev = NULL;
@@ -177,6 +211,44 @@ pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp)
 	return m_dup;
 }
 
+/*
+ * Mirror a packet without copying its data: the indirect mbufs of the
+ * clone hold a reference on the original segments. Only the clone is
+ * trimmed to caplen.
+ */
+static inline struct rte_mbuf *
+pdump_pktmbuf_clone(struct rte_mbuf *m, struct rte_mempool *mp,
+		uint32_t caplen)
+{
+	struct rte_mbuf *m_dup, *seg;
+	uint32_t remain;
+	uint16_t nseg;
+
+	m_dup = rte_pktmbuf_clone(m, mp);
+	if (unlikely(m_dup == NULL))
+		return NULL;
+	if (caplen >= m_dup->pkt_len)
+		return m_dup;
+
+	seg = m_dup;
+	remain = caplen;
+	nseg = 1;
+	while (seg->data_len < remain) {
+		remain -= seg->data_len;
+		seg = seg->next;
+		nseg++;
+	}
+	seg->data_len = remain;
+	if (seg->next != NULL) {
+		rte_pktmbuf_free(seg->next);
+		seg->next = NULL;
+	}
+	m_dup->nb_segs = nseg;
+	m_dup->pkt_len = caplen;
+
+	return m_dup;
+}
+
 static inline void
 pdump_copy(struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
 {
@@ -187,21 +259,42 @@ pdump_copy(struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
 	struct pdump_rxtx_cbs *cbs;
 	struct rte_ring *ring;
 	struct rte_mempool *mp;
-	struct rte_mbuf *p;
+	struct rte_mbuf *m, *p;
+	uint32_t caplen, ret;
 
 	cbs  = user_params;
 	ring = cbs->ring;
 	mp = cbs->mp;
 	for (i = 0; i < nb_pkts; i++) {
-		p = pdump_pktmbuf_copy(pkts[i], mp);
+		m = pkts[i];
+		caplen = cbs->snaplen;
+		if (cbs->filter != NULL) {
+			ret = pdump_filter_run(cbs->filter, m);
+			if (ret == 0) {
+				cbs->stats.filtered++;
+				continue;
+			}
+			caplen = RTE_MIN(caplen, ret);
+		}
+
+		/* software VLAN insertion needs the only reference */
+		if (cbs->zero_copy && (m->ol_flags &
+				(PKT_TX_VLAN_PKT | PKT_TX_QINQ_PKT)) == 0)
+			p = pdump_pktmbuf_clone(m, mp, caplen);
+		else
+			p = pdump_pktmbuf_copy(m, mp, caplen);
 		if (p)
 			dup_bufs[d_pkts++] = p;
+		else
+			cbs->stats.nombuf++;
 	}
 
 	ring_enq = rte_ring_enqueue_burst(ring, (void *)dup_bufs, d_pkts, NULL);
+	cbs->stats.accepted += ring_enq;
 	if (unlikely(ring_enq < d_pkts)) {
 		RTE_LOG(DEBUG, PDUMP,
 			"only %d of packets enqueued to ring\n", ring_enq);
+		cbs->stats.ringfull += d_pkts - ring_enq;
 		do {
 			rte_pktmbuf_free(dup_bufs[ring_enq]);
 		} while (++ring_enq < d_pkts);
@@ -226,11 +319,72 @@ pdump_tx(uint16_t port __rte_unused, uint16_t qidx __rte_unused,
 	return nb_pkts;
 }
 
+static int
+pdump_cbs_init(struct pdump_rxtx_cbs *cbs, uint16_t port,
+		const struct pdump_capture *cap)
+{
+	size_t size;
+
+	/*
+	 * The filter of a previous capture is only released now, as the
+	 * datapath may still have been running its callback when it was
+	 * removed.
+	 */
+	rte_free(cbs->filter);
+	cbs->filter = NULL;
+	if (cap->filter_len != 0) {
+		size = cap->filter_len * sizeof(*cap->filter);
+		cbs->filter = rte_malloc_socket("pdump_filter", size, 0,
+				rte_eth_dev_socket_id(port));
+		if (cbs->filter == NULL) {
+			RTE_LOG(ERR, PDUMP,
+				"failed to allocate filter for port=%d\n",
+				port);
+			return -ENOMEM;
+		}
+		rte_memcpy(cbs->filter, cap->filter, size);
+	}
+
+	cbs->ring = cap->ring;
+	cbs->mp = cap->mp;
+	cbs->snaplen = cap->snaplen != 0 ? cap->snaplen : UINT32_MAX;
+	cbs->zero_copy = false;
+	memset(&cbs->stats, 0, sizeof(cbs->stats));
+
+	return 0;
+}
+
+/*
+ * Cloned packets are released by the capture user, the Tx queue must not
+ * put transmitted mbufs back to their pool regardless of their refcnt.
+ */
+static bool
+pdump_tx_zero_copy_safe(uint16_t port, uint16_t qid)
+{
+	struct rte_eth_txq_info qinfo;
+	uint64_t offloads;
+
+	if (rte_eth_tx_queue_info_get(port, qid, &qinfo) != 0)
+		return false;
+
+	offloads = qinfo.conf.offloads |
+		rte_eth_devices[port].data->dev_conf.txmode.offloads;
+	if (offloads & DEV_TX_OFFLOAD_MBUF_FAST_FREE)
+		return false;
+	if ((qinfo.conf.txq_flags & ETH_TXQ_FLAGS_IGNORE) == 0 &&
+			(qinfo.conf.txq_flags & ETH_TXQ_FLAGS_NOREFCOUNT))
+		return false;
+
+	return true;
+}
+
 static int
 pdump_register_rx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
-				struct rte_ring *ring, struct rte_mempool *mp,
+				const struct pdump_capture *cap,
 				uint16_t operation)
 {
+	int ret;
+
 	uint16_t qid;
 	struct pdump_rxtx_cbs *cbs = NULL;
 
@@ -245,8 +399,9 @@ pdump_register_rx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 					port, qid);
 				return -EEXIST;
 			}
-			cbs->ring = ring;
-			cbs->mp = mp;
+			ret = pdump_cbs_init(cbs, port, cap);
+			if (ret < 0)
+				return ret;
 			cbs->cb = rte_eth_add_first_rx_callback(port, qid,
 								pdump_rx, cbs);
 			if (cbs->cb == NULL) {
@@ -257,8 +412,6 @@ pdump_register_rx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 			}
 		}
 		if (cbs && operation == DISABLE) {
-			int ret;
-
 			if (cbs->cb == NULL) {
 				RTE_LOG(ERR, PDUMP,
 					"failed to delete non existing rx "
@@ -282,10 +435,10 @@ pdump_register_rx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 
 static int
 pdump_register_tx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
-				struct rte_ring *ring, struct rte_mempool *mp,
+				const struct pdump_capture *cap,
 				uint16_t operation)
 {
-
+	int ret;
 	uint16_t qid;
 	struct pdump_rxtx_cbs *cbs = NULL;
 
@@ -300,8 +453,18 @@ pdump_register_tx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 					port, qid);
 				return -EEXIST;
 			}
-			cbs->ring = ring;
-			cbs->mp = mp;
+			ret = pdump_cbs_init(cbs, port, cap);
+			if (ret < 0)
+				return ret;
+			if (cap->zero_copy) {
+				cbs->zero_copy =
+					pdump_tx_zero_copy_safe(port, qid);
+				if (!cbs->zero_copy)
+					RTE_LOG(INFO, PDUMP,
+						"copying tx packets of port=%d "
+						"queue=%d, mbuf refcnt is "
+						"ignored\n", port, qid);
+			}
 			cbs->cb = rte_eth_add_tx_callback(port, qid, pdump_tx,
 								cbs);
 			if (cbs->cb == NULL) {
@@ -312,8 +475,6 @@ pdump_register_tx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 			}
 		}
 		if (cbs && operation == DISABLE) {
-			int ret;
-
 			if (cbs->cb == NULL) {
 				RTE_LOG(ERR, PDUMP,
 					"failed to delete non existing tx "
@@ -343,12 +504,33 @@ set_pdump_rxtx_cbs(struct pdump_request *p)
 	int ret = 0;
 	uint32_t flags;
 	uint16_t operation;
-	struct rte_ring *ring;
-	struct rte_mempool *mp;
+	struct pdump_capture cap = { .ring = NULL };
 
-	flags = p->flags;
+	flags = p->flags & RTE_PDUMP_FLAG_RXTX;
 	operation = p->op;
-	if (operation == ENABLE) {
+	if (operation == ENABLE && p->ver == V2) {
+		ret = rte_eth_dev_get_port_by_name(p->data.en_v2.device,
+				&port);
+		if (ret < 0) {
+			RTE_LOG(ERR, PDUMP,
+				"failed to get port id for device id=%s\n",
+				p->data.en_v2.device);
+			return -EINVAL;
+		}
+		queue = p->data.en_v2.queue;
+		cap.ring = p->data.en_v2.ring;
+		cap.mp = p->data.en_v2.mp;
+		cap.snaplen = p->data.en_v2.snaplen;
+		cap.zero_copy = !!(p->flags & RTE_PDUMP_FLAG_ZEROCOPY);
+		cap.filter = p->data.en_v2.filter;
+		cap.filter_len = p->data.en_v2.filter_len;
+		if (cap.filter_len != 0 &&
+				pdump_filter_validate(cap.filter,
+					cap.filter_len) < 0) {
+			RTE_LOG(ERR, PDUMP, "invalid filter program\n");
+			return -EINVAL;
+		}
+	} else if (operation == ENABLE) {
 		ret = rte_eth_dev_get_port_by_name(p->data.en_v1.device,
 				&port);
 		if (ret < 0) {
@@ -358,8 +540,8 @@ set_pdump_rxtx_cbs(struct pdump_request *p)
 			return -EINVAL;
 		}
 		queue = p->data.en_v1.queue;
-		ring = p->data.en_v1.ring;
-		mp = p->data.en_v1.mp;
+		cap.ring = p->data.en_v1.ring;
+		cap.mp = p->data.en_v1.mp;
 	} else {
 		ret = rte_eth_dev_get_port_by_name(p->data.dis_v1.device,
 				&port);
@@ -370,8 +552,6 @@ set_pdump_rxtx_cbs(struct pdump_request *p)
 			return -EINVAL;
 		}
 		queue = p->data.dis_v1.queue;
-		ring = p->data.dis_v1.ring;
-		mp = p->data.dis_v1.mp;
 	}
 
 	/* validation if packet capture is for all queues */
@@ -402,7 +582,7 @@ set_pdump_rxtx_cbs(struct pdump_request *p)
 	/* register RX callback */
 	if (flags & RTE_PDUMP_FLAG_RX) {
 		end_q = (queue == RTE_PDUMP_ALL_QUEUES) ? nb_rx_q : queue + 1;
-		ret = pdump_register_rx_callbacks(end_q, port, queue, ring, mp,
+		ret = pdump_register_rx_callbacks(end_q, port, queue, &cap,
 							operation);
 		if (ret < 0)
 			return ret;
@@ -411,7 +591,7 @@ set_pdump_rxtx_cbs(struct pdump_request *p)
 	/* register TX callback */
 	if (flags & RTE_PDUMP_FLAG_TX) {
 		end_q = (queue == RTE_PDUMP_ALL_QUEUES) ? nb_tx_q : queue + 1;
-		ret = pdump_register_tx_callbacks(end_q, port, queue, ring, mp,
+		ret = pdump_register_tx_callbacks(end_q, port, queue, &cap,
 							operation);
 		if (ret < 0)
 			return ret;
@@ -420,6 +600,50 @@ set_pdump_rxtx_cbs(struct pdump_request *p)
 	return ret;
 }
 
+static void
+pdump_sum_stats(struct rte_pdump_stats *stats,
+		const struct pdump_rxtx_cbs *cbs, uint16_t queue,
+		uint16_t nb_q)
+{
+	uint16_t qid, end_q;
+
+	qid = (queue == RTE_PDUMP_ALL_QUEUES) ? 0 : queue;
+	end_q = (queue == RTE_PDUMP_ALL_QUEUES) ? nb_q : queue + 1;
+	for (; qid < end_q && qid < RTE_MAX_QUEUES_PER_PORT; qid++) {
+		stats->accepted += cbs[qid].stats.accepted;
+		stats->filtered += cbs[qid].stats.filtered;
+		stats->nombuf += cbs[qid].stats.nombuf;
+		stats->ringfull += cbs[qid].stats.ringfull;
+	}
+}
+
+static int
+get_pdump_stats(struct pdump_request *p, struct rte_pdump_stats *stats)
+{
+	struct rte_eth_dev_info dev_info;
+	uint16_t port;
+	int ret;
+
+	ret = rte_eth_dev_get_port_by_name(p->data.dis_v1.device, &port);
+	if (ret < 0) {
+		RTE_LOG(ERR, PDUMP,
+			"failed to get port id for device id=%s\n",
+			p->data.dis_v1.device);
+		return -EINVAL;
+	}
+
+	rte_eth_dev_info_get(port, &dev_info);
+	memset(stats, 0, sizeof(*stats));
+	if (p->flags & RTE_PDUMP_FLAG_RX)
+		pdump_sum_stats(stats, rx_cbs[port], p->data.dis_v1.queue,
+				dev_info.nb_rx_queues);
+	if (p->flags & RTE_PDUMP_FLAG_TX)
+		pdump_sum_stats(stats, tx_cbs[port], p->data.dis_v1.queue,
+				dev_info.nb_tx_queues);
+
+	return 0;
+}
+
 /* get socket path (/var/run if root, $HOME otherwise) */
 static int
 pdump_get_socket_path(char *buffer, int bufsz, enum rte_pdump_socktype type)
@@ -542,7 +766,11 @@ pdump_thread_main(__rte_unused void *arg)
 			continue;
 		}
 
-		ret = set_pdump_rxtx_cbs(&cli_req);
+		memset(&resp, 0, sizeof(resp));
+		if (cli_req.op == STATS)
+			ret = get_pdump_stats(&cli_req, &resp.stats);
+		else
+			ret = set_pdump_rxtx_cbs(&cli_req);
 
 		resp.ver = cli_req.ver;
 		resp.res_op = cli_req.op;
@@ -638,7 +866,8 @@ rte_pdump_uninit(void)
 }
 
 static int
-pdump_create_client_socket(struct pdump_request *p)
+pdump_create_client_socket(struct pdump_request *p,
+			struct rte_pdump_stats *stats)
 {
 	int ret, socket_fd;
 	int pid;
@@ -718,6 +947,8 @@ pdump_create_client_socket(struct pdump_request *p)
 			break;
 		}
 		ret = server_resp.err_value;
+		if (ret == 0 && stats != NULL)
+			*stats = server_resp.stats;
 	} while (0);
 
 exit:
@@ -754,6 +985,7 @@ pdump_validate_ring_mp(struct rte_ring *ring, struct rte_mempool *mp)
 static int
 pdump_validate_flags(uint32_t flags)
 {
+	flags &= ~RTE_PDUMP_FLAG_ZEROCOPY;
 	if (flags != RTE_PDUMP_FLAG_RX && flags != RTE_PDUMP_FLAG_TX &&
 		flags != RTE_PDUMP_FLAG_RXTX) {
 		RTE_LOG(ERR, PDUMP,
@@ -789,26 +1021,47 @@ pdump_validate_port(uint16_t port, char *name)
 	return 0;
 }
 
+static int
+pdump_validate_filter(const struct rte_pdump_bpf_insn *filter,
+			uint16_t filter_len)
+{
+	if (filter_len == 0)
+		return 0;
+
+	if (filter == NULL || pdump_filter_validate(filter, filter_len) < 0) {
+		RTE_LOG(ERR, PDUMP, "invalid filter program, %s:%d\n",
+			__func__, __LINE__);
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	return 0;
+}
+
 static int
 pdump_prepare_client_request(char *device, uint16_t queue,
 				uint32_t flags,
 				uint16_t operation,
-				struct rte_ring *ring,
-				struct rte_mempool *mp,
-				void *filter)
+				const struct pdump_capture *cap,
+				struct rte_pdump_stats *stats)
 {
 	int ret;
-	struct pdump_request req = {.ver = 1,};
+	struct pdump_request req = {.ver = V1,};
 
 	req.flags = flags;
 	req.op =  operation;
-	if ((operation & ENABLE) != 0) {
-		snprintf(req.data.en_v1.device, sizeof(req.data.en_v1.device),
+	if (operation == ENABLE) {
+		req.ver = V2;
+		snprintf(req.data.en_v2.device, sizeof(req.data.en_v2.device),
 				"%s", device);
-		req.data.en_v1.queue = queue;
-		req.data.en_v1.ring = ring;
-		req.data.en_v1.mp = mp;
-		req.data.en_v1.filter = filter;
+		req.data.en_v2.queue = queue;
+		req.data.en_v2.ring = cap->ring;
+		req.data.en_v2.mp = cap->mp;
+		req.data.en_v2.snaplen = cap->snaplen;
+		req.data.en_v2.filter_len = cap->filter_len;
+		if (cap->filter_len != 0)
+			memcpy(req.data.en_v2.filter, cap->filter,
+				cap->filter_len * sizeof(*cap->filter));
 	} else {
 		snprintf(req.data.dis_v1.device, sizeof(req.data.dis_v1.device),
 				"%s", device);
@@ -818,10 +1071,11 @@ pdump_prepare_client_request(char *device, uint16_t queue,
 		req.data.dis_v1.filter = NULL;
 	}
 
-	ret = pdump_create_client_socket(&req);
+	ret = pdump_create_client_socket(&req, stats);
 	if (ret < 0) {
 		RTE_LOG(ERR, PDUMP,
-			"client request for pdump enable/disable failed\n");
+			"client request for pdump enable/disable/stats "
+			"failed\n");
 		rte_errno = ret;
 		return -1;
 	}
@@ -830,53 +1084,79 @@ pdump_prepare_client_request(char *device, uint16_t queue,
 }
 
 int
-rte_pdump_enable(uint16_t port, uint16_t queue, uint32_t flags,
+rte_pdump_enable_filter(uint16_t port, uint16_t queue, uint32_t flags,
+			uint32_t snaplen,
 			struct rte_ring *ring,
 			struct rte_mempool *mp,
-			void *filter)
+			const struct rte_pdump_bpf_insn *filter,
+			uint16_t filter_len)
 {
-
 	int ret = 0;
 	char name[DEVICE_ID_SIZE];
 
 	ret = pdump_validate_port(port, name);
-	if (ret < 0)
-		return ret;
-	ret = pdump_validate_ring_mp(ring, mp);
-	if (ret < 0)
-		return ret;
-	ret = pdump_validate_flags(flags);
 	if (ret < 0)
 		return ret;
 
-	ret = pdump_prepare_client_request(name, queue, flags,
-						ENABLE, ring, mp, filter);
-
-	return ret;
+	return rte_pdump_enable_filter_by_deviceid(name, queue, flags,
+			snaplen, ring, mp, filter, filter_len);
 }
 
 int
-rte_pdump_enable_by_deviceid(char *device_id, uint16_t queue,
+rte_pdump_enable_filter_by_deviceid(char *device_id, uint16_t queue,
 				uint32_t flags,
+				uint32_t snaplen,
 				struct rte_ring *ring,
 				struct rte_mempool *mp,
-				void *filter)
+				const struct rte_pdump_bpf_insn *filter,
+				uint16_t filter_len)
 {
 	int ret = 0;
+	struct pdump_capture cap = {
+		.ring = ring,
+		.mp = mp,
+		.snaplen = snaplen,
+		.filter = filter,
+		.filter_len = filter_len,
+	};
 
 	ret = pdump_validate_ring_mp(ring, mp);
 	if (ret < 0)
 		return ret;
 	ret = pdump_validate_flags(flags);
+	if (ret < 0)
+		return ret;
+	ret = pdump_validate_filter(filter, filter_len);
 	if (ret < 0)
 		return ret;
 
 	ret = pdump_prepare_client_request(device_id, queue, flags,
-						ENABLE, ring, mp, filter);
+						ENABLE, &cap, NULL);
 
 	return ret;
 }
 
+int
+rte_pdump_enable(uint16_t port, uint16_t queue, uint32_t flags,
+			struct rte_ring *ring,
+			struct rte_mempool *mp,
+			void *filter __rte_unused)
+{
+	return rte_pdump_enable_filter(port, queue, flags, 0, ring, mp,
+					NULL, 0);
+}
+
+int
+rte_pdump_enable_by_deviceid(char *device_id, uint16_t queue,
+				uint32_t flags,
+				struct rte_ring *ring,
+				struct rte_mempool *mp,
+				void *filter __rte_unused)
+{
+	return rte_pdump_enable_filter_by_deviceid(device_id, queue, flags,
+						0, ring, mp, NULL, 0);
+}
+
 int
 rte_pdump_disable(uint16_t port, uint16_t queue, uint32_t flags)
 {
@@ -891,7 +1171,7 @@ rte_pdump_disable(uint16_t port, uint16_t queue, uint32_t flags)
 		return ret;
 
 	ret = pdump_prepare_client_request(name, queue, flags,
-						DISABLE, NULL, NULL, NULL);
+						DISABLE, NULL, NULL);
 
 	return ret;
 }
@@ -907,7 +1187,43 @@ rte_pdump_disable_by_deviceid(char *device_id, uint16_t queue,
 		return ret;
 
 	ret = pdump_prepare_client_request(device_id, queue, flags,
-						DISABLE, NULL, NULL, NULL);
+						DISABLE, NULL, NULL);
+
+	return ret;
+}
+
+int
+rte_pdump_stats(uint16_t port, uint16_t queue, uint32_t flags,
+		struct rte_pdump_stats *stats)
+{
+	int ret = 0;
+	char name[DEVICE_ID_SIZE];
+
+	ret = pdump_validate_port(port, name);
+	if (ret < 0)
+		return ret;
+
+	return rte_pdump_stats_by_deviceid(name, queue, flags, stats);
+}
+
+int
+rte_pdump_stats_by_deviceid(char *device_id, uint16_t queue, uint32_t flags,
+		struct rte_pdump_stats *stats)
+{
+	int ret = 0;
+
+	if (stats == NULL) {
+		RTE_LOG(ERR, PDUMP, "NULL stats passed %s:%d\n",
+			__func__, __LINE__);
+		rte_errno = EINVAL;
+		return -1;
+	}
+	ret = pdump_validate_flags(flags);
+	if (ret < 0)
+		return ret;
+
+	ret = pdump_prepare_client_request(device_id, queue, flags,
+						STATS, NULL, stats);
 
 	return ret;
 }
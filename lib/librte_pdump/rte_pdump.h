@@ -55,7 +55,31 @@ enum {
 	RTE_PDUMP_FLAG_RX = 1,  /* receive direction */
 	RTE_PDUMP_FLAG_TX = 2,  /* transmit direction */
 	/* both receive and transmit directions */
-	RTE_PDUMP_FLAG_RXTX = (RTE_PDUMP_FLAG_RX|RTE_PDUMP_FLAG_TX)
+	RTE_PDUMP_FLAG_RXTX = (RTE_PDUMP_FLAG_RX|RTE_PDUMP_FLAG_TX),
+	/* mirror transmitted packets by reference instead of copying them */
+	RTE_PDUMP_FLAG_ZEROCOPY = 4
+};
+
+/** Maximum number of instructions of a capture filter */
+#define RTE_PDUMP_FILTER_MAX_INSNS 512
+
+/**
+ * Classic BPF instruction, with the layout and encoding used by libpcap
+ * and the Linux socket filter. "tcpdump -ddd" prints programs this way.
+ */
+struct rte_pdump_bpf_insn {
+	uint16_t code;
+	uint8_t jt;
+	uint8_t jf;
+	uint32_t k;
+};
+
+/** Capture statistics of a port, summed over the queues asked for */
+struct rte_pdump_stats {
+	uint64_t accepted; /**< packets enqueued to the capture ring */
+	uint64_t filtered; /**< packets rejected by the filter */
+	uint64_t nombuf;   /**< packets lost, capture mempool exhausted */
+	uint64_t ringfull; /**< packets lost, capture ring full */
 };
 
 enum rte_pdump_socktype {
@@ -191,6 +215,106 @@ int
 rte_pdump_disable_by_deviceid(char *device_id, uint16_t queue,
 				uint32_t flags);
 
+/**
+ * Enables filtered packet capturing on given port and queue.
+ *
+ * The filter is a classic BPF program run on every packet before it is
+ * mirrored: a zero return value drops the packet, any other value is the
+ * number of bytes to capture. Only the first snaplen bytes of a packet are
+ * copied to the mempool, so pkt_len of a captured mbuf is the captured
+ * length.
+ *
+ * With RTE_PDUMP_FLAG_ZEROCOPY, transmitted packets are mirrored by
+ * cloning them into mp, i.e. the captured mbufs reference the data of the
+ * original packets until the user frees them. This is only done on Tx
+ * queues which honour the mbuf reference count, and never for received
+ * packets, which the application is still free to modify.
+ *
+ * @param port
+ *  port on which packet capturing should be enabled.
+ * @param queue
+ *  queue of a given port on which packet capturing should be enabled.
+ *  users should pass on value UINT16_MAX to enable packet capturing on all
+ *  queues of a given port.
+ * @param flags
+ *  flags specifies RTE_PDUMP_FLAG_RX/RTE_PDUMP_FLAG_TX/RTE_PDUMP_FLAG_RXTX
+ *  on which packet capturing should be enabled for a given port and queue,
+ *  optionally or'ed with RTE_PDUMP_FLAG_ZEROCOPY.
+ * @param snaplen
+ *  maximum number of bytes captured per packet, 0 for whole packets.
+ * @param ring
+ *  ring on which captured packets will be enqueued for user.
+ * @param mp
+ *  mempool on to which original packets will be mirrored or duplicated.
+ * @param filter
+ *  filter program, NULL to capture all packets. It is copied by the
+ *  primary process.
+ * @param filter_len
+ *  number of instructions of the filter program.
+ *
+ * @return
+ *    0 on success, -1 on error, rte_errno is set accordingly.
+ */
+int
+rte_pdump_enable_filter(uint16_t port, uint16_t queue, uint32_t flags,
+		uint32_t snaplen,
+		struct rte_ring *ring,
+		struct rte_mempool *mp,
+		const struct rte_pdump_bpf_insn *filter,
+		uint16_t filter_len);
+
+/**
+ * Enables filtered packet capturing on given device id and queue.
+ * device_id can be name or pci address of device.
+ * See rte_pdump_enable_filter() for the other parameters.
+ *
+ * @return
+ *    0 on success, -1 on error, rte_errno is set accordingly.
+ */
+int
+rte_pdump_enable_filter_by_deviceid(char *device_id, uint16_t queue,
+		uint32_t flags,
+		uint32_t snaplen,
+		struct rte_ring *ring,
+		struct rte_mempool *mp,
+		const struct rte_pdump_bpf_insn *filter,
+		uint16_t filter_len);
+
+/**
+ * Retrieves capture statistics of given port and queue.
+ *
+ * Counters are reset when capturing is enabled, and kept after it is
+ * disabled, so that they can be read once the capture rings are drained.
+ *
+ * @param port
+ *  port of which statistics are retrieved.
+ * @param queue
+ *  queue of a given port, UINT16_MAX to sum the statistics of all queues.
+ * @param flags
+ *  flags specifies RTE_PDUMP_FLAG_RX/RTE_PDUMP_FLAG_TX/RTE_PDUMP_FLAG_RXTX
+ *  directions of which statistics are summed.
+ * @param stats
+ *  statistics filled in on success.
+ *
+ * @return
+ *    0 on success, -1 on error, rte_errno is set accordingly.
+ */
+int
+rte_pdump_stats(uint16_t port, uint16_t queue, uint32_t flags,
+		struct rte_pdump_stats *stats);
+
+/**
+ * Retrieves capture statistics of given device id and queue.
+ * device_id can be name or pci address of device.
+ * See rte_pdump_stats() for the other parameters.
+ *
+ * @return
+ *    0 on success, -1 on error, rte_errno is set accordingly.
+ */
+int
+rte_pdump_stats_by_deviceid(char *device_id, uint16_t queue, uint32_t flags,
+		struct rte_pdump_stats *stats);
+
 /**
  * Allows applications to set server and client socket paths.
  * If specified path is null default path will be selected, i.e.
@@ -75,6 +75,8 @@ extern "C" {
  * 2. Key size:
  *     a. Configurable key size
  *     b. Single key size (8-byte, 16-byte or 32-byte key size)
+ *     c. Any key size multiple of 8 bytes, up to 128 bytes, stored inside
+ *        the bucket like for the single key size tables
  *
  ***/
 #include <stdint.h>
@@ -115,11 +117,18 @@ struct rte_table_hash_params {
 	uint64_t seed;
 };
 
+/**
+ * Maximum key size (number of bytes) for the rte_table_hash_key_*_ops
+ * tables, which accept any multiple of 8 bytes up to this value.
+ */
+#define RTE_TABLE_HASH_KEY_SIZE_MAX                          128
+
 /** Extendible bucket hash table operations */
 extern struct rte_table_ops rte_table_hash_ext_ops;
 extern struct rte_table_ops rte_table_hash_key8_ext_ops;
 extern struct rte_table_ops rte_table_hash_key16_ext_ops;
 extern struct rte_table_ops rte_table_hash_key32_ext_ops;
+extern struct rte_table_ops rte_table_hash_key_ext_ops;
 
 /** LRU hash table operations */
 extern struct rte_table_ops rte_table_hash_lru_ops;
@@ -127,6 +136,7 @@ extern struct rte_table_ops rte_table_hash_lru_ops;
 extern struct rte_table_ops rte_table_hash_key8_lru_ops;
 extern struct rte_table_ops rte_table_hash_key16_lru_ops;
 extern struct rte_table_ops rte_table_hash_key32_lru_ops;
+extern struct rte_table_ops rte_table_hash_key_lru_ops;
 
 /** Cuckoo hash table operations */
 extern struct rte_table_ops rte_table_hash_cuckoo_ops;
@@ -0,0 +1,1545 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_memcpy.h>
+#include <rte_prefetch.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_port.h>
+#include <rte_sched.h>
+
+#include "rte_table_action.h"
+
+#define ACTION_MASK(type)                            (1LLU << (type))
+
+#define ETHER_TYPE_MPLS_UNICAST                      0x8847
+#define ETHER_TYPE_MPLS_MULTICAST                    0x8848
+
+/* Action data is 8-byte aligned within the table entry */
+#define ACTION_DATA_ALIGN                            8
+
+/**
+ * RTE_TABLE_ACTION_FWD
+ */
+static int
+fwd_apply(struct rte_pipeline_table_entry *entry,
+	struct rte_table_action_fwd_params *p)
+{
+	if (p->action >= RTE_PIPELINE_ACTIONS)
+		return -EINVAL;
+
+	entry->action = p->action;
+	if (p->action == RTE_PIPELINE_ACTION_TABLE)
+		entry->table_id = p->id;
+	else
+		entry->port_id = p->id;
+
+	return 0;
+}
+
+/**
+ * RTE_TABLE_ACTION_LB
+ */
+struct lb_config {
+	struct rte_table_action_lb_config c;
+	uint8_t key_mask[RTE_TABLE_ACTION_LB_KEY_SIZE_MAX];
+};
+
+struct lb_data {
+	uint32_t out[RTE_TABLE_ACTION_LB_TABLE_SIZE];
+};
+
+static int
+lb_cfg_check(struct rte_table_action_lb_config *lb)
+{
+	if (lb->key_size == 0 ||
+		lb->key_size > RTE_TABLE_ACTION_LB_KEY_SIZE_MAX ||
+		lb->key_size % 8 ||
+		lb->f_hash == NULL)
+		return -EINVAL;
+
+	return 0;
+}
+
+static int
+lb_apply(struct lb_data *data,
+	struct rte_table_action_lb_params *p)
+{
+	memcpy(data->out, p->out, sizeof(data->out));
+
+	return 0;
+}
+
+static __rte_always_inline void
+pkt_work_lb(struct rte_mbuf *mbuf,
+	struct lb_data *data,
+	struct lb_config *cfg)
+{
+	uint8_t *pkt_key = RTE_MBUF_METADATA_UINT8_PTR(mbuf, cfg->c.key_offset);
+	uint32_t *out = RTE_MBUF_METADATA_UINT32_PTR(mbuf, cfg->c.out_offset);
+	uint64_t digest;
+
+	digest = cfg->c.f_hash(pkt_key, cfg->key_mask, cfg->c.key_size,
+		cfg->c.seed);
+	*out = data->out[digest & (RTE_TABLE_ACTION_LB_TABLE_SIZE - 1)];
+}
+
+/**
+ * RTE_TABLE_ACTION_MTR
+ */
+struct dscp_table_entry_data {
+	uint8_t tc_id;
+	uint8_t tc_queue_id;
+	uint8_t color;
+};
+
+struct dscp_table_data {
+	struct dscp_table_entry_data entry[64];
+};
+
+struct mtr_trtcm_data {
+	struct rte_meter_trtcm trtcm;
+	uint64_t n_packets[e_RTE_METER_COLORS];
+	uint64_t n_bytes[e_RTE_METER_COLORS];
+	uint64_t n_packets_dropped;
+	uint8_t policer[e_RTE_METER_COLORS];
+};
+
+static int
+mtr_cfg_check(struct rte_table_action_mtr_config *mtr)
+{
+	if (mtr->alg != RTE_TABLE_ACTION_METER_TRTCM ||
+		(mtr->n_tc != 1 && mtr->n_tc != RTE_TABLE_ACTION_TC_MAX))
+		return -EINVAL;
+
+	return 0;
+}
+
+static size_t
+mtr_data_size(struct rte_table_action_mtr_config *mtr)
+{
+	return mtr->n_tc * RTE_ALIGN_CEIL(sizeof(struct mtr_trtcm_data),
+		ACTION_DATA_ALIGN);
+}
+
+static int
+mtr_apply_check(struct rte_table_action_mtr_params *p,
+	uint32_t n_tc)
+{
+	uint32_t tc, color;
+
+	if (p->tc_mask == 0 || (p->tc_mask & ~RTE_LEN2MASK(n_tc, uint32_t)))
+		return -EINVAL;
+
+	for (tc = 0; tc < n_tc; tc++) {
+		if ((p->tc_mask & (1 << tc)) == 0)
+			continue;
+
+		for (color = 0; color < e_RTE_METER_COLORS; color++)
+			if (p->mtr[tc].policer[color] >=
+				RTE_TABLE_ACTION_POLICER_MAX)
+				return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int
+mtr_apply(struct mtr_trtcm_data *data,
+	struct rte_table_action_mtr_params *p,
+	struct rte_table_action_mtr_config *cfg)
+{
+	struct rte_meter_trtcm trtcm[RTE_TABLE_ACTION_TC_MAX];
+	uint32_t tc, color;
+	int status;
+
+	status = mtr_apply_check(p, cfg->n_tc);
+	if (status)
+		return status;
+
+	/* Configure all the meters first, so that a failure leaves the
+	 * entry unchanged.
+	 */
+	for (tc = 0; tc < cfg->n_tc; tc++) {
+		if ((p->tc_mask & (1 << tc)) == 0)
+			continue;
+
+		status = rte_meter_trtcm_config(&trtcm[tc],
+			&p->mtr[tc].meter);
+		if (status)
+			return status;
+	}
+
+	for (tc = 0; tc < cfg->n_tc; tc++) {
+		struct mtr_trtcm_data *d = &data[tc];
+
+		if ((p->tc_mask & (1 << tc)) == 0)
+			continue;
+
+		memset(d, 0, sizeof(*d));
+		d->trtcm = trtcm[tc];
+		for (color = 0; color < e_RTE_METER_COLORS; color++)
+			d->policer[color] = (uint8_t)p->mtr[tc].policer[color];
+	}
+
+	return 0;
+}
+
+static __rte_always_inline uint64_t
+pkt_work_mtr(struct mtr_trtcm_data *data,
+	uint32_t tc_id,
+	uint64_t time,
+	uint32_t total_length,
+	enum rte_meter_color *color)
+{
+	struct mtr_trtcm_data *d = &data[tc_id];
+	enum rte_meter_color color_meter;
+	uint32_t policer;
+
+	color_meter = rte_meter_trtcm_color_aware_check(&d->trtcm,
+		time,
+		total_length,
+		*color);
+
+	policer = d->policer[color_meter];
+	if (policer == RTE_TABLE_ACTION_POLICER_DROP) {
+		d->n_packets_dropped++;
+		return 1;
+	}
+
+	d->n_packets[policer]++;
+	d->n_bytes[policer] += total_length;
+	*color = (enum rte_meter_color)policer;
+
+	return 0;
+}
+
+/**
+ * RTE_TABLE_ACTION_TM
+ */
+struct tm_data {
+	uint32_t subport;
+	uint32_t pipe;
+};
+
+static int
+tm_cfg_check(struct rte_table_action_tm_config *tm)
+{
+	if (tm->n_subports_per_port == 0 ||
+		tm->n_subports_per_port > UINT16_MAX + 1 ||
+		tm->n_pipes_per_subport == 0)
+		return -EINVAL;
+
+	return 0;
+}
+
+static int
+tm_apply(struct tm_data *data,
+	struct rte_table_action_tm_params *p,
+	struct rte_table_action_tm_config *cfg)
+{
+	if (p->subport_id >= cfg->n_subports_per_port ||
+		p->pipe_id >= cfg->n_pipes_per_subport)
+		return -EINVAL;
+
+	data->subport = p->subport_id;
+	data->pipe = p->pipe_id;
+
+	return 0;
+}
+
+static __rte_always_inline void
+pkt_work_tm(struct rte_mbuf *mbuf,
+	struct tm_data *data,
+	struct dscp_table_entry_data *dscp,
+	enum rte_meter_color color)
+{
+	rte_sched_port_pkt_write(mbuf, data->subport, data->pipe,
+		dscp->tc_id, dscp->tc_queue_id, color);
+}
+
+/**
+ * RTE_TABLE_ACTION_ENCAP
+ */
+#define ENCAP_MASK_ALL                                               \
+	(ACTION_MASK(RTE_TABLE_ACTION_ENCAP_ETHER) |                 \
+	ACTION_MASK(RTE_TABLE_ACTION_ENCAP_VLAN) |                   \
+	ACTION_MASK(RTE_TABLE_ACTION_ENCAP_QINQ) |                   \
+	ACTION_MASK(RTE_TABLE_ACTION_ENCAP_MPLS))
+
+struct encap_data {
+	uint16_t len;
+	uint8_t hdr[0];
+};
+
+static const uint32_t encap_hdr_size[] = {
+	[RTE_TABLE_ACTION_ENCAP_ETHER] = sizeof(struct ether_hdr),
+	[RTE_TABLE_ACTION_ENCAP_VLAN] = sizeof(struct ether_hdr) +
+		sizeof(struct vlan_hdr),
+	[RTE_TABLE_ACTION_ENCAP_QINQ] = sizeof(struct ether_hdr) +
+		2 * sizeof(struct vlan_hdr),
+	[RTE_TABLE_ACTION_ENCAP_MPLS] = sizeof(struct ether_hdr) +
+		RTE_TABLE_ACTION_MPLS_LABELS_MAX * sizeof(uint32_t),
+};
+
+static int
+encap_cfg_check(struct rte_table_action_encap_config *encap)
+{
+	if (encap->encap_mask == 0 || (encap->encap_mask & ~ENCAP_MASK_ALL))
+		return -EINVAL;
+
+	return 0;
+}
+
+/* Largest header of the enabled encapsulation types */
+static uint32_t
+encap_hdr_size_max(struct rte_table_action_encap_config *encap)
+{
+	uint32_t type, size = 0;
+
+	for (type = 0; type < RTE_DIM(encap_hdr_size); type++)
+		if ((encap->encap_mask & ACTION_MASK(type)) &&
+			encap_hdr_size[type] > size)
+			size = encap_hdr_size[type];
+
+	return size;
+}
+
+static size_t
+encap_data_size(struct rte_table_action_encap_config *encap)
+{
+	return sizeof(struct encap_data) + encap_hdr_size_max(encap);
+}
+
+static uint8_t *
+encap_ether_write(uint8_t *hdr, struct rte_table_action_ether_hdr *ether,
+	uint16_t ether_type)
+{
+	struct ether_hdr *eth = (struct ether_hdr *)hdr;
+
+	ether_addr_copy(&ether->da, &eth->d_addr);
+	ether_addr_copy(&ether->sa, &eth->s_addr);
+	eth->ether_type = rte_cpu_to_be_16(ether_type);
+
+	return hdr + sizeof(*eth);
+}
+
+static uint8_t *
+encap_vlan_write(uint8_t *hdr, struct rte_table_action_vlan_hdr *vlan,
+	uint16_t eth_proto)
+{
+	struct vlan_hdr *v = (struct vlan_hdr *)hdr;
+
+	v->vlan_tci = rte_cpu_to_be_16(((vlan->pcp & 0x7) << 13) |
+		((vlan->dei & 0x1) << 12) |
+		(vlan->vid & 0xFFF));
+	v->eth_proto = rte_cpu_to_be_16(eth_proto);
+
+	return hdr + sizeof(*v);
+}
+
+static int
+encap_apply(struct encap_data *data,
+	struct rte_table_action_encap_params *p,
+	struct rte_table_action_encap_config *cfg,
+	struct rte_table_action_common_config *common)
+{
+	uint16_t ether_type = common->ip_version ?
+		ETHER_TYPE_IPv4 : ETHER_TYPE_IPv6;
+	uint8_t *hdr = data->hdr;
+	uint32_t i;
+
+	if ((cfg->encap_mask & ACTION_MASK(p->type)) == 0)
+		return -EINVAL;
+
+	switch (p->type) {
+	case RTE_TABLE_ACTION_ENCAP_ETHER:
+		hdr = encap_ether_write(hdr, &p->ether.ether, ether_type);
+		break;
+
+	case RTE_TABLE_ACTION_ENCAP_VLAN:
+		hdr = encap_ether_write(hdr, &p->vlan.ether, ETHER_TYPE_VLAN);
+		hdr = encap_vlan_write(hdr, &p->vlan.vlan, ether_type);
+		break;
+
+	case RTE_TABLE_ACTION_ENCAP_QINQ:
+		hdr = encap_ether_write(hdr, &p->qinq.ether, ETHER_TYPE_QINQ);
+		hdr = encap_vlan_write(hdr, &p->qinq.svlan, ETHER_TYPE_VLAN);
+		hdr = encap_vlan_write(hdr, &p->qinq.cvlan, ether_type);
+		break;
+
+	case RTE_TABLE_ACTION_ENCAP_MPLS:
+		if (p->mpls.mpls_count == 0 ||
+			p->mpls.mpls_count > RTE_TABLE_ACTION_MPLS_LABELS_MAX)
+			return -EINVAL;
+
+		hdr = encap_ether_write(hdr, &p->mpls.ether,
+			p->mpls.unicast ? ETHER_TYPE_MPLS_UNICAST :
+			ETHER_TYPE_MPLS_MULTICAST);
+
+		for (i = 0; i < p->mpls.mpls_count; i++) {
+			struct rte_table_action_mpls_hdr *m = &p->mpls.mpls[i];
+			uint32_t s = (i == p->mpls.mpls_count - 1) ? 1 : 0;
+			uint32_t label = ((m->label & 0xFFFFF) << 12) |
+				((m->tc & 0x7) << 9) |
+				(s << 8) |
+				m->ttl;
+
+			label = rte_cpu_to_be_32(label);
+			memcpy(hdr, &label, sizeof(label));
+			hdr += sizeof(label);
+		}
+		break;
+
+	default:
+		return -EINVAL;
+	}
+
+	data->len = hdr - data->hdr;
+
+	return 0;
+}
+
+static __rte_always_inline void
+pkt_work_encap(struct rte_mbuf *mbuf,
+	struct encap_data *data,
+	void *ip)
+{
+	uint8_t *hdr = RTE_PTR_SUB(ip, data->len);
+	uint16_t data_off = hdr - (uint8_t *)mbuf->buf_addr;
+
+	/* The new header replaces whatever was in front of the IP header */
+	rte_memcpy(hdr, data->hdr, data->len);
+	mbuf->data_len += mbuf->data_off - data_off;
+	mbuf->pkt_len += mbuf->data_off - data_off;
+	mbuf->data_off = data_off;
+}
+
+/**
+ * RTE_TABLE_ACTION_NAT
+ */
+struct nat_ipv4_data {
+	uint32_t addr;
+	uint16_t port;
+};
+
+struct nat_ipv6_data {
+	uint8_t addr[16];
+	uint16_t port;
+};
+
+static int
+nat_cfg_check(struct rte_table_action_nat_config *nat)
+{
+	if (nat->proto != IPPROTO_TCP && nat->proto != IPPROTO_UDP)
+		return -EINVAL;
+
+	return 0;
+}
+
+static size_t
+nat_data_size(struct rte_table_action_common_config *common)
+{
+	return common->ip_version ? sizeof(struct nat_ipv4_data) :
+		sizeof(struct nat_ipv6_data);
+}
+
+static int
+nat_apply(void *data,
+	struct rte_table_action_nat_params *p,
+	struct rte_table_action_common_config *common)
+{
+	if ((p->ip_version != 0) != (common->ip_version != 0))
+		return -EINVAL;
+
+	if (common->ip_version) {
+		struct nat_ipv4_data *d = data;
+
+		d->addr = rte_cpu_to_be_32(p->addr.ipv4);
+		d->port = rte_cpu_to_be_16(p->port);
+	} else {
+		struct nat_ipv6_data *d = data;
+
+		memcpy(d->addr, p->addr.ipv6, sizeof(d->addr));
+		d->port = rte_cpu_to_be_16(p->port);
+	}
+
+	return 0;
+}
+
+/* Incremental checksum update (RFC 1624) for 16-bit words changed from
+ * old to new, all in network byte order.
+ */
+static __rte_always_inline uint16_t
+nat_checksum_update(uint16_t cksum,
+	const uint16_t *old,
+	const uint16_t *new,
+	uint32_t n_words)
+{
+	uint32_t sum = (uint16_t)~cksum;
+	uint32_t i;
+
+	for (i = 0; i < n_words; i++)
+		sum += (uint16_t)~old[i] + new[i];
+
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	sum = (sum & 0xFFFF) + (sum >> 16);
+
+	return (uint16_t)~sum;
+}
+
+/* Update the L4 checksum and port, for address words changed from old to
+ * new. A zero UDP checksum means no checksum and is left as is.
+ */
+static __rte_always_inline void
+nat_l4_update(void *l4,
+	uint8_t proto,
+	int source_nat,
+	const uint16_t *old_addr,
+	const uint16_t *new_addr,
+	uint32_t n_words,
+	uint16_t port)
+{
+	uint16_t *l4_port, *l4_cksum;
+	uint16_t cksum;
+
+	/* TCP and UDP have their ports in the same place */
+	l4_port = RTE_PTR_ADD(l4, source_nat ?
+		offsetof(struct udp_hdr, src_port) :
+		offsetof(struct udp_hdr, dst_port));
+
+	if (proto == IPPROTO_TCP)
+		l4_cksum = RTE_PTR_ADD(l4, offsetof(struct tcp_hdr, cksum));
+	else {
+		l4_cksum = RTE_PTR_ADD(l4,
+			offsetof(struct udp_hdr, dgram_cksum));
+		if (*l4_cksum == 0) {
+			*l4_port = port;
+			return;
+		}
+	}
+
+	cksum = nat_checksum_update(*l4_cksum, old_addr, new_addr, n_words);
+	cksum = nat_checksum_update(cksum, l4_port, &port, 1);
+	if (proto == IPPROTO_UDP && cksum == 0)
+		cksum = 0xFFFF;
+
+	*l4_cksum = cksum;
+	*l4_port = port;
+}
+
+static __rte_always_inline void
+pkt_ipv4_work_nat(struct ipv4_hdr *ip,
+	struct nat_ipv4_data *data,
+	struct rte_table_action_nat_config *cfg)
+{
+	uint32_t *addr = RTE_PTR_ADD(ip, cfg->source_nat ?
+		offsetof(struct ipv4_hdr, src_addr) :
+		offsetof(struct ipv4_hdr, dst_addr));
+	void *l4 = RTE_PTR_ADD(ip, (ip->version_ihl & IPV4_HDR_IHL_MASK) *
+		IPV4_IHL_MULTIPLIER);
+	uint16_t old_addr[2], new_addr[2];
+
+	memcpy(old_addr, addr, sizeof(old_addr));
+	memcpy(new_addr, &data->addr, sizeof(new_addr));
+
+	ip->hdr_checksum = nat_checksum_update(ip->hdr_checksum,
+		old_addr, new_addr, 2);
+	nat_l4_update(l4, cfg->proto, cfg->source_nat, old_addr, new_addr, 2,
+		data->port);
+	*addr = data->addr;
+}
+
+static __rte_always_inline void
+pkt_ipv6_work_nat(struct ipv6_hdr *ip,
+	struct nat_ipv6_data *data,
+	struct rte_table_action_nat_config *cfg)
+{
+	uint8_t *addr = cfg->source_nat ? ip->src_addr : ip->dst_addr;
+	uint16_t old_addr[8], new_addr[8];
+
+	memcpy(old_addr, addr, sizeof(old_addr));
+	memcpy(new_addr, data->addr, sizeof(new_addr));
+
+	nat_l4_update(&ip[1], cfg->proto, cfg->source_nat, old_addr, new_addr,
+		8, data->port);
+	memcpy(addr, data->addr, sizeof(data->addr));
+}
+
+/**
+ * RTE_TABLE_ACTION_TTL
+ */
+struct ttl_data {
+	uint64_t n_packets;
+	uint32_t decrement;
+};
+
+static int
+ttl_apply(struct ttl_data *data,
+	struct rte_table_action_ttl_params *p)
+{
+	data->n_packets = 0;
+	data->decrement = p->decrement ? 1 : 0;
+
+	return 0;
+}
+
+static __rte_always_inline uint64_t
+pkt_ipv4_work_ttl(struct ipv4_hdr *ip,
+	struct ttl_data *data,
+	struct rte_table_action_ttl_config *cfg)
+{
+	uint32_t ttl = ip->time_to_live;
+	uint32_t expired = ttl <= data->decrement;
+
+	if (data->decrement && ttl) {
+		uint32_t cksum;
+
+		ip->time_to_live = ttl - 1;
+		cksum = ip->hdr_checksum + rte_cpu_to_be_16(0x0100);
+		ip->hdr_checksum = (uint16_t)(cksum + (cksum >> 16));
+	}
+
+	data->n_packets += expired;
+
+	return expired & (cfg->drop != 0);
+}
+
+static __rte_always_inline uint64_t
+pkt_ipv6_work_ttl(struct ipv6_hdr *ip,
+	struct ttl_data *data,
+	struct rte_table_action_ttl_config *cfg)
+{
+	uint32_t ttl = ip->hop_limits;
+	uint32_t expired = ttl <= data->decrement;
+
+	if (data->decrement && ttl)
+		ip->hop_limits = ttl - 1;
+
+	data->n_packets += expired;
+
+	return expired & (cfg->drop != 0);
+}
+
+/**
+ * RTE_TABLE_ACTION_STATS
+ */
+struct stats_data {
+	uint64_t n_packets;
+	uint64_t n_bytes;
+};
+
+static __rte_always_inline void
+pkt_work_stats(struct stats_data *data,
+	uint16_t total_length)
+{
+	data->n_packets++;
+	data->n_bytes += total_length;
+}
+
+/**
+ * RTE_TABLE_ACTION_TIME
+ */
+struct time_data {
+	uint64_t time;
+};
+
+static __rte_always_inline void
+pkt_work_time(struct time_data *data,
+	uint64_t time)
+{
+	data->time = time;
+}
+
+/**
+ * Action profile
+ */
+static int
+action_valid(enum rte_table_action_type action)
+{
+	switch (action) {
+	case RTE_TABLE_ACTION_FWD:
+	case RTE_TABLE_ACTION_LB:
+	case RTE_TABLE_ACTION_MTR:
+	case RTE_TABLE_ACTION_TM:
+	case RTE_TABLE_ACTION_ENCAP:
+	case RTE_TABLE_ACTION_NAT:
+	case RTE_TABLE_ACTION_TTL:
+	case RTE_TABLE_ACTION_STATS:
+	case RTE_TABLE_ACTION_TIME:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+#define RTE_TABLE_ACTION_MAX                         64
+
+struct ap_config {
+	uint64_t action_mask;
+	struct rte_table_action_common_config common;
+	struct lb_config lb;
+	struct rte_table_action_mtr_config mtr;
+	struct rte_table_action_tm_config tm;
+	struct rte_table_action_encap_config encap;
+	struct rte_table_action_nat_config nat;
+	struct rte_table_action_ttl_config ttl;
+	struct rte_table_action_stats_config stats;
+};
+
+static size_t
+action_cfg_size(enum rte_table_action_type action)
+{
+	switch (action) {
+	case RTE_TABLE_ACTION_LB:
+		return sizeof(struct rte_table_action_lb_config);
+	case RTE_TABLE_ACTION_MTR:
+		return sizeof(struct rte_table_action_mtr_config);
+	case RTE_TABLE_ACTION_TM:
+		return sizeof(struct rte_table_action_tm_config);
+	case RTE_TABLE_ACTION_ENCAP:
+		return sizeof(struct rte_table_action_encap_config);
+	case RTE_TABLE_ACTION_NAT:
+		return sizeof(struct rte_table_action_nat_config);
+	case RTE_TABLE_ACTION_TTL:
+		return sizeof(struct rte_table_action_ttl_config);
+	case RTE_TABLE_ACTION_STATS:
+		return sizeof(struct rte_table_action_stats_config);
+	default:
+		return 0;
+	}
+}
+
+static void *
+action_cfg_get(struct ap_config *ap_config,
+	enum rte_table_action_type type)
+{
+	switch (type) {
+	case RTE_TABLE_ACTION_LB:
+		return &ap_config->lb.c;
+	case RTE_TABLE_ACTION_MTR:
+		return &ap_config->mtr;
+	case RTE_TABLE_ACTION_TM:
+		return &ap_config->tm;
+	case RTE_TABLE_ACTION_ENCAP:
+		return &ap_config->encap;
+	case RTE_TABLE_ACTION_NAT:
+		return &ap_config->nat;
+	case RTE_TABLE_ACTION_TTL:
+		return &ap_config->ttl;
+	case RTE_TABLE_ACTION_STATS:
+		return &ap_config->stats;
+	default:
+		return NULL;
+	}
+}
+
+static void
+action_cfg_set(struct ap_config *ap_config,
+	enum rte_table_action_type type,
+	void *action_cfg)
+{
+	void *dst = action_cfg_get(ap_config, type);
+
+	if (dst && action_cfg)
+		memcpy(dst, action_cfg, action_cfg_size(type));
+
+	if (type == RTE_TABLE_ACTION_LB)
+		memset(ap_config->lb.key_mask, 0xFF,
+			sizeof(ap_config->lb.key_mask));
+
+	ap_config->action_mask |= ACTION_MASK(type);
+}
+
+struct ap_data {
+	size_t offset[RTE_TABLE_ACTION_MAX];
+	size_t total_size;
+};
+
+static size_t
+action_data_size(enum rte_table_action_type action,
+	struct ap_config *ap_config)
+{
+	switch (action) {
+	case RTE_TABLE_ACTION_LB:
+		return sizeof(struct lb_data);
+	case RTE_TABLE_ACTION_MTR:
+		return mtr_data_size(&ap_config->mtr);
+	case RTE_TABLE_ACTION_TM:
+		return sizeof(struct tm_data);
+	case RTE_TABLE_ACTION_ENCAP:
+		return encap_data_size(&ap_config->encap);
+	case RTE_TABLE_ACTION_NAT:
+		return nat_data_size(&ap_config->common);
+	case RTE_TABLE_ACTION_TTL:
+		return sizeof(struct ttl_data);
+	case RTE_TABLE_ACTION_STATS:
+		return sizeof(struct stats_data);
+	case RTE_TABLE_ACTION_TIME:
+		return sizeof(struct time_data);
+	default:
+		return 0;
+	}
+}
+
+/* Pack the data of the enabled actions after the table entry header, in
+ * the order they are applied to the packets.
+ */
+static void
+action_data_offset_set(struct ap_data *ap_data,
+	struct ap_config *ap_config)
+{
+	uint64_t action_mask = ap_config->action_mask;
+	size_t offset;
+	uint32_t action;
+
+	memset(ap_data->offset, 0, sizeof(ap_data->offset));
+
+	offset = sizeof(struct rte_pipeline_table_entry);
+	for (action = 0; action < RTE_TABLE_ACTION_MAX; action++)
+		if (action_mask & ACTION_MASK(action)) {
+			ap_data->offset[action] = offset;
+			offset += RTE_ALIGN_CEIL(
+				action_data_size(action, ap_config),
+				ACTION_DATA_ALIGN);
+		}
+
+	ap_data->total_size = offset;
+}
+
+struct rte_table_action_profile {
+	struct ap_config cfg;
+	struct ap_data data;
+	int frozen;
+};
+
+struct rte_table_action_profile *
+rte_table_action_profile_create(struct rte_table_action_common_config *common)
+{
+	struct rte_table_action_profile *ap;
+
+	/* Check input arguments */
+	if (common == NULL)
+		return NULL;
+
+	/* Memory allocation */
+	ap = calloc(1, sizeof(struct rte_table_action_profile));
+	if (ap == NULL)
+		return NULL;
+
+	/* Initialization */
+	memcpy(&ap->cfg.common, common, sizeof(*common));
+
+	return ap;
+}
+
+int
+rte_table_action_profile_action_register(
+	struct rte_table_action_profile *profile,
+	enum rte_table_action_type type,
+	void *action_config)
+{
+	int status;
+
+	/* Check input arguments */
+	if (profile == NULL ||
+		profile->frozen ||
+		action_valid(type) == 0 ||
+		(profile->cfg.action_mask & ACTION_MASK(type)) ||
+		(action_cfg_size(type) && action_config == NULL))
+		return -EINVAL;
+
+	switch (type) {
+	case RTE_TABLE_ACTION_LB:
+		status = lb_cfg_check(action_config);
+		break;
+
+	case RTE_TABLE_ACTION_MTR:
+		status = mtr_cfg_check(action_config);
+		break;
+
+	case RTE_TABLE_ACTION_TM:
+		status = tm_cfg_check(action_config);
+		break;
+
+	case RTE_TABLE_ACTION_ENCAP:
+		status = encap_cfg_check(action_config);
+		break;
+
+	case RTE_TABLE_ACTION_NAT:
+		status = nat_cfg_check(action_config);
+		break;
+
+	default:
+		status = 0;
+		break;
+	}
+
+	if (status)
+		return status;
+
+	/* Action enable */
+	action_cfg_set(&profile->cfg, type, action_config);
+
+	return 0;
+}
+
+int
+rte_table_action_profile_freeze(struct rte_table_action_profile *profile)
+{
+	if (profile == NULL || profile->frozen)
+		return -EINVAL;
+
+	/* The encapsulation header has to fit in front of the IP header */
+	if ((profile->cfg.action_mask & ACTION_MASK(RTE_TABLE_ACTION_ENCAP)) &&
+		profile->cfg.common.ip_offset < sizeof(struct rte_mbuf) +
+			encap_hdr_size_max(&profile->cfg.encap))
+		return -EINVAL;
+
+	action_data_offset_set(&profile->data, &profile->cfg);
+	profile->frozen = 1;
+
+	return 0;
+}
+
+int
+rte_table_action_profile_free(struct rte_table_action_profile *profile)
+{
+	if (profile == NULL)
+		return 0;
+
+	free(profile);
+	return 0;
+}
+
+/**
+ * Action
+ */
+struct rte_table_action {
+	struct ap_config cfg;
+	struct ap_data data;
+	struct dscp_table_data dscp_table;
+};
+
+struct rte_table_action *
+rte_table_action_create(struct rte_table_action_profile *profile,
+	uint32_t socket_id)
+{
+	struct rte_table_action *action;
+
+	/* Check input arguments */
+	if (profile == NULL ||
+		profile->frozen == 0)
+		return NULL;
+
+	/* Memory allocation */
+	action = rte_zmalloc_socket(NULL,
+		sizeof(struct rte_table_action),
+		RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (action == NULL)
+		return NULL;
+
+	/* Initialization */
+	memcpy(&action->cfg, &profile->cfg, sizeof(profile->cfg));
+	memcpy(&action->data, &profile->data, sizeof(profile->data));
+
+	return action;
+}
+
+static __rte_always_inline void *
+action_data_get(void *data,
+	struct rte_table_action *action,
+	enum rte_table_action_type type)
+{
+	size_t offset = action->data.offset[type];
+	uint8_t *data_bytes = data;
+
+	return &data_bytes[offset];
+}
+
+int
+rte_table_action_apply(struct rte_table_action *action,
+	void *data,
+	enum rte_table_action_type type,
+	void *action_params)
+{
+	void *action_data;
+
+	/* Check input arguments */
+	if (action == NULL ||
+		data == NULL ||
+		action_valid(type) == 0 ||
+		(action->cfg.action_mask & ACTION_MASK(type)) == 0 ||
+		(action_params == NULL &&
+			type != RTE_TABLE_ACTION_STATS &&
+			type != RTE_TABLE_ACTION_TIME))
+		return -EINVAL;
+
+	/* Data update */
+	action_data = action_data_get(data, action, type);
+	switch (type) {
+	case RTE_TABLE_ACTION_FWD:
+		return fwd_apply(data, action_params);
+
+	case RTE_TABLE_ACTION_LB:
+		return lb_apply(action_data, action_params);
+
+	case RTE_TABLE_ACTION_MTR:
+		return mtr_apply(action_data, action_params,
+			&action->cfg.mtr);
+
+	case RTE_TABLE_ACTION_TM:
+		return tm_apply(action_data, action_params,
+			&action->cfg.tm);
+
+	case RTE_TABLE_ACTION_ENCAP:
+		return encap_apply(action_data, action_params,
+			&action->cfg.encap, &action->cfg.common);
+
+	case RTE_TABLE_ACTION_NAT:
+		return nat_apply(action_data, action_params,
+			&action->cfg.common);
+
+	case RTE_TABLE_ACTION_TTL:
+		return ttl_apply(action_data, action_params);
+
+	case RTE_TABLE_ACTION_STATS:
+		memset(action_data, 0, sizeof(struct stats_data));
+		return 0;
+
+	case RTE_TABLE_ACTION_TIME:
+		memset(action_data, 0, sizeof(struct time_data));
+		return 0;
+
+	default:
+		return -EINVAL;
+	}
+}
+
+int
+rte_table_action_dscp_table_update(struct rte_table_action *action,
+	uint64_t dscp_mask,
+	struct rte_table_action_dscp_table *table)
+{
+	uint32_t i;
+
+	/* Check input arguments */
+	if (action == NULL ||
+		(action->cfg.action_mask & (ACTION_MASK(RTE_TABLE_ACTION_MTR) |
+		ACTION_MASK(RTE_TABLE_ACTION_TM))) == 0 ||
+		dscp_mask == 0 ||
+		table == NULL)
+		return -EINVAL;
+
+	for (i = 0; i < RTE_DIM(table->entry); i++) {
+		struct rte_table_action_dscp_table_entry *entry =
+			&table->entry[i];
+
+		if ((dscp_mask & (1LLU << i)) == 0)
+			continue;
+
+		if (entry->tc_id >= RTE_TABLE_ACTION_TC_MAX ||
+			entry->tc_queue_id >= RTE_TABLE_ACTION_TC_QUEUE_MAX ||
+			entry->color >= e_RTE_METER_COLORS)
+			return -EINVAL;
+	}
+
+	for (i = 0; i < RTE_DIM(table->entry); i++) {
+		struct dscp_table_entry_data *data =
+			&action->dscp_table.entry[i];
+		struct rte_table_action_dscp_table_entry *entry =
+			&table->entry[i];
+
+		if ((dscp_mask & (1LLU << i)) == 0)
+			continue;
+
+		data->tc_id = entry->tc_id;
+		data->tc_queue_id = entry->tc_queue_id;
+		data->color = entry->color;
+	}
+
+	return 0;
+}
+
+int
+rte_table_action_meter_read(struct rte_table_action *action,
+	void *data,
+	uint32_t tc_mask,
+	struct rte_table_action_mtr_counters *stats,
+	int clear)
+{
+	struct mtr_trtcm_data *mtr_data;
+	uint32_t i, j;
+
+	/* Check input arguments */
+	if (action == NULL ||
+		(action->cfg.action_mask &
+			ACTION_MASK(RTE_TABLE_ACTION_MTR)) == 0 ||
+		data == NULL ||
+		(tc_mask & ~RTE_LEN2MASK(action->cfg.mtr.n_tc, uint32_t)))
+		return -EINVAL;
+
+	mtr_data = action_data_get(data, action, RTE_TABLE_ACTION_MTR);
+
+	/* Read */
+	if (stats) {
+		for (i = 0; i < action->cfg.mtr.n_tc; i++) {
+			struct rte_table_action_mtr_counters_tc *dst =
+				&stats->stats[i];
+			struct mtr_trtcm_data *src = &mtr_data[i];
+
+			if ((tc_mask & (1 << i)) == 0)
+				continue;
+
+			for (j = 0; j < e_RTE_METER_COLORS; j++) {
+				dst->n_packets[j] = src->n_packets[j];
+				dst->n_bytes[j] = src->n_bytes[j];
+			}
+			dst->n_packets_dropped = src->n_packets_dropped;
+		}
+
+		stats->tc_mask = tc_mask;
+	}
+
+	/* Clear */
+	if (clear)
+		for (i = 0; i < action->cfg.mtr.n_tc; i++) {
+			struct mtr_trtcm_data *src = &mtr_data[i];
+
+			if ((tc_mask & (1 << i)) == 0)
+				continue;
+
+			memset(src->n_packets, 0, sizeof(src->n_packets));
+			memset(src->n_bytes, 0, sizeof(src->n_bytes));
+			src->n_packets_dropped = 0;
+		}
+
+	return 0;
+}
+
+int
+rte_table_action_ttl_read(struct rte_table_action *action,
+	void *data,
+	struct rte_table_action_ttl_counters *stats,
+	int clear)
+{
+	struct ttl_data *ttl_data;
+
+	/* Check input arguments */
+	if (action == NULL ||
+		(action->cfg.action_mask &
+			ACTION_MASK(RTE_TABLE_ACTION_TTL)) == 0 ||
+		data == NULL)
+		return -EINVAL;
+
+	ttl_data = action_data_get(data, action, RTE_TABLE_ACTION_TTL);
+
+	/* Read */
+	if (stats)
+		stats->n_packets = ttl_data->n_packets;
+
+	/* Clear */
+	if (clear)
+		ttl_data->n_packets = 0;
+
+	return 0;
+}
+
+int
+rte_table_action_stats_read(struct rte_table_action *action,
+	void *data,
+	struct rte_table_action_stats_counters *stats,
+	int clear)
+{
+	struct stats_data *stats_data;
+
+	/* Check input arguments */
+	if (action == NULL ||
+		(action->cfg.action_mask &
+			ACTION_MASK(RTE_TABLE_ACTION_STATS)) == 0 ||
+		data == NULL)
+		return -EINVAL;
+
+	stats_data = action_data_get(data, action, RTE_TABLE_ACTION_STATS);
+
+	/* Read */
+	if (stats) {
+		stats->n_packets = stats_data->n_packets;
+		stats->n_bytes = stats_data->n_bytes;
+		stats->n_packets_valid = action->cfg.stats.n_packets_enabled;
+		stats->n_bytes_valid = action->cfg.stats.n_bytes_enabled;
+	}
+
+	/* Clear */
+	if (clear) {
+		stats_data->n_packets = 0;
+		stats_data->n_bytes = 0;
+	}
+
+	return 0;
+}
+
+int
+rte_table_action_time_read(struct rte_table_action *action,
+	void *data,
+	uint64_t *timestamp)
+{
+	struct time_data *time_data;
+
+	/* Check input arguments */
+	if (action == NULL ||
+		(action->cfg.action_mask &
+			ACTION_MASK(RTE_TABLE_ACTION_TIME)) == 0 ||
+		data == NULL ||
+		timestamp == NULL)
+		return -EINVAL;
+
+	time_data = action_data_get(data, action, RTE_TABLE_ACTION_TIME);
+
+	/* Read */
+	*timestamp = time_data->time;
+
+	return 0;
+}
+
+/**
+ * Action handler
+ *
+ * The action mask is an argument of the inline work functions, so that the
+ * handlers below built for a constant mask only keep the code of its
+ * actions.
+ */
+static __rte_always_inline uint64_t
+pkt_work(struct rte_mbuf *mbuf,
+	struct rte_pipeline_table_entry *table_entry,
+	uint64_t time,
+	struct rte_table_action *action,
+	const uint64_t action_mask)
+{
+	struct ap_config *cfg = &action->cfg;
+	void *ip = RTE_MBUF_METADATA_UINT32_PTR(mbuf, cfg->common.ip_offset);
+	struct dscp_table_entry_data *dscp_entry;
+	enum rte_meter_color color;
+	uint64_t drop_mask = 0;
+	uint16_t total_length;
+	uint32_t dscp;
+
+	if (cfg->common.ip_version) {
+		struct ipv4_hdr *hdr = ip;
+
+		dscp = hdr->type_of_service >> 2;
+		total_length = rte_be_to_cpu_16(hdr->total_length);
+	} else {
+		struct ipv6_hdr *hdr = ip;
+
+		dscp = (rte_be_to_cpu_32(hdr->vtc_flow) >> 22) & 0x3F;
+		total_length = rte_be_to_cpu_16(hdr->payload_len) +
+			sizeof(struct ipv6_hdr);
+	}
+
+	dscp_entry = &action->dscp_table.entry[dscp];
+	color = (enum rte_meter_color)dscp_entry->color;
+
+	if (action_mask & ACTION_MASK(RTE_TABLE_ACTION_LB)) {
+		void *data = action_data_get(table_entry, action,
+			RTE_TABLE_ACTION_LB);
+
+		pkt_work_lb(mbuf, data, &cfg->lb);
+	}
+
+	if (action_mask & ACTION_MASK(RTE_TABLE_ACTION_MTR)) {
+		void *data = action_data_get(table_entry, action,
+			RTE_TABLE_ACTION_MTR);
+		uint32_t tc_id = (cfg->mtr.n_tc == 1) ? 0 : dscp_entry->tc_id;
+
+		drop_mask |= pkt_work_mtr(data, tc_id, time, total_length,
+			&color);
+	}
+
+	if (action_mask & ACTION_MASK(RTE_TABLE_ACTION_TM)) {
+		void *data = action_data_get(table_entry, action,
+			RTE_TABLE_ACTION_TM);
+
+		pkt_work_tm(mbuf, data, dscp_entry, color);
+	}
+
+	if (action_mask & ACTION_MASK(RTE_TABLE_ACTION_ENCAP)) {
+		void *data = action_data_get(table_entry, action,
+			RTE_TABLE_ACTION_ENCAP);
+
+		pkt_work_encap(mbuf, data, ip);
+	}
+
+	if (action_mask & ACTION_MASK(RTE_TABLE_ACTION_NAT)) {
+		void *data = action_data_get(table_entry, action,
+			RTE_TABLE_ACTION_NAT);
+
+		if (cfg->common.ip_version)
+			pkt_ipv4_work_nat(ip, data, &cfg->nat);
+		else
+			pkt_ipv6_work_nat(ip, data, &cfg->nat);
+	}
+
+	if (action_mask & ACTION_MASK(RTE_TABLE_ACTION_TTL)) {
+		void *data = action_data_get(table_entry, action,
+			RTE_TABLE_ACTION_TTL);
+
+		if (cfg->common.ip_version)
+			drop_mask |= pkt_ipv4_work_ttl(ip, data, &cfg->ttl);
+		else
+			drop_mask |= pkt_ipv6_work_ttl(ip, data, &cfg->ttl);
+	}
+
+	if (action_mask & ACTION_MASK(RTE_TABLE_ACTION_STATS)) {
+		void *data = action_data_get(table_entry, action,
+			RTE_TABLE_ACTION_STATS);
+
+		pkt_work_stats(data, total_length);
+	}
+
+	if (action_mask & ACTION_MASK(RTE_TABLE_ACTION_TIME)) {
+		void *data = action_data_get(table_entry, action,
+			RTE_TABLE_ACTION_TIME);
+
+		pkt_work_time(data, time);
+	}
+
+	return drop_mask;
+}
+
+/* Prefetch the IP headers and the table entries of 4 packets. Entries
+ * larger than a cache line get their second line prefetched as well.
+ */
+static __rte_always_inline void
+pkt4_prefetch(struct rte_mbuf **mbufs,
+	struct rte_pipeline_table_entry **table_entries,
+	struct rte_table_action *action)
+{
+	uint32_t ip_offset = action->cfg.common.ip_offset;
+	uint32_t i;
+
+	for (i = 0; i < 4; i++) {
+		rte_prefetch0(RTE_MBUF_METADATA_UINT8_PTR(mbufs[i], ip_offset));
+		if (action->data.total_size > RTE_CACHE_LINE_SIZE)
+			rte_prefetch0(RTE_PTR_ADD(table_entries[i],
+				RTE_CACHE_LINE_SIZE));
+	}
+}
+
+static __rte_always_inline uint64_t
+pkt4_work(struct rte_mbuf **mbufs,
+	struct rte_pipeline_table_entry **table_entries,
+	uint64_t time,
+	struct rte_table_action *action,
+	const uint64_t action_mask)
+{
+	uint64_t drop_mask0, drop_mask1, drop_mask2, drop_mask3;
+
+	drop_mask0 = pkt_work(mbufs[0], table_entries[0], time, action,
+		action_mask);
+	drop_mask1 = pkt_work(mbufs[1], table_entries[1], time, action,
+		action_mask);
+	drop_mask2 = pkt_work(mbufs[2], table_entries[2], time, action,
+		action_mask);
+	drop_mask3 = pkt_work(mbufs[3], table_entries[3], time, action,
+		action_mask);
+
+	return drop_mask0 |
+		(drop_mask1 << 1) |
+		(drop_mask2 << 2) |
+		(drop_mask3 << 3);
+}
+
+static __rte_always_inline int
+ah(struct rte_pipeline *p,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	struct rte_pipeline_table_entry **entries,
+	struct rte_table_action *action,
+	const uint64_t action_mask)
+{
+	uint64_t pkts_drop_mask = 0;
+	uint64_t time = 0;
+
+	if (action_mask & (ACTION_MASK(RTE_TABLE_ACTION_MTR) |
+		ACTION_MASK(RTE_TABLE_ACTION_TIME)))
+		time = rte_rdtsc();
+
+	if ((pkts_mask & (pkts_mask + 1)) == 0) {
+		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
+		uint32_t i;
+
+		if (n_pkts >= 4)
+			pkt4_prefetch(pkts, entries, action);
+
+		for (i = 0; i < (n_pkts & (~0x3LLU)); i += 4) {
+			uint64_t drop_mask;
+
+			if (i + 8 <= n_pkts)
+				pkt4_prefetch(&pkts[i + 4], &entries[i + 4],
+					action);
+
+			drop_mask = pkt4_work(&pkts[i], &entries[i], time,
+				action, action_mask);
+
+			pkts_drop_mask |= drop_mask << i;
+		}
+
+		for ( ; i < n_pkts; i++) {
+			uint64_t drop_mask;
+
+			drop_mask = pkt_work(pkts[i], entries[i], time, action,
+				action_mask);
+
+			pkts_drop_mask |= drop_mask << i;
+		}
+	} else
+		for ( ; pkts_mask; ) {
+			uint32_t pos = __builtin_ctzll(pkts_mask);
+			uint64_t pkt_mask = 1LLU << pos;
+			uint64_t drop_mask;
+
+			drop_mask = pkt_work(pkts[pos], entries[pos], time,
+				action, action_mask);
+
+			pkts_mask &= ~pkt_mask;
+			pkts_drop_mask |= drop_mask << pos;
+		}
+
+	if (pkts_drop_mask)
+		rte_pipeline_ah_packet_drop(p, pkts_drop_mask);
+
+	return 0;
+}
+
+/* Handler for any action mask, read from the table action object */
+static int
+ah_default(struct rte_pipeline *p,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	struct rte_pipeline_table_entry **entries,
+	void *arg)
+{
+	struct rte_table_action *action = arg;
+
+	return ah(p, pkts, pkts_mask, entries, action,
+		action->cfg.action_mask);
+}
+
+#define AH_SPECIALIZED(f_ah, action_mask)                            \
+static int                                                           \
+f_ah(struct rte_pipeline *p,                                         \
+	struct rte_mbuf **pkts,                                      \
+	uint64_t pkts_mask,                                          \
+	struct rte_pipeline_table_entry **entries,                   \
+	void *arg)                                                   \
+{                                                                    \
+	return ah(p, pkts, pkts_mask, entries, arg, action_mask);    \
+}
+
+#define AH_MASK_FWD_STATS                                            \
+	(ACTION_MASK(RTE_TABLE_ACTION_FWD) |                         \
+	ACTION_MASK(RTE_TABLE_ACTION_STATS))
+
+#define AH_MASK_FWD_TTL_STATS                                        \
+	(AH_MASK_FWD_STATS |                                         \
+	ACTION_MASK(RTE_TABLE_ACTION_TTL))
+
+#define AH_MASK_FWD_ENCAP_TTL_STATS                                  \
+	(AH_MASK_FWD_TTL_STATS |                                     \
+	ACTION_MASK(RTE_TABLE_ACTION_ENCAP))
+
+#define AH_MASK_FWD_MTR_STATS                                        \
+	(AH_MASK_FWD_STATS |                                         \
+	ACTION_MASK(RTE_TABLE_ACTION_MTR))
+
+#define AH_MASK_FWD_MTR_TM_STATS                                     \
+	(AH_MASK_FWD_MTR_STATS |                                     \
+	ACTION_MASK(RTE_TABLE_ACTION_TM))
+
+AH_SPECIALIZED(ah_fwd_stats, AH_MASK_FWD_STATS)
+AH_SPECIALIZED(ah_fwd_ttl_stats, AH_MASK_FWD_TTL_STATS)
+AH_SPECIALIZED(ah_fwd_encap_ttl_stats, AH_MASK_FWD_ENCAP_TTL_STATS)
+AH_SPECIALIZED(ah_fwd_mtr_stats, AH_MASK_FWD_MTR_STATS)
+AH_SPECIALIZED(ah_fwd_mtr_tm_stats, AH_MASK_FWD_MTR_TM_STATS)
+
+/* Handlers built for the action masks of the usual pipelines: flow
+ * classification, routing, flow actions.
+ */
+static const struct {
+	uint64_t action_mask;
+	rte_pipeline_table_action_handler_hit f_ah;
+} ah_specialized[] = {
+	{AH_MASK_FWD_STATS, ah_fwd_stats},
+	{AH_MASK_FWD_TTL_STATS, ah_fwd_ttl_stats},
+	{AH_MASK_FWD_ENCAP_TTL_STATS, ah_fwd_encap_ttl_stats},
+	{AH_MASK_FWD_MTR_STATS, ah_fwd_mtr_stats},
+	{AH_MASK_FWD_MTR_TM_STATS, ah_fwd_mtr_tm_stats},
+};
+
+static rte_pipeline_table_action_handler_hit
+ah_selector(struct rte_table_action *action)
+{
+	uint64_t action_mask = action->cfg.action_mask;
+	uint32_t i;
+
+	/* Forward only: nothing to do besides the reserved actions */
+	if ((action_mask & ~ACTION_MASK(RTE_TABLE_ACTION_FWD)) == 0)
+		return NULL;
+
+	/* The FWD action has no work, whether it is enabled is irrelevant */
+	action_mask |= ACTION_MASK(RTE_TABLE_ACTION_FWD);
+	for (i = 0; i < RTE_DIM(ah_specialized); i++)
+		if (ah_specialized[i].action_mask == action_mask)
+			return ah_specialized[i].f_ah;
+
+	return ah_default;
+}
+
+int
+rte_table_action_table_params_get(struct rte_table_action *action,
+	struct rte_pipeline_table_params *params)
+{
+	rte_pipeline_table_action_handler_hit f_action_hit;
+	uint32_t total_size;
+
+	/* Check input arguments */
+	if (action == NULL ||
+		params == NULL)
+		return -EINVAL;
+
+	f_action_hit = ah_selector(action);
+	total_size = rte_align32pow2(action->data.total_size);
+
+	/* Fill in params */
+	params->f_action_hit = f_action_hit;
+	params->f_action_miss = NULL;
+	params->arg_ah = (f_action_hit) ? action : NULL;
+	params->action_data_size = total_size -
+		sizeof(struct rte_pipeline_table_entry);
+
+	return 0;
+}
+
+int
+rte_table_action_free(struct rte_table_action *action)
+{
+	if (action == NULL)
+		return 0;
+
+	rte_free(action);
+
+	return 0;
+}
@@ -0,0 +1,706 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef __INCLUDE_RTE_TABLE_ACTION_H__
+#define __INCLUDE_RTE_TABLE_ACTION_H__
+
+/**
+ * @file
+ * RTE Pipeline Table Actions
+ *
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * This API provides a common set of actions for pipeline tables to speed up
+ * application development.
+ *
+ * Each table action is a set of packet processing operations (e.g. metering,
+ * encapsulation, NAT, TTL update, statistics) applied to the packets hitting
+ * a table entry, based on the data stored in that entry. Several actions can
+ * be combined in a table action profile: the profile sets which actions are
+ * enabled for all the entries of a table, and their configuration.
+ *
+ * Once frozen, the profile fixes the layout of the table entry: the data of
+ * each enabled action is packed after the struct rte_pipeline_table_entry
+ * header, in the order the actions are applied to the packets. A table action
+ * object created from the profile then provides the pipeline table action
+ * handler for this layout, through rte_table_action_table_params_get().
+ *
+ * The actions are applied in this order: forward, load balance, meter,
+ * traffic management, encapsulation, NAT, TTL update, statistics, timestamp.
+ *
+ * Typical usage:
+ * - create a profile, register its actions, freeze it;
+ * - create a table action object from the profile, get its table parameters
+ *   and create the pipeline table with them;
+ * - fill in each table entry with rte_table_action_apply(), once per enabled
+ *   action, then add it to the pipeline table;
+ * - read the counters of an entry with the *_read() functions.
+ *
+ * All the table entries are assumed to carry packets of the IP version of the
+ * profile, with the IP header at the same place.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_ether.h>
+#include <rte_meter.h>
+#include <rte_pipeline.h>
+#include <rte_table_hash.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Table actions. */
+enum rte_table_action_type {
+	/** Forward to next pipeline table, output port or drop. */
+	RTE_TABLE_ACTION_FWD = 0,
+
+	/** Load balance: select an output from the hash of a packet key. */
+	RTE_TABLE_ACTION_LB,
+
+	/** Traffic metering and policing. */
+	RTE_TABLE_ACTION_MTR,
+
+	/** Traffic management: set the scheduler path of the packet. */
+	RTE_TABLE_ACTION_TM,
+
+	/** Packet encapsulation. */
+	RTE_TABLE_ACTION_ENCAP,
+
+	/** Network Address Translation (NAT). */
+	RTE_TABLE_ACTION_NAT,
+
+	/** TTL update. */
+	RTE_TABLE_ACTION_TTL,
+
+	/** Statistics. */
+	RTE_TABLE_ACTION_STATS,
+
+	/** Timestamp of the last packet. */
+	RTE_TABLE_ACTION_TIME,
+};
+
+/** Common action configuration (per table action profile). */
+struct rte_table_action_common_config {
+	/** Input packet IP version: non-zero for IPv4, zero for IPv6. */
+	int ip_version;
+
+	/** Offset of the IP header within the input packet buffer. Offset 0
+	 * points to the first byte of the MBUF structure.
+	 */
+	uint32_t ip_offset;
+};
+
+/**
+ * RTE_TABLE_ACTION_FWD
+ */
+/** Forward action parameters (per table rule). */
+struct rte_table_action_fwd_params {
+	/** Forward action: RTE_PIPELINE_ACTION_DROP, _PORT, _PORT_META or
+	 * _TABLE.
+	 */
+	enum rte_pipeline_action action;
+
+	/** Pipeline table ID or output port ID. */
+	uint32_t id;
+};
+
+/**
+ * RTE_TABLE_ACTION_LB
+ */
+/** Max key size for load balancing. */
+#define RTE_TABLE_ACTION_LB_KEY_SIZE_MAX                   64
+
+/** Number of outputs of the load balancing table. */
+#define RTE_TABLE_ACTION_LB_TABLE_SIZE                     8
+
+/** Load balance action configuration (per table action profile). */
+struct rte_table_action_lb_config {
+	/** Key size: a multiple of 8, up to RTE_TABLE_ACTION_LB_KEY_SIZE_MAX
+	 * bytes.
+	 */
+	uint32_t key_size;
+
+	/** Key offset within the input packet buffer. Offset 0 points to the
+	 * first byte of the MBUF structure.
+	 */
+	uint32_t key_offset;
+
+	/** Hash function. */
+	rte_table_hash_op_hash f_hash;
+
+	/** Seed value for the hash function. */
+	uint64_t seed;
+
+	/** Offset within the input packet buffer where the 32-bit output
+	 * value is written. Offset 0 points to the first byte of the MBUF
+	 * structure.
+	 */
+	uint32_t out_offset;
+};
+
+/** Load balance action parameters (per table rule). */
+struct rte_table_action_lb_params {
+	/** Output value selected by the hash of the packet key. */
+	uint32_t out[RTE_TABLE_ACTION_LB_TABLE_SIZE];
+};
+
+/**
+ * RTE_TABLE_ACTION_MTR
+ */
+/** Max number of traffic classes (TCs). */
+#define RTE_TABLE_ACTION_TC_MAX                            4
+
+/** Max number of queues per traffic class. */
+#define RTE_TABLE_ACTION_TC_QUEUE_MAX                      4
+
+/** Differentiated Services Code Point (DSCP) translation table entry. */
+struct rte_table_action_dscp_table_entry {
+	/** Traffic class. Used by the meter and traffic management actions.
+	 * Has to be strictly smaller than RTE_TABLE_ACTION_TC_MAX.
+	 */
+	uint32_t tc_id;
+
+	/** Traffic class queue. Used by the traffic management action. Has
+	 * to be strictly smaller than RTE_TABLE_ACTION_TC_QUEUE_MAX.
+	 */
+	uint32_t tc_queue_id;
+
+	/** Packet input color. Used by the meter action as the input color
+	 * for the color aware mode of the meter.
+	 */
+	enum rte_meter_color color;
+};
+
+/** DSCP translation table. */
+struct rte_table_action_dscp_table {
+	/** Entries, indexed by the DSCP field of the packet. */
+	struct rte_table_action_dscp_table_entry entry[64];
+};
+
+/** Meter algorithms. */
+enum rte_table_action_meter_algorithm {
+	/** Two Rate Three Color Marker (trTCM), RFC 2698. */
+	RTE_TABLE_ACTION_METER_TRTCM,
+};
+
+/** Policer actions. */
+enum rte_table_action_policer {
+	/** Recolor the packet as green. */
+	RTE_TABLE_ACTION_POLICER_COLOR_GREEN = 0,
+
+	/** Recolor the packet as yellow. */
+	RTE_TABLE_ACTION_POLICER_COLOR_YELLOW,
+
+	/** Recolor the packet as red. */
+	RTE_TABLE_ACTION_POLICER_COLOR_RED,
+
+	/** Drop the packet. */
+	RTE_TABLE_ACTION_POLICER_DROP,
+
+	/** Number of policer actions. */
+	RTE_TABLE_ACTION_POLICER_MAX
+};
+
+/** Meter action configuration (per table action profile). */
+struct rte_table_action_mtr_config {
+	/** Meter algorithm. */
+	enum rte_table_action_meter_algorithm alg;
+
+	/** Number of traffic classes, each with its own meter: 1 or
+	 * RTE_TABLE_ACTION_TC_MAX. With one traffic class, all the packets of
+	 * an entry go through its single meter.
+	 */
+	uint32_t n_tc;
+};
+
+/** Meter action parameters per traffic class. */
+struct rte_table_action_mtr_tc_params {
+	/** trTCM parameters of the meter. */
+	struct rte_meter_trtcm_params meter;
+
+	/** Policer action for each output color of the meter. */
+	enum rte_table_action_policer policer[e_RTE_METER_COLORS];
+};
+
+/** Meter action parameters (per table rule). */
+struct rte_table_action_mtr_params {
+	/** Traffic class parameters. */
+	struct rte_table_action_mtr_tc_params mtr[RTE_TABLE_ACTION_TC_MAX];
+
+	/** Bit mask of the traffic classes to configure. */
+	uint32_t tc_mask;
+};
+
+/** Meter action counters per traffic class. */
+struct rte_table_action_mtr_counters_tc {
+	/** Number of packets per output color, drops not included. */
+	uint64_t n_packets[e_RTE_METER_COLORS];
+
+	/** Number of bytes per output color, drops not included. */
+	uint64_t n_bytes[e_RTE_METER_COLORS];
+
+	/** Number of packets dropped by the policer. */
+	uint64_t n_packets_dropped;
+};
+
+/** Meter action counters. */
+struct rte_table_action_mtr_counters {
+	/** Traffic class counters. */
+	struct rte_table_action_mtr_counters_tc stats[RTE_TABLE_ACTION_TC_MAX];
+
+	/** Bit mask of the traffic classes with valid counters. */
+	uint32_t tc_mask;
+};
+
+/**
+ * RTE_TABLE_ACTION_TM
+ */
+/** Traffic management action configuration (per table action profile). */
+struct rte_table_action_tm_config {
+	/** Number of subports per port. */
+	uint32_t n_subports_per_port;
+
+	/** Number of pipes per subport. */
+	uint32_t n_pipes_per_subport;
+};
+
+/** Traffic management action parameters (per table rule). */
+struct rte_table_action_tm_params {
+	/** Subport ID. */
+	uint32_t subport_id;
+
+	/** Pipe ID. */
+	uint32_t pipe_id;
+};
+
+/**
+ * RTE_TABLE_ACTION_ENCAP
+ */
+/** Supported packet encapsulation types. */
+enum rte_table_action_encap_type {
+	/** IP -> { Ether | IP } */
+	RTE_TABLE_ACTION_ENCAP_ETHER = 0,
+
+	/** IP -> { Ether | VLAN | IP } */
+	RTE_TABLE_ACTION_ENCAP_VLAN,
+
+	/** IP -> { Ether | S-VLAN | C-VLAN | IP } */
+	RTE_TABLE_ACTION_ENCAP_QINQ,
+
+	/** IP -> { Ether | MPLS | IP } */
+	RTE_TABLE_ACTION_ENCAP_MPLS,
+};
+
+/** Ethernet header. */
+struct rte_table_action_ether_hdr {
+	struct ether_addr da; /**< Destination address. */
+	struct ether_addr sa; /**< Source address. */
+};
+
+/** VLAN header. */
+struct rte_table_action_vlan_hdr {
+	uint8_t pcp; /**< Priority Code Point (PCP). */
+	uint8_t dei; /**< Drop Eligibility Indicator (DEI). */
+	uint16_t vid; /**< VLAN Identifier (VID). */
+};
+
+/** MPLS header. */
+struct rte_table_action_mpls_hdr {
+	uint32_t label; /**< Label. */
+	uint8_t tc; /**< Traffic Class (TC). */
+	uint8_t ttl; /**< Time to Live (TTL). */
+};
+
+/** Max number of MPLS labels per packet. */
+#define RTE_TABLE_ACTION_MPLS_LABELS_MAX                   4
+
+/** Ether encap parameters. */
+struct rte_table_action_encap_ether_params {
+	struct rte_table_action_ether_hdr ether; /**< Ethernet header. */
+};
+
+/** VLAN encap parameters. */
+struct rte_table_action_encap_vlan_params {
+	struct rte_table_action_ether_hdr ether; /**< Ethernet header. */
+	struct rte_table_action_vlan_hdr vlan; /**< VLAN header. */
+};
+
+/** QinQ encap parameters. */
+struct rte_table_action_encap_qinq_params {
+	struct rte_table_action_ether_hdr ether; /**< Ethernet header. */
+	struct rte_table_action_vlan_hdr svlan; /**< Service VLAN header. */
+	struct rte_table_action_vlan_hdr cvlan; /**< Customer VLAN header. */
+};
+
+/** MPLS encap parameters. */
+struct rte_table_action_encap_mpls_params {
+	/** Ethernet header. */
+	struct rte_table_action_ether_hdr ether;
+
+	/** MPLS header, outermost label first. */
+	struct rte_table_action_mpls_hdr mpls[RTE_TABLE_ACTION_MPLS_LABELS_MAX];
+
+	/** Number of MPLS labels: 1 .. RTE_TABLE_ACTION_MPLS_LABELS_MAX. */
+	uint32_t mpls_count;
+
+	/** Non-zero for MPLS unicast, zero for MPLS multicast. */
+	int unicast;
+};
+
+/** Encap action configuration (per table action profile). */
+struct rte_table_action_encap_config {
+	/** Bit mask of the enabled encapsulation types, bit n being set for
+	 * enum rte_table_action_encap_type value n.
+	 */
+	uint64_t encap_mask;
+};
+
+/** Encap action parameters (per table rule). */
+struct rte_table_action_encap_params {
+	/** Encapsulation type. */
+	enum rte_table_action_encap_type type;
+
+	RTE_STD_C11
+	union {
+		/** Only valid when *type* is set to Ether. */
+		struct rte_table_action_encap_ether_params ether;
+
+		/** Only valid when *type* is set to VLAN. */
+		struct rte_table_action_encap_vlan_params vlan;
+
+		/** Only valid when *type* is set to QinQ. */
+		struct rte_table_action_encap_qinq_params qinq;
+
+		/** Only valid when *type* is set to MPLS. */
+		struct rte_table_action_encap_mpls_params mpls;
+	};
+};
+
+/**
+ * RTE_TABLE_ACTION_NAT
+ */
+/** NAT action configuration (per table action profile). */
+struct rte_table_action_nat_config {
+	/** Non-zero for source NAT, zero for destination NAT. */
+	int source_nat;
+
+	/** Layer 4 protocol, for the port translation and checksum update:
+	 * IPPROTO_TCP or IPPROTO_UDP.
+	 */
+	uint8_t proto;
+};
+
+/** NAT action parameters (per table rule). */
+struct rte_table_action_nat_params {
+	/** IP version of *addr*, has to match the profile. */
+	int ip_version;
+
+	/** New IP address. */
+	RTE_STD_C11
+	union {
+		/** IPv4 address, in host byte order. */
+		uint32_t ipv4;
+
+		/** IPv6 address, in network byte order. */
+		uint8_t ipv6[16];
+	} addr;
+
+	/** New port, in host byte order. */
+	uint16_t port;
+};
+
+/**
+ * RTE_TABLE_ACTION_TTL
+ */
+/** TTL action configuration (per table action profile). */
+struct rte_table_action_ttl_config {
+	/** When non-zero, the packets whose TTL reaches zero are dropped,
+	 * otherwise they are only counted.
+	 */
+	int drop;
+};
+
+/** TTL action parameters (per table rule). */
+struct rte_table_action_ttl_params {
+	/** When non-zero, the TTL (IPv4) or hop limit (IPv6) is decremented,
+	 * otherwise it is only checked.
+	 */
+	int decrement;
+};
+
+/** TTL action counters. */
+struct rte_table_action_ttl_counters {
+	/** Number of packets whose TTL reached zero. */
+	uint64_t n_packets;
+};
+
+/**
+ * RTE_TABLE_ACTION_STATS
+ */
+/** Stats action configuration (per table action profile). */
+struct rte_table_action_stats_config {
+	/** When non-zero, the number of packets is counted. */
+	int n_packets_enabled;
+
+	/** When non-zero, the number of bytes is counted. */
+	int n_bytes_enabled;
+};
+
+/** Stats action counters. */
+struct rte_table_action_stats_counters {
+	/** Number of packets. */
+	uint64_t n_packets;
+
+	/** Number of bytes, from the IP header on. */
+	uint64_t n_bytes;
+
+	/** Non-zero when n_packets is valid. */
+	int n_packets_valid;
+
+	/** Non-zero when n_bytes is valid. */
+	int n_bytes_valid;
+};
+
+/**
+ * Table action profile.
+ */
+struct rte_table_action_profile;
+
+/**
+ * Table action profile create.
+ *
+ * @param[in] common
+ *   Common action configuration.
+ * @return
+ *   Table action profile handle on success, NULL otherwise.
+ */
+struct rte_table_action_profile *
+rte_table_action_profile_create(struct rte_table_action_common_config *common);
+
+/**
+ * Table action profile free.
+ *
+ * @param[in] profile
+ *   Table profile action handle (needs to be valid).
+ * @return
+ *   Zero on success, non-zero error code otherwise.
+ */
+int
+rte_table_action_profile_free(struct rte_table_action_profile *profile);
+
+/**
+ * Table action profile action register.
+ *
+ * @param[in] profile
+ *   Table profile action handle (needs to be valid and not in frozen state).
+ * @param[in] type
+ *   Specific table action to be registered for *profile*.
+ * @param[in] action_config
+ *   Configuration for the *type* action. NULL for the FWD, TIME and TTL
+ *   actions, meaning a default configuration for the latter.
+ * @return
+ *   Zero on success, non-zero error code otherwise.
+ */
+int
+rte_table_action_profile_action_register(
+	struct rte_table_action_profile *profile,
+	enum rte_table_action_type type,
+	void *action_config);
+
+/**
+ * Table action profile freeze.
+ *
+ * Computes the table entry layout. Once frozen, no more actions can be
+ * registered.
+ *
+ * @param[in] profile
+ *   Table profile action handle (needs to be valid and not in frozen state).
+ * @return
+ *   Zero on success, non-zero error code otherwise.
+ */
+int
+rte_table_action_profile_freeze(struct rte_table_action_profile *profile);
+
+/**
+ * Table action.
+ */
+struct rte_table_action;
+
+/**
+ * Table action create.
+ *
+ * @param[in] profile
+ *   Table profile action handle (needs to be valid and in frozen state).
+ * @param[in] socket_id
+ *   CPU socket ID where the internal data structures required by the new
+ *   table action object should be allocated.
+ * @return
+ *   Handle to table action object on success, NULL on error.
+ */
+struct rte_table_action *
+rte_table_action_create(struct rte_table_action_profile *profile,
+	uint32_t socket_id);
+
+/**
+ * Table action free.
+ *
+ * @param[in] action
+ *   Handle to table action object (needs to be valid).
+ * @return
+ *   Zero on success, non-zero error code otherwise.
+ */
+int
+rte_table_action_free(struct rte_table_action *action);
+
+/**
+ * Table action table params get.
+ *
+ * Sets the action handler, its argument and the action data size of the
+ * pipeline table parameters. The other fields are left unchanged.
+ *
+ * @param[in] action
+ *   Handle to table action object (needs to be valid).
+ * @param[inout] params
+ *   Pipeline table parameters (needs to be pre-allocated).
+ * @return
+ *   Zero on success, non-zero error code otherwise.
+ */
+int
+rte_table_action_table_params_get(struct rte_table_action *action,
+	struct rte_pipeline_table_params *params);
+
+/**
+ * Table action apply.
+ *
+ * Writes the data of one action in a table entry. The entry is typically
+ * written this way once per enabled action, then added to the pipeline table.
+ *
+ * @param[in] action
+ *   Handle to table action object (needs to be valid).
+ * @param[in] data
+ *   Table entry, of the layout of the profile of *action*.
+ * @param[in] type
+ *   Specific table action previously registered for the profile of *action*.
+ * @param[in] action_params
+ *   Parameters for the *type* action: struct rte_table_action_*_params, NULL
+ *   for the STATS and TIME actions, whose data is reset.
+ * @return
+ *   Zero on success, non-zero error code otherwise.
+ */
+int
+rte_table_action_apply(struct rte_table_action *action,
+	void *data,
+	enum rte_table_action_type type,
+	void *action_params);
+
+/**
+ * Table action DSCP table update.
+ *
+ * Not safe against concurrent packet processing by the action handler.
+ *
+ * @param[in] action
+ *   Handle to table action object (needs to be valid).
+ * @param[in] dscp_mask
+ *   64-bit mask defining the DSCP table entries to be updated. If bit N is
+ *   set in this bit mask, then DSCP table entry N is to be updated, otherwise
+ *   not.
+ * @param[in] table
+ *   DSCP table.
+ * @return
+ *   Zero on success, non-zero error code otherwise.
+ */
+int
+rte_table_action_dscp_table_update(struct rte_table_action *action,
+	uint64_t dscp_mask,
+	struct rte_table_action_dscp_table *table);
+
+/**
+ * Table action meter read.
+ *
+ * @param[in] action
+ *   Handle to table action object (needs to be valid).
+ * @param[in] data
+ *   Table entry with the MTR action previously applied.
+ * @param[in] tc_mask
+ *   Bit mask of the traffic classes to read.
+ * @param[inout] stats
+ *   When non-NULL, it points to the area where the counters are copied.
+ * @param[in] clear
+ *   When non-zero, the counters are cleared after being read.
+ * @return
+ *   Zero on success, non-zero error code otherwise.
+ */
+int
+rte_table_action_meter_read(struct rte_table_action *action,
+	void *data,
+	uint32_t tc_mask,
+	struct rte_table_action_mtr_counters *stats,
+	int clear);
+
+/**
+ * Table action TTL read.
+ *
+ * @param[in] action
+ *   Handle to table action object (needs to be valid).
+ * @param[in] data
+ *   Table entry with the TTL action previously applied.
+ * @param[inout] stats
+ *   When non-NULL, it points to the area where the counters are copied.
+ * @param[in] clear
+ *   When non-zero, the counters are cleared after being read.
+ * @return
+ *   Zero on success, non-zero error code otherwise.
+ */
+int
+rte_table_action_ttl_read(struct rte_table_action *action,
+	void *data,
+	struct rte_table_action_ttl_counters *stats,
+	int clear);
+
+/**
+ * Table action stats read.
+ *
+ * @param[in] action
+ *   Handle to table action object (needs to be valid).
+ * @param[in] data
+ *   Table entry with the STATS action previously applied.
+ * @param[inout] stats
+ *   When non-NULL, it points to the area where the counters are copied.
+ * @param[in] clear
+ *   When non-zero, the counters are cleared after being read.
+ * @return
+ *   Zero on success, non-zero error code otherwise.
+ */
+int
+rte_table_action_stats_read(struct rte_table_action *action,
+	void *data,
+	struct rte_table_action_stats_counters *stats,
+	int clear);
+
+/**
+ * Table action timestamp read.
+ *
+ * @param[in] action
+ *   Handle to table action object (needs to be valid).
+ * @param[in] data
+ *   Table entry with the TIME action previously applied.
+ * @param[inout] timestamp
+ *   Pre-allocated memory where the timestamp read from *data*, in TSC
+ *   cycles, is saved. Zero when no packet hit the entry yet.
+ * @return
+ *   Zero on success, non-zero error code otherwise.
+ */
+int
+rte_table_action_time_read(struct rte_table_action *action,
+	void *data,
+	uint64_t *timestamp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCLUDE_RTE_TABLE_ACTION_H__ */
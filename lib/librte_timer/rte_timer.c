@@ -31,11 +31,13 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+
 #include <string.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <inttypes.h>
 #include <assert.h>
+#include <errno.h>
 #include <sys/queue.h>
 
 #include <rte_atomic.h>
@@ -50,11 +52,45 @@
 #include <rte_spinlock.h>
 #include <rte_random.h>
 #include <rte_pause.h>
+#include <rte_malloc.h>
 
 #include "rte_timer.h"
 
 LIST_HEAD(rte_timer_list, rte_timer);
 
+/*
+ * Timing wheel geometry: a first level of 256 slots of one tick each,
+ * then four levels of 64 slots, each slot covering a whole turn of the
+ * level below, that is 2^32 ticks in all. Timers are moved down one level
+ * when the level below wraps.
+ */
+#define WHEEL_L0_BITS 8
+#define WHEEL_LN_BITS 6
+#define WHEEL_NB_LN 4
+#define WHEEL_L0_SIZE (1 << WHEEL_L0_BITS)
+#define WHEEL_LN_SIZE (1 << WHEEL_LN_BITS)
+#define WHEEL_L0_MASK (WHEEL_L0_SIZE - 1)
+#define WHEEL_LN_MASK (WHEEL_LN_SIZE - 1)
+#define WHEEL_MAX_TICKS \
+	((1ULL << (WHEEL_L0_BITS + WHEEL_NB_LN * WHEEL_LN_BITS)) - 1)
+
+/* default wheel resolution, in slots per second */
+#define WHEEL_DEFAULT_HZ 100000
+
+/* timers handled at once by the bulk functions */
+#define TIMER_BULK_SIZE 64U
+
+struct timer_wheel {
+	uint64_t cur_tick;      /**< next tick to expire */
+	uint64_t nb_timers;     /**< timers in the wheel slots */
+	unsigned int shift;     /**< log2 of the timer cycles per tick */
+
+	/** first level slots that may be in use, cleared lazily */
+	uint64_t l0_map[WHEEL_L0_SIZE / 64];
+	struct rte_timer *l0[WHEEL_L0_SIZE];
+	struct rte_timer *ln[WHEEL_NB_LN][WHEEL_LN_SIZE];
+} __rte_cache_aligned;
+
 struct priv_timer {
 	struct rte_timer pending_head;  /**< dummy timer instance to head up list */
 	rte_spinlock_t list_lock;       /**< lock to protect list access */
@@ -71,39 +107,156 @@ struct priv_timer {
 	/** running timer on this lcore now */
 	struct rte_timer *running_tim;
 
+	/** pending timers of the wheel backend, NULL for the skiplist */
+	struct timer_wheel *wheel;
+
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	/** per-lcore statistics */
 	struct rte_timer_debug_stats stats;
 #endif
 } __rte_cache_aligned;
 
-/** per-lcore private info for timers */
-static struct priv_timer priv_timer[RTE_MAX_LCORE];
+/** timer data instance, per-lcore private info for timers */
+struct rte_timer_data {
+	struct priv_timer priv_timer[RTE_MAX_LCORE];
+	struct timer_wheel *wheels;       /**< per-lcore wheels or NULL */
+};
+
+/** instance of the rte_timer_reset() family of functions */
+static struct rte_timer_data default_timer_data;
+
+static struct rte_timer_data *timer_data[RTE_TIMER_MAX_DATA] = {
+	[RTE_TIMER_DEFAULT_DATA_ID] = &default_timer_data,
+};
+static rte_spinlock_t timer_data_lock = RTE_SPINLOCK_INITIALIZER;
 
 /* when debug is enabled, store some statistics */
 #ifdef RTE_LIBRTE_TIMER_DEBUG
-#define __TIMER_STAT_ADD(name, n) do {					\
+#define __TIMER_STAT_ADD(priv_timer, name, n) do {			\
 		unsigned __lcore_id = rte_lcore_id();			\
 		if (__lcore_id < RTE_MAX_LCORE)				\
 			priv_timer[__lcore_id].stats.name += (n);	\
 	} while(0)
 #else
-#define __TIMER_STAT_ADD(name, n) do {} while(0)
+#define __TIMER_STAT_ADD(priv_timer, name, n) do {} while(0)
 #endif
 
+static inline struct rte_timer_data *
+timer_data_get(uint32_t id)
+{
+	if (id >= RTE_TIMER_MAX_DATA)
+		return NULL;
+	return timer_data[id];
+}
+
+static void
+timer_data_init(struct rte_timer_data *data)
+{
+	unsigned lcore_id;
+
+	/* the instance is zeroed, so only init some fields */
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id ++) {
+		rte_spinlock_init(&data->priv_timer[lcore_id].list_lock);
+		data->priv_timer[lcore_id].prev_lcore = lcore_id;
+	}
+}
+
 /* Init the timer library. */
 void
 rte_timer_subsystem_init(void)
 {
-	unsigned lcore_id;
+	/* since default_timer_data is static, it's zeroed by default */
+	timer_data_init(&default_timer_data);
+}
 
-	/* since priv_timer is static, it's zeroed by default, so only init some
-	 * fields.
-	 */
-	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id ++) {
-		rte_spinlock_init(&priv_timer[lcore_id].list_lock);
-		priv_timer[lcore_id].prev_lcore = lcore_id;
+/* Allocate a timer data instance with a given backend */
+int
+rte_timer_data_alloc_backend(uint32_t *id_ptr,
+		enum rte_timer_backend backend, uint64_t resolution)
+{
+	struct rte_timer_data *data;
+	unsigned int lcore_id, shift;
+	uint64_t now;
+	uint32_t id;
+
+	if (id_ptr == NULL || (backend != RTE_TIMER_BACKEND_SKIPLIST &&
+			       backend != RTE_TIMER_BACKEND_WHEEL))
+		return -EINVAL;
+
+	data = rte_zmalloc("rte_timer_data", sizeof(*data),
+			   RTE_CACHE_LINE_SIZE);
+	if (data == NULL)
+		return -ENOMEM;
+	timer_data_init(data);
+
+	if (backend == RTE_TIMER_BACKEND_WHEEL) {
+		data->wheels = rte_zmalloc("rte_timer_wheel",
+				sizeof(data->wheels[0]) * RTE_MAX_LCORE,
+				RTE_CACHE_LINE_SIZE);
+		if (data->wheels == NULL) {
+			rte_free(data);
+			return -ENOMEM;
+		}
+
+		if (resolution == 0)
+			resolution = rte_get_timer_hz() / WHEEL_DEFAULT_HZ;
+		shift = resolution > 1 ? 63 - __builtin_clzll(resolution) : 0;
+		now = rte_get_timer_cycles();
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+			data->wheels[lcore_id].shift = shift;
+			data->wheels[lcore_id].cur_tick = now >> shift;
+			data->priv_timer[lcore_id].wheel =
+				&data->wheels[lcore_id];
+		}
 	}
+
+	rte_spinlock_lock(&timer_data_lock);
+	for (id = 0; id < RTE_TIMER_MAX_DATA; id++)
+		if (timer_data[id] == NULL)
+			break;
+	if (id < RTE_TIMER_MAX_DATA)
+		timer_data[id] = data;
+	rte_spinlock_unlock(&timer_data_lock);
+
+	if (id == RTE_TIMER_MAX_DATA) {
+		rte_free(data->wheels);
+		rte_free(data);
+		return -ENOSPC;
+	}
+
+	*id_ptr = id;
+	return 0;
+}
+
+/* Allocate a timer data instance with the skiplist backend */
+int
+rte_timer_data_alloc(uint32_t *id_ptr)
+{
+	return rte_timer_data_alloc_backend(id_ptr,
+			RTE_TIMER_BACKEND_SKIPLIST, 0);
+}
+
+/* Free a timer data instance */
+int
+rte_timer_data_dealloc(uint32_t id)
+{
+	struct rte_timer_data *data;
+
+	if (id == RTE_TIMER_DEFAULT_DATA_ID)
+		return -EINVAL;
+
+	rte_spinlock_lock(&timer_data_lock);
+	data = timer_data_get(id);
+	if (data != NULL)
+		timer_data[id] = NULL;
+	rte_spinlock_unlock(&timer_data_lock);
+
+	if (data == NULL)
+		return -EINVAL;
+
+	rte_free(data->wheels);
+	rte_free(data);
+	return 0;
 }
 
 /* Initialize the timer handle tim for use */
@@ -124,7 +277,8 @@ rte_timer_init(struct rte_timer *tim)
  */
 static int
 timer_set_config_state(struct rte_timer *tim,
-		       union rte_timer_status *ret_prev_status)
+		       union rte_timer_status *ret_prev_status,
+		       struct priv_timer *priv_timer)
 {
 	union rte_timer_status prev_status, status;
 	int success = 0;
@@ -236,7 +390,7 @@ timer_get_skiplist_level(unsigned curr_depth)
  */
 static void
 timer_get_prev_entries(uint64_t time_val, unsigned tim_lcore,
-		struct rte_timer **prev)
+		struct rte_timer **prev, struct priv_timer *priv_timer)
 {
 	unsigned lvl = priv_timer[tim_lcore].curr_skiplist_depth;
 	prev[lvl] = &priv_timer[tim_lcore].pending_head;
@@ -255,13 +409,13 @@ timer_get_prev_entries(uint64_t time_val, unsigned tim_lcore,
  */
 static void
 timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
-		struct rte_timer **prev)
+		struct rte_timer **prev, struct priv_timer *priv_timer)
 {
 	int i;
 	/* to get a specific entry in the list, look for just lower than the time
 	 * values, and then increment on each level individually if necessary
 	 */
-	timer_get_prev_entries(tim->expire - 1, tim_lcore, prev);
+	timer_get_prev_entries(tim->expire - 1, tim_lcore, prev, priv_timer);
 	for (i = priv_timer[tim_lcore].curr_skiplist_depth - 1; i >= 0; i--) {
 		while (prev[i]->sl_next[i] != NULL &&
 				prev[i]->sl_next[i] != tim &&
@@ -271,26 +425,185 @@ timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
 }
 
 /*
- * add in list, lock if needed
+ * add in a wheel slot, the slot is picked from the distance to the
+ * current tick, so that it is moved down to the first level before it
+ * is due
+ */
+static void
+timer_wheel_add(struct timer_wheel *w, struct rte_timer *tim)
+{
+	struct rte_timer **slot;
+	uint64_t tick, delta;
+	unsigned int idx, lvl, shift;
+
+	/* the first tick not before the expiry time */
+	tick = tim->expire >> w->shift;
+	if (tim->expire & ((1ULL << w->shift) - 1))
+		tick++;
+
+	if (tick < w->cur_tick)
+		tick = w->cur_tick;
+	delta = tick - w->cur_tick;
+
+	if (delta < WHEEL_L0_SIZE) {
+		idx = tick & WHEEL_L0_MASK;
+		slot = &w->l0[idx];
+		w->l0_map[idx / 64] |= 1ULL << (idx % 64);
+	} else {
+		/* too far away, parked in the last level */
+		if (delta > WHEEL_MAX_TICKS)
+			tick = w->cur_tick + WHEEL_MAX_TICKS;
+
+		lvl = 0;
+		shift = WHEEL_L0_BITS;
+		while (delta >> (shift + WHEEL_LN_BITS) != 0 &&
+				lvl < WHEEL_NB_LN - 1) {
+			lvl++;
+			shift += WHEEL_LN_BITS;
+		}
+		idx = (tick >> shift) & WHEEL_LN_MASK;
+		slot = &w->ln[lvl][idx];
+	}
+
+	tim->wh_next = *slot;
+	if (tim->wh_next != NULL)
+		tim->wh_next->wh_pprev = &tim->wh_next;
+	tim->wh_pprev = slot;
+	*slot = tim;
+	w->nb_timers++;
+}
+
+/*
+ * del from a wheel slot, unless the timer was already taken out of the
+ * wheel by rte_timer_manage()
+ */
+static void
+timer_wheel_del(struct timer_wheel *w, struct rte_timer *tim)
+{
+	if (tim->wh_pprev == NULL)
+		return;
+
+	*tim->wh_pprev = tim->wh_next;
+	if (tim->wh_next != NULL)
+		tim->wh_next->wh_pprev = tim->wh_pprev;
+	tim->wh_pprev = NULL;
+	w->nb_timers--;
+}
+
+/* move the timers of a slot of an upper level to the levels below */
+static void
+timer_wheel_cascade(struct timer_wheel *w, struct rte_timer **slot)
+{
+	struct rte_timer *tim, *next_tim;
+
+	tim = *slot;
+	*slot = NULL;
+	for ( ; tim != NULL; tim = next_tim) {
+		next_tim = tim->wh_next;
+		w->nb_timers--;
+		timer_wheel_add(w, tim);
+	}
+}
+
+/* first level slot after idx that may be in use, or WHEEL_L0_SIZE */
+static unsigned int
+timer_wheel_next_slot(const struct timer_wheel *w, unsigned int idx)
+{
+	unsigned int i;
+	uint64_t map;
+
+	idx++;
+	if (idx == WHEEL_L0_SIZE)
+		return WHEEL_L0_SIZE;
+
+	i = idx / 64;
+	map = w->l0_map[i] & (UINT64_MAX << (idx % 64));
+	while (map == 0) {
+		if (++i == RTE_DIM(w->l0_map))
+			return WHEEL_L0_SIZE;
+		map = w->l0_map[i];
+	}
+
+	return i * 64 + __builtin_ctzll(map);
+}
+
+/*
+ * turn the wheel up to the current tick and return the timers that
+ * expired, chained through sl_next[0]
+ */
+static struct rte_timer *
+timer_wheel_expired(struct timer_wheel *w, uint64_t cur_time)
+{
+	struct rte_timer *run_first_tim = NULL, **pprev = &run_first_tim;
+	struct rte_timer *tim;
+	uint64_t now = cur_time >> w->shift;
+	unsigned int idx, lvl, n;
+
+	while (w->cur_tick <= now) {
+		if (w->nb_timers == 0) {
+			w->cur_tick = now + 1;
+			break;
+		}
+
+		idx = w->cur_tick & WHEEL_L0_MASK;
+		if (idx == 0) {
+			/* first level wrapped, refill it from the upper ones */
+			for (lvl = 0; lvl < WHEEL_NB_LN; lvl++) {
+				n = (w->cur_tick >> (WHEEL_L0_BITS +
+					lvl * WHEEL_LN_BITS)) & WHEEL_LN_MASK;
+				timer_wheel_cascade(w, &w->ln[lvl][n]);
+				if (n != 0)
+					break;
+			}
+		}
+
+		tim = w->l0[idx];
+		w->l0_map[idx / 64] &= ~(1ULL << (idx % 64));
+		if (tim == NULL) {
+			/* skip the empty slots, up to the next wrap */
+			w->cur_tick = RTE_MIN(w->cur_tick - idx +
+				timer_wheel_next_slot(w, idx), now + 1);
+			continue;
+		}
+
+		w->l0[idx] = NULL;
+		*pprev = tim;
+		for ( ; tim != NULL; tim = tim->wh_next) {
+			tim->wh_pprev = NULL;
+			w->nb_timers--;
+			pprev = &tim->wh_next;
+		}
+		w->cur_tick++;
+	}
+
+	return run_first_tim;
+}
+
+/*
+ * add in list, list must be locked
  * timer must be in config state
  * timer must not be in a list
  */
 static void
-timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
+__timer_add(struct rte_timer *tim, unsigned tim_lcore,
+		struct priv_timer *priv_timer)
 {
-	unsigned lcore_id = rte_lcore_id();
 	unsigned lvl;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
-
-	/* if timer needs to be scheduled on another core, we need to
-	 * lock the list; if it is on local core, we need to lock if
-	 * we are not called from rte_timer_manage() */
-	if (tim_lcore != lcore_id || !local_is_locked)
-		rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
+	struct timer_wheel *w = priv_timer[tim_lcore].wheel;
+
+	if (w != NULL) {
+		/* the wheel may not have been turned for a while */
+		if (w->nb_timers == 0)
+			w->cur_tick = RTE_MAX(w->cur_tick,
+					rte_get_timer_cycles() >> w->shift);
+		timer_wheel_add(w, tim);
+		return;
+	}
 
 	/* find where exactly this element goes in the list of elements
 	 * for each depth. */
-	timer_get_prev_entries(tim->expire, tim_lcore, prev);
+	timer_get_prev_entries(tim->expire, tim_lcore, prev, priv_timer);
 
 	/* now assign it a new level and add at that level */
 	const unsigned tim_level = timer_get_skiplist_level(
@@ -311,30 +624,47 @@ timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
 	 * NOTE: this is not atomic on 32-bit*/
 	priv_timer[tim_lcore].pending_head.expire = priv_timer[tim_lcore].\
 			pending_head.sl_next[0]->expire;
+}
+
+/*
+ * add in list, lock if needed
+ * timer must be in config state
+ * timer must not be in a list
+ */
+static void
+timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked,
+		struct priv_timer *priv_timer)
+{
+	unsigned lcore_id = rte_lcore_id();
+
+	/* if timer needs to be scheduled on another core, we need to
+	 * lock the list; if it is on local core, we need to lock if
+	 * we are not called from rte_timer_manage() */
+	if (tim_lcore != lcore_id || !local_is_locked)
+		rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
+
+	__timer_add(tim, tim_lcore, priv_timer);
 
 	if (tim_lcore != lcore_id || !local_is_locked)
 		rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
 }
 
 /*
- * del from list, lock if needed
+ * del from list, list must be locked
  * timer must be in config state
  * timer must be in a list
  */
 static void
-timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
-		int local_is_locked)
+__timer_del(struct rte_timer *tim, unsigned prev_owner,
+		struct priv_timer *priv_timer)
 {
-	unsigned lcore_id = rte_lcore_id();
-	unsigned prev_owner = prev_status.owner;
 	int i;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
-	/* if timer needs is pending another core, we need to lock the
-	 * list; if it is on local core, we need to lock if we are not
-	 * called from rte_timer_manage() */
-	if (prev_owner != lcore_id || !local_is_locked)
-		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
+	if (priv_timer[prev_owner].wheel != NULL) {
+		timer_wheel_del(priv_timer[prev_owner].wheel, tim);
+		return;
+	}
 
 	/* save the lowest list entry into the expire field of the dummy hdr.
 	 * NOTE: this is not atomic on 32-bit */
@@ -343,7 +673,7 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 				((tim->sl_next[0] == NULL) ? 0 : tim->sl_next[0]->expire);
 
 	/* adjust pointers from previous entries to point past this */
-	timer_get_prev_entries_for_node(tim, prev_owner, prev);
+	timer_get_prev_entries_for_node(tim, prev_owner, prev, priv_timer);
 	for (i = priv_timer[prev_owner].curr_skiplist_depth - 1; i >= 0; i--) {
 		if (prev[i]->sl_next[i] == tim)
 			prev[i]->sl_next[i] = tim->sl_next[i];
@@ -355,43 +685,87 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 			priv_timer[prev_owner].curr_skiplist_depth --;
 		else
 			break;
+}
+
+/*
+ * del from list, lock if needed
+ * timer must be in config state
+ * timer must be in a list
+ */
+static void
+timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
+		int local_is_locked, struct priv_timer *priv_timer)
+{
+	unsigned lcore_id = rte_lcore_id();
+	unsigned prev_owner = prev_status.owner;
+
+	/* if timer needs is pending another core, we need to lock the
+	 * list; if it is on local core, we need to lock if we are not
+	 * called from rte_timer_manage() */
+	if (prev_owner != lcore_id || !local_is_locked)
+		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
+
+	__timer_del(tim, prev_owner, priv_timer);
 
 	if (prev_owner != lcore_id || !local_is_locked)
 		rte_spinlock_unlock(&priv_timer[prev_owner].list_lock);
 }
 
+/* pick the lcore for LCORE_ID_ANY, round robin */
+static unsigned
+timer_get_lcore(unsigned tim_lcore, struct priv_timer *priv_timer)
+{
+	unsigned lcore_id = rte_lcore_id();
+
+	if (tim_lcore != (unsigned)LCORE_ID_ANY)
+		return tim_lcore;
+
+	if (lcore_id < RTE_MAX_LCORE) {
+		/* EAL thread with valid lcore_id */
+		tim_lcore = rte_get_next_lcore(
+			priv_timer[lcore_id].prev_lcore,
+			0, 1);
+		priv_timer[lcore_id].prev_lcore = tim_lcore;
+	} else
+		/* non-EAL thread do not run rte_timer_manage(),
+		 * so schedule the timer on the first enabled lcore. */
+		tim_lcore = rte_get_next_lcore(LCORE_ID_ANY, 0, 1);
+
+	return tim_lcore;
+}
+
+/* check that timers can be run on tim_lcore */
+static inline int
+timer_lcore_is_valid(unsigned tim_lcore)
+{
+	return tim_lcore == (unsigned)LCORE_ID_ANY ||
+		(tim_lcore < RTE_MAX_LCORE &&
+		 (rte_lcore_is_enabled(tim_lcore) ||
+		  rte_lcore_has_role(tim_lcore, ROLE_SERVICE) == 0));
+}
+
 /* Reset and start the timer associated with the timer handle (private func) */
 static int
 __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 		  uint64_t period, unsigned tim_lcore,
 		  rte_timer_cb_t fct, void *arg,
-		  int local_is_locked)
+		  int local_is_locked,
+		  struct priv_timer *priv_timer)
 {
 	union rte_timer_status prev_status, status;
 	int ret;
 	unsigned lcore_id = rte_lcore_id();
 
 	/* round robin for tim_lcore */
-	if (tim_lcore == (unsigned)LCORE_ID_ANY) {
-		if (lcore_id < RTE_MAX_LCORE) {
-			/* EAL thread with valid lcore_id */
-			tim_lcore = rte_get_next_lcore(
-				priv_timer[lcore_id].prev_lcore,
-				0, 1);
-			priv_timer[lcore_id].prev_lcore = tim_lcore;
-		} else
-			/* non-EAL thread do not run rte_timer_manage(),
-			 * so schedule the timer on the first enabled lcore. */
-			tim_lcore = rte_get_next_lcore(LCORE_ID_ANY, 0, 1);
-	}
+	tim_lcore = timer_get_lcore(tim_lcore, priv_timer);
 
 	/* wait that the timer is in correct status before update,
 	 * and mark it as being configured */
-	ret = timer_set_config_state(tim, &prev_status);
+	ret = timer_set_config_state(tim, &prev_status, priv_timer);
 	if (ret < 0)
 		return -1;
 
-	__TIMER_STAT_ADD(reset, 1);
+	__TIMER_STAT_ADD(priv_timer, reset, 1);
 	if (prev_status.state == RTE_TIMER_RUNNING &&
 	    lcore_id < RTE_MAX_LCORE) {
 		priv_timer[lcore_id].updated = 1;
@@ -399,8 +773,8 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 
 	/* remove it from list */
 	if (prev_status.state == RTE_TIMER_PENDING) {
-		timer_del(tim, prev_status, local_is_locked);
-		__TIMER_STAT_ADD(pending, -1);
+		timer_del(tim, prev_status, local_is_locked, priv_timer);
+		__TIMER_STAT_ADD(priv_timer, pending, -1);
 	}
 
 	tim->period = period;
@@ -408,8 +782,8 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 	tim->f = fct;
 	tim->arg = arg;
 
-	__TIMER_STAT_ADD(pending, 1);
-	timer_add(tim, tim_lcore, local_is_locked);
+	__TIMER_STAT_ADD(priv_timer, pending, 1);
+	timer_add(tim, tim_lcore, local_is_locked, priv_timer);
 
 	/* update state: as we are in CONFIG state, only us can modify
 	 * the state so we don't need to use cmpset() here */
@@ -430,9 +804,7 @@ rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
 	uint64_t cur_time = rte_get_timer_cycles();
 	uint64_t period;
 
-	if (unlikely((tim_lcore != (unsigned)LCORE_ID_ANY) &&
-			!(rte_lcore_is_enabled(tim_lcore) ||
-			  rte_lcore_has_role(tim_lcore, ROLE_SERVICE) == 0)))
+	if (unlikely(!timer_lcore_is_valid(tim_lcore)))
 		return -1;
 
 	if (type == PERIODICAL)
@@ -441,7 +813,29 @@ rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
 		period = 0;
 
 	return __rte_timer_reset(tim,  cur_time + ticks, period, tim_lcore,
-			  fct, arg, 0);
+			  fct, arg, 0, default_timer_data.priv_timer);
+}
+
+/* Reset and start the timer on a timer data instance */
+int
+rte_timer_alt_reset(uint32_t timer_data_id, struct rte_timer *tim,
+		    uint64_t ticks, enum rte_timer_type type,
+		    unsigned int tim_lcore, rte_timer_cb_t fct, void *arg)
+{
+	struct rte_timer_data *data = timer_data_get(timer_data_id);
+	uint64_t cur_time = rte_get_timer_cycles();
+	uint64_t period;
+
+	if (unlikely(data == NULL || !timer_lcore_is_valid(tim_lcore)))
+		return -EINVAL;
+
+	if (type == PERIODICAL)
+		period = ticks;
+	else
+		period = 0;
+
+	return __rte_timer_reset(tim,  cur_time + ticks, period, tim_lcore,
+			  fct, arg, 0, data->priv_timer);
 }
 
 /* loop until rte_timer_reset() succeed */
@@ -456,8 +850,8 @@ rte_timer_reset_sync(struct rte_timer *tim, uint64_t ticks,
 }
 
 /* Stop the timer associated with the timer handle tim */
-int
-rte_timer_stop(struct rte_timer *tim)
+static int
+__rte_timer_stop(struct rte_timer *tim, struct priv_timer *priv_timer)
 {
 	union rte_timer_status prev_status, status;
 	unsigned lcore_id = rte_lcore_id();
@@ -465,11 +859,11 @@ rte_timer_stop(struct rte_timer *tim)
 
 	/* wait that the timer is in correct status before update,
 	 * and mark it as being configured */
-	ret = timer_set_config_state(tim, &prev_status);
+	ret = timer_set_config_state(tim, &prev_status, priv_timer);
 	if (ret < 0)
 		return -1;
 
-	__TIMER_STAT_ADD(stop, 1);
+	__TIMER_STAT_ADD(priv_timer, stop, 1);
 	if (prev_status.state == RTE_TIMER_RUNNING &&
 	    lcore_id < RTE_MAX_LCORE) {
 		priv_timer[lcore_id].updated = 1;
@@ -477,8 +871,8 @@ rte_timer_stop(struct rte_timer *tim)
 
 	/* remove it from list */
 	if (prev_status.state == RTE_TIMER_PENDING) {
-		timer_del(tim, prev_status, 0);
-		__TIMER_STAT_ADD(pending, -1);
+		timer_del(tim, prev_status, 0, priv_timer);
+		__TIMER_STAT_ADD(priv_timer, pending, -1);
 	}
 
 	/* mark timer as stopped */
@@ -490,6 +884,25 @@ rte_timer_stop(struct rte_timer *tim)
 	return 0;
 }
 
+/* Stop the timer associated with the timer handle tim */
+int
+rte_timer_stop(struct rte_timer *tim)
+{
+	return __rte_timer_stop(tim, default_timer_data.priv_timer);
+}
+
+/* Stop the timer armed on a timer data instance */
+int
+rte_timer_alt_stop(uint32_t timer_data_id, struct rte_timer *tim)
+{
+	struct rte_timer_data *data = timer_data_get(timer_data_id);
+
+	if (unlikely(data == NULL))
+		return -EINVAL;
+
+	return __rte_timer_stop(tim, data->priv_timer);
+}
+
 /* loop until rte_timer_stop() succeed */
 void
 rte_timer_stop_sync(struct rte_timer *tim)
@@ -498,6 +911,144 @@ rte_timer_stop_sync(struct rte_timer *tim)
 		rte_pause();
 }
 
+/*
+ * mark timers as being configured, up to the first one that cannot be,
+ * and remove the pending ones from their lists, taking the list lock of
+ * an lcore once for consecutive timers pending on it
+ */
+static unsigned
+timer_bulk_config(struct rte_timer **tims, unsigned nb_tims,
+		  struct priv_timer *priv_timer)
+{
+	union rte_timer_status prev_status[TIMER_BULK_SIZE];
+	unsigned lcore_id = rte_lcore_id();
+	unsigned i, n, owner, locked = RTE_MAX_LCORE;
+
+	for (n = 0; n < nb_tims; n++) {
+		if (timer_set_config_state(tims[n], &prev_status[n],
+					   priv_timer) < 0)
+			break;
+		if (prev_status[n].state == RTE_TIMER_RUNNING &&
+		    lcore_id < RTE_MAX_LCORE)
+			priv_timer[lcore_id].updated = 1;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (prev_status[i].state != RTE_TIMER_PENDING)
+			continue;
+
+		owner = prev_status[i].owner;
+		if (owner != locked) {
+			if (locked != RTE_MAX_LCORE)
+				rte_spinlock_unlock(
+					&priv_timer[locked].list_lock);
+			rte_spinlock_lock(&priv_timer[owner].list_lock);
+			locked = owner;
+		}
+		__timer_del(tims[i], owner, priv_timer);
+		__TIMER_STAT_ADD(priv_timer, pending, -1);
+	}
+	if (locked != RTE_MAX_LCORE)
+		rte_spinlock_unlock(&priv_timer[locked].list_lock);
+
+	return n;
+}
+
+/* Reset and start a set of timers on a timer data instance */
+int
+rte_timer_alt_reset_bulk(uint32_t timer_data_id, struct rte_timer **tims,
+			 unsigned int nb_tims, uint64_t ticks,
+			 enum rte_timer_type type, unsigned int tim_lcore,
+			 rte_timer_cb_t fct, void **args)
+{
+	struct rte_timer_data *data = timer_data_get(timer_data_id);
+	struct priv_timer *priv_timer;
+	union rte_timer_status status;
+	uint64_t expire, period;
+	unsigned int done, n, i;
+
+	if (unlikely(data == NULL || !timer_lcore_is_valid(tim_lcore)))
+		return -EINVAL;
+	priv_timer = data->priv_timer;
+
+	period = type == PERIODICAL ? ticks : 0;
+	tim_lcore = timer_get_lcore(tim_lcore, priv_timer);
+	status.state = RTE_TIMER_PENDING;
+	status.owner = (int16_t)tim_lcore;
+
+	for (done = 0; done < nb_tims; done += n) {
+		n = timer_bulk_config(&tims[done],
+				RTE_MIN(nb_tims - done, TIMER_BULK_SIZE),
+				priv_timer);
+		if (n == 0)
+			break;
+
+		/* one expiry time per group keeps large sets on time and
+		 * limits the runs of equal keys in a skiplist */
+		expire = rte_get_timer_cycles() + ticks;
+		rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
+		for (i = done; i < done + n; i++) {
+			tims[i]->period = period;
+			tims[i]->expire = expire;
+			tims[i]->f = fct;
+			tims[i]->arg = args != NULL ? args[i] : NULL;
+			__timer_add(tims[i], tim_lcore, priv_timer);
+		}
+		rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
+		__TIMER_STAT_ADD(priv_timer, reset, n);
+		__TIMER_STAT_ADD(priv_timer, pending, n);
+
+		/* as we are in CONFIG state, only us can modify the state */
+		rte_wmb();
+		for (i = done; i < done + n; i++)
+			tims[i]->status.u32 = status.u32;
+
+		if (n < TIMER_BULK_SIZE && done + n < nb_tims) {
+			done += n;
+			break;
+		}
+	}
+
+	return done;
+}
+
+/* Stop a set of timers armed on a timer data instance */
+int
+rte_timer_alt_stop_bulk(uint32_t timer_data_id, struct rte_timer **tims,
+			unsigned int nb_tims)
+{
+	struct rte_timer_data *data = timer_data_get(timer_data_id);
+	union rte_timer_status status;
+	unsigned int done, n, i;
+
+	if (unlikely(data == NULL))
+		return -EINVAL;
+
+	status.state = RTE_TIMER_STOP;
+	status.owner = RTE_TIMER_NO_OWNER;
+
+	for (done = 0; done < nb_tims; done += n) {
+		n = timer_bulk_config(&tims[done],
+				RTE_MIN(nb_tims - done, TIMER_BULK_SIZE),
+				data->priv_timer);
+		if (n == 0)
+			break;
+		__TIMER_STAT_ADD(data->priv_timer, stop, n);
+
+		/* mark timers as stopped */
+		rte_wmb();
+		for (i = done; i < done + n; i++)
+			tims[i]->status.u32 = status.u32;
+
+		if (n < TIMER_BULK_SIZE && done + n < nb_tims) {
+			done += n;
+			break;
+		}
+	}
+
+	return done;
+}
+
 /* Test the PENDING status of the timer handle tim */
 int
 rte_timer_pending(struct rte_timer *tim)
@@ -505,59 +1056,89 @@ rte_timer_pending(struct rte_timer *tim)
 	return tim->status.state == RTE_TIMER_PENDING;
 }
 
+/*
+ * take the expired timers out of the skiplist of the local lcore, list
+ * must be locked
+ */
+static struct rte_timer *
+timer_skiplist_expired(uint64_t cur_time, struct priv_timer *priv_timer)
+{
+	struct rte_timer *tim;
+	unsigned lcore_id = rte_lcore_id();
+	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
+	int i;
+
+	/* if nothing to do just return */
+	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL ||
+	    priv_timer[lcore_id].pending_head.sl_next[0]->expire > cur_time)
+		return NULL;
+
+	/* save start of list of expired timers */
+	tim = priv_timer[lcore_id].pending_head.sl_next[0];
+
+	/* break the existing list at current time point */
+	timer_get_prev_entries(cur_time, lcore_id, prev, priv_timer);
+	for (i = priv_timer[lcore_id].curr_skiplist_depth -1; i >= 0; i--) {
+		if (prev[i] == &priv_timer[lcore_id].pending_head)
+			continue;
+		priv_timer[lcore_id].pending_head.sl_next[i] =
+		    prev[i]->sl_next[i];
+		if (prev[i]->sl_next[i] == NULL)
+			priv_timer[lcore_id].curr_skiplist_depth--;
+		prev[i] ->sl_next[i] = NULL;
+	}
+
+	return tim;
+}
+
 /* must be called periodically, run all timer that expired */
-void rte_timer_manage(void)
+static void
+__rte_timer_manage(struct priv_timer *priv_timer)
 {
 	union rte_timer_status status;
 	struct rte_timer *tim, *next_tim;
 	struct rte_timer *run_first_tim, **pprev;
 	unsigned lcore_id = rte_lcore_id();
-	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
+	struct timer_wheel *w;
 	uint64_t cur_time;
-	int i, ret;
+	int ret;
 
 	/* timer manager only runs on EAL thread with valid lcore_id */
 	assert(lcore_id < RTE_MAX_LCORE);
 
-	__TIMER_STAT_ADD(manage, 1);
+	__TIMER_STAT_ADD(priv_timer, manage, 1);
+	w = priv_timer[lcore_id].wheel;
 	/* optimize for the case where per-cpu list is empty */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
+	if (w != NULL ? w->nb_timers == 0 :
+	    priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
 		return;
 	cur_time = rte_get_timer_cycles();
 
 #ifdef RTE_ARCH_64
-	/* on 64-bit the value cached in the pending_head.expired will be
-	 * updated atomically, so we can consult that for a quick check here
-	 * outside the lock */
-	if (likely(priv_timer[lcore_id].pending_head.expire > cur_time))
+	/* on 64-bit the value cached in the pending_head.expired and the
+	 * current tick of the wheel will be updated atomically, so we can
+	 * consult them for a quick check here outside the lock */
+	if (w != NULL) {
+		if (likely((cur_time >> w->shift) < w->cur_tick))
+			return;
+	} else if (likely(priv_timer[lcore_id].pending_head.expire > cur_time))
 		return;
 #endif
 
 	/* browse ordered list, add expired timers in 'expired' list */
 	rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
 
+	if (w != NULL)
+		tim = timer_wheel_expired(w, cur_time);
+	else
+		tim = timer_skiplist_expired(cur_time, priv_timer);
+
 	/* if nothing to do just unlock and return */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL ||
-	    priv_timer[lcore_id].pending_head.sl_next[0]->expire > cur_time) {
+	if (tim == NULL) {
 		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
 		return;
 	}
 
-	/* save start of list of expired timers */
-	tim = priv_timer[lcore_id].pending_head.sl_next[0];
-
-	/* break the existing list at current time point */
-	timer_get_prev_entries(cur_time, lcore_id, prev);
-	for (i = priv_timer[lcore_id].curr_skiplist_depth -1; i >= 0; i--) {
-		if (prev[i] == &priv_timer[lcore_id].pending_head)
-			continue;
-		priv_timer[lcore_id].pending_head.sl_next[i] =
-		    prev[i]->sl_next[i];
-		if (prev[i]->sl_next[i] == NULL)
-			priv_timer[lcore_id].curr_skiplist_depth--;
-		prev[i] ->sl_next[i] = NULL;
-	}
-
 	/* transition run-list from PENDING to RUNNING */
 	run_first_tim = tim;
 	pprev = &run_first_tim;
@@ -592,7 +1173,7 @@ void rte_timer_manage(void)
 		/* execute callback function with list unlocked */
 		tim->f(tim, tim->arg);
 
-		__TIMER_STAT_ADD(pending, -1);
+		__TIMER_STAT_ADD(priv_timer, pending, -1);
 		/* the timer was stopped or reloaded by the callback
 		 * function, we have nothing to do here */
 		if (priv_timer[lcore_id].updated == 1)
@@ -609,20 +1190,41 @@ void rte_timer_manage(void)
 			/* keep it in list and mark timer as pending */
 			rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
 			status.state = RTE_TIMER_PENDING;
-			__TIMER_STAT_ADD(pending, 1);
+			__TIMER_STAT_ADD(priv_timer, pending, 1);
 			status.owner = (int16_t)lcore_id;
 			rte_wmb();
 			tim->status.u32 = status.u32;
 			__rte_timer_reset(tim, tim->expire + tim->period,
-				tim->period, lcore_id, tim->f, tim->arg, 1);
+				tim->period, lcore_id, tim->f, tim->arg, 1,
+				priv_timer);
 			rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
 		}
 	}
 	priv_timer[lcore_id].running_tim = NULL;
 }
 
+/* must be called periodically, run all timer that expired */
+void rte_timer_manage(void)
+{
+	__rte_timer_manage(default_timer_data.priv_timer);
+}
+
+/* run the expired timers of a timer data instance */
+int
+rte_timer_alt_manage(uint32_t timer_data_id)
+{
+	struct rte_timer_data *data = timer_data_get(timer_data_id);
+
+	if (unlikely(data == NULL))
+		return -EINVAL;
+
+	__rte_timer_manage(data->priv_timer);
+	return 0;
+}
+
 /* dump statistics about timers */
-void rte_timer_dump_stats(FILE *f)
+static void
+__rte_timer_dump_stats(FILE *f, struct priv_timer *priv_timer)
 {
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	struct rte_timer_debug_stats sum;
@@ -641,6 +1243,26 @@ void rte_timer_dump_stats(FILE *f)
 	fprintf(f, "  manage = %"PRIu64"\n", sum.manage);
 	fprintf(f, "  pending = %"PRIu64"\n", sum.pending);
 #else
+	RTE_SET_USED(priv_timer);
 	fprintf(f, "No timer statistics, RTE_LIBRTE_TIMER_DEBUG is disabled\n");
 #endif
 }
+
+/* dump statistics about timers */
+void rte_timer_dump_stats(FILE *f)
+{
+	__rte_timer_dump_stats(f, default_timer_data.priv_timer);
+}
+
+/* dump statistics about the timers of a timer data instance */
+int
+rte_timer_alt_dump_stats(uint32_t timer_data_id, FILE *f)
+{
+	struct rte_timer_data *data = timer_data_get(timer_data_id);
+
+	if (data == NULL)
+		return -EINVAL;
+
+	__rte_timer_dump_stats(f, data->priv_timer);
+	return 0;
+}
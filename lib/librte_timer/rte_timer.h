@@ -46,6 +46,8 @@
  *   to be specified in the call to rte_timer_reset().
  * - High precision is possible. NOTE: this depends on the call frequency to
  *   rte_timer_manage() that check the timer expiration for the local core.
+ * - Timers can be kept apart in timer data instances, whose pending timers
+ *   are held in a skiplist or in a timing wheel, see rte_timer_data_alloc().
  * - If not used in an application, for improved performance, it can be
  *   disabled at compilation time by not calling the rte_timer_manage()
  *   to improve performance.
@@ -80,6 +82,27 @@ extern "C" {
 
 #define RTE_TIMER_NO_OWNER -2 /**< Timer has no owner. */
 
+/**
+ * Identifier of the timer data instance used by the rte_timer_reset(),
+ * rte_timer_stop() and rte_timer_manage() family of functions.
+ */
+#define RTE_TIMER_DEFAULT_DATA_ID 0
+
+/** Maximum number of timer data instances, the default one included. */
+#define RTE_TIMER_MAX_DATA 64
+
+/**
+ * Data structure holding the pending timers of a timer data instance.
+ */
+enum rte_timer_backend {
+	/** Per-lcore skiplist ordered by expiry time, O(log n) arm and
+	 *  stop, expiry with the timer cycle precision. */
+	RTE_TIMER_BACKEND_SKIPLIST,
+	/** Per-lcore hierarchical timing wheel, O(1) arm and stop,
+	 *  expiry rounded up to the wheel resolution. */
+	RTE_TIMER_BACKEND_WHEEL,
+};
+
 /**
  * Timer type: Periodic or single (one-shot).
  */
@@ -128,7 +151,19 @@ typedef void (*rte_timer_cb_t)(struct rte_timer *, void *);
 struct rte_timer
 {
 	uint64_t expire;       /**< Time when timer expire. */
-	struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+	RTE_STD_C11
+	union {
+		/** Links in the skiplist of a skiplist timer data instance. */
+		struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+		/** Links in a slot of a timing wheel instance, wh_next is
+		 *  sl_next[0] so that expired timers are chained the same
+		 *  way by both backends. */
+		RTE_STD_C11
+		struct {
+			struct rte_timer *wh_next;
+			struct rte_timer **wh_pprev;
+		};
+	};
 	volatile union rte_timer_status status; /**< Status of timer. */
 	uint64_t period;       /**< Period of timer (0 if not periodic). */
 	rte_timer_cb_t f;      /**< Callback function. */
@@ -331,6 +366,192 @@ void rte_timer_manage(void);
  */
 void rte_timer_dump_stats(FILE *f);
 
+/**
+ * Allocate a timer data instance using the skiplist backend.
+ *
+ * Each instance has its own per-lcore lists of pending timers, so that
+ * the timers of a library or of an application are not mixed with the
+ * ones of the default instance. A timer must be stopped, and is managed,
+ * through the instance it was armed on.
+ *
+ * @param id_ptr
+ *   Pointer to variable to store the identifier of the instance.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid parameter.
+ *   - (-ENOSPC): No free instance left.
+ *   - (-ENOMEM): Memory allocation failure.
+ */
+int rte_timer_data_alloc(uint32_t *id_ptr);
+
+/**
+ * Allocate a timer data instance using the given backend.
+ *
+ * The timing wheel expires timers at the granularity of its resolution:
+ * a timer is never run before its expiry time, but up to one resolution
+ * later. Timers further away than 2^32 resolutions are kept in the last
+ * level of the wheel and moved down when it turns.
+ *
+ * @param id_ptr
+ *   Pointer to variable to store the identifier of the instance.
+ * @param backend
+ *   Data structure holding the pending timers.
+ * @param resolution
+ *   Timer cycles (see rte_get_timer_hz()) per slot of the timing wheel,
+ *   rounded down to a power of two. 0 selects about 10 microseconds.
+ *   Ignored by the skiplist backend.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid parameter.
+ *   - (-ENOSPC): No free instance left.
+ *   - (-ENOMEM): Memory allocation failure.
+ */
+int rte_timer_data_alloc_backend(uint32_t *id_ptr,
+		enum rte_timer_backend backend, uint64_t resolution);
+
+/**
+ * Free a timer data instance.
+ *
+ * No timer may be pending or running on the instance.
+ *
+ * @param id
+ *   Identifier of the instance, from rte_timer_data_alloc().
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid instance, or the default one.
+ */
+int rte_timer_data_dealloc(uint32_t id);
+
+/**
+ * Reset and start a timer on a timer data instance.
+ *
+ * See rte_timer_reset() for details.
+ *
+ * @param timer_data_id
+ *   Identifier of the instance to arm the timer on.
+ * @param tim
+ *   The timer handle.
+ * @param ticks
+ *   The number of cycles (see rte_get_hpet_hz()) before the callback
+ *   function is called.
+ * @param type
+ *   SINGLE or PERIODICAL, see rte_timer_reset().
+ * @param tim_lcore
+ *   The ID of the lcore where the timer callback function has to be
+ *   executed, or LCORE_ID_ANY.
+ * @param fct
+ *   The callback function of the timer.
+ * @param arg
+ *   The user argument of the callback function.
+ * @return
+ *   - 0: Success; the timer is scheduled.
+ *   - (-1): Timer is in the RUNNING or CONFIG state.
+ *   - (-EINVAL): Invalid instance or lcore.
+ */
+int rte_timer_alt_reset(uint32_t timer_data_id, struct rte_timer *tim,
+			uint64_t ticks, enum rte_timer_type type,
+			unsigned int tim_lcore, rte_timer_cb_t fct, void *arg);
+
+/**
+ * Stop a timer armed on a timer data instance.
+ *
+ * See rte_timer_stop() for details.
+ *
+ * @param timer_data_id
+ *   Identifier of the instance the timer was armed on.
+ * @param tim
+ *   The timer handle.
+ * @return
+ *   - 0: Success; the timer is stopped.
+ *   - (-1): The timer is in the RUNNING or CONFIG state.
+ *   - (-EINVAL): Invalid instance.
+ */
+int rte_timer_alt_stop(uint32_t timer_data_id, struct rte_timer *tim);
+
+/**
+ * Reset and start a set of timers on a timer data instance.
+ *
+ * All the timers get the same period, lcore and callback function. This
+ * is cheaper than as many calls to rte_timer_alt_reset(): the current
+ * time is read and the pending lists are locked once per group of
+ * timers. With LCORE_ID_ANY, one lcore is picked for the whole set.
+ *
+ * The timers are processed in order and the first one in the RUNNING or
+ * CONFIG state ends the call.
+ *
+ * @param timer_data_id
+ *   Identifier of the instance to arm the timers on.
+ * @param tims
+ *   Array of timer handles.
+ * @param nb_tims
+ *   Number of timers in the array.
+ * @param ticks
+ *   The number of cycles (see rte_get_hpet_hz()) before the callback
+ *   function is called.
+ * @param type
+ *   SINGLE or PERIODICAL, see rte_timer_reset().
+ * @param tim_lcore
+ *   The ID of the lcore where the timer callback functions have to be
+ *   executed, or LCORE_ID_ANY.
+ * @param fct
+ *   The callback function of the timers.
+ * @param args
+ *   Array of the user arguments of the callback function, one per timer,
+ *   or NULL to pass NULL to all of them.
+ * @return
+ *   - >= 0: Number of timers scheduled, the first ones of the array.
+ *   - (-EINVAL): Invalid instance or lcore.
+ */
+int rte_timer_alt_reset_bulk(uint32_t timer_data_id, struct rte_timer **tims,
+			     unsigned int nb_tims, uint64_t ticks,
+			     enum rte_timer_type type, unsigned int tim_lcore,
+			     rte_timer_cb_t fct, void **args);
+
+/**
+ * Stop a set of timers armed on a timer data instance.
+ *
+ * The timers are processed in order and the first one in the RUNNING or
+ * CONFIG state ends the call.
+ *
+ * @param timer_data_id
+ *   Identifier of the instance the timers were armed on.
+ * @param tims
+ *   Array of timer handles.
+ * @param nb_tims
+ *   Number of timers in the array.
+ * @return
+ *   - >= 0: Number of timers stopped, the first ones of the array.
+ *   - (-EINVAL): Invalid instance.
+ */
+int rte_timer_alt_stop_bulk(uint32_t timer_data_id, struct rte_timer **tims,
+			    unsigned int nb_tims);
+
+/**
+ * Run the expired timers of the calling lcore on a timer data instance.
+ *
+ * See rte_timer_manage() for details.
+ *
+ * @param timer_data_id
+ *   Identifier of the instance.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid instance.
+ */
+int rte_timer_alt_manage(uint32_t timer_data_id);
+
+/**
+ * Dump statistics about the timers of a timer data instance.
+ *
+ * @param timer_data_id
+ *   Identifier of the instance.
+ * @param f
+ *   A pointer to a file for output
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid instance.
+ */
+int rte_timer_alt_dump_stats(uint32_t timer_data_id, FILE *f);
+
 #ifdef __cplusplus
 }
 #endif
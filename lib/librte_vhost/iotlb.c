@@ -34,6 +34,7 @@
 #include <numaif.h>
 #endif
 
+#include <rte_malloc.h>
 #include <rte_tailq.h>
 
 #include "iotlb.h"
@@ -50,9 +51,6 @@ struct vhost_iotlb_entry {
 
 #define IOTLB_CACHE_SIZE 2048
 
-static void
-vhost_user_iotlb_cache_random_evict(struct vhost_virtqueue *vq);
-
 static void
 vhost_user_iotlb_pending_remove_all(struct vhost_virtqueue *vq)
 {
@@ -99,10 +97,7 @@ vhost_user_iotlb_pending_insert(struct vhost_virtqueue *vq,
 	ret = rte_mempool_get(vq->iotlb_pool, (void **)&node);
 	if (ret) {
 		RTE_LOG(DEBUG, VHOST_CONFIG, "IOTLB pool empty, clear entries\n");
-		if (!TAILQ_EMPTY(&vq->iotlb_pending_list))
-			vhost_user_iotlb_pending_remove_all(vq);
-		else
-			vhost_user_iotlb_cache_random_evict(vq);
+		vhost_user_iotlb_pending_remove_all(vq);
 		ret = rte_mempool_get(vq->iotlb_pool, (void **)&node);
 		if (ret) {
 			RTE_LOG(ERR, VHOST_CONFIG, "IOTLB pool still empty, failure\n");
@@ -142,165 +137,41 @@ vhost_user_iotlb_pending_remove(struct vhost_virtqueue *vq,
 	rte_rwlock_write_unlock(&vq->iotlb_pending_lock);
 }
 
+/*
+ * The cache is read without lock, but the bursts hold the IOTLB read lock:
+ * once it is taken for write, no burst uses a removed entry anymore.
+ */
 static void
-vhost_user_iotlb_cache_remove_all(struct vhost_virtqueue *vq)
-{
-	struct vhost_iotlb_entry *node, *temp_node;
-
-	rte_rwlock_write_lock(&vq->iotlb_lock);
-
-	TAILQ_FOREACH_SAFE(node, &vq->iotlb_list, next, temp_node) {
-		TAILQ_REMOVE(&vq->iotlb_list, node, next);
-		rte_mempool_put(vq->iotlb_pool, node);
-	}
-
-	vq->iotlb_cache_nr = 0;
-
-	rte_rwlock_write_unlock(&vq->iotlb_lock);
-}
-
-static void
-vhost_user_iotlb_cache_random_evict(struct vhost_virtqueue *vq)
+vhost_user_iotlb_cache_sync(struct vhost_virtqueue *vq)
 {
-	struct vhost_iotlb_entry *node, *temp_node;
-	int entry_idx;
-
-	rte_rwlock_write_lock(&vq->iotlb_lock);
-
-	entry_idx = rte_rand() % vq->iotlb_cache_nr;
-
-	TAILQ_FOREACH_SAFE(node, &vq->iotlb_list, next, temp_node) {
-		if (!entry_idx) {
-			TAILQ_REMOVE(&vq->iotlb_list, node, next);
-			rte_mempool_put(vq->iotlb_pool, node);
-			vq->iotlb_cache_nr--;
-			break;
-		}
-		entry_idx--;
-	}
-
-	rte_rwlock_write_unlock(&vq->iotlb_lock);
+	vhost_user_iotlb_wr_lock(vq);
+	vhost_user_iotlb_wr_unlock(vq);
 }
 
 void
 vhost_user_iotlb_cache_insert(struct vhost_virtqueue *vq, uint64_t iova,
 				uint64_t uaddr, uint64_t size, uint8_t perm)
 {
-	struct vhost_iotlb_entry *node, *new_node;
-	int ret;
+	if (vhost_iotlb_cache_add(&vq->iotlb_cache, iova, uaddr, size, perm))
+		vhost_user_iotlb_cache_sync(vq);
 
-	ret = rte_mempool_get(vq->iotlb_pool, (void **)&new_node);
-	if (ret) {
-		RTE_LOG(DEBUG, VHOST_CONFIG, "IOTLB pool empty, clear entries\n");
-		if (!TAILQ_EMPTY(&vq->iotlb_list))
-			vhost_user_iotlb_cache_random_evict(vq);
-		else
-			vhost_user_iotlb_pending_remove_all(vq);
-		ret = rte_mempool_get(vq->iotlb_pool, (void **)&new_node);
-		if (ret) {
-			RTE_LOG(ERR, VHOST_CONFIG, "IOTLB pool still empty, failure\n");
-			return;
-		}
-	}
-
-	new_node->iova = iova;
-	new_node->uaddr = uaddr;
-	new_node->size = size;
-	new_node->perm = perm;
-
-	rte_rwlock_write_lock(&vq->iotlb_lock);
-
-	TAILQ_FOREACH(node, &vq->iotlb_list, next) {
-		/*
-		 * Entries must be invalidated before being updated.
-		 * So if iova already in list, assume identical.
-		 */
-		if (node->iova == new_node->iova) {
-			rte_mempool_put(vq->iotlb_pool, new_node);
-			goto unlock;
-		} else if (node->iova > new_node->iova) {
-			TAILQ_INSERT_BEFORE(node, new_node, next);
-			vq->iotlb_cache_nr++;
-			goto unlock;
-		}
-	}
-
-	TAILQ_INSERT_TAIL(&vq->iotlb_list, new_node, next);
-	vq->iotlb_cache_nr++;
-
-unlock:
 	vhost_user_iotlb_pending_remove(vq, iova, size, perm);
-
-	rte_rwlock_write_unlock(&vq->iotlb_lock);
-
 }
 
 void
 vhost_user_iotlb_cache_remove(struct vhost_virtqueue *vq,
 					uint64_t iova, uint64_t size)
 {
-	struct vhost_iotlb_entry *node, *temp_node;
-
-	if (unlikely(!size))
-		return;
-
-	rte_rwlock_write_lock(&vq->iotlb_lock);
-
-	TAILQ_FOREACH_SAFE(node, &vq->iotlb_list, next, temp_node) {
-		/* Sorted list */
-		if (unlikely(iova + size < node->iova))
-			break;
-
-		if (iova < node->iova + node->size) {
-			TAILQ_REMOVE(&vq->iotlb_list, node, next);
-			rte_mempool_put(vq->iotlb_pool, node);
-			vq->iotlb_cache_nr--;
-		}
-	}
-
-	rte_rwlock_write_unlock(&vq->iotlb_lock);
+	if (vhost_iotlb_cache_del(&vq->iotlb_cache, iova, size))
+		vhost_user_iotlb_cache_sync(vq);
 }
 
 uint64_t
 vhost_user_iotlb_cache_find(struct vhost_virtqueue *vq, uint64_t iova,
 						uint64_t *size, uint8_t perm)
 {
-	struct vhost_iotlb_entry *node;
-	uint64_t offset, vva = 0, mapped = 0;
-
-	if (unlikely(!*size))
-		goto out;
-
-	TAILQ_FOREACH(node, &vq->iotlb_list, next) {
-		/* List sorted by iova */
-		if (unlikely(iova < node->iova))
-			break;
-
-		if (iova >= node->iova + node->size)
-			continue;
-
-		if (unlikely((perm & node->perm) != perm)) {
-			vva = 0;
-			break;
-		}
-
-		offset = iova - node->iova;
-		if (!vva)
-			vva = node->uaddr + offset;
-
-		mapped += node->size - offset;
-		iova = node->iova + node->size;
-
-		if (mapped >= *size)
-			break;
-	}
-
-out:
-	/* Only part of the requested chunk is mapped */
-	if (unlikely(mapped < *size))
-		*size = mapped;
-
-	return vva;
+	return vhost_iotlb_cache_lookup(&vq->iotlb_cache, &vq->iotlb_last,
+			iova, size, perm);
 }
 
 int
@@ -315,7 +186,7 @@ vhost_user_iotlb_init(struct virtio_net *dev, int vq_index)
 		 * The cache has already been initialized,
 		 * just drop all cached and pending entries.
 		 */
-		vhost_user_iotlb_cache_remove_all(vq);
+		vhost_iotlb_cache_flush(&vq->iotlb_cache);
 		vhost_user_iotlb_pending_remove_all(vq);
 	}
 
@@ -327,7 +198,6 @@ vhost_user_iotlb_init(struct virtio_net *dev, int vq_index)
 	rte_rwlock_init(&vq->iotlb_lock);
 	rte_rwlock_init(&vq->iotlb_pending_lock);
 
-	TAILQ_INIT(&vq->iotlb_list);
 	TAILQ_INIT(&vq->iotlb_pending_list);
 
 	snprintf(pool_name, sizeof(pool_name), "iotlb_cache_%d_%d",
@@ -351,8 +221,33 @@ vhost_user_iotlb_init(struct virtio_net *dev, int vq_index)
 		return -1;
 	}
 
-	vq->iotlb_cache_nr = 0;
+	/* The virtqueue may have moved to another node */
+	rte_free(vq->iotlb_cache.maps);
+	vq->iotlb_cache.seq = 0;
+	vq->iotlb_cache.nr = 0;
+	vq->iotlb_cache.max = 0;
+	rte_spinlock_init(&vq->iotlb_cache.lock);
+	vq->iotlb_cache.maps = rte_malloc_socket(NULL,
+			IOTLB_CACHE_SIZE * sizeof(struct vhost_iotlb_map),
+			RTE_CACHE_LINE_SIZE, socket);
+	if (!vq->iotlb_cache.maps) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+				"Failed to allocate IOTLB cache (%s)\n",
+				pool_name);
+		return -1;
+	}
+	vq->iotlb_cache.max = IOTLB_CACHE_SIZE;
 
 	return 0;
 }
 
+void
+vhost_user_iotlb_free(struct vhost_virtqueue *vq)
+{
+	rte_free(vq->iotlb_cache.maps);
+	vq->iotlb_cache.maps = NULL;
+	vq->iotlb_cache.max = 0;
+	rte_mempool_free(vq->iotlb_pool);
+	vq->iotlb_pool = NULL;
+}
+
@@ -33,6 +33,10 @@
 #define _VHOST_IOTLB_H_
 
 #include <stdbool.h>
+#include <string.h>
+
+#include <rte_pause.h>
+#include <rte_random.h>
 
 #include "vhost.h"
 
@@ -60,6 +64,222 @@ vhost_user_iotlb_wr_unlock(struct vhost_virtqueue *vq)
 	rte_rwlock_write_unlock(&vq->iotlb_lock);
 }
 
+/*
+ * Translate an IOVA through the cache, without lock. *size is updated
+ * with the length mapped contiguously with the requested permissions.
+ * *last is the index of the entry of the previous hit, tried first.
+ */
+static __rte_always_inline uint64_t
+vhost_iotlb_cache_lookup(struct vhost_iotlb_cache *c, uint32_t *last,
+		uint64_t iova, uint64_t *size, uint8_t perm)
+{
+	const struct vhost_iotlb_map *m;
+	uint64_t vva, mapped, offset, cur;
+	uint32_t seq, nr, n, half, i;
+
+	if (unlikely(!*size))
+		return 0;
+
+	for (;;) {
+		seq = c->seq;
+		if (unlikely(seq & 1)) {
+			rte_pause();
+			continue;
+		}
+		rte_smp_rmb();
+
+		nr = RTE_MIN(c->nr, c->max);
+		vva = 0;
+		mapped = 0;
+
+		i = *last;
+		if (likely(i < nr)) {
+			m = &c->maps[i];
+			offset = iova - m->iova;
+			if (offset < m->size && *size <= m->size - offset &&
+					(perm & m->perm) == perm) {
+				vva = m->uaddr + offset;
+				mapped = *size;
+				goto check;
+			}
+		}
+
+		/* last entry starting at or below iova, without branches */
+		i = 0;
+		n = nr;
+		while (n > 1) {
+			half = n >> 1;
+			i = c->maps[i + half].iova <= iova ? i + half : i;
+			n -= half;
+		}
+
+		/* the request may span contiguous entries */
+		cur = iova;
+		for (; i < nr; i++) {
+			m = &c->maps[i];
+			offset = cur - m->iova;
+			if (offset >= m->size)
+				break;
+
+			if (unlikely((perm & m->perm) != perm))
+				break;
+
+			if (mapped == 0) {
+				vva = m->uaddr + offset;
+				*last = i;
+			}
+
+			mapped += m->size - offset;
+			cur = m->iova + m->size;
+
+			if (mapped >= *size)
+				break;
+		}
+
+check:
+		rte_smp_rmb();
+		if (likely(c->seq == seq))
+			break;
+	}
+
+	/* Only part of the requested chunk is mapped */
+	if (unlikely(mapped < *size))
+		*size = mapped;
+
+	return vva;
+}
+
+static __rte_always_inline void
+vhost_iotlb_cache_write_begin(struct vhost_iotlb_cache *c)
+{
+	rte_spinlock_lock(&c->lock);
+	c->seq++;
+	rte_smp_wmb();
+}
+
+static __rte_always_inline void
+vhost_iotlb_cache_write_end(struct vhost_iotlb_cache *c)
+{
+	rte_smp_wmb();
+	c->seq++;
+	rte_spinlock_unlock(&c->lock);
+}
+
+/* Remove the entries overlapping [iova, iova + size), in a write section */
+static inline uint32_t
+__vhost_iotlb_cache_del(struct vhost_iotlb_cache *c, uint64_t iova,
+		uint64_t size)
+{
+	uint32_t lo, hi, i, first;
+
+	/* entries do not overlap, their ends are sorted as well */
+	lo = 0;
+	hi = c->nr;
+	while (lo < hi) {
+		i = (lo + hi) >> 1;
+		if (c->maps[i].iova + c->maps[i].size <= iova)
+			lo = i + 1;
+		else
+			hi = i;
+	}
+	first = lo;
+
+	hi = c->nr;
+	while (lo < hi) {
+		i = (lo + hi) >> 1;
+		if (c->maps[i].iova < iova + size)
+			lo = i + 1;
+		else
+			hi = i;
+	}
+
+	if (lo == first)
+		return 0;
+
+	memmove(&c->maps[first], &c->maps[lo],
+		(c->nr - lo) * sizeof(c->maps[0]));
+	c->nr -= lo - first;
+
+	return lo - first;
+}
+
+/*
+ * Insert an entry. The entries it overlaps are stale, they are replaced;
+ * a random entry is evicted when the cache is full.
+ * Return the number of entries removed.
+ */
+static inline uint32_t
+vhost_iotlb_cache_add(struct vhost_iotlb_cache *c, uint64_t iova,
+		uint64_t uaddr, uint64_t size, uint8_t perm)
+{
+	uint32_t lo, hi, i, n;
+
+	if (unlikely(!size || !c->max))
+		return 0;
+
+	vhost_iotlb_cache_write_begin(c);
+
+	n = __vhost_iotlb_cache_del(c, iova, size);
+
+	if (unlikely(c->nr == c->max)) {
+		i = rte_rand() % c->nr;
+		memmove(&c->maps[i], &c->maps[i + 1],
+			(c->nr - i - 1) * sizeof(c->maps[0]));
+		c->nr--;
+		n++;
+	}
+
+	lo = 0;
+	hi = c->nr;
+	while (lo < hi) {
+		i = (lo + hi) >> 1;
+		if (c->maps[i].iova < iova)
+			lo = i + 1;
+		else
+			hi = i;
+	}
+
+	memmove(&c->maps[lo + 1], &c->maps[lo],
+		(c->nr - lo) * sizeof(c->maps[0]));
+	c->maps[lo].iova = iova;
+	c->maps[lo].uaddr = uaddr;
+	c->maps[lo].size = size;
+	c->maps[lo].perm = perm;
+	c->nr++;
+
+	vhost_iotlb_cache_write_end(c);
+
+	return n;
+}
+
+/*
+ * Remove the entries overlapping [iova, iova + size).
+ * Return the number of entries removed.
+ */
+static inline uint32_t
+vhost_iotlb_cache_del(struct vhost_iotlb_cache *c, uint64_t iova,
+		uint64_t size)
+{
+	uint32_t n;
+
+	if (unlikely(!size))
+		return 0;
+
+	vhost_iotlb_cache_write_begin(c);
+	n = __vhost_iotlb_cache_del(c, iova, size);
+	vhost_iotlb_cache_write_end(c);
+
+	return n;
+}
+
+static inline void
+vhost_iotlb_cache_flush(struct vhost_iotlb_cache *c)
+{
+	vhost_iotlb_cache_write_begin(c);
+	c->nr = 0;
+	vhost_iotlb_cache_write_end(c);
+}
+
 void vhost_user_iotlb_cache_insert(struct vhost_virtqueue *vq, uint64_t iova,
 					uint64_t uaddr, uint64_t size,
 					uint8_t perm);
@@ -75,5 +295,6 @@ void vhost_user_iotlb_pending_remove(struct vhost_virtqueue *vq, uint64_t iova,
 						uint64_t size, uint8_t perm);
 
 int vhost_user_iotlb_init(struct virtio_net *dev, int vq_index);
+void vhost_user_iotlb_free(struct vhost_virtqueue *vq);
 
 #endif /* _VHOST_IOTLB_H_ */
@@ -0,0 +1,249 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#ifndef _RTE_VHOST_ASYNC_H_
+#define _RTE_VHOST_ASYNC_H_
+
+/**
+ * @file
+ * Asynchronous vhost enqueue
+ *
+ * With an async channel registered on a virtqueue, the copies of packet
+ * data into guest buffers are not done by the enqueuing core but handed
+ * to a copy engine, typically a DMA device. The enqueue is split in two
+ * steps: rte_vhost_submit_enqueue_burst() reserves the guest buffers and
+ * submits the copies, rte_vhost_poll_enqueue_completed() later updates
+ * the used ring for the packets whose copies are done and gives them
+ * back to the application. Packets are made visible to the guest in the
+ * order they were submitted.
+ *
+ * Only split virtqueues are supported.
+ */
+
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * One copy job: len bytes from src_addr to dst_addr, both being virtual
+ * addresses of the vhost process.
+ */
+struct rte_vhost_iovec {
+	void *src_addr;
+	void *dst_addr;
+	size_t len;
+};
+
+/**
+ * Copies of one packet.
+ */
+struct rte_vhost_async_desc {
+	struct rte_vhost_iovec *iov;
+	uint16_t nr_segs;
+};
+
+/**
+ * Copy engine callbacks.
+ */
+struct rte_vhost_async_channel_ops {
+	/**
+	 * Submit the copies of count packets. The descriptors are only
+	 * valid during the call.
+	 *
+	 * @param ctx
+	 *  context given at registration
+	 * @param descs
+	 *  copies of each packet
+	 * @param count
+	 *  number of packets
+	 * @return
+	 *  number of packets accepted, starting from the first one,
+	 *  negative on error
+	 */
+	int32_t (*transfer_data)(void *ctx,
+		const struct rte_vhost_async_desc *descs, uint16_t count);
+	/**
+	 * Report how many of the submitted packets have all their copies
+	 * done. Packets complete in submission order: a packet is only
+	 * reported once all those submitted before it have been.
+	 *
+	 * @param ctx
+	 *  context given at registration
+	 * @param max_packets
+	 *  maximum number of packets to report
+	 * @return
+	 *  number of packets completed since the last call, negative on
+	 *  error
+	 */
+	int32_t (*check_completed_copies)(void *ctx, uint16_t max_packets);
+};
+
+/**
+ * Register an async channel on a virtqueue of a running device, usually
+ * from the new_device callback. The synchronous rte_vhost_enqueue_burst()
+ * is not available on the virtqueue until the channel is unregistered.
+ *
+ * @param vid
+ *  vhost device ID
+ * @param queue_id
+ *  virtio queue index of a guest Rx queue
+ * @param ops
+ *  copy engine callbacks
+ * @param ctx
+ *  opaque context passed to the callbacks
+ * @param threshold
+ *  copies shorter than this many bytes are done by the enqueuing core
+ * @return
+ *  0 on success, negative errno value on error
+ */
+int rte_vhost_async_channel_register(int vid, uint16_t queue_id,
+	const struct rte_vhost_async_channel_ops *ops, void *ctx,
+	uint32_t threshold);
+
+/**
+ * Unregister the async channel of a virtqueue, usually from the
+ * destroy_device callback. It fails with -EBUSY while packets are
+ * in flight: they must first be collected through
+ * rte_vhost_poll_enqueue_completed().
+ *
+ * @param vid
+ *  vhost device ID
+ * @param queue_id
+ *  virtio queue index
+ * @return
+ *  0 on success, negative errno value on error
+ */
+int rte_vhost_async_channel_unregister(int vid, uint16_t queue_id);
+
+/**
+ * Reserve guest buffers for packets and submit their copies to the copy
+ * engine. The accepted packets belong to vhost until they are returned
+ * by rte_vhost_poll_enqueue_completed(); the application must not modify
+ * or free them meanwhile.
+ *
+ * @param vid
+ *  vhost device ID
+ * @param queue_id
+ *  virtio queue index
+ * @param pkts
+ *  packets to enqueue
+ * @param count
+ *  number of packets
+ * @return
+ *  number of packets accepted, from the head of the array
+ */
+uint16_t rte_vhost_submit_enqueue_burst(int vid, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint16_t count);
+
+/**
+ * Make the packets whose copies are done visible to the guest, and give
+ * them back to the application, which is responsible for freeing them.
+ *
+ * @param vid
+ *  vhost device ID
+ * @param queue_id
+ *  virtio queue index
+ * @param pkts
+ *  array filled with the completed packets, in submission order
+ * @param count
+ *  size of the array
+ * @return
+ *  number of packets completed
+ */
+uint16_t rte_vhost_poll_enqueue_completed(int vid, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint16_t count);
+
+/**
+ * Software copy engine
+ *
+ * A copy engine for platforms without DMA, or for testing: copies are
+ * done by worker lcores. Each engine owns a job ring served by one or
+ * more workers; each async channel gets its own engine channel, and
+ * several channels may share an engine.
+ */
+struct rte_vhost_async_sw;
+struct rte_vhost_async_sw_channel;
+
+/**
+ * Create a software copy engine.
+ *
+ * @param name
+ *  name of the engine, unique
+ * @param size
+ *  number of packets in flight in the engine, a power of 2
+ * @param socket_id
+ *  NUMA socket of the engine memory
+ * @return
+ *  the engine, NULL on error with rte_errno set
+ */
+struct rte_vhost_async_sw *rte_vhost_async_sw_create(const char *name,
+	unsigned int size, int socket_id);
+
+/**
+ * Release an engine. Its workers must be stopped and its channels freed.
+ *
+ * @param sw
+ *  the engine
+ */
+void rte_vhost_async_sw_free(struct rte_vhost_async_sw *sw);
+
+/**
+ * Worker loop, run on an lcore with rte_eal_remote_launch() and the
+ * engine as argument, until rte_vhost_async_sw_stop() is called. Any
+ * number of workers may serve the same engine.
+ *
+ * @param arg
+ *  the engine
+ * @return
+ *  0
+ */
+int rte_vhost_async_sw_worker(void *arg);
+
+/**
+ * Make the workers of an engine return, once the copies already submitted
+ * are done. No copies must be submitted to the engine afterwards.
+ *
+ * @param sw
+ *  the engine
+ */
+void rte_vhost_async_sw_stop(struct rte_vhost_async_sw *sw);
+
+/**
+ * Create a channel of an engine, to be registered as the context of an
+ * async channel along with rte_vhost_async_sw_ops().
+ *
+ * @param sw
+ *  the engine
+ * @param size
+ *  number of packets in flight in the channel, a power of 2; the size
+ *  of the virtqueue is enough
+ * @return
+ *  the channel, NULL on error with rte_errno set
+ */
+struct rte_vhost_async_sw_channel *rte_vhost_async_sw_channel_create(
+	struct rte_vhost_async_sw *sw, uint16_t size);
+
+/**
+ * Release a channel. It must not have packets in flight.
+ *
+ * @param ch
+ *  the channel
+ */
+void rte_vhost_async_sw_channel_free(struct rte_vhost_async_sw_channel *ch);
+
+/**
+ * @return
+ *  the callbacks of the software copy engine
+ */
+const struct rte_vhost_async_channel_ops *rte_vhost_async_sw_ops(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_VHOST_ASYNC_H_ */
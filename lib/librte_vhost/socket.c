@@ -680,6 +680,18 @@ rte_vhost_driver_register(const char *path, uint64_t flags)
 		vsocket->features &= ~(1ULL << VIRTIO_F_IOMMU_PLATFORM);
 	}
 
+	/*
+	 * Zero copy dequeue returns the buffers out of order and only knows
+	 * the split ring.
+	 */
+	if (vsocket->dequeue_zero_copy) {
+		uint64_t packed = (1ULL << VIRTIO_F_RING_PACKED) |
+				  (1ULL << VIRTIO_F_IN_ORDER);
+
+		vsocket->supported_features &= ~packed;
+		vsocket->features &= ~packed;
+	}
+
 	if ((flags & RTE_VHOST_USER_CLIENT) != 0) {
 		vsocket->reconnect = !(flags & RTE_VHOST_USER_NO_RECONNECT);
 		if (vsocket->reconnect && reconn_tid == 0) {
@@ -148,13 +148,46 @@ free_device(struct virtio_net *dev)
 
 		rte_free(vq->shadow_used_ring);
 		rte_free(vq->batch_copy_elems);
-		rte_mempool_free(vq->iotlb_pool);
+		vhost_free_async_mem(vq);
+		vhost_user_iotlb_free(vq);
 		rte_free(vq);
 	}
 
 	rte_free(dev);
 }
 
+static int
+vring_translate_packed(struct virtio_net *dev, struct vhost_virtqueue *vq)
+{
+	uint64_t req_size, size;
+
+	req_size = sizeof(struct vring_packed_desc) * vq->size;
+	size = req_size;
+	vq->desc_packed = (struct vring_packed_desc *)(uintptr_t)
+		vhost_iova_to_vva(dev, vq, vq->ring_addrs.desc_user_addr,
+				&size, VHOST_ACCESS_RW);
+	if (!vq->desc_packed || size != req_size)
+		return -1;
+
+	req_size = sizeof(struct vring_packed_desc_event);
+	size = req_size;
+	vq->driver_event = (struct vring_packed_desc_event *)(uintptr_t)
+		vhost_iova_to_vva(dev, vq, vq->ring_addrs.avail_user_addr,
+				&size, VHOST_ACCESS_RW);
+	if (!vq->driver_event || size != req_size)
+		return -1;
+
+	req_size = sizeof(struct vring_packed_desc_event);
+	size = req_size;
+	vq->device_event = (struct vring_packed_desc_event *)(uintptr_t)
+		vhost_iova_to_vva(dev, vq, vq->ring_addrs.used_user_addr,
+				&size, VHOST_ACCESS_RW);
+	if (!vq->device_event || size != req_size)
+		return -1;
+
+	return 0;
+}
+
 int
 vring_translate(struct virtio_net *dev, struct vhost_virtqueue *vq)
 {
@@ -163,6 +196,12 @@ vring_translate(struct virtio_net *dev, struct vhost_virtqueue *vq)
 	if (!(dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM)))
 		goto out;
 
+	if (vq_is_packed(dev)) {
+		if (vring_translate_packed(dev, vq) < 0)
+			return -1;
+		goto out;
+	}
+
 	req_size = sizeof(struct vring_desc) * vq->size;
 	size = req_size;
 	vq->desc = (struct vring_desc *)(uintptr_t)vhost_iova_to_vva(dev, vq,
@@ -232,6 +271,9 @@ init_vring_queue(struct virtio_net *dev, uint32_t vring_idx)
 
 	vq->kickfd = VIRTIO_UNINITIALIZED_EVENTFD;
 	vq->callfd = VIRTIO_UNINITIALIZED_EVENTFD;
+	/* Packed rings start with both wrap counters set */
+	vq->avail_wrap_counter = 1;
+	vq->used_wrap_counter = 1;
 
 	vhost_user_iotlb_init(dev, vring_idx);
 	/* Backends are set to -1 indicating an inactive device. */
@@ -255,6 +297,8 @@ reset_vring_queue(struct virtio_net *dev, uint32_t vring_idx)
 
 	vq = dev->virtqueue[vring_idx];
 	callfd = vq->callfd;
+	vhost_free_async_mem(vq);
+	vhost_user_iotlb_free(vq);
 	init_vring_queue(dev, vring_idx);
 	vq->callfd = callfd;
 }
@@ -504,6 +548,29 @@ rte_vhost_get_mem_table(int vid, struct rte_vhost_memory **mem)
 	return 0;
 }
 
+/*
+ * Count the descriptors the driver made available past last_avail_idx;
+ * a packed ring has no index to read it from.
+ */
+static uint16_t
+vring_packed_avail_entries(struct vhost_virtqueue *vq)
+{
+	uint16_t idx = vq->last_avail_idx;
+	bool wrap = vq->avail_wrap_counter;
+	uint16_t count;
+
+	for (count = 0; count < vq->size; count++) {
+		if (!desc_is_avail(&vq->desc_packed[idx], wrap))
+			break;
+		if (++idx >= vq->size) {
+			idx -= vq->size;
+			wrap ^= 1;
+		}
+	}
+
+	return count;
+}
+
 int
 rte_vhost_get_vhost_vring(int vid, uint16_t vring_idx,
 			  struct rte_vhost_vring *vring)
@@ -548,6 +615,9 @@ rte_vhost_avail_entries(int vid, uint16_t queue_id)
 	if (!vq->enabled)
 		return 0;
 
+	if (vq_is_packed(dev))
+		return vring_packed_avail_entries(vq);
+
 	return *(volatile uint16_t *)&vq->avail->idx - vq->last_used_idx;
 }
 
@@ -565,7 +635,11 @@ rte_vhost_enable_guest_notification(int vid, uint16_t queue_id, int enable)
 		return -1;
 	}
 
-	dev->virtqueue[queue_id]->used->flags = VRING_USED_F_NO_NOTIFY;
+	if (vq_is_packed(dev))
+		dev->virtqueue[queue_id]->device_event->flags =
+			VRING_EVENT_F_DISABLE;
+	else
+		dev->virtqueue[queue_id]->used->flags = VRING_USED_F_NO_NOTIFY;
 	return 0;
 }
 
@@ -623,5 +697,152 @@ rte_vhost_rx_queue_count(int vid, uint16_t qid)
 	if (unlikely(vq->enabled == 0 || vq->avail == NULL))
 		return 0;
 
+	if (vq_is_packed(dev))
+		return vring_packed_avail_entries(vq);
+
 	return *((volatile uint16_t *)&vq->avail->idx) - vq->last_avail_idx;
 }
+
+/*
+ * Release the async bookkeeping of a virtqueue. Packets still in flight
+ * are left to the application, which should have unregistered the
+ * channel from destroy_device.
+ */
+void
+vhost_free_async_mem(struct vhost_virtqueue *vq)
+{
+	rte_free(vq->async_pkts);
+	vq->async_pkts = NULL;
+	rte_free(vq->async_pkts_nr_used);
+	vq->async_pkts_nr_used = NULL;
+	rte_free(vq->async_used);
+	vq->async_used = NULL;
+	rte_free(vq->async_iov);
+	vq->async_iov = NULL;
+
+	vq->async_registered = false;
+}
+
+int
+rte_vhost_async_channel_register(int vid, uint16_t queue_id,
+	const struct rte_vhost_async_channel_ops *ops, void *ctx,
+	uint32_t threshold)
+{
+	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
+	int node, ret = 0;
+
+	dev = get_device(vid);
+	if (dev == NULL)
+		return -ENODEV;
+
+	if (ops == NULL || ops->transfer_data == NULL ||
+			ops->check_completed_copies == NULL)
+		return -EINVAL;
+
+	if (queue_id >= dev->nr_vring || (queue_id & 1) != 0) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) %s: invalid virtqueue idx %d.\n",
+			vid, __func__, queue_id);
+		return -EINVAL;
+	}
+
+	if (vq_is_packed(dev)) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) async enqueue not supported on packed rings\n",
+			vid);
+		return -ENOTSUP;
+	}
+
+	vq = dev->virtqueue[queue_id];
+	if (vq == NULL || vq->size == 0)
+		return -EINVAL;
+
+	rte_spinlock_lock(&vq->access_lock);
+
+	if (vq->async_registered) {
+		ret = -EBUSY;
+		goto out;
+	}
+
+	node = rte_vhost_get_numa_node(vid);
+	if (node < 0)
+		node = SOCKET_ID_ANY;
+
+	vq->async_pkts = rte_malloc_socket(NULL,
+			vq->size * sizeof(struct rte_mbuf *),
+			RTE_CACHE_LINE_SIZE, node);
+	vq->async_pkts_nr_used = rte_malloc_socket(NULL,
+			vq->size * sizeof(uint16_t),
+			RTE_CACHE_LINE_SIZE, node);
+	vq->async_used = rte_malloc_socket(NULL,
+			vq->size * sizeof(struct vring_used_elem),
+			RTE_CACHE_LINE_SIZE, node);
+	vq->async_iov = rte_malloc_socket(NULL,
+			VHOST_ASYNC_MAX_IOV * sizeof(struct rte_vhost_iovec),
+			RTE_CACHE_LINE_SIZE, node);
+	if (vq->async_pkts == NULL || vq->async_pkts_nr_used == NULL ||
+			vq->async_used == NULL || vq->async_iov == NULL) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) failed to allocate memory for async channel\n",
+			vid);
+		vhost_free_async_mem(vq);
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	vq->async_ops = *ops;
+	vq->async_ctx = ctx;
+	vq->async_threshold = threshold;
+	vq->async_pkts_idx = 0;
+	vq->async_pkts_inflight_n = 0;
+	vq->async_used_idx = 0;
+	vq->async_used_inflight_n = 0;
+	vq->async_registered = true;
+
+out:
+	rte_spinlock_unlock(&vq->access_lock);
+
+	return ret;
+}
+
+int
+rte_vhost_async_channel_unregister(int vid, uint16_t queue_id)
+{
+	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
+	int ret = 0;
+
+	dev = get_device(vid);
+	if (dev == NULL)
+		return -ENODEV;
+
+	if (queue_id >= dev->nr_vring)
+		return -EINVAL;
+
+	vq = dev->virtqueue[queue_id];
+	if (vq == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&vq->access_lock);
+
+	if (!vq->async_registered) {
+		ret = -EINVAL;
+		goto out;
+	}
+
+	if (vq->async_pkts_inflight_n != 0) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) %s: %u packets in flight on queue %d\n",
+			vid, __func__, vq->async_pkts_inflight_n, queue_id);
+		ret = -EBUSY;
+		goto out;
+	}
+
+	vhost_free_async_mem(vq);
+
+out:
+	rte_spinlock_unlock(&vq->access_lock);
+
+	return ret;
+}
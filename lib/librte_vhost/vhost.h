@@ -33,6 +33,7 @@
 
 #ifndef _VHOST_NET_CDEV_H_
 #define _VHOST_NET_CDEV_H_
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <sys/types.h>
@@ -46,8 +47,10 @@
 #include <rte_log.h>
 #include <rte_ether.h>
 #include <rte_rwlock.h>
+#include <rte_spinlock.h>
 
 #include "rte_vhost.h"
+#include "rte_vhost_async.h"
 
 /* Used to indicate that the device is running on a data core */
 #define VIRTIO_DEV_RUNNING 1
@@ -59,6 +62,33 @@
 
 #define BUF_VECTOR_MAX 256
 
+/* Copies handed to the copy engine per async enqueue burst */
+#define VHOST_ASYNC_MAX_IOV (BUF_VECTOR_MAX * 4)
+
+/*
+ * IOTLB cache entry, guest IOVA to vhost virtual address.
+ */
+struct vhost_iotlb_map {
+	uint64_t iova;
+	uint64_t uaddr;
+	uint64_t size;
+	uint8_t perm;
+};
+
+/*
+ * IOTLB cache: entries sorted by IOVA, not overlapping. Readers take no
+ * lock, they retry when the sequence number has changed or is odd, which
+ * it is while an update is in progress. Updates are serialized by the
+ * spinlock.
+ */
+struct vhost_iotlb_cache {
+	volatile uint32_t seq;
+	uint32_t nr;
+	uint32_t max;
+	rte_spinlock_t lock;
+	struct vhost_iotlb_map *maps;
+};
+
 /**
  * Structure contains buffer address, length and descriptor index
  * from vring to do scatter RX.
@@ -82,6 +112,16 @@ struct zcopy_mbuf {
 };
 TAILQ_HEAD(zcopy_mbuf_list, zcopy_mbuf);
 
+/*
+ * Used element of a packed ring, pending write back to the descriptor
+ * ring. 'count' is the number of descriptors the buffer occupied.
+ */
+struct vring_used_elem_packed {
+	uint16_t id;
+	uint32_t len;
+	uint32_t count;
+};
+
 /*
  * Structure contains the info for each batched memory copy.
  */
@@ -96,13 +136,25 @@ struct batch_copy_elem {
  * Structure contains variables relevant to RX/TX virtqueues.
  */
 struct vhost_virtqueue {
-	struct vring_desc	*desc;
-	struct vring_avail	*avail;
-	struct vring_used	*used;
+	union {
+		struct vring_desc	*desc;
+		struct vring_packed_desc *desc_packed;
+	};
+	union {
+		struct vring_avail	*avail;
+		struct vring_packed_desc_event *driver_event;
+	};
+	union {
+		struct vring_used	*used;
+		struct vring_packed_desc_event *device_event;
+	};
 	uint32_t		size;
 
 	uint16_t		last_avail_idx;
 	uint16_t		last_used_idx;
+	/* Wrap counters of a packed ring, unused with a split ring */
+	bool			avail_wrap_counter;
+	bool			used_wrap_counter;
 #define VIRTIO_INVALID_EVENTFD		(-1)
 #define VIRTIO_UNINITIALIZED_EVENTFD	(-2)
 
@@ -126,19 +178,43 @@ struct vhost_virtqueue {
 	struct zcopy_mbuf	*zmbufs;
 	struct zcopy_mbuf_list	zmbuf_list;
 
-	struct vring_used_elem  *shadow_used_ring;
+	union {
+		struct vring_used_elem  *shadow_used_ring;
+		struct vring_used_elem_packed *shadow_used_packed;
+	};
 	uint16_t                shadow_used_idx;
 	struct vhost_vring_addr ring_addrs;
 
 	struct batch_copy_elem	*batch_copy_elems;
 	uint16_t		batch_copy_nb_elems;
 
+	/*
+	 * Async enqueue: packets in flight in the copy engine, the number
+	 * of used ring elements of each and these elements, all in
+	 * submission order.
+	 */
+	bool			async_registered;
+	struct rte_vhost_async_channel_ops async_ops;
+	void			*async_ctx;
+	uint32_t		async_threshold;
+	struct rte_mbuf		**async_pkts;
+	uint16_t		*async_pkts_nr_used;
+	uint16_t		async_pkts_idx;
+	uint16_t		async_pkts_inflight_n;
+	struct vring_used_elem	*async_used;
+	uint16_t		async_used_idx;
+	uint16_t		async_used_inflight_n;
+	struct rte_vhost_iovec	*async_iov;
+
 	rte_rwlock_t	iotlb_lock;
 	rte_rwlock_t	iotlb_pending_lock;
 	struct rte_mempool *iotlb_pool;
-	TAILQ_HEAD(, vhost_iotlb_entry) iotlb_list;
-	int				iotlb_cache_nr;
+	struct vhost_iotlb_cache iotlb_cache;
 	TAILQ_HEAD(, vhost_iotlb_entry) iotlb_pending_list;
+
+	/* Entry of the last IOTLB hit and region of the last GPA hit */
+	uint32_t		iotlb_last;
+	uint32_t		mem_last;
 } __rte_cache_aligned;
 
 /* Old kernels have no such macros defined */
@@ -195,6 +271,36 @@ struct vhost_msg {
  #define VIRTIO_F_VERSION_1 32
 #endif
 
+/* Declare packed ring related bits for older kernels */
+#ifndef VIRTIO_F_RING_PACKED
+
+#define VIRTIO_F_RING_PACKED 34
+
+struct vring_packed_desc {
+	uint64_t addr;
+	uint32_t len;
+	uint16_t id;
+	uint16_t flags;
+};
+
+struct vring_packed_desc_event {
+	uint16_t off_wrap;
+	uint16_t flags;
+};
+#endif
+
+/* Buffers are used in the order they were made available */
+#ifndef VIRTIO_F_IN_ORDER
+ #define VIRTIO_F_IN_ORDER 35
+#endif
+
+#define VRING_DESC_F_AVAIL	(1 << 7)
+#define VRING_DESC_F_USED	(1 << 15)
+
+#define VRING_EVENT_F_ENABLE	0x0
+#define VRING_EVENT_F_DISABLE	0x1
+#define VRING_EVENT_F_DESC	0x2
+
 #define VHOST_USER_F_PROTOCOL_FEATURES	30
 
 /* Features supported by this builtin vhost-user net driver. */
@@ -214,7 +320,9 @@ struct vhost_msg {
 				(1ULL << VIRTIO_NET_F_GUEST_TSO6) | \
 				(1ULL << VIRTIO_RING_F_INDIRECT_DESC) | \
 				(1ULL << VIRTIO_NET_F_MTU) | \
-				(1ULL << VIRTIO_F_IOMMU_PLATFORM))
+				(1ULL << VIRTIO_F_IOMMU_PLATFORM) | \
+				(1ULL << VIRTIO_F_RING_PACKED) | \
+				(1ULL << VIRTIO_F_IN_ORDER))
 
 
 struct guest_page {
@@ -260,6 +368,25 @@ struct virtio_net {
 
 #define VHOST_LOG_PAGE	4096
 
+static __rte_always_inline bool
+vq_is_packed(struct virtio_net *dev)
+{
+	return dev->features & (1ULL << VIRTIO_F_RING_PACKED);
+}
+
+/*
+ * A packed descriptor is available when its AVAIL flag matches the wrap
+ * counter of the driver and its USED flag does not.
+ */
+static __rte_always_inline bool
+desc_is_avail(struct vring_packed_desc *desc, bool wrap_counter)
+{
+	uint16_t flags = *((volatile uint16_t *)&desc->flags);
+
+	return wrap_counter == !!(flags & VRING_DESC_F_AVAIL) &&
+		wrap_counter != !!(flags & VRING_DESC_F_USED);
+}
+
 /*
  * Atomically set a bit in memory.
  */
@@ -367,6 +494,7 @@ void reset_device(struct virtio_net *dev);
 void vhost_destroy_device(int);
 
 int alloc_vring_queue(struct virtio_net *dev, uint32_t vring_idx);
+void vhost_free_async_mem(struct vhost_virtqueue *vq);
 
 void vhost_set_ifname(int, const char *if_name, unsigned int if_len);
 void vhost_enable_dequeue_zero_copy(int vid);
@@ -385,12 +513,61 @@ uint64_t __vhost_iova_to_vva(struct virtio_net *dev, struct vhost_virtqueue *vq,
 int vring_translate(struct virtio_net *dev, struct vhost_virtqueue *vq);
 void vring_invalidate(struct virtio_net *dev, struct vhost_virtqueue *vq);
 
+/*
+ * Guest physical to vhost virtual address, the regions being sorted by
+ * guest physical address. The region of the previous hit is tried first.
+ */
+static __rte_always_inline uint64_t
+vhost_va_from_guest_pa(struct rte_vhost_memory *mem, uint32_t *last,
+			uint64_t gpa, uint64_t *len)
+{
+	struct rte_vhost_mem_region *r;
+	uint32_t n, half, i;
+
+	i = *last;
+	if (likely(i < mem->nregions)) {
+		r = &mem->regions[i];
+		if (gpa - r->guest_phys_addr < r->size)
+			goto found;
+	}
+
+	if (unlikely(mem->nregions == 0))
+		goto miss;
+
+	/* last region starting at or below gpa, without branches */
+	i = 0;
+	n = mem->nregions;
+	while (n > 1) {
+		half = n >> 1;
+		i = mem->regions[i + half].guest_phys_addr <= gpa ?
+			i + half : i;
+		n -= half;
+	}
+
+	r = &mem->regions[i];
+	if (unlikely(gpa - r->guest_phys_addr >= r->size))
+		goto miss;
+	*last = i;
+
+found:
+	if (unlikely(*len > r->guest_phys_addr + r->size - gpa))
+		*len = r->guest_phys_addr + r->size - gpa;
+
+	return gpa - r->guest_phys_addr + r->host_user_addr;
+
+miss:
+	*len = 0;
+
+	return 0;
+}
+
 static __rte_always_inline uint64_t
 vhost_iova_to_vva(struct virtio_net *dev, struct vhost_virtqueue *vq,
 			uint64_t iova, uint64_t *len, uint8_t perm)
 {
 	if (!(dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM)))
-		return rte_vhost_va_from_guest_pa(dev->mem, iova, len);
+		return vhost_va_from_guest_pa(dev->mem, &vq->mem_last,
+					iova, len);
 
 	return __vhost_iova_to_vva(dev, vq, iova, len, perm);
 }
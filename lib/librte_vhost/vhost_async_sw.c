@@ -0,0 +1,251 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <errno.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_memcpy.h>
+#include <rte_pause.h>
+#include <rte_ring.h>
+
+#include "vhost.h"
+
+/* packets with more copies are done by the submitting core */
+#define ASYNC_SW_MAX_SEGS	16
+#define ASYNC_SW_BURST		32
+
+/*
+ * Copies of one packet. The job slots of a channel are used in order, so
+ * that completions are reported in order even when several workers run
+ * the jobs of a channel concurrently.
+ */
+struct async_sw_job {
+	volatile uint32_t done;
+	uint16_t nr_segs;
+	struct rte_vhost_iovec iov[ASYNC_SW_MAX_SEGS];
+} __rte_cache_aligned;
+
+struct rte_vhost_async_sw {
+	struct rte_ring *r;
+	volatile int stop;
+	int socket_id;
+};
+
+/* only used by the core owning the virtqueue */
+struct rte_vhost_async_sw_channel {
+	struct rte_vhost_async_sw *sw;
+	uint32_t mask;
+	uint32_t head;	/* next job slot to submit */
+	uint32_t tail;	/* oldest job slot not reported */
+	struct async_sw_job *jobs;
+};
+
+static inline void
+async_sw_copy(struct async_sw_job *job)
+{
+	uint16_t i;
+
+	for (i = 0; i < job->nr_segs; i++)
+		rte_memcpy(job->iov[i].dst_addr, job->iov[i].src_addr,
+			job->iov[i].len);
+
+	/* copies complete before the job is seen done */
+	rte_smp_wmb();
+	job->done = 1;
+}
+
+static int32_t
+async_sw_transfer_data(void *ctx, const struct rte_vhost_async_desc *descs,
+	uint16_t count)
+{
+	struct rte_vhost_async_sw_channel *ch = ctx;
+	struct async_sw_job *job;
+	void *jobs[ASYNC_SW_BURST];
+	uint32_t nb_free;
+	uint16_t i, n, k;
+
+	nb_free = ch->mask + 1 - (ch->head - ch->tail);
+	count = RTE_MIN(count, nb_free);
+	count = RTE_MIN(count, ASYNC_SW_BURST);
+
+	for (i = 0, n = 0; i < count; i++) {
+		job = &ch->jobs[(ch->head + i) & ch->mask];
+		job->done = 0;
+
+		/* packets fully copied by vhost complete right away */
+		if (descs[i].nr_segs == 0 ||
+				unlikely(descs[i].nr_segs > ASYNC_SW_MAX_SEGS)) {
+			uint16_t j;
+
+			for (j = 0; j < descs[i].nr_segs; j++)
+				rte_memcpy(descs[i].iov[j].dst_addr,
+					descs[i].iov[j].src_addr,
+					descs[i].iov[j].len);
+			job->nr_segs = 0;
+			async_sw_copy(job);
+			continue;
+		}
+
+		rte_memcpy(job->iov, descs[i].iov,
+			descs[i].nr_segs * sizeof(job->iov[0]));
+		job->nr_segs = descs[i].nr_segs;
+		jobs[n++] = job;
+	}
+
+	k = rte_ring_enqueue_burst(ch->sw->r, jobs, n, NULL);
+
+	/* the engine is full, do not wait for it */
+	for (; k < n; k++)
+		async_sw_copy(jobs[k]);
+
+	ch->head += count;
+
+	return count;
+}
+
+static int32_t
+async_sw_check_completed_copies(void *ctx, uint16_t max_packets)
+{
+	struct rte_vhost_async_sw_channel *ch = ctx;
+	uint16_t n = 0;
+
+	while (n < max_packets && ch->tail != ch->head) {
+		if (ch->jobs[ch->tail & ch->mask].done == 0)
+			break;
+		ch->tail++;
+		n++;
+	}
+
+	/* guest buffers are not released before the copies are seen done */
+	rte_smp_rmb();
+
+	return n;
+}
+
+static const struct rte_vhost_async_channel_ops async_sw_ops = {
+	.transfer_data = async_sw_transfer_data,
+	.check_completed_copies = async_sw_check_completed_copies,
+};
+
+const struct rte_vhost_async_channel_ops *
+rte_vhost_async_sw_ops(void)
+{
+	return &async_sw_ops;
+}
+
+int
+rte_vhost_async_sw_worker(void *arg)
+{
+	struct rte_vhost_async_sw *sw = arg;
+	void *jobs[ASYNC_SW_BURST];
+	unsigned int i, n;
+
+	while (1) {
+		n = rte_ring_dequeue_burst(sw->r, jobs, ASYNC_SW_BURST, NULL);
+		if (n == 0) {
+			if (sw->stop)
+				break;
+			rte_pause();
+			continue;
+		}
+
+		for (i = 0; i < n; i++)
+			async_sw_copy(jobs[i]);
+	}
+
+	return 0;
+}
+
+void
+rte_vhost_async_sw_stop(struct rte_vhost_async_sw *sw)
+{
+	sw->stop = 1;
+}
+
+struct rte_vhost_async_sw *
+rte_vhost_async_sw_create(const char *name, unsigned int size, int socket_id)
+{
+	struct rte_vhost_async_sw *sw;
+	char ring_name[RTE_RING_NAMESIZE];
+
+	if (name == NULL || !rte_is_power_of_2(size)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	sw = rte_zmalloc_socket(NULL, sizeof(*sw), RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (sw == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	snprintf(ring_name, sizeof(ring_name), "vhost_sw_%s", name);
+	sw->r = rte_ring_create(ring_name, size, socket_id, RING_F_EXACT_SZ);
+	if (sw->r == NULL) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"failed to create copy engine %s\n", name);
+		rte_free(sw);
+		return NULL;
+	}
+	sw->socket_id = socket_id;
+
+	return sw;
+}
+
+void
+rte_vhost_async_sw_free(struct rte_vhost_async_sw *sw)
+{
+	if (sw == NULL)
+		return;
+
+	rte_ring_free(sw->r);
+	rte_free(sw);
+}
+
+struct rte_vhost_async_sw_channel *
+rte_vhost_async_sw_channel_create(struct rte_vhost_async_sw *sw,
+	uint16_t size)
+{
+	struct rte_vhost_async_sw_channel *ch;
+
+	if (sw == NULL || !rte_is_power_of_2(size)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	ch = rte_zmalloc_socket(NULL, sizeof(*ch), RTE_CACHE_LINE_SIZE,
+		sw->socket_id);
+	if (ch == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	ch->jobs = rte_zmalloc_socket(NULL, size * sizeof(ch->jobs[0]),
+		RTE_CACHE_LINE_SIZE, sw->socket_id);
+	if (ch->jobs == NULL) {
+		rte_free(ch);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	ch->sw = sw;
+	ch->mask = size - 1;
+
+	return ch;
+}
+
+void
+rte_vhost_async_sw_channel_free(struct rte_vhost_async_sw_channel *ch)
+{
+	if (ch == NULL)
+		return;
+
+	rte_free(ch->jobs);
+	rte_free(ch);
+}
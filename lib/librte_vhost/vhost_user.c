@@ -229,7 +229,12 @@ vhost_user_set_vring_num(struct virtio_net *dev,
 		}
 	}
 
-	vq->shadow_used_ring = rte_malloc(NULL,
+	if (vq_is_packed(dev))
+		vq->shadow_used_packed = rte_malloc(NULL, vq->size *
+				sizeof(struct vring_used_elem_packed),
+				RTE_CACHE_LINE_SIZE);
+	else
+		vq->shadow_used_ring = rte_malloc(NULL,
 				vq->size * sizeof(struct vring_used_elem),
 				RTE_CACHE_LINE_SIZE);
 	if (!vq->shadow_used_ring) {
@@ -377,6 +382,91 @@ ring_addr_to_vva(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	return qva_to_vva(dev, ra, size);
 }
 
+/*
+ * Converts QEMU virtual address to guest physical address, for the dirty
+ * log of the packed descriptor ring. Returns 0 if not found.
+ */
+static uint64_t
+qva_to_gpa(struct virtio_net *dev, uint64_t qva)
+{
+	struct rte_vhost_mem_region *r;
+	uint32_t i;
+
+	for (i = 0; i < dev->mem->nregions; i++) {
+		r = &dev->mem->regions[i];
+
+		if (qva >= r->guest_user_addr &&
+		    qva <  r->guest_user_addr + r->size)
+			return qva - r->guest_user_addr + r->guest_phys_addr;
+	}
+
+	return 0;
+}
+
+static struct virtio_net *
+translate_ring_addresses_packed(struct virtio_net *dev, int vq_index)
+{
+	struct vhost_virtqueue *vq = dev->virtqueue[vq_index];
+	struct vhost_vring_addr *addr = &vq->ring_addrs;
+	uint64_t len;
+
+	len = sizeof(struct vring_packed_desc) * vq->size;
+	vq->desc_packed = (struct vring_packed_desc *)(uintptr_t)
+		ring_addr_to_vva(dev, vq, addr->desc_user_addr, &len);
+	if (vq->desc_packed == NULL ||
+			len != sizeof(struct vring_packed_desc) * vq->size) {
+		RTE_LOG(DEBUG, VHOST_CONFIG,
+			"(%d) failed to map desc_packed ring.\n",
+			dev->vid);
+		return dev;
+	}
+
+	dev = numa_realloc(dev, vq_index);
+	vq = dev->virtqueue[vq_index];
+	addr = &vq->ring_addrs;
+
+	len = sizeof(struct vring_packed_desc_event);
+	vq->driver_event = (struct vring_packed_desc_event *)(uintptr_t)
+		ring_addr_to_vva(dev, vq, addr->avail_user_addr, &len);
+	if (vq->driver_event == NULL ||
+			len != sizeof(struct vring_packed_desc_event)) {
+		RTE_LOG(DEBUG, VHOST_CONFIG,
+			"(%d) failed to find driver area address.\n",
+			dev->vid);
+		return dev;
+	}
+
+	len = sizeof(struct vring_packed_desc_event);
+	vq->device_event = (struct vring_packed_desc_event *)(uintptr_t)
+		ring_addr_to_vva(dev, vq, addr->used_user_addr, &len);
+	if (vq->device_event == NULL ||
+			len != sizeof(struct vring_packed_desc_event)) {
+		RTE_LOG(DEBUG, VHOST_CONFIG,
+			"(%d) failed to find device area address.\n",
+			dev->vid);
+		return dev;
+	}
+
+	/*
+	 * Used descriptors are written back to the descriptor ring, this is
+	 * the area to log. With an IOMMU the ring address is an IOVA, which
+	 * the guest maps 1:1 for the rings it gives to a vhost backend.
+	 */
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vq->log_guest_addr = addr->desc_user_addr;
+	else
+		vq->log_guest_addr = qva_to_gpa(dev, addr->desc_user_addr);
+
+	LOG_DEBUG(VHOST_CONFIG, "(%d) mapped address desc_packed: %p\n",
+			dev->vid, vq->desc_packed);
+	LOG_DEBUG(VHOST_CONFIG, "(%d) mapped address driver_event: %p\n",
+			dev->vid, vq->driver_event);
+	LOG_DEBUG(VHOST_CONFIG, "(%d) mapped address device_event: %p\n",
+			dev->vid, vq->device_event);
+
+	return dev;
+}
+
 static struct virtio_net *
 translate_ring_addresses(struct virtio_net *dev, int vq_index)
 {
@@ -388,6 +478,9 @@ translate_ring_addresses(struct virtio_net *dev, int vq_index)
 	if (vq->desc && vq->avail && vq->used)
 		return dev;
 
+	if (vq_is_packed(dev))
+		return translate_ring_addresses_packed(dev, vq_index);
+
 	len = sizeof(struct vring_desc) * vq->size;
 	vq->desc = (struct vring_desc *)(uintptr_t)ring_addr_to_vva(dev,
 			vq, addr->desc_user_addr, &len);
@@ -493,10 +586,21 @@ static int
 vhost_user_set_vring_base(struct virtio_net *dev,
 			  VhostUserMsg *msg)
 {
-	dev->virtqueue[msg->payload.state.index]->last_used_idx  =
-			msg->payload.state.num;
-	dev->virtqueue[msg->payload.state.index]->last_avail_idx =
-			msg->payload.state.num;
+	struct vhost_virtqueue *vq = dev->virtqueue[msg->payload.state.index];
+
+	/*
+	 * For a packed ring, bit 15 of the base carries the wrap counter of
+	 * the driver, the used side resumes from the same point.
+	 */
+	if (vq_is_packed(dev)) {
+		vq->last_used_idx = msg->payload.state.num & 0x7fff;
+		vq->last_avail_idx = vq->last_used_idx;
+		vq->avail_wrap_counter = !!(msg->payload.state.num & 0x8000);
+		vq->used_wrap_counter = vq->avail_wrap_counter;
+	} else {
+		vq->last_used_idx  = msg->payload.state.num;
+		vq->last_avail_idx = msg->payload.state.num;
+	}
 
 	return 0;
 }
@@ -607,11 +711,21 @@ vhost_memory_changed(struct VhostUserMemory *new,
 	if (new->nregions != old->nregions)
 		return true;
 
+	/* the regions in use are sorted, not the ones of the message */
 	for (i = 0; i < new->nregions; ++i) {
 		VhostUserMemoryRegion *new_r = &new->regions[i];
-		struct rte_vhost_mem_region *old_r = &old->regions[i];
+		struct rte_vhost_mem_region *old_r = NULL;
+		uint32_t j;
+
+		for (j = 0; j < old->nregions; j++) {
+			if (new_r->guest_phys_addr ==
+					old->regions[j].guest_phys_addr) {
+				old_r = &old->regions[j];
+				break;
+			}
+		}
 
-		if (new_r->guest_phys_addr != old_r->guest_phys_addr)
+		if (old_r == NULL)
 			return true;
 		if (new_r->memory_size != old_r->size)
 			return true;
@@ -622,6 +736,18 @@ vhost_memory_changed(struct VhostUserMemory *new,
 	return false;
 }
 
+static int
+mem_region_cmp(const void *a, const void *b)
+{
+	const struct rte_vhost_mem_region *ra = a;
+	const struct rte_vhost_mem_region *rb = b;
+
+	if (ra->guest_phys_addr < rb->guest_phys_addr)
+		return -1;
+
+	return ra->guest_phys_addr > rb->guest_phys_addr;
+}
+
 static int
 vhost_user_set_mem_table(struct virtio_net *dev, struct VhostUserMsg *pmsg)
 {
@@ -743,6 +869,10 @@ vhost_user_set_mem_table(struct virtio_net *dev, struct VhostUserMsg *pmsg)
 			mmap_offset);
 	}
 
+	/* guest physical addresses are then looked up by binary search */
+	qsort(dev->mem->regions, dev->mem->nregions,
+		sizeof(dev->mem->regions[0]), mem_region_cmp);
+
 	dump_guest_pages(dev);
 
 	return 0;
@@ -875,7 +1005,11 @@ vhost_user_get_vring_base(struct virtio_net *dev,
 	dev->flags &= ~VIRTIO_DEV_READY;
 
 	/* Here we are safe to get the last avail index */
-	msg->payload.state.num = vq->last_avail_idx;
+	if (vq_is_packed(dev))
+		msg->payload.state.num = vq->last_avail_idx |
+			(vq->avail_wrap_counter << 15);
+	else
+		msg->payload.state.num = vq->last_avail_idx;
 
 	RTE_LOG(INFO, VHOST_CONFIG,
 		"vring base idx:%d file:%d\n", msg->payload.state.index,
@@ -903,6 +1037,8 @@ vhost_user_get_vring_base(struct virtio_net *dev,
 	rte_free(vq->batch_copy_elems);
 	vq->batch_copy_elems = NULL;
 
+	vhost_free_async_mem(vq);
+
 	return 0;
 }
 
@@ -60,16 +60,15 @@ is_valid_virt_queue_idx(uint32_t idx, int is_tx, uint32_t nr_vring)
 	return (is_tx ^ (idx & 1)) == 0 && idx < nr_vring;
 }
 
-static __rte_always_inline struct vring_desc *
+static __rte_always_inline void *
 alloc_copy_ind_table(struct virtio_net *dev, struct vhost_virtqueue *vq,
-					 struct vring_desc *desc)
+		     uint64_t desc_addr, uint64_t desc_len)
 {
-	struct vring_desc *idesc;
+	void *idesc;
 	uint64_t src, dst;
-	uint64_t len, remain = desc->len;
-	uint64_t desc_addr = desc->addr;
+	uint64_t len, remain = desc_len;
 
-	idesc = rte_malloc(__func__, desc->len, 0);
+	idesc = rte_malloc(__func__, desc_len, 0);
 	if (unlikely(!idesc))
 		return 0;
 
@@ -95,7 +94,7 @@ alloc_copy_ind_table(struct virtio_net *dev, struct vhost_virtqueue *vq,
 }
 
 static __rte_always_inline void
-free_ind_table(struct vring_desc *idesc)
+free_ind_table(void *idesc)
 {
 	rte_free(idesc);
 }
@@ -150,6 +149,254 @@ update_shadow_used_ring(struct vhost_virtqueue *vq,
 	vq->shadow_used_ring[i].len = len;
 }
 
+static __rte_always_inline void
+update_shadow_used_ring_packed(struct vhost_virtqueue *vq,
+			 uint16_t buf_id, uint32_t len, uint16_t count)
+{
+	uint16_t i = vq->shadow_used_idx++;
+
+	vq->shadow_used_packed[i].id  = buf_id;
+	vq->shadow_used_packed[i].len = len;
+	vq->shadow_used_packed[i].count = count;
+}
+
+/*
+ * With in-order, a single used descriptor carrying the id of the last
+ * buffer tells the driver the whole batch was used: merge the buffers into
+ * the pending element instead of writing one descriptor each.
+ */
+static __rte_always_inline void
+update_shadow_used_ring_packed_inorder(struct vhost_virtqueue *vq,
+			 uint16_t buf_id, uint16_t count)
+{
+	uint16_t i;
+
+	if (vq->shadow_used_idx == 0) {
+		update_shadow_used_ring_packed(vq, buf_id, 0, count);
+		return;
+	}
+
+	i = vq->shadow_used_idx - 1;
+	vq->shadow_used_packed[i].id = buf_id;
+	vq->shadow_used_packed[i].count += count;
+}
+
+static __rte_always_inline void
+vhost_log_used_desc_packed(struct virtio_net *dev,
+			   struct vhost_virtqueue *vq, uint16_t idx)
+{
+	vhost_log_used_vring(dev, vq, idx * sizeof(struct vring_packed_desc),
+			sizeof(struct vring_packed_desc));
+}
+
+/*
+ * Write the used descriptors back to the ring. The flags are what hands a
+ * descriptor over to the driver, so they are written once ids and lengths
+ * are visible, the head one last so that the driver never sees a partial
+ * batch.
+ */
+static __rte_always_inline void
+flush_shadow_used_ring_packed(struct virtio_net *dev,
+			      struct vhost_virtqueue *vq)
+{
+	struct vring_packed_desc *descs = vq->desc_packed;
+	uint16_t used_idx = vq->last_used_idx;
+	uint16_t head_idx = vq->last_used_idx;
+	uint16_t head_flags = 0;
+	uint16_t flags;
+	int i;
+
+	for (i = 0; i < vq->shadow_used_idx; i++) {
+		descs[used_idx].id = vq->shadow_used_packed[i].id;
+		descs[used_idx].len = vq->shadow_used_packed[i].len;
+
+		used_idx += vq->shadow_used_packed[i].count;
+		if (used_idx >= vq->size)
+			used_idx -= vq->size;
+	}
+
+	rte_smp_wmb();
+
+	for (i = 0; i < vq->shadow_used_idx; i++) {
+		used_idx = vq->last_used_idx;
+
+		if (vq->used_wrap_counter)
+			flags = VRING_DESC_F_AVAIL | VRING_DESC_F_USED;
+		else
+			flags = 0;
+
+		if (i > 0) {
+			descs[used_idx].flags = flags;
+			vhost_log_used_desc_packed(dev, vq, used_idx);
+		} else {
+			head_idx = used_idx;
+			head_flags = flags;
+		}
+
+		vq->last_used_idx += vq->shadow_used_packed[i].count;
+		if (vq->last_used_idx >= vq->size) {
+			vq->last_used_idx -= vq->size;
+			vq->used_wrap_counter ^= 1;
+		}
+	}
+
+	rte_smp_wmb();
+
+	descs[head_idx].flags = head_flags;
+	vhost_log_used_desc_packed(dev, vq, head_idx);
+
+	vq->shadow_used_idx = 0;
+}
+
+/*
+ * Notify the driver of a packed ring, following its event suppression
+ * structure. 'old' is the used index before the last flush.
+ */
+static __rte_always_inline void
+vhost_vring_call_packed(struct vhost_virtqueue *vq, uint16_t old)
+{
+	uint16_t new = vq->last_used_idx;
+	uint16_t flags, off_wrap, off;
+
+	/* flush the used descriptors before we read the driver event. */
+	rte_mb();
+
+	if (vq->callfd < 0)
+		return;
+
+	flags = *(volatile uint16_t *)&vq->driver_event->flags;
+	if (flags == VRING_EVENT_F_DISABLE)
+		return;
+
+	if (flags == VRING_EVENT_F_DESC) {
+		off_wrap = *(volatile uint16_t *)&vq->driver_event->off_wrap;
+		off = off_wrap & ~(1 << 15);
+
+		/* bring both ends back to the same lap of the ring */
+		if (new <= old)
+			old -= vq->size;
+		if (vq->used_wrap_counter != off_wrap >> 15)
+			off -= vq->size;
+
+		if ((uint16_t)(new - off - 1) >= (uint16_t)(new - old))
+			return;
+	}
+
+	eventfd_write(vq->callfd, (eventfd_t)1);
+}
+
+static __rte_always_inline int
+fill_vec_buf_packed_indirect(struct virtio_net *dev,
+			struct vhost_virtqueue *vq,
+			struct vring_packed_desc *desc, uint32_t *vec_idx,
+			struct buf_vector *buf_vec, uint32_t *len)
+{
+	struct vring_packed_desc *descs, *idescs = NULL;
+	uint32_t vec_id = *vec_idx;
+	uint64_t dlen = desc->len;
+	uint16_t i, nr_descs;
+
+	nr_descs = desc->len / sizeof(struct vring_packed_desc);
+	if (unlikely(nr_descs == 0 || nr_descs > vq->size))
+		return -1;
+
+	descs = (struct vring_packed_desc *)(uintptr_t)
+		vhost_iova_to_vva(dev, vq, desc->addr, &dlen,
+				VHOST_ACCESS_RO);
+	if (unlikely(!descs))
+		return -1;
+
+	if (unlikely(dlen < desc->len)) {
+		/*
+		 * The indirect desc table is not contiguous
+		 * in process VA space, we have to copy it.
+		 */
+		idescs = alloc_copy_ind_table(dev, vq, desc->addr, desc->len);
+		if (unlikely(!idescs))
+			return -1;
+
+		descs = idescs;
+	}
+
+	for (i = 0; i < nr_descs; i++) {
+		if (unlikely(vec_id >= BUF_VECTOR_MAX)) {
+			free_ind_table(idescs);
+			return -1;
+		}
+
+		*len += descs[i].len;
+		buf_vec[vec_id].buf_addr = descs[i].addr;
+		buf_vec[vec_id].buf_len  = descs[i].len;
+		buf_vec[vec_id].desc_idx = i;
+		vec_id++;
+	}
+
+	*vec_idx = vec_id;
+
+	if (unlikely(!!idescs))
+		free_ind_table(idescs);
+
+	return 0;
+}
+
+/*
+ * Gather the buffer starting at descriptor 'avail_idx' of a packed ring.
+ * Its descriptors follow each other in the ring, the last one carries the
+ * buffer id.
+ */
+static __rte_always_inline int
+fill_vec_buf_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
+			uint16_t avail_idx, bool wrap_counter,
+			uint16_t *desc_count, struct buf_vector *buf_vec,
+			uint32_t *vec_idx, uint16_t *buf_id, uint32_t *len)
+{
+	struct vring_packed_desc *descs = vq->desc_packed;
+	uint32_t vec_id = *vec_idx;
+	uint16_t flags;
+
+	if (!desc_is_avail(&descs[avail_idx], wrap_counter))
+		return -1;
+
+	/* read the descriptor content after its flags */
+	rte_smp_rmb();
+
+	*desc_count = 0;
+	*len = 0;
+
+	while (1) {
+		if (unlikely(vec_id >= BUF_VECTOR_MAX ||
+			     *desc_count >= vq->size))
+			return -1;
+
+		*desc_count += 1;
+		*buf_id = descs[avail_idx].id;
+		flags = descs[avail_idx].flags;
+
+		if (flags & VRING_DESC_F_INDIRECT) {
+			if (unlikely(fill_vec_buf_packed_indirect(dev, vq,
+					&descs[avail_idx], &vec_id,
+					buf_vec, len) < 0))
+				return -1;
+		} else {
+			*len += descs[avail_idx].len;
+			buf_vec[vec_id].buf_addr = descs[avail_idx].addr;
+			buf_vec[vec_id].buf_len  = descs[avail_idx].len;
+			buf_vec[vec_id].desc_idx = avail_idx;
+			vec_id++;
+		}
+
+		if ((flags & VRING_DESC_F_NEXT) == 0)
+			break;
+
+		if (++avail_idx >= vq->size)
+			avail_idx -= vq->size;
+	}
+
+	*vec_idx = vec_id;
+
+	return 0;
+}
+
 static inline void
 do_data_copy_enqueue(struct virtio_net *dev, struct vhost_virtqueue *vq)
 {
@@ -496,7 +743,8 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 				 * in process VA space, we have to copy it.
 				 */
 				idesc = alloc_copy_ind_table(dev, vq,
-							&vq->desc[desc_idx]);
+						vq->desc[desc_idx].addr,
+						vq->desc[desc_idx].len);
 				if (unlikely(!idesc))
 					break;
 
@@ -580,7 +828,8 @@ fill_vec_buf(struct virtio_net *dev, struct vhost_virtqueue *vq,
 			 * The indirect desc table is not contiguous
 			 * in process VA space, we have to copy it.
 			 */
-			idesc = alloc_copy_ind_table(dev, vq, &vq->desc[idx]);
+			idesc = alloc_copy_ind_table(dev, vq,
+					vq->desc[idx].addr, vq->desc[idx].len);
 			if (unlikely(!idesc))
 				return -1;
 
@@ -662,10 +911,16 @@ reserve_avail_buf_mergeable(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	return 0;
 }
 
+/*
+ * With a non NULL iov, the copies of at least vq->async_threshold bytes
+ * are not done but added to iov, up to max_segs of them, for the async
+ * copy engine.
+ */
 static __rte_always_inline int
 copy_mbuf_to_desc_mergeable(struct virtio_net *dev, struct vhost_virtqueue *vq,
 			    struct rte_mbuf *m, struct buf_vector *buf_vec,
-			    uint16_t num_buffers)
+			    uint16_t num_buffers, struct rte_vhost_iovec *iov,
+			    uint16_t max_segs, uint16_t *nr_segs)
 {
 	uint32_t vec_idx = 0;
 	uint64_t desc_addr, desc_gaddr;
@@ -815,7 +1070,16 @@ copy_mbuf_to_desc_mergeable(struct virtio_net *dev, struct vhost_virtqueue *vq,
 
 		cpy_len = RTE_MIN(desc_chunck_len, mbuf_avail);
 
-		if (likely(cpy_len > MAX_BATCH_LEN || copy_nb >= vq->size)) {
+		if (iov != NULL && cpy_len >= vq->async_threshold &&
+				*nr_segs < max_segs) {
+			iov[*nr_segs].dst_addr =
+				(void *)((uintptr_t)(desc_addr + desc_offset));
+			iov[*nr_segs].src_addr =
+				rte_pktmbuf_mtod_offset(m, void *, mbuf_offset);
+			iov[*nr_segs].len = cpy_len;
+			(*nr_segs)++;
+		} else if (likely(cpy_len > MAX_BATCH_LEN ||
+					copy_nb >= vq->size)) {
 			rte_memcpy((void *)((uintptr_t)(desc_addr +
 							desc_offset)),
 				rte_pktmbuf_mtod_offset(m, void *, mbuf_offset),
@@ -905,7 +1169,8 @@ virtio_dev_merge_rx(struct virtio_net *dev, uint16_t queue_id,
 			vq->last_avail_idx + num_buffers);
 
 		if (copy_mbuf_to_desc_mergeable(dev, vq, pkts[pkt_idx],
-						buf_vec, num_buffers) < 0) {
+						buf_vec, num_buffers,
+						NULL, 0, NULL) < 0) {
 			vq->shadow_used_idx -= num_buffers;
 			break;
 		}
@@ -937,6 +1202,154 @@ virtio_dev_merge_rx(struct virtio_net *dev, uint16_t queue_id,
 	return pkt_idx;
 }
 
+/*
+ * Returns -1 on fail, 0 on success. Without mergeable buffers the packet
+ * has to fit in a single buffer.
+ */
+static inline int
+reserve_avail_buf_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
+				uint32_t size, struct buf_vector *buf_vec,
+				uint16_t *num_buffers, uint16_t *nr_descs)
+{
+	uint16_t avail_idx = vq->last_avail_idx;
+	bool wrap_counter = vq->avail_wrap_counter;
+	uint16_t max_tries, tries = 0;
+	uint16_t buf_id = 0;
+	uint16_t desc_count;
+	uint32_t vec_idx = 0;
+	uint32_t len = 0;
+
+	*num_buffers = 0;
+	*nr_descs = 0;
+
+	if (dev->features & (1ULL << VIRTIO_NET_F_MRG_RXBUF))
+		max_tries = vq->size;
+	else
+		max_tries = 1;
+
+	while (size > 0) {
+		/*
+		 * if we tried all available ring items, and still
+		 * can't get enough buf, it means something abnormal
+		 * happened.
+		 */
+		if (unlikely(tries >= max_tries))
+			return -1;
+
+		if (unlikely(fill_vec_buf_packed(dev, vq, avail_idx,
+						wrap_counter, &desc_count,
+						buf_vec, &vec_idx, &buf_id,
+						&len) < 0))
+			return -1;
+
+		len = RTE_MIN(len, size);
+		update_shadow_used_ring_packed(vq, buf_id, len, desc_count);
+		size -= len;
+
+		avail_idx += desc_count;
+		if (avail_idx >= vq->size) {
+			avail_idx -= vq->size;
+			wrap_counter ^= 1;
+		}
+
+		*nr_descs += desc_count;
+		tries++;
+		*num_buffers += 1;
+	}
+
+	return 0;
+}
+
+static __rte_always_inline uint32_t
+virtio_dev_rx_packed(struct virtio_net *dev, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint32_t count)
+{
+	struct vhost_virtqueue *vq;
+	uint32_t pkt_idx = 0;
+	uint16_t num_buffers, nr_descs;
+	struct buf_vector buf_vec[BUF_VECTOR_MAX];
+	uint16_t used_idx;
+
+	LOG_DEBUG(VHOST_DATA, "(%d) %s\n", dev->vid, __func__);
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, 0, dev->nr_vring))) {
+		RTE_LOG(ERR, VHOST_DATA, "(%d) %s: invalid virtqueue idx %d.\n",
+			dev->vid, __func__, queue_id);
+		return 0;
+	}
+
+	vq = dev->virtqueue[queue_id];
+
+	rte_spinlock_lock(&vq->access_lock);
+
+	if (unlikely(vq->enabled == 0))
+		goto out_access_unlock;
+
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_lock(vq);
+
+	if (unlikely(vq->access_ok == 0))
+		if (unlikely(vring_translate(dev, vq) < 0))
+			goto out;
+
+	count = RTE_MIN((uint32_t)MAX_PKT_BURST, count);
+	if (count == 0)
+		goto out;
+
+	vq->batch_copy_nb_elems = 0;
+
+	rte_prefetch0(&vq->desc_packed[vq->last_avail_idx]);
+
+	vq->shadow_used_idx = 0;
+	used_idx = vq->last_used_idx;
+	for (pkt_idx = 0; pkt_idx < count; pkt_idx++) {
+		uint32_t pkt_len = pkts[pkt_idx]->pkt_len + dev->vhost_hlen;
+
+		if (unlikely(reserve_avail_buf_packed(dev, vq, pkt_len,
+						buf_vec, &num_buffers,
+						&nr_descs) < 0)) {
+			LOG_DEBUG(VHOST_DATA,
+				"(%d) failed to get enough desc from vring\n",
+				dev->vid);
+			vq->shadow_used_idx -= num_buffers;
+			break;
+		}
+
+		LOG_DEBUG(VHOST_DATA, "(%d) current index %d | end index %d\n",
+			dev->vid, vq->last_avail_idx,
+			vq->last_avail_idx + nr_descs);
+
+		/* virtio 1 always has num_buffers in the header */
+		if (copy_mbuf_to_desc_mergeable(dev, vq, pkts[pkt_idx],
+						buf_vec, num_buffers,
+						NULL, 0, NULL) < 0) {
+			vq->shadow_used_idx -= num_buffers;
+			break;
+		}
+
+		vq->last_avail_idx += nr_descs;
+		if (vq->last_avail_idx >= vq->size) {
+			vq->last_avail_idx -= vq->size;
+			vq->avail_wrap_counter ^= 1;
+		}
+	}
+
+	do_data_copy_enqueue(dev, vq);
+
+	if (likely(vq->shadow_used_idx)) {
+		flush_shadow_used_ring_packed(dev, vq);
+		vhost_vring_call_packed(vq, used_idx);
+	}
+
+out:
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_unlock(vq);
+
+out_access_unlock:
+	rte_spinlock_unlock(&vq->access_lock);
+
+	return pkt_idx;
+}
+
 uint16_t
 rte_vhost_enqueue_burst(int vid, uint16_t queue_id,
 	struct rte_mbuf **pkts, uint16_t count)
@@ -946,12 +1359,250 @@ rte_vhost_enqueue_burst(int vid, uint16_t queue_id,
 	if (!dev)
 		return 0;
 
-	if (dev->features & (1 << VIRTIO_NET_F_MRG_RXBUF))
+	if (unlikely(queue_id < dev->nr_vring &&
+			dev->virtqueue[queue_id]->async_registered)) {
+		RTE_LOG(ERR, VHOST_DATA,
+			"(%d) %s: async channel registered on queue %d.\n",
+			dev->vid, __func__, queue_id);
+		return 0;
+	}
+
+	if (vq_is_packed(dev))
+		return virtio_dev_rx_packed(dev, queue_id, pkts, count);
+	else if (dev->features & (1 << VIRTIO_NET_F_MRG_RXBUF))
 		return virtio_dev_merge_rx(dev, queue_id, pkts, count);
 	else
 		return virtio_dev_rx(dev, queue_id, pkts, count);
 }
 
+/*
+ * Same as virtio_dev_merge_rx(), except that the large copies are handed
+ * to the copy engine and the used ring elements are kept aside until
+ * they are done.
+ */
+static __rte_always_inline uint32_t
+virtio_dev_rx_async_submit(struct virtio_net *dev, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint32_t count)
+{
+	struct vhost_virtqueue *vq;
+	uint32_t pkt_idx = 0, n_submitted = 0;
+	uint16_t num_buffers;
+	struct buf_vector buf_vec[BUF_VECTOR_MAX];
+	struct rte_vhost_async_desc descs[MAX_PKT_BURST];
+	uint16_t nr_used[MAX_PKT_BURST];
+	uint16_t avail_head, iov_idx, nr_segs, max_segs, slot, mask, i;
+	int32_t n;
+
+	LOG_DEBUG(VHOST_DATA, "(%d) %s\n", dev->vid, __func__);
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, 0, dev->nr_vring))) {
+		RTE_LOG(ERR, VHOST_DATA, "(%d) %s: invalid virtqueue idx %d.\n",
+			dev->vid, __func__, queue_id);
+		return 0;
+	}
+
+	vq = dev->virtqueue[queue_id];
+
+	rte_spinlock_lock(&vq->access_lock);
+
+	if (unlikely(vq->enabled == 0 || !vq->async_registered))
+		goto out_access_unlock;
+
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_lock(vq);
+
+	if (unlikely(vq->access_ok == 0))
+		if (unlikely(vring_translate(dev, vq) < 0))
+			goto out;
+
+	count = RTE_MIN((uint32_t)MAX_PKT_BURST, count);
+	count = RTE_MIN((uint32_t)(vq->size - vq->async_pkts_inflight_n),
+			count);
+	if (count == 0)
+		goto out;
+
+	vq->batch_copy_nb_elems = 0;
+
+	rte_prefetch0(&vq->avail->ring[vq->last_avail_idx & (vq->size - 1)]);
+
+	vq->shadow_used_idx = 0;
+	iov_idx = 0;
+	avail_head = *((volatile uint16_t *)&vq->avail->idx);
+	for (pkt_idx = 0; pkt_idx < count; pkt_idx++) {
+		uint32_t pkt_len = pkts[pkt_idx]->pkt_len + dev->vhost_hlen;
+
+		if (unlikely(reserve_avail_buf_mergeable(dev, vq,
+						pkt_len, buf_vec, &num_buffers,
+						avail_head) < 0 ||
+				(num_buffers > 1 && !(dev->features &
+					(1ULL << VIRTIO_NET_F_MRG_RXBUF))))) {
+			LOG_DEBUG(VHOST_DATA,
+				"(%d) failed to get enough desc from vring\n",
+				dev->vid);
+			vq->shadow_used_idx -= num_buffers;
+			break;
+		}
+
+		/*
+		 * Copies are only seen by the dirty log when done by the
+		 * CPU, so the engine is bypassed during live migration.
+		 */
+		if (unlikely(dev->features & (1ULL << VHOST_F_LOG_ALL)))
+			max_segs = 0;
+		else
+			max_segs = VHOST_ASYNC_MAX_IOV - iov_idx;
+
+		nr_segs = 0;
+		if (copy_mbuf_to_desc_mergeable(dev, vq, pkts[pkt_idx],
+						buf_vec, num_buffers,
+						&vq->async_iov[iov_idx],
+						max_segs, &nr_segs) < 0) {
+			vq->shadow_used_idx -= num_buffers;
+			break;
+		}
+
+		descs[pkt_idx].iov = &vq->async_iov[iov_idx];
+		descs[pkt_idx].nr_segs = nr_segs;
+		iov_idx += nr_segs;
+		nr_used[pkt_idx] = num_buffers;
+		vq->last_avail_idx += num_buffers;
+	}
+
+	do_data_copy_enqueue(dev, vq);
+
+	if (unlikely(pkt_idx == 0))
+		goto out;
+
+	n = vq->async_ops.transfer_data(vq->async_ctx, descs, pkt_idx);
+	if (unlikely(n < 0)) {
+		RTE_LOG(ERR, VHOST_DATA, "(%d) %s: copy engine error %d\n",
+			dev->vid, __func__, n);
+		n = 0;
+	}
+	n_submitted = RTE_MIN((uint32_t)n, pkt_idx);
+
+	/* give back the buffers of the packets the engine did not take */
+	for (i = n_submitted; i < pkt_idx; i++) {
+		vq->last_avail_idx -= nr_used[i];
+		vq->shadow_used_idx -= nr_used[i];
+	}
+
+	mask = vq->size - 1;
+	slot = vq->async_pkts_idx + vq->async_pkts_inflight_n;
+	for (i = 0; i < n_submitted; i++, slot++) {
+		vq->async_pkts[slot & mask] = pkts[i];
+		vq->async_pkts_nr_used[slot & mask] = nr_used[i];
+	}
+	vq->async_pkts_inflight_n += n_submitted;
+
+	slot = vq->async_used_idx + vq->async_used_inflight_n;
+	for (i = 0; i < vq->shadow_used_idx; i++, slot++)
+		vq->async_used[slot & mask] = vq->shadow_used_ring[i];
+	vq->async_used_inflight_n += vq->shadow_used_idx;
+	vq->shadow_used_idx = 0;
+
+out:
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_unlock(vq);
+
+out_access_unlock:
+	rte_spinlock_unlock(&vq->access_lock);
+
+	return n_submitted;
+}
+
+uint16_t
+rte_vhost_submit_enqueue_burst(int vid, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint16_t count)
+{
+	struct virtio_net *dev = get_device(vid);
+
+	if (!dev)
+		return 0;
+
+	return virtio_dev_rx_async_submit(dev, queue_id, pkts, count);
+}
+
+uint16_t
+rte_vhost_poll_enqueue_completed(int vid, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint16_t count)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+	uint16_t mask, nr_used, slot, i;
+	int32_t n = 0;
+
+	if (!dev)
+		return 0;
+
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, 0, dev->nr_vring))) {
+		RTE_LOG(ERR, VHOST_DATA, "(%d) %s: invalid virtqueue idx %d.\n",
+			dev->vid, __func__, queue_id);
+		return 0;
+	}
+
+	vq = dev->virtqueue[queue_id];
+
+	rte_spinlock_lock(&vq->access_lock);
+
+	if (unlikely(!vq->async_registered || vq->async_pkts_inflight_n == 0))
+		goto out_access_unlock;
+
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_lock(vq);
+
+	if (unlikely(vq->access_ok == 0))
+		if (unlikely(vring_translate(dev, vq) < 0))
+			goto out;
+
+	count = RTE_MIN(count, vq->async_pkts_inflight_n);
+	n = vq->async_ops.check_completed_copies(vq->async_ctx, count);
+	if (unlikely(n <= 0)) {
+		if (n < 0)
+			RTE_LOG(ERR, VHOST_DATA,
+				"(%d) %s: copy engine error %d\n",
+				dev->vid, __func__, n);
+		n = 0;
+		goto out;
+	}
+	n = RTE_MIN(n, (int32_t)count);
+
+	mask = vq->size - 1;
+	nr_used = 0;
+	for (i = 0, slot = vq->async_pkts_idx; i < n; i++, slot++) {
+		pkts[i] = vq->async_pkts[slot & mask];
+		nr_used += vq->async_pkts_nr_used[slot & mask];
+	}
+	vq->async_pkts_idx += n;
+	vq->async_pkts_inflight_n -= n;
+
+	/* the used elements of the packets are released in order */
+	for (i = 0, slot = vq->async_used_idx; i < nr_used; i++, slot++)
+		vq->shadow_used_ring[i] = vq->async_used[slot & mask];
+	vq->async_used_idx += nr_used;
+	vq->async_used_inflight_n -= nr_used;
+	vq->shadow_used_idx = nr_used;
+
+	flush_shadow_used_ring(dev, vq);
+	vq->shadow_used_idx = 0;
+
+	/* flush used->idx update before we read avail->flags. */
+	rte_mb();
+
+	/* Kick the guest if necessary. */
+	if (!(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT)
+			&& (vq->callfd >= 0))
+		eventfd_write(vq->callfd, (eventfd_t)1);
+
+out:
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_unlock(vq);
+
+out_access_unlock:
+	rte_spinlock_unlock(&vq->access_lock);
+
+	return n;
+}
+
 static inline bool
 virtio_net_with_host_offload(struct virtio_net *dev)
 {
@@ -1468,6 +2119,230 @@ restore_mbuf(struct rte_mbuf *m)
 	}
 }
 
+/*
+ * Copy a buffer gathered in buf_vec to the mbuf chain, the packed ring
+ * counterpart of copy_desc_to_mbuf(), without zero copy.
+ */
+static __rte_always_inline int
+copy_vec_to_mbuf(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		 struct buf_vector *buf_vec, uint32_t nr_vec,
+		 struct rte_mbuf *m, struct rte_mempool *mbuf_pool)
+{
+	uint64_t buf_addr, buf_gaddr, chunck_len;
+	uint32_t buf_avail, buf_offset;
+	uint32_t mbuf_avail, mbuf_offset;
+	uint32_t cpy_len, hdr_remain;
+	uint32_t vec_idx;
+	struct rte_mbuf *cur = m, *prev = m;
+	struct virtio_net_hdr tmp_hdr;
+	struct virtio_net_hdr *hdr = NULL;
+	struct batch_copy_elem *batch_copy = vq->batch_copy_elems;
+	uint16_t copy_nb = vq->batch_copy_nb_elems;
+	int error = 0;
+
+	/*
+	 * The header is small, take a copy of it whatever its layout rather
+	 * than dealing with a header split across descriptors or pages.
+	 */
+	if (virtio_net_with_host_offload(dev)) {
+		uint8_t *dst = (uint8_t *)&tmp_hdr;
+
+		hdr_remain = sizeof(struct virtio_net_hdr);
+		for (vec_idx = 0, buf_offset = 0; hdr_remain != 0; ) {
+			if (buf_offset == buf_vec[vec_idx].buf_len) {
+				if (unlikely(++vec_idx >= nr_vec)) {
+					error = -1;
+					goto out;
+				}
+				buf_offset = 0;
+				continue;
+			}
+
+			chunck_len = RTE_MIN(hdr_remain,
+				buf_vec[vec_idx].buf_len - buf_offset);
+			buf_addr = vhost_iova_to_vva(dev, vq,
+					buf_vec[vec_idx].buf_addr + buf_offset,
+					&chunck_len, VHOST_ACCESS_RO);
+			if (unlikely(!buf_addr || !chunck_len)) {
+				error = -1;
+				goto out;
+			}
+
+			rte_memcpy(dst, (void *)(uintptr_t)buf_addr,
+				   chunck_len);
+			dst += chunck_len;
+			hdr_remain -= chunck_len;
+			buf_offset += chunck_len;
+		}
+
+		hdr = &tmp_hdr;
+	}
+
+	/* skip the header to find the start of the packet data */
+	hdr_remain = dev->vhost_hlen;
+	for (vec_idx = 0; vec_idx < nr_vec; vec_idx++) {
+		if (hdr_remain < buf_vec[vec_idx].buf_len)
+			break;
+		hdr_remain -= buf_vec[vec_idx].buf_len;
+	}
+	if (unlikely(vec_idx == nr_vec && hdr_remain != 0)) {
+		error = -1;
+		goto out;
+	}
+	buf_offset = hdr_remain;
+
+	mbuf_offset = 0;
+	mbuf_avail  = m->buf_len - RTE_PKTMBUF_HEADROOM;
+	for (; vec_idx < nr_vec; vec_idx++, buf_offset = 0) {
+		buf_avail = buf_vec[vec_idx].buf_len - buf_offset;
+		buf_gaddr = buf_vec[vec_idx].buf_addr + buf_offset;
+
+		while (buf_avail != 0) {
+			chunck_len = buf_avail;
+			buf_addr = vhost_iova_to_vva(dev, vq, buf_gaddr,
+					&chunck_len, VHOST_ACCESS_RO);
+			if (unlikely(!buf_addr || !chunck_len)) {
+				error = -1;
+				goto out;
+			}
+
+			rte_prefetch0((void *)(uintptr_t)buf_addr);
+			PRINT_PACKET(dev, (uintptr_t)buf_addr,
+					(uint32_t)chunck_len, 0);
+
+			buf_avail -= chunck_len;
+			buf_gaddr += chunck_len;
+
+			while (chunck_len != 0) {
+				/*
+				 * This mbuf reaches to its end, get a new
+				 * one to hold more data.
+				 */
+				if (mbuf_avail == 0) {
+					cur = rte_pktmbuf_alloc(mbuf_pool);
+					if (unlikely(cur == NULL)) {
+						RTE_LOG(ERR, VHOST_DATA,
+							"Failed to allocate "
+							"memory for mbuf.\n");
+						error = -1;
+						goto out;
+					}
+
+					prev->next = cur;
+					prev->data_len = mbuf_offset;
+					m->nb_segs += 1;
+					m->pkt_len += mbuf_offset;
+					prev = cur;
+
+					mbuf_offset = 0;
+					mbuf_avail  = cur->buf_len -
+						RTE_PKTMBUF_HEADROOM;
+				}
+
+				cpy_len = RTE_MIN(chunck_len, mbuf_avail);
+				if (likely(cpy_len > MAX_BATCH_LEN ||
+					   copy_nb >= vq->size ||
+					   (hdr && cur == m))) {
+					rte_memcpy(rte_pktmbuf_mtod_offset(cur,
+							void *, mbuf_offset),
+						(void *)(uintptr_t)buf_addr,
+						cpy_len);
+				} else {
+					batch_copy[copy_nb].dst =
+						rte_pktmbuf_mtod_offset(cur,
+							void *, mbuf_offset);
+					batch_copy[copy_nb].src =
+						(void *)(uintptr_t)buf_addr;
+					batch_copy[copy_nb].len = cpy_len;
+					copy_nb++;
+				}
+
+				mbuf_avail  -= cpy_len;
+				mbuf_offset += cpy_len;
+				buf_addr    += cpy_len;
+				chunck_len  -= cpy_len;
+			}
+		}
+	}
+
+	prev->data_len = mbuf_offset;
+	m->pkt_len    += mbuf_offset;
+
+	if (hdr)
+		vhost_dequeue_offload(hdr, m);
+
+out:
+	vq->batch_copy_nb_elems = copy_nb;
+
+	return error;
+}
+
+static __rte_always_inline uint16_t
+virtio_dev_tx_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
+	struct rte_mempool *mbuf_pool, struct rte_mbuf **pkts, uint16_t count)
+{
+	struct buf_vector buf_vec[BUF_VECTOR_MAX];
+	bool in_order = dev->features & (1ULL << VIRTIO_F_IN_ORDER);
+	uint16_t used_idx = vq->last_used_idx;
+	uint16_t i;
+
+	vq->shadow_used_idx = 0;
+	count = RTE_MIN(count, MAX_PKT_BURST);
+	LOG_DEBUG(VHOST_DATA, "(%d) about to dequeue %u buffers\n",
+			dev->vid, count);
+
+	rte_prefetch0(&vq->desc_packed[vq->last_avail_idx]);
+	for (i = 0; i < count; i++) {
+		uint32_t vec_idx = 0;
+		uint16_t buf_id, desc_count;
+		uint32_t dummy_len;
+		int err;
+
+		if (unlikely(fill_vec_buf_packed(dev, vq, vq->last_avail_idx,
+						vq->avail_wrap_counter,
+						&desc_count, buf_vec,
+						&vec_idx, &buf_id,
+						&dummy_len) < 0))
+			break;
+
+		pkts[i] = rte_pktmbuf_alloc(mbuf_pool);
+		if (unlikely(pkts[i] == NULL)) {
+			RTE_LOG(ERR, VHOST_DATA,
+				"Failed to allocate memory for mbuf.\n");
+			break;
+		}
+
+		err = copy_vec_to_mbuf(dev, vq, buf_vec, vec_idx, pkts[i],
+				       mbuf_pool);
+		if (unlikely(err)) {
+			rte_pktmbuf_free(pkts[i]);
+			break;
+		}
+
+		if (in_order)
+			update_shadow_used_ring_packed_inorder(vq, buf_id,
+							       desc_count);
+		else
+			update_shadow_used_ring_packed(vq, buf_id, 0,
+						       desc_count);
+
+		vq->last_avail_idx += desc_count;
+		if (vq->last_avail_idx >= vq->size) {
+			vq->last_avail_idx -= vq->size;
+			vq->avail_wrap_counter ^= 1;
+		}
+	}
+
+	do_data_copy_dequeue(vq);
+
+	if (likely(vq->shadow_used_idx)) {
+		flush_shadow_used_ring_packed(dev, vq);
+		vhost_vring_call_packed(vq, used_idx);
+	}
+
+	return i;
+}
+
 uint16_t
 rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 	struct rte_mempool *mbuf_pool, struct rte_mbuf **pkts, uint16_t count)
@@ -1568,6 +2443,11 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 		}
 	}
 
+	if (vq_is_packed(dev)) {
+		i = virtio_dev_tx_packed(dev, vq, mbuf_pool, pkts, count);
+		goto out;
+	}
+
 	free_entries = *((volatile uint16_t *)&vq->avail->idx) -
 			vq->last_avail_idx;
 	if (free_entries == 0)
@@ -1623,7 +2503,8 @@ rte_vhost_dequeue_burst(int vid, uint16_t queue_id,
 				 * in process VA space, we have to copy it.
 				 */
 				idesc = alloc_copy_ind_table(dev, vq,
-						&vq->desc[desc_indexes[i]]);
+						vq->desc[desc_indexes[i]].addr,
+						vq->desc[desc_indexes[i]].len);
 				if (unlikely(!idesc))
 					break;
 
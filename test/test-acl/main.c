@@ -66,6 +66,7 @@
 #define	OPT_BLD_CATEGORIES	"bldcat"
 #define	OPT_RUN_CATEGORIES	"runcat"
 #define	OPT_MAX_SIZE		"maxsize"
+#define	OPT_BLD_THREADS		"bldthreads"
 #define	OPT_ITER_NUM		"iter"
 #define	OPT_VERBOSE		"verbose"
 #define	OPT_IPV6		"ipv6"
@@ -101,6 +102,10 @@ static const struct acl_alg acl_alg[] = {
 		.name = "avx2",
 		.alg = RTE_ACL_CLASSIFY_AVX2,
 	},
+	{
+		.name = "avx512",
+		.alg = RTE_ACL_CLASSIFY_AVX512,
+	},
 	{
 		.name = "neon",
 		.alg = RTE_ACL_CLASSIFY_NEON,
@@ -117,6 +122,7 @@ static struct {
 	const char         *trace_file;
 	size_t              max_size;
 	uint32_t            bld_categories;
+	uint32_t            bld_threads;
 	uint32_t            run_categories;
 	uint32_t            nb_rules;
 	uint32_t            nb_traces;
@@ -131,6 +137,7 @@ static struct {
 	struct rte_acl_ctx *acx;
 } config = {
 	.bld_categories = 3,
+	.bld_threads = 1,
 	.run_categories = 1,
 	.nb_rules = RULE_NUM,
 	.nb_traces = TRACE_DEFAULT_NUM,
@@ -781,6 +788,37 @@ add_cb_rules(FILE *f, struct rte_acl_ctx *ctx)
 	return 0;
 }
 
+static void
+dump_build_stats(const struct rte_acl_ctx *acx)
+{
+	struct rte_acl_build_stats st;
+	uint64_t hz;
+	uint32_t i;
+
+	if (rte_acl_build_stats_get(acx, &st) != 0)
+		return;
+
+	hz = rte_get_tsc_hz();
+	dump_verbose(DUMP_NONE, stdout,
+		"build time: %.2f ms (tries: %.2f ms, gen: %.2f ms), "
+		"attempts: %u\n",
+		(double)st.build_cycles * 1000 / hz,
+		(double)st.trie_cycles * 1000 / hz,
+		(double)st.gen_cycles * 1000 / hz, st.num_attempts);
+	dump_verbose(DUMP_NONE, stdout,
+		"build memory: %zu, run-time memory: %zu, node limit: %u, "
+		"tries rebuilt by workers: %u\n",
+		st.tmp_mem, st.rt_mem, st.node_max, st.num_workers);
+	dump_verbose(DUMP_NONE, stdout,
+		"nodes: %u, dfa: %u, quad: %u, single: %u, match: %u\n",
+		st.num_nodes, st.dfa_nodes, st.quad_nodes, st.single_nodes,
+		st.match_nodes);
+	for (i = 0; i != st.num_tries; i++)
+		dump_verbose(DUMP_NONE, stdout,
+			"trie %u: rules: %u, nodes: %u\n",
+			i, st.trie_rules[i], st.trie_nodes[i]);
+}
+
 static void
 acx_init(void)
 {
@@ -817,6 +855,11 @@ acx_init(void)
 				"for ACL context\n", config.alg.name);
 	}
 
+	ret = rte_acl_set_build_threads(config.acx, config.bld_threads, NULL);
+	if (ret != 0)
+		rte_exit(ret, "failed to set %u build threads "
+			"for ACL context\n", config.bld_threads);
+
 	/* add ACL rules. */
 	f = fopen(config.rule_file, "r");
 	if (f == NULL)
@@ -837,6 +880,7 @@ acx_init(void)
 		config.bld_categories, ret);
 
 	rte_acl_dump(config.acx);
+	dump_build_stats(config.acx);
 
 	if (ret != 0)
 		rte_exit(ret, "failed to build search context\n");
@@ -978,6 +1022,8 @@ print_usage(const char *prgname)
 		"[--" OPT_MAX_SIZE
 			"=<size limit (in bytes) for runtime ACL strucutures> "
 			"leave 0 for default behaviour]\n"
+		"[--" OPT_BLD_THREADS
+			"=<number of threads to build with>]\n"
 		"[--" OPT_ITER_NUM "=<number of iterations to perform>]\n"
 		"[--" OPT_VERBOSE "=<verbose level>]\n"
 		"[--" OPT_SEARCH_ALG "=%s]\n"
@@ -999,6 +1045,7 @@ dump_config(FILE *f)
 	fprintf(f, "%s:%u\n", OPT_BLD_CATEGORIES, config.bld_categories);
 	fprintf(f, "%s:%u\n", OPT_RUN_CATEGORIES, config.run_categories);
 	fprintf(f, "%s:%zu\n", OPT_MAX_SIZE, config.max_size);
+	fprintf(f, "%s:%u\n", OPT_BLD_THREADS, config.bld_threads);
 	fprintf(f, "%s:%u\n", OPT_ITER_NUM, config.iter_num);
 	fprintf(f, "%s:%u\n", OPT_VERBOSE, config.verbose);
 	fprintf(f, "%s:%u(%s)\n", OPT_SEARCH_ALG, config.alg.alg,
@@ -1026,6 +1073,7 @@ get_input_opts(int argc, char **argv)
 		{OPT_TRACE_NUM, 1, 0, 0},
 		{OPT_RULE_NUM, 1, 0, 0},
 		{OPT_MAX_SIZE, 1, 0, 0},
+		{OPT_BLD_THREADS, 1, 0, 0},
 		{OPT_TRACE_STEP, 1, 0, 0},
 		{OPT_BLD_CATEGORIES, 1, 0, 0},
 		{OPT_RUN_CATEGORIES, 1, 0, 0},
@@ -1055,6 +1103,10 @@ get_input_opts(int argc, char **argv)
 		} else if (strcmp(lgopts[opt_idx].name, OPT_MAX_SIZE) == 0) {
 			config.max_size = get_ulong_opt(optarg,
 				lgopts[opt_idx].name, 0, SIZE_MAX);
+		} else if (strcmp(lgopts[opt_idx].name,
+				OPT_BLD_THREADS) == 0) {
+			config.bld_threads = get_ulong_opt(optarg,
+				lgopts[opt_idx].name, 1, RTE_ACL_MAX_TRIES);
 		} else if (strcmp(lgopts[opt_idx].name, OPT_TRACE_NUM) == 0) {
 			config.nb_traces = get_ulong_opt(optarg,
 				lgopts[opt_idx].name, 1, UINT32_MAX);
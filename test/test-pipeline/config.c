@@ -134,6 +134,10 @@ struct {
 	{"hash-spec-16-lru", e_APP_PIPELINE_HASH_SPEC_KEY16_LRU},
 	{"hash-spec-32-ext", e_APP_PIPELINE_HASH_SPEC_KEY32_EXT},
 	{"hash-spec-32-lru", e_APP_PIPELINE_HASH_SPEC_KEY32_LRU},
+	{"hash-spec-48-ext", e_APP_PIPELINE_HASH_SPEC_KEY48_EXT},
+	{"hash-spec-48-lru", e_APP_PIPELINE_HASH_SPEC_KEY48_LRU},
+	{"hash-spec-64-ext", e_APP_PIPELINE_HASH_SPEC_KEY64_EXT},
+	{"hash-spec-64-lru", e_APP_PIPELINE_HASH_SPEC_KEY64_LRU},
 	{"acl", e_APP_PIPELINE_ACL},
 	{"lpm", e_APP_PIPELINE_LPM},
 	{"lpm-ipv6", e_APP_PIPELINE_LPM_IPV6},
@@ -170,6 +174,10 @@ app_parse_args(int argc, char **argv)
 		{"hash-spec-16-lru", 0, 0, 0},
 		{"hash-spec-32-ext", 0, 0, 0},
 		{"hash-spec-32-lru", 0, 0, 0},
+		{"hash-spec-48-ext", 0, 0, 0},
+		{"hash-spec-48-lru", 0, 0, 0},
+		{"hash-spec-64-ext", 0, 0, 0},
+		{"hash-spec-64-lru", 0, 0, 0},
 		{"acl", 0, 0, 0},
 		{"lpm", 0, 0, 0},
 		{"lpm-ipv6", 0, 0, 0},
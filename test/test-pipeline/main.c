@@ -141,6 +141,10 @@ app_lcore_main_loop(__attribute__((unused)) void *arg)
 		case e_APP_PIPELINE_HASH_SPEC_KEY16_LRU:
 		case e_APP_PIPELINE_HASH_SPEC_KEY32_EXT:
 		case e_APP_PIPELINE_HASH_SPEC_KEY32_LRU:
+		case e_APP_PIPELINE_HASH_SPEC_KEY48_EXT:
+		case e_APP_PIPELINE_HASH_SPEC_KEY48_LRU:
+		case e_APP_PIPELINE_HASH_SPEC_KEY64_EXT:
+		case e_APP_PIPELINE_HASH_SPEC_KEY64_LRU:
 		/* cases for cuckoo hash table types */
 		case e_APP_PIPELINE_HASH_CUCKOO_KEY8:
 		case e_APP_PIPELINE_HASH_CUCKOO_KEY16:
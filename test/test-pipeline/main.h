@@ -112,6 +112,10 @@ enum {
 	e_APP_PIPELINE_HASH_SPEC_KEY16_LRU,
 	e_APP_PIPELINE_HASH_SPEC_KEY32_EXT,
 	e_APP_PIPELINE_HASH_SPEC_KEY32_LRU,
+	e_APP_PIPELINE_HASH_SPEC_KEY48_EXT,
+	e_APP_PIPELINE_HASH_SPEC_KEY48_LRU,
+	e_APP_PIPELINE_HASH_SPEC_KEY64_EXT,
+	e_APP_PIPELINE_HASH_SPEC_KEY64_LRU,
 
 	e_APP_PIPELINE_ACL,
 	e_APP_PIPELINE_LPM,
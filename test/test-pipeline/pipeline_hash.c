@@ -77,6 +77,14 @@ translate_options(uint32_t *special, uint32_t *ext, uint32_t *key_size)
 		*special = 1; *ext = 1; *key_size = 32; return;
 	case e_APP_PIPELINE_HASH_SPEC_KEY32_LRU:
 		*special = 1; *ext = 0; *key_size = 32; return;
+	case e_APP_PIPELINE_HASH_SPEC_KEY48_EXT:
+		*special = 1; *ext = 1; *key_size = 48; return;
+	case e_APP_PIPELINE_HASH_SPEC_KEY48_LRU:
+		*special = 1; *ext = 0; *key_size = 48; return;
+	case e_APP_PIPELINE_HASH_SPEC_KEY64_EXT:
+		*special = 1; *ext = 1; *key_size = 64; return;
+	case e_APP_PIPELINE_HASH_SPEC_KEY64_LRU:
+		*special = 1; *ext = 0; *key_size = 64; return;
 
 	case e_APP_PIPELINE_HASH_CUCKOO_KEY8:
 		*special = 0; *ext = 0; *key_size = 8; return;
@@ -315,6 +323,40 @@ app_main_loop_worker_pipeline_hash(void) {
 	}
 	break;
 
+	case e_APP_PIPELINE_HASH_SPEC_KEY48_EXT:
+	case e_APP_PIPELINE_HASH_SPEC_KEY64_EXT:
+	{
+		struct rte_pipeline_table_params table_params = {
+			.ops = &rte_table_hash_key_ext_ops,
+			.arg_create = &table_hash_params,
+			.f_action_hit = NULL,
+			.f_action_miss = NULL,
+			.arg_ah = NULL,
+			.action_data_size = 0,
+		};
+
+		if (rte_pipeline_table_create(p, &table_params, &table_id))
+			rte_panic("Unable to configure the hash table\n");
+	}
+	break;
+
+	case e_APP_PIPELINE_HASH_SPEC_KEY48_LRU:
+	case e_APP_PIPELINE_HASH_SPEC_KEY64_LRU:
+	{
+		struct rte_pipeline_table_params table_params = {
+			.ops = &rte_table_hash_key_lru_ops,
+			.arg_create = &table_hash_params,
+			.f_action_hit = NULL,
+			.f_action_miss = NULL,
+			.arg_ah = NULL,
+			.action_data_size = 0,
+		};
+
+		if (rte_pipeline_table_create(p, &table_params, &table_id))
+			rte_panic("Unable to configure the hash table\n");
+	}
+	break;
+
 	case e_APP_PIPELINE_HASH_CUCKOO_KEY8:
 	case e_APP_PIPELINE_HASH_CUCKOO_KEY16:
 	case e_APP_PIPELINE_HASH_CUCKOO_KEY32:
@@ -357,7 +399,7 @@ app_main_loop_worker_pipeline_hash(void) {
 			{.port_id = port_out_id[i & (app.n_ports - 1)]},
 		};
 		struct rte_pipeline_table_entry *entry_ptr;
-		uint8_t key[32];
+		uint8_t key[RTE_TABLE_HASH_KEY_SIZE_MAX];
 		uint32_t *k32 = (uint32_t *) key;
 		int key_found, status;
 
@@ -443,6 +485,7 @@ app_main_loop_rx_metadata(void) {
 					APP_METADATA_OFFSET(0));
 			key = RTE_MBUF_METADATA_UINT8_PTR(m,
 					APP_METADATA_OFFSET(32));
+			memset(key, 0, 64);
 
 			if (RTE_ETH_IS_IPV4_HDR(m->packet_type)) {
 				ip_hdr = (struct ipv4_hdr *)
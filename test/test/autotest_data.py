@@ -338,6 +338,12 @@ def per_sockets(num):
                 "Func":    default_autotest,
                 "Report":  None,
             },
+            {
+                "Name":    "BPF autotest",
+                "Command": "bpf_autotest",
+                "Func":    default_autotest,
+                "Report":  None,
+            },
         ]
     },
 ]
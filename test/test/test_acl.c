@@ -31,6 +31,7 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 
@@ -42,6 +43,8 @@
 #include <rte_ip.h>
 #include <rte_acl.h>
 #include <rte_common.h>
+#include <rte_cpuflags.h>
+#include <rte_random.h>
 
 #include "test_acl.h"
 
@@ -475,6 +478,549 @@ test_classify(void)
 	return ret;
 }
 
+#define	TEST_ALG_RULES	0x400
+#define	TEST_ALG_DATA	0x100
+
+static const struct {
+	const char *name;
+	enum rte_acl_classify_alg alg;
+} test_classify_algs[] = {
+	{ "sse", RTE_ACL_CLASSIFY_SSE, },
+	{ "avx2", RTE_ACL_CLASSIFY_AVX2, },
+	{ "avx512", RTE_ACL_CLASSIFY_AVX512, },
+	{ "neon", RTE_ACL_CLASSIFY_NEON, },
+	{ "altivec", RTE_ACL_CLASSIFY_ALTIVEC, },
+};
+
+/* check that the cpu can run the given classify method */
+static int
+test_alg_supported(enum rte_acl_classify_alg alg)
+{
+	switch (alg) {
+#if defined(RTE_ARCH_X86)
+	case RTE_ACL_CLASSIFY_SSE:
+		return rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1);
+	case RTE_ACL_CLASSIFY_AVX2:
+		return rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2);
+	case RTE_ACL_CLASSIFY_AVX512:
+		return rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW);
+#elif defined(RTE_ARCH_ARM64)
+	case RTE_ACL_CLASSIFY_NEON:
+		return 1;
+#elif defined(RTE_ARCH_ARM)
+	case RTE_ACL_CLASSIFY_NEON:
+		return rte_cpu_get_flag_enabled(RTE_CPUFLAG_NEON);
+#elif defined(RTE_ARCH_PPC_64)
+	case RTE_ACL_CLASSIFY_ALTIVEC:
+		return 1;
+#endif
+	default:
+		return 0;
+	}
+}
+
+/* network mask of the given prefix length */
+static uint32_t
+test_prefix_mask(uint32_t len)
+{
+	return (uint64_t)UINT32_MAX << (BIT_SIZEOF(uint32_t) - len);
+}
+
+static uint32_t
+test_rand_range(uint32_t low, uint32_t high)
+{
+	return low + rte_rand() % (high - low + 1);
+}
+
+/* fill a rule with random prefixes, port ranges and priority */
+static void
+test_alg_rule(struct rte_acl_ipv4vlan_rule *r, uint32_t idx)
+{
+	uint16_t p0, p1;
+
+	memset(r, 0, sizeof(*r));
+	r->data.userdata = idx + 1;
+	r->data.priority = test_rand_range(RTE_ACL_MIN_PRIORITY,
+		RTE_ACL_MAX_PRIORITY);
+	/* a rule without category is invalid */
+	r->data.category_mask = rte_rand() %
+		RTE_LEN2MASK(RTE_ACL_MAX_CATEGORIES, uint32_t) + 1;
+
+	if ((rte_rand() & 3) == 0) {
+		r->proto = rte_rand();
+		r->proto_mask = UINT8_MAX;
+	}
+	if ((rte_rand() & 3) == 0) {
+		r->vlan = rte_rand();
+		r->vlan_mask = UINT16_MAX;
+	}
+
+	r->src_mask_len = test_rand_range(0, BIT_SIZEOF(r->src_addr));
+	r->src_addr = rte_rand() & test_prefix_mask(r->src_mask_len);
+	r->dst_mask_len = test_rand_range(0, BIT_SIZEOF(r->dst_addr));
+	r->dst_addr = rte_rand() & test_prefix_mask(r->dst_mask_len);
+
+	p0 = rte_rand();
+	p1 = rte_rand();
+	r->src_port_low = RTE_MIN(p0, p1);
+	r->src_port_high = RTE_MAX(p0, p1);
+	r->dst_port_low = 0;
+	r->dst_port_high = (rte_rand() & 1) ? UINT16_MAX : p0;
+}
+
+/* make a tuple, most of them falling inside one of the rules */
+static void
+test_alg_tuple(struct ipv4_7tuple *t,
+	const struct rte_acl_ipv4vlan_rule *rules, uint32_t num)
+{
+	const struct rte_acl_ipv4vlan_rule *r;
+	uint32_t mask;
+
+	memset(t, 0, sizeof(*t));
+	t->proto = rte_rand();
+	t->vlan = rte_rand();
+	t->domain = rte_rand();
+	t->ip_src = rte_rand();
+	t->ip_dst = rte_rand();
+	t->port_src = rte_rand();
+	t->port_dst = rte_rand();
+
+	if ((rte_rand() & 3) == 0)
+		return;
+
+	r = rules + rte_rand() % num;
+	t->proto = (t->proto & ~r->proto_mask) | r->proto;
+	t->vlan = (t->vlan & ~r->vlan_mask) | r->vlan;
+
+	mask = test_prefix_mask(r->src_mask_len);
+	t->ip_src = r->src_addr | (t->ip_src & ~mask);
+	mask = test_prefix_mask(r->dst_mask_len);
+	t->ip_dst = r->dst_addr | (t->ip_dst & ~mask);
+
+	t->port_src = test_rand_range(r->src_port_low, r->src_port_high);
+	t->port_dst = test_rand_range(r->dst_port_low, r->dst_port_high);
+}
+
+static int
+test_classify_alg_run(struct rte_acl_ctx *acx, const uint8_t **data,
+	uint32_t categories)
+{
+	static uint32_t expected[TEST_ALG_DATA * RTE_ACL_MAX_CATEGORIES];
+	static uint32_t results[TEST_ALG_DATA * RTE_ACL_MAX_CATEGORIES];
+	uint32_t count, i, j;
+	int ret;
+
+	ret = rte_acl_classify_alg(acx, data, expected, TEST_ALG_DATA,
+		categories, RTE_ACL_CLASSIFY_SCALAR);
+	if (ret != 0) {
+		printf("Line %i: scalar classify failed!\n", __LINE__);
+		return ret;
+	}
+
+	for (i = 0; i != RTE_DIM(test_classify_algs); i++) {
+
+		if (!test_alg_supported(test_classify_algs[i].alg))
+			continue;
+
+		/* the prefixes of the burst take every code path */
+		for (count = 0; count <= TEST_ALG_DATA; count++) {
+			memset(results, 0, sizeof(results));
+			ret = rte_acl_classify_alg(acx, data, results, count,
+				categories, test_classify_algs[i].alg);
+
+			/* the method is not built in */
+			if (ret == -ENOTSUP)
+				break;
+			if (ret != 0) {
+				printf("Line %i: %s classify failed!\n",
+					__LINE__, test_classify_algs[i].name);
+				return ret;
+			}
+
+			for (j = 0; j != count * categories; j++) {
+				if (results[j] != expected[j]) {
+					printf("Line %i: %s classify of %u "
+						"packets, result %u: "
+						"expected %u, got %u\n",
+						__LINE__,
+						test_classify_algs[i].name,
+						count, j, expected[j],
+						results[j]);
+					return -EINVAL;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Compare all the classify methods supported by the cpu
+ * with the scalar one, over random rules and packets.
+ */
+static int
+test_classify_alg(void)
+{
+	struct rte_acl_ctx *acx;
+	struct rte_acl_ipv4vlan_rule *rules;
+	struct ipv4_7tuple *tuples;
+	const uint8_t *data[TEST_ALG_DATA];
+	uint32_t i;
+	int ret;
+
+	rules = calloc(TEST_ALG_RULES, sizeof(rules[0]));
+	tuples = calloc(TEST_ALG_DATA, sizeof(tuples[0]));
+	acx = rte_acl_create(&acl_param);
+	if (rules == NULL || tuples == NULL || acx == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	for (i = 0; i != TEST_ALG_RULES; i++)
+		test_alg_rule(rules + i, i);
+	for (i = 0; i != TEST_ALG_DATA; i++) {
+		test_alg_tuple(tuples + i, rules, TEST_ALG_RULES);
+		data[i] = (const uint8_t *)(tuples + i);
+	}
+	bswap_test_data(tuples, TEST_ALG_DATA, 1);
+
+	ret = test_classify_buid(acx, rules, TEST_ALG_RULES);
+	if (ret != 0)
+		goto out;
+
+	ret = test_classify_alg_run(acx, data, RTE_ACL_MAX_CATEGORIES);
+	if (ret != 0)
+		goto out;
+
+	/* single category has its own result resolution */
+	ret = rte_acl_ipv4vlan_build(acx, ipv4_7tuple_layout, 1);
+	if (ret != 0) {
+		printf("Line %i: Building ACL context failed!\n", __LINE__);
+		goto out;
+	}
+	ret = test_classify_alg_run(acx, data, 1);
+
+out:
+	rte_acl_free(acx);
+	free(tuples);
+	free(rules);
+	return ret;
+}
+
+#define	TEST_BLD_THREADS	4
+
+/*
+ * Build the same rules on one and on several threads, the two contexts
+ * have to give the same results and the same build statistics.
+ */
+static int
+test_build_threads(void)
+{
+	static uint32_t expected[TEST_ALG_DATA * RTE_ACL_MAX_CATEGORIES];
+	static uint32_t results[TEST_ALG_DATA * RTE_ACL_MAX_CATEGORIES];
+	struct rte_acl_build_stats st[2];
+	struct rte_acl_ctx *acx;
+	struct rte_acl_ipv4vlan_rule *rules;
+	struct ipv4_7tuple *tuples;
+	const uint8_t *data[TEST_ALG_DATA];
+	uint32_t i;
+	int ret;
+
+	rules = calloc(TEST_ALG_RULES, sizeof(rules[0]));
+	tuples = calloc(TEST_ALG_DATA, sizeof(tuples[0]));
+	acx = rte_acl_create(&acl_param);
+	if (rules == NULL || tuples == NULL || acx == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	ret = rte_acl_set_build_threads(acx, RTE_ACL_MAX_TRIES + 1, NULL);
+	if (ret != -EINVAL) {
+		printf("Line %i: %u build threads accepted!\n", __LINE__,
+			RTE_ACL_MAX_TRIES + 1);
+		ret = -EINVAL;
+		goto out;
+	}
+
+	for (i = 0; i != TEST_ALG_RULES; i++)
+		test_alg_rule(rules + i, i);
+	for (i = 0; i != TEST_ALG_DATA; i++) {
+		test_alg_tuple(tuples + i, rules, TEST_ALG_RULES);
+		data[i] = (const uint8_t *)(tuples + i);
+	}
+	bswap_test_data(tuples, TEST_ALG_DATA, 1);
+
+	ret = test_classify_buid(acx, rules, TEST_ALG_RULES);
+	if (ret == 0)
+		ret = rte_acl_classify(acx, data, expected, TEST_ALG_DATA,
+			RTE_ACL_MAX_CATEGORIES);
+	if (ret == 0)
+		ret = rte_acl_build_stats_get(acx, &st[0]);
+	if (ret != 0)
+		goto out;
+
+	ret = rte_acl_set_build_threads(acx, TEST_BLD_THREADS, NULL);
+	if (ret == 0)
+		ret = rte_acl_ipv4vlan_build(acx, ipv4_7tuple_layout,
+			RTE_ACL_MAX_CATEGORIES);
+	if (ret == 0)
+		ret = rte_acl_classify(acx, data, results, TEST_ALG_DATA,
+			RTE_ACL_MAX_CATEGORIES);
+	if (ret == 0)
+		ret = rte_acl_build_stats_get(acx, &st[1]);
+	if (ret != 0) {
+		printf("Line %i: build on %u threads failed!\n", __LINE__,
+			TEST_BLD_THREADS);
+		goto out;
+	}
+
+	for (i = 0; i != RTE_DIM(results); i++) {
+		if (results[i] != expected[i]) {
+			printf("Line %i: result %u: expected %u, got %u\n",
+				__LINE__, i, expected[i], results[i]);
+			ret = -EINVAL;
+			goto out;
+		}
+	}
+
+	/* all but the last trie are built again by the workers */
+	if (st[1].num_workers != st[1].num_tries - 1 ||
+			st[0].num_workers != 0 ||
+			st[0].num_tries != st[1].num_tries ||
+			st[0].rt_mem != st[1].rt_mem ||
+			st[0].dfa_nodes != st[1].dfa_nodes ||
+			st[0].quad_nodes != st[1].quad_nodes ||
+			st[0].single_nodes != st[1].single_nodes ||
+			st[0].match_nodes != st[1].match_nodes ||
+			memcmp(st[0].trie_rules, st[1].trie_rules,
+				sizeof(st[0].trie_rules)) != 0 ||
+			memcmp(st[0].trie_nodes, st[1].trie_nodes,
+				sizeof(st[0].trie_nodes)) != 0) {
+		printf("Line %i: build statistics differ, "
+			"%u tries on one thread, %u on %u threads\n",
+			__LINE__, st[0].num_tries, st[1].num_tries,
+			TEST_BLD_THREADS);
+		ret = -EINVAL;
+	}
+
+out:
+	rte_acl_free(acx);
+	free(tuples);
+	free(rules);
+	return ret;
+}
+
+#define	TEST_INC_RULES		0x200
+#define	TEST_INC_PART_RULES	0x40
+#define	TEST_INC_ROUNDS		4
+
+/*
+ * Build a regular context over the given rules, and check that it gives
+ * the same results as the incremental one.
+ */
+static int
+test_acl_inc_check(const struct rte_acl_inc_ctx *inc,
+	const struct rte_acl_ipv4vlan_rule *rules, uint32_t num,
+	const uint8_t **data)
+{
+	static uint32_t expected[TEST_ALG_DATA * RTE_ACL_MAX_CATEGORIES];
+	static uint32_t results[TEST_ALG_DATA * RTE_ACL_MAX_CATEGORIES];
+	struct rte_acl_ctx *acx;
+	uint32_t i;
+	int ret;
+
+	acx = rte_acl_create(&acl_param);
+	if (acx == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		return -1;
+	}
+
+	/* without rules, nothing matches */
+	memset(expected, 0, sizeof(expected));
+	if (num != 0) {
+		ret = test_classify_buid(acx, rules, num);
+		if (ret == 0)
+			ret = rte_acl_classify(acx, data, expected,
+				TEST_ALG_DATA, RTE_ACL_MAX_CATEGORIES);
+		if (ret != 0)
+			goto out;
+	}
+
+	ret = rte_acl_inc_classify(inc, data, results, TEST_ALG_DATA,
+		RTE_ACL_MAX_CATEGORIES);
+	if (ret != 0) {
+		printf("Line %i: classify failed!\n", __LINE__);
+		goto out;
+	}
+
+	for (i = 0; i != RTE_DIM(results); i++) {
+		if (results[i] != expected[i]) {
+			printf("Line %i: incremental classify of %u rules, "
+				"result %u: expected %u, got %u\n",
+				__LINE__, num, i, expected[i], results[i]);
+			ret = -EINVAL;
+			goto out;
+		}
+	}
+
+out:
+	rte_acl_free(acx);
+	return ret;
+}
+
+static int
+test_acl_inc_add(struct rte_acl_inc_ctx *inc,
+	const struct rte_acl_ipv4vlan_rule *rules, uint32_t num)
+{
+	struct acl_ipv4vlan_rule rv;
+	uint32_t i;
+	int ret;
+
+	for (i = 0; i != num; i++) {
+		acl_ipv4vlan_convert_rule(rules + i, &rv);
+		ret = rte_acl_inc_add_rules(inc,
+			(const struct rte_acl_rule *)&rv, 1);
+		if (ret != 0) {
+			printf("Line %i: adding rule %u failed!\n",
+				__LINE__, i);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Add and delete random rules to an incremental context, and compare
+ * its results with the ones of a context built from scratch.
+ */
+static int
+test_acl_inc(void)
+{
+	struct rte_acl_inc_param prm = {
+		.name = "acl_inc",
+		.socket_id = SOCKET_ID_ANY,
+		.rule_size = RTE_ACL_IPV4VLAN_RULE_SZ,
+		.max_rule_num = TEST_INC_RULES * 2,
+		.part_rule_num = TEST_INC_PART_RULES,
+	};
+	struct rte_acl_inc_ctx *inc;
+	struct rte_acl_config cfg;
+	struct acl_ipv4vlan_rule rv;
+	struct rte_acl_ipv4vlan_rule *rules;
+	struct ipv4_7tuple *tuples;
+	const uint8_t *data[TEST_ALG_DATA];
+	uint32_t del[TEST_INC_RULES / 4];
+	uint32_t i, j, num, next;
+	int ret;
+
+	memset(&cfg, 0, sizeof(cfg));
+	acl_ipv4vlan_config(&cfg, ipv4_7tuple_layout, RTE_ACL_MAX_CATEGORIES);
+
+	rules = calloc(TEST_INC_RULES * 2, sizeof(rules[0]));
+	tuples = calloc(TEST_ALG_DATA, sizeof(tuples[0]));
+	inc = rte_acl_inc_create(&prm, &cfg);
+	if (rules == NULL || tuples == NULL || inc == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	/* unique priorities, the winner of every category is known */
+	for (i = 0; i != TEST_INC_RULES; i++) {
+		test_alg_rule(rules + i, i);
+		rules[i].data.priority = RTE_ACL_MAX_PRIORITY - i;
+	}
+	for (i = 0; i != TEST_ALG_DATA; i++) {
+		test_alg_tuple(tuples + i, rules, TEST_INC_RULES);
+		data[i] = (const uint8_t *)(tuples + i);
+	}
+	bswap_test_data(tuples, TEST_ALG_DATA, 1);
+
+	/* nothing committed yet, nothing matches */
+	ret = test_acl_inc_check(inc, rules, 0, data);
+	if (ret != 0)
+		goto out;
+
+	ret = test_acl_inc_add(inc, rules, TEST_INC_RULES);
+	if (ret == 0)
+		ret = rte_acl_inc_commit(inc);
+	if (ret == 0)
+		ret = test_acl_inc_check(inc, rules, TEST_INC_RULES, data);
+	if (ret != 0)
+		goto out;
+
+	num = TEST_INC_RULES;
+	next = TEST_INC_RULES;
+	for (i = 0; i != TEST_INC_ROUNDS; i++) {
+
+		/* delete random rules, the last ones take their place */
+		for (j = 0; j != RTE_DIM(del); j++) {
+			uint32_t k = rte_rand() % num;
+
+			del[j] = rules[k].data.userdata;
+			rules[k] = rules[--num];
+		}
+		ret = rte_acl_inc_del_rules(inc, del, RTE_DIM(del));
+		if (ret != (int)RTE_DIM(del)) {
+			printf("Line %i: deleted %d rules instead of %zu\n",
+				__LINE__, ret, RTE_DIM(del));
+			ret = -EINVAL;
+			goto out;
+		}
+
+		/* and add new ones */
+		for (j = 0; j != RTE_DIM(del); j++, next++) {
+			test_alg_rule(rules + num + j, next);
+			rules[num + j].data.priority =
+				RTE_ACL_MAX_PRIORITY - next;
+		}
+		ret = test_acl_inc_add(inc, rules + num, RTE_DIM(del));
+		num += RTE_DIM(del);
+
+		if (ret == 0)
+			ret = rte_acl_inc_commit(inc);
+		if (ret == 0)
+			ret = test_acl_inc_check(inc, rules, num, data);
+		if (ret != 0) {
+			printf("Line %i, round %u: %s failed!\n",
+				__LINE__, i, __func__);
+			goto out;
+		}
+	}
+
+	/* deleting unknown rules is not an error */
+	ret = rte_acl_inc_del_rules(inc, del, RTE_DIM(del));
+	if (ret != 0) {
+		printf("Line %i: deleted %d unknown rules\n", __LINE__, ret);
+		ret = -EINVAL;
+		goto out;
+	}
+
+	/* fill the context, the next rule does not fit */
+	ret = test_acl_inc_add(inc, rules, TEST_INC_RULES);
+	if (ret != 0)
+		goto out;
+	acl_ipv4vlan_convert_rule(rules, &rv);
+	ret = rte_acl_inc_add_rules(inc, (const struct rte_acl_rule *)&rv, 1);
+	if (ret != -ENOMEM) {
+		printf("Line %i: too many rules accepted\n", __LINE__);
+		ret = -EINVAL;
+		goto out;
+	}
+	ret = 0;
+
+out:
+	rte_acl_inc_free(inc);
+	free(tuples);
+	free(rules);
+	return ret;
+}
+
 static int
 test_build_ports_range(void)
 {
@@ -1641,6 +2187,12 @@ test_acl(void)
 		return -1;
 	if (test_classify() < 0)
 		return -1;
+	if (test_classify_alg() < 0)
+		return -1;
+	if (test_build_threads() < 0)
+		return -1;
+	if (test_acl_inc() < 0)
+		return -1;
 	if (test_build_ports_range() < 0)
 		return -1;
 	if (test_convert() < 0)
@@ -0,0 +1,341 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_acl.h>
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_random.h>
+
+#include "test.h"
+
+/*
+ * Cost of a rule change in an ACL context, against the number of rules:
+ * a regular context has to be built again over all its rules, while an
+ * incremental one only builds the partition of the changed rule. Also
+ * reported is the lookup cost of both, the incremental context looks up
+ * every partition.
+ */
+
+#define AIP_MAX_RULES	(64 * 1024)
+#define AIP_NB_TUPLES	4096
+#define AIP_BURST	64
+#define AIP_CHANGES	16
+#define AIP_CATEGORIES	RTE_ACL_RESULTS_MULTIPLIER
+
+static const uint32_t aip_nb_rules[] = { 1024, 4096, 16384, 65536 };
+static const uint32_t aip_part_rules[] = { 1024, 4096, 16384 };
+
+struct aip_tuple {
+	uint8_t  proto;
+	uint32_t ip_src;
+	uint32_t ip_dst;
+	uint16_t port_src;
+	uint16_t port_dst;
+};
+
+enum {
+	AIP_PROTO,
+	AIP_SRC,
+	AIP_DST,
+	AIP_PORTS,
+	AIP_NUM_FIELDS = AIP_PORTS + 2
+};
+
+RTE_ACL_RULE_DEF(aip_rule, AIP_NUM_FIELDS);
+
+static const struct rte_acl_field_def aip_defs[AIP_NUM_FIELDS] = {
+	{
+		.type = RTE_ACL_FIELD_TYPE_BITMASK,
+		.size = sizeof(uint8_t),
+		.field_index = AIP_PROTO,
+		.input_index = AIP_PROTO,
+		.offset = offsetof(struct aip_tuple, proto),
+	},
+	{
+		.type = RTE_ACL_FIELD_TYPE_MASK,
+		.size = sizeof(uint32_t),
+		.field_index = AIP_SRC,
+		.input_index = AIP_SRC,
+		.offset = offsetof(struct aip_tuple, ip_src),
+	},
+	{
+		.type = RTE_ACL_FIELD_TYPE_MASK,
+		.size = sizeof(uint32_t),
+		.field_index = AIP_DST,
+		.input_index = AIP_DST,
+		.offset = offsetof(struct aip_tuple, ip_dst),
+	},
+	{
+		.type = RTE_ACL_FIELD_TYPE_RANGE,
+		.size = sizeof(uint16_t),
+		.field_index = AIP_PORTS,
+		.input_index = AIP_PORTS,
+		.offset = offsetof(struct aip_tuple, port_src),
+	},
+	{
+		.type = RTE_ACL_FIELD_TYPE_RANGE,
+		.size = sizeof(uint16_t),
+		.field_index = AIP_PORTS + 1,
+		.input_index = AIP_PORTS,
+		.offset = offsetof(struct aip_tuple, port_dst),
+	},
+};
+
+static struct aip_rule *aip_rules;
+static struct aip_tuple *aip_tuples;
+static const uint8_t *aip_data[AIP_NB_TUPLES];
+static uint32_t aip_results[AIP_BURST * AIP_CATEGORIES];
+
+static struct rte_acl_config aip_cfg = {
+	.num_categories = AIP_CATEGORIES,
+	.num_fields = AIP_NUM_FIELDS,
+};
+
+/* a firewall like rule: host or subnet to server, on a service port */
+static void
+aip_gen_rule(struct aip_rule *r, uint32_t idx)
+{
+	static const uint8_t src_len[] = { 16, 24, 32 };
+	static const uint8_t dst_len[] = { 24, 32 };
+	uint32_t port;
+
+	memset(r, 0, sizeof(*r));
+	r->data.userdata = idx + 1;
+	r->data.priority = RTE_ACL_MAX_PRIORITY - idx;
+	r->data.category_mask = RTE_LEN2MASK(AIP_CATEGORIES, uint32_t);
+
+	r->field[AIP_PROTO].value.u8 = (rte_rand() & 1) ? 6 : 17;
+	r->field[AIP_PROTO].mask_range.u8 = UINT8_MAX;
+	r->field[AIP_SRC].value.u32 = rte_rand();
+	r->field[AIP_SRC].mask_range.u32 =
+		src_len[rte_rand() % RTE_DIM(src_len)];
+	r->field[AIP_DST].value.u32 = rte_rand();
+	r->field[AIP_DST].mask_range.u32 =
+		dst_len[rte_rand() % RTE_DIM(dst_len)];
+
+	r->field[AIP_PORTS].value.u16 = 0;
+	r->field[AIP_PORTS].mask_range.u16 = UINT16_MAX;
+	port = rte_rand() % UINT16_MAX;
+	r->field[AIP_PORTS + 1].value.u16 = port;
+	if (rte_rand() & 3)
+		r->field[AIP_PORTS + 1].mask_range.u16 = port;
+	else
+		r->field[AIP_PORTS + 1].mask_range.u16 =
+			RTE_MIN(port + 16, (uint32_t)UINT16_MAX);
+}
+
+static uint32_t
+aip_host_mask(uint32_t prefix_len)
+{
+	return ((uint64_t)1 << (32 - prefix_len)) - 1;
+}
+
+/* a packet matching one of the first num rules */
+static void
+aip_gen_tuple(struct aip_tuple *t, uint32_t num)
+{
+	const struct aip_rule *r = aip_rules + rte_rand() % num;
+	uint32_t mask;
+
+	t->proto = r->field[AIP_PROTO].value.u8;
+	mask = aip_host_mask(r->field[AIP_SRC].mask_range.u32);
+	t->ip_src = rte_cpu_to_be_32(r->field[AIP_SRC].value.u32 |
+		(rte_rand() & mask));
+	mask = aip_host_mask(r->field[AIP_DST].mask_range.u32);
+	t->ip_dst = rte_cpu_to_be_32(r->field[AIP_DST].value.u32 |
+		(rte_rand() & mask));
+	t->port_src = rte_cpu_to_be_16(rte_rand());
+	t->port_dst = rte_cpu_to_be_16(r->field[AIP_PORTS + 1].value.u16);
+}
+
+static double
+aip_ms(uint64_t cycles)
+{
+	return (double)cycles * 1000 / rte_get_tsc_hz();
+}
+
+/* cycles per packet of the lookups over all the tuples */
+static double
+aip_lookup_full(const struct rte_acl_ctx *ctx)
+{
+	uint64_t start = rte_rdtsc();
+	uint32_t i;
+
+	for (i = 0; i < AIP_NB_TUPLES; i += AIP_BURST)
+		rte_acl_classify(ctx, aip_data + i, aip_results, AIP_BURST,
+			AIP_CATEGORIES);
+
+	return (double)(rte_rdtsc() - start) / AIP_NB_TUPLES;
+}
+
+static double
+aip_lookup_inc(const struct rte_acl_inc_ctx *ctx)
+{
+	uint64_t start = rte_rdtsc();
+	uint32_t i;
+
+	for (i = 0; i < AIP_NB_TUPLES; i += AIP_BURST)
+		rte_acl_inc_classify(ctx, aip_data + i, aip_results,
+			AIP_BURST, AIP_CATEGORIES);
+
+	return (double)(rte_rdtsc() - start) / AIP_NB_TUPLES;
+}
+
+static int
+aip_full(uint32_t num, double *build_ms, double *lookup)
+{
+	struct rte_acl_param prm = {
+		.name = "aip_full",
+		.socket_id = SOCKET_ID_ANY,
+		.rule_size = RTE_ACL_RULE_SZ(AIP_NUM_FIELDS),
+		.max_rule_num = num,
+	};
+	struct rte_acl_ctx *ctx;
+	uint64_t start;
+	int ret;
+
+	ctx = rte_acl_create(&prm);
+	if (ctx == NULL)
+		return -1;
+
+	ret = rte_acl_add_rules(ctx, (struct rte_acl_rule *)aip_rules, num);
+	if (ret == 0) {
+		start = rte_rdtsc();
+		ret = rte_acl_build(ctx, &aip_cfg);
+		*build_ms = aip_ms(rte_rdtsc() - start);
+	}
+	if (ret == 0)
+		*lookup = aip_lookup_full(ctx);
+
+	rte_acl_free(ctx);
+	return ret;
+}
+
+static int
+aip_inc(uint32_t num, uint32_t part_rules, double *build_ms, double *del_ms,
+	double *add_ms, double *lookup)
+{
+	struct rte_acl_inc_param prm = {
+		.name = "aip_inc",
+		.socket_id = SOCKET_ID_ANY,
+		.rule_size = RTE_ACL_RULE_SZ(AIP_NUM_FIELDS),
+		.max_rule_num = num,
+		.part_rule_num = part_rules,
+	};
+	struct rte_acl_inc_ctx *ctx;
+	uint64_t start, del = 0, add = 0;
+	uint32_t i, k;
+	int ret;
+
+	ctx = rte_acl_inc_create(&prm, &aip_cfg);
+	if (ctx == NULL)
+		return -1;
+
+	ret = rte_acl_inc_add_rules(ctx, (struct rte_acl_rule *)aip_rules,
+		num);
+	if (ret != 0)
+		goto out;
+	start = rte_rdtsc();
+	ret = rte_acl_inc_commit(ctx);
+	*build_ms = aip_ms(rte_rdtsc() - start);
+	if (ret != 0)
+		goto out;
+
+	*lookup = aip_lookup_inc(ctx);
+
+	/* replace random rules, one commit per change */
+	for (i = 0; i != AIP_CHANGES; i++) {
+		k = rte_rand() % num;
+
+		start = rte_rdtsc();
+		ret = rte_acl_inc_del_rules(ctx,
+			&aip_rules[k].data.userdata, 1);
+		if (ret == 1)
+			ret = rte_acl_inc_commit(ctx);
+		del += rte_rdtsc() - start;
+		if (ret != 0)
+			goto out;
+
+		start = rte_rdtsc();
+		ret = rte_acl_inc_add_rules(ctx,
+			(struct rte_acl_rule *)(aip_rules + k), 1);
+		if (ret == 0)
+			ret = rte_acl_inc_commit(ctx);
+		add += rte_rdtsc() - start;
+		if (ret != 0)
+			goto out;
+	}
+
+	*del_ms = aip_ms(del) / AIP_CHANGES;
+	*add_ms = aip_ms(add) / AIP_CHANGES;
+
+out:
+	rte_acl_inc_free(ctx);
+	return ret;
+}
+
+static int
+test_acl_inc_perf(void)
+{
+	double build_ms, del_ms, add_ms, lookup;
+	uint32_t i, j, num;
+	int ret = -1;
+
+	memcpy(aip_cfg.defs, aip_defs, sizeof(aip_defs));
+
+	aip_rules = malloc(AIP_MAX_RULES * sizeof(aip_rules[0]));
+	aip_tuples = malloc(AIP_NB_TUPLES * sizeof(aip_tuples[0]));
+	if (aip_rules == NULL || aip_tuples == NULL)
+		goto out;
+
+	for (i = 0; i != AIP_MAX_RULES; i++)
+		aip_gen_rule(aip_rules + i, i);
+
+	printf("%8s %10s %10s %10s %10s %10s\n", "rules", "part_rules",
+		"build_ms", "del_ms", "add_ms", "lookup");
+
+	for (i = 0; i != RTE_DIM(aip_nb_rules); i++) {
+		num = aip_nb_rules[i];
+		for (j = 0; j != AIP_NB_TUPLES; j++) {
+			aip_gen_tuple(aip_tuples + j, num);
+			aip_data[j] = (const uint8_t *)(aip_tuples + j);
+		}
+
+		/* a change costs a build of the whole context */
+		if (aip_full(num, &build_ms, &lookup) != 0) {
+			printf("ACL build of %u rules failed\n", num);
+			goto out;
+		}
+		printf("%8u %10s %10.2f %10.2f %10.2f %10.1f\n", num, "-",
+			build_ms, build_ms, build_ms, lookup);
+
+		for (j = 0; j != RTE_DIM(aip_part_rules); j++) {
+			if (aip_part_rules[j] >= num)
+				break;
+			if (aip_inc(num, aip_part_rules[j], &build_ms,
+					&del_ms, &add_ms, &lookup) != 0) {
+				printf("ACL incremental build of %u rules "
+					"failed\n", num);
+				goto out;
+			}
+			printf("%8u %10u %10.2f %10.2f %10.2f %10.1f\n", num,
+				aip_part_rules[j], build_ms, del_ms, add_ms,
+				lookup);
+		}
+	}
+	printf("(lookups in cycles per packet, '-' for a regular context)\n");
+
+	ret = 0;
+out:
+	free(aip_rules);
+	free(aip_tuples);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(acl_inc_perf_autotest, test_acl_inc_perf);
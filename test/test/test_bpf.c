@@ -0,0 +1,974 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_hexdump.h>
+#include <rte_errno.h>
+#include <rte_bpf.h>
+
+#include "test.h"
+
+/*
+ * Every program below is run by the interpreter and, when available, as
+ * native code; both must return the same value and leave the same data
+ * behind, which in turn must match what the C reference computes.
+ */
+
+#define TEST_FILL_1	0xDEADBEEF
+
+#define TEST_MUL_1	21
+#define TEST_MUL_2	-100
+
+#define TEST_SHIFT_1	15
+#define TEST_SHIFT_2	33
+
+#define TEST_JCC_NUM	11
+
+#define MAX_STACK_OFS	512
+
+#define TEST_IMM_1	UINT64_MAX
+#define TEST_IMM_2	((uint64_t)INT64_MIN)
+#define TEST_IMM_3	((uint64_t)INT64_MAX + INT32_MAX)
+#define TEST_IMM_4	((uint64_t)UINT32_MAX)
+#define TEST_IMM_5	((uint64_t)UINT32_MAX + 1)
+
+struct dummy_offset {
+	uint64_t u64;
+	uint32_t u32;
+	uint16_t u16;
+	uint8_t  u8;
+};
+
+struct dummy_vect8 {
+	struct dummy_offset in[8];
+	struct dummy_offset out[8];
+};
+
+struct bpf_test {
+	const char *name;
+	size_t arg_sz;
+	struct rte_bpf_prm prm;
+	void (*prepare)(void *);
+	int (*check_result)(uint64_t, const void *);
+};
+
+#define EBPF_INSN(c, d, s, o, i) \
+	{ .code = (c), .dst_reg = (d), .src_reg = (s), .off = (o), .imm = (i) }
+
+#define EBPF_RET()	EBPF_INSN(BPF_JMP | EBPF_EXIT, 0, 0, 0, 0)
+
+#define IN(i, f)	offsetof(struct dummy_vect8, in[i].f)
+#define OUT(i, f)	offsetof(struct dummy_vect8, out[i].f)
+
+static int
+cmp_res(const char *func, uint64_t exp_rc, uint64_t ret_rc,
+	const void *exp_res, const void *ret_res, size_t res_sz)
+{
+	if (exp_rc != ret_rc) {
+		printf("%s: invalid return value, expected: 0x%" PRIx64
+			", result: 0x%" PRIx64 "\n", func, exp_rc, ret_rc);
+		return -1;
+	}
+
+	if (memcmp(exp_res, ret_res, res_sz) != 0) {
+		printf("%s: invalid value\n", func);
+		rte_memdump(stdout, "expected", exp_res, res_sz);
+		rte_memdump(stdout, "result", ret_res, res_sz);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* store immediates of every size */
+static const struct ebpf_insn test_store1_prog[] = {
+	EBPF_INSN(BPF_ST | BPF_MEM | BPF_B, EBPF_REG_1, 0, OUT(0, u8),
+		(int8_t)TEST_FILL_1),
+	EBPF_INSN(BPF_ST | BPF_MEM | BPF_H, EBPF_REG_1, 0, OUT(0, u16),
+		(int16_t)TEST_FILL_1),
+	EBPF_INSN(BPF_ST | BPF_MEM | BPF_W, EBPF_REG_1, 0, OUT(0, u32),
+		(int32_t)TEST_FILL_1),
+	EBPF_INSN(BPF_ST | BPF_MEM | EBPF_DW, EBPF_REG_1, 0, OUT(0, u64),
+		(int32_t)TEST_FILL_1),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_0, 0, 0, 1),
+	EBPF_RET(),
+};
+
+static void
+test_store1_prepare(void *arg)
+{
+	memset(arg, 0, sizeof(struct dummy_vect8));
+}
+
+static int
+test_store1_check(uint64_t rc, const void *arg)
+{
+	struct dummy_vect8 dfe;
+
+	memset(&dfe, 0, sizeof(dfe));
+	dfe.out[0].u8 = (int8_t)TEST_FILL_1;
+	dfe.out[0].u16 = (int16_t)TEST_FILL_1;
+	dfe.out[0].u32 = (int32_t)TEST_FILL_1;
+	dfe.out[0].u64 = (int32_t)TEST_FILL_1;
+
+	return cmp_res(__func__, 1, rc, &dfe, arg, sizeof(dfe));
+}
+
+/* load fields of every size, store them back from registers */
+static const struct ebpf_insn test_load1_prog[] = {
+	EBPF_INSN(BPF_LDX | BPF_MEM | BPF_B, EBPF_REG_2, EBPF_REG_1,
+		IN(0, u8), 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | BPF_H, EBPF_REG_3, EBPF_REG_1,
+		IN(0, u16), 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | BPF_W, EBPF_REG_4, EBPF_REG_1,
+		IN(0, u32), 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | EBPF_DW, EBPF_REG_0, EBPF_REG_1,
+		IN(0, u64), 0),
+	/* byte store of a register needing a REX prefix on x86 */
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_X, EBPF_REG_6, EBPF_REG_1, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_X, EBPF_REG_1, EBPF_REG_2, 0, 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | BPF_B, EBPF_REG_6, EBPF_REG_1,
+		OUT(0, u8), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | BPF_H, EBPF_REG_6, EBPF_REG_3,
+		OUT(0, u16), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | BPF_W, EBPF_REG_6, EBPF_REG_4,
+		OUT(0, u32), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_6, EBPF_REG_0,
+		OUT(0, u64), 0),
+	/* sum them up */
+	EBPF_INSN(EBPF_ALU64 | BPF_ADD | BPF_X, EBPF_REG_0, EBPF_REG_2, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_ADD | BPF_X, EBPF_REG_0, EBPF_REG_3, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_ADD | BPF_X, EBPF_REG_0, EBPF_REG_4, 0, 0),
+	EBPF_RET(),
+};
+
+static void
+test_load1_prepare(void *arg)
+{
+	struct dummy_vect8 *dv = arg;
+
+	memset(dv, 0, sizeof(*dv));
+	dv->in[0].u64 = (int32_t)TEST_FILL_1;
+	dv->in[0].u32 = dv->in[0].u64;
+	dv->in[0].u16 = dv->in[0].u64;
+	dv->in[0].u8 = dv->in[0].u64;
+}
+
+static int
+test_load1_check(uint64_t rc, const void *arg)
+{
+	const struct dummy_vect8 *dv = arg;
+	struct dummy_vect8 dve;
+	uint64_t v;
+
+	memcpy(&dve, dv, sizeof(dve));
+	memcpy(&dve.out[0], &dve.in[0], sizeof(dve.out[0]));
+	v = dv->in[0].u64 + dv->in[0].u8 + dv->in[0].u16 + dv->in[0].u32;
+
+	return cmp_res(__func__, v, rc, &dve, arg, sizeof(dve));
+}
+
+/*
+ * ALU operations, 32 and 64 bits, with immediate and register sources,
+ * including shifts by the register x86 uses for the count.
+ */
+static const struct ebpf_insn test_alu1_prog[] = {
+	EBPF_INSN(BPF_LDX | BPF_MEM | EBPF_DW, EBPF_REG_2, EBPF_REG_1,
+		IN(0, u64), 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | EBPF_DW, EBPF_REG_3, EBPF_REG_1,
+		IN(1, u64), 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | BPF_W, EBPF_REG_4, EBPF_REG_1,
+		IN(2, u32), 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | BPF_H, EBPF_REG_5, EBPF_REG_1,
+		IN(3, u16), 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_X, EBPF_REG_6, EBPF_REG_1, 0, 0),
+	EBPF_INSN(BPF_ALU | BPF_ADD | BPF_K, EBPF_REG_2, 0, 0, 0x7fffff01),
+	EBPF_INSN(EBPF_ALU64 | BPF_SUB | BPF_K, EBPF_REG_3, 0, 0, -3),
+	EBPF_INSN(EBPF_ALU64 | BPF_MUL | BPF_X, EBPF_REG_4, EBPF_REG_3, 0, 0),
+	EBPF_INSN(BPF_ALU | BPF_XOR | BPF_X, EBPF_REG_5, EBPF_REG_2, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_AND | BPF_K, EBPF_REG_3, 0, 0, -0x100),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_X, EBPF_REG_2, EBPF_REG_4, 0, 0),
+	EBPF_INSN(BPF_ALU | BPF_LSH | BPF_K, EBPF_REG_4, 0, 0, TEST_SHIFT_1),
+	EBPF_INSN(EBPF_ALU64 | EBPF_ARSH | BPF_K, EBPF_REG_3, 0, 0,
+		TEST_SHIFT_2),
+	EBPF_INSN(EBPF_ALU64 | BPF_RSH | BPF_X, EBPF_REG_2, EBPF_REG_5, 0, 0),
+	EBPF_INSN(BPF_ALU | EBPF_ARSH | BPF_X, EBPF_REG_5, EBPF_REG_4, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_RSH | BPF_X, EBPF_REG_3, EBPF_REG_4, 0, 0),
+	EBPF_INSN(BPF_ALU | BPF_LSH | BPF_X, EBPF_REG_4, EBPF_REG_2, 0, 0),
+	EBPF_INSN(BPF_ALU | BPF_MUL | BPF_K, EBPF_REG_5, 0, 0, TEST_MUL_1),
+	EBPF_INSN(EBPF_ALU64 | BPF_MUL | BPF_K, EBPF_REG_2, 0, 0, TEST_MUL_2),
+	EBPF_INSN(BPF_ALU | BPF_NEG, EBPF_REG_4, 0, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_NEG, EBPF_REG_3, 0, 0, 0),
+	EBPF_INSN(BPF_ALU | EBPF_MOV | BPF_X, EBPF_REG_7, EBPF_REG_3, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_SUB | BPF_X, EBPF_REG_7, EBPF_REG_5, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_XOR | BPF_K, EBPF_REG_7, 0, 0, -1),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_6, EBPF_REG_2,
+		OUT(0, u64), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_6, EBPF_REG_3,
+		OUT(1, u64), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_6, EBPF_REG_4,
+		OUT(2, u64), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_6, EBPF_REG_5,
+		OUT(3, u64), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_6, EBPF_REG_7,
+		OUT(4, u64), 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_0, 0, 0, -1),
+	EBPF_RET(),
+};
+
+static void
+test_alu1_prepare(void *arg)
+{
+	struct dummy_vect8 *dv = arg;
+
+	memset(dv, 0, sizeof(*dv));
+	dv->in[0].u64 = 0x8765432112345678ULL;
+	dv->in[1].u64 = -0x123456789aLL;
+	dv->in[2].u32 = 0xfedcba98;
+	dv->in[3].u16 = 0x4321;
+}
+
+static int
+test_alu1_check(uint64_t rc, const void *arg)
+{
+	const struct dummy_vect8 *dv = arg;
+	struct dummy_vect8 dve;
+	uint64_t r2, r3, r4, r5, r7;
+
+	memcpy(&dve, dv, sizeof(dve));
+	memset(dve.out, 0, sizeof(dve.out));
+
+	r2 = dv->in[0].u64;
+	r3 = dv->in[1].u64;
+	r4 = dv->in[2].u32;
+	r5 = dv->in[3].u16;
+
+	r2 = (uint32_t)(r2 + 0x7fffff01);
+	r3 = r3 + 3;
+	r4 *= r3;
+	r5 = (uint32_t)(r5 ^ r2);
+	r3 &= (uint64_t)-0x100;
+	r2 |= r4;
+	r4 = (uint32_t)(r4 << TEST_SHIFT_1);
+	r3 = (int64_t)r3 >> TEST_SHIFT_2;
+	r2 >>= r5 & 63;
+	r5 = (uint32_t)((int32_t)r5 >> (r4 & 31));
+	r3 >>= r4 & 63;
+	r4 = (uint32_t)(r4 << (r2 & 31));
+	r5 = (uint32_t)(r5 * TEST_MUL_1);
+	r2 *= (uint64_t)(int64_t)TEST_MUL_2;
+	r4 = -(uint32_t)r4;
+	r3 = -r3;
+	r7 = (uint32_t)r3;
+	r7 -= r5;
+	r7 ^= UINT64_MAX;
+
+	dve.out[0].u64 = r2;
+	dve.out[1].u64 = r3;
+	dve.out[2].u64 = r4;
+	dve.out[3].u64 = r5;
+	dve.out[4].u64 = r7;
+
+	return cmp_res(__func__, UINT64_MAX, rc, &dve, arg, sizeof(dve));
+}
+
+/* division and modulo, the last one by zero aborts the program */
+static const struct ebpf_insn test_div1_prog[] = {
+	EBPF_INSN(BPF_LDX | BPF_MEM | EBPF_DW, EBPF_REG_2, EBPF_REG_1,
+		IN(0, u64), 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | EBPF_DW, EBPF_REG_3, EBPF_REG_1,
+		IN(1, u64), 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | BPF_W, EBPF_REG_4, EBPF_REG_1,
+		IN(2, u32), 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | BPF_W, EBPF_REG_0, EBPF_REG_1,
+		IN(3, u32), 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_DIV | BPF_X, EBPF_REG_2, EBPF_REG_3, 0, 0),
+	/* dst and src are the registers x86 division uses */
+	EBPF_INSN(BPF_ALU | BPF_MOD | BPF_X, EBPF_REG_3, EBPF_REG_0, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_DIV | BPF_K, EBPF_REG_4, 0, 0, 7),
+	EBPF_INSN(BPF_ALU | BPF_MOD | BPF_K, EBPF_REG_0, 0, 0, 0x1234),
+	EBPF_INSN(EBPF_ALU64 | BPF_MOD | BPF_X, EBPF_REG_4, EBPF_REG_2, 0, 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_1, EBPF_REG_2,
+		OUT(0, u64), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_1, EBPF_REG_3,
+		OUT(1, u64), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_1, EBPF_REG_4,
+		OUT(2, u64), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_1, EBPF_REG_0,
+		OUT(3, u64), 0),
+	/* in[4] is zero */
+	EBPF_INSN(BPF_LDX | BPF_MEM | EBPF_DW, EBPF_REG_5, EBPF_REG_1,
+		IN(4, u64), 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_DIV | BPF_X, EBPF_REG_0, EBPF_REG_5, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_0, 0, 0, 1),
+	EBPF_RET(),
+};
+
+static void
+test_div1_prepare(void *arg)
+{
+	struct dummy_vect8 *dv = arg;
+
+	memset(dv, 0, sizeof(*dv));
+	dv->in[0].u64 = 0xfedcba9876543210ULL;
+	dv->in[1].u64 = 0x1234567;
+	dv->in[2].u32 = 0x89abcdef;
+	dv->in[3].u32 = 0x76543;
+}
+
+static int
+test_div1_check(uint64_t rc, const void *arg)
+{
+	const struct dummy_vect8 *dv = arg;
+	struct dummy_vect8 dve;
+	uint64_t r0, r2, r3, r4;
+
+	memcpy(&dve, dv, sizeof(dve));
+	memset(dve.out, 0, sizeof(dve.out));
+
+	r2 = dv->in[0].u64;
+	r3 = dv->in[1].u64;
+	r4 = dv->in[2].u32;
+	r0 = dv->in[3].u32;
+
+	r2 /= r3;
+	r3 = (uint32_t)r3 % (uint32_t)r0;
+	r4 /= 7;
+	r0 = (uint32_t)r0 % 0x1234;
+	r4 %= r2;
+
+	dve.out[0].u64 = r2;
+	dve.out[1].u64 = r3;
+	dve.out[2].u64 = r4;
+	dve.out[3].u64 = r0;
+
+	return cmp_res(__func__, 0, rc, &dve, arg, sizeof(dve));
+}
+
+/* byte order conversions */
+static const struct ebpf_insn test_bele1_prog[] = {
+	EBPF_INSN(BPF_LDX | BPF_MEM | EBPF_DW, EBPF_REG_2, EBPF_REG_1,
+		IN(0, u64), 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_X, EBPF_REG_3, EBPF_REG_2, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_X, EBPF_REG_4, EBPF_REG_2, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_X, EBPF_REG_5, EBPF_REG_2, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_X, EBPF_REG_6, EBPF_REG_2, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_X, EBPF_REG_7, EBPF_REG_2, 0, 0),
+	EBPF_INSN(BPF_ALU | EBPF_END | EBPF_TO_BE, EBPF_REG_2, 0, 0, 16),
+	EBPF_INSN(BPF_ALU | EBPF_END | EBPF_TO_BE, EBPF_REG_3, 0, 0, 32),
+	EBPF_INSN(BPF_ALU | EBPF_END | EBPF_TO_BE, EBPF_REG_4, 0, 0, 64),
+	EBPF_INSN(BPF_ALU | EBPF_END | EBPF_TO_LE, EBPF_REG_5, 0, 0, 16),
+	EBPF_INSN(BPF_ALU | EBPF_END | EBPF_TO_LE, EBPF_REG_6, 0, 0, 32),
+	EBPF_INSN(BPF_ALU | EBPF_END | EBPF_TO_LE, EBPF_REG_7, 0, 0, 64),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_1, EBPF_REG_2,
+		OUT(0, u64), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_1, EBPF_REG_3,
+		OUT(1, u64), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_1, EBPF_REG_4,
+		OUT(2, u64), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_1, EBPF_REG_5,
+		OUT(3, u64), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_1, EBPF_REG_6,
+		OUT(4, u64), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_1, EBPF_REG_7,
+		OUT(5, u64), 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_0, 0, 0, 1),
+	EBPF_RET(),
+};
+
+static void
+test_bele1_prepare(void *arg)
+{
+	struct dummy_vect8 *dv = arg;
+
+	memset(dv, 0, sizeof(*dv));
+	dv->in[0].u64 = 0x0123456789abcdefULL;
+}
+
+static int
+test_bele1_check(uint64_t rc, const void *arg)
+{
+	const struct dummy_vect8 *dv = arg;
+	struct dummy_vect8 dve;
+	uint64_t v;
+
+	memcpy(&dve, dv, sizeof(dve));
+	memset(dve.out, 0, sizeof(dve.out));
+
+	v = dv->in[0].u64;
+	dve.out[0].u64 = rte_cpu_to_be_16((uint16_t)v);
+	dve.out[1].u64 = rte_cpu_to_be_32((uint32_t)v);
+	dve.out[2].u64 = rte_cpu_to_be_64(v);
+	dve.out[3].u64 = rte_cpu_to_le_16((uint16_t)v);
+	dve.out[4].u64 = rte_cpu_to_le_32((uint32_t)v);
+	dve.out[5].u64 = rte_cpu_to_le_64(v);
+
+	return cmp_res(__func__, 1, rc, &dve, arg, sizeof(dve));
+}
+
+/* atomic additions */
+static const struct ebpf_insn test_xadd1_prog[] = {
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_2, 0, 0, 1),
+	EBPF_INSN(BPF_STX | EBPF_XADD | BPF_W, EBPF_REG_1, EBPF_REG_2,
+		OUT(0, u32), 0),
+	EBPF_INSN(BPF_STX | EBPF_XADD | EBPF_DW, EBPF_REG_1, EBPF_REG_2,
+		OUT(0, u64), 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_3, 0, 0, -1),
+	EBPF_INSN(BPF_STX | EBPF_XADD | BPF_W, EBPF_REG_1, EBPF_REG_3,
+		OUT(1, u32), 0),
+	EBPF_INSN(BPF_STX | EBPF_XADD | EBPF_DW, EBPF_REG_1, EBPF_REG_3,
+		OUT(1, u64), 0),
+	EBPF_INSN(BPF_LD | BPF_IMM | EBPF_DW, EBPF_REG_9, 0, 0,
+		(uint32_t)TEST_IMM_3),
+	EBPF_INSN(0, 0, 0, 0, TEST_IMM_3 >> 32),
+	EBPF_INSN(BPF_STX | EBPF_XADD | BPF_W, EBPF_REG_1, EBPF_REG_9,
+		OUT(2, u32), 0),
+	EBPF_INSN(BPF_STX | EBPF_XADD | EBPF_DW, EBPF_REG_1, EBPF_REG_9,
+		OUT(2, u64), 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_0, 0, 0, 1),
+	EBPF_RET(),
+};
+
+static void
+test_xadd1_prepare(void *arg)
+{
+	struct dummy_vect8 *dv = arg;
+
+	memset(dv, 0, sizeof(*dv));
+	dv->out[0].u32 = 10;
+	dv->out[0].u64 = 20;
+	dv->out[1].u32 = 30;
+	dv->out[1].u64 = 40;
+	dv->out[2].u32 = TEST_FILL_1;
+	dv->out[2].u64 = TEST_IMM_2;
+}
+
+static int
+test_xadd1_check(uint64_t rc, const void *arg)
+{
+	struct dummy_vect8 dve;
+
+	test_xadd1_prepare(&dve);
+	dve.out[0].u32 += 1;
+	dve.out[0].u64 += 1;
+	dve.out[1].u32 -= 1;
+	dve.out[1].u64 -= 1;
+	dve.out[2].u32 += (uint32_t)TEST_IMM_3;
+	dve.out[2].u64 += TEST_IMM_3;
+
+	return cmp_res(__func__, 1, rc, &dve, arg, sizeof(dve));
+}
+
+/* 64-bit immediate loads */
+static const struct ebpf_insn test_ldimm1_prog[] = {
+	EBPF_INSN(BPF_LD | BPF_IMM | EBPF_DW, EBPF_REG_0, 0, 0,
+		(uint32_t)TEST_IMM_1),
+	EBPF_INSN(0, 0, 0, 0, TEST_IMM_1 >> 32),
+	EBPF_INSN(BPF_LD | BPF_IMM | EBPF_DW, EBPF_REG_3, 0, 0,
+		(uint32_t)TEST_IMM_2),
+	EBPF_INSN(0, 0, 0, 0, TEST_IMM_2 >> 32),
+	EBPF_INSN(BPF_LD | BPF_IMM | EBPF_DW, EBPF_REG_5, 0, 0,
+		(uint32_t)TEST_IMM_4),
+	EBPF_INSN(0, 0, 0, 0, TEST_IMM_4 >> 32),
+	EBPF_INSN(BPF_LD | BPF_IMM | EBPF_DW, EBPF_REG_7, 0, 0,
+		(uint32_t)TEST_IMM_5),
+	EBPF_INSN(0, 0, 0, 0, TEST_IMM_5 >> 32),
+	EBPF_INSN(EBPF_ALU64 | BPF_ADD | BPF_X, EBPF_REG_0, EBPF_REG_3, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_ADD | BPF_X, EBPF_REG_0, EBPF_REG_5, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_ADD | BPF_X, EBPF_REG_0, EBPF_REG_7, 0, 0),
+	EBPF_RET(),
+};
+
+static void
+test_ldimm1_prepare(void *arg)
+{
+	memset(arg, 0, sizeof(struct dummy_vect8));
+}
+
+static int
+test_ldimm1_check(uint64_t rc, const void *arg)
+{
+	struct dummy_vect8 dve;
+
+	memset(&dve, 0, sizeof(dve));
+	return cmp_res(__func__, TEST_IMM_1 + TEST_IMM_2 + TEST_IMM_4 +
+		TEST_IMM_5, rc, &dve, arg, sizeof(dve));
+}
+
+/*
+ * Conditional jumps: bit N of R0 is set when jump N is not taken.
+ * Each jump is tested against a register and an immediate.
+ */
+static const struct ebpf_insn test_jump1_prog[] = {
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_0, 0, 0, 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | EBPF_DW, EBPF_REG_2, EBPF_REG_1,
+		IN(0, u64), 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | EBPF_DW, EBPF_REG_3, EBPF_REG_1,
+		IN(1, u64), 0),
+	EBPF_INSN(BPF_JMP | BPF_JEQ | BPF_X, EBPF_REG_2, EBPF_REG_3, 1, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 0),
+	EBPF_INSN(BPF_JMP | EBPF_JNE | BPF_X, EBPF_REG_2, EBPF_REG_3, 1, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 1),
+	EBPF_INSN(BPF_JMP | BPF_JGT | BPF_X, EBPF_REG_2, EBPF_REG_3, 1, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 2),
+	EBPF_INSN(BPF_JMP | BPF_JGE | BPF_X, EBPF_REG_2, EBPF_REG_3, 1, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 3),
+	EBPF_INSN(BPF_JMP | EBPF_JLT | BPF_X, EBPF_REG_2, EBPF_REG_3, 1, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 4),
+	EBPF_INSN(BPF_JMP | EBPF_JLE | BPF_X, EBPF_REG_2, EBPF_REG_3, 1, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 5),
+	EBPF_INSN(BPF_JMP | EBPF_JSGT | BPF_X, EBPF_REG_2, EBPF_REG_3, 1, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 6),
+	EBPF_INSN(BPF_JMP | EBPF_JSGE | BPF_X, EBPF_REG_2, EBPF_REG_3, 1, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 7),
+	EBPF_INSN(BPF_JMP | EBPF_JSLT | BPF_X, EBPF_REG_2, EBPF_REG_3, 1, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 8),
+	EBPF_INSN(BPF_JMP | EBPF_JSLE | BPF_X, EBPF_REG_2, EBPF_REG_3, 1, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 9),
+	EBPF_INSN(BPF_JMP | BPF_JSET | BPF_X, EBPF_REG_2, EBPF_REG_3, 1, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 10),
+	EBPF_INSN(BPF_JMP | BPF_JEQ | BPF_K, EBPF_REG_2, 0, 1, -2),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 11),
+	EBPF_INSN(BPF_JMP | EBPF_JNE | BPF_K, EBPF_REG_2, 0, 1, -2),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 12),
+	EBPF_INSN(BPF_JMP | BPF_JGT | BPF_K, EBPF_REG_2, 0, 1, -2),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 13),
+	EBPF_INSN(BPF_JMP | BPF_JGE | BPF_K, EBPF_REG_2, 0, 1, -2),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 14),
+	EBPF_INSN(BPF_JMP | EBPF_JLT | BPF_K, EBPF_REG_2, 0, 1, -2),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 15),
+	EBPF_INSN(BPF_JMP | EBPF_JLE | BPF_K, EBPF_REG_2, 0, 1, -2),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 16),
+	EBPF_INSN(BPF_JMP | EBPF_JSGT | BPF_K, EBPF_REG_2, 0, 1, -2),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 17),
+	EBPF_INSN(BPF_JMP | EBPF_JSGE | BPF_K, EBPF_REG_2, 0, 1, -2),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 18),
+	EBPF_INSN(BPF_JMP | EBPF_JSLT | BPF_K, EBPF_REG_2, 0, 1, -2),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 19),
+	EBPF_INSN(BPF_JMP | EBPF_JSLE | BPF_K, EBPF_REG_2, 0, 1, -2),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 20),
+	EBPF_INSN(BPF_JMP | BPF_JSET | BPF_K, EBPF_REG_2, 0, 1, -2),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 21),
+	EBPF_INSN(BPF_JMP | BPF_JA, 0, 0, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_OR | BPF_K, EBPF_REG_0, 0, 0, 1 << 22),
+	EBPF_RET(),
+};
+
+static const uint64_t test_jump1_val[][2] = {
+	{ 1, 1 },
+	{ 1, 2 },
+	{ -2, 1 },
+	{ 1, -2 },
+	{ -2, -2 },
+	{ 0, 0 },
+};
+
+static uint32_t test_jump1_idx;
+
+static void
+test_jump1_prepare(void *arg)
+{
+	struct dummy_vect8 *dv = arg;
+
+	memset(dv, 0, sizeof(*dv));
+	dv->in[0].u64 = test_jump1_val[test_jump1_idx][0];
+	dv->in[1].u64 = test_jump1_val[test_jump1_idx][1];
+}
+
+/* bits of R0 for the comparisons of a and b */
+static uint64_t
+test_jump1_ref(uint64_t a, uint64_t b)
+{
+	const int taken[TEST_JCC_NUM] = {
+		a == b,
+		a != b,
+		a > b,
+		a >= b,
+		a < b,
+		a <= b,
+		(int64_t)a > (int64_t)b,
+		(int64_t)a >= (int64_t)b,
+		(int64_t)a < (int64_t)b,
+		(int64_t)a <= (int64_t)b,
+		(a & b) != 0,
+	};
+	uint64_t rc;
+	uint32_t i;
+
+	rc = 0;
+	for (i = 0; i != TEST_JCC_NUM; i++)
+		if (!taken[i])
+			rc |= 1 << i;
+	return rc;
+}
+
+static int
+test_jump1_check(uint64_t rc, const void *arg)
+{
+	const struct dummy_vect8 *dv = arg;
+	struct dummy_vect8 dve;
+	uint64_t v;
+
+	test_jump1_prepare(&dve);
+	v = test_jump1_ref(dv->in[0].u64, dv->in[1].u64) |
+		test_jump1_ref(dv->in[0].u64, (uint64_t)-2) << TEST_JCC_NUM |
+		1 << (2 * TEST_JCC_NUM);
+
+	return cmp_res(__func__, v, rc, &dve, arg, sizeof(dve));
+}
+
+/* external call, through a pointer to the stack */
+static uint64_t
+dummy_func1(uint64_t p, uint64_t v, uint64_t a3, uint64_t a4, uint64_t a5)
+{
+	uint64_t *s = (uint64_t *)(uintptr_t)p;
+	uint64_t rc;
+
+	rc = *s + v + a3 * 3 + a4 * 5 + a5 * 7;
+	*s = ~*s;
+	return rc;
+}
+
+static const struct rte_bpf_xsym test_call1_xsym[] = {
+	{
+		.name = RTE_STR(dummy_func1),
+		.type = RTE_BPF_XTYPE_FUNC,
+		.func = dummy_func1,
+	},
+};
+
+static const struct ebpf_insn test_call1_prog[] = {
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_X, EBPF_REG_6, EBPF_REG_1, 0, 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | EBPF_DW, EBPF_REG_2, EBPF_REG_6,
+		IN(0, u64), 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_10, EBPF_REG_2,
+		-8, 0),
+	EBPF_INSN(BPF_ST | BPF_MEM | BPF_W, EBPF_REG_10, 0,
+		-MAX_STACK_OFS, TEST_FILL_1),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_X, EBPF_REG_1, EBPF_REG_10, 0, 0),
+	EBPF_INSN(EBPF_ALU64 | BPF_ADD | BPF_K, EBPF_REG_1, 0, 0, -8),
+	EBPF_INSN(BPF_LDX | BPF_MEM | BPF_W, EBPF_REG_2, EBPF_REG_6,
+		IN(1, u32), 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_3, 0, 0, 3),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_4, 0, 0, 4),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_5, 0, 0, 5),
+	EBPF_INSN(BPF_JMP | EBPF_CALL, 0, 0, 0, 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | EBPF_DW, EBPF_REG_7, EBPF_REG_10,
+		-8, 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | EBPF_DW, EBPF_REG_6, EBPF_REG_7,
+		OUT(0, u64), 0),
+	EBPF_INSN(BPF_LDX | BPF_MEM | BPF_W, EBPF_REG_8, EBPF_REG_10,
+		-MAX_STACK_OFS, 0),
+	EBPF_INSN(BPF_STX | BPF_MEM | BPF_W, EBPF_REG_6, EBPF_REG_8,
+		OUT(0, u32), 0),
+	EBPF_RET(),
+};
+
+static void
+test_call1_prepare(void *arg)
+{
+	struct dummy_vect8 *dv = arg;
+
+	memset(dv, 0, sizeof(*dv));
+	dv->in[0].u64 = 0x1122334455667788ULL;
+	dv->in[1].u32 = 0x99aabbcc;
+}
+
+static int
+test_call1_check(uint64_t rc, const void *arg)
+{
+	const struct dummy_vect8 *dv = arg;
+	struct dummy_vect8 dve;
+	uint64_t v, s;
+
+	memcpy(&dve, dv, sizeof(dve));
+	memset(dve.out, 0, sizeof(dve.out));
+
+	s = dv->in[0].u64;
+	v = dummy_func1((uintptr_t)&s, dv->in[1].u32, 3, 4, 5);
+	dve.out[0].u64 = s;
+	dve.out[0].u32 = TEST_FILL_1;
+
+	return cmp_res(__func__, v, rc, &dve, arg, sizeof(dve));
+}
+
+static const struct bpf_test tests[] = {
+	{
+		.name = "test_store1",
+		.arg_sz = sizeof(struct dummy_vect8),
+		.prm = {
+			.ins = test_store1_prog,
+			.nb_ins = RTE_DIM(test_store1_prog),
+		},
+		.prepare = test_store1_prepare,
+		.check_result = test_store1_check,
+	},
+	{
+		.name = "test_load1",
+		.arg_sz = sizeof(struct dummy_vect8),
+		.prm = {
+			.ins = test_load1_prog,
+			.nb_ins = RTE_DIM(test_load1_prog),
+		},
+		.prepare = test_load1_prepare,
+		.check_result = test_load1_check,
+	},
+	{
+		.name = "test_alu1",
+		.arg_sz = sizeof(struct dummy_vect8),
+		.prm = {
+			.ins = test_alu1_prog,
+			.nb_ins = RTE_DIM(test_alu1_prog),
+		},
+		.prepare = test_alu1_prepare,
+		.check_result = test_alu1_check,
+	},
+	{
+		.name = "test_div1",
+		.arg_sz = sizeof(struct dummy_vect8),
+		.prm = {
+			.ins = test_div1_prog,
+			.nb_ins = RTE_DIM(test_div1_prog),
+		},
+		.prepare = test_div1_prepare,
+		.check_result = test_div1_check,
+	},
+	{
+		.name = "test_bele1",
+		.arg_sz = sizeof(struct dummy_vect8),
+		.prm = {
+			.ins = test_bele1_prog,
+			.nb_ins = RTE_DIM(test_bele1_prog),
+		},
+		.prepare = test_bele1_prepare,
+		.check_result = test_bele1_check,
+	},
+	{
+		.name = "test_xadd1",
+		.arg_sz = sizeof(struct dummy_vect8),
+		.prm = {
+			.ins = test_xadd1_prog,
+			.nb_ins = RTE_DIM(test_xadd1_prog),
+		},
+		.prepare = test_xadd1_prepare,
+		.check_result = test_xadd1_check,
+	},
+	{
+		.name = "test_ldimm1",
+		.arg_sz = sizeof(struct dummy_vect8),
+		.prm = {
+			.ins = test_ldimm1_prog,
+			.nb_ins = RTE_DIM(test_ldimm1_prog),
+		},
+		.prepare = test_ldimm1_prepare,
+		.check_result = test_ldimm1_check,
+	},
+	{
+		.name = "test_jump1",
+		.arg_sz = sizeof(struct dummy_vect8),
+		.prm = {
+			.ins = test_jump1_prog,
+			.nb_ins = RTE_DIM(test_jump1_prog),
+		},
+		.prepare = test_jump1_prepare,
+		.check_result = test_jump1_check,
+	},
+	{
+		.name = "test_call1",
+		.arg_sz = sizeof(struct dummy_vect8),
+		.prm = {
+			.ins = test_call1_prog,
+			.nb_ins = RTE_DIM(test_call1_prog),
+			.xsym = test_call1_xsym,
+			.nb_xsym = RTE_DIM(test_call1_xsym),
+		},
+		.prepare = test_call1_prepare,
+		.check_result = test_call1_check,
+	},
+};
+
+/* programs the verifier must reject */
+static const struct ebpf_insn test_bad_loop[] = {
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_0, 0, 0, 0),
+	EBPF_INSN(BPF_JMP | BPF_JA, 0, 0, -2, 0),
+	EBPF_RET(),
+};
+
+static const struct ebpf_insn test_bad_unreachable[] = {
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_0, 0, 0, 0),
+	EBPF_RET(),
+	EBPF_RET(),
+};
+
+static const struct ebpf_insn test_bad_fp_write[] = {
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_10, 0, 0, 0),
+	EBPF_RET(),
+};
+
+static const struct ebpf_insn test_bad_stack[] = {
+	EBPF_INSN(BPF_ST | BPF_MEM | EBPF_DW, EBPF_REG_10, 0, -4, 0),
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_0, 0, 0, 0),
+	EBPF_RET(),
+};
+
+static const struct ebpf_insn test_bad_div[] = {
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_0, 0, 0, 1),
+	EBPF_INSN(EBPF_ALU64 | BPF_DIV | BPF_K, EBPF_REG_0, 0, 0, 0),
+	EBPF_RET(),
+};
+
+static const struct ebpf_insn test_bad_call[] = {
+	EBPF_INSN(BPF_JMP | EBPF_CALL, 0, 0, 0, 0),
+	EBPF_RET(),
+};
+
+static const struct ebpf_insn test_bad_end[] = {
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_0, 0, 0, 0),
+};
+
+static const struct ebpf_insn test_bad_ldimm[] = {
+	EBPF_INSN(EBPF_ALU64 | EBPF_MOV | BPF_K, EBPF_REG_0, 0, 0, 0),
+	EBPF_INSN(BPF_JMP | BPF_JEQ | BPF_K, EBPF_REG_0, 0, 1, 0),
+	EBPF_INSN(BPF_LD | BPF_IMM | EBPF_DW, EBPF_REG_0, 0, 0, 0),
+	EBPF_INSN(0, 0, 0, 0, 0),
+	EBPF_RET(),
+};
+
+static const struct {
+	const char *name;
+	const struct ebpf_insn *ins;
+	uint32_t nb_ins;
+} bad_tests[] = {
+	{ "loop", test_bad_loop, RTE_DIM(test_bad_loop) },
+	{ "unreachable", test_bad_unreachable,
+		RTE_DIM(test_bad_unreachable) },
+	{ "fp write", test_bad_fp_write, RTE_DIM(test_bad_fp_write) },
+	{ "stack", test_bad_stack, RTE_DIM(test_bad_stack) },
+	{ "div by 0", test_bad_div, RTE_DIM(test_bad_div) },
+	{ "unknown call", test_bad_call, RTE_DIM(test_bad_call) },
+	{ "no exit", test_bad_end, RTE_DIM(test_bad_end) },
+	{ "jump into ld_imm64", test_bad_ldimm, RTE_DIM(test_bad_ldimm) },
+};
+
+static int
+run_test(const struct bpf_test *tst)
+{
+	int32_t ret;
+	uint64_t rc, rv;
+	struct rte_bpf *bpf;
+	struct rte_bpf_jit jit;
+	uint8_t tbuf[tst->arg_sz];
+	uint8_t jbuf[tst->arg_sz];
+
+	printf("%s(%s) start\n", __func__, tst->name);
+
+	bpf = rte_bpf_load(&tst->prm);
+	if (bpf == NULL) {
+		printf("%s: failed to load bpf code, error=%d(%s);\n",
+			__func__, rte_errno, strerror(rte_errno));
+		return -1;
+	}
+
+	tst->prepare(tbuf);
+	rc = rte_bpf_exec(bpf, tbuf);
+	ret = tst->check_result(rc, tbuf);
+	if (ret != 0)
+		printf("%s@%d: check_result(%s) failed;\n",
+			__func__, __LINE__, tst->name);
+
+	rte_bpf_get_jit(bpf, &jit);
+	if (jit.func != NULL) {
+		tst->prepare(jbuf);
+		rv = jit.func(jbuf);
+		if (tst->check_result(rv, jbuf) != 0 || rv != rc ||
+				memcmp(jbuf, tbuf, sizeof(jbuf)) != 0) {
+			printf("%s@%d: JIT and interpreter differ for %s;\n",
+				__func__, __LINE__, tst->name);
+			ret = -1;
+		}
+	}
+
+	rte_bpf_destroy(bpf);
+	return ret;
+}
+
+static int
+test_bpf_burst(void)
+{
+	struct rte_bpf *bpf;
+	struct dummy_vect8 dv[4];
+	void *ctx[RTE_DIM(dv)];
+	uint64_t rc[RTE_DIM(dv)];
+	uint32_t i, n;
+
+	bpf = rte_bpf_load(&tests[0].prm);
+	if (bpf == NULL)
+		return -1;
+
+	for (i = 0; i != RTE_DIM(dv); i++) {
+		test_store1_prepare(&dv[i]);
+		ctx[i] = &dv[i];
+	}
+
+	n = rte_bpf_exec_burst(bpf, ctx, rc, RTE_DIM(dv));
+	rte_bpf_destroy(bpf);
+
+	if (n != RTE_DIM(dv))
+		return -1;
+	for (i = 0; i != RTE_DIM(dv); i++)
+		if (test_store1_check(rc[i], &dv[i]) != 0)
+			return -1;
+
+	return 0;
+}
+
+static int
+test_bpf(void)
+{
+	int32_t rc, rv;
+	uint32_t i;
+	struct rte_bpf *bpf;
+	struct rte_bpf_prm prm;
+
+	rc = 0;
+	for (i = 0; i != RTE_DIM(tests); i++) {
+		if (tests[i].prepare == test_jump1_prepare) {
+			for (test_jump1_idx = 0;
+					test_jump1_idx !=
+					RTE_DIM(test_jump1_val);
+					test_jump1_idx++)
+				rc |= run_test(tests + i);
+		} else {
+			rc |= run_test(tests + i);
+		}
+	}
+
+	rv = test_bpf_burst();
+	if (rv != 0)
+		printf("%s: burst execution failed\n", __func__);
+	rc |= rv;
+
+	memset(&prm, 0, sizeof(prm));
+	for (i = 0; i != RTE_DIM(bad_tests); i++) {
+		prm.ins = bad_tests[i].ins;
+		prm.nb_ins = bad_tests[i].nb_ins;
+		bpf = rte_bpf_load(&prm);
+		if (bpf != NULL || rte_errno != EINVAL) {
+			printf("%s: invalid program \"%s\" accepted\n",
+				__func__, bad_tests[i].name);
+			rte_bpf_destroy(bpf);
+			rc = -1;
+		}
+	}
+
+	return rc;
+}
+
+REGISTER_TEST_COMMAND(bpf_autotest, test_bpf);
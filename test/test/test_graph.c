@@ -0,0 +1,487 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+
+#include "test.h"
+
+/*
+ * Graph
+ * =====
+ *
+ * The nodes below carry integers, cast to pointers, instead of packets:
+ *
+ *   test_graph_src --+--> test_graph_odd  --+--> test_graph_sink
+ *                    +--> test_graph_even --+
+ *
+ * - The source produces nb_src_objs consecutive integers on each walk.
+ * - Odd integers go through test_graph_odd, which enqueues them one by one
+ *   or four at a time; even integers through test_graph_even, which moves
+ *   its whole stream.
+ * - The sink checks it gets each integer once, and sums them up.
+ */
+
+#define TEST_GRAPH_MAX_OBJS 4096
+
+enum {
+	SRC_NEXT_ODD,
+	SRC_NEXT_EVEN,
+};
+
+static uint16_t nb_src_objs;
+static uintptr_t src_next_obj;
+static uint64_t sink_objs;
+static uint64_t sink_sum;
+static unsigned int nb_init, nb_fini;
+
+static uint16_t
+test_graph_src_process(struct rte_graph *graph, struct rte_node *node,
+		void **objs, uint16_t nb_objs)
+{
+	uint16_t i;
+
+	RTE_SET_USED(objs);
+	RTE_SET_USED(nb_objs);
+
+	for (i = 0; i < nb_src_objs; i++, src_next_obj++)
+		rte_node_enqueue_x1(graph, node, src_next_obj & 1 ?
+			SRC_NEXT_ODD : SRC_NEXT_EVEN, (void *)src_next_obj);
+	return nb_src_objs;
+}
+
+static uint16_t
+test_graph_odd_process(struct rte_graph *graph, struct rte_node *node,
+		void **objs, uint16_t nb_objs)
+{
+	uint16_t i = 0;
+
+	for (; i + 4 <= nb_objs; i += 4)
+		rte_node_enqueue_x4(graph, node, 0, objs[i], objs[i + 1],
+			objs[i + 2], objs[i + 3]);
+	for (; i < nb_objs; i++)
+		rte_node_enqueue_x1(graph, node, 0, objs[i]);
+	return nb_objs;
+}
+
+static uint16_t
+test_graph_even_process(struct rte_graph *graph, struct rte_node *node,
+		void **objs, uint16_t nb_objs)
+{
+	RTE_SET_USED(objs);
+
+	rte_node_next_stream_move(graph, node, 0);
+	return nb_objs;
+}
+
+static uint16_t
+test_graph_sink_process(struct rte_graph *graph, struct rte_node *node,
+		void **objs, uint16_t nb_objs)
+{
+	uint16_t i;
+
+	RTE_SET_USED(graph);
+	RTE_SET_USED(node);
+
+	for (i = 0; i < nb_objs; i++)
+		sink_sum += (uintptr_t)objs[i];
+	sink_objs += nb_objs;
+	return nb_objs;
+}
+
+static int
+test_graph_init(const struct rte_graph *graph, struct rte_node *node)
+{
+	RTE_SET_USED(graph);
+	RTE_SET_USED(node);
+
+	nb_init++;
+	return 0;
+}
+
+static void
+test_graph_fini(const struct rte_graph *graph, struct rte_node *node)
+{
+	RTE_SET_USED(graph);
+	RTE_SET_USED(node);
+
+	nb_fini++;
+}
+
+static struct rte_node_register test_graph_src = {
+	.name = "test_graph_src",
+	.flags = RTE_NODE_SOURCE_F,
+	.process = test_graph_src_process,
+	.init = test_graph_init,
+	.fini = test_graph_fini,
+	.nb_edges = 2,
+	.next_nodes = {
+		[SRC_NEXT_ODD] = "test_graph_odd",
+		[SRC_NEXT_EVEN] = "test_graph_even",
+	},
+};
+RTE_NODE_REGISTER(test_graph_src);
+
+static struct rte_node_register test_graph_odd = {
+	.name = "test_graph_odd",
+	.process = test_graph_odd_process,
+	.init = test_graph_init,
+	.fini = test_graph_fini,
+	.nb_edges = 1,
+	.next_nodes = { "test_graph_sink" },
+};
+RTE_NODE_REGISTER(test_graph_odd);
+
+static struct rte_node_register test_graph_even = {
+	.name = "test_graph_even",
+	.process = test_graph_even_process,
+	.init = test_graph_init,
+	.fini = test_graph_fini,
+	.nb_edges = 1,
+	.next_nodes = { "test_graph_sink" },
+};
+RTE_NODE_REGISTER(test_graph_even);
+
+static struct rte_node_register test_graph_sink = {
+	.name = "test_graph_sink",
+	.process = test_graph_sink_process,
+	.init = test_graph_init,
+	.fini = test_graph_fini,
+};
+RTE_NODE_REGISTER(test_graph_sink);
+
+static const char *test_graph_patterns[] = { "test_graph_src" };
+
+static int
+test_graph_nodes(void)
+{
+	const char *next_nodes[4];
+	const char *name;
+	rte_node_t id;
+
+	if (test_graph_src.id == RTE_NODE_ID_INVALID ||
+			rte_node_from_name("test_graph_src") !=
+				test_graph_src.id ||
+			rte_node_from_name("test_graph_none") !=
+				RTE_NODE_ID_INVALID) {
+		printf("Bad node ids\n");
+		return -1;
+	}
+	name = rte_node_id_to_name(test_graph_sink.id);
+	if (name == NULL || strcmp(name, "test_graph_sink") != 0) {
+		printf("Bad node name %s\n", name);
+		return -1;
+	}
+	if (rte_node_edge_count(test_graph_src.id) != 2 ||
+			rte_node_edge_get(test_graph_src.id, next_nodes) != 2 ||
+			strcmp(next_nodes[SRC_NEXT_EVEN], "test_graph_even")) {
+		printf("Bad edges of test_graph_src\n");
+		return -1;
+	}
+
+	/* a clone has the edges of its parent, and edges of its own */
+	id = rte_node_from_name("test_graph_odd-c0");
+	if (id == RTE_NODE_ID_INVALID)
+		id = rte_node_clone(test_graph_odd.id, "c0");
+	name = rte_node_id_to_name(id);
+	if (id == RTE_NODE_ID_INVALID || name == NULL ||
+			strcmp(name, "test_graph_odd-c0") != 0 ||
+			rte_node_edge_count(id) != 1) {
+		printf("Bad clone\n");
+		return -1;
+	}
+	if (rte_node_clone(test_graph_odd.id, "c0") != RTE_NODE_ID_INVALID ||
+			rte_errno != EEXIST) {
+		printf("Clone of the same name created\n");
+		return -1;
+	}
+	if (rte_node_clone(id, "c1") != RTE_NODE_ID_INVALID) {
+		printf("Clone of a clone created\n");
+		return -1;
+	}
+	next_nodes[0] = "test_graph_even";
+	if (rte_node_edge_update(id, RTE_EDGE_ID_INVALID, next_nodes, 1) != 2 ||
+			rte_node_edge_get(id, next_nodes) != 2 ||
+			strcmp(next_nodes[1], "test_graph_even") != 0 ||
+			rte_node_edge_count(test_graph_odd.id) != 1) {
+		printf("Bad edge update\n");
+		return -1;
+	}
+	if (rte_node_edge_shrink(id, 1) != 1 ||
+			rte_node_edge_shrink(id, 2) != RTE_EDGE_ID_INVALID) {
+		printf("Bad edge shrink\n");
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_graph_create_fail(void)
+{
+	const char *sink = "test_graph_sink";
+	const char *none = "test_graph_none";
+	struct rte_graph_param prm = {
+		.socket_id = SOCKET_ID_ANY,
+		.nb_node_patterns = 1,
+	};
+
+	/* no source node */
+	prm.node_patterns = &sink;
+	if (rte_graph_create("test_graph_fail", &prm) !=
+			RTE_GRAPH_ID_INVALID) {
+		printf("Graph without source created\n");
+		return -1;
+	}
+	/* no node */
+	prm.node_patterns = &none;
+	if (rte_graph_create("test_graph_fail", &prm) !=
+			RTE_GRAPH_ID_INVALID || rte_errno != ENOENT) {
+		printf("Graph without node created\n");
+		return -1;
+	}
+	if (rte_graph_from_name("test_graph_fail") != RTE_GRAPH_ID_INVALID) {
+		printf("Failed graph found\n");
+		return -1;
+	}
+	return 0;
+}
+
+/* walk a graph, and check the sink got all the objects */
+static int
+test_graph_walk_check(struct rte_graph *graph, uint16_t nb_objs,
+		unsigned int nb_walks)
+{
+	uint64_t first = src_next_obj, last, sum;
+	unsigned int i;
+
+	nb_src_objs = nb_objs;
+	sink_objs = 0;
+	sink_sum = 0;
+	for (i = 0; i < nb_walks; i++)
+		rte_graph_walk(graph);
+
+	last = src_next_obj;
+	sum = (first + last - 1) * (last - first) / 2;
+	if (sink_objs != last - first || sink_sum != sum) {
+		printf("Sink got %" PRIu64 " objects summing to %" PRIu64
+			", expected %" PRIu64 " summing to %" PRIu64 "\n",
+			sink_objs, sink_sum, last - first, sum);
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_graph_walk(void)
+{
+	struct rte_graph_param prm = {
+		.socket_id = SOCKET_ID_ANY,
+		.nb_node_patterns = 1,
+		.node_patterns = test_graph_patterns,
+	};
+	struct rte_node *src, *sink;
+	struct rte_graph *graph;
+	rte_graph_t id;
+	int ret = -1;
+
+	nb_init = nb_fini = 0;
+	id = rte_graph_create("test_graph", &prm);
+	if (id == RTE_GRAPH_ID_INVALID) {
+		printf("Graph creation failed: %s\n", rte_strerror(rte_errno));
+		return -1;
+	}
+	if (nb_init != 4) {
+		printf("%u node inits, expected 4\n", nb_init);
+		goto out;
+	}
+	if (rte_graph_create("test_graph", &prm) != RTE_GRAPH_ID_INVALID ||
+			rte_errno != EEXIST) {
+		printf("Graph of the same name created\n");
+		goto out;
+	}
+
+	graph = rte_graph_lookup("test_graph");
+	src = rte_graph_node_get(id, test_graph_src.id);
+	sink = rte_graph_node_get_by_name("test_graph", "test_graph_sink");
+	if (graph == NULL || src == NULL || sink == NULL ||
+			rte_graph_from_name("test_graph") != id ||
+			rte_graph_node_get(id, rte_node_max_count()) != NULL) {
+		printf("Graph or node lookup failed\n");
+		goto out;
+	}
+
+	if (test_graph_walk_check(graph, 1, 1) < 0 ||
+			test_graph_walk_check(graph, 7, 10) < 0 ||
+			test_graph_walk_check(graph, RTE_GRAPH_BURST_SIZE,
+				10) < 0)
+		goto out;
+	if (sink->realloc_count != 0) {
+		printf("Stream grown for a burst\n");
+		goto out;
+	}
+
+	/* more than a burst: the streams grow */
+	if (test_graph_walk_check(graph, TEST_GRAPH_MAX_OBJS, 3) < 0)
+		goto out;
+	if (sink->realloc_count == 0 || sink->size < TEST_GRAPH_MAX_OBJS) {
+		printf("Stream not grown\n");
+		goto out;
+	}
+	if (test_graph_walk_check(graph, TEST_GRAPH_MAX_OBJS, 2) < 0)
+		goto out;
+
+#ifdef RTE_LIBRTE_GRAPH_STATS
+	if (src->total_calls != 1 + 10 + 10 + 3 + 2 ||
+			sink->total_objs != src->total_objs) {
+		printf("Bad node statistics\n");
+		goto out;
+	}
+#endif
+	rte_graph_dump(stdout, id);
+	ret = 0;
+out:
+	if (rte_graph_destroy(id) < 0 || nb_fini != nb_init ||
+			rte_graph_lookup("test_graph") != NULL) {
+		printf("Graph destruction failed\n");
+		ret = -1;
+	}
+	return ret;
+}
+
+struct test_graph_stats {
+	uint64_t objs;
+	unsigned int nb_nodes;
+	bool first, last;
+};
+
+static int
+test_graph_stats_cb(bool is_first, bool is_last, void *cookie,
+		const struct rte_graph_cluster_node_stats *stats)
+{
+	struct test_graph_stats *s = cookie;
+
+	if (is_first != (s->nb_nodes == 0))
+		return -1;
+	s->first |= is_first;
+	s->last = is_last;
+	s->nb_nodes++;
+	if (strcmp(stats->name, "test_graph_sink") == 0)
+		s->objs = stats->objs;
+	return 0;
+}
+
+static int
+test_graph_clone_stats(void)
+{
+	struct rte_graph_param prm = {
+		.socket_id = SOCKET_ID_ANY,
+		.nb_node_patterns = 1,
+		.node_patterns = test_graph_patterns,
+	};
+	const char *pattern = "test_graph*";
+	struct rte_graph_cluster_stats_param sprm = {
+		.socket_id = SOCKET_ID_ANY,
+		.fn = test_graph_stats_cb,
+		.nb_graph_patterns = 1,
+		.graph_patterns = &pattern,
+	};
+	struct rte_graph_cluster_stats *stats = NULL;
+	struct test_graph_stats s;
+	struct rte_graph *graph, *clone;
+	rte_graph_t id, clone_id = RTE_GRAPH_ID_INVALID;
+	char *buf = NULL;
+	size_t len;
+	FILE *f;
+	int ret = -1;
+
+	sprm.cookie = &s;
+	id = rte_graph_create("test_graph", &prm);
+	if (id == RTE_GRAPH_ID_INVALID)
+		return -1;
+	clone_id = rte_graph_clone(id, "1", SOCKET_ID_ANY);
+	graph = rte_graph_lookup("test_graph");
+	clone = rte_graph_lookup("test_graph-1");
+	if (clone_id == RTE_GRAPH_ID_INVALID || clone == NULL ||
+			clone == graph || rte_graph_max_count() < 2) {
+		printf("Graph clone failed\n");
+		goto out;
+	}
+
+	if (test_graph_walk_check(graph, 16, 4) < 0 ||
+			test_graph_walk_check(clone, 32, 4) < 0)
+		goto out;
+
+	stats = rte_graph_cluster_stats_create(&sprm);
+	if (stats == NULL) {
+		printf("Cluster stats creation failed\n");
+		goto out;
+	}
+	memset(&s, 0, sizeof(s));
+	rte_graph_cluster_stats_get(stats, false);
+	if (s.nb_nodes != 4 || !s.first || !s.last) {
+		printf("Stats callback called for %u nodes\n", s.nb_nodes);
+		goto out;
+	}
+#ifdef RTE_LIBRTE_GRAPH_STATS
+	if (s.objs != 16 * 4 + 32 * 4) {
+		printf("Sink stats %" PRIu64 " objects\n", s.objs);
+		goto out;
+	}
+	rte_graph_cluster_stats_reset(stats);
+	if (test_graph_walk_check(clone, 8, 1) < 0)
+		goto out;
+	memset(&s, 0, sizeof(s));
+	rte_graph_cluster_stats_get(stats, false);
+	if (s.objs != 8) {
+		printf("Sink stats %" PRIu64 " objects after reset\n", s.objs);
+		goto out;
+	}
+#endif
+
+	f = open_memstream(&buf, &len);
+	if (f == NULL)
+		goto out;
+	if (rte_graph_export("test_graph-1", f) < 0) {
+		fclose(f);
+		goto out;
+	}
+	fclose(f);
+	if (strstr(buf, "\"test_graph_odd\" -> \"test_graph_sink\"") ==
+			NULL) {
+		printf("Bad graph export:\n%s", buf);
+		goto out;
+	}
+	ret = 0;
+out:
+	free(buf);
+	rte_graph_cluster_stats_destroy(stats);
+	if (clone_id != RTE_GRAPH_ID_INVALID)
+		rte_graph_destroy(clone_id);
+	rte_graph_destroy(id);
+	return ret;
+}
+
+static int
+test_graph(void)
+{
+	if (test_graph_nodes() < 0)
+		return -1;
+	if (test_graph_create_fail() < 0)
+		return -1;
+	if (test_graph_walk() < 0)
+		return -1;
+	if (test_graph_clone_stats() < 0)
+		return -1;
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(graph_autotest, test_graph);
@@ -0,0 +1,323 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_ethdev.h>
+#include <rte_eth_ring.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_ip.h>
+#include <rte_lpm.h>
+#include <rte_mbuf.h>
+#include <rte_node_eth_api.h>
+#include <rte_node_ip4_api.h>
+#include <rte_ring.h>
+
+#include "test.h"
+
+/*
+ * Graph forwarding performance
+ * ============================
+ *
+ * IPv4 forwarding through a ring port, whose Tx ring is its Rx ring: the
+ * packets sent are received again, until their TTL runs out.
+ *
+ * - l3fwd: the loop of the LPM mode of examples/l3fwd, Rx burst, LPM
+ *   lookup, TTL decrement and Ethernet rewrite, Tx burst.
+ * - graph: a graph of the ethdev_rx, ip4_lookup, ip4_rewrite, ethdev_tx
+ *   and pkt_drop nodes.
+ *
+ * Both forward the same packets with the same routes, and drop them when
+ * their TTL runs out; the cycles per packet of each are printed. The
+ * graph is first checked to forward each packet once per pass, with the
+ * TTL, checksum and Ethernet header updated.
+ */
+
+#define PERF_NB_PKTS 1024
+#define PERF_RING_SIZE 4096
+#define PERF_NB_MBUF 2048
+#define PERF_TTL 200
+#define PERF_L3FWD_BURST 32
+#define PERF_NB_ROUTES 8
+#define PERF_GRAPH_NAME "graph_perf"
+
+static struct rte_mempool *perf_mp;
+static struct rte_ring *perf_ring;
+static struct rte_lpm *perf_lpm;
+static uint16_t perf_port = UINT16_MAX;
+static struct ether_addr perf_dst_addr = {
+	.addr_bytes = { 0x02, 0, 0, 0, 0, 0x01 },
+};
+
+/* destinations of the routes, the next hop of route i is i */
+static uint32_t
+perf_route(unsigned int i)
+{
+	return IPv4(i + 1, 1, 1, 0);
+}
+
+static int
+perf_port_setup(void)
+{
+	struct rte_node_ethdev_config ethdev_conf;
+	struct rte_lpm_config lpm_conf = {
+		.max_rules = 64,
+		.number_tbl8s = 16,
+	};
+	struct rte_eth_conf conf;
+	struct ether_addr src_addr;
+	uint8_t rewrite[2 * ETHER_ADDR_LEN];
+	unsigned int i;
+	int port;
+
+	/* nodes are cloned for the port once for all */
+	if (perf_port != UINT16_MAX)
+		return 0;
+
+	perf_mp = rte_pktmbuf_pool_create("graph_perf_pool", PERF_NB_MBUF,
+		32, 0, RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	perf_ring = rte_ring_create("graph_perf_ring", PERF_RING_SIZE,
+		SOCKET_ID_ANY, RING_F_SP_ENQ | RING_F_SC_DEQ);
+	perf_lpm = rte_lpm_create("graph_perf_lpm", SOCKET_ID_ANY, &lpm_conf);
+	if (perf_mp == NULL || perf_ring == NULL || perf_lpm == NULL) {
+		printf("Cannot allocate mbufs, ring or LPM\n");
+		return -1;
+	}
+
+	port = rte_eth_from_rings("net_graph_perf", &perf_ring, 1,
+		&perf_ring, 1, SOCKET_ID_ANY);
+	if (port < 0) {
+		printf("Cannot create ring port\n");
+		return -1;
+	}
+	memset(&conf, 0, sizeof(conf));
+	if (rte_eth_dev_configure(port, 1, 1, &conf) < 0 ||
+			rte_eth_rx_queue_setup(port, 0, PERF_RING_SIZE,
+				SOCKET_ID_ANY, NULL, perf_mp) < 0 ||
+			rte_eth_tx_queue_setup(port, 0, PERF_RING_SIZE,
+				SOCKET_ID_ANY, NULL) < 0 ||
+			rte_eth_dev_start(port) < 0) {
+		printf("Cannot start ring port\n");
+		return -1;
+	}
+	rte_eth_macaddr_get(port, &src_addr);
+
+	ethdev_conf.port_id = port;
+	ethdev_conf.num_rx_queues = 1;
+	ethdev_conf.num_tx_queues = 1;
+	if (rte_node_eth_config(&ethdev_conf, 1, 1) < 0) {
+		printf("Cannot configure ethdev nodes\n");
+		return -1;
+	}
+
+	memcpy(rewrite, &perf_dst_addr, ETHER_ADDR_LEN);
+	memcpy(rewrite + ETHER_ADDR_LEN, &src_addr, ETHER_ADDR_LEN);
+	for (i = 0; i < PERF_NB_ROUTES; i++) {
+		if (rte_lpm_add(perf_lpm, perf_route(i), 24, i) < 0 ||
+				rte_node_ip4_route_add(perf_route(i), 24, i,
+					RTE_NODE_IP4_LOOKUP_NEXT_REWRITE) < 0 ||
+				rte_node_ip4_rewrite_add(i, rewrite,
+					sizeof(rewrite), port) < 0) {
+			printf("Cannot add route %u\n", i);
+			return -1;
+		}
+	}
+	perf_port = port;
+	return 0;
+}
+
+/* fill the port ring with packets to the routes */
+static int
+perf_pkts_fill(void)
+{
+	struct rte_mbuf *m;
+	struct ether_hdr *eth;
+	struct ipv4_hdr *ip;
+	unsigned int i;
+
+	for (i = 0; i < PERF_NB_PKTS; i++) {
+		m = rte_pktmbuf_alloc(perf_mp);
+		if (m == NULL)
+			return -1;
+		eth = (struct ether_hdr *)rte_pktmbuf_append(m,
+			sizeof(*eth) + sizeof(*ip) + 18);
+		ip = (struct ipv4_hdr *)(eth + 1);
+		memset(eth, 0, sizeof(*eth));
+		eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+		memset(ip, 0, sizeof(*ip));
+		ip->version_ihl = 0x45;
+		ip->total_length = rte_cpu_to_be_16(sizeof(*ip) + 18);
+		ip->time_to_live = PERF_TTL;
+		ip->next_proto_id = IPPROTO_UDP;
+		ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+		ip->dst_addr = rte_cpu_to_be_32(perf_route(i %
+			PERF_NB_ROUTES) + (i & 0xff));
+		ip->hdr_checksum = rte_ipv4_cksum(ip);
+		if (rte_ring_enqueue(perf_ring, m) != 0) {
+			rte_pktmbuf_free(m);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/* forward each packet once through the graph, and check the rewrite */
+static int
+perf_graph_check(struct rte_graph *graph)
+{
+	struct ipv4_hdr *ip;
+	struct rte_mbuf *m;
+	void *obj;
+	unsigned int i, n = 0;
+	int ret = 0;
+
+	if (perf_pkts_fill() < 0)
+		return -1;
+	for (i = 0; i < PERF_NB_PKTS / RTE_GRAPH_BURST_SIZE; i++)
+		rte_graph_walk(graph);
+
+	while (rte_ring_dequeue(perf_ring, &obj) == 0) {
+		m = obj;
+		ip = rte_pktmbuf_mtod_offset(m, struct ipv4_hdr *,
+			sizeof(struct ether_hdr));
+		if (ip->time_to_live != PERF_TTL - 1 ||
+				rte_raw_cksum(ip, sizeof(*ip)) != 0xffff ||
+				!is_same_ether_addr(&perf_dst_addr,
+					rte_pktmbuf_mtod(m,
+						struct ether_addr *)))
+			ret = -1;
+		rte_pktmbuf_free(m);
+		n++;
+	}
+	if (ret < 0 || n != PERF_NB_PKTS) {
+		printf("Graph forwarded %u packets, %u expected, or bad ones\n",
+			n, PERF_NB_PKTS);
+		return -1;
+	}
+	return 0;
+}
+
+/* same processing as the LPM mode of l3fwd, until all TTLs run out */
+static void
+perf_l3fwd(void)
+{
+	struct rte_mbuf *pkts[PERF_L3FWD_BURST];
+	struct rte_mbuf *tx_pkts[PERF_L3FWD_BURST];
+	uint8_t rewrite[2 * ETHER_ADDR_LEN];
+	struct ether_hdr *eth;
+	struct ipv4_hdr *ip;
+	uint16_t n, i, nb_tx, sent;
+	uint32_t nh, csum;
+
+	memcpy(rewrite, &perf_dst_addr, ETHER_ADDR_LEN);
+	rte_eth_macaddr_get(perf_port,
+		(struct ether_addr *)(rewrite + ETHER_ADDR_LEN));
+
+	while ((n = rte_eth_rx_burst(perf_port, 0, pkts,
+			PERF_L3FWD_BURST)) != 0) {
+		nb_tx = 0;
+		for (i = 0; i < n; i++) {
+			eth = rte_pktmbuf_mtod(pkts[i], struct ether_hdr *);
+			ip = (struct ipv4_hdr *)(eth + 1);
+			if (eth->ether_type !=
+					rte_cpu_to_be_16(ETHER_TYPE_IPv4) ||
+					rte_lpm_lookup(perf_lpm,
+						rte_be_to_cpu_32(ip->dst_addr),
+						&nh) != 0 ||
+					ip->time_to_live <= 1) {
+				rte_pktmbuf_free(pkts[i]);
+				continue;
+			}
+			ip->time_to_live--;
+			csum = ip->hdr_checksum + rte_cpu_to_be_16(0x0100);
+			ip->hdr_checksum = csum + (csum >> 16);
+			memcpy(eth, rewrite, sizeof(rewrite));
+			tx_pkts[nb_tx++] = pkts[i];
+		}
+		sent = rte_eth_tx_burst(perf_port, 0, tx_pkts, nb_tx);
+		for (i = sent; i < nb_tx; i++)
+			rte_pktmbuf_free(tx_pkts[i]);
+	}
+}
+
+static void
+perf_graph(struct rte_graph *graph)
+{
+	while (rte_ring_count(perf_ring) != 0)
+		rte_graph_walk(graph);
+}
+
+static int
+perf_print(const char *name, uint64_t cycles)
+{
+	/* each packet is forwarded until its TTL is 1, then dropped */
+	printf("%s: %.1f cycles/packet\n", name,
+		(double)cycles / ((PERF_TTL - 1) * PERF_NB_PKTS));
+
+	if (rte_ring_count(perf_ring) != 0 ||
+			rte_mempool_in_use_count(perf_mp) != 0) {
+		printf("%s: packets lost\n", name);
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_graph_perf(void)
+{
+	struct rte_graph_param prm = {
+		.socket_id = SOCKET_ID_ANY,
+		.nb_node_patterns = 1,
+	};
+	char rx_node[RTE_NODE_NAMESIZE];
+	const char *pattern = rx_node;
+	struct rte_graph *graph;
+	rte_graph_t id;
+	uint64_t start;
+	int ret = -1;
+
+	if (perf_port_setup() < 0)
+		return -1;
+
+	snprintf(rx_node, sizeof(rx_node), "ethdev_rx-%u-0", perf_port);
+	prm.node_patterns = &pattern;
+	id = rte_graph_create(PERF_GRAPH_NAME, &prm);
+	if (id == RTE_GRAPH_ID_INVALID) {
+		printf("Cannot create graph: %s\n", rte_strerror(rte_errno));
+		return -1;
+	}
+	graph = rte_graph_lookup(PERF_GRAPH_NAME);
+	if (graph == NULL || perf_graph_check(graph) < 0)
+		goto out;
+
+	if (perf_pkts_fill() < 0)
+		goto out;
+	start = rte_rdtsc();
+	perf_l3fwd();
+	if (perf_print("l3fwd", rte_rdtsc() - start) < 0)
+		goto out;
+
+	if (perf_pkts_fill() < 0)
+		goto out;
+	start = rte_rdtsc();
+	perf_graph(graph);
+	if (perf_print("graph", rte_rdtsc() - start) < 0)
+		goto out;
+
+	rte_graph_dump(stdout, id);
+	ret = 0;
+out:
+	rte_graph_destroy(id);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(graph_perf_autotest, test_graph_perf);
@@ -33,6 +33,8 @@
 
 /* This test is for membership library's simple feature test */
 
+#include <inttypes.h>
+
 #include <rte_memcpy.h>
 #include <rte_malloc.h>
 #include <rte_member.h>
@@ -46,6 +48,7 @@
 struct rte_member_setsum *setsum_ht;
 struct rte_member_setsum *setsum_cache;
 struct rte_member_setsum *setsum_vbf;
+struct rte_member_setsum *setsum_sketch;
 
 /* 5-tuple key type */
 struct flow_key {
@@ -255,6 +258,31 @@ test_member_create_bad_param(void)
 			"name\n");
 		return -1;
 	}
+
+	bad_params.name = "bad_param6";
+	bad_params.type = RTE_MEMBER_TYPE_SKETCH;
+	bad_params.false_positive_rate = 0.01;
+	bad_params.error_rate = 0;
+	/* Test with 0 error rate for sketch should fail */
+	bad_setsum = rte_member_create(&bad_params);
+	if (bad_setsum != NULL) {
+		rte_member_free(bad_setsum);
+		printf("Impossible creating setsum successfully with invalid "
+			"error rate for sketch\n");
+		return -1;
+	}
+
+	bad_params.name = "bad_param7";
+	bad_params.error_rate = 0.001;
+	bad_params.top_k = RTE_MEMBER_SKETCH_TOPK_MAX + 1;
+	/* Test with too many heavy hitters for sketch should fail */
+	bad_setsum = rte_member_create(&bad_params);
+	if (bad_setsum != NULL) {
+		rte_member_free(bad_setsum);
+		printf("Impossible creating setsum successfully with too many "
+			"heavy hitters for sketch\n");
+		return -1;
+	}
 	printf("Expected error section end...\n");
 	rte_member_free(bad_setsum);
 	return 0;
@@ -694,12 +722,119 @@ test_member_loadfactor(void)
 	return 0;
 }
 
+#define SKETCH_BG_KEYS 1000
+#define SKETCH_ADD_STEP 100
+
+/*
+ * Sequence of operations for sketch setsummary
+ *
+ *  - add SKETCH_BG_KEYS background keys once each
+ *  - add sample key i (i + 1) * SKETCH_ADD_STEP times
+ *  - count estimates are within the error bound of the real counts
+ *  - heavy hitters are the sample keys
+ *  - delete a heavy hitter, reset
+ *  - byte counting sketch only counts bytes
+ */
+static int
+test_member_sketch(void)
+{
+	struct rte_member_parameters sketch_params = params;
+	struct flow_key bg_key;
+	void *hh_keys[NUM_SAMPLES];
+	uint64_t hh_counts[NUM_SAMPLES], count, real, total;
+	member_set_t set_id;
+	int i, j, n, ret;
+
+	sketch_params.name = "test_member_sketch";
+	sketch_params.type = RTE_MEMBER_TYPE_SKETCH;
+	sketch_params.key_len = sizeof(struct flow_key);
+	sketch_params.error_rate = 0.001;
+	sketch_params.false_positive_rate = 0.01;
+	sketch_params.top_k = NUM_SAMPLES;
+	sketch_params.extra_flag = RTE_MEMBER_SKETCH_ALWAYS_BOUNDED;
+	setsum_sketch = rte_member_create(&sketch_params);
+	TEST_ASSERT(setsum_sketch != NULL, "Creation of sketch fail");
+
+	memset(&bg_key, 0, sizeof(bg_key));
+	for (i = 0; i < SKETCH_BG_KEYS; i++) {
+		bg_key.ip_src = i;
+		ret = rte_member_add(setsum_sketch, &bg_key, 0);
+		TEST_ASSERT(ret == 0, "sketch add error");
+	}
+	total = SKETCH_BG_KEYS;
+	for (i = 0; i < NUM_SAMPLES; i++) {
+		for (j = 0; j < (i + 1) * SKETCH_ADD_STEP; j++)
+			rte_member_add(setsum_sketch, &keys[i], 0);
+		total += (i + 1) * SKETCH_ADD_STEP;
+	}
+
+	for (i = 0; i < NUM_SAMPLES; i++) {
+		real = (i + 1) * SKETCH_ADD_STEP;
+		ret = rte_member_query_count(setsum_sketch, &keys[i], &count);
+		TEST_ASSERT(ret == 0 && count >= real &&
+				count <= real + total * sketch_params.error_rate,
+				"sketch count estimate %"PRIu64" out of bounds "
+				"for real count %"PRIu64, count, real);
+
+		ret = rte_member_lookup(setsum_sketch, &keys[i], &set_id);
+		TEST_ASSERT(ret == 1 && set_id == 1,
+				"sketch heavy hitter lookup error");
+	}
+	ret = rte_member_lookup(setsum_sketch, &bg_key, &set_id);
+	TEST_ASSERT(ret == 0 && set_id == RTE_MEMBER_NO_MATCH,
+			"sketch background key is a heavy hitter");
+
+	n = rte_member_report_heavyhitter(setsum_sketch, hh_keys, hh_counts);
+	TEST_ASSERT(n == NUM_SAMPLES, "sketch heavy hitter report error");
+	for (i = 0; i < n; i++) {
+		ret = rte_member_query_count(setsum_sketch, hh_keys[i],
+				&count);
+		TEST_ASSERT(ret == 0 && count >= hh_counts[i],
+				"sketch heavy hitter count error");
+	}
+
+	ret = rte_member_add_byte_count(setsum_sketch, &keys[0], 64);
+	TEST_ASSERT(ret == -EINVAL, "byte count added to key count sketch");
+
+	ret = rte_member_delete(setsum_sketch, &keys[0], 0);
+	TEST_ASSERT(ret == 0, "sketch delete error");
+	ret = rte_member_lookup(setsum_sketch, &keys[0], &set_id);
+	TEST_ASSERT(ret == 0, "sketch deleted key is a heavy hitter");
+	ret = rte_member_delete(setsum_sketch, &keys[0], 0);
+	TEST_ASSERT(ret == -ENOENT, "sketch deleted key deleted again");
+	ret = rte_member_report_heavyhitter(setsum_sketch, hh_keys, NULL);
+	TEST_ASSERT(ret == NUM_SAMPLES - 1, "sketch heavy hitter report error");
+
+	rte_member_reset(setsum_sketch);
+	ret = rte_member_query_count(setsum_sketch, &keys[NUM_SAMPLES - 1],
+			&count);
+	TEST_ASSERT(ret == 0 && count == 0, "sketch reset error");
+	ret = rte_member_report_heavyhitter(setsum_sketch, hh_keys, NULL);
+	TEST_ASSERT(ret == 0, "sketch reset error");
+	rte_member_free(setsum_sketch);
+
+	sketch_params.extra_flag |= RTE_MEMBER_SKETCH_COUNT_BYTE;
+	setsum_sketch = rte_member_create(&sketch_params);
+	TEST_ASSERT(setsum_sketch != NULL, "Creation of byte sketch fail");
+
+	ret = rte_member_add(setsum_sketch, &keys[0], 0);
+	TEST_ASSERT(ret == -EINVAL, "key count added to byte count sketch");
+	rte_member_add_byte_count(setsum_sketch, &keys[0], 1500);
+	rte_member_add_byte_count(setsum_sketch, &keys[0], 64);
+	ret = rte_member_query_count(setsum_sketch, &keys[0], &count);
+	TEST_ASSERT(ret == 0 && count == 1564, "sketch byte count error");
+
+	printf("sketch test success\n");
+	return 0;
+}
+
 static void
 perform_free(void)
 {
 	rte_member_free(setsum_ht);
 	rte_member_free(setsum_cache);
 	rte_member_free(setsum_vbf);
+	rte_member_free(setsum_sketch);
 }
 
 static int
@@ -731,6 +866,10 @@ test_member(void)
 		perform_free();
 		return -1;
 	}
+	if (test_member_sketch() < 0) {
+		perform_free();
+		return -1;
+	}
 	if (test_member_loadfactor() < 0) {
 		rte_member_free(setsum_ht);
 		rte_member_free(setsum_cache);
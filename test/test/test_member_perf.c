@@ -641,6 +641,200 @@ run_all_tbl_perf_tests(void)
 	return 0;
 }
 
+#define SKETCH_KEYSIZE 13 /* IPv4 5-tuple, unpadded */
+#define SKETCH_ADDS (1 << 22)
+#define SKETCH_TOP_K 64
+#define SKETCH_ERROR_RATE 0.0001
+#define SKETCH_SAMPLE_RATE 0.125
+#define SKETCH_PKT_LEN(idx) (64 + ((idx) & 0x3FF))
+
+enum sketch_mode {
+	SKETCH_BOUNDED = 0,
+	SKETCH_SAMPLED,
+	SKETCH_BYTE,
+	NUM_SKETCH_MODE
+};
+
+static const char * const sketch_mode_names[NUM_SKETCH_MODE] = {
+	"bounded", "sampled", "byte"
+};
+
+/* Index in keys of each added key, with a skewed flow size distribution */
+uint32_t sketch_stream[SKETCH_ADDS];
+/* Real count, in keys and in bytes, of each key */
+uint64_t sketch_real[KEYS_TO_ADD][2];
+
+struct sketch_result {
+	uint64_t add;
+	uint64_t query;
+	uint64_t lookup_bulk;
+	double recall;
+	double error;
+};
+
+static int
+real_count_compare(const void *a, const void *b)
+{
+	const uint64_t *ca = a, *cb = b;
+
+	return (ca[0] < cb[0]) - (ca[0] > cb[0]);
+}
+
+static void
+setup_sketch_stream(void)
+{
+	unsigned int i, j;
+
+	for (i = 0; i < KEYS_TO_ADD; i++)
+		for (j = 0; j < SKETCH_KEYSIZE; j++)
+			keys[i][j] = rte_rand() & 0xFF;
+
+	/*
+	 * Halving the index range a random number of times makes key i
+	 * about twice as frequent as key 2 * i, a few keys take most of the
+	 * adds while most keys are seen only a few times.
+	 */
+	memset(sketch_real, 0, sizeof(sketch_real));
+	for (i = 0; i < SKETCH_ADDS; i++) {
+		uint32_t idx = rte_rand() % KEYS_TO_ADD;
+
+		idx >>= rte_rand() % 20;
+		sketch_stream[i] = idx;
+		sketch_real[idx][0]++;
+		sketch_real[idx][1] += SKETCH_PKT_LEN(i);
+	}
+}
+
+static int
+timed_sketch(enum sketch_mode mode, struct sketch_result *res)
+{
+	struct rte_member_setsum *setsum;
+	const void *keys_burst[BURST_SIZE];
+	member_set_t result[BURST_SIZE];
+	uint64_t (*top)[2], start_tsc, count, real;
+	unsigned int i, k, col = (mode == SKETCH_BYTE);
+	int ret;
+
+	member_params.name = "test_member_sketch";
+	member_params.type = RTE_MEMBER_TYPE_SKETCH;
+	member_params.key_len = SKETCH_KEYSIZE;
+	member_params.socket_id = test_socket_id;
+	member_params.false_positive_rate = 0.01;
+	member_params.error_rate = SKETCH_ERROR_RATE;
+	member_params.sample_rate = SKETCH_SAMPLE_RATE;
+	member_params.top_k = SKETCH_TOP_K;
+	member_params.extra_flag = 0;
+	if (mode != SKETCH_SAMPLED)
+		member_params.extra_flag |= RTE_MEMBER_SKETCH_ALWAYS_BOUNDED;
+	if (mode == SKETCH_BYTE)
+		member_params.extra_flag |= RTE_MEMBER_SKETCH_COUNT_BYTE;
+	setsum = rte_member_create(&member_params);
+	if (setsum == NULL) {
+		printf("sketch create fail\n");
+		return -1;
+	}
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < SKETCH_ADDS; i++) {
+		const void *key = keys[sketch_stream[i]];
+
+		if (mode == SKETCH_BYTE)
+			ret = rte_member_add_byte_count(setsum, key,
+					SKETCH_PKT_LEN(i));
+		else
+			ret = rte_member_add(setsum, key, 0);
+		if (ret < 0) {
+			printf("sketch add error %d\n", ret);
+			rte_member_free(setsum);
+			return -1;
+		}
+	}
+	res->add = (rte_rdtsc() - start_tsc) / SKETCH_ADDS;
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < KEYS_TO_ADD; i++)
+		rte_member_query_count(setsum, keys[i], &count);
+	res->query = (rte_rdtsc() - start_tsc) / KEYS_TO_ADD;
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < KEYS_TO_ADD / BURST_SIZE; i++) {
+		for (k = 0; k < BURST_SIZE; k++)
+			keys_burst[k] = keys[i * BURST_SIZE + k];
+		rte_member_lookup_bulk(setsum, keys_burst, BURST_SIZE, result);
+	}
+	res->lookup_bulk = (rte_rdtsc() - start_tsc) /
+		(KEYS_TO_ADD / BURST_SIZE * BURST_SIZE);
+
+	/*
+	 * Recall: share of the real top-k keys found as heavy hitters.
+	 * Error: average relative error of their count estimates.
+	 */
+	top = rte_malloc(NULL, sizeof(sketch_real), 0);
+	if (top == NULL) {
+		rte_member_free(setsum);
+		return -1;
+	}
+	for (i = 0; i < KEYS_TO_ADD; i++) {
+		top[i][0] = sketch_real[i][col];
+		top[i][1] = i;
+	}
+	qsort(top, KEYS_TO_ADD, sizeof(top[0]), real_count_compare);
+
+	res->recall = 0;
+	res->error = 0;
+	for (i = 0; i < SKETCH_TOP_K; i++) {
+		const void *key = keys[top[i][1]];
+
+		real = top[i][0];
+		rte_member_query_count(setsum, key, &count);
+		res->error += (count > real ? count - real : real - count) /
+			(double)real;
+		if (rte_member_lookup(setsum, key, result) == 1)
+			res->recall++;
+	}
+	res->recall /= SKETCH_TOP_K;
+	res->error /= SKETCH_TOP_K;
+
+	rte_free(top);
+	rte_member_free(setsum);
+	return 0;
+}
+
+static int
+run_sketch_perf_tests(void)
+{
+	struct sketch_result res[NUM_SKETCH_MODE];
+	unsigned int i;
+
+	printf("\nMeasuring sketch performance, please wait\n");
+	fflush(stdout);
+
+	setup_sketch_stream();
+	for (i = 0; i < NUM_SKETCH_MODE; i++)
+		if (timed_sketch(i, &res[i]) < 0) {
+			printf("<<<<<Test sketch failed in mode %s>>>>>\n",
+				sketch_mode_names[i]);
+			return -1;
+		}
+
+	printf("\nSketch results (in CPU cycles/operation), "
+		"top %u of %u keys\n", SKETCH_TOP_K, KEYS_TO_ADD);
+	printf("-----------------------------------\n");
+	printf("\n%-18s%-18s%-18s%-18s%-18s%-18s\n",
+			"mode", "Add", "Query", "Lookup_bulk", "topk_recall",
+			"topk_error");
+	for (i = 0; i < NUM_SKETCH_MODE; i++) {
+		printf("%-18s", sketch_mode_names[i]);
+		printf("%-18"PRIu64, res[i].add);
+		printf("%-18"PRIu64, res[i].query);
+		printf("%-18"PRIu64, res[i].lookup_bulk);
+		printf("%-18f", res[i].recall);
+		printf("%-18f", res[i].error);
+		printf("\n");
+	}
+	return 0;
+}
+
 static int
 test_member_perf(void)
 {
@@ -648,6 +842,9 @@ test_member_perf(void)
 	if (run_all_tbl_perf_tests() < 0)
 		return -1;
 
+	if (run_sketch_perf_tests() < 0)
+		return -1;
+
 	return 0;
 }
 
@@ -0,0 +1,188 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_memzone.h>
+#include <rte_malloc.h>
+
+#include "test.h"
+
+/*
+ * Memory hotplug
+ * ==============
+ *
+ * Needs the --mem-hotplug EAL option, the test is skipped without it.
+ *
+ * - Fill the heap of socket 0 with blocks, until it grows (first block
+ *   in new memory), and again until it grows a second time (last block).
+ *
+ * - Reserve a memzone, it is in the memory mapped last.
+ *
+ * - Free the blocks of the first growth: their memory is released, and
+ *   the memsegs of the second growth take the place of those released.
+ *   Check the memzone and the last block are still fine.
+ *
+ * - Free everything: the heap shrinks back.
+ */
+
+#define HOTPLUG_BLOCK_SIZE (1 << 20)
+#define HOTPLUG_MAX_BLOCKS 4096
+#define HOTPLUG_MZ_NAME "mem_hotplug_mz"
+
+static void *blocks[HOTPLUG_MAX_BLOCKS];
+
+static size_t
+heap_total(void)
+{
+	struct rte_malloc_socket_stats stats;
+
+	rte_malloc_get_socket_stats(0, &stats);
+	return stats.heap_totalsz_bytes;
+}
+
+/* allocate blocks from index first until the heap grows */
+static int
+fill_heap(unsigned int first, unsigned int *last)
+{
+	size_t total = heap_total();
+	unsigned int i;
+
+	for (i = first; i < HOTPLUG_MAX_BLOCKS; i++) {
+		blocks[i] = rte_malloc_socket(NULL, HOTPLUG_BLOCK_SIZE, 0, 0);
+		if (blocks[i] == NULL)
+			return -1;
+		memset(blocks[i], i, HOTPLUG_BLOCK_SIZE);
+		if (heap_total() != total) {
+			*last = i;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+static void
+free_blocks(unsigned int first, unsigned int last)
+{
+	unsigned int i;
+
+	for (i = first; i <= last && i < HOTPLUG_MAX_BLOCKS; i++) {
+		rte_free(blocks[i]);
+		blocks[i] = NULL;
+	}
+}
+
+static int
+check_block(unsigned int i)
+{
+	const uint8_t *p = blocks[i];
+	size_t j;
+
+	if (rte_malloc_validate(p, NULL) < 0) {
+		printf("Bad malloc metadata of block %u\n", i);
+		return -1;
+	}
+	for (j = 0; j < HOTPLUG_BLOCK_SIZE; j += RTE_PGSIZE_4K)
+		if (p[j] != (uint8_t)i) {
+			printf("Block %u data lost at offset %zu\n", i, j);
+			return -1;
+		}
+	return 0;
+}
+
+static int
+check_memzone(const struct rte_memzone *mz, rte_iova_t iova)
+{
+	const struct rte_memseg *ms = rte_eal_get_physmem_layout();
+	const uint8_t *p = mz->addr;
+	size_t i;
+
+	if (rte_memzone_lookup(HOTPLUG_MZ_NAME) != mz) {
+		printf("Memzone lookup failed\n");
+		return -1;
+	}
+	if (mz->memseg_id >= RTE_MAX_MEMSEG ||
+			mz->addr_64 < ms[mz->memseg_id].addr_64 ||
+			mz->addr_64 + mz->len > ms[mz->memseg_id].addr_64 +
+				ms[mz->memseg_id].len) {
+		printf("Memzone not in memseg %u\n", mz->memseg_id);
+		return -1;
+	}
+	if (rte_malloc_validate(mz->addr, NULL) < 0 ||
+			rte_malloc_virt2iova(mz->addr) != iova) {
+		printf("Bad malloc metadata of the memzone\n");
+		return -1;
+	}
+	for (i = 0; i < mz->len; i += RTE_PGSIZE_4K)
+		if (p[i] != (uint8_t)(i >> 12)) {
+			printf("Memzone data lost at offset %zu\n", i);
+			return -1;
+		}
+	return 0;
+}
+
+static int
+test_memory_hotplug(void)
+{
+	const struct rte_memzone *mz = NULL;
+	unsigned int grown, last = 0;
+	size_t total, peak;
+	rte_iova_t iova;
+	size_t i;
+
+	total = heap_total();
+
+	if (fill_heap(0, &grown) < 0) {
+		printf("Heap did not grow, no memory hotplug\n");
+		free_blocks(0, HOTPLUG_MAX_BLOCKS - 1);
+		return TEST_SKIPPED;
+	}
+	if (fill_heap(grown + 1, &last) < 0) {
+		printf("Heap did not grow a second time\n");
+		goto fail;
+	}
+
+	mz = rte_memzone_reserve(HOTPLUG_MZ_NAME, HOTPLUG_BLOCK_SIZE, 0, 0);
+	if (mz == NULL) {
+		printf("Could not reserve memzone\n");
+		goto fail;
+	}
+	for (i = 0; i < mz->len; i += RTE_PGSIZE_4K)
+		((uint8_t *)mz->addr)[i] = i >> 12;
+	iova = rte_malloc_virt2iova(mz->addr);
+	peak = heap_total();
+
+	free_blocks(grown, last - 1);
+	if (heap_total() >= peak) {
+		printf("Heap did not shrink after free\n");
+		goto fail;
+	}
+	if (check_memzone(mz, iova) < 0 || check_block(last) < 0)
+		goto fail;
+
+	rte_memzone_free(mz);
+	mz = NULL;
+	if (rte_memzone_lookup(HOTPLUG_MZ_NAME) != NULL) {
+		printf("Memzone still found after free\n");
+		goto fail;
+	}
+	free_blocks(0, last);
+	if (heap_total() != total) {
+		printf("Heap total %zu after free, was %zu\n", heap_total(),
+			total);
+		return -1;
+	}
+	return 0;
+
+fail:
+	rte_memzone_free(mz);
+	free_blocks(0, last > grown ? last : grown);
+	return -1;
+}
+
+REGISTER_TEST_COMMAND(mem_hotplug_autotest, test_memory_hotplug);
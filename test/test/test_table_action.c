@@ -0,0 +1,891 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_byteorder.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+#include <rte_port_ring.h>
+#include <rte_table_array.h>
+#include <rte_pipeline.h>
+#include <rte_table_action.h>
+
+#include "test.h"
+
+/*
+ * Table action
+ * ============
+ *
+ * - Profile and action object argument checks.
+ * - A pipeline made of a ring input port, an array table whose entry 0 is
+ *   hit by all the packets, and a ring output port. The table entry is
+ *   written by the table action object, the packets received on the
+ *   output ring and the entry counters are checked for:
+ *   . all the actions on IPv4/UDP packets (generic action handler),
+ *   . forward, TTL and statistics on IPv4 (specialized action handler),
+ *   . NAT on IPv6/TCP packets.
+ */
+
+#define TA_NB_MBUF 256
+#define TA_RING_SIZE 64
+#define TA_BURST_SIZE 8
+#define TA_NB_PKTS 16
+#define TA_PAYLOAD_SIZE 18
+
+/* packet meta-data: offsets from the mbuf start, in the mbuf headroom */
+#define TA_MD_OFFSET(offset) (sizeof(struct rte_mbuf) + (offset))
+#define TA_KEY_OFFSET TA_MD_OFFSET(0)
+#define TA_LB_OUT_OFFSET TA_MD_OFFSET(8)
+#define TA_IP_OFFSET (TA_MD_OFFSET(RTE_PKTMBUF_HEADROOM) + \
+	sizeof(struct ether_hdr))
+
+#define TA_NAT_IPV4 IPv4(100, 0, 0, 1)
+#define TA_NAT_PORT 2000
+#define TA_VLAN_ID 100
+#define TA_TTL 64
+
+static struct rte_mempool *ta_mp;
+static struct rte_ring *ta_ring_in;
+static struct rte_ring *ta_ring_out;
+
+struct ta_pipeline {
+	struct rte_pipeline *p;
+	uint32_t table_id;
+	struct rte_pipeline_table_entry *entry;
+};
+
+static const uint8_t ta_nat_ipv6[16] = {
+	0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01,
+};
+
+static uint64_t
+ta_hash(void *key, __rte_unused void *key_mask, uint32_t key_size,
+	uint64_t seed)
+{
+	uint8_t *k = key;
+	uint64_t h = seed;
+	uint32_t i;
+
+	for (i = 0; i < key_size; i++)
+		h = h * 31 + k[i];
+	return h;
+}
+
+static int
+ta_setup(void)
+{
+	if (ta_mp != NULL)
+		return 0;
+
+	ta_mp = rte_pktmbuf_pool_create("table_action_pool", TA_NB_MBUF, 32,
+		0, RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	ta_ring_in = rte_ring_create("table_action_in", TA_RING_SIZE,
+		SOCKET_ID_ANY, RING_F_SP_ENQ | RING_F_SC_DEQ);
+	ta_ring_out = rte_ring_create("table_action_out", TA_RING_SIZE,
+		SOCKET_ID_ANY, RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (ta_mp == NULL || ta_ring_in == NULL || ta_ring_out == NULL) {
+		printf("Cannot allocate mbufs or rings\n");
+		return -1;
+	}
+	return 0;
+}
+
+/* IPv4 or IPv6 packet with the given L4 protocol, DSCP and TTL */
+static struct rte_mbuf *
+ta_pkt_build(int ipv4, uint8_t proto, uint8_t dscp, uint8_t ttl,
+	uint32_t id)
+{
+	size_t l4_size = (proto == IPPROTO_TCP) ? sizeof(struct tcp_hdr) :
+		sizeof(struct udp_hdr);
+	size_t ip_size = ipv4 ? sizeof(struct ipv4_hdr) :
+		sizeof(struct ipv6_hdr);
+	struct rte_mbuf *m;
+	struct ether_hdr *eth;
+	void *ip, *l4;
+
+	m = rte_pktmbuf_alloc(ta_mp);
+	if (m == NULL)
+		return NULL;
+	eth = (struct ether_hdr *)rte_pktmbuf_append(m, sizeof(*eth) +
+		ip_size + l4_size + TA_PAYLOAD_SIZE);
+	memset(eth, 0, rte_pktmbuf_data_len(m));
+	ip = RTE_PTR_ADD(eth, sizeof(*eth));
+	l4 = RTE_PTR_ADD(ip, ip_size);
+
+	if (ipv4) {
+		struct ipv4_hdr *ip4 = ip;
+
+		eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+		ip4->version_ihl = 0x45;
+		ip4->packet_id = rte_cpu_to_be_16(id);
+		ip4->type_of_service = dscp << 2;
+		ip4->total_length = rte_cpu_to_be_16(ip_size + l4_size +
+			TA_PAYLOAD_SIZE);
+		ip4->time_to_live = ttl;
+		ip4->next_proto_id = proto;
+		ip4->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1 + id));
+		ip4->dst_addr = rte_cpu_to_be_32(IPv4(20, 0, 0, 1));
+		ip4->hdr_checksum = rte_ipv4_cksum(ip4);
+	} else {
+		struct ipv6_hdr *ip6 = ip;
+
+		eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv6);
+		ip6->vtc_flow = rte_cpu_to_be_32((6 << 28) | (dscp << 22));
+		ip6->payload_len = rte_cpu_to_be_16(l4_size + TA_PAYLOAD_SIZE);
+		ip6->proto = proto;
+		ip6->hop_limits = ttl;
+		ip6->src_addr[0] = 0xfd;
+		ip6->src_addr[15] = 1 + id;
+		ip6->dst_addr[0] = 0xfd;
+		ip6->dst_addr[15] = 0xff;
+	}
+
+	if (proto == IPPROTO_TCP) {
+		struct tcp_hdr *tcp = l4;
+
+		tcp->src_port = rte_cpu_to_be_16(1024 + id);
+		tcp->dst_port = rte_cpu_to_be_16(80);
+		tcp->data_off = (sizeof(*tcp) / 4) << 4;
+		tcp->cksum = ipv4 ? rte_ipv4_udptcp_cksum(ip, l4) :
+			rte_ipv6_udptcp_cksum(ip, l4);
+	} else {
+		struct udp_hdr *udp = l4;
+
+		udp->src_port = rte_cpu_to_be_16(1024 + id);
+		udp->dst_port = rte_cpu_to_be_16(80);
+		udp->dgram_len = rte_cpu_to_be_16(l4_size + TA_PAYLOAD_SIZE);
+		udp->dgram_cksum = ipv4 ? rte_ipv4_udptcp_cksum(ip, l4) :
+			rte_ipv6_udptcp_cksum(ip, l4);
+	}
+
+	/* all the packets hit the table entry 0 */
+	*RTE_MBUF_METADATA_UINT32_PTR(m, TA_KEY_OFFSET) = 0;
+	return m;
+}
+
+/* check the L4 checksum, 0 and 0xffff are the same checksum */
+static int
+ta_l4_cksum_ok(void *ip, int ipv4, uint8_t proto, void *l4)
+{
+	uint16_t *cksum = RTE_PTR_ADD(l4, (proto == IPPROTO_TCP) ?
+		offsetof(struct tcp_hdr, cksum) :
+		offsetof(struct udp_hdr, dgram_cksum));
+	uint16_t expected, found = *cksum;
+
+	*cksum = 0;
+	expected = ipv4 ? rte_ipv4_udptcp_cksum(ip, l4) :
+		rte_ipv6_udptcp_cksum(ip, l4);
+	*cksum = found;
+
+	if (found == 0)
+		found = 0xffff;
+	return found == expected;
+}
+
+static int
+ta_pipeline_create(struct ta_pipeline *tp, struct rte_table_action *action,
+	struct rte_pipeline_table_entry *entry)
+{
+	struct rte_pipeline_params pipeline_params = {
+		.name = "table_action",
+	};
+	struct rte_port_ring_reader_params reader_params = {
+		.ring = ta_ring_in,
+	};
+	struct rte_pipeline_port_in_params port_in_params = {
+		.ops = &rte_port_ring_reader_ops,
+		.arg_create = &reader_params,
+		.burst_size = TA_BURST_SIZE,
+	};
+	struct rte_port_ring_writer_params writer_params = {
+		.ring = ta_ring_out,
+		.tx_burst_sz = TA_BURST_SIZE,
+	};
+	struct rte_pipeline_port_out_params port_out_params = {
+		.ops = &rte_port_ring_writer_ops,
+		.arg_create = &writer_params,
+	};
+	struct rte_table_array_params array_params = {
+		.n_entries = 16,
+		.offset = TA_KEY_OFFSET,
+	};
+	struct rte_pipeline_table_params table_params = {
+		.ops = &rte_table_array_ops,
+		.arg_create = &array_params,
+	};
+	struct rte_pipeline_table_entry default_entry = {
+		.action = RTE_PIPELINE_ACTION_DROP,
+	};
+	struct rte_pipeline_table_entry *default_entry_ptr;
+	struct rte_table_action_fwd_params fwd = {
+		.action = RTE_PIPELINE_ACTION_PORT,
+	};
+	struct rte_table_array_key key = { .pos = 0 };
+	uint32_t port_in_id;
+	int key_found;
+
+	memset(tp, 0, sizeof(*tp));
+	pipeline_params.socket_id = rte_socket_id();
+	tp->p = rte_pipeline_create(&pipeline_params);
+	if (tp->p == NULL)
+		return -1;
+
+	if (rte_table_action_table_params_get(action, &table_params) ||
+			rte_pipeline_port_in_create(tp->p, &port_in_params,
+				&port_in_id) ||
+			rte_pipeline_port_out_create(tp->p, &port_out_params,
+				&fwd.id) ||
+			rte_pipeline_table_create(tp->p, &table_params,
+				&tp->table_id) ||
+			rte_pipeline_port_in_connect_to_table(tp->p, port_in_id,
+				tp->table_id) ||
+			rte_pipeline_table_default_entry_add(tp->p,
+				tp->table_id, &default_entry,
+				&default_entry_ptr) ||
+			rte_pipeline_port_in_enable(tp->p, port_in_id) ||
+			rte_pipeline_check(tp->p)) {
+		printf("Cannot create pipeline\n");
+		return -1;
+	}
+
+	if (rte_table_action_apply(action, entry, RTE_TABLE_ACTION_FWD,
+			&fwd) ||
+			rte_pipeline_table_entry_add(tp->p, tp->table_id, &key,
+				entry, &key_found, &tp->entry)) {
+		printf("Cannot add table entry\n");
+		return -1;
+	}
+	return 0;
+}
+
+/* run the packets through the pipeline, return the number received */
+static int
+ta_pipeline_run(struct ta_pipeline *tp, struct rte_mbuf **pkts,
+	unsigned int n_pkts, struct rte_mbuf **out)
+{
+	unsigned int i;
+
+	if (rte_ring_enqueue_bulk(ta_ring_in, (void **)pkts, n_pkts,
+			NULL) != n_pkts) {
+		printf("Cannot enqueue packets\n");
+		return -1;
+	}
+	for (i = 0; i < n_pkts / TA_BURST_SIZE + 1; i++)
+		rte_pipeline_run(tp->p);
+	rte_pipeline_flush(tp->p);
+
+	return rte_ring_dequeue_burst(ta_ring_out, (void **)out, n_pkts, NULL);
+}
+
+static void
+ta_pkts_free(struct rte_mbuf **pkts, int n_pkts)
+{
+	int i;
+
+	for (i = 0; i < n_pkts; i++)
+		rte_pktmbuf_free(pkts[i]);
+}
+
+static int
+test_table_action_profile(void)
+{
+	struct rte_table_action_common_config common = {
+		.ip_version = 1,
+		.ip_offset = TA_IP_OFFSET,
+	};
+	struct rte_table_action_lb_config lb = {
+		.key_size = 12,
+		.f_hash = ta_hash,
+	};
+	struct rte_table_action_mtr_config mtr = {
+		.alg = RTE_TABLE_ACTION_METER_TRTCM,
+		.n_tc = 2,
+	};
+	struct rte_table_action_encap_config encap = {
+		.encap_mask = 1LLU << RTE_TABLE_ACTION_ENCAP_VLAN,
+	};
+	struct rte_table_action_nat_config nat = {
+		.source_nat = 1,
+		.proto = IPPROTO_ICMP,
+	};
+	struct rte_table_action_stats_config stats = {
+		.n_packets_enabled = 1,
+	};
+	struct rte_table_action_stats_counters counters;
+	struct rte_table_action_profile *ap;
+	struct rte_table_action *action;
+	uint8_t data[128];
+	int ret = -1;
+
+	if (rte_table_action_profile_create(NULL) != NULL) {
+		printf("Profile created without common configuration\n");
+		return -1;
+	}
+
+	ap = rte_table_action_profile_create(&common);
+	if (ap == NULL) {
+		printf("Cannot create profile\n");
+		return -1;
+	}
+
+	/* invalid action configurations */
+	if (rte_table_action_profile_action_register(ap,
+			RTE_TABLE_ACTION_LB, &lb) == 0 ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_MTR, &mtr) == 0 ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_NAT, &nat) == 0 ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_STATS, NULL) == 0) {
+		printf("Invalid action configuration accepted\n");
+		goto out;
+	}
+
+	/* no action object from a profile not frozen */
+	if (rte_table_action_profile_action_register(ap,
+			RTE_TABLE_ACTION_STATS, &stats) ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_STATS, &stats) == 0 ||
+			rte_table_action_create(ap, SOCKET_ID_ANY) != NULL) {
+		printf("Action registered twice or profile not frozen\n");
+		goto out;
+	}
+
+	/* the encapsulation header does not fit before the IP header */
+	common.ip_offset = sizeof(struct rte_mbuf);
+	rte_table_action_profile_free(ap);
+	ap = rte_table_action_profile_create(&common);
+	if (ap == NULL ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_ENCAP, &encap) ||
+			rte_table_action_profile_freeze(ap) == 0) {
+		printf("Encapsulation header beyond the mbuf accepted\n");
+		goto out;
+	}
+
+	rte_table_action_profile_free(ap);
+	common.ip_offset = TA_IP_OFFSET;
+	ap = rte_table_action_profile_create(&common);
+	if (ap == NULL ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_STATS, &stats) ||
+			rte_table_action_profile_freeze(ap) ||
+			rte_table_action_profile_freeze(ap) == 0 ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_TTL, NULL) == 0) {
+		printf("Cannot freeze profile or frozen profile changed\n");
+		goto out;
+	}
+
+	action = rte_table_action_create(ap, SOCKET_ID_ANY);
+	if (action == NULL) {
+		printf("Cannot create action\n");
+		goto out;
+	}
+
+	/* actions not in the profile */
+	memset(data, 0, sizeof(data));
+	if (rte_table_action_apply(action, data, RTE_TABLE_ACTION_STATS,
+			NULL) ||
+			rte_table_action_stats_read(action, data, &counters,
+				0) ||
+			rte_table_action_ttl_read(action, data, NULL, 0) !=
+				-EINVAL ||
+			rte_table_action_apply(action, data,
+				RTE_TABLE_ACTION_ENCAP, &encap) != -EINVAL) {
+		printf("Action not in the profile accepted\n");
+		goto free_action;
+	}
+
+	if (counters.n_packets != 0 || counters.n_packets_valid == 0 ||
+			counters.n_bytes_valid != 0) {
+		printf("Bad statistics counters\n");
+		goto free_action;
+	}
+
+	ret = 0;
+free_action:
+	rte_table_action_free(action);
+out:
+	rte_table_action_profile_free(ap);
+	return ret;
+}
+
+/* all the actions, IPv4/UDP packets: the packets with DSCP 1 are red and
+ * dropped by the policer, the one with TTL 1 dropped by the TTL action
+ */
+static int
+test_table_action_all(void)
+{
+	struct rte_table_action_common_config common = {
+		.ip_version = 1,
+		.ip_offset = TA_IP_OFFSET,
+	};
+	struct rte_table_action_lb_config lb = {
+		.key_size = 8,
+		.key_offset = TA_IP_OFFSET + offsetof(struct ipv4_hdr,
+			src_addr),
+		.f_hash = ta_hash,
+		.seed = 0,
+		.out_offset = TA_LB_OUT_OFFSET,
+	};
+	struct rte_table_action_mtr_config mtr = {
+		.alg = RTE_TABLE_ACTION_METER_TRTCM,
+		.n_tc = 1,
+	};
+	struct rte_table_action_encap_config encap = {
+		.encap_mask = (1LLU << RTE_TABLE_ACTION_ENCAP_ETHER) |
+			(1LLU << RTE_TABLE_ACTION_ENCAP_VLAN),
+	};
+	struct rte_table_action_nat_config nat = {
+		.source_nat = 1,
+		.proto = IPPROTO_UDP,
+	};
+	struct rte_table_action_ttl_config ttl = {
+		.drop = 1,
+	};
+	struct rte_table_action_stats_config stats = {
+		.n_packets_enabled = 1,
+		.n_bytes_enabled = 1,
+	};
+	struct rte_table_action_lb_params lb_params = {
+		.out = { 10, 11, 12, 13, 14, 15, 16, 17 },
+	};
+	struct rte_table_action_mtr_params mtr_params = {
+		.mtr[0] = {
+			.meter = {
+				.cir = UINT32_MAX,
+				.pir = UINT32_MAX,
+				.cbs = 1 << 20,
+				.pbs = 1 << 20,
+			},
+			.policer = {
+				RTE_TABLE_ACTION_POLICER_COLOR_GREEN,
+				RTE_TABLE_ACTION_POLICER_COLOR_YELLOW,
+				RTE_TABLE_ACTION_POLICER_DROP,
+			},
+		},
+		.tc_mask = 1,
+	};
+	struct rte_table_action_encap_params encap_params = {
+		.type = RTE_TABLE_ACTION_ENCAP_VLAN,
+		.vlan = {
+			.ether = {
+				.da = {{ 0x02, 0, 0, 0, 0, 0x01 }},
+				.sa = {{ 0x02, 0, 0, 0, 0, 0x02 }},
+			},
+			.vlan = { .pcp = 3, .vid = TA_VLAN_ID },
+		},
+	};
+	struct rte_table_action_nat_params nat_params = {
+		.ip_version = 1,
+		.addr.ipv4 = TA_NAT_IPV4,
+		.port = TA_NAT_PORT,
+	};
+	struct rte_table_action_ttl_params ttl_params = {
+		.decrement = 1,
+	};
+	struct rte_table_action_dscp_table dscp_table;
+	struct rte_table_action_mtr_counters mtr_counters;
+	struct rte_table_action_ttl_counters ttl_counters;
+	struct rte_table_action_stats_counters stats_counters;
+	struct rte_mbuf *pkts[TA_NB_PKTS], *out[TA_NB_PKTS];
+	struct rte_table_action_profile *ap;
+	struct rte_table_action *action = NULL;
+	struct ta_pipeline tp = { .p = NULL };
+	struct rte_pipeline_table_params table_params;
+	uint64_t entry_data[128], timestamp;
+	uint32_t pkt_len = 0;
+	int i, n = 0, ret = -1;
+
+	ap = rte_table_action_profile_create(&common);
+	if (ap == NULL ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_FWD, NULL) ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_LB, &lb) ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_MTR, &mtr) ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_ENCAP, &encap) ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_NAT, &nat) ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_TTL, &ttl) ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_STATS, &stats) ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_TIME, NULL) ||
+			rte_table_action_profile_freeze(ap)) {
+		printf("Cannot create profile\n");
+		goto out;
+	}
+	action = rte_table_action_create(ap, SOCKET_ID_ANY);
+	if (action == NULL ||
+			rte_table_action_table_params_get(action,
+				&table_params) ||
+			table_params.action_data_size + sizeof(entry_data[0]) >
+				sizeof(entry_data))
+		goto out;
+
+	/* DSCP 1 is red, the others green */
+	memset(&dscp_table, 0, sizeof(dscp_table));
+	dscp_table.entry[1].color = e_RTE_METER_RED;
+	if (rte_table_action_dscp_table_update(action, UINT64_MAX,
+			&dscp_table)) {
+		printf("Cannot update DSCP table\n");
+		goto out;
+	}
+
+	memset(entry_data, 0, sizeof(entry_data));
+	if (rte_table_action_apply(action, entry_data, RTE_TABLE_ACTION_LB,
+				&lb_params) ||
+			rte_table_action_apply(action, entry_data,
+				RTE_TABLE_ACTION_MTR, &mtr_params) ||
+			rte_table_action_apply(action, entry_data,
+				RTE_TABLE_ACTION_ENCAP, &encap_params) ||
+			rte_table_action_apply(action, entry_data,
+				RTE_TABLE_ACTION_NAT, &nat_params) ||
+			rte_table_action_apply(action, entry_data,
+				RTE_TABLE_ACTION_TTL, &ttl_params) ||
+			rte_table_action_apply(action, entry_data,
+				RTE_TABLE_ACTION_STATS, NULL) ||
+			rte_table_action_apply(action, entry_data,
+				RTE_TABLE_ACTION_TIME, NULL)) {
+		printf("Cannot apply actions\n");
+		goto out;
+	}
+
+	if (ta_pipeline_create(&tp, action,
+			(struct rte_pipeline_table_entry *)entry_data) < 0)
+		goto out;
+
+	for (i = 0; i < TA_NB_PKTS; i++) {
+		pkts[i] = ta_pkt_build(1, IPPROTO_UDP, (i % 4 == 3) ? 1 : 0,
+			(i == 0) ? 1 : TA_TTL, i);
+		if (pkts[i] == NULL) {
+			ta_pkts_free(pkts, i);
+			goto out;
+		}
+		pkt_len = rte_pktmbuf_data_len(pkts[i]) -
+			sizeof(struct ether_hdr);
+	}
+
+	/* 4 red packets dropped, then the one expired */
+	n = ta_pipeline_run(&tp, pkts, TA_NB_PKTS, out);
+	if (n != TA_NB_PKTS - 5) {
+		printf("Received %d packets, %d expected\n", n,
+			TA_NB_PKTS - 5);
+		goto out;
+	}
+
+	for (i = 0; i < n; i++) {
+		struct ether_hdr *eth = rte_pktmbuf_mtod(out[i],
+			struct ether_hdr *);
+		struct vlan_hdr *vlan = (struct vlan_hdr *)(eth + 1);
+		struct ipv4_hdr *ip = (struct ipv4_hdr *)(vlan + 1);
+		struct udp_hdr *udp = (struct udp_hdr *)(ip + 1);
+		uint32_t id = rte_be_to_cpu_16(ip->packet_id);
+		uint32_t lb_out = *RTE_MBUF_METADATA_UINT32_PTR(out[i],
+			TA_LB_OUT_OFFSET);
+		uint32_t lb_key[2];
+
+		/* LB hashes the addresses before NAT */
+		lb_key[0] = rte_cpu_to_be_32(IPv4(10, 0, 0, 1 + id));
+		lb_key[1] = ip->dst_addr;
+		if (rte_pktmbuf_data_len(out[i]) != pkt_len + sizeof(*eth) +
+				sizeof(*vlan) ||
+				rte_pktmbuf_pkt_len(out[i]) !=
+					rte_pktmbuf_data_len(out[i]) ||
+				eth->ether_type !=
+					rte_cpu_to_be_16(ETHER_TYPE_VLAN) ||
+				vlan->vlan_tci != rte_cpu_to_be_16((3 << 13) |
+					TA_VLAN_ID) ||
+				vlan->eth_proto !=
+					rte_cpu_to_be_16(ETHER_TYPE_IPv4) ||
+				lb_out != lb_params.out[ta_hash(lb_key, NULL,
+					sizeof(lb_key), lb.seed) & 7]) {
+			printf("Bad Ethernet header or LB output\n");
+			goto out;
+		}
+
+		if (ip->src_addr != rte_cpu_to_be_32(TA_NAT_IPV4) ||
+				ip->time_to_live != TA_TTL - 1 ||
+				rte_raw_cksum(ip, sizeof(*ip)) != 0xffff ||
+				udp->src_port !=
+					rte_cpu_to_be_16(TA_NAT_PORT) ||
+				!ta_l4_cksum_ok(ip, 1, IPPROTO_UDP, udp)) {
+			printf("Bad IPv4 or UDP header\n");
+			goto out;
+		}
+	}
+
+	if (rte_table_action_meter_read(action, tp.entry, 1, &mtr_counters,
+				1) ||
+			mtr_counters.stats[0].n_packets[e_RTE_METER_GREEN] !=
+				TA_NB_PKTS - 4 ||
+			mtr_counters.stats[0].n_packets_dropped != 4 ||
+			mtr_counters.stats[0].n_bytes[e_RTE_METER_GREEN] !=
+				(TA_NB_PKTS - 4) * pkt_len ||
+			rte_table_action_meter_read(action, tp.entry, 1,
+				&mtr_counters, 0) ||
+			mtr_counters.stats[0].n_packets_dropped != 0) {
+		printf("Bad meter counters\n");
+		goto out;
+	}
+
+	if (rte_table_action_ttl_read(action, tp.entry, &ttl_counters, 0) ||
+			ttl_counters.n_packets != 1 ||
+			rte_table_action_stats_read(action, tp.entry,
+				&stats_counters, 0) ||
+			stats_counters.n_packets != TA_NB_PKTS ||
+			stats_counters.n_bytes != TA_NB_PKTS * pkt_len ||
+			rte_table_action_time_read(action, tp.entry,
+				&timestamp) ||
+			timestamp == 0) {
+		printf("Bad TTL, statistics or time stamp\n");
+		goto out;
+	}
+
+	ret = 0;
+out:
+	ta_pkts_free(out, n);
+	rte_pipeline_free(tp.p);
+	rte_table_action_free(action);
+	rte_table_action_profile_free(ap);
+	return ret;
+}
+
+/* forward, TTL and statistics (specialized handler), expired packets are
+ * counted but not dropped
+ */
+static int
+test_table_action_ttl(void)
+{
+	struct rte_table_action_common_config common = {
+		.ip_version = 1,
+		.ip_offset = TA_IP_OFFSET,
+	};
+	struct rte_table_action_ttl_config ttl = {
+		.drop = 0,
+	};
+	struct rte_table_action_stats_config stats = {
+		.n_packets_enabled = 1,
+		.n_bytes_enabled = 1,
+	};
+	struct rte_table_action_ttl_params ttl_params = {
+		.decrement = 1,
+	};
+	struct rte_table_action_ttl_counters ttl_counters;
+	struct rte_table_action_stats_counters stats_counters;
+	struct rte_mbuf *pkts[TA_NB_PKTS], *out[TA_NB_PKTS];
+	struct rte_table_action_profile *ap;
+	struct rte_table_action *action = NULL;
+	struct rte_pipeline_table_params table_params;
+	struct ta_pipeline tp = { .p = NULL };
+	uint64_t entry_data[8];
+	int i, n = 0, ret = -1;
+
+	ap = rte_table_action_profile_create(&common);
+	if (ap == NULL ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_FWD, NULL) ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_TTL, &ttl) ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_STATS, &stats) ||
+			rte_table_action_profile_freeze(ap)) {
+		printf("Cannot create profile\n");
+		goto out;
+	}
+	action = rte_table_action_create(ap, SOCKET_ID_ANY);
+	if (action == NULL ||
+			rte_table_action_table_params_get(action,
+				&table_params) ||
+			table_params.f_action_hit == NULL ||
+			table_params.action_data_size + sizeof(entry_data[0]) >
+				sizeof(entry_data))
+		goto out;
+
+	memset(entry_data, 0, sizeof(entry_data));
+	if (rte_table_action_apply(action, entry_data, RTE_TABLE_ACTION_TTL,
+				&ttl_params) ||
+			rte_table_action_apply(action, entry_data,
+				RTE_TABLE_ACTION_STATS, NULL) ||
+			ta_pipeline_create(&tp, action,
+				(struct rte_pipeline_table_entry *)entry_data))
+		goto out;
+
+	for (i = 0; i < TA_NB_PKTS; i++) {
+		pkts[i] = ta_pkt_build(1, IPPROTO_UDP, 0, (i < 2) ? i : TA_TTL,
+			i);
+		if (pkts[i] == NULL) {
+			ta_pkts_free(pkts, i);
+			goto out;
+		}
+	}
+
+	n = ta_pipeline_run(&tp, pkts, TA_NB_PKTS, out);
+	if (n != TA_NB_PKTS) {
+		printf("Received %d packets, %d expected\n", n, TA_NB_PKTS);
+		goto out;
+	}
+
+	for (i = 0; i < n; i++) {
+		struct ipv4_hdr *ip = rte_pktmbuf_mtod_offset(out[i],
+			struct ipv4_hdr *, sizeof(struct ether_hdr));
+		uint8_t ttl_expected = (i < 2) ? 0 : TA_TTL - 1;
+
+		if (ip->time_to_live != ttl_expected ||
+				rte_raw_cksum(ip, sizeof(*ip)) != 0xffff) {
+			printf("Bad TTL or checksum\n");
+			goto out;
+		}
+	}
+
+	if (rte_table_action_ttl_read(action, tp.entry, &ttl_counters, 1) ||
+			ttl_counters.n_packets != 2 ||
+			rte_table_action_stats_read(action, tp.entry,
+				&stats_counters, 1) ||
+			stats_counters.n_packets != TA_NB_PKTS) {
+		printf("Bad TTL or statistics counters\n");
+		goto out;
+	}
+
+	ret = 0;
+out:
+	ta_pkts_free(out, n);
+	rte_pipeline_free(tp.p);
+	rte_table_action_free(action);
+	rte_table_action_profile_free(ap);
+	return ret;
+}
+
+/* destination NAT on IPv6/TCP packets */
+static int
+test_table_action_nat_ipv6(void)
+{
+	struct rte_table_action_common_config common = {
+		.ip_version = 0,
+		.ip_offset = TA_IP_OFFSET,
+	};
+	struct rte_table_action_nat_config nat = {
+		.source_nat = 0,
+		.proto = IPPROTO_TCP,
+	};
+	struct rte_table_action_nat_params nat_params = {
+		.ip_version = 0,
+		.port = TA_NAT_PORT,
+	};
+	struct rte_mbuf *pkts[TA_NB_PKTS], *out[TA_NB_PKTS];
+	struct rte_table_action_profile *ap;
+	struct rte_table_action *action = NULL;
+	struct ta_pipeline tp = { .p = NULL };
+	uint64_t entry_data[8];
+	int i, n = 0, ret = -1;
+
+	memcpy(nat_params.addr.ipv6, ta_nat_ipv6, sizeof(ta_nat_ipv6));
+	ap = rte_table_action_profile_create(&common);
+	if (ap == NULL ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_FWD, NULL) ||
+			rte_table_action_profile_action_register(ap,
+				RTE_TABLE_ACTION_NAT, &nat) ||
+			rte_table_action_profile_freeze(ap)) {
+		printf("Cannot create profile\n");
+		goto out;
+	}
+	action = rte_table_action_create(ap, SOCKET_ID_ANY);
+	if (action == NULL)
+		goto out;
+
+	memset(entry_data, 0, sizeof(entry_data));
+	nat_params.ip_version = 1;
+	if (rte_table_action_apply(action, entry_data, RTE_TABLE_ACTION_NAT,
+			&nat_params) == 0) {
+		printf("IPv4 NAT applied to IPv6 profile\n");
+		goto out;
+	}
+	nat_params.ip_version = 0;
+	if (rte_table_action_apply(action, entry_data, RTE_TABLE_ACTION_NAT,
+				&nat_params) ||
+			ta_pipeline_create(&tp, action,
+				(struct rte_pipeline_table_entry *)entry_data))
+		goto out;
+
+	for (i = 0; i < TA_NB_PKTS; i++) {
+		pkts[i] = ta_pkt_build(0, IPPROTO_TCP, 0, TA_TTL, i);
+		if (pkts[i] == NULL) {
+			ta_pkts_free(pkts, i);
+			goto out;
+		}
+	}
+
+	n = ta_pipeline_run(&tp, pkts, TA_NB_PKTS, out);
+	if (n != TA_NB_PKTS) {
+		printf("Received %d packets, %d expected\n", n, TA_NB_PKTS);
+		goto out;
+	}
+
+	for (i = 0; i < n; i++) {
+		struct ipv6_hdr *ip = rte_pktmbuf_mtod_offset(out[i],
+			struct ipv6_hdr *, sizeof(struct ether_hdr));
+		struct tcp_hdr *tcp = (struct tcp_hdr *)(ip + 1);
+
+		if (memcmp(ip->dst_addr, ta_nat_ipv6, sizeof(ta_nat_ipv6)) ||
+				tcp->dst_port !=
+					rte_cpu_to_be_16(TA_NAT_PORT) ||
+				ip->hop_limits != TA_TTL ||
+				!ta_l4_cksum_ok(ip, 0, IPPROTO_TCP, tcp)) {
+			printf("Bad IPv6 or TCP header\n");
+			goto out;
+		}
+	}
+
+	ret = 0;
+out:
+	ta_pkts_free(out, n);
+	rte_pipeline_free(tp.p);
+	rte_table_action_free(action);
+	rte_table_action_profile_free(ap);
+	return ret;
+}
+
+static int
+test_table_action(void)
+{
+	if (ta_setup() < 0)
+		return -1;
+
+	if (test_table_action_profile() < 0)
+		return -1;
+	printf("Profile checks OK\n");
+
+	if (test_table_action_all() < 0)
+		return -1;
+	printf("All actions OK\n");
+
+	if (test_table_action_ttl() < 0)
+		return -1;
+	printf("TTL and statistics OK\n");
+
+	if (test_table_action_nat_ipv6() < 0)
+		return -1;
+	printf("IPv6 NAT OK\n");
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(table_action_autotest, test_table_action);
@@ -57,7 +57,7 @@ table_test table_tests[] = {
 			APP_METADATA_OFFSET(0));			\
 	key = RTE_MBUF_METADATA_UINT8_PTR(mbuf,			\
 			APP_METADATA_OFFSET(32));			\
-	memset(key, 0, 32);						\
+	memset(key, 0, RTE_TABLE_HASH_KEY_SIZE_MAX);			\
 	k32 = (uint32_t *) key;						\
 	k32[0] = (value);						\
 	*signature = pipeline_test_hash(key, NULL, 0, 0);			\
@@ -707,10 +707,10 @@ test_table_hash_lru_generic(struct rte_table_ops *ops, uint32_t key_size)
 		return -7;
 
 	/* Add */
-	uint8_t key[32];
+	uint8_t key[RTE_TABLE_HASH_KEY_SIZE_MAX];
 	uint32_t *k32 = (uint32_t *) &key;
 
-	memset(key, 0, 32);
+	memset(key, 0, RTE_TABLE_HASH_KEY_SIZE_MAX);
 	k32[0] = rte_be_to_cpu_32(0xadadadad);
 
 	table = ops->f_create(&hash_params, 0, 1);
@@ -817,10 +817,10 @@ test_table_hash_ext_generic(struct rte_table_ops *ops, uint32_t key_size)
 		return -7;
 
 	/* Add */
-	uint8_t key[32];
+	uint8_t key[RTE_TABLE_HASH_KEY_SIZE_MAX];
 	uint32_t *k32 = (uint32_t *) &key;
 
-	memset(key, 0, 32);
+	memset(key, 0, RTE_TABLE_HASH_KEY_SIZE_MAX);
 	k32[0] = rte_be_to_cpu_32(0xadadadad);
 
 	table = ops->f_create(&hash_params, 0, 1);
@@ -890,6 +890,24 @@ test_table_hash_lru(void)
 	if (status < 0)
 		return status;
 
+	status = test_table_hash_lru_generic(
+		&rte_table_hash_key_lru_ops,
+		8);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_lru_generic(
+		&rte_table_hash_key_lru_ops,
+		48);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_lru_generic(
+		&rte_table_hash_key_lru_ops,
+		RTE_TABLE_HASH_KEY_SIZE_MAX);
+	if (status < 0)
+		return status;
+
 	status = test_lru_update();
 	if (status < 0)
 		return status;
@@ -914,6 +932,19 @@ test_table_hash_ext(void)
 	if (status < 0)
 		return status;
 
+	status = test_table_hash_ext_generic(&rte_table_hash_key_ext_ops, 8);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_ext_generic(&rte_table_hash_key_ext_ops, 48);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_ext_generic(&rte_table_hash_key_ext_ops,
+		RTE_TABLE_HASH_KEY_SIZE_MAX);
+	if (status < 0)
+		return status;
+
 	return 0;
 }
 
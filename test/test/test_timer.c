@@ -112,6 +112,20 @@
  *      - At initialization, timer3 is loaded by the master core, on
  *        another core in "periodical" mode (time = 1 second).
  *      - It is stopped at t=25s by timer2.
+ *
+ * #. Timer data instances.
+ *
+ *    This test checks the instances allocated with rte_timer_data_alloc()
+ *    and their backends, on the master core only.
+ *
+ *    - The default instance cannot be freed, and all the other ones can
+ *      be allocated then freed.
+ *    - On a skiplist and on a timing wheel instance, 1024 timers are armed
+ *      in bulk then rearmed with random delays spanning all the levels of
+ *      a wheel of one cycle resolution. Half of them are stopped in bulk.
+ *    - The other half runs once each and never before its expiry time.
+ *    - A periodic timer runs several times, a timer beyond the range of
+ *      the wheel does not run.
  */
 
 #include <stdio.h>
@@ -120,6 +134,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <errno.h>
 #include <sys/queue.h>
 #include <math.h>
 
@@ -523,6 +538,157 @@ timer_basic_main_loop(__attribute__((unused)) void *arg)
 	return 0;
 }
 
+#define NB_DATA_TIMERS 1024
+/* all levels of a wheel of one cycle resolution */
+#define DATA_TIMERS_TICKS (1ULL << 27)
+
+static struct rte_timer data_tims[NB_DATA_TIMERS];
+static struct rte_timer *data_tims_p[NB_DATA_TIMERS];
+static unsigned data_tims_count[NB_DATA_TIMERS];
+static unsigned data_tims_early;
+
+static void
+timer_data_cb(struct rte_timer *tim, void *arg)
+{
+	unsigned *count = arg;
+
+	if (rte_get_timer_cycles() < tim->expire)
+		data_tims_early++;
+	(*count)++;
+}
+
+static int
+timer_data_check(uint32_t id)
+{
+	struct rte_timer periodic_tim, far_tim;
+	unsigned periodic_count = 0, far_count = 0;
+	unsigned lcore_id = rte_lcore_id();
+	void *args[NB_DATA_TIMERS];
+	unsigned i, far_pending;
+	uint64_t end;
+
+	data_tims_early = 0;
+	for (i = 0; i < NB_DATA_TIMERS; i++) {
+		rte_timer_init(&data_tims[i]);
+		data_tims_count[i] = 0;
+		args[i] = &data_tims_count[i];
+		data_tims_p[i] = &data_tims[i];
+	}
+
+	if (rte_timer_alt_reset_bulk(id, data_tims_p, NB_DATA_TIMERS,
+			DATA_TIMERS_TICKS, SINGLE, lcore_id, timer_data_cb,
+			args) != NB_DATA_TIMERS) {
+		printf("Cannot arm timers in bulk\n");
+		return -1;
+	}
+	for (i = 0; i < NB_DATA_TIMERS; i++) {
+		if (rte_timer_alt_reset(id, &data_tims[i],
+				rte_rand() % DATA_TIMERS_TICKS, SINGLE,
+				lcore_id, timer_data_cb, args[i]) != 0) {
+			printf("Cannot rearm timer %u\n", i);
+			return -1;
+		}
+	}
+
+	/* stop the odd timers */
+	for (i = 0; i < NB_DATA_TIMERS / 2; i++)
+		data_tims_p[i] = &data_tims[2 * i + 1];
+	if (rte_timer_alt_stop_bulk(id, data_tims_p, NB_DATA_TIMERS / 2) !=
+			NB_DATA_TIMERS / 2) {
+		printf("Cannot stop timers in bulk\n");
+		return -1;
+	}
+
+	rte_timer_init(&periodic_tim);
+	rte_timer_init(&far_tim);
+	if (rte_timer_alt_reset(id, &periodic_tim, DATA_TIMERS_TICKS / 8,
+			PERIODICAL, lcore_id, timer_data_cb,
+			&periodic_count) != 0 ||
+	    rte_timer_alt_reset(id, &far_tim, 1ULL << 33, SINGLE, lcore_id,
+			timer_data_cb, &far_count) != 0) {
+		printf("Cannot arm timers\n");
+		return -1;
+	}
+
+	end = rte_get_timer_cycles() + DATA_TIMERS_TICKS +
+		DATA_TIMERS_TICKS / 8;
+	while (rte_get_timer_cycles() < end)
+		rte_timer_alt_manage(id);
+
+	far_pending = rte_timer_pending(&far_tim);
+	rte_timer_alt_stop(id, &periodic_tim);
+	rte_timer_alt_stop(id, &far_tim);
+
+	for (i = 0; i < NB_DATA_TIMERS; i++) {
+		if (data_tims_count[i] != (i % 2 ? 0U : 1U)) {
+			printf("Timer %u run %u times\n", i,
+					data_tims_count[i]);
+			return -1;
+		}
+	}
+	if (data_tims_early != 0) {
+		printf("%u timers run early\n", data_tims_early);
+		return -1;
+	}
+	if (periodic_count < 4 || far_count != 0 || !far_pending) {
+		printf("Periodic timer run %u times, far timer %u times\n",
+				periodic_count, far_count);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+timer_data_test(void)
+{
+	static const enum rte_timer_backend backends[] = {
+		RTE_TIMER_BACKEND_SKIPLIST,
+		RTE_TIMER_BACKEND_WHEEL,
+	};
+	uint32_t ids[RTE_TIMER_MAX_DATA];
+	unsigned i, n = 0;
+	int ret;
+
+	if (rte_timer_data_dealloc(RTE_TIMER_DEFAULT_DATA_ID) != -EINVAL) {
+		printf("Default timer data freed\n");
+		return -1;
+	}
+
+	while (n < RTE_TIMER_MAX_DATA && rte_timer_data_alloc(&ids[n]) == 0)
+		n++;
+	if (n != RTE_TIMER_MAX_DATA - 1) {
+		printf("%u timer data allocated\n", n);
+		return -1;
+	}
+	for (i = 0; i < n; i++) {
+		if (rte_timer_data_dealloc(ids[i]) != 0) {
+			printf("Cannot free timer data %u\n", ids[i]);
+			return -1;
+		}
+	}
+	if (rte_timer_data_dealloc(ids[0]) != -EINVAL) {
+		printf("Timer data freed twice\n");
+		return -1;
+	}
+
+	for (i = 0; i < RTE_DIM(backends); i++) {
+		if (rte_timer_data_alloc_backend(&ids[0], backends[i], 1) != 0) {
+			printf("Cannot allocate timer data\n");
+			return -1;
+		}
+		ret = timer_data_check(ids[0]);
+		rte_timer_data_dealloc(ids[0]);
+		if (ret != 0) {
+			printf("Timer data test failed, backend %u\n",
+					(unsigned)backends[i]);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 static int
 timer_sanity_check(void)
 {
@@ -573,6 +739,10 @@ test_timer(void)
 		return TEST_FAILED;
 	}
 
+	printf("Start timer data instance tests\n");
+	if (timer_data_test() < 0)
+		return TEST_FAILED;
+
 	if (rte_lcore_count() < 2) {
 		printf("not enough lcores for this test\n");
 		return TEST_FAILED;
@@ -31,9 +31,11 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+
 #include "test.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <inttypes.h>
 #include <rte_cycles.h>
@@ -44,7 +46,11 @@
 #include <rte_malloc.h>
 #include <rte_pause.h>
 
-#define MAX_ITERATIONS 1000000
+#define MIN_ITERATIONS 100
+#define MAX_ITERATIONS 10000000
+/* 100, 1000, ..., MAX_ITERATIONS */
+#define NB_STEPS 6
+#define NB_POLLS 1000000
 
 int outstanding_count = 0;
 
@@ -62,76 +68,140 @@ timer_cb(struct rte_timer *t __rte_unused, void *param __rte_unused)
 #define do_delay() rte_pause()
 #endif
 
-static int
-test_timer_perf(void)
+/* cycles per timer of the operations, for the summary */
+enum {
+	PERF_RESET,
+	PERF_CALLBACK,
+	PERF_RAND_RESET,
+	PERF_STOP,
+	PERF_BULK_RESET,
+	PERF_BULK_STOP,
+	PERF_MAX,
+};
+
+static const char * const perf_names[PERF_MAX] = {
+	"reset", "callback", "rand_reset", "stop", "bulk_reset", "bulk_stop",
+};
+
+static uint64_t
+print_time(const char *what, unsigned iterations, uint64_t cycles)
 {
-	unsigned iterations = 100;
-	unsigned i;
-	struct rte_timer *tms;
-	uint64_t start_tsc, end_tsc, delay_start;
-	unsigned lcore_id = rte_lcore_id();
+	const uint64_t ticks_per_ms = rte_get_tsc_hz()/1000;
+	const uint64_t ticks_per_us = ticks_per_ms/1000;
 
-	tms = rte_malloc(NULL, sizeof(*tms) * MAX_ITERATIONS, 0);
+	printf("Time for %u %s: %"PRIu64" (%"PRIu64"ms), ", iterations, what,
+			cycles, (cycles+ticks_per_ms/2)/(ticks_per_ms));
+	printf("Time per %s: %"PRIu64" (%"PRIu64"us)\n", what,
+			cycles/iterations,
+			(cycles/iterations+ticks_per_us/2)/(ticks_per_us));
+	return cycles/iterations;
+}
 
-	for (i = 0; i < MAX_ITERATIONS; i++)
-		rte_timer_init(&tms[i]);
+/* wait for all the timers armed so far to be due, wheel rounding included */
+static void
+wait_for_timers(uint64_t ticks)
+{
+	uint64_t delay_start = rte_get_timer_cycles();
+
+	while (rte_get_timer_cycles() < delay_start + ticks + ticks / 100)
+		do_delay();
+}
+
+static int
+timer_perf_run(uint32_t id, struct rte_timer *tms, struct rte_timer **ptrs,
+		uint64_t res[NB_STEPS][PERF_MAX])
+{
+	unsigned iterations = MIN_ITERATIONS;
+	unsigned i, step;
+	uint64_t start_tsc, end_tsc;
+	unsigned lcore_id = rte_lcore_id();
+	int n;
 
 	const uint64_t ticks = rte_get_timer_hz() * DELAY_SECONDS;
-	const uint64_t ticks_per_ms = rte_get_tsc_hz()/1000;
-	const uint64_t ticks_per_us = ticks_per_ms/1000;
 
-	while (iterations <= MAX_ITERATIONS) {
+	for (step = 0; step < NB_STEPS; step++, iterations *= 10) {
 
 		printf("Appending %u timers\n", iterations);
 		start_tsc = rte_rdtsc();
 		for (i = 0; i < iterations; i++)
-			rte_timer_reset(&tms[i], ticks, SINGLE, lcore_id,
+			rte_timer_alt_reset(id, &tms[i], ticks, SINGLE, lcore_id,
 					timer_cb, NULL);
 		end_tsc = rte_rdtsc();
-		printf("Time for %u timers: %"PRIu64" (%"PRIu64"ms), ", iterations,
-				end_tsc-start_tsc, (end_tsc-start_tsc+ticks_per_ms/2)/(ticks_per_ms));
-		printf("Time per timer: %"PRIu64" (%"PRIu64"us)\n",
-				(end_tsc-start_tsc)/iterations,
-				((end_tsc-start_tsc)/iterations+ticks_per_us/2)/(ticks_per_us));
+		res[step][PERF_RESET] = print_time("timers", iterations,
+				end_tsc-start_tsc);
 		outstanding_count = iterations;
-		delay_start = rte_get_timer_cycles();
-		while (rte_get_timer_cycles() < delay_start + ticks)
-			do_delay();
+		wait_for_timers(ticks);
 
 		start_tsc = rte_rdtsc();
 		while (outstanding_count)
-			rte_timer_manage();
+			rte_timer_alt_manage(id);
 		end_tsc = rte_rdtsc();
-		printf("Time for %u callbacks: %"PRIu64" (%"PRIu64"ms), ", iterations,
-				end_tsc-start_tsc, (end_tsc-start_tsc+ticks_per_ms/2)/(ticks_per_ms));
-		printf("Time per callback: %"PRIu64" (%"PRIu64"us)\n",
-				(end_tsc-start_tsc)/iterations,
-				((end_tsc-start_tsc)/iterations+ticks_per_us/2)/(ticks_per_us));
+		res[step][PERF_CALLBACK] = print_time("callbacks", iterations,
+				end_tsc-start_tsc);
 
 		printf("Resetting %u timers\n", iterations);
 		start_tsc = rte_rdtsc();
 		for (i = 0; i < iterations; i++)
-			rte_timer_reset(&tms[i], rte_rand() % ticks, SINGLE, lcore_id,
-					timer_cb, NULL);
+			rte_timer_alt_reset(id, &tms[i], rte_rand() % ticks,
+					SINGLE, lcore_id, timer_cb, NULL);
 		end_tsc = rte_rdtsc();
-		printf("Time for %u timers: %"PRIu64" (%"PRIu64"ms), ", iterations,
-				end_tsc-start_tsc, (end_tsc-start_tsc+ticks_per_ms/2)/(ticks_per_ms));
-		printf("Time per timer: %"PRIu64" (%"PRIu64"us)\n",
-				(end_tsc-start_tsc)/iterations,
-				((end_tsc-start_tsc)/iterations+ticks_per_us/2)/(ticks_per_us));
+		res[step][PERF_RAND_RESET] = print_time("timers", iterations,
+				end_tsc-start_tsc);
 		outstanding_count = iterations;
+		wait_for_timers(ticks);
 
-		delay_start = rte_get_timer_cycles();
-		while (rte_get_timer_cycles() < delay_start + ticks)
-			do_delay();
-
-		rte_timer_manage();
+		rte_timer_alt_manage(id);
 		if (outstanding_count != 0) {
 			printf("Error: outstanding callback count = %d\n", outstanding_count);
 			return -1;
 		}
 
-		iterations *= 10;
+		/* stopped timers must not run */
+		printf("Stopping %u timers\n", iterations);
+		for (i = 0; i < iterations; i++)
+			rte_timer_alt_reset(id, &tms[i], rte_rand() % ticks,
+					SINGLE, lcore_id, timer_cb, NULL);
+		start_tsc = rte_rdtsc();
+		for (i = 0; i < iterations; i++)
+			rte_timer_alt_stop(id, &tms[i]);
+		end_tsc = rte_rdtsc();
+		res[step][PERF_STOP] = print_time("timers", iterations,
+				end_tsc-start_tsc);
+
+		printf("Bulk resetting %u timers\n", iterations);
+		start_tsc = rte_rdtsc();
+		n = rte_timer_alt_reset_bulk(id, ptrs, iterations, ticks,
+				SINGLE, lcore_id, timer_cb, NULL);
+		end_tsc = rte_rdtsc();
+		if (n != (int)iterations) {
+			printf("Error: %d timers armed out of %u\n", n,
+					iterations);
+			return -1;
+		}
+		res[step][PERF_BULK_RESET] = print_time("timers", iterations,
+				end_tsc-start_tsc);
+
+		printf("Bulk stopping %u timers\n", iterations);
+		start_tsc = rte_rdtsc();
+		n = rte_timer_alt_stop_bulk(id, ptrs, iterations);
+		end_tsc = rte_rdtsc();
+		if (n != (int)iterations) {
+			printf("Error: %d timers stopped out of %u\n", n,
+					iterations);
+			return -1;
+		}
+		res[step][PERF_BULK_STOP] = print_time("timers", iterations,
+				end_tsc-start_tsc);
+
+		outstanding_count = 0;
+		wait_for_timers(ticks);
+		rte_timer_alt_manage(id);
+		if (outstanding_count != 0) {
+			printf("Error: %d stopped timers run\n",
+					-outstanding_count);
+			return -1;
+		}
+
 		printf("\n");
 	}
 
@@ -139,25 +209,84 @@ test_timer_perf(void)
 
 	/* measure time to poll an empty timer list */
 	start_tsc = rte_rdtsc();
-	for (i = 0; i < iterations; i++)
-		rte_timer_manage();
+	for (i = 0; i < NB_POLLS; i++)
+		rte_timer_alt_manage(id);
 	end_tsc = rte_rdtsc();
 	printf("\nTime per rte_timer_manage with zero timers: %"PRIu64" cycles\n",
-			(end_tsc - start_tsc + iterations/2) / iterations);
+			(end_tsc - start_tsc + NB_POLLS/2) / NB_POLLS);
 
 	/* measure time to poll a timer list with timers, but without
 	 * calling any callbacks */
-	rte_timer_reset(&tms[0], ticks * 100, SINGLE, lcore_id,
+	rte_timer_alt_reset(id, &tms[0], ticks * 100, SINGLE, lcore_id,
 			timer_cb, NULL);
 	start_tsc = rte_rdtsc();
-	for (i = 0; i < iterations; i++)
-		rte_timer_manage();
+	for (i = 0; i < NB_POLLS; i++)
+		rte_timer_alt_manage(id);
 	end_tsc = rte_rdtsc();
 	printf("Time per rte_timer_manage with zero callbacks: %"PRIu64" cycles\n",
-			(end_tsc - start_tsc + iterations/2) / iterations);
+			(end_tsc - start_tsc + NB_POLLS/2) / NB_POLLS);
+	rte_timer_alt_stop(id, &tms[0]);
 
-	rte_free(tms);
 	return 0;
 }
 
+static int
+test_timer_perf(void)
+{
+	static uint64_t res[2][NB_STEPS][PERF_MAX];
+	struct rte_timer *tms;
+	struct rte_timer **ptrs;
+	uint32_t wheel_id;
+	unsigned i, step, op, iterations;
+	int ret = -1;
+
+	/* millions of timers do not fit the hugepage memory of the tests */
+	tms = malloc(sizeof(*tms) * MAX_ITERATIONS);
+	ptrs = malloc(sizeof(*ptrs) * MAX_ITERATIONS);
+	if (tms == NULL || ptrs == NULL) {
+		printf("Cannot allocate %u timers\n", MAX_ITERATIONS);
+		goto out;
+	}
+
+	for (i = 0; i < MAX_ITERATIONS; i++) {
+		rte_timer_init(&tms[i]);
+		ptrs[i] = &tms[i];
+	}
+
+	if (rte_timer_data_alloc_backend(&wheel_id, RTE_TIMER_BACKEND_WHEEL,
+					 0) != 0) {
+		printf("Cannot allocate a timing wheel instance\n");
+		goto out;
+	}
+
+	printf("Skiplist timers\n\n");
+	ret = timer_perf_run(RTE_TIMER_DEFAULT_DATA_ID, tms, ptrs, res[0]);
+	if (ret == 0) {
+		printf("\nTiming wheel timers\n\n");
+		ret = timer_perf_run(wheel_id, tms, ptrs, res[1]);
+	}
+	rte_timer_data_dealloc(wheel_id);
+	if (ret != 0)
+		goto out;
+
+	printf("\nCycles per timer, skiplist / timing wheel:\n");
+	printf("%9s", "timers");
+	for (op = 0; op < PERF_MAX; op++)
+		printf(" %15s", perf_names[op]);
+	printf("\n");
+	for (step = 0, iterations = MIN_ITERATIONS; step < NB_STEPS;
+			step++, iterations *= 10) {
+		printf("%9u", iterations);
+		for (op = 0; op < PERF_MAX; op++)
+			printf(" %7"PRIu64"/%-7"PRIu64, res[0][step][op],
+					res[1][step][op]);
+		printf("\n");
+	}
+
+out:
+	free(tms);
+	free(ptrs);
+	return ret;
+}
+
 REGISTER_TEST_COMMAND(timer_perf_autotest, test_timer_perf);
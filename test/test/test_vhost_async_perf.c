@@ -0,0 +1,298 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_vhost.h>
+#include <rte_vhost_async.h>
+
+#include "test.h"
+
+/*
+ * Vhost enqueue performance, synchronous and through the software copy
+ * engine. A virtio-user port of the same process plays the guest: it is
+ * connected to a vhost-user socket and its Rx queue is drained on the
+ * enqueuing core. Reported are the cycles spent per packet in the vhost
+ * enqueue calls, which is what the async path offloads, and the overall
+ * packet rate. The slave lcores run the copy engine workers.
+ */
+
+#define VAP_SOCK	"/tmp/vhost_async_perf.sock"
+#define VAP_GUEST	"net_virtio_user_vap"
+#define VAP_RING_SIZE	256
+#define VAP_BURST	32
+#define VAP_NB_SRC	(VAP_RING_SIZE * 2)
+#define VAP_NB_PKTS	(1 << 20)
+#define VAP_MAX_PKT_LEN	4096
+#define VAP_THRESHOLD	256
+#define VAP_TIMEOUT_S	5
+
+static const uint32_t vap_pkt_len[] = { 64, 256, 1024, 1518, 4096 };
+
+static volatile int vap_vid = -1;
+static volatile uint32_t vap_events;
+
+static int
+vap_new_device(int vid)
+{
+	vap_vid = vid;
+	vap_events++;
+	return 0;
+}
+
+static void
+vap_destroy_device(int vid __rte_unused)
+{
+	vap_vid = -1;
+	vap_events++;
+}
+
+static const struct vhost_device_ops vap_ops = {
+	.new_device = vap_new_device,
+	.destroy_device = vap_destroy_device,
+};
+
+static uint32_t
+vap_guest_drain(uint16_t port)
+{
+	struct rte_mbuf *pkts[VAP_BURST];
+	uint16_t i, n;
+
+	n = rte_eth_rx_burst(port, 0, pkts, VAP_BURST);
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free(pkts[i]);
+
+	return n;
+}
+
+static int
+vap_run(uint16_t port, struct rte_mbuf **src, uint32_t pkt_len, int async)
+{
+	struct rte_mbuf *free_pkts[VAP_NB_SRC];
+	struct rte_mbuf *done[VAP_BURST];
+	uint64_t enq_cycles, start, last, t, hz;
+	uint32_t sent, received, nb_free, n, k, i;
+	int vid = vap_vid;
+
+	for (i = 0; i < VAP_NB_SRC; i++) {
+		src[i]->data_len = pkt_len;
+		src[i]->pkt_len = pkt_len;
+		free_pkts[i] = src[i];
+	}
+	nb_free = VAP_NB_SRC;
+
+	hz = rte_get_tsc_hz();
+	enq_cycles = 0;
+	sent = 0;
+	received = 0;
+	start = rte_rdtsc();
+	last = start;
+
+	while (received < VAP_NB_PKTS) {
+		t = rte_rdtsc();
+		k = 0;
+
+		if (async) {
+			n = RTE_MIN(nb_free, (uint32_t)VAP_BURST);
+			n = RTE_MIN(n, VAP_NB_PKTS - sent);
+			k = rte_vhost_submit_enqueue_burst(vid, 0,
+				&free_pkts[nb_free - n], n);
+			/* keep the packets not taken at the top */
+			memmove(&free_pkts[nb_free - n],
+				&free_pkts[nb_free - n + k],
+				(n - k) * sizeof(free_pkts[0]));
+			nb_free -= k;
+
+			n = rte_vhost_poll_enqueue_completed(vid, 0, done,
+				VAP_BURST);
+			for (i = 0; i < n; i++)
+				free_pkts[nb_free++] = done[i];
+		} else if (sent < VAP_NB_PKTS) {
+			n = RTE_MIN((uint32_t)VAP_BURST, VAP_NB_PKTS - sent);
+			k = rte_vhost_enqueue_burst(vid, 0,
+				&src[sent % (VAP_NB_SRC - VAP_BURST)], n);
+		}
+
+		enq_cycles += rte_rdtsc() - t;
+		sent += k;
+
+		n = vap_guest_drain(port);
+		received += n;
+
+		t = rte_rdtsc();
+		if (n != 0 || k != 0)
+			last = t;
+		else if (t - last > VAP_TIMEOUT_S * hz) {
+			printf("%s: stalled, %u packets sent, %u received\n",
+				__func__, sent, received);
+			return -1;
+		}
+	}
+
+	t = rte_rdtsc() - start;
+	printf("%8u %6s %12.1f %10.2f %10.2f\n", pkt_len,
+		async ? "async" : "sync",
+		(double)enq_cycles / VAP_NB_PKTS,
+		(double)VAP_NB_PKTS * hz / t / 1e6,
+		(double)VAP_NB_PKTS * pkt_len * 8 * hz / t / 1e9);
+
+	return 0;
+}
+
+static int
+vap_guest_start(uint16_t *port, struct rte_mempool *mp, int *created)
+{
+	struct rte_eth_conf conf;
+	char args[128];
+	uint64_t deadline;
+	uint32_t events;
+
+	snprintf(args, sizeof(args), "path=%s,queues=1,queue_size=%u",
+		VAP_SOCK, VAP_RING_SIZE);
+	if (rte_vdev_init(VAP_GUEST, args) != 0) {
+		printf("cannot create %s\n", VAP_GUEST);
+		return -1;
+	}
+	*created = 1;
+
+	if (rte_eth_dev_get_port_by_name(VAP_GUEST, port) != 0)
+		return -1;
+
+	memset(&conf, 0, sizeof(conf));
+	if (rte_eth_dev_configure(*port, 1, 1, &conf) < 0 ||
+			rte_eth_rx_queue_setup(*port, 0, VAP_RING_SIZE,
+				rte_socket_id(), NULL, mp) < 0 ||
+			rte_eth_tx_queue_setup(*port, 0, VAP_RING_SIZE,
+				rte_socket_id(), NULL) < 0 ||
+			rte_eth_dev_start(*port) < 0) {
+		printf("cannot start %s\n", VAP_GUEST);
+		return -1;
+	}
+
+	/*
+	 * The vhost-user messages are handled by the vhost thread, and
+	 * virtio-user resets the device once while it is set up: wait for
+	 * the device to stay ready.
+	 */
+	deadline = rte_rdtsc() + VAP_TIMEOUT_S * rte_get_tsc_hz();
+	do {
+		if (rte_rdtsc() > deadline) {
+			printf("vhost device not ready\n");
+			return -1;
+		}
+		events = vap_events;
+		usleep(100000);
+	} while (vap_vid < 0 || events != vap_events);
+
+	return 0;
+}
+
+static int
+test_vhost_async_perf(void)
+{
+	struct rte_mbuf *src[VAP_NB_SRC];
+	struct rte_mempool *src_mp = NULL, *guest_mp = NULL;
+	struct rte_vhost_async_sw *sw = NULL;
+	struct rte_vhost_async_sw_channel *ch = NULL;
+	unsigned int lcore, nb_workers = 0;
+	uint16_t port = 0;
+	unsigned int i;
+	int guest = 0, ret = -1;
+
+	unlink(VAP_SOCK);
+	if (rte_vhost_driver_register(VAP_SOCK, 0) != 0)
+		return -1;
+	if (rte_vhost_driver_callback_register(VAP_SOCK, &vap_ops) != 0 ||
+			rte_vhost_driver_start(VAP_SOCK) != 0)
+		goto out;
+
+	src_mp = rte_pktmbuf_pool_create("vap_src", VAP_NB_SRC, 0, 0,
+		VAP_MAX_PKT_LEN + RTE_PKTMBUF_HEADROOM, rte_socket_id());
+	guest_mp = rte_pktmbuf_pool_create("vap_guest", VAP_RING_SIZE * 4,
+		VAP_BURST, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (src_mp == NULL || guest_mp == NULL) {
+		printf("cannot create mbuf pools\n");
+		goto out;
+	}
+
+	if (rte_pktmbuf_alloc_bulk(src_mp, src, VAP_NB_SRC) != 0)
+		goto out;
+	for (i = 0; i < VAP_NB_SRC; i++)
+		memset(rte_pktmbuf_mtod(src[i], void *), i, VAP_MAX_PKT_LEN);
+
+	if (vap_guest_start(&port, guest_mp, &guest) != 0)
+		goto out_src;
+
+	printf("%8s %6s %12s %10s %10s\n", "pkt_len", "mode",
+		"enq_cyc/pkt", "Mpps", "Gbps");
+
+	for (i = 0; i < RTE_DIM(vap_pkt_len); i++)
+		if (vap_run(port, src, vap_pkt_len[i], 0) != 0)
+			goto out_src;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore)
+		nb_workers++;
+	if (nb_workers == 0) {
+		printf("no slave lcore for the copy engine, async skipped\n");
+		ret = 0;
+		goto out_src;
+	}
+
+	sw = rte_vhost_async_sw_create("vap", VAP_RING_SIZE * 4,
+		rte_socket_id());
+	ch = rte_vhost_async_sw_channel_create(sw, VAP_RING_SIZE);
+	if (sw == NULL || ch == NULL ||
+			rte_vhost_async_channel_register(vap_vid, 0,
+				rte_vhost_async_sw_ops(), ch,
+				VAP_THRESHOLD) != 0) {
+		printf("cannot set up the async channel\n");
+		goto out_engine;
+	}
+
+	printf("async: %u copy workers, threshold %u bytes\n",
+		nb_workers, VAP_THRESHOLD);
+	RTE_LCORE_FOREACH_SLAVE(lcore)
+		rte_eal_remote_launch(rte_vhost_async_sw_worker, sw, lcore);
+
+	ret = 0;
+	for (i = 0; i < RTE_DIM(vap_pkt_len) && ret == 0; i++)
+		ret = vap_run(port, src, vap_pkt_len[i], 1);
+
+	rte_vhost_async_sw_stop(sw);
+	rte_eal_mp_wait_lcore();
+
+	if (rte_vhost_async_channel_unregister(vap_vid, 0) != 0)
+		ret = -1;
+
+out_engine:
+	rte_vhost_async_sw_channel_free(ch);
+	rte_vhost_async_sw_free(sw);
+out_src:
+	for (i = 0; i < VAP_NB_SRC; i++)
+		rte_pktmbuf_free(src[i]);
+out:
+	if (guest) {
+		if (rte_eth_dev_get_port_by_name(VAP_GUEST, &port) == 0) {
+			rte_eth_dev_stop(port);
+			rte_eth_dev_close(port);
+		}
+		rte_vdev_uninit(VAP_GUEST);
+	}
+	rte_vhost_driver_unregister(VAP_SOCK);
+	rte_mempool_free(src_mp);
+	rte_mempool_free(guest_mp);
+
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(vhost_async_perf_autotest, test_vhost_async_perf);
@@ -0,0 +1,315 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+#include <rte_vhost.h>
+
+#include "../../lib/librte_vhost/iotlb.h"
+
+#include "test.h"
+
+/*
+ * Cost of the vhost address translations against the number of mappings:
+ * IOTLB cache lookups, by binary search or through the last hit, compared
+ * with a linear walk of the entries as done by the former list based
+ * cache, and guest physical address lookups in the memory regions.
+ */
+
+#define VIP_PAGE_SIZE	4096
+#define VIP_MAX_MAPS	2048
+#define VIP_NB_ADDRS	4096
+#define VIP_ITER	(1 << 20)
+/* lookups per page in the sequential pattern, as for buffers of a page */
+#define VIP_PER_PAGE	8
+#define VIP_UADDR	0x7f0000000000ULL
+/* as many as vhost-user accepts */
+#define VIP_MAX_REGIONS	8
+
+static const uint32_t vip_nb_maps[] = { 16, 64, 256, 1024, 2048 };
+
+static uint64_t vip_addrs[VIP_NB_ADDRS];
+static volatile uint64_t vip_sink;
+
+/* one page mapped out of two, so that lookups cannot span entries */
+static inline uint64_t
+vip_iova(uint32_t i)
+{
+	return (uint64_t)i * 2 * VIP_PAGE_SIZE;
+}
+
+static inline uint64_t
+vip_uaddr(uint32_t i)
+{
+	return VIP_UADDR + (uint64_t)i * VIP_PAGE_SIZE;
+}
+
+static uint64_t
+vip_linear_lookup(const struct vhost_iotlb_cache *c, uint64_t iova,
+		uint64_t *size, uint8_t perm)
+{
+	const struct vhost_iotlb_map *m;
+	uint64_t offset, vva = 0, mapped = 0;
+	uint32_t i;
+
+	for (i = 0; i < c->nr; i++) {
+		m = &c->maps[i];
+		if (iova < m->iova)
+			break;
+		if (iova >= m->iova + m->size)
+			continue;
+		if ((perm & m->perm) != perm)
+			break;
+
+		offset = iova - m->iova;
+		if (!vva)
+			vva = m->uaddr + offset;
+		mapped += m->size - offset;
+		iova = m->iova + m->size;
+		if (mapped >= *size)
+			break;
+	}
+
+	if (mapped < *size)
+		*size = mapped;
+
+	return vva;
+}
+
+static int
+vip_check(struct vhost_iotlb_cache *c, uint32_t nb_maps)
+{
+	uint64_t iova, vva, size;
+	uint32_t last = 0, i;
+
+	for (i = 0; i < nb_maps; i++) {
+		iova = vip_iova(i) + 100;
+		size = 64;
+		vva = vhost_iotlb_cache_lookup(c, &last, iova, &size,
+			VHOST_ACCESS_RO);
+		if (vva != vip_uaddr(i) + 100 || size != 64) {
+			printf("wrong translation of entry %u\n", i);
+			return -1;
+		}
+
+		/* the unmapped page following the entry */
+		iova = vip_iova(i) + VIP_PAGE_SIZE;
+		size = 64;
+		vva = vhost_iotlb_cache_lookup(c, &last, iova, &size,
+			VHOST_ACCESS_RO);
+		if (vva != 0 || size != 0) {
+			printf("unmapped IOVA 0x%" PRIx64 " translated\n",
+				iova);
+			return -1;
+		}
+
+		/* partially mapped request */
+		iova = vip_iova(i) + VIP_PAGE_SIZE - 64;
+		size = 128;
+		vip_sink += vhost_iotlb_cache_lookup(c, &last, iova, &size,
+			VHOST_ACCESS_RO);
+		if (size != 64) {
+			printf("wrong length mapped at entry %u\n", i);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static double
+vip_iotlb_run(struct vhost_iotlb_cache *c, int mode)
+{
+	uint64_t start, size, sum = 0;
+	uint32_t last = 0, i;
+
+	start = rte_rdtsc();
+	for (i = 0; i < VIP_ITER; i++) {
+		size = 64;
+		switch (mode) {
+		case 0:
+			sum += vip_linear_lookup(c,
+				vip_addrs[i % VIP_NB_ADDRS], &size,
+				VHOST_ACCESS_RO);
+			break;
+		case 1:
+			sum += vhost_iotlb_cache_lookup(c, &last,
+				vip_addrs[i % VIP_NB_ADDRS], &size,
+				VHOST_ACCESS_RO);
+			break;
+		default:
+			sum += vhost_iotlb_cache_lookup(c, &last,
+				vip_addrs[(i / VIP_PER_PAGE) % VIP_NB_ADDRS],
+				&size, VHOST_ACCESS_RO);
+			break;
+		}
+	}
+	vip_sink += sum;
+
+	return (double)(rte_rdtsc() - start) / VIP_ITER;
+}
+
+static int
+test_vip_iotlb(void)
+{
+	struct vhost_iotlb_cache c;
+	uint32_t n, i, j;
+	int ret = 0;
+
+	memset(&c, 0, sizeof(c));
+	rte_spinlock_init(&c.lock);
+	c.maps = rte_malloc(NULL, VIP_MAX_MAPS * sizeof(c.maps[0]), 0);
+	if (c.maps == NULL)
+		return -1;
+	c.max = VIP_MAX_MAPS;
+
+	printf("IOTLB lookup, cycles per lookup:\n");
+	printf("%8s %10s %10s %10s\n", "entries", "linear", "bsearch",
+		"last_hit");
+
+	for (j = 0; j < RTE_DIM(vip_nb_maps) && ret == 0; j++) {
+		n = vip_nb_maps[j];
+
+		/* inserted in random order, as the misses come */
+		vhost_iotlb_cache_flush(&c);
+		for (i = 0; i < n; i++) {
+			uint32_t k = (i * 7919) % n;
+
+			vhost_iotlb_cache_add(&c, vip_iova(k), vip_uaddr(k),
+				VIP_PAGE_SIZE, VHOST_ACCESS_RW);
+		}
+		if (c.nr != n || vip_check(&c, n) != 0) {
+			ret = -1;
+			break;
+		}
+
+		for (i = 0; i < VIP_NB_ADDRS; i++)
+			vip_addrs[i] = vip_iova(rte_rand() % n) +
+				rte_rand() % (VIP_PAGE_SIZE - 64);
+
+		printf("%8u %10.1f %10.1f %10.1f\n", n,
+			vip_iotlb_run(&c, 0), vip_iotlb_run(&c, 1),
+			vip_iotlb_run(&c, 2));
+	}
+
+	/* a full cache evicts an entry for each insertion */
+	for (i = VIP_MAX_MAPS; i < VIP_MAX_MAPS * 2 && ret == 0; i++) {
+		vhost_iotlb_cache_add(&c, vip_iova(i), vip_uaddr(i),
+			VIP_PAGE_SIZE, VHOST_ACCESS_RW);
+		if (c.nr != VIP_MAX_MAPS)
+			ret = -1;
+	}
+	if (ret == 0 && vhost_iotlb_cache_del(&c, 0,
+			vip_iova(VIP_MAX_MAPS * 2)) != VIP_MAX_MAPS)
+		ret = -1;
+	if (ret != 0)
+		printf("wrong number of IOTLB entries\n");
+
+	rte_free(c.maps);
+
+	return ret;
+}
+
+static int
+test_vip_gpa(void)
+{
+	struct rte_vhost_memory *mem;
+	uint64_t start, gpa, len, sum;
+	uint64_t linear, bsearch, last_hit;
+	uint32_t n, i, last = 0;
+
+	mem = rte_zmalloc(NULL, sizeof(*mem) +
+		VIP_MAX_REGIONS * sizeof(mem->regions[0]), 0);
+	if (mem == NULL)
+		return -1;
+
+	printf("GPA lookup, cycles per lookup:\n");
+	printf("%8s %10s %10s %10s\n", "regions", "linear", "bsearch",
+		"last_hit");
+
+	for (n = 1; n <= VIP_MAX_REGIONS; n++) {
+		/* 1GB regions, with a hole below 4GB as for PCI */
+		mem->nregions = n;
+		for (i = 0; i < n; i++) {
+			mem->regions[i].guest_phys_addr =
+				(uint64_t)(i < 3 ? i : i + 1) << 30;
+			mem->regions[i].size = 1ULL << 30;
+			mem->regions[i].host_user_addr =
+				VIP_UADDR + ((uint64_t)i << 30);
+		}
+
+		for (i = 0; i < VIP_NB_ADDRS; i++) {
+			uint32_t r = rte_rand() % n;
+
+			vip_addrs[i] = mem->regions[r].guest_phys_addr +
+				rte_rand() % ((1ULL << 30) - 64);
+		}
+
+		for (i = 0; i < VIP_NB_ADDRS; i++) {
+			uint64_t len2 = 64;
+
+			gpa = vip_addrs[i];
+			len = 64;
+			if (vhost_va_from_guest_pa(mem, &last, gpa, &len) !=
+					rte_vhost_va_from_guest_pa(mem, gpa,
+						&len2) || len != len2) {
+				printf("wrong translation of 0x%" PRIx64 "\n",
+					gpa);
+				rte_free(mem);
+				return -1;
+			}
+		}
+
+		sum = 0;
+		start = rte_rdtsc();
+		for (i = 0; i < VIP_ITER; i++) {
+			len = 64;
+			sum += rte_vhost_va_from_guest_pa(mem,
+				vip_addrs[i % VIP_NB_ADDRS], &len);
+		}
+		linear = rte_rdtsc() - start;
+
+		start = rte_rdtsc();
+		for (i = 0; i < VIP_ITER; i++) {
+			len = 64;
+			sum += vhost_va_from_guest_pa(mem, &last,
+				vip_addrs[i % VIP_NB_ADDRS], &len);
+		}
+		bsearch = rte_rdtsc() - start;
+
+		start = rte_rdtsc();
+		for (i = 0; i < VIP_ITER; i++) {
+			len = 64;
+			sum += vhost_va_from_guest_pa(mem, &last,
+				vip_addrs[(i / VIP_PER_PAGE) % VIP_NB_ADDRS],
+				&len);
+		}
+		last_hit = rte_rdtsc() - start;
+		vip_sink += sum;
+
+		printf("%8u %10.1f %10.1f %10.1f\n", n,
+			(double)linear / VIP_ITER, (double)bsearch / VIP_ITER,
+			(double)last_hit / VIP_ITER);
+	}
+
+	rte_free(mem);
+
+	return 0;
+}
+
+static int
+test_vhost_iotlb_perf(void)
+{
+	if (test_vip_iotlb() != 0)
+		return -1;
+
+	return test_vip_gpa();
+}
+
+REGISTER_TEST_COMMAND(vhost_iotlb_perf_autotest, test_vhost_iotlb_perf);
@@ -0,0 +1,322 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2018 NXP
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_mbuf.h>
+#include <rte_vhost.h>
+
+#include "test.h"
+
+/*
+ * Cost of the virtio PMD Rx and Tx bursts, over a vhost-user loopback in
+ * the same process. The virtio-user port is created once with the wide
+ * vector paths disabled and once with the default paths, which are the
+ * AVX2 or AVX512 ones when the CPU and the build support them. The vhost
+ * side feeds the guest Rx queue and drains its Tx queue; reported are the
+ * cycles per packet spent in the PMD bursts only. Packets larger than a
+ * guest mbuf take mergeable buffers.
+ */
+
+#define VRP_SOCK	"/tmp/virtio_rxtx_perf.sock"
+#define VRP_GUEST	"net_virtio_user_vrp"
+#define VRP_RING_SIZE	256
+#define VRP_BURST	32
+#define VRP_NB_SRC	(VRP_BURST * 2)
+#define VRP_NB_PKTS	(1 << 20)
+#define VRP_MAX_PKT_LEN	4096
+#define VRP_TIMEOUT_S	5
+
+static const uint32_t vrp_rx_len[] = { 64, 1518, 4096 };
+static const uint32_t vrp_tx_len[] = { 64, 1518 };
+
+static uint8_t vrp_data[VRP_MAX_PKT_LEN];
+static volatile int vrp_vid = -1;
+static volatile uint32_t vrp_events;
+
+static int
+vrp_new_device(int vid)
+{
+	vrp_vid = vid;
+	vrp_events++;
+	return 0;
+}
+
+static void
+vrp_destroy_device(int vid __rte_unused)
+{
+	vrp_vid = -1;
+	vrp_events++;
+}
+
+static const struct vhost_device_ops vrp_ops = {
+	.new_device = vrp_new_device,
+	.destroy_device = vrp_destroy_device,
+};
+
+static int
+vrp_rx(uint16_t port, struct rte_mbuf **src, uint32_t pkt_len,
+	double *cycles)
+{
+	struct rte_mbuf *pkts[VRP_BURST];
+	uint64_t rx_cycles = 0, last, t, hz;
+	uint32_t sent = 0, received = 0, n, k, i;
+
+	for (i = 0; i < VRP_NB_SRC; i++) {
+		src[i]->data_len = pkt_len;
+		src[i]->pkt_len = pkt_len;
+	}
+
+	hz = rte_get_tsc_hz();
+	last = rte_rdtsc();
+
+	while (received < VRP_NB_PKTS) {
+		k = 0;
+		if (sent < VRP_NB_PKTS) {
+			n = RTE_MIN((uint32_t)VRP_BURST, VRP_NB_PKTS - sent);
+			k = rte_vhost_enqueue_burst(vrp_vid, 0,
+				&src[sent % VRP_BURST], n);
+			sent += k;
+		}
+
+		t = rte_rdtsc();
+		n = rte_eth_rx_burst(port, 0, pkts, VRP_BURST);
+		rx_cycles += rte_rdtsc() - t;
+
+		for (i = 0; i < n; i++) {
+			const void *data = rte_pktmbuf_mtod(pkts[i], void *);
+
+			if (pkts[i]->pkt_len != pkt_len ||
+					memcmp(data, vrp_data, RTE_MIN(pkt_len,
+						pkts[i]->data_len)) != 0) {
+				printf("wrong packet of %u bytes received\n",
+					pkts[i]->pkt_len);
+				for (; i < n; i++)
+					rte_pktmbuf_free(pkts[i]);
+				return -1;
+			}
+			rte_pktmbuf_free(pkts[i]);
+		}
+		received += n;
+
+		t = rte_rdtsc();
+		if (n != 0 || k != 0)
+			last = t;
+		else if (t - last > VRP_TIMEOUT_S * hz) {
+			printf("%s: stalled, %u packets sent, %u received\n",
+				__func__, sent, received);
+			return -1;
+		}
+	}
+
+	*cycles = (double)rx_cycles / VRP_NB_PKTS;
+
+	return 0;
+}
+
+static int
+vrp_tx(uint16_t port, struct rte_mempool *mp, struct rte_mempool *host_mp,
+	uint32_t pkt_len, double *cycles)
+{
+	struct rte_mbuf *pkts[VRP_BURST];
+	uint64_t tx_cycles = 0, last, t, hz;
+	uint32_t sent = 0, received = 0, n, k, i;
+
+	hz = rte_get_tsc_hz();
+	last = rte_rdtsc();
+
+	while (received < VRP_NB_PKTS) {
+		k = 0;
+		n = RTE_MIN((uint32_t)VRP_BURST, VRP_NB_PKTS - sent);
+		if (n != 0 && rte_pktmbuf_alloc_bulk(mp, pkts, n) == 0) {
+			for (i = 0; i < n; i++) {
+				pkts[i]->data_len = pkt_len;
+				pkts[i]->pkt_len = pkt_len;
+			}
+
+			t = rte_rdtsc();
+			k = rte_eth_tx_burst(port, 0, pkts, n);
+			tx_cycles += rte_rdtsc() - t;
+
+			for (i = k; i < n; i++)
+				rte_pktmbuf_free(pkts[i]);
+			sent += k;
+		}
+
+		n = rte_vhost_dequeue_burst(vrp_vid, 1, host_mp, pkts,
+			VRP_BURST);
+		for (i = 0; i < n; i++) {
+			if (pkts[i]->pkt_len != pkt_len) {
+				printf("wrong packet of %u bytes sent\n",
+					pkts[i]->pkt_len);
+				for (; i < n; i++)
+					rte_pktmbuf_free(pkts[i]);
+				return -1;
+			}
+			rte_pktmbuf_free(pkts[i]);
+		}
+		received += n;
+
+		t = rte_rdtsc();
+		if (n != 0 || k != 0)
+			last = t;
+		else if (t - last > VRP_TIMEOUT_S * hz) {
+			printf("%s: stalled, %u packets sent, %u received\n",
+				__func__, sent, received);
+			return -1;
+		}
+	}
+
+	*cycles = (double)tx_cycles / VRP_NB_PKTS;
+
+	return 0;
+}
+
+static int
+vrp_guest_start(uint16_t *port, struct rte_mempool *mp, int vectorized)
+{
+	struct rte_eth_dev_info info;
+	struct rte_eth_txconf txconf;
+	struct rte_eth_conf conf;
+	char args[128];
+	uint64_t deadline;
+	uint32_t events;
+
+	snprintf(args, sizeof(args),
+		"path=%s,queues=1,queue_size=%u,vectorized=%d",
+		VRP_SOCK, VRP_RING_SIZE, vectorized);
+	if (rte_vdev_init(VRP_GUEST, args) != 0) {
+		printf("cannot create %s\n", VRP_GUEST);
+		return -1;
+	}
+
+	if (rte_eth_dev_get_port_by_name(VRP_GUEST, port) != 0)
+		return -1;
+
+	/* single segment packets, the offloads are left available */
+	rte_eth_dev_info_get(*port, &info);
+	txconf = info.default_txconf;
+	txconf.txq_flags = ETH_TXQ_FLAGS_NOMULTSEGS;
+
+	memset(&conf, 0, sizeof(conf));
+	if (rte_eth_dev_configure(*port, 1, 1, &conf) < 0 ||
+			rte_eth_rx_queue_setup(*port, 0, VRP_RING_SIZE,
+				rte_socket_id(), NULL, mp) < 0 ||
+			rte_eth_tx_queue_setup(*port, 0, VRP_RING_SIZE,
+				rte_socket_id(), &txconf) < 0 ||
+			rte_eth_dev_start(*port) < 0) {
+		printf("cannot start %s\n", VRP_GUEST);
+		return -1;
+	}
+
+	/* wait for the device to stay ready, see vhost_async_perf */
+	deadline = rte_rdtsc() + VRP_TIMEOUT_S * rte_get_tsc_hz();
+	do {
+		if (rte_rdtsc() > deadline) {
+			printf("vhost device not ready\n");
+			return -1;
+		}
+		events = vrp_events;
+		usleep(100000);
+	} while (vrp_vid < 0 || events != vrp_events);
+
+	return 0;
+}
+
+static void
+vrp_guest_stop(void)
+{
+	uint16_t port;
+
+	if (rte_eth_dev_get_port_by_name(VRP_GUEST, &port) == 0) {
+		rte_eth_dev_stop(port);
+		rte_eth_dev_close(port);
+	}
+	rte_vdev_uninit(VRP_GUEST);
+}
+
+static int
+test_virtio_rxtx_perf(void)
+{
+	struct rte_mbuf *src[VRP_NB_SRC];
+	struct rte_mempool *src_mp = NULL, *guest_mp = NULL;
+	double rx[2][RTE_DIM(vrp_rx_len)], tx[2][RTE_DIM(vrp_tx_len)];
+	uint16_t port = 0;
+	unsigned int i, j;
+	int vectorized, ret = -1;
+
+	unlink(VRP_SOCK);
+	if (rte_vhost_driver_register(VRP_SOCK, 0) != 0)
+		return -1;
+	if (rte_vhost_driver_callback_register(VRP_SOCK, &vrp_ops) != 0 ||
+			rte_vhost_driver_start(VRP_SOCK) != 0)
+		goto out;
+
+	src_mp = rte_pktmbuf_pool_create("vrp_src", VRP_NB_SRC * 2, 0, 0,
+		VRP_MAX_PKT_LEN + RTE_PKTMBUF_HEADROOM, rte_socket_id());
+	guest_mp = rte_pktmbuf_pool_create("vrp_guest", VRP_RING_SIZE * 4,
+		VRP_BURST, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (src_mp == NULL || guest_mp == NULL) {
+		printf("cannot create mbuf pools\n");
+		goto out;
+	}
+
+	if (rte_pktmbuf_alloc_bulk(src_mp, src, VRP_NB_SRC) != 0)
+		goto out;
+	for (i = 0; i < VRP_MAX_PKT_LEN; i++)
+		vrp_data[i] = i;
+	for (i = 0; i < VRP_NB_SRC; i++)
+		memcpy(rte_pktmbuf_mtod(src[i], void *), vrp_data,
+			VRP_MAX_PKT_LEN);
+
+	for (vectorized = 0; vectorized < 2; vectorized++) {
+		if (vrp_guest_start(&port, guest_mp, vectorized) != 0)
+			goto out_guest;
+
+		for (i = 0; i < RTE_DIM(vrp_rx_len); i++)
+			if (vrp_rx(port, src, vrp_rx_len[i],
+					&rx[vectorized][i]) != 0)
+				goto out_guest;
+		/* the host copies of the sent packets go to the source pool */
+		for (i = 0; i < RTE_DIM(vrp_tx_len); i++)
+			if (vrp_tx(port, guest_mp, src_mp, vrp_tx_len[i],
+					&tx[vectorized][i]) != 0)
+				goto out_guest;
+
+		vrp_guest_stop();
+	}
+
+	printf("%8s %4s %12s %12s\n", "pkt_len", "dir", "scalar/sse",
+		"default");
+	for (j = 0; j < RTE_DIM(vrp_rx_len); j++)
+		printf("%8u %4s %12.1f %12.1f\n", vrp_rx_len[j], "rx",
+			rx[0][j], rx[1][j]);
+	for (j = 0; j < RTE_DIM(vrp_tx_len); j++)
+		printf("%8u %4s %12.1f %12.1f\n", vrp_tx_len[j], "tx",
+			tx[0][j], tx[1][j]);
+	printf("(cycles per packet in the PMD bursts)\n");
+
+	ret = 0;
+	goto out_src;
+
+out_guest:
+	vrp_guest_stop();
+out_src:
+	for (i = 0; i < VRP_NB_SRC; i++)
+		rte_pktmbuf_free(src[i]);
+out:
+	rte_vhost_driver_unregister(VRP_SOCK);
+	rte_mempool_free(src_mp);
+	rte_mempool_free(guest_mp);
+
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(virtio_rxtx_perf_autotest, test_virtio_rxtx_perf);